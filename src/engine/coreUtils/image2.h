@@ -25,6 +25,336 @@
 #include <string>
 #include <iostream>
 #include <type_traits> // for std::is_same - https://en.cppreference.com/w/cpp/types/is_same
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#include "profiler.h"
+#include "parallel.h"
+
+//===== Lens Warp Field ===============================================================================================
+// precomputed form of the Brown-Conrady lens distorts below - the distortion only depends on r², so instead of a
+	// dense per-pixel, per-tap map ( 4GB for a 4k image at 64 taps ), each tap gets a table of its 2x2 pixel space
+	// transform, sampled over r² in [ 0, 2 ]. Applying it is then a table lerp, a bilinear gather, and a weighted
+	// add per tap, with no trig. Channel weights are normalized over the taps once, up front.
+
+enum class lensWeighting_t {
+	UNIFORM,			// plain average of the taps
+	CHROMATIC,			// blue -> green -> red across the taps
+	CHROMATIC_SMOOTH	// sin / sin( 2x ) / cos across the taps
+};
+
+struct lensWarpParams_t {
+	uint32_t width = 0, height = 0;
+	int iterations = 1;
+	float k1min = 0.0f, k1max = 0.0f;
+	float k2min = 0.0f, k2max = 0.0f;
+	float t1min = 0.0f, t1max = 0.0f;
+	bool normalize = false;
+	lensWeighting_t weighting = lensWeighting_t::UNIFORM;
+
+	bool operator == ( const lensWarpParams_t &other ) const {
+		return width == other.width && height == other.height && iterations == other.iterations &&
+			k1min == other.k1min && k1max == other.k1max && k2min == other.k2min && k2max == other.k2max &&
+			t1min == other.t1min && t1max == other.t1max && normalize == other.normalize && weighting == other.weighting;
+	}
+};
+
+struct lensWarpField_t {
+	static constexpr uint32_t radialSamples = 4096; // table resolution over r², error is well under 0.01 pixels
+	lensWarpParams_t params;
+	uint32_t numTaps = 0;
+	uint32_t tapStride = 0;	// numTaps rounded up to 8, the padding taps have zero weight
+	float halfWidth = 0.0f, halfHeight = 0.0f;	// ( dim - 1 ) / 2, pixel space scale and center
+	std::vector< float > weights;	// tapStride x 4, per channel, already divided by that channel's total
+	std::vector< float > radial;	// ( radialSamples + 1 ) x { a[ tapStride ], b[ tapStride ] }, planar so 8 taps load at once
+
+	explicit lensWarpField_t ( const lensWarpParams_t &p ) : params( p ) {
+		numTaps = uint32_t( std::max( 1, p.iterations ) );
+		tapStride = ( numTaps + 7 ) & ~7u;
+		halfWidth = ( p.width - 1 ) * 0.5f;
+		halfHeight = ( p.height - 1 ) * 0.5f;
+
+		// same parameter interpolation and channel weights as the per-pixel versions
+		const float n = float( numTaps );
+		auto remap = [] ( float value, float inLow, float inHigh, float outLow, float outHigh ) {
+			return outLow + ( value - inLow ) * ( outHigh - outLow ) / ( inHigh - inLow );
+		};
+
+		weights.resize( tapStride * 4, 0.0f );
+		float totals[ 4 ] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		const float midPoint = n / 2.0f;
+		for ( uint32_t i = 0; i < numTaps; i++ ) {
+			float * w = &weights[ i * 4 ];
+			switch ( p.weighting ) {
+			case lensWeighting_t::UNIFORM:
+				w[ 0 ] = w[ 1 ] = w[ 2 ] = w[ 3 ] = 1.0f;
+				break;
+			case lensWeighting_t::CHROMATIC:
+				if ( i < midPoint ) { // red to green if less than midpoint, green to blue if greater
+					w[ 2 ] = remap( float( i ), 0.0f, midPoint, 1.0f, 0.0f );
+					w[ 1 ] = ( 1.0f - w[ 2 ] ) / 2.0f;
+					w[ 0 ] = 0.0f;
+				} else {
+					w[ 0 ] = remap( float( i ), midPoint, n, 0.0f, 1.0f );
+					w[ 2 ] = 0.0f;
+					w[ 1 ] = ( 1.0f - w[ 0 ] ) / 2.0f;
+				}
+				w[ 3 ] = 1.0f;
+				break;
+			case lensWeighting_t::CHROMATIC_SMOOTH:
+			{
+				const float interp = remap( i + 0.5f, 0.0f, n, 0.0f, 1.0f );
+				w[ 0 ] = std::sin( interp );
+				w[ 1 ] = std::sin( interp * 2.0f );
+				w[ 2 ] = std::cos( interp );
+				w[ 3 ] = 1.0f;
+				break;
+			}
+			}
+			for ( int c = 0; c < 4; c++ ) totals[ c ] += w[ c ];
+		}
+		for ( uint32_t i = 0; i < numTaps; i++ ) {
+			for ( int c = 0; c < 4; c++ ) {
+				weights[ i * 4 + c ] = ( totals[ c ] != 0.0f ) ? weights[ i * 4 + c ] / totals[ c ] : 0.0f;
+			}
+		}
+
+		// per tap, remapped = nf * s( r² ) * rotate( r² * t1 ) * p, with s( r² ) = 1 + ( k1 r² ) * ( k2 r⁴ ), then
+			// pixel = halfDim * ( 1 + remapped ) - this stores { nf s cos, nf s sin } at each r² sample
+		radial.resize( size_t( radialSamples + 1 ) * tapStride * 2, 0.0f );
+		for ( uint32_t i = 0; i < numTaps; i++ ) {
+			const float k1 = remap( float( i ), 0.0f, n, p.k1min, p.k1max );
+			const float k2 = remap( float( i ), 0.0f, n, p.k2min, p.k2max );
+			const float t1 = remap( float( i ), 0.0f, n, p.t1min, p.t1max );
+			const float normalizeFactor = p.normalize ? ( ( std::abs( k1 ) < 1.0f ) ? ( 1.0f - std::abs( k1 ) ) : ( 1.0f / ( k1 + 1.0f ) ) ) : 1.0f;
+			for ( uint32_t r = 0; r <= radialSamples; r++ ) {
+				const double r2 = 2.0 * double( r ) / double( radialSamples );
+				const double scale = normalizeFactor * ( 1.0 + ( k1 * r2 ) * ( k2 * r2 * r2 ) );
+				const double angle = r2 * t1;
+				float * entry = &radial[ size_t( r ) * tapStride * 2 ];
+				entry[ i ] = float( scale * std::cos( angle ) );
+				entry[ tapStride + i ] = float( scale * std::sin( angle ) );
+			}
+		}
+	}
+};
+
+// small most-recently-used cache, so repeated applies with the same parameters ( screenshots, sliders settling ) skip the build
+inline std::shared_ptr< const lensWarpField_t > LensWarpField ( const lensWarpParams_t &params ) {
+	static std::mutex lock;
+	static std::vector< std::shared_ptr< const lensWarpField_t > > cache;
+	constexpr size_t maxCached = 4;
+
+	std::lock_guard< std::mutex > guard( lock );
+	for ( size_t i = 0; i < cache.size(); i++ ) {
+		if ( cache[ i ]->params == params ) {
+			std::rotate( cache.begin(), cache.begin() + i, cache.begin() + i + 1 );
+			return cache.front();
+		}
+	}
+	cache.insert( cache.begin(), std::make_shared< const lensWarpField_t >( params ) );
+	if ( cache.size() > maxCached ) cache.pop_back();
+	return cache.front();
+}
+
+//===== Resampling ====================================================================================================
+// separable resampling filters, for Image2::Resize and Image2::BuildMipChain - weights are computed once per axis, for
+	// each output pixel, then applied as a horizontal pass into a float scratch buffer and a vertical pass out of it.
+
+enum class resampleFilter_t {
+	BOX,		// area average, exact 2x2 average for the mip chain
+	TENT,		// bilinear
+	LANCZOS3,	// windowed sinc, sharpest, with some ringing
+	MITCHELL,	// B = C = 1/3 cubic, stb_image_resize's default for downsampling
+	CATMULLROM,	// B = 0, C = 1/2 cubic, interpolating - stb_image_resize's default for upsampling
+	AUTO		// per axis, CATMULLROM when magnifying and MITCHELL otherwise, like stb_image_resize picked
+};
+
+// resolves AUTO for one axis
+inline resampleFilter_t ResampleFilterForAxis ( const resampleFilter_t filter, const uint32_t sourceSize, const uint32_t destSize ) {
+	if ( filter != resampleFilter_t::AUTO ) return filter;
+	return ( destSize > sourceSize ) ? resampleFilter_t::CATMULLROM : resampleFilter_t::MITCHELL;
+}
+
+// Mitchell-Netravali family of cubics, support 2
+inline float ResampleCubic ( const float x, const float B, const float C ) {
+	if ( x < 1.0f ) {
+		return ( ( 12.0f - 9.0f * B - 6.0f * C ) * x * x * x + ( -18.0f + 12.0f * B + 6.0f * C ) * x * x + ( 6.0f - 2.0f * B ) ) / 6.0f;
+	} else if ( x < 2.0f ) {
+		return ( ( -B - 6.0f * C ) * x * x * x + ( 6.0f * B + 30.0f * C ) * x * x + ( -12.0f * B - 48.0f * C ) * x + ( 8.0f * B + 24.0f * C ) ) / 6.0f;
+	}
+	return 0.0f;
+}
+
+inline float ResampleFilterSupport ( const resampleFilter_t filter ) {
+	switch ( filter ) {
+		case resampleFilter_t::BOX:			return 0.5f;
+		case resampleFilter_t::TENT:		return 1.0f;
+		case resampleFilter_t::LANCZOS3:	return 3.0f;
+		case resampleFilter_t::MITCHELL:	return 2.0f;
+		case resampleFilter_t::CATMULLROM:	return 2.0f;
+		default: return 1.0f;
+	}
+}
+
+inline float ResampleFilterEvaluate ( const resampleFilter_t filter, float x ) {
+	x = std::abs( x );
+	switch ( filter ) {
+		case resampleFilter_t::BOX:
+			return ( x < 0.5f ) ? 1.0f : 0.0f;
+
+		case resampleFilter_t::TENT:
+			return std::max( 0.0f, 1.0f - x );
+
+		case resampleFilter_t::LANCZOS3:
+		{
+			if ( x < 1e-5f ) return 1.0f;
+			if ( x >= 3.0f ) return 0.0f;
+			const float pix = 3.14159265358979f * x;
+			return 3.0f * std::sin( pix ) * std::sin( pix / 3.0f ) / ( pix * pix );
+		}
+
+		case resampleFilter_t::MITCHELL:
+			return ResampleCubic( x, 1.0f / 3.0f, 1.0f / 3.0f );
+
+		case resampleFilter_t::CATMULLROM:
+			return ResampleCubic( x, 0.0f, 0.5f );
+
+		default: return 0.0f;
+	}
+}
+
+// contributions for every output pixel along one axis - fixed tap count, zero padded, edges clamped
+struct resampleAxis_t {
+	uint32_t taps = 0;
+	std::vector< int > first;		// first source index, per output pixel
+	std::vector< float > weights;	// taps per output pixel, sums to 1
+
+	void Build ( const uint32_t sourceSize, const uint32_t destSize, const resampleFilter_t filterIn ) {
+		const resampleFilter_t filter = ResampleFilterForAxis( filterIn, sourceSize, destSize );
+		const float scale = float( destSize ) / float( sourceSize );
+		const float filterScale = std::max( 1.0f, 1.0f / scale );	// widen the filter when minifying
+		const float radius = ResampleFilterSupport( filter ) * filterScale;
+		taps = std::min( uint32_t( std::ceil( radius * 2.0f ) ) + 1, sourceSize );
+
+		first.resize( destSize );
+		weights.assign( size_t( destSize ) * taps, 0.0f );
+		for ( uint32_t i = 0; i < destSize; i++ ) {
+			const float center = ( i + 0.5f ) / scale - 0.5f;
+			const int lo = int( std::ceil( center - radius ) );
+			const int hi = int( std::floor( center + radius ) );
+
+			// the clamped span is contiguous - anything off the edge folds into the edge pixel
+			const int start = std::clamp( lo, 0, int( sourceSize ) - int( taps ) );
+			float * w = &weights[ size_t( i ) * taps ];
+			float total = 0.0f;
+			for ( int j = lo; j <= hi; j++ ) {
+				const float value = ResampleFilterEvaluate( filter, ( float( j ) - center ) / filterScale );
+				if ( value == 0.0f ) continue;
+				const int tap = std::clamp( j, 0, int( sourceSize ) - 1 ) - start;
+				if ( tap < 0 || tap >= int( taps ) ) continue;
+				w[ tap ] += value;
+				total += value;
+			}
+			if ( total == 0.0f ) { // nothing landed in the window, fall back to the nearest pixel
+				w[ std::clamp( int( center + 0.5f ), 0, int( sourceSize ) - 1 ) - start ] = total = 1.0f;
+			}
+			for ( uint32_t k = 0; k < taps; k++ ) w[ k ] /= total;
+			first[ i ] = start;
+		}
+	}
+};
+
+// reused between calls, so repeated resizes don't go back to the allocator - one per calling thread
+struct resampleScratch_t {
+	resampleAxis_t horizontal;
+	resampleAxis_t vertical;
+	std::vector< float > rows;	// source height x dest width x channels, the horizontal pass result
+};
+
+inline resampleScratch_t &ResampleScratch () {
+	thread_local resampleScratch_t scratch;
+	return scratch;
+}
+
+//===== Pixel Sorting =================================================================================================
+// lines are gathered 16 at a time, tile by tile, into contiguous buffers - keys are pulled out once per pixel as 16 bits,
+	// each line is split into intervals by a threshold on the key, and every interval is sorted with an LSD radix sort on
+	// ( key << 16 | offset ), which carries the permutation along with it. Groups of lines spread across threads, each
+	// thread with its own scratch.
+
+enum class pixelSortKey_t { RED, GREEN, BLUE, ALPHA, LUMA, HUE, SATURATION };
+
+struct pixelSortParams_t {
+	pixelSortKey_t key = pixelSortKey_t::LUMA;
+	float angle = 0.0f;				// degrees, direction of increasing key - 0 is along +x, 90 is along +y
+	float thresholdLow = 0.0f;		// pixels with keys in [ low, high ] are sorted, anything outside splits the intervals - as
+									// fractions of the key range, which is [ 0, 1 ] unless a float image runs outside it
+	float thresholdHigh = 1.0f;
+	bool maskTransparent = false;	// zero alpha also splits intervals
+	bool reverse = false;
+	uint32_t numThreads = 0;
+};
+
+struct pixelSortScratch_t {
+	static constexpr uint32_t groupLines = 16;	// adjacent lines gathered together, so the reads share cache lines
+	struct group_t {
+		std::vector< uint8_t > colors;		// groupLines x line length pixels, gathered in sort order
+		std::vector< uint8_t > sorted;		// the same, with the intervals sorted
+		std::vector< uint16_t > keys;		// one line's worth
+		std::vector< uint32_t > packed;		// ( key << 16 ) | offset into the interval
+		std::vector< uint32_t > temp;		// radix ping-pong
+	};
+	std::vector< int > steps;		// minor axis offset, per major axis step
+	std::vector< group_t > groups;	// one per worker thread
+};
+
+// owned by the calling thread - workers index into it, so nothing is allocated once it has grown to size
+inline pixelSortScratch_t &PixelSortScratch () {
+	thread_local pixelSortScratch_t scratch;
+	return scratch;
+}
+
+// sorts by the top 16 bits, stable, so equal keys keep their order along the line
+inline void PixelSortRadix ( uint32_t * values, uint32_t * temp, const uint32_t count, const int passes ) {
+	if ( count < 48 ) { // insertion sort wins for short intervals
+		for ( uint32_t i = 1; i < count; i++ ) {
+			const uint32_t v = values[ i ];
+			uint32_t j = i;
+			while ( j > 0 && ( values[ j - 1 ] >> 16 ) > ( v >> 16 ) ) {
+				values[ j ] = values[ j - 1 ];
+				j--;
+			}
+			values[ j ] = v;
+		}
+		return;
+	}
+	uint32_t * source = values;
+	uint32_t * dest = temp;
+	for ( int pass = 0; pass < passes; pass++ ) {
+		const int shift = ( passes == 1 ) ? 24 : 16 + pass * 8;
+		uint32_t counts[ 256 ] = {};
+		for ( uint32_t i = 0; i < count; i++ ) counts[ ( source[ i ] >> shift ) & 0xFF ]++;
+		uint32_t sum = 0;
+		for ( int b = 0; b < 256; b++ ) {
+			const uint32_t c = counts[ b ];
+			counts[ b ] = sum;
+			sum += c;
+		}
+		for ( uint32_t i = 0; i < count; i++ ) dest[ counts[ ( source[ i ] >> shift ) & 0xFF ]++ ] = source[ i ];
+		std::swap( source, dest );
+	}
+	if ( source != values ) {
+		memcpy( values, source, count * sizeof( uint32_t ) );
+	}
+}
 
 //===== Image2 ========================================================================================================
 
@@ -183,6 +513,7 @@ public:
 	}
 
 	bool Save ( string path, backend loader = backend::LODEPNG ) const {
+		PROFILE_SCOPE( "Image2::Save" );
 		switch ( loader ) {
 			case backend::STB_IMG: return SaveSTB_img( path ); break;
 			case backend::LODEPNG: return SaveLodePNG( path ); break;
@@ -223,12 +554,100 @@ public:
 		}
 	}
 
-	void Resize ( float factor ) {
+	void Resize ( float factor, resampleFilter_t filter = resampleFilter_t::AUTO ) {
 		// scale, uniform on both axes
-		Resize( factor, factor );
+		Resize( factor, factor, filter );
+	}
+
+	void Resize ( float XFactor, float YFactor, resampleFilter_t filter = resampleFilter_t::AUTO ) {
+		// scale factor does not need to be the same on x and y
+		ResizeTo( uint32_t( std::floor( XFactor * float( width ) ) ), uint32_t( std::floor( YFactor * float( height ) ) ), filter );
+	}
+
+	void ResizeTo ( uint32_t newWidth, uint32_t newHeight, resampleFilter_t filter = resampleFilter_t::AUTO ) {
+		if ( newWidth == 0 || newHeight == 0 || width == 0 || height == 0 ) return;
+		PROFILE_SCOPE( "Image2::Resize" );
+		resampleScratch_t &scratch = ResampleScratch();
+
+		// the horizontal pass is the last read of the source, so the vertical pass can write straight into data
+		ResampleHorizontal( data.data(), width, height, newWidth, filter, scratch );
+		data.resize( size_t( newWidth ) * newHeight * numChannels );
+		ResampleVertical( scratch, height, newWidth, newHeight, filter, data.data() );
+
+		width = newWidth;
+		height = newHeight;
+	}
+
+	// every level, largest to smallest, back to back in one allocation - level 0 is a copy of the image
+	struct mipChain_t {
+		std::vector< uint32_t > widths;
+		std::vector< uint32_t > heights;
+		std::vector< size_t > offsets;	// in elements, into data
+		std::vector< imageType > data;
+
+		uint32_t NumLevels () const { return uint32_t( offsets.size() ); }
+		const imageType * Level ( uint32_t level ) const { return data.data() + offsets[ level ]; }
+		imageType * Level ( uint32_t level ) { return data.data() + offsets[ level ]; }
+	};
+
+	// each level is resampled from the one above it - reusing a chain of the same size does not reallocate
+	void BuildMipChain ( mipChain_t &chain, resampleFilter_t filter = resampleFilter_t::BOX, uint32_t maxLevels = 0 ) const {
+		PROFILE_SCOPE( "Image2::BuildMipChain" );
+		chain.widths.clear();
+		chain.heights.clear();
+		chain.offsets.clear();
+		if ( width == 0 || height == 0 ) {
+			chain.data.clear();
+			return;
+		}
+
+		// lay out the levels, halving down to 1x1 ( or maxLevels )
+		size_t total = 0;
+		uint32_t w = width, h = height;
+		while ( true ) {
+			chain.widths.push_back( w );
+			chain.heights.push_back( h );
+			chain.offsets.push_back( total );
+			total += size_t( w ) * h * numChannels;
+			if ( ( w == 1 && h == 1 ) || ( maxLevels != 0 && chain.offsets.size() == maxLevels ) ) break;
+			w = std::max( 1u, w / 2 );
+			h = std::max( 1u, h / 2 );
+		}
+		chain.data.resize( total );
+		std::copy( data.begin(), data.end(), chain.data.begin() );
+
+		resampleScratch_t &scratch = ResampleScratch();
+		for ( uint32_t level = 1; level < chain.NumLevels(); level++ ) {
+			const uint32_t sw = chain.widths[ level - 1 ], sh = chain.heights[ level - 1 ];
+			const uint32_t dw = chain.widths[ level ], dh = chain.heights[ level ];
+			const imageType * source = chain.Level( level - 1 );
+			imageType * dest = chain.Level( level );
+
+			if ( filter == resampleFilter_t::BOX && sw == dw * 2 && sh == dh * 2 ) {
+				// exact 2x2 average, one pass
+				parallelForRanges( dh, [ & ] ( size_t yBegin, size_t yEnd, uint32_t ) {
+					for ( size_t y = yBegin; y < yEnd; y++ ) {
+						const imageType * row0 = source + ( y * 2 ) * sw * numChannels;
+						const imageType * row1 = row0 + sw * numChannels;
+						imageType * out = dest + y * dw * numChannels;
+						for ( uint32_t x = 0; x < dw; x++ ) {
+							for ( int c = 0; c < numChannels; c++ ) {
+								const float sum = float( row0[ x * 2 * numChannels + c ] ) + float( row0[ ( x * 2 + 1 ) * numChannels + c ] ) +
+									float( row1[ x * 2 * numChannels + c ] ) + float( row1[ ( x * 2 + 1 ) * numChannels + c ] );
+								out[ x * numChannels + c ] = ResampleStore( sum * 0.25f );
+							}
+						}
+					}
+				}, ResampleThreads( size_t( sw ) * sh ) );
+			} else {
+				ResampleHorizontal( source, sw, sh, dw, filter, scratch );
+				ResampleVertical( scratch, sh, dw, dh, filter, dest );
+			}
+		}
 	}
 
-	void Resize ( float XFactor, float YFactor ) {
+	// the previous stb_image_resize path, kept for comparison in ResampleBenchmark
+	void ResizeSTB ( float XFactor, float YFactor ) {
 		// scale factor does not need to be the same on x and y
 		int newX = std::floor( XFactor * float( width ) );
 		int newY = std::floor( YFactor * float( height ) );
@@ -264,6 +683,8 @@ public:
 		for ( uint32_t i = 0; i < newSize; i++ ) {
 			data.push_back( newData[ i ] );
 		}
+		free( oldData );
+		free( newData );
 	}
 
 	void ClearTo ( color c ) {
@@ -388,8 +809,152 @@ public:
 		}
 	}
 
-	// TODO: thresholding logic, masking?
+	// same line choice as before - orientation 0 sorts down the columns - through the radix engine below. Transparent
+		// pixels now stay where they are and split the intervals, instead of being dropped off the end of the line
 	void PixelSort ( int orientation, int channel ) {
+		pixelSortParams_t params;
+		params.angle = ( orientation == 0 ) ? 90.0f : 0.0f;
+		params.key = ( channel < 4 ) ? pixelSortKey_t( channel ) : pixelSortKey_t::LUMA;
+		params.maskTransparent = true;
+		PixelSort( params );
+	}
+
+	void PixelSort ( const pixelSortParams_t &params ) {
+		if ( width == 0 || height == 0 ) return;
+		PROFILE_SCOPE( "Image2::PixelSort" );
+		pixelSortScratch_t &scratch = PixelSortScratch();
+		const uint32_t numThreads = ( params.numThreads == 0 ) ? parallelThreadCount() : params.numThreads;
+
+		// lines are stepped along the major axis, with a rounded offset on the minor axis - every pixel is on exactly one line
+		const float angle = glm::radians( params.angle );
+		const bool majorX = std::abs( std::cos( angle ) ) >= std::abs( std::sin( angle ) );
+		const bool backwards = majorX ? ( std::cos( angle ) < 0.0f ) : ( std::sin( angle ) < 0.0f );
+		const float slope = majorX ? std::tan( angle ) : 1.0f / std::tan( angle );
+		const uint32_t majorSize = majorX ? width : height;
+		const int minorSize = int( majorX ? height : width );
+		const size_t majorStride = majorX ? 1 : width;
+		const size_t minorStride = majorX ? width : 1;
+		scratch.steps.resize( majorSize );
+		for ( uint32_t i = 0; i < majorSize; i++ ) {
+			scratch.steps[ i ] = int( std::floor( i * slope + 0.5f ) );
+		}
+		const int * steps = scratch.steps.data();
+		const int lastStep = steps[ majorSize - 1 ];
+		const int firstLine = -std::max( 0, lastStep );
+		const uint32_t numLines = uint32_t( minorSize ) + std::abs( lastStep );
+
+		constexpr uint32_t groupLines = pixelSortScratch_t::groupLines;
+		const uint32_t numGroups = ( numLines + groupLines - 1 ) / groupLines;
+		if ( scratch.groups.size() < numThreads ) scratch.groups.resize( numThreads );
+
+		// float images can run past 1 ( HDR ), or below 0 - the channel and luma keys widen from [ 0, 1 ] to cover the
+			// values that are actually there, so those keep their order instead of all landing on the same key
+		float keyLow = 0.0f, keyHigh = 1.0f;
+		if constexpr ( !std::is_same< imageType, uint8_t >::value ) {
+			if ( params.key <= pixelSortKey_t::LUMA ) {
+				std::vector< float > threadLow( numThreads, 0.0f ), threadHigh( numThreads, 1.0f );
+				parallelForRanges( size_t( width ) * height, [ & ] ( size_t begin, size_t end, uint32_t threadIndex ) {
+					PixelSortKeyRange( data.data() + begin * numChannels, end - begin, params.key, threadLow[ threadIndex ], threadHigh[ threadIndex ] );
+				}, numThreads );
+				keyLow = *std::min_element( threadLow.begin(), threadLow.end() );
+				keyHigh = *std::max_element( threadHigh.begin(), threadHigh.end() );
+			}
+		}
+
+		const uint16_t low = uint16_t( std::clamp( params.thresholdLow, 0.0f, 1.0f ) * 65535.0f );
+		const uint16_t high = uint16_t( std::clamp( params.thresholdHigh, 0.0f, 1.0f ) * 65535.0f );
+		const int passes = ( std::is_same< imageType, uint8_t >::value && params.key <= pixelSortKey_t::ALPHA ) ? 1 : 2;
+		color * pixels = reinterpret_cast< color * >( data.data() );
+
+		parallelForDynamic( numGroups, [ & ] ( size_t groupIndex, uint32_t threadIndex ) {
+			pixelSortScratch_t::group_t &group = scratch.groups[ threadIndex ];
+			// only ever grows - the pixel buffers are bytes, shared between image types
+			const size_t groupBytes = size_t( groupLines ) * majorSize * sizeof( color );
+			if ( group.colors.size() < groupBytes ) {
+				group.colors.resize( groupBytes );
+				group.sorted.resize( groupBytes );
+			}
+			if ( group.keys.size() < majorSize ) {
+				group.keys.resize( majorSize );
+				group.packed.resize( majorSize );
+				group.temp.resize( majorSize );
+			}
+			color * colors = reinterpret_cast< color * >( group.colors.data() );
+			color * sorted = reinterpret_cast< color * >( group.sorted.data() );
+
+			// the span of the major axis where each line is inside the image
+			const uint32_t lines = std::min( groupLines, numLines - uint32_t( groupIndex ) * groupLines );
+			int offsets[ groupLines ];
+			uint32_t spanBegin[ groupLines ], spanEnd[ groupLines ];
+			for ( uint32_t k = 0; k < lines; k++ ) {
+				offsets[ k ] = firstLine + int( groupIndex * groupLines + k );
+				uint32_t m = 0;
+				while ( m < majorSize && uint32_t( offsets[ k ] + steps[ m ] ) >= uint32_t( minorSize ) ) m++;
+				spanBegin[ k ] = m;
+				while ( m < majorSize && uint32_t( offsets[ k ] + steps[ m ] ) < uint32_t( minorSize ) ) m++;
+				spanEnd[ k ] = m;
+			}
+
+			// gather / scatter in tiles along the major axis - the group's lines are neighbors, so a tile is a compact block
+			auto forEachPixel = [ & ] ( auto func ) {
+				constexpr uint32_t tile = 16;
+				for ( uint32_t tileBegin = 0; tileBegin < majorSize; tileBegin += tile ) {
+					for ( uint32_t k = 0; k < lines; k++ ) {
+						const uint32_t mBegin = std::max( tileBegin, spanBegin[ k ] );
+						const uint32_t mEnd = std::min( tileBegin + tile, spanEnd[ k ] );
+						for ( uint32_t m = mBegin; m < mEnd; m++ ) {
+							const size_t source = m * majorStride + size_t( offsets[ k ] + steps[ m ] ) * minorStride;
+							const uint32_t position = backwards ? ( spanEnd[ k ] - 1 - m ) : ( m - spanBegin[ k ] );
+							func( source, size_t( k ) * majorSize + position );
+						}
+					}
+				}
+			};
+			forEachPixel( [ & ] ( size_t source, size_t position ) { colors[ position ] = pixels[ source ]; } );
+
+			// per line - keys, intervals, sort
+			for ( uint32_t k = 0; k < lines; k++ ) {
+				const uint32_t count = spanEnd[ k ] - spanBegin[ k ];
+				const color * in = colors + size_t( k ) * majorSize;
+				color * out = sorted + size_t( k ) * majorSize;
+				uint16_t * keys = group.keys.data();
+				uint32_t * packed = group.packed.data();
+				PixelSortKeys( reinterpret_cast< const imageType * >( in ), count, params.key, keys, keyLow, keyHigh );
+
+				auto breaks = [ & ] ( uint32_t i ) {
+					bool result = keys[ i ] < low || keys[ i ] > high;
+					if constexpr ( numChannels > 3 ) result = result || ( params.maskTransparent && in[ i ][ alpha ] == 0 );
+					return result;
+				};
+
+				uint32_t start = 0;
+				while ( start < count ) {
+					if ( breaks( start ) ) {
+						out[ start ] = in[ start ];
+						start++;
+						continue;
+					}
+					uint32_t end = start + 1;
+					while ( end < count && !breaks( end ) && ( end - start ) < 65536 ) end++;
+					const uint32_t length = end - start;
+					for ( uint32_t i = 0; i < length; i++ ) {
+						const uint32_t key = params.reverse ? ( 65535u - keys[ start + i ] ) : keys[ start + i ];
+						packed[ i ] = ( key << 16 ) | i;
+					}
+					PixelSortRadix( packed, group.temp.data(), length, passes );
+					for ( uint32_t i = 0; i < length; i++ ) {
+						out[ start + i ] = in[ start + ( packed[ i ] & 0xFFFF ) ];
+					}
+					start = end;
+				}
+			}
+
+			forEachPixel( [ & ] ( size_t source, size_t position ) { pixels[ source ] = sorted[ position ]; } );
+		}, 1, numThreads );
+	}
+
+	// the original comparison sort, whole lines, kept for comparison in PixelSortBenchmark
+	void PixelSortReference ( int orientation, int channel ) {
 		const bool horizontal = orientation == 0;
 		for ( uint32_t x { 0 }; x < ( horizontal ? width : height ); x++ ) {
 			std::vector< color > vec;
@@ -561,8 +1126,210 @@ public:
 		// Some sample values:
 			// { k1 = -0.2, k2 = 0.2, tangentialSkew =  0.2 }
 			// { k1 =  0.5, k2 = 0.4, tangentialSkew = -0.2 }
+	// the public versions go through the cached lensWarpField_t, the ...Reference versions are the original per-pixel
+		// evaluation, kept for comparison ( see LensWarpBenchmark, at the bottom of this file )
 
 	void BrownConradyLensDistort ( const float k1, const float k2, const float tangentialSkew, const bool normalize = false ) {
+		LensWarp( 1, k1, k1, k2, k2, tangentialSkew, tangentialSkew, normalize, lensWeighting_t::UNIFORM );
+	}
+
+	void BrownConradyLensDistortMSBlurred ( const int iterations, const float k1, const float k2, const float t1, const bool normalize = false ) {
+		BrownConradyLensDistortMSBlurred( iterations, -k1, k1, -k2, k2, -t1, t1, normalize );
+	}
+
+	void BrownConradyLensDistortMSBlurred ( const int iterations,
+		const float k1min, const float k1max,
+		const float k2min, const float k2max,
+		const float t1min, const float t1max,
+		const bool normalize = false ) {
+		LensWarp( iterations, k1min, k1max, k2min, k2max, t1min, t1max, normalize, lensWeighting_t::UNIFORM );
+	}
+
+	void BrownConradyLensDistortMSBlurredChromatic ( const int iterations, const float k1, const float k2, const float t1 ) {
+		BrownConradyLensDistortMSBlurredChromatic( iterations, -k1, k1, -k2, k2, -t1, t1 );
+	}
+
+	void BrownConradyLensDistortMSBlurredChromatic ( const int iterations,
+		const float k1min, const float k1max,
+		const float k2min, const float k2max,
+		const float t1min, const float t1max ) {
+		LensWarp( iterations, k1min, k1max, k2min, k2max, t1min, t1max, false, lensWeighting_t::CHROMATIC );
+	}
+
+	void BrownConradyLensDistortMSBlurredChromaticSmooth ( const int iterations, const float k1, const float k2, const float t1 ) {
+		BrownConradyLensDistortMSBlurredChromaticSmooth( iterations, -k1, k1, -k2, k2, -t1, t1 );
+	}
+
+	void BrownConradyLensDistortMSBlurredChromaticSmooth ( const int iterations,
+		const float k1min, const float k1max,
+		const float k2min, const float k2max,
+		const float t1min, const float t1max ) {
+		LensWarp( iterations, k1min, k1max, k2min, k2max, t1min, t1max, false, lensWeighting_t::CHROMATIC_SMOOTH );
+	}
+
+	void BrownConradyLensDistortMSBlurredChromaticNormalized ( const int iterations, const float k1, const float k2, const float t1 ) {
+		BrownConradyLensDistortMSBlurredChromaticNormalized( iterations, -k1, k1, -k2, k2, -t1, t1 );
+	}
+
+	void BrownConradyLensDistortMSBlurredChromaticNormalized ( const int iterations,
+		const float k1min, const float k1max,
+		const float k2min, const float k2max,
+		const float t1min, const float t1max ) {
+		LensWarp( iterations, k1min, k1max, k2min, k2max, t1min, t1max, true, lensWeighting_t::CHROMATIC );
+	}
+
+	void LensWarp ( const int iterations,
+		const float k1min, const float k1max,
+		const float k2min, const float k2max,
+		const float t1min, const float t1max,
+		const bool normalize, const lensWeighting_t weighting, const uint32_t numThreads = 0 ) {
+		lensWarpParams_t params;
+		params.width = width;
+		params.height = height;
+		params.iterations = iterations;
+		params.k1min = k1min; params.k1max = k1max;
+		params.k2min = k2min; params.k2max = k2max;
+		params.t1min = t1min; params.t1max = t1max;
+		params.normalize = normalize;
+		params.weighting = weighting;
+		LensWarp( *LensWarpField( params ), numThreads );
+	}
+
+	// apply a warp field built for this image's dimensions - every tap for a pixel happens in one pass, row bands across threads
+	void LensWarp ( const lensWarpField_t &field, const uint32_t numThreads = 0 ) {
+		if ( field.params.width != width || field.params.height != height || width < 2 || height < 2 ) return;
+		PROFILE_SCOPE( "Image2::LensWarp" );
+
+		// the taps read the original, so keep a copy of it
+		const std::vector< imageType > source = data;
+		const imageType * src = source.data();
+		imageType * dst = data.data();
+
+		const uint32_t numTaps = field.numTaps;
+		const uint32_t tapStride = field.tapStride;
+		const float * radial = field.radial.data();
+		const float * weights = field.weights.data();
+		const float halfWidth = field.halfWidth;
+		const float halfHeight = field.halfHeight;
+		const float radialScale = lensWarpField_t::radialSamples * 0.5f;
+		const int w = int( width );
+		const int h = int( height );
+
+		parallelForRanges( height, [ & ] ( size_t yBegin, size_t yEnd, uint32_t ) {
+			for ( size_t y = yBegin; y < yEnd; y++ ) {
+				const float py = ( ( float ) y / ( float ) height ) * 2.0f - 1.0f;
+				for ( uint32_t x = 0; x < width; x++ ) {
+					const float px = ( ( float ) x / ( float ) width ) * 2.0f - 1.0f;
+
+					// where this pixel falls in the radial table - shared by all the taps
+					const float t = ( px * px + py * py ) * radialScale;
+					const uint32_t r = std::min( uint32_t( t ), lensWarpField_t::radialSamples - 1 );
+					const float f = t - float( r );
+					const float * e0 = radial + size_t( r ) * tapStride * 2;
+					const float * e1 = e0 + tapStride * 2;
+
+					imageType * out = dst + ( size_t( y ) * width + x ) * numChannels;
+
+				#ifdef __AVX__
+					if constexpr ( numChannels == 4 && ( std::is_same< imageType, float >::value || std::is_same< imageType, uint8_t >::value ) ) {
+						// RGBA, one texel per SSE register
+						auto load = [] ( const imageType * p ) -> __m128 {
+							if constexpr ( std::is_same< imageType, float >::value ) {
+								return _mm_loadu_ps( p );
+							} else {
+								int packed;
+								memcpy( &packed, p, 4 );
+								return _mm_cvtepi32_ps( _mm_cvtepu8_epi32( _mm_cvtsi32_si128( packed ) ) );
+							}
+						};
+						auto texel = [ & ] ( int tx, int ty ) -> __m128 {
+							return ( tx >= 0 && ty >= 0 && tx < w && ty < h ) ? load( src + ( size_t( ty ) * width + tx ) * 4 ) : _mm_setzero_ps();
+						};
+
+						__m128 accumulated = _mm_setzero_ps();
+						for ( uint32_t group = 0; group < numTaps; group += 8 ) {
+							// sample positions for 8 taps at once
+							const __m256 f8 = _mm256_set1_ps( f );
+							const __m256 a0 = _mm256_loadu_ps( e0 + group ), b0 = _mm256_loadu_ps( e0 + tapStride + group );
+							const __m256 a = _mm256_add_ps( a0, _mm256_mul_ps( f8, _mm256_sub_ps( _mm256_loadu_ps( e1 + group ), a0 ) ) );
+							const __m256 b = _mm256_add_ps( b0, _mm256_mul_ps( f8, _mm256_sub_ps( _mm256_loadu_ps( e1 + tapStride + group ), b0 ) ) );
+							const __m256 px8 = _mm256_set1_ps( px ), py8 = _mm256_set1_ps( py ), one = _mm256_set1_ps( 1.0f );
+							__m256 sx = _mm256_mul_ps( _mm256_set1_ps( halfWidth ), _mm256_add_ps( one, _mm256_add_ps( _mm256_mul_ps( a, px8 ), _mm256_mul_ps( b, py8 ) ) ) );
+							__m256 sy = _mm256_mul_ps( _mm256_set1_ps( halfHeight ), _mm256_sub_ps( _mm256_add_ps( one, _mm256_mul_ps( a, py8 ) ), _mm256_mul_ps( b, px8 ) ) );
+							sx = _mm256_min_ps( _mm256_max_ps( sx, _mm256_set1_ps( -2.0f ) ), _mm256_set1_ps( float( w + 1 ) ) );
+							sy = _mm256_min_ps( _mm256_max_ps( sy, _mm256_set1_ps( -2.0f ) ), _mm256_set1_ps( float( h + 1 ) ) );
+							const __m256 fx = _mm256_floor_ps( sx ), fy = _mm256_floor_ps( sy );
+							alignas( 32 ) int ix[ 8 ], iy[ 8 ];
+							alignas( 32 ) float wx[ 8 ], wy[ 8 ];
+							_mm256_store_si256( ( __m256i * ) ix, _mm256_cvttps_epi32( fx ) );
+							_mm256_store_si256( ( __m256i * ) iy, _mm256_cvttps_epi32( fy ) );
+							_mm256_store_ps( wx, _mm256_sub_ps( sx, fx ) );
+							_mm256_store_ps( wy, _mm256_sub_ps( sy, fy ) );
+
+							// gather and blend
+							const uint32_t groupTaps = std::min( 8u, numTaps - group );
+							for ( uint32_t k = 0; k < groupTaps; k++ ) {
+								__m128 t00, t10, t01, t11;
+								if ( ix[ k ] >= 0 && iy[ k ] >= 0 && ix[ k ] + 1 < w && iy[ k ] + 1 < h ) {
+									const imageType * p = src + ( size_t( iy[ k ] ) * width + ix[ k ] ) * 4;
+									t00 = load( p ); t10 = load( p + 4 );
+									t01 = load( p + width * 4 ); t11 = load( p + width * 4 + 4 );
+								} else { // texels off the edge read as zero, same as GetAtXY
+									t00 = texel( ix[ k ], iy[ k ] ); t10 = texel( ix[ k ] + 1, iy[ k ] );
+									t01 = texel( ix[ k ], iy[ k ] + 1 ); t11 = texel( ix[ k ] + 1, iy[ k ] + 1 );
+								}
+								const __m128 wx4 = _mm_set1_ps( wx[ k ] ), wy4 = _mm_set1_ps( wy[ k ] );
+								const __m128 top = _mm_add_ps( t00, _mm_mul_ps( wx4, _mm_sub_ps( t10, t00 ) ) );
+								const __m128 bottom = _mm_add_ps( t01, _mm_mul_ps( wx4, _mm_sub_ps( t11, t01 ) ) );
+								const __m128 filtered = _mm_add_ps( top, _mm_mul_ps( wy4, _mm_sub_ps( bottom, top ) ) );
+								accumulated = _mm_add_ps( accumulated, _mm_mul_ps( filtered, _mm_loadu_ps( weights + ( group + k ) * 4 ) ) );
+							}
+						}
+
+						if constexpr ( std::is_same< imageType, float >::value ) {
+							_mm_storeu_ps( out, accumulated );
+						} else {
+							const __m128i packed = _mm_packus_epi16( _mm_packus_epi32( _mm_cvtps_epi32( accumulated ), _mm_setzero_si128() ), _mm_setzero_si128() );
+							const int result = _mm_cvtsi128_si32( packed );
+							memcpy( out, &result, 4 );
+						}
+						continue;
+					}
+				#endif
+
+					float accumulated[ numChannels ] = {};
+					for ( uint32_t i = 0; i < numTaps; i++ ) {
+						const float a = e0[ i ] + f * ( e1[ i ] - e0[ i ] );
+						const float b = e0[ tapStride + i ] + f * ( e1[ tapStride + i ] - e0[ tapStride + i ] );
+						const float sx = std::clamp( halfWidth * ( 1.0f + a * px + b * py ), -2.0f, float( w + 1 ) );
+						const float sy = std::clamp( halfHeight * ( 1.0f - b * px + a * py ), -2.0f, float( h + 1 ) );
+						const float fx = floorf( sx ), fy = floorf( sy );
+						const int ix = int( fx ), iy = int( fy );
+						const float wx = sx - fx, wy = sy - fy;
+						const float texelWeights[ 4 ] = { ( 1.0f - wx ) * ( 1.0f - wy ), wx * ( 1.0f - wy ), ( 1.0f - wx ) * wy, wx * wy };
+						const float * channelWeights = weights + i * 4;
+						for ( int corner = 0; corner < 4; corner++ ) {
+							const int tx = ix + ( corner & 1 ), ty = iy + ( corner >> 1 );
+							if ( tx < 0 || ty < 0 || tx >= w || ty >= h ) continue; // zero, same as GetAtXY
+							const imageType * p = src + ( size_t( ty ) * width + tx ) * numChannels;
+							for ( int c = 0; c < numChannels; c++ ) {
+								accumulated[ c ] += texelWeights[ corner ] * channelWeights[ c ] * float( p[ c ] );
+							}
+						}
+					}
+					for ( int c = 0; c < numChannels; c++ ) {
+						if constexpr ( std::is_floating_point< imageType >::value ) {
+							out[ c ] = imageType( accumulated[ c ] );
+						} else {
+							out[ c ] = imageType( std::clamp( accumulated[ c ] + 0.5f, 0.0f, float( std::numeric_limits< imageType >::max() ) ) );
+						}
+					}
+				}
+			}
+		}, numThreads );
+	}
+
+	void BrownConradyLensDistortReference ( const float k1, const float k2, const float tangentialSkew, const bool normalize = false ) {
 		// create an identical copy of the data, since we will be overwriting the entire image
 		const Image2< imageType, numChannels > cachedCopy( width, height, GetImageDataBasePtr() );
 
@@ -611,12 +1378,8 @@ public:
 	// same as above, but combines multiple samples with strength increasing from 0 to the specified parameters in order to blur
 		// note that the MS versions of this function assume they have enough range to average across the N samples
 
-	void BrownConradyLensDistortMSBlurred ( const int iterations, const float k1, const float k2, const float t1, const bool normalize = false ) {
-		BrownConradyLensDistortMSBlurred( iterations, -k1, k1, -k2, k2, -t1, t1, normalize );
-	}
-
 	// pass zero as min values to get the old behavior
-	void BrownConradyLensDistortMSBlurred ( const int iterations,
+	void BrownConradyLensDistortMSBlurredReference ( const int iterations,
 		const float k1min, const float k1max,
 		const float k2min, const float k2max,
 		const float t1min, const float t1max,
@@ -662,11 +1425,7 @@ public:
 		}
 	}
 
-	void BrownConradyLensDistortMSBlurredChromatic ( const int iterations, const float k1, const float k2, const float t1 ) {
-		BrownConradyLensDistortMSBlurredChromatic( iterations, -k1, k1, -k2, k2, -t1, t1 );
-	}
-
-	void BrownConradyLensDistortMSBlurredChromatic ( const int iterations,
+	void BrownConradyLensDistortMSBlurredChromaticReference ( const int iterations,
 		const float k1min, const float k1max,
 		const float k2min, const float k2max,
 		const float t1min, const float t1max ) {
@@ -728,11 +1487,7 @@ public:
 		}
 	}
 
-	void BrownConradyLensDistortMSBlurredChromaticSmooth ( const int iterations, const float k1, const float k2, const float t1 ) {
-		BrownConradyLensDistortMSBlurredChromaticSmooth( iterations, -k1, k1, -k2, k2, -t1, t1 );
-	}
-
-	void BrownConradyLensDistortMSBlurredChromaticSmooth ( const int iterations,
+	void BrownConradyLensDistortMSBlurredChromaticSmoothReference ( const int iterations,
 		const float k1min, const float k1max,
 		const float k2min, const float k2max,
 		const float t1min, const float t1max ) {
@@ -787,11 +1542,7 @@ public:
 		}
 	}
 
-	void BrownConradyLensDistortMSBlurredChromaticNormalized ( const int iterations, const float k1, const float k2, const float t1 ) {
-		BrownConradyLensDistortMSBlurredChromaticNormalized( iterations, -k1, k1, -k2, k2, -t1, t1 );
-	}
-
-	void BrownConradyLensDistortMSBlurredChromaticNormalized ( const int iterations,
+	void BrownConradyLensDistortMSBlurredChromaticNormalizedReference ( const int iterations,
 		const float k1min, const float k1max,
 		const float k2min, const float k2max,
 		const float t1min, const float t1max ) {
@@ -1113,6 +1864,197 @@ private:
 	// image data
 	std::vector< imageType > data;
 
+//===== Pixel Sort Keys ===============================================================================================
+
+	// widens [ lo, hi ] to cover the channel / luma values of a float image - non-finite values are left to the clamp
+	static void PixelSortKeyRange ( const imageType * p, const size_t count, const pixelSortKey_t key, float &lo, float &hi ) {
+		auto value = [ p ] ( size_t i, int c ) -> float {
+			return ( c < numChannels ) ? float( p[ i * numChannels + c ] ) : 0.0f;
+		};
+		for ( size_t i = 0; i < count; i++ ) {
+			float v = value( i, int( key ) );
+			if ( key == pixelSortKey_t::LUMA ) {
+				const float r = value( i, 0 ), g = value( i, 1 ), b = value( i, 2 );
+				v = std::sqrt( r * r * 0.299f + g * g * 0.587f + b * b * 0.114f );
+			}
+			if ( std::isfinite( v ) ) {
+				lo = std::min( lo, v );
+				hi = std::max( hi, v );
+			}
+		}
+	}
+
+	// 16 bit keys, 0..65535 over [ keyLow, keyHigh ] of the channel / luma / hue / saturation - the key choice is hoisted
+		// out of the loop, and 8 bit luma goes through per channel tables. Hue and saturation always use [ 0, 1 ]
+	static void PixelSortKeys ( const imageType * p, const size_t count, const pixelSortKey_t key, uint16_t * keys, const float keyLow = 0.0f, const float keyHigh = 1.0f ) {
+		constexpr bool isUint = std::is_same< uint8_t, imageType >::value;
+		auto value = [ p ] ( size_t i, int c ) -> float {
+			if ( c >= numChannels ) return 0.0f;
+			return isUint ? p[ i * numChannels + c ] / 255.0f : float( p[ i * numChannels + c ] );
+		};
+		const bool widened = ( keyLow != 0.0f || keyHigh != 1.0f ) && key <= pixelSortKey_t::LUMA;
+		const float rangeLow = widened ? keyLow : 0.0f;
+		const float rangeScale = widened ? 1.0f / ( keyHigh - keyLow ) : 1.0f;
+		auto quantize = [ rangeLow, rangeScale ] ( float v ) -> uint16_t {
+			return uint16_t( std::clamp( ( v - rangeLow ) * rangeScale, 0.0f, 1.0f ) * 65535.0f + 0.5f );
+		};
+		switch ( key ) {
+			case pixelSortKey_t::RED:
+			case pixelSortKey_t::GREEN:
+			case pixelSortKey_t::BLUE:
+			case pixelSortKey_t::ALPHA:
+			{
+				const int c = int( key );
+				if ( c >= numChannels ) {
+					std::fill( keys, keys + count, uint16_t( 0 ) );
+				} else {
+					for ( size_t i = 0; i < count; i++ ) {
+						if constexpr ( isUint ) {
+							keys[ i ] = uint16_t( p[ i * numChannels + c ] * 257 );
+						} else {
+							keys[ i ] = quantize( float( p[ i * numChannels + c ] ) );
+						}
+					}
+				}
+				break;
+			}
+
+			case pixelSortKey_t::LUMA: // matches color::GetLuma
+			{
+				if constexpr ( isUint && numChannels >= 3 ) {
+					static const std::array< std::array< float, 256 >, 3 > weighted = [] () {
+						std::array< std::array< float, 256 >, 3 > tables;
+						const float scaleFactors[] = { 0.299f, 0.587f, 0.114f };
+						for ( int c = 0; c < 3; c++ ) {
+							for ( int v = 0; v < 256; v++ ) {
+								tables[ c ][ v ] = ( v / 255.0f ) * ( v / 255.0f ) * scaleFactors[ c ];
+							}
+						}
+						return tables;
+					} ();
+					for ( size_t i = 0; i < count; i++ ) {
+						const imageType * px = p + i * numChannels;
+						keys[ i ] = quantize( std::sqrt( weighted[ 0 ][ px[ 0 ] ] + weighted[ 1 ][ px[ 1 ] ] + weighted[ 2 ][ px[ 2 ] ] ) );
+					}
+				} else {
+					for ( size_t i = 0; i < count; i++ ) {
+						const float r = value( i, 0 ), g = value( i, 1 ), b = value( i, 2 );
+						keys[ i ] = quantize( std::sqrt( r * r * 0.299f + g * g * 0.587f + b * b * 0.114f ) );
+					}
+				}
+				break;
+			}
+
+			case pixelSortKey_t::HUE:
+			case pixelSortKey_t::SATURATION:
+			{
+				const bool saturation = ( key == pixelSortKey_t::SATURATION );
+				for ( size_t i = 0; i < count; i++ ) {
+					const float r = value( i, 0 ), g = value( i, 1 ), b = value( i, 2 );
+					const float maxValue = std::max( r, std::max( g, b ) );
+					const float chroma = maxValue - std::min( r, std::min( g, b ) );
+					if ( saturation ) {
+						keys[ i ] = quantize( ( maxValue > 0.0f ) ? chroma / maxValue : 0.0f );
+						continue;
+					}
+					float hue = 0.0f;
+					if ( chroma > 0.0f ) {
+						if ( maxValue == r ) {
+							hue = ( g - b ) / chroma;
+							if ( hue < 0.0f ) hue += 6.0f;
+						} else if ( maxValue == g ) {
+							hue = ( b - r ) / chroma + 2.0f;
+						} else {
+							hue = ( r - g ) / chroma + 4.0f;
+						}
+					}
+					keys[ i ] = quantize( hue / 6.0f );
+				}
+				break;
+			}
+
+			default:
+				std::fill( keys, keys + count, uint16_t( 0 ) );
+				break;
+		}
+	}
+
+//===== Resampling Passes =============================================================================================
+
+	// small images aren't worth the thread spawns
+	static uint32_t ResampleThreads ( const size_t pixels ) {
+		return ( pixels < ( 1u << 16 ) ) ? 1u : 0u;
+	}
+
+	static imageType ResampleStore ( const float value ) {
+		if constexpr ( std::is_floating_point< imageType >::value ) {
+			return imageType( value );
+		} else {
+			return imageType( std::clamp( value + 0.5f, 0.0f, float( std::numeric_limits< imageType >::max() ) ) );
+		}
+	}
+
+	// source rows -> scratch.rows, sourceHeight x destWidth, in float
+	static void ResampleHorizontal ( const imageType * source, const uint32_t sourceWidth, const uint32_t sourceHeight, const uint32_t destWidth, const resampleFilter_t filter, resampleScratch_t &scratch ) {
+		resampleAxis_t &axis = scratch.horizontal;
+		axis.Build( sourceWidth, destWidth, filter );
+		scratch.rows.resize( size_t( sourceHeight ) * destWidth * numChannels );
+		float * rows = scratch.rows.data();
+		const uint32_t taps = axis.taps;
+		parallelForRanges( sourceHeight, [ & ] ( size_t yBegin, size_t yEnd, uint32_t ) {
+			for ( size_t y = yBegin; y < yEnd; y++ ) {
+				const imageType * in = source + y * sourceWidth * numChannels;
+				float * out = rows + y * destWidth * numChannels;
+				for ( uint32_t x = 0; x < destWidth; x++ ) {
+					const imageType * span = in + axis.first[ x ] * numChannels;
+					const float * w = &axis.weights[ size_t( x ) * taps ];
+					float sum[ numChannels ] = {};
+					for ( uint32_t k = 0; k < taps; k++ ) {
+						for ( int c = 0; c < numChannels; c++ ) {
+							sum[ c ] += w[ k ] * float( span[ k * numChannels + c ] );
+						}
+					}
+					for ( int c = 0; c < numChannels; c++ ) {
+						out[ x * numChannels + c ] = sum[ c ];
+					}
+				}
+			}
+		}, ResampleThreads( size_t( sourceWidth ) * sourceHeight ) );
+	}
+
+	// scratch.rows -> dest, weighted sums of whole rows, so the inner loop is contiguous
+	static void ResampleVertical ( resampleScratch_t &scratch, const uint32_t sourceHeight, const uint32_t destWidth, const uint32_t destHeight, const resampleFilter_t filter, imageType * dest ) {
+		resampleAxis_t &axis = scratch.vertical;
+		axis.Build( sourceHeight, destHeight, filter );
+		const float * rows = scratch.rows.data();
+		const size_t rowLength = size_t( destWidth ) * numChannels;
+		const uint32_t taps = axis.taps;
+		parallelForRanges( destHeight, [ & ] ( size_t yBegin, size_t yEnd, uint32_t ) {
+			constexpr size_t block = 512; // accumulate a stretch of the row at a time, on the stack
+			float sum[ block ];
+			for ( size_t y = yBegin; y < yEnd; y++ ) {
+				const float * w = &axis.weights[ y * taps ];
+				const float * in = rows + size_t( axis.first[ y ] ) * rowLength;
+				imageType * out = dest + y * rowLength;
+				for ( size_t begin = 0; begin < rowLength; begin += block ) {
+					const size_t count = std::min( block, rowLength - begin );
+					std::fill( sum, sum + count, 0.0f );
+					for ( uint32_t k = 0; k < taps; k++ ) {
+						if ( w[ k ] == 0.0f ) continue;
+						const float weight = w[ k ];
+						const float * tapRow = in + k * rowLength + begin;
+						for ( size_t i = 0; i < count; i++ ) {
+							sum[ i ] += weight * tapRow[ i ];
+						}
+					}
+					for ( size_t i = 0; i < count; i++ ) {
+						out[ begin + i ] = ResampleStore( sum[ i ] );
+					}
+				}
+			}
+		}, ResampleThreads( size_t( destWidth ) * destHeight ) );
+	}
+
 //===== Loader Functions == ( Accessed via Load() ) ===================================================================
 
 	// this will handle a number of different file extensions ( png, jpg, etc )
@@ -1310,5 +2252,220 @@ typedef Image2< float, 1 >::color color_1F;
 typedef Image2< float, 4 > Image_4F;
 typedef Image2< float, 4 >::color color_4F;
 
+//===== Resample Benchmark ============================================================================================
+// 2x downsample time, and the PSNR of a down + up round trip, per filter vs stb_image_resize - plus a full mip chain
+struct resampleBenchmark_t {
+	uint32_t dim = 0;
+	uint32_t numThreads = 0;
+	double stbMs = 0.0;
+	double stbPSNR = 0.0;
+	static constexpr int numFilters = 4;
+	double filterMs[ numFilters ] = {};
+	double filterPSNR[ numFilters ] = {};
+	double stbMipMs = 0.0;		// repeated ResizeSTB( 0.5f ), down to 1x1
+	double mipChainMs = 0.0;	// BuildMipChain, box
+};
+
+inline resampleBenchmark_t ResampleBenchmark ( const uint32_t dim ) {
+	resampleBenchmark_t result;
+	result.dim = dim;
+	result.numThreads = parallelThreadCount();
+
+	// a couple octaves of sinusoids, well under the half-resolution nyquist limit, so the round trip can recover them
+	Image_4F source( dim, dim );
+	for ( uint32_t y = 0; y < dim; y++ ) {
+		for ( uint32_t x = 0; x < dim; x++ ) {
+			const float u = float( x ) / dim, v = float( y ) / dim;
+			source.SetAtXY( x, y, color_4F( {
+				0.5f + 0.25f * std::sin( u * 40.0f + v * 13.0f ) + 0.2f * std::sin( v * 90.0f ),
+				0.5f + 0.45f * std::cos( ( u * u + v * v ) * 60.0f ),
+				u * v,
+				1.0f } ) );
+		}
+	}
+
+	using clock = std::chrono::steady_clock;
+	auto msSince = [] ( clock::time_point start ) { return std::chrono::duration< double, std::milli >( clock::now() - start ).count(); };
+	auto psnr = [ & ] ( const Image_4F &image ) {
+		double squaredError = 0.0;
+		const float * a = source.GetImageDataBasePtr();
+		const float * b = image.GetImageDataBasePtr();
+		const size_t count = size_t( dim ) * dim * 4;
+		for ( size_t i = 0; i < count; i++ ) {
+			squaredError += double( a[ i ] - b[ i ] ) * double( a[ i ] - b[ i ] );
+		}
+		return 10.0 * std::log10( 1.0 / std::max( squaredError / count, 1e-20 ) );
+	};
+
+	{
+		Image_4F image( source );
+		const auto start = clock::now();
+		image.ResizeSTB( 0.5f, 0.5f );
+		result.stbMs = msSince( start );
+		image.ResizeSTB( 2.0f, 2.0f );
+		result.stbPSNR = psnr( image );
+	}
+
+	const resampleFilter_t filters[ resampleBenchmark_t::numFilters ] = { resampleFilter_t::BOX, resampleFilter_t::TENT, resampleFilter_t::LANCZOS3, resampleFilter_t::MITCHELL };
+	for ( int f = 0; f < resampleBenchmark_t::numFilters; f++ ) {
+		Image_4F image( source );
+		image.ResizeTo( dim, dim, filters[ f ] ); // warm up the scratch, so the timing is the steady state
+		const auto start = clock::now();
+		image.ResizeTo( dim / 2, dim / 2, filters[ f ] );
+		result.filterMs[ f ] = msSince( start );
+		image.ResizeTo( dim, dim, filters[ f ] );
+		result.filterPSNR[ f ] = psnr( image );
+	}
+
+	{
+		Image_4F image( source );
+		const auto start = clock::now();
+		while ( image.Width() > 1 ) {
+			image.ResizeSTB( 0.5f, 0.5f );
+		}
+		result.stbMipMs = msSince( start );
+	}
+
+	{
+		Image_4F::mipChain_t chain;
+		source.BuildMipChain( chain );
+		const auto start = clock::now();
+		source.BuildMipChain( chain );
+		result.mipChainMs = msSince( start );
+	}
+	return result;
+}
+
+//===== Pixel Sort Benchmark ==========================================================================================
+// comparison sort of whole columns vs the radix engine on the same columns, then thresholded intervals at an angle
+struct pixelSortBenchmark_t {
+	uint32_t width = 0, height = 0;
+	uint32_t numThreads = 0;
+	double referenceMs = 0.0;	// PixelSortReference, luma
+	double columnsMs = 0.0;		// radix, luma, same whole columns
+	double angledMs = 0.0;		// radix, hue, 30 degrees, thresholded intervals
+	bool matches = false;		// whole column keys come out in the same order as the reference
+};
+
+inline pixelSortBenchmark_t PixelSortBenchmark ( const uint32_t width, const uint32_t height ) {
+	pixelSortBenchmark_t result;
+	result.width = width;
+	result.height = height;
+	result.numThreads = parallelThreadCount();
+
+	Image_4U source( width, height );
+	std::mt19937 gen( 42 );
+	for ( uint32_t y = 0; y < height; y++ ) {
+		for ( uint32_t x = 0; x < width; x++ ) {
+			const uint32_t noise = gen();
+			source.SetAtXY( x, y, color_4U( { uint8_t( ( x * 255 ) / width ^ ( noise & 0x3F ) ), uint8_t( ( y * 255 ) / height ), uint8_t( noise >> 8 ), 255 } ) );
+		}
+	}
+
+	using clock = std::chrono::steady_clock;
+	auto msSince = [] ( clock::time_point start ) { return std::chrono::duration< double, std::milli >( clock::now() - start ).count(); };
+
+	Image_4U reference( source );
+	auto start = clock::now();
+	reference.PixelSortReference( 0, 4 );
+	result.referenceMs = msSince( start );
+
+	Image_4U columns( source );
+	columns.PixelSort( pixelSortParams_t() ); // grow the scratch, so the timings are the steady state
+	columns = source;
+	pixelSortParams_t params;
+	params.angle = 90.0f;
+	start = clock::now();
+	columns.PixelSort( params );
+	result.columnsMs = msSince( start );
+
+	// the comparison sort isn't stable, so compare the keys rather than the pixels
+	result.matches = true;
+	for ( uint32_t y = 0; y < height && result.matches; y++ ) {
+		for ( uint32_t x = 0; x < width; x++ ) {
+			const float a = reference.GetAtXY( x, y ).GetLuma(), b = columns.GetAtXY( x, y ).GetLuma();
+			if ( std::abs( a - b ) > 1.0f / 65535.0f * 2.0f ) {
+				result.matches = false;
+				break;
+			}
+		}
+	}
+
+	Image_4U angled( source );
+	params.key = pixelSortKey_t::HUE;
+	params.angle = 30.0f;
+	params.thresholdLow = 0.2f;
+	params.thresholdHigh = 0.8f;
+	start = clock::now();
+	angled.PixelSort( params );
+	result.angledMs = msSince( start );
+
+	return result;
+}
+
+//===== Lens Warp Benchmark ===========================================================================================
+// chromatic multisample distort on a noise image, per-pixel reference vs the warp field - build, and cached apply
+struct lensWarpBenchmark_t {
+	uint32_t dim = 0;
+	int iterations = 0;
+	uint32_t numThreads = 0;
+	double referenceMs = 0.0;
+	double buildMs = 0.0;
+	double applyMs = 0.0;
+	float maxError = 0.0f;	// largest per-channel difference from the reference
+};
+
+inline lensWarpBenchmark_t LensWarpBenchmark ( const uint32_t dim, const int iterations ) {
+	lensWarpBenchmark_t result;
+	result.dim = dim;
+	result.iterations = iterations;
+	result.numThreads = parallelThreadCount();
+
+	Image_4F source( dim, dim );
+	std::mt19937 gen( 1337 );
+	std::uniform_real_distribution< float > dist( 0.0f, 1.0f );
+	for ( uint32_t y = 0; y < dim; y++ ) {
+		for ( uint32_t x = 0; x < dim; x++ ) {
+			source.SetAtXY( x, y, color_4F( { dist( gen ), dist( gen ), dist( gen ), 1.0f } ) );
+		}
+	}
+
+	const float k1 = 0.3f, k2 = 0.2f, t1 = 0.1f;
+	using clock = std::chrono::steady_clock;
+	auto msSince = [] ( clock::time_point start ) { return std::chrono::duration< double, std::milli >( clock::now() - start ).count(); };
+
+	Image_4F reference( source );
+	auto start = clock::now();
+	reference.BrownConradyLensDistortMSBlurredChromaticReference( iterations, -k1, k1, -k2, k2, -t1, t1 );
+	result.referenceMs = msSince( start );
+
+	lensWarpParams_t params;
+	params.width = params.height = dim;
+	params.iterations = iterations;
+	params.k1min = -k1; params.k1max = k1;
+	params.k2min = -k2; params.k2max = k2;
+	params.t1min = -t1; params.t1max = t1;
+	params.weighting = lensWeighting_t::CHROMATIC;
+	start = clock::now();
+	const lensWarpField_t field( params );
+	result.buildMs = msSince( start );
+
+	Image_4F warped( source );
+	start = clock::now();
+	warped.LensWarp( field );
+	result.applyMs = msSince( start );
+
+	for ( uint32_t y = 0; y < dim; y++ ) {
+		for ( uint32_t x = 0; x < dim; x++ ) {
+			const color_4F a = reference.GetAtXY( x, y );
+			const color_4F b = warped.GetAtXY( x, y );
+			for ( int c = 0; c < 4; c++ ) {
+				result.maxError = std::max( result.maxError, std::abs( a[ c ] - b[ c ] ) );
+			}
+		}
+	}
+	return result;
+}
+
 
 #endif // IMAGE2_H
\ No newline at end of file
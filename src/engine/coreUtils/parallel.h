@@ -0,0 +1,60 @@
+#pragma once
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "profiler.h"
+
+// small helpers for splitting CPU work across std::threads - one thread per core, spawned per call, same
+	// as the worker thread setup in the BVH test. This is meant for coarse chunks of work ( row bands, tiles ),
+	// where the thread spawn cost is noise compared to the work being done.
+
+inline uint32_t parallelThreadCount () {
+	return std::max( 1u, std::thread::hardware_concurrency() );
+}
+
+// split [ 0, count ) into contiguous ranges, one per thread - func( begin, end, threadIndex )
+template < typename func_t >
+inline void parallelForRanges ( const size_t count, func_t func, uint32_t numThreads = 0 ) {
+	if ( numThreads == 0 ) numThreads = parallelThreadCount();
+	numThreads = uint32_t( std::max( size_t( 1 ), std::min( size_t( numThreads ), count ) ) );
+	if ( numThreads == 1 ) { // skip the spawn entirely
+		if ( count ) func( size_t( 0 ), count, 0u );
+		return;
+	}
+	std::vector< std::thread > threads;
+	threads.reserve( numThreads );
+	for ( uint32_t t = 0; t < numThreads; t++ ) {
+		const size_t begin = ( count * t ) / numThreads;
+		const size_t end = ( count * ( t + 1 ) ) / numThreads;
+		threads.emplace_back( [ = ] () {
+			PROFILE_SCOPE( "parallel worker" );
+			func( begin, end, t );
+		} );
+	}
+	for ( auto& thread : threads ) thread.join();
+}
+
+// dynamic distribution of [ 0, count ) in chunks of grainSize, off of an atomic counter - func( index, threadIndex )
+template < typename func_t >
+inline void parallelForDynamic ( const size_t count, func_t func, const size_t grainSize = 1, uint32_t numThreads = 0 ) {
+	if ( numThreads == 0 ) numThreads = parallelThreadCount();
+	std::atomic< size_t > counter { 0 };
+	parallelForRanges( numThreads, [ & ] ( size_t, size_t, uint32_t threadIndex ) {
+		while ( true ) {
+			const size_t begin = counter.fetch_add( grainSize );
+			if ( begin >= count ) break;
+			const size_t end = std::min( begin + grainSize, count );
+			for ( size_t i = begin; i < end; i++ ) {
+				func( i, threadIndex );
+			}
+		}
+	}, numThreads );
+}
+
+#endif // PARALLEL_H
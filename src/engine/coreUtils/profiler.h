@@ -0,0 +1,423 @@
+#pragma once
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+	#include <x86intrin.h>
+	#define PROFILER_RDTSC
+#elif defined( _M_X64 )
+	#include <intrin.h>
+	#define PROFILER_RDTSC
+#endif
+
+// hierarchical CPU scope recorder, no Tracy needed - works on any thread, including the parallelFor workers:
+	//	- labels are interned once per call site, scopes only carry a 32-bit id
+	//	- each thread writes complete scopes into its own preallocated ring, nothing is locked or allocated on the
+	//		recording side. Recorders are claimed from a fixed pool, and handed back when their thread exits
+	//	- Collect() drains the rings once a frame into rolling per-label stats ( p50 / p99 ), and optionally into a
+	//		trace capture, which is written out as Chrome trace JSON ( chrome://tracing, ui.perfetto.dev )
+
+namespace cpuProfiler {
+
+constexpr uint32_t maxLabels = 1024;
+constexpr uint32_t maxThreads = 128;
+constexpr uint32_t ringSize = 1u << 14;		// scopes per thread between collections, less one - power of two
+constexpr uint32_t statWindow = 256;		// most recent samples kept per label, for the percentiles
+
+//===== Timestamps ====================================================================================================
+// raw timestamp - the TSC where there is one, converted to nanoseconds only when collecting
+inline uint64_t Ticks () {
+#ifdef PROFILER_RDTSC
+	return __rdtsc();
+#else
+	return uint64_t( std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+#endif
+}
+
+struct tickClock_t {
+	uint64_t baseTicks;
+	std::chrono::steady_clock::time_point baseTime;
+	double nsPerTick = 1.0;
+
+	tickClock_t () : baseTicks( Ticks() ), baseTime( std::chrono::steady_clock::now() ) {}
+
+	// refit the tick rate against steady_clock, over everything since startup - gets more accurate the longer it runs
+	void Calibrate () {
+#ifdef PROFILER_RDTSC
+		std::chrono::steady_clock::time_point now;
+		uint64_t ticks;
+		do { // the first time, make sure there's a long enough interval to get a sane ratio
+			now = std::chrono::steady_clock::now();
+			ticks = Ticks();
+		} while ( now - baseTime < std::chrono::milliseconds( 5 ) );
+		nsPerTick = std::chrono::duration< double, std::nano >( now - baseTime ).count() / double( ticks - baseTicks );
+#endif
+	}
+
+	double Nanoseconds ( const uint64_t ticks ) const {
+		return double( int64_t( ticks - baseTicks ) ) * nsPerTick;
+	}
+};
+
+inline tickClock_t &Clock () {
+	static tickClock_t clock;
+	return clock;
+}
+
+//===== Labels ========================================================================================================
+// append-only table - lookups don't lock, only adding a new label does. Ids are stable for the life of the program
+struct labelTable_t {
+	static constexpr uint32_t tableSize = maxLabels * 2;
+	std::mutex insertLock;
+	std::atomic< uint32_t > count { 0 };
+	std::string names[ maxLabels ];
+	std::atomic< uint32_t > slots[ tableSize ];	// label id + 1, zero is empty
+
+	labelTable_t () {
+		for ( auto& slot : slots ) slot.store( 0, std::memory_order_relaxed );
+	}
+
+	static uint32_t Hash ( const char * name, const size_t length ) {
+		uint32_t h = 2166136261u; // FNV-1a
+		for ( size_t i = 0; i < length; i++ ) {
+			h = ( h ^ uint8_t( name[ i ] ) ) * 16777619u;
+		}
+		return h;
+	}
+
+	// returns the slot holding name, or the empty slot where it would go
+	uint32_t Find ( const char * name, const size_t length, const uint32_t hash, uint32_t &id ) const {
+		uint32_t slot = hash & ( tableSize - 1 );
+		while ( true ) {
+			const uint32_t entry = slots[ slot ].load( std::memory_order_acquire );
+			if ( entry == 0 ) { id = 0; return slot; }
+			const std::string &candidate = names[ entry - 1 ];
+			if ( candidate.size() == length && memcmp( candidate.data(), name, length ) == 0 ) { id = entry; return slot; }
+			slot = ( slot + 1 ) & ( tableSize - 1 );
+		}
+	}
+
+	uint32_t Intern ( const char * name, const size_t length ) {
+		const uint32_t hash = Hash( name, length );
+		uint32_t id;
+		Find( name, length, hash, id );
+		if ( id != 0 ) return id - 1;
+
+		std::lock_guard< std::mutex > lock( insertLock );
+		const uint32_t slot = Find( name, length, hash, id ); // someone may have beaten us to it
+		if ( id != 0 ) return id - 1;
+		const uint32_t index = count.load( std::memory_order_relaxed );
+		if ( index == maxLabels - 1 ) { // last one is reserved as the catch-all
+			if ( names[ index ].empty() ) names[ index ] = "( label table full )";
+			return index;
+		}
+		names[ index ].assign( name, length );
+		count.store( index + 1, std::memory_order_release );
+		slots[ slot ].store( index + 1, std::memory_order_release ); // name is written before it can be found
+		return index;
+	}
+};
+
+inline labelTable_t &Labels () {
+	static labelTable_t labels;
+	return labels;
+}
+
+inline uint32_t Intern ( const char * name ) { return Labels().Intern( name, strlen( name ) ); }
+inline uint32_t Intern ( const std::string &name ) { return Labels().Intern( name.data(), name.size() ); }
+inline const std::string &LabelName ( const uint32_t label ) { return Labels().names[ label ]; }
+
+//===== Per-Thread Recording ==========================================================================================
+struct event_t {
+	uint64_t start;
+	uint64_t end;
+	uint32_t label;
+	uint32_t depth;		// nesting level on its thread, 0 is outermost
+};
+
+struct threadRecorder_t {
+	std::atomic< bool > claimed { false };
+	uint32_t slot = 0;				// thread index in the trace - stays with the recorder, not the OS thread
+	uint32_t depth = 0;
+	std::atomic< uint64_t > written { 0 };	// scopes ever written, only the owning thread stores this
+	uint64_t read = 0;				// scopes ever consumed, only touched while collecting
+	event_t events[ ringSize ];
+};
+
+struct registry_t {
+	std::atomic< bool > enabled { true };
+	std::atomic< uint32_t > count { 0 };
+	std::atomic< threadRecorder_t * > recorders[ maxThreads ];
+
+	registry_t () {
+		for ( auto& recorder : recorders ) recorder.store( nullptr, std::memory_order_relaxed );
+	}
+
+	// reuse a recorder left behind by an exited thread, or make a new one - new ones are only needed when more
+		// threads are alive at once than ever before, so this settles to zero allocations
+	threadRecorder_t * Claim () {
+		const uint32_t existing = std::min( count.load( std::memory_order_acquire ), maxThreads );
+		for ( uint32_t i = 0; i < existing; i++ ) {
+			threadRecorder_t * recorder = recorders[ i ].load( std::memory_order_acquire );
+			bool expected = false;
+			if ( recorder && recorder->claimed.compare_exchange_strong( expected, true, std::memory_order_acq_rel ) ) {
+				return recorder;
+			}
+		}
+		const uint32_t slot = count.fetch_add( 1, std::memory_order_acq_rel );
+		if ( slot >= maxThreads ) return nullptr; // out of slots, this thread goes unrecorded
+		threadRecorder_t * recorder = new threadRecorder_t();
+		recorder->slot = slot;
+		recorder->claimed.store( true, std::memory_order_relaxed );
+		recorders[ slot ].store( recorder, std::memory_order_release );
+		return recorder;
+	}
+};
+
+inline registry_t &Registry () {
+	static registry_t registry;
+	return registry;
+}
+
+// hands the recorder back when the thread exits - unread scopes stay in the ring until the next collection
+struct threadHandle_t {
+	threadRecorder_t * recorder = nullptr;
+	bool tried = false;
+	~threadHandle_t () {
+		if ( recorder ) {
+			recorder->depth = 0;
+			recorder->claimed.store( false, std::memory_order_release );
+		}
+	}
+};
+
+inline threadRecorder_t * ThreadRecorder () {
+	thread_local threadHandle_t handle;
+	if ( !handle.tried ) {
+		handle.tried = true;
+		handle.recorder = Registry().Claim();
+	}
+	return handle.recorder;
+}
+
+// RAII scope - use through PROFILE_SCOPE, so the label is only interned once per call site
+class scope_t {
+public:
+	scope_t ( const uint32_t labelIn ) : label( labelIn ) {
+		recorder = Registry().enabled.load( std::memory_order_relaxed ) ? ThreadRecorder() : nullptr;
+		if ( recorder ) {
+			depth = recorder->depth++;
+			start = Ticks();
+		}
+	}
+	~scope_t () {
+		if ( recorder ) {
+			const uint64_t end = Ticks();
+			recorder->depth--;
+			const uint64_t w = recorder->written.load( std::memory_order_relaxed );
+			recorder->events[ w & ( ringSize - 1 ) ] = { start, end, label, depth };
+			recorder->written.store( w + 1, std::memory_order_release );
+		}
+	}
+	scope_t ( const scope_t & ) = delete;
+	scope_t &operator = ( const scope_t & ) = delete;
+
+private:
+	threadRecorder_t * recorder;
+	uint64_t start = 0;
+	uint32_t label;
+	uint32_t depth = 0;
+};
+
+#define PROFILE_CONCAT_INNER( a, b ) a##b
+#define PROFILE_CONCAT( a, b ) PROFILE_CONCAT_INNER( a, b )
+#define PROFILE_SCOPE( name ) \
+	static const uint32_t PROFILE_CONCAT( profileLabel_, __LINE__ ) = cpuProfiler::Intern( name ); \
+	cpuProfiler::scope_t PROFILE_CONCAT( profileScope_, __LINE__ ) ( PROFILE_CONCAT( profileLabel_, __LINE__ ) )
+
+//===== Collection ====================================================================================================
+struct labelStats_t {
+	float samples[ statWindow ];	// ring of the most recent durations, in ms
+	uint32_t next = 0;
+	uint64_t count = 0;
+	double totalMs = 0.0;
+	float maxMs = 0.0f;
+
+	void Add ( const float ms ) {
+		samples[ next ] = ms;
+		next = ( next + 1 ) % statWindow;
+		count++;
+		totalMs += ms;
+		maxMs = std::max( maxMs, ms );
+	}
+
+	// p50 / p99 over the window
+	void Percentiles ( float &p50, float &p99 ) const {
+		const uint32_t n = uint32_t( std::min( count, uint64_t( statWindow ) ) );
+		p50 = p99 = 0.0f;
+		if ( n == 0 ) return;
+		float sorted[ statWindow ];
+		std::copy( samples, samples + n, sorted );
+		std::nth_element( sorted, sorted + n / 2, sorted + n );
+		p50 = sorted[ n / 2 ];
+		const uint32_t i99 = std::min( n - 1, uint32_t( n * 0.99f ) );
+		std::nth_element( sorted, sorted + i99, sorted + n );
+		p99 = sorted[ i99 ];
+	}
+};
+
+struct capturedEvent_t {
+	event_t event;
+	uint32_t thread;
+};
+
+struct collector_t {
+	std::mutex lock;
+	labelStats_t stats[ maxLabels ];
+	uint64_t frames = 0;
+	uint64_t collected = 0;
+	uint64_t dropped = 0;		// overwritten before they could be read
+	uint32_t collectingThread = 0;	// recorder slot of the thread calling Collect(), named "main" in the trace
+
+	// trace capture, sized up front
+	std::vector< capturedEvent_t > capture;
+	size_t captureCapacity = 0;
+	uint32_t captureFramesLeft = 0;
+	std::string capturePath;
+	std::string lastTracePath;	// written by the last finished capture
+
+	bool Capturing () const { return captureCapacity != 0; }
+
+	void Collect () {
+		std::lock_guard< std::mutex > guard( lock );
+		if ( threadRecorder_t * self = ThreadRecorder() ) collectingThread = self->slot;
+		Clock().Calibrate();
+		const double msPerTick = Clock().nsPerTick * 1e-6;
+		registry_t &registry = Registry();
+		const uint32_t numRecorders = std::min( registry.count.load( std::memory_order_acquire ), maxThreads );
+		for ( uint32_t r = 0; r < numRecorders; r++ ) {
+			threadRecorder_t * recorder = registry.recorders[ r ].load( std::memory_order_acquire );
+			if ( !recorder ) continue;
+			const uint64_t written = recorder->written.load( std::memory_order_acquire );
+			// a full ring back is already unsafe - the writer's next scope goes into that slot, possibly while it's read
+			if ( written - recorder->read >= ringSize ) { // lapped, the oldest ones are gone
+				dropped += written - recorder->read - ( ringSize - 1 );
+				recorder->read = written - ( ringSize - 1 );
+			}
+			for ( ; recorder->read < written; recorder->read++ ) {
+				const event_t e = recorder->events[ recorder->read & ( ringSize - 1 ) ];
+				// the writer keeps going while this reads - if it came back around to this slot, the copy can be torn
+				if ( recorder->written.load( std::memory_order_acquire ) - recorder->read >= ringSize ) {
+					dropped++;
+					continue;
+				}
+				stats[ e.label ].Add( float( double( e.end - e.start ) * msPerTick ) );
+				if ( Capturing() && capture.size() < captureCapacity ) {
+					capture.push_back( { e, recorder->slot } );
+				}
+				collected++;
+			}
+		}
+		frames++;
+		if ( Capturing() && ( --captureFramesLeft == 0 || capture.size() == captureCapacity ) ) {
+			WriteChromeTrace( capturePath );
+			lastTracePath = capturePath;
+			captureCapacity = 0;
+			capture = std::vector< capturedEvent_t >();
+		}
+	}
+
+	// starts recording scopes into the capture, written to path after the given number of Collect() calls
+	void StartCapture ( const uint32_t numFrames, const std::string &path, const size_t maxEvents = 1u << 20 ) {
+		std::lock_guard< std::mutex > guard( lock );
+		capture.clear();
+		capture.reserve( maxEvents );
+		captureCapacity = maxEvents;
+		captureFramesLeft = std::max( 1u, numFrames );
+		capturePath = path;
+	}
+
+	// Chrome trace event format, complete ( "X" ) events in microseconds - caller holds the lock
+	bool WriteChromeTrace ( const std::string &path ) const {
+		std::ofstream out( path );
+		if ( !out.is_open() ) return false;
+		auto escaped = [] ( const std::string &s ) {
+			std::string result;
+			for ( const char c : s ) {
+				if ( c == '"' || c == '\\' ) result += '\\';
+				if ( uint8_t( c ) >= 0x20 ) result += c;
+			}
+			return result;
+		};
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		bool first = true;
+		std::vector< bool > namedThread( maxThreads, false );
+		for ( auto& c : capture ) {
+			if ( !namedThread[ c.thread ] ) {
+				namedThread[ c.thread ] = true;
+				out << ( first ? "" : ",\n" ) << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << c.thread
+					<< ",\"args\":{\"name\":\"" << ( c.thread == collectingThread ? std::string( "main" ) : "thread " + std::to_string( c.thread ) ) << "\"}}";
+				first = false;
+			}
+			const double startUs = Clock().Nanoseconds( c.event.start ) * 1e-3;
+			const double durationUs = double( c.event.end - c.event.start ) * Clock().nsPerTick * 1e-3;
+			out << ( first ? "" : ",\n" ) << "{\"name\":\"" << escaped( LabelName( c.event.label ) ) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << c.thread
+				<< ",\"ts\":" << startUs << ",\"dur\":" << durationUs << ",\"args\":{\"depth\":" << c.event.depth << "}}";
+			first = false;
+		}
+		out << "\n]}\n";
+		return out.good();
+	}
+};
+
+inline collector_t &Collector () {
+	static collector_t collector;
+	return collector;
+}
+
+// once per frame, on the main thread - also fine to call from a headless loop
+inline void Collect () { Collector().Collect(); }
+
+// nanoseconds per raw timestamp read - every scope takes two, which sets the floor for MeasureOverhead()
+inline double TimestampCost ( const uint32_t iterations ) {
+	uint64_t sum = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for ( uint32_t i = 0; i < iterations; i++ ) {
+		sum += Ticks();
+	}
+	const double ns = std::chrono::duration< double, std::nano >( std::chrono::steady_clock::now() - start ).count();
+	return ( sum == 0 ) ? 0.0 : ns / std::max( 1u, iterations );
+}
+
+// nanoseconds per empty scope, recorded on the calling thread - these don't go to the stats
+inline double MeasureOverhead ( const uint32_t iterations ) {
+	static const uint32_t label = Intern( "profiler overhead" );
+	threadRecorder_t * recorder = ThreadRecorder();
+	Collect(); // flush what's pending, so it isn't thrown out below
+	const auto start = std::chrono::steady_clock::now();
+	for ( uint32_t i = 0; i < iterations; i++ ) {
+		scope_t outer( label );
+		scope_t inner( label );
+	}
+	const double ns = std::chrono::duration< double, std::nano >( std::chrono::steady_clock::now() - start ).count();
+	if ( recorder ) { // skip everything just written
+		std::lock_guard< std::mutex > guard( Collector().lock );
+		recorder->read = recorder->written.load( std::memory_order_acquire );
+	}
+	return ns / ( 2.0 * std::max( 1u, iterations ) );
+}
+
+}
+
+#endif // PROFILER_H
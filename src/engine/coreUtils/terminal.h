@@ -1,4 +1,5 @@
 #include "../includes.h"
+#include <memory>
 
 struct cChar {
 	unsigned char data[ 4 ] = { 255, 255, 255, 0 };
@@ -236,19 +237,35 @@ struct cvarManager_t {
 	var_t dummyVar;
 	std::vector< var_t > vars;
 
+	// label -> index in vars, so lookup is not a scan over every cvar
+	std::unordered_map< string, int > lookup;
+
 	void add ( var_t var ) {
+		lookup.emplace( var.label, int( vars.size() ) ); // first one added wins, same as the scan did
 		vars.push_back( var );
 	}
 
-	// operator to get by string
-	var_t& operator[] ( string label ) {
+	// index of the cvar with this label, or -1 - stable, since vars only grows
+	int find ( const string &label ) const {
+		auto it = lookup.find( label );
+		return ( it == lookup.end() ) ? -1 : it->second;
+	}
+
+	// the old linear scan, kept for comparison in the terminal benchmark
+	int findLinear ( const string &label ) const {
 		for ( uint i = 0; i < vars.size(); i++ ) {
 			if ( vars[ i ].label == label ) {
-				return vars[ i ];
+				return int( i );
 			}
 		}
+		return -1;
+	}
+
+	// operator to get by string
+	var_t& operator[] ( const string &label ) {
+		const int i = find( label );
 		// mostly just for warning supression...
-		return dummyVar;
+		return ( i == -1 ) ? dummyVar : vars[ i ];
 	}
 
 	// operator to get by index
@@ -261,16 +278,26 @@ struct cvarManager_t {
 	}
 
 	// does this string refer to a valid cvar?
-	bool isValid ( string label ) {
-		for ( uint i = 0; i < vars.size(); i++ ) {
-			if ( vars[ i ].label == label ) {
-				return true;
-			}
-		}
-		return false;
+	bool isValid ( const string &label ) const {
+		return find( label ) != -1;
 	}
 };
 
+// a command file, parsed once - each instruction is a command index plus its already parsed arguments, so
+	// replaying it skips the lookup and the parse. "$cvar" arguments are kept as cvar indices and read when the
+	// instruction runs, since earlier instructions in the script may have assigned to them.
+struct terminalScript_t {
+	struct instruction_t {
+		int commandIdx;
+		args_t args;
+		std::vector< std::pair< int, int > > cvarRefs; // ( argument index, cvar index )
+		int line;
+	};
+	std::vector< instruction_t > instructions;
+	std::vector< string > errors;
+	size_t numLines = 0;
+};
+
 struct terminal_t {
 
 	// eventually move this stuff onto a struct:
@@ -295,8 +322,8 @@ struct terminal_t {
 	coloredStringBuilder csb;
 
 	// tracking if we need to rebuild the list of strings for tab completion
-	DictionaryTrie * trie = new DictionaryTrie();
-	DictionaryTrie * trieCvar = new DictionaryTrie();
+	std::unique_ptr< DictionaryTrie > trie = std::make_unique< DictionaryTrie >();
+	std::unique_ptr< DictionaryTrie > trieCvar = std::make_unique< DictionaryTrie >();
 
 	// corresponding flat vector, all the strings that got added to that acceleration structure
 	std::vector< string > allStrings;
@@ -329,8 +356,7 @@ struct terminal_t {
 
 			// add this also to the list of all strings, and alphabetize (for reporting on tab complete with empty input prompt)
 			// allStrings.push_back( string( "$" ) + label );
-			allStrings.push_back( label );
-			sort( allStrings.begin(), allStrings.end() );
+			allStrings.insert( std::lower_bound( allStrings.begin(), allStrings.end(), label ), label );
 		}
 	}
 
@@ -345,6 +371,16 @@ struct terminal_t {
 		// ...
 
 	std::vector< command_t > commands;
+
+	// command label or alias -> indices into commands, one per overload
+	std::unordered_map< string, std::vector< int > > commandLookup;
+
+	// nullptr if there is no command with this label
+	const std::vector< int > * findCommand ( const string &label ) const {
+		auto it = commandLookup.find( label );
+		return ( it == commandLookup.end() ) ? nullptr : &it->second;
+	}
+
 	void addCommand ( std::vector< string > commandAndOptionalAliases_in,
 		std::vector< var_t > argumentList_in,
 		std::function< void( args_t args ) > func_in,
@@ -357,23 +393,24 @@ struct terminal_t {
 			command.func = func_in;
 			command.description = description_in;
 
+			// index this command under each of its names - overloads share a name, and keep registration order
+			for ( auto& label : commandAndOptionalAliases_in ) {
+				commandLookup[ label ].push_back( int( commands.size() ) );
+			}
 			commands.push_back( command );
 
 			// add command names - I think, for the report, at least, we want to deduplicate these... if you encounter it already in the list, skip adding it again
 			for ( uint i = 0; i < commandAndOptionalAliases_in.size(); i++ ) {
 
-				bool foundAlreadyInList = false;
-				for ( auto& s : allStrings )
-					if ( s == commandAndOptionalAliases_in[ i ] )
-						foundAlreadyInList = true;
+				// allStrings is kept sorted
+				const bool foundAlreadyInList = std::binary_search( allStrings.begin(), allStrings.end(), commandAndOptionalAliases_in[ i ] );
 
 				if ( !foundAlreadyInList ) {
 					// add it to the autocomplete list
 					trie->insert( commandAndOptionalAliases_in[ i ], 100 );
 
 					// add this also to the list of all strings, and alphabetize (for reporting on tab complete with empty input prompt)
-					allStrings.push_back( commandAndOptionalAliases_in[ i ] );
-					sort( allStrings.begin(), allStrings.end() );
+					allStrings.insert( std::lower_bound( allStrings.begin(), allStrings.end(), commandAndOptionalAliases_in[ i ] ), commandAndOptionalAliases_in[ i ] );
 				}
 			}
 	}
@@ -397,6 +434,40 @@ struct terminal_t {
 				csb.selectedPalette = int( args[ "select" ].data.x );
 			}, "Numbered presets (0-3)." );
 
+		// command files - parsed once up front, then replayed without any string matching
+		addCommand( { "runScript" }, {
+				{ "path", STRING, "Path to a file with one command per line." }
+			}, [=] ( args_t args ) {
+				terminalScript_t script;
+				if ( loadScript( args[ "path" ].stringData, script ) ) {
+					runScript( script );
+					addHistoryLine( csb.append( "  ran " + to_string( script.instructions.size() ) + " commands from " + args[ "path" ].stringData ).flush() );
+				} else {
+					for ( auto& error : script.errors ) {
+						addHistoryLine( csb.append( "  Error: ", 4 ).append( error, 3 ).flush() );
+					}
+				}
+			}, "Compile and run a file of terminal commands." );
+
+		addCommand( { "terminalBenchmark" }, {
+				{ "count", INT, "How many lines to dispatch through each path." }
+			}, [=] ( args_t args ) {
+				const benchmarkResult_t result = benchmark( size_t( std::max( 1, int( args[ "count" ].data.x ) ) ) );
+				auto report = [ & ] ( const string &label, const double ms ) {
+					addHistoryLine( csb.append( "  " + label, 2 ).append( to_string( ms ) + "ms", 1 ).append( " ( " + to_string( ms * 1000000.0 / result.numCommands ) + "ns per line )" ).flush() );
+				};
+				addHistoryLine( csb.append( "  " + to_string( result.numCommands ) + " lines, 400 commands, 200 cvars" ).flush() );
+				report( "legacy dispatch:  ", result.legacyMs );
+				report( "indexed dispatch: ", result.indexedMs );
+				report( "script compile:   ", result.compileMs );
+				report( "script replay:    ", result.replayMs );
+				report( "cvar linear find: ", result.cvarLinearMs );
+				report( "cvar hashed find: ", result.cvarHashedMs );
+				if ( result.invocations[ 0 ] != result.invocations[ 1 ] || result.invocations[ 1 ] != result.invocations[ 2 ] ) {
+					addHistoryLine( csb.append( "  Error: ", 4 ).append( "invocation counts differ between dispatch paths", 3 ).flush() );
+				}
+			}, "Time command dispatch through the legacy, indexed, and compiled script paths." );
+
 		addCommand( { "echo", "e" },
 			{ // parameters list
 				{ "string", STRING, "The string in question." }
@@ -578,7 +649,27 @@ struct terminal_t {
 		}
 	}
 
-	// is this valid input for this command
+	static string getParseErrorString ( int failureMode ) {
+		const string errorList[] = {
+			"cvar name parse error",
+			"cvar types do not match",
+			"cvar invalid",
+			"bool parse error",
+			"float encountered when expecting int",
+			"int parse error",
+			"int encountered when expecting float",
+			"float parse error",
+			"string parse error",
+			"number passed as string argument",
+			"bool passed as string argument",
+			"stray characters at end of input"
+		};
+		return ( failureMode >= 0 && failureMode < 12 ) ? errorList[ failureMode ] : string( "unknown parse error" );
+	}
+
+	// is this valid input for this command - this is the stringstream version, which re-tokenizes the argument
+		// string for every overload it's tried against. enter() and scripts use parseTokensForCommand() instead,
+		// this one is kept for comparison in the terminal benchmark.
 	bool parseForCommand ( int commandIdx, string argumentString, bool verbose = false ) {
 
 		// so we have matched with command number commandIdx
@@ -760,21 +851,7 @@ struct terminal_t {
 
 		if ( fail || failureMode != -1 ) {
 			if ( verbose ) {
-				const string errorList[] = {
-					"cvar name parse error",
-					"cvar types do not match",
-					"cvar invalid",
-					"bool parse error",
-					"float encountered when expecting int",
-					"int parse error",
-					"int encountered when expecting float",
-					"float parse error",
-					"string parse error",
-					"number passed as string argument",
-					"bool passed as string argument",
-					"stray characters at end of input"
-				};
-				addHistoryLine( csb.append( errorList[ failureMode ] ).flush() );
+				addHistoryLine( csb.append( getParseErrorString( failureMode ) ).flush() );
 			}
 			return false;
 		} else {
@@ -782,6 +859,340 @@ struct terminal_t {
 		}
 	}
 
+	// split on whitespace, same tokens that operator>> on a stringstream would give
+	static void tokenize ( const string &input, std::vector< string > &tokens ) {
+		tokens.clear();
+		size_t i = 0;
+		while ( i < input.length() ) {
+			while ( i < input.length() && isspace( ( unsigned char ) input[ i ] ) ) i++;
+			const size_t start = i;
+			while ( i < input.length() && !isspace( ( unsigned char ) input[ i ] ) ) i++;
+			if ( i > start ) tokens.emplace_back( input, start, i - start );
+		}
+	}
+
+	// is this valid input for this command - same rules and failure modes as parseForCommand(), working off of
+		// tokens that were split once for the whole line. cvarRefs, if given, gets ( argument, cvar ) index pairs
+		// for the "$cvar" arguments, so a compiled script can read them again at run time.
+	bool parseTokensForCommand ( int commandIdx, const std::vector< string > &tokens, bool verbose = false, std::vector< std::pair< int, int > > * cvarRefs = nullptr ) {
+		command_t &command = commands[ commandIdx ];
+		size_t t = 0;
+		int failureMode = -1;
+
+		for ( uint i = 0; i < command.args.count() && failureMode == -1; i++ ) {
+			var_t &arg = command.args[ int( i ) ];
+			const bool haveToken = t < tokens.size();
+
+			if ( arg.type == CVAR_NAME ) {
+				// we want to read in just a string, we aren't going to dereference the cvar value
+				if ( haveToken ) {
+					arg.stringData = tokens[ t++ ];
+				} else {
+					failureMode = 0; // cvar name parse error
+				}
+
+			} else if ( haveToken && tokens[ t ][ 0 ] == '$' ) {
+				// signalling value for a cvar - needs to exist, and match the argument type
+				const int cvarIdx = cvars.find( tokens[ t++ ].substr( 1 ) );
+				if ( cvarIdx == -1 ) {
+					failureMode = 2; // cvar invalid
+				} else if ( cvars[ cvarIdx ].type != arg.type ) {
+					failureMode = 1; // cvar types do not match
+				} else {
+					arg.data = cvars[ cvarIdx ].data;
+					arg.stringData = cvars[ cvarIdx ].stringData;
+					if ( cvarRefs ) cvarRefs->push_back( { int( i ), cvarIdx } );
+				}
+
+			} else {
+				int count = 0;
+				switch ( arg.type ) {
+					case BOOL:
+						if ( haveToken && ( tokens[ t ] == "true" || tokens[ t ] == "false" ) ) {
+							arg.data[ 0 ] = ( tokens[ t++ ] == "true" ) ? 1.0f : 0.0f;
+						} else {
+							failureMode = 3; // bool failure
+						}
+					break;
+
+					case IVEC4:	count++;
+					case IVEC3:	count++;
+					case IVEC2:	count++;
+					case INT:	count++;
+						// read in up to four ints, put it in xyzw
+						for ( int j = 0; j < count && failureMode == -1; j++ ) {
+							if ( t < tokens.size() && isInt( tokens[ t ].c_str() ) ) {
+								try {
+									arg.data[ j ] = stoi( tokens[ t++ ] );
+								} catch ( ... ) {
+									failureMode = 5; // e.g. a lone "-"
+								}
+							} else {
+								failureMode = 5; // int failure mode, also covers float encountered when expecting int
+							}
+						}
+					break;
+
+					case VEC4:	count++;
+					case VEC3:	count++;
+					case VEC2:	count++;
+					case FLOAT:	count++;
+						// read in up to four floats, put it in xyzw
+						for ( int j = 0; j < count && failureMode == -1; j++ ) {
+							if ( t >= tokens.size() ) {
+								failureMode = 7; // float failure mode
+							} else if ( isInt( tokens[ t ].c_str() ) ) {
+								failureMode = 6; // int-as-float failure mode
+							} else if ( isFloat( tokens[ t ].c_str() ) ) {
+								try {
+									arg.data[ j ] = stof( tokens[ t++ ] );
+								} catch ( ... ) {
+									failureMode = 7; // e.g. a lone "."
+								}
+							} else {
+								failureMode = 7; // float failure mode
+							}
+						}
+					break;
+
+					case STRING:
+						if ( !haveToken ) {
+							failureMode = 8; // string failure mode
+						} else if ( isFloat( tokens[ t ].c_str() ) || isInt( tokens[ t ].c_str() ) ) {
+							failureMode = 9; // recieved numbers instead
+						} else if ( tokens[ t ] == "true" || tokens[ t ] == "false" ) {
+							failureMode = 10; // recieved bool instead
+						} else {
+							arg.stringData = tokens[ t++ ];
+						}
+					break;
+
+					default:
+					break;
+				}
+			}
+		}
+
+		if ( failureMode == -1 && t < tokens.size() ) {
+			// stray characters at end of input failure mode
+			failureMode = 11;
+		}
+
+		if ( failureMode != -1 ) {
+			if ( verbose ) {
+				addHistoryLine( csb.append( getParseErrorString( failureMode ) ).flush() );
+			}
+			return false;
+		}
+		return true;
+	}
+
+	// run one line of input without touching the history - every overload whose arguments parse gets invoked,
+		// same as enter(). commandFound / commandInvoked are for reporting.
+	void dispatch ( const string &commandText, const string &argumentText, bool &commandFound, bool &commandInvoked ) {
+		commandFound = commandInvoked = false;
+		const std::vector< int > * found = findCommand( commandText );
+		if ( found == nullptr ) return;
+		commandFound = true;
+
+		// copies - invoking a command is allowed to add more commands
+		const std::vector< int > candidates = *found;
+		std::vector< string > tokens;
+		tokenize( argumentText, tokens );
+		for ( int i : candidates ) {
+			if ( parseTokensForCommand( i, tokens ) ) {
+				// we successfully parsed the arguments for the command, so we can go ahead and run it
+				commands[ i ].invoke( commands[ i ].args );
+				commandInvoked = true;
+			}
+		}
+	}
+
+	// the old dispatch path - linear scan over every command and alias, stringstream parse per overload
+	void dispatchLegacy ( const string &commandText, const string &argumentText, bool &commandFound, bool &commandInvoked ) {
+		commandFound = commandInvoked = false;
+		for ( uint i = 0; i < commands.size(); i++ ) {
+			if ( commands[ i ].commandStringMatch( commandText ) ) {
+				commandFound = true;
+				if ( parseForCommand( i, argumentText ) ) {
+					commands[ i ].invoke( commands[ i ].args );
+					commandInvoked = true;
+				}
+			}
+		}
+	}
+
+	// break an input line into command text and argument text, the same way enter() does
+	static void splitLine ( const string &line, string &commandText, string &argumentText ) {
+		const size_t space = line.find( " " );
+		commandText = line.substr( 0, space );
+		argumentText = ( space == string::npos ) ? string() : line.substr( space + 1 );
+	}
+
+	// parse a command file once - one line per command, blank lines and lines starting with '#' or "//" are skipped
+	bool compileScript ( const string &source, terminalScript_t &script ) {
+		script = terminalScript_t();
+		std::istringstream lines( source );
+		string line, commandText, argumentText;
+		std::vector< string > tokens;
+		int lineNumber = 0;
+		while ( std::getline( lines, line ) ) {
+			lineNumber++;
+			script.numLines++;
+			if ( !line.empty() && line.back() == '\r' ) line.pop_back();
+			const size_t first = line.find_first_not_of( " \t" );
+			if ( first == string::npos || line[ first ] == '#' || line.compare( first, 2, "//" ) == 0 ) continue;
+			splitLine( line.substr( first ), commandText, argumentText );
+
+			const std::vector< int > * candidates = findCommand( commandText );
+			if ( candidates == nullptr ) {
+				script.errors.push_back( "line " + to_string( lineNumber ) + ": command " + commandText + " not found" );
+				continue;
+			}
+
+			tokenize( argumentText, tokens );
+			bool parsed = false;
+			for ( int i : *candidates ) {
+				terminalScript_t::instruction_t instruction;
+				if ( parseTokensForCommand( i, tokens, false, &instruction.cvarRefs ) ) {
+					instruction.commandIdx = i;
+					instruction.args = commands[ i ].args;
+					instruction.line = lineNumber;
+					script.instructions.push_back( instruction );
+					parsed = true;
+				}
+			}
+			if ( !parsed ) {
+				script.errors.push_back( "line " + to_string( lineNumber ) + ": command \"" + commandText + "\" argument parse failed" );
+			}
+		}
+		return script.errors.empty();
+	}
+
+	bool loadScript ( const string &path, terminalScript_t &script ) {
+		std::ifstream file( path );
+		if ( !file.is_open() ) {
+			script = terminalScript_t();
+			script.errors.push_back( "could not open " + path );
+			return false;
+		}
+		std::stringstream contents;
+		contents << file.rdbuf();
+		return compileScript( contents.str(), script );
+	}
+
+	// replay with the pre-resolved command indices - only the cvar references are looked at again
+	void runScript ( const terminalScript_t &script ) {
+		for ( auto& instruction : script.instructions ) {
+			args_t args = instruction.args;
+			for ( auto& ref : instruction.cvarRefs ) {
+				args[ ref.first ].data = cvars[ ref.second ].data;
+				args[ ref.first ].stringData = cvars[ ref.second ].stringData;
+			}
+			commands[ instruction.commandIdx ].invoke( args );
+		}
+	}
+
+	// timing for the three dispatch paths, on a scratch terminal with a registry about the size of a big project's
+		// - no window or GL needed, so this runs headless too
+	struct benchmarkResult_t {
+		size_t numCommands = 0;
+		double legacyMs = 0.0;		// linear scan + stringstream parse
+		double indexedMs = 0.0;		// hash lookup + single tokenize
+		double compileMs = 0.0;		// parsing the script once
+		double replayMs = 0.0;		// running the compiled script
+		double cvarLinearMs = 0.0;	// numCommands cvar lookups, old scan
+		double cvarHashedMs = 0.0;	// numCommands cvar lookups, hash index
+		size_t invocations[ 3 ] = { 0, 0, 0 }; // per path, should all match
+	};
+
+	static benchmarkResult_t benchmark ( const size_t numCommands ) {
+		benchmarkResult_t result;
+		result.numCommands = numCommands;
+
+		terminal_t scratch;
+		size_t invocations = 0;
+		float sink = 0.0f;
+		for ( int i = 0; i < 200; i++ ) {
+			scratch.addCvar( "benchCvar" + to_string( i ), VEC3, "Benchmark cvar." );
+			scratch.addCommand( { "benchCommand" + to_string( i ), "bc" + to_string( i ) }, {
+					{ "count", INT, "An int." },
+					{ "amount", FLOAT, "A float." }
+				}, [ &invocations, &sink ] ( args_t args ) {
+					invocations++;
+					sink += args[ "amount" ].data.x;
+				}, "Benchmark command." );
+			scratch.addCommand( { "benchCommand" + to_string( i ), "bc" + to_string( i ) }, {
+					{ "offset", VEC3, "A vector." }
+				}, [ &invocations, &sink ] ( args_t args ) {
+					invocations++;
+					sink += args[ "offset" ].data.z;
+				}, "Benchmark command overload." );
+		}
+
+		// the sort of thing a render job script does - a mix of commands, overloads, assignments, cvar reads
+		std::vector< string > lines;
+		string script;
+		for ( size_t i = 0; i < numCommands; i++ ) {
+			const int c = int( ( i * 7919 ) % 200 );
+			switch ( i % 4 ) {
+				case 0: lines.push_back( "benchCommand" + to_string( c ) + " " + to_string( i % 100 ) + " 0.5" ); break;
+				case 1: lines.push_back( "bc" + to_string( c ) + " 1.0 2.0 3.0" ); break;
+				case 2: lines.push_back( "assign benchCvar" + to_string( c ) + " 0.25 0.5 1.0" ); break;
+				case 3: lines.push_back( "benchCommand" + to_string( c ) + " $benchCvar" + to_string( c ) ); break;
+			}
+			script += lines.back() + "\n";
+		}
+		// ^ "$cvar" as the first argument, where the stringstream parse also accepts it
+
+		auto tStart = std::chrono::high_resolution_clock::now();
+		auto elapsedMs = [ & ] () {
+			const double ms = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::high_resolution_clock::now() - tStart ).count() / 1000.0;
+			tStart = std::chrono::high_resolution_clock::now();
+			return ms;
+		};
+
+		bool found, invoked;
+		string commandText, argumentText;
+		invocations = 0; elapsedMs();
+		for ( auto& line : lines ) {
+			splitLine( line, commandText, argumentText );
+			scratch.dispatchLegacy( commandText, argumentText, found, invoked );
+		}
+		result.legacyMs = elapsedMs();
+		result.invocations[ 0 ] = invocations;
+
+		invocations = 0; elapsedMs();
+		for ( auto& line : lines ) {
+			splitLine( line, commandText, argumentText );
+			scratch.dispatch( commandText, argumentText, found, invoked );
+		}
+		result.indexedMs = elapsedMs();
+		result.invocations[ 1 ] = invocations;
+
+		terminalScript_t compiled;
+		elapsedMs();
+		scratch.compileScript( script, compiled );
+		result.compileMs = elapsedMs();
+		invocations = 0;
+		scratch.runScript( compiled );
+		result.replayMs = elapsedMs();
+		result.invocations[ 2 ] = invocations;
+
+		// cvar lookup by itself
+		int check = 0;
+		elapsedMs();
+		for ( size_t i = 0; i < numCommands; i++ ) check += scratch.cvars.findLinear( "benchCvar" + to_string( ( i * 7919 ) % 200 ) );
+		result.cvarLinearMs = elapsedMs();
+		for ( size_t i = 0; i < numCommands; i++ ) check -= scratch.cvars.find( "benchCvar" + to_string( ( i * 7919 ) % 200 ) );
+		result.cvarHashedMs = elapsedMs();
+
+		// keep the work from being optimized out
+		[[maybe_unused]] volatile float escape = sink;
+		[[maybe_unused]] volatile int escapeCheck = check;
+		return result;
+	}
+
 	// init with startup message
 	terminal_t () {
 		// some initial setup - set color palette to be used
@@ -1137,28 +1548,10 @@ struct terminal_t {
 			// todo - try to match a cvar
 				// if you do, report the type and value of that cvar - require "$"?
 
-			// try to match a command
+			// try to match a command, and parse the rest of the input string for the arguments to that command
 			bool commandFound = false;
 			bool commandInvoked = false;
-			for ( uint i = 0; i < commands.size(); i++ ) {
-				// if you do, try to parse the rest of the input string for the arguments to that command
-				if ( commands[ i ].commandStringMatch( commandText ) ) {
-					commandFound = true;
-
-				// // debug
-				// 	addHistoryLine( csb.append( "Found matching command " + commandText ).flush() );
-				// 	addHistoryLine( csb.append( "  Arguments:" ).flush() );
-				// 	for ( auto& var : commands[ i ].args.args ) {
-				// 		addHistoryLine( csb.append( "    " + var.label + " ( ", 2 ).append( getStringForType( var.type ), 1 ).append( " ): ", 2 ).append( var.description, 1 ).flush() );
-				// 	}
-
-					if ( parseForCommand( i, argumentText ) ) {
-						// we successfully parsed the arguments for the command, so we can go ahead and run it
-						commands[ i ].invoke( commands[ i ].args );
-						commandInvoked = true;
-					}
-				}
-			}
+			dispatch( commandText, argumentText, commandFound, commandInvoked );
 
 			if ( commandFound && !commandInvoked ) {
 
@@ -1167,18 +1560,17 @@ struct terminal_t {
 				addHistoryLine( csb.append( "  Error: ", 4 ).append( "command \"" + commandText + "\" argument parse failed...", 3 ).flush() );
 				addLineBreak();
 				addHistoryLine( csb.append( "  Cantidates:" ).flush() );
-				for ( uint i = 0; i < commands.size(); i++ ) {
-					if ( commands[ i ].commandStringMatch( commandText ) ) {
-						if ( commands[ i ].args.count() != 0 ) {
-							addLineBreak();
-							addHistoryLine( csb.append( "  Command Aliases: " ).append( commands[ i ].getAliasString(), 1 ).flush() );
-							addHistoryLine( csb.append( "  Description: " ).append( commands[ i ].description, 1 ).flush() );
-							addHistoryLine( csb.append( "  Arguments:" ).flush() );
-							for ( auto& var : commands[ i ].args.args ) {
-								addHistoryLine( csb.append( "    " + var.label + " ( ", 2 ).append( getStringForType( var.type ), 1 ).append( " ): ", 2 ).append( var.description, 1 ).flush() );
-							}
-							addLineBreak();
+				const std::vector< int > candidates = *findCommand( commandText );
+				for ( int i : candidates ) {
+					if ( commands[ i ].args.count() != 0 ) {
+						addLineBreak();
+						addHistoryLine( csb.append( "  Command Aliases: " ).append( commands[ i ].getAliasString(), 1 ).flush() );
+						addHistoryLine( csb.append( "  Description: " ).append( commands[ i ].description, 1 ).flush() );
+						addHistoryLine( csb.append( "  Arguments:" ).flush() );
+						for ( auto& var : commands[ i ].args.args ) {
+							addHistoryLine( csb.append( "    " + var.label + " ( ", 2 ).append( getStringForType( var.type ), 1 ).append( " ): ", 2 ).append( var.description, 1 ).flush() );
 						}
+						addLineBreak();
 					}
 				}
 			}
@@ -3,6 +3,7 @@
 #define TEXTURE_H
 
 #include "../includes.h"
+#include "textureBackend.h"
 
 //===== Helper Functions ==============================================================================================
 inline size_t bytesPerPixel ( GLint type ) {
@@ -323,10 +324,20 @@ struct texture_t {
 
 	GLuint textureHandle;	// from glGenTextures()
 	size_t textureSize;		// number of bytes on disk
+	int32_t slot = -1;		// which textureHandle_t slot points at this record
+};
+
+//===== Texture Handle ================================================================================================
+// resolve a label once with GetHandle(), then use this instead of the string - stays valid if the texture is
+	// re-added under the same label ( e.g. resizing ), goes stale when the texture is removed
+struct textureHandle_t {
+	int32_t slot = -1;
+	uint32_t generation = 0;
+	bool IsValid () const { return slot >= 0; }
 };
 
 //===== Texture Manager ===============================================================================================
-class textureManager_t {
+template < typename backend_t > class textureManagerBase_t {
 public:
 	// prevent the use of 4.5 features
 	const bool compatibilityMode = false;
@@ -334,6 +345,22 @@ public:
 	// report some OpenGL constants' values
 	const bool statsReport = false;
 
+	// where the GL calls go - textureBackendRecording_t for headless use
+	backend_t gl;
+
+	// handles of programs replaced by a rebuild, oldest first - normally ShaderProgramCache().retired, GL reuses
+		// deleted program names, so a reloaded shader could otherwise inherit the old program's cached sampler units
+	const std::vector< uint32_t > * retiredPrograms = nullptr;
+
+	// counters for the binding cache
+	struct bindingStats_t {
+		size_t binds = 0;					// BindTexForShader + BindImageForShader calls
+		size_t locationQueries = 0;			// glGetUniformLocation calls actually made
+		size_t uniformSets = 0;				// sampler uniforms actually set
+		size_t uniformSetsSkipped = 0;		// sampler uniforms already holding the unit
+		size_t clears = 0;					// ZeroTexture2D / ZeroTexture3D calls
+	} bindingStats;
+
 	void Init () {
 
 		if ( statsReport ) {
@@ -344,24 +371,24 @@ public:
 			//	...
 
 			GLint val;
-			glGetIntegerv( GL_MAX_TEXTURE_SIZE, &val );
+			gl.GetIntegerv( GL_MAX_TEXTURE_SIZE, &val );
 			cout << endl << endl << "\t\tMax Texture Size Reports: " << val << endl;
 
 			cout << "\t\t  So Max Texture MIP Level Should Be " << log2( val ) << endl;
 
-			glGetIntegerv( GL_MAX_3D_TEXTURE_SIZE, &val );
+			gl.GetIntegerv( GL_MAX_3D_TEXTURE_SIZE, &val );
 			cout << "\t\tMax 3D Texture Size Reports: " << val << endl;
 
-			glGetIntegerv( GL_MAX_DRAW_BUFFERS, &val );
+			gl.GetIntegerv( GL_MAX_DRAW_BUFFERS, &val );
 			cout << "\t\tMax Draw Buffers: " << val << endl;
 
-			glGetIntegerv( GL_MAX_COMPUTE_TEXTURE_IMAGE_UNITS, &val );
+			gl.GetIntegerv( GL_MAX_COMPUTE_TEXTURE_IMAGE_UNITS, &val );
 			cout << "\t\tMax Compute Texture Image Units Reports: " << val << endl;
 
-			glGetIntegerv( GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &val );
+			gl.GetIntegerv( GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &val );
 			cout << "\t\tMax Combined Texture Image Units: " << val << endl;
 
-			glGetIntegerv( GL_MAX_VIEWPORT_DIMS, &val );
+			gl.GetIntegerv( GL_MAX_VIEWPORT_DIMS, &val );
 			cout << "\t\tMax Viewport Dims: " << val << endl << endl;
 
 			// make up for the spacing issues
@@ -373,7 +400,8 @@ public:
 
 	}
 
-	void Add ( string label, textureOptions_t &texOptsIn ) {
+	// adding a label that already exists replaces that texture, and handles to it stay valid
+	textureHandle_t Add ( string label, textureOptions_t &texOptsIn ) {
 
 		texture_t tex;
 		tex.label = label;
@@ -388,9 +416,9 @@ public:
 		);
 
 		// generate the texture
-		glActiveTexture( GL_TEXTURE0 );
-		glGenTextures( 1, &tex.textureHandle );
-		glBindTexture( texOptsIn.textureType, tex.textureHandle );
+		gl.ActiveTexture( GL_TEXTURE0 );
+		gl.GenTextures( 1, &tex.textureHandle );
+		gl.BindTexture( texOptsIn.textureType, tex.textureHandle );
 		switch ( texOptsIn.textureType ) {
 		case GL_TEXTURE_2D:
 
@@ -399,38 +427,38 @@ public:
 			// 	glTexParameterfv( GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, color );
 			// }
 
-			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texOptsIn.minFilter );
-			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texOptsIn.magFilter );
-			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texOptsIn.wrap );
-			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texOptsIn.wrap );
-			glTexParameterfv( GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, &texOptsIn.borderColor[ 0 ] );
-			glTexImage2D( GL_TEXTURE_2D, 0, texOptsIn.dataType, texOptsIn.width, texOptsIn.height, 0, getFormat( texOptsIn.dataType ), texOptsIn.pixelDataType, texOptsIn.initialData );
+			gl.TexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texOptsIn.minFilter );
+			gl.TexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texOptsIn.magFilter );
+			gl.TexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texOptsIn.wrap );
+			gl.TexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texOptsIn.wrap );
+			gl.TexParameterfv( GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, &texOptsIn.borderColor[ 0 ] );
+			gl.TexImage2D( GL_TEXTURE_2D, 0, texOptsIn.dataType, texOptsIn.width, texOptsIn.height, getFormat( texOptsIn.dataType ), texOptsIn.pixelDataType, texOptsIn.initialData );
 			if ( needsMipmap == true ) {
-				glGenerateMipmap( GL_TEXTURE_2D );
+				gl.GenerateMipmap( GL_TEXTURE_2D );
 			}
 			break;
 
 		case GL_TEXTURE_2D_ARRAY:
-			glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, texOptsIn.minFilter );
-			glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, texOptsIn.magFilter );
-			glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, texOptsIn.wrap );
-			glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, texOptsIn.wrap );
-			glTexParameterfv( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, &texOptsIn.borderColor[ 0 ] );
-			glTexImage3D( GL_TEXTURE_2D_ARRAY, 0, texOptsIn.dataType, texOptsIn.width, texOptsIn.height, texOptsIn.depth, 0, getFormat( texOptsIn.dataType ), texOptsIn.pixelDataType, texOptsIn.initialData );
+			gl.TexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, texOptsIn.minFilter );
+			gl.TexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, texOptsIn.magFilter );
+			gl.TexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, texOptsIn.wrap );
+			gl.TexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, texOptsIn.wrap );
+			gl.TexParameterfv( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, &texOptsIn.borderColor[ 0 ] );
+			gl.TexImage3D( GL_TEXTURE_2D_ARRAY, 0, texOptsIn.dataType, texOptsIn.width, texOptsIn.height, texOptsIn.depth, getFormat( texOptsIn.dataType ), texOptsIn.pixelDataType, texOptsIn.initialData );
 			if ( needsMipmap == true ) {
-				glGenerateMipmap( GL_TEXTURE_2D_ARRAY );
+				gl.GenerateMipmap( GL_TEXTURE_2D_ARRAY );
 			}
 			break;
 
 		case GL_TEXTURE_3D:
-			glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, texOptsIn.minFilter );
-			glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, texOptsIn.magFilter );
-			glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, texOptsIn.wrap );
-			glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, texOptsIn.wrap );
-			glTexParameterfv( GL_TEXTURE_3D, GL_TEXTURE_BORDER_COLOR, &texOptsIn.borderColor[ 0 ] );
-			glTexImage3D( GL_TEXTURE_3D, 0, texOptsIn.dataType, texOptsIn.width, texOptsIn.height, texOptsIn.depth, 0, getFormat( texOptsIn.dataType ), texOptsIn.pixelDataType, texOptsIn.initialData );
+			gl.TexParameteri( GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, texOptsIn.minFilter );
+			gl.TexParameteri( GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, texOptsIn.magFilter );
+			gl.TexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, texOptsIn.wrap );
+			gl.TexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, texOptsIn.wrap );
+			gl.TexParameterfv( GL_TEXTURE_3D, GL_TEXTURE_BORDER_COLOR, &texOptsIn.borderColor[ 0 ] );
+			gl.TexImage3D( GL_TEXTURE_3D, 0, texOptsIn.dataType, texOptsIn.width, texOptsIn.height, texOptsIn.depth, getFormat( texOptsIn.dataType ), texOptsIn.pixelDataType, texOptsIn.initialData );
 			if ( needsMipmap == true ) {
-				glGenerateMipmap( GL_TEXTURE_3D );
+				gl.GenerateMipmap( GL_TEXTURE_3D );
 			}
 			break;
 
@@ -440,42 +468,73 @@ public:
 		}
 
 		// add texture label
-		glObjectLabel( GL_TEXTURE, tex.textureHandle, -1, label.c_str() );
+		gl.ObjectLabel( tex.textureHandle, label );
 
 		// data likely doesn't exist after initialization
 		tex.creationOptions.initialData = nullptr;
 
 		// store for later
-		textures.push_back( tex );
+		auto existing = slotByLabel.find( label );
+		if ( existing != slotByLabel.end() ) {
+			// replacing - the old texture goes away, the slot now points at the new one
+			tex.slot = existing->second;
+			texture_t &old = textures[ slots[ tex.slot ].index ];
+			gl.DeleteTextures( 1, &old.textureHandle );
+			old = tex;
+		} else {
+			tex.slot = AllocateSlot();
+			slots[ tex.slot ].index = int32_t( textures.size() );
+			slotByLabel[ label ] = tex.slot;
+			textures.push_back( tex );
+		}
+		return textureHandle_t { tex.slot, slots[ tex.slot ].generation };
+	}
+
+	// resolve once, then use the handle versions of the calls below
+	textureHandle_t GetHandle ( const string &label ) const {
+		auto it = slotByLabel.find( label );
+		if ( it == slotByLabel.end() ) {
+			cout << "Texture \"" << label << "\" Missing" << endl;
+			return textureHandle_t();
+		}
+		return textureHandle_t { it->second, slots[ it->second ].generation };
+	}
+
+	// nullptr if the handle is stale, or was never valid
+	const texture_t * Lookup ( const textureHandle_t handle ) const {
+		if ( handle.slot < 0 || handle.slot >= int32_t( slots.size() ) ) return nullptr;
+		const slot_t &s = slots[ handle.slot ];
+		if ( s.generation != handle.generation || s.index < 0 ) return nullptr;
+		return &textures[ s.index ];
+	}
+
+	GLuint Get ( const textureHandle_t handle ) {
+		const texture_t * tex = Lookup( handle );
+		return tex ? tex->textureHandle : std::numeric_limits< GLuint >::max();
 	}
 
 	GLuint Get ( const string label ) { // if the array contains the key, return it, else some nonsense value
-		for ( auto& tex : textures ) {
-			if ( tex.label == label ) {
-				return tex.textureHandle;
-			}
+		const texture_t * tex = Find( label );
+		if ( tex != nullptr ) {
+			return tex->textureHandle;
 		}
 		cout << "Texture \"" << label << "\" Missing" << endl;
 		return std::numeric_limits< GLuint >::max();
 	}
 
+	GLint GetType ( const textureHandle_t handle ) {
+		const texture_t * tex = Lookup( handle );
+		return tex ? tex->creationOptions.dataType : std::numeric_limits< GLint >::max();
+	}
+
 	GLint GetType ( const string label ) {
-		for ( auto& tex : textures ) {
-			if ( tex.label == label ) {
-				return tex.creationOptions.dataType; // this is the move
-			}
-		}
-		return std::numeric_limits< GLint >::max();
+		const texture_t * tex = Find( label );
+		return tex ? tex->creationOptions.dataType : std::numeric_limits< GLint >::max();
 	}
 
 	uvec2 GetDimensions ( const string label ) {
-		textureOptions_t opts;
-		for ( auto& tex : textures ) {
-			if ( tex.label == label ) {
-				opts = tex.creationOptions;
-			}
-		}
-		return uvec2( opts.width, opts.height );
+		const texture_t * tex = Find( label );
+		return tex ? uvec2( tex->creationOptions.width, tex->creationOptions.height ) : uvec2( 0 );
 	}
 
 // I think this is the way we're going to use this now...
@@ -483,61 +542,56 @@ public:
 
 	// so an example call is textureManager.BindTexForShader( "Display Texture", "current", shaders[ "Display" ], 0 );
 	void BindTexForShader ( string label, const string shaderSampler, const GLuint shader, int location ) {
+		BindTexForShader( GetHandle( label ), shaderSampler, shader, location );
+	}
+
+	void BindTexForShader ( const textureHandle_t handle, const string &shaderSampler, const GLuint shader, int location ) {
+		bindingStats.binds++;
+		const GLuint tex = Get( handle );
 		// if 4.5 feature set is not supported
 		if ( compatibilityMode == true ) {
-			glActiveTexture( GL_TEXTURE0 + location );
-			glBindTexture( GL_TEXTURE_2D, Get( label ) );
+			gl.ActiveTexture( GL_TEXTURE0 + location );
+			gl.BindTexture( GL_TEXTURE_2D, tex );
 		} else {
-			glBindTextureUnit( location, Get( label ) );
+			gl.BindTextureUnit( location, tex );
 		}
-		glUniform1i( glGetUniformLocation( shader, shaderSampler.c_str() ), location );
+		SetSampler( shader, shaderSampler, location );
 	}
 
 	// so an example call is textureManager.BindImageForShader( "Display Texture", "current", shaders[ "Display" ], 0 );
 	void BindImageForShader ( string label, const string shaderSampler, const GLuint shader, int location, int level = 0 ) {
-		glBindImageTexture( location, Get( label ), level, GL_TRUE, 0, GL_READ_WRITE, GetType( label ) );
-		glUniform1i( glGetUniformLocation( shader, shaderSampler.c_str() ), location );
+		BindImageForShader( GetHandle( label ), shaderSampler, shader, location, level );
 	}
 
-	void ZeroTexture2D ( string label ) {
-		GLuint handle, dataType, format;
-		uint32_t w, h;
-		for ( auto& tex : textures ) {
-			if ( tex.label == label ) {
-				w = tex.creationOptions.width;
-				h = tex.creationOptions.height;
-				handle = tex.textureHandle;
-				dataType = tex.creationOptions.dataType;
-				format = getFormat( dataType );
-			}
-		}
-		// this is going to be too slow for per-frame usage, allocating a big buffer like this over and over
-		Image_4U zeroes( w, h ); // consider static declaration, resizing only if the current buffer is not large enough
-		void * data = ( void * ) zeroes.GetImageDataBasePtr();
-		glBindTexture( GL_TEXTURE_2D, handle );
-		glTexImage2D( GL_TEXTURE_2D, 0, dataType, w, h, 0, format, GL_UNSIGNED_BYTE, data );
+	void BindImageForShader ( const textureHandle_t handle, const string &shaderSampler, const GLuint shader, int location, int level = 0 ) {
+		bindingStats.binds++;
+		gl.BindImageTexture( location, Get( handle ), level, GetType( handle ) );
+		SetSampler( shader, shaderSampler, location );
 	}
 
-	void ZeroTexture3D ( string label ) {
-		GLuint handle, dataType, format;
-		uint32_t w, h, d;
-		for ( auto& tex : textures ) {
-			if ( tex.label == label ) {
-				w = tex.creationOptions.width;
-				h = tex.creationOptions.height;
-				d = tex.creationOptions.depth;
-				handle = tex.textureHandle;
-				dataType = tex.creationOptions.dataType;
-				format = getFormat( dataType );
-			}
+	// the cached sampler state for this program is dropped - for when it's relinked or deleted outside of here, or
+		// when one of its sampler uniforms gets written directly with glUniform1i
+	void ForgetProgram ( const GLuint shader ) {
+		programBindings.erase( shader );
+	}
+
+	// count sampler locations from location were written by someone else ( the uniform cache ) - their cached units
+		// are dropped, so the next SetSampler on them writes again
+	void ForgetSamplerUnits ( const GLuint shader, const GLint location, const GLsizei count = 1 ) {
+		auto program = programBindings.find( shader );
+		if ( program == programBindings.end() ) return;
+		for ( GLsizei i = 0; i < count; i++ ) {
+			program->second.units.erase( location + i );
 		}
-		// this is going to be too slow for per-frame usage, allocating a big buffer like this over and over
-		Image_4U zeroes( w, h * d );
-		void * data = ( void * ) zeroes.GetImageDataBasePtr();
-		glBindTexture( GL_TEXTURE_3D, handle );
-		glTexImage3D( GL_TEXTURE_3D, 0, dataType, w, h, d, 0, format, GL_UNSIGNED_BYTE, data );
 	}
 
+	// clears go through glClearTexImage, which zeroes on the GPU without any host memory - compatibility mode
+		// ( no 4.4 ) uploads from a zeroed buffer that is kept around and only grows
+	void ZeroTexture2D ( string label ) { ZeroTexture( GetHandle( label ), GL_TEXTURE_2D ); }
+	void ZeroTexture2D ( const textureHandle_t handle ) { ZeroTexture( handle, GL_TEXTURE_2D ); }
+	void ZeroTexture3D ( string label ) { ZeroTexture( GetHandle( label ), GL_TEXTURE_3D ); }
+	void ZeroTexture3D ( const textureHandle_t handle ) { ZeroTexture( handle, GL_TEXTURE_3D ); }
+
 	void Update ( string label /*, ... */ ) {
 		// pass in new data for the texture... tbd
 	}
@@ -581,30 +635,30 @@ public:
 	}
 
 	void Remove ( string label ) {
-		// delete texture
-		GLuint tex = Get( label );
+		auto it = slotByLabel.find( label );
 
 		// just early out
-		if ( tex == std::numeric_limits< GLuint >::max() ) { return; }
-
-		glDeleteTextures( 1, &tex );
-
-		// do the removal
-		bool removed = false;
-		std::vector< texture_t >::iterator itr = textures.begin();
-		while ( itr != textures.end() ) {
-			if ( itr->label == label ) {
-				textures.erase( itr );
-				removed = true;
-			} else {
-				++itr;
-			}
+		if ( it == slotByLabel.end() ) {
+			cout << "Texture \"" << label << "\" Missing" << endl;
+			return;
 		}
 
-		// if we get through the list without finding, the texture was not found
-		if ( !removed ) {
-			cout << "texture not found" << endl;
+		// delete texture
+		const int32_t slot = it->second;
+		const int32_t index = slots[ slot ].index;
+		gl.DeleteTextures( 1, &textures[ index ].textureHandle );
+
+		// do the removal - keep the order, the records after this one move down by one
+		textures.erase( textures.begin() + index );
+		for ( size_t i = index; i < textures.size(); i++ ) {
+			slots[ textures[ i ].slot ].index = int32_t( i );
 		}
+
+		// outstanding handles to this texture go stale
+		slots[ slot ].index = -1;
+		slots[ slot ].generation++;
+		freeSlots.push_back( slot );
+		slotByLabel.erase( it );
 	}
 
 	// TODO
@@ -613,8 +667,190 @@ public:
 	}
 
 	std::vector< texture_t > textures; // keep as an ordered set
+
+private:
+	// handles index into this, so they survive removals reordering textures
+	struct slot_t {
+		int32_t index = -1;			// into textures, -1 when free
+		uint32_t generation = 0;	// bumped on removal
+	};
+	std::vector< slot_t > slots;
+	std::vector< int32_t > freeSlots;
+	std::unordered_map< string, int32_t > slotByLabel;
+
+	// sampler uniforms are program state, so they're tracked per program - location by name, and the unit last
+		// written to each location. Texture units themselves are context state that other code binds to directly
+		// ( ImGui, the text renderer, raw glBindImageTexture in projects ), so those binds are always issued. Sampler
+		// uniforms set through the uniform cache come back through ForgetSamplerUnits(), any other write needs a
+		// ForgetProgram()
+	struct programBindings_t {
+		std::unordered_map< string, GLint > locations;
+		std::unordered_map< GLint, GLint > units;
+	};
+	std::unordered_map< GLuint, programBindings_t > programBindings;
+	size_t retiredSeen = 0;
+
+	// zeroes for the compatibility mode clear path
+	std::vector< uint8_t > zeroes;
+
+	int32_t AllocateSlot () {
+		if ( !freeSlots.empty() ) {
+			const int32_t slot = freeSlots.back();
+			freeSlots.pop_back();
+			return slot;
+		}
+		slots.emplace_back();
+		return int32_t( slots.size() - 1 );
+	}
+
+	const texture_t * Find ( const string &label ) const {
+		auto it = slotByLabel.find( label );
+		return ( it == slotByLabel.end() ) ? nullptr : &textures[ slots[ it->second ].index ];
+	}
+
+	void SetSampler ( const GLuint shader, const string &shaderSampler, const GLint unit ) {
+		if ( retiredPrograms != nullptr && retiredSeen != retiredPrograms->size() ) {
+			for ( ; retiredSeen < retiredPrograms->size(); retiredSeen++ ) {
+				programBindings.erase( ( *retiredPrograms )[ retiredSeen ] );
+			}
+		}
+		programBindings_t &program = programBindings[ shader ];
+		auto location = program.locations.find( shaderSampler );
+		if ( location == program.locations.end() ) {
+			bindingStats.locationQueries++;
+			location = program.locations.emplace( shaderSampler, gl.GetUniformLocation( shader, shaderSampler ) ).first;
+		}
+		if ( location->second == -1 ) return; // not active in this program, nothing to set
+
+		auto current = program.units.find( location->second );
+		if ( current != program.units.end() && current->second == unit ) {
+			bindingStats.uniformSetsSkipped++;
+			return;
+		}
+		bindingStats.uniformSets++;
+		program.units[ location->second ] = unit;
+		if ( compatibilityMode == true ) {
+			// this is setting the uniform on whatever program is current - which has been the caller's shader
+			gl.Uniform1i( location->second, unit );
+		} else {
+			gl.ProgramUniform1i( shader, location->second, unit );
+		}
+	}
+
+	void ZeroTexture ( const textureHandle_t handle, const GLenum target ) {
+		const texture_t * tex = Lookup( handle );
+		if ( tex == nullptr ) return;
+		bindingStats.clears++;
+
+		const textureOptions_t &opts = tex->creationOptions;
+		const GLenum format = getFormat( opts.dataType );
+		// integer and float formats alike, zero bits are zero
+		if ( compatibilityMode == false ) {
+			gl.ClearTexImage( tex->textureHandle, 0, format, GL_UNSIGNED_BYTE );
+		} else {
+			const size_t texels = size_t( opts.width ) * opts.height * ( target == GL_TEXTURE_3D ? opts.depth : 1 );
+			// GL_UNSIGNED_BYTE source, up to four components per texel
+			if ( zeroes.size() < texels * 4 ) {
+				zeroes.resize( texels * 4, 0 );
+			}
+			gl.BindTexture( target, tex->textureHandle );
+			if ( target == GL_TEXTURE_3D ) {
+				gl.TexSubImage3D( GL_TEXTURE_3D, 0, opts.width, opts.height, opts.depth, format, GL_UNSIGNED_BYTE, zeroes.data() );
+			} else {
+				gl.TexSubImage2D( GL_TEXTURE_2D, 0, opts.width, opts.height, format, GL_UNSIGNED_BYTE, zeroes.data() );
+			}
+		}
+	}
 };
 
+// what the engine uses
+using textureManager_t = textureManagerBase_t< textureBackendGL_t >;
+
+//===== Binding Benchmark =============================================================================================
+// a frame's worth of binds, the way the projects do them, against the recording backend - label lookups + uniform
+	// location queries every time, versus handles resolved once and the per-program sampler cache
+struct textureBindingBenchmark_t {
+	size_t numBinds = 0;
+	double labelMs = 0.0;
+	double handleMs = 0.0;
+	size_t labelCalls = 0;		// recorded GL calls, label path
+	size_t handleCalls = 0;		// recorded GL calls, handle path
+	size_t clearTexelsUploaded = 0;	// host texels uploaded by the clears, should be zero outside compatibility mode
+};
+
+inline textureBindingBenchmark_t RunTextureBindingBenchmark ( const size_t numFrames ) {
+	textureBindingBenchmark_t result;
+	textureManagerBase_t< textureBackendRecording_t > manager;
+	manager.gl.keepLog = false;
+
+	// roughly what a path tracer project holds - a few dozen textures, a handful of programs
+	constexpr int numTextures = 48;
+	constexpr int numPrograms = 8;
+	constexpr int bindsPerProgram = 6;
+	std::vector< string > labels;
+	std::vector< textureHandle_t > handles;
+	for ( int i = 0; i < numTextures; i++ ) {
+		textureOptions_t opts;
+		opts.dataType		= ( i % 2 ) ? GL_RGBA32F : GL_RGBA8UI;
+		opts.textureType	= ( i % 8 == 7 ) ? GL_TEXTURE_3D : GL_TEXTURE_2D;
+		opts.width			= 1024;
+		opts.height			= 1024;
+		opts.depth			= ( opts.textureType == GL_TEXTURE_3D ) ? 256 : 1;
+		labels.push_back( "Benchmark Texture " + to_string( i ) );
+		handles.push_back( manager.Add( labels.back(), opts ) );
+	}
+	const string samplers[ bindsPerProgram ] = { "current", "accumulator", "blueNoise", "depth", "normals", "history" };
+
+	auto tStart = std::chrono::high_resolution_clock::now();
+	auto elapsedMs = [ & ] () {
+		const double ms = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::high_resolution_clock::now() - tStart ).count() / 1000.0;
+		tStart = std::chrono::high_resolution_clock::now();
+		return ms;
+	};
+
+	// label path, with the location query and uniform set every time, like before
+	manager.gl.Reset();
+	elapsedMs();
+	for ( size_t frame = 0; frame < numFrames; frame++ ) {
+		for ( int p = 0; p < numPrograms; p++ ) {
+			for ( int b = 0; b < bindsPerProgram; b++ ) {
+				const string &label = labels[ ( p * 5 + b * 7 ) % numTextures ];
+				const GLuint shader = GLuint( p + 1 );
+				manager.gl.BindTextureUnit( b, manager.Get( label ) );
+				manager.gl.Uniform1i( manager.gl.GetUniformLocation( shader, samplers[ b ] ), b );
+			}
+		}
+	}
+	result.labelMs = elapsedMs();
+	result.labelCalls = manager.gl.TotalCalls();
+
+	// handle path, through the cache
+	manager.gl.Reset();
+	elapsedMs();
+	for ( size_t frame = 0; frame < numFrames; frame++ ) {
+		for ( int p = 0; p < numPrograms; p++ ) {
+			for ( int b = 0; b < bindsPerProgram; b++ ) {
+				manager.BindTexForShader( handles[ ( p * 5 + b * 7 ) % numTextures ], samplers[ b ], GLuint( p + 1 ), b );
+			}
+		}
+	}
+	result.handleMs = elapsedMs();
+	result.handleCalls = manager.gl.TotalCalls();
+	result.numBinds = numFrames * numPrograms * bindsPerProgram;
+
+	// and the clears
+	manager.gl.Reset();
+	for ( auto &handle : handles ) {
+		if ( manager.Lookup( handle )->creationOptions.textureType == GL_TEXTURE_3D ) {
+			manager.ZeroTexture3D( handle );
+		} else {
+			manager.ZeroTexture2D( handle );
+		}
+	}
+	result.clearTexelsUploaded = manager.gl.texelsUploaded;
+	return result;
+}
+
 // move bindsets to here
 	// bindsets get a new field to tell texture/image bind type
 
@@ -0,0 +1,132 @@
+#pragma once
+#ifndef TEXTURE_BACKEND_H
+#define TEXTURE_BACKEND_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+
+// the GL calls textureManager makes, pulled out so the bookkeeping around them ( labels, handles, binding cache )
+	// can run against something other than a live context. textureBackendGL_t forwards straight to GL, this is
+	// what the engine uses. textureBackendRecording_t keeps a log of the calls instead, and hands out texture
+	// names and uniform locations itself - so it works headless, with no window or GPU.
+
+//===== GL Backend ====================================================================================================
+struct textureBackendGL_t {
+	void GetIntegerv ( GLenum pname, GLint * value ) { glGetIntegerv( pname, value ); }
+	void ActiveTexture ( GLenum unit ) { glActiveTexture( unit ); }
+	void GenTextures ( GLsizei n, GLuint * names ) { glGenTextures( n, names ); }
+	void DeleteTextures ( GLsizei n, const GLuint * names ) { glDeleteTextures( n, names ); }
+	void BindTexture ( GLenum target, GLuint name ) { glBindTexture( target, name ); }
+	void TexParameteri ( GLenum target, GLenum pname, GLint value ) { glTexParameteri( target, pname, value ); }
+	void TexParameterfv ( GLenum target, GLenum pname, const GLfloat * value ) { glTexParameterfv( target, pname, value ); }
+	void TexImage2D ( GLenum target, GLint level, GLint internalFormat, GLsizei w, GLsizei h, GLenum format, GLenum type, const void * data ) {
+		glTexImage2D( target, level, internalFormat, w, h, 0, format, type, data );
+	}
+	void TexImage3D ( GLenum target, GLint level, GLint internalFormat, GLsizei w, GLsizei h, GLsizei d, GLenum format, GLenum type, const void * data ) {
+		glTexImage3D( target, level, internalFormat, w, h, d, 0, format, type, data );
+	}
+	void TexSubImage2D ( GLenum target, GLint level, GLsizei w, GLsizei h, GLenum format, GLenum type, const void * data ) {
+		glTexSubImage2D( target, level, 0, 0, w, h, format, type, data );
+	}
+	void TexSubImage3D ( GLenum target, GLint level, GLsizei w, GLsizei h, GLsizei d, GLenum format, GLenum type, const void * data ) {
+		glTexSubImage3D( target, level, 0, 0, 0, w, h, d, format, type, data );
+	}
+	void ClearTexImage ( GLuint name, GLint level, GLenum format, GLenum type ) { glClearTexImage( name, level, format, type, nullptr ); }
+	void GenerateMipmap ( GLenum target ) { glGenerateMipmap( target ); }
+	void ObjectLabel ( GLuint name, const std::string &label ) { glObjectLabel( GL_TEXTURE, name, -1, label.c_str() ); }
+	void BindTextureUnit ( GLuint unit, GLuint name ) { glBindTextureUnit( unit, name ); }
+	void BindImageTexture ( GLuint unit, GLuint name, GLint level, GLenum format ) { glBindImageTexture( unit, name, level, GL_TRUE, 0, GL_READ_WRITE, format ); }
+	GLint GetUniformLocation ( GLuint program, const std::string &name ) { return glGetUniformLocation( program, name.c_str() ); }
+	void Uniform1i ( GLint location, GLint value ) { glUniform1i( location, value ); }
+	void ProgramUniform1i ( GLuint program, GLint location, GLint value ) { glProgramUniform1i( program, location, value ); }
+};
+
+//===== Recording Backend =============================================================================================
+struct textureBackendRecording_t {
+	enum call_e : uint8_t {
+		GET_INTEGERV, ACTIVE_TEXTURE, GEN_TEXTURES, DELETE_TEXTURES, BIND_TEXTURE, TEX_PARAMETER, TEX_IMAGE,
+		TEX_SUB_IMAGE, CLEAR_TEX_IMAGE, GENERATE_MIPMAP, OBJECT_LABEL, BIND_TEXTURE_UNIT, BIND_IMAGE_TEXTURE,
+		GET_UNIFORM_LOCATION, UNIFORM_1I, NUM_CALLS
+	};
+
+	struct call_t {
+		call_e call;
+		GLuint name;	// texture or program, where relevant
+		GLint a;		// unit / location / level / internal format, depending on the call
+		GLint b;		// uniform value / format
+		size_t texels;	// texels the call would have read from host memory, for uploads
+	};
+
+	// turn off to only keep the counts, for long benchmark runs
+	bool keepLog = true;
+	std::vector< call_t > log;
+	size_t counts[ NUM_CALLS ] = { 0 };
+	size_t texelsUploaded = 0;
+
+	size_t Count ( call_e call ) const { return counts[ call ]; }
+	size_t TotalCalls () const {
+		size_t total = 0;
+		for ( size_t c : counts ) total += c;
+		return total;
+	}
+
+	void Reset () {
+		log.clear();
+		for ( size_t &c : counts ) c = 0;
+		texelsUploaded = 0;
+	}
+
+	void GetIntegerv ( GLenum, GLint * value ) { Record( GET_INTEGERV ); *value = 16384; }
+	void ActiveTexture ( GLenum unit ) { Record( ACTIVE_TEXTURE, 0, GLint( unit ) ); }
+	void GenTextures ( GLsizei n, GLuint * names ) {
+		for ( GLsizei i = 0; i < n; i++ ) {
+			names[ i ] = nextTextureName++;
+			Record( GEN_TEXTURES, names[ i ] );
+		}
+	}
+	void DeleteTextures ( GLsizei n, const GLuint * names ) {
+		for ( GLsizei i = 0; i < n; i++ ) Record( DELETE_TEXTURES, names[ i ] );
+	}
+	void BindTexture ( GLenum, GLuint name ) { Record( BIND_TEXTURE, name ); }
+	void TexParameteri ( GLenum, GLenum pname, GLint value ) { Record( TEX_PARAMETER, 0, GLint( pname ), value ); }
+	void TexParameterfv ( GLenum, GLenum pname, const GLfloat * ) { Record( TEX_PARAMETER, 0, GLint( pname ) ); }
+	void TexImage2D ( GLenum, GLint level, GLint internalFormat, GLsizei, GLsizei, GLenum, GLenum, const void * ) { Record( TEX_IMAGE, 0, level, internalFormat ); }
+	void TexImage3D ( GLenum, GLint level, GLint internalFormat, GLsizei, GLsizei, GLsizei, GLenum, GLenum, const void * ) { Record( TEX_IMAGE, 0, level, internalFormat ); }
+	void TexSubImage2D ( GLenum, GLint level, GLsizei w, GLsizei h, GLenum, GLenum, const void * ) {
+		Record( TEX_SUB_IMAGE, 0, level, 0, size_t( w ) * h );
+	}
+	void TexSubImage3D ( GLenum, GLint level, GLsizei w, GLsizei h, GLsizei d, GLenum, GLenum, const void * ) {
+		Record( TEX_SUB_IMAGE, 0, level, 0, size_t( w ) * h * d );
+	}
+	void ClearTexImage ( GLuint name, GLint level, GLenum format, GLenum ) { Record( CLEAR_TEX_IMAGE, name, level, GLint( format ) ); }
+	void GenerateMipmap ( GLenum ) { Record( GENERATE_MIPMAP ); }
+	void ObjectLabel ( GLuint name, const std::string & ) { Record( OBJECT_LABEL, name ); }
+	void BindTextureUnit ( GLuint unit, GLuint name ) { Record( BIND_TEXTURE_UNIT, name, GLint( unit ) ); }
+	void BindImageTexture ( GLuint unit, GLuint name, GLint, GLenum format ) { Record( BIND_IMAGE_TEXTURE, name, GLint( unit ), GLint( format ) ); }
+	GLint GetUniformLocation ( GLuint program, const std::string &name ) {
+		// stable per ( program, name ), like the real thing - hand out the next one the first time it's seen
+		Record( GET_UNIFORM_LOCATION, program );
+		auto &programLocations = uniformLocations[ program ];
+		auto it = programLocations.find( name );
+		if ( it == programLocations.end() ) {
+			it = programLocations.emplace( name, GLint( programLocations.size() ) ).first;
+		}
+		return it->second;
+	}
+	void Uniform1i ( GLint location, GLint value ) { Record( UNIFORM_1I, 0, location, value ); }
+	void ProgramUniform1i ( GLuint program, GLint location, GLint value ) { Record( UNIFORM_1I, program, location, value ); }
+
+private:
+	GLuint nextTextureName = 1;
+	std::unordered_map< GLuint, std::unordered_map< std::string, GLint > > uniformLocations;
+
+	void Record ( call_e call, GLuint name = 0, GLint a = 0, GLint b = 0, size_t texels = 0 ) {
+		counts[ call ]++;
+		if ( call == TEX_SUB_IMAGE ) texelsUploaded += texels;
+		if ( keepLog ) log.push_back( { call, name, a, b, texels } );
+	}
+};
+
+#endif // TEXTURE_BACKEND_H
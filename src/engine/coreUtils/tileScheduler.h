@@ -0,0 +1,437 @@
+#pragma once
+#ifndef TILESCHEDULER_H
+#define TILESCHEDULER_H
+
+#include <cmath>
+#include <mutex>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "../../utils/GLM/glm.hpp"
+
+// hands out tile offsets for the tiled pathtracers ( Daedalus, Siren ), replacing tileDispenser. Work is handed
+	// out in rounds; with no feedback, a round is every tile once in a shuffled order, like the old dispenser did.
+	// The differences:
+	//	- the shuffle comes from a seed, with its own generator, so a run can be reproduced on any platform
+	//	- NextBatchSize() sizes each batch between timer queries from the measured cost per tile, instead of a
+	//		fixed tilesBetweenQueries, so a frame lands close to its budget
+	//	- if the caller reports per-tile variance ( ReportVariance() ), later rounds favor the tiles with the most
+	//		remaining error per ms, and visit converged tiles only occasionally
+	//	- every public member function takes the lock, so several consumers can share one scheduler
+
+class tileScheduler_t {
+public:
+	struct tile_t {
+		glm::ivec2 offset;
+		uint32_t index;		// for ReportVariance() / ReportTileCost()
+	};
+
+	// environment
+	uint32_t tileSize = 256;
+	uint32_t imageWidth = 0;
+	uint32_t imageHeight = 0;
+	uint64_t seed = 0;
+
+	// frame budgeting
+	float tileTimeLimitMS = 15.0f;		// per frame
+	uint32_t tilesBetweenQueries = 5;	// first batch, and every batch when adaptiveBatches is off
+	bool adaptiveBatches = true;
+	uint32_t maxBatchSize = 256;
+
+	// convergence
+	bool adaptivePriority = true;		// only has an effect once variance is being reported
+	float targetError = 0.0f;			// standard error below which a tile counts as converged, 0 disables
+	uint32_t convergedInterval = 8;		// converged tiles still get a visit every this many rounds
+	uint32_t maxVisitsPerRound = 4;
+
+	tileScheduler_t () {}
+	tileScheduler_t ( uint32_t t, uint32_t w, uint32_t h, uint64_t s = 0 ) : tileSize( t ), imageWidth( w ), imageHeight( h ), seed( s ) {
+		RegenerateTileList();
+	}
+
+	// regenerate list - also the timer and sample count reset
+	void RegenerateTileList () {
+		std::lock_guard< std::mutex > lock( mutex );
+		BuildTileList();
+	}
+
+	// new accumulation over the same tiles, e.g. after the camera moves - the order, sample counts and variance start
+		// over, but the measured costs per tile / per batch are kept, so batch sizing doesn't have to learn them again
+	void ResetAccumulation () {
+		std::lock_guard< std::mutex > lock( mutex );
+		for ( tileState_t &tile : tiles ) {
+			tile.samples = 0;
+			tile.lastRound = 0;
+			tile.variance = 0.0f;
+			tile.haveVariance = false;
+		}
+		rngState = seed;
+		rounds = 0;
+		haveVariance = false;
+		totalDispatched = 0;
+		tLastReset = std::chrono::steady_clock::now();
+		BuildRound();
+	}
+
+	// reset state
+	void Reset ( uint32_t t, uint32_t w, uint32_t h ) {
+		if ( t < 16 || t > 2048 ) return; // reject invalid tilesizes
+		std::lock_guard< std::mutex > lock( mutex );
+		tileSize = t;
+		imageWidth = w;
+		imageHeight = h;
+		BuildTileList();
+	}
+
+	// how many tiles cover the image
+	uint32_t Count () const {
+		std::lock_guard< std::mutex > lock( mutex );
+		return uint32_t( tiles.size() );
+	}
+
+	// how many rounds have completed - a full pass each, until variance is reported
+	uint32_t SampleCount () const {
+		std::lock_guard< std::mutex > lock( mutex );
+		return rounds;
+	}
+
+	// how many tiles have been handed out since the reset
+	uint64_t TilesDispatched () const {
+		std::lock_guard< std::mutex > lock( mutex );
+		return totalDispatched;
+	}
+
+	// how long has this been running since the last time we reset the thing
+	float SecondsSinceLastReset () const {
+		std::lock_guard< std::mutex > lock( mutex );
+		return std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::steady_clock::now() - tLastReset ).count() / 1000.0f;
+	}
+
+	// get a tile from the list
+	glm::ivec2 GetTile () { return NextTile().offset; }
+
+	tile_t NextTile () {
+		std::lock_guard< std::mutex > lock( mutex );
+		return Pop();
+	}
+
+	// several at once, one lock - for consumers that take a batch at a time
+	void NextTiles ( const uint32_t count, std::vector< tile_t > &out ) {
+		std::lock_guard< std::mutex > lock( mutex );
+		out.clear();
+		for ( uint32_t i = 0; i < count; i++ ) out.push_back( Pop() );
+	}
+
+	// how many tiles to dispatch before the next timer query, given the time already spent this frame - always
+		// at least one, so the loop makes progress and gets a new measurement
+	uint32_t NextBatchSize ( const float elapsedMS ) {
+		std::lock_guard< std::mutex > lock( mutex );
+		if ( !adaptiveBatches || msPerTile <= 0.0f || tiles.empty() ) return std::max( 1u, tilesBetweenQueries );
+		// walk the upcoming tiles, adding up their predicted cost until the budget runs out ( aiming slightly short,
+			// since going over is worse than one more query )
+		const float remaining = ( tileTimeLimitMS - elapsedMS ) * 0.9f;
+		float predicted = 0.0f;
+		uint32_t count = 0;
+		size_t r = roundOffset;
+		while ( count < maxBatchSize ) {
+			if ( r == round.size() ) r = 0; // past this round, the order isn't known yet - assume the same tiles again
+			if ( round.empty() ) break;
+			const float cost = PredictedCost( round[ r++ ] );
+			if ( count > 0 && predicted + cost > remaining ) break;
+			predicted += cost;
+			count++;
+		}
+		return std::max( 1u, count );
+	}
+
+	// time measured for the last batch of numTiles tiles - updates the running cost per tile
+	void ReportBatch ( const uint32_t numTiles, const float ms ) {
+		if ( numTiles == 0 || ms <= 0.0f ) return;
+		std::lock_guard< std::mutex > lock( mutex );
+		const float measured = ms / numTiles;
+		msPerTile = ( msPerTile <= 0.0f ) ? measured : glm::mix( msPerTile, measured, 0.25f );
+	}
+
+	// cost of one tile on its own, for consumers that can time them individually
+	void ReportTileCost ( const uint32_t index, const float ms ) {
+		std::lock_guard< std::mutex > lock( mutex );
+		if ( index >= tiles.size() ) return; // stale index, from before a Reset() to a smaller image
+		tileState_t &tile = tiles[ index ];
+		tile.cost = ( tile.cost <= 0.0f ) ? ms : glm::mix( tile.cost, ms, 0.25f );
+	}
+
+	// per-sample variance estimate for a tile ( e.g. luminance variance across its pixels' recent samples ) - the
+		// remaining error is then predicted as sqrt( variance / samples ), so it doesn't need reporting every round
+	void ReportVariance ( const uint32_t index, const float variance ) {
+		std::lock_guard< std::mutex > lock( mutex );
+		if ( index >= tiles.size() ) return;
+		tiles[ index ].variance = std::max( 0.0f, variance );
+		tiles[ index ].haveVariance = true;
+		haveVariance = true;
+	}
+
+	uint32_t TileSamples ( const uint32_t index ) const {
+		std::lock_guard< std::mutex > lock( mutex );
+		return ( index < tiles.size() ) ? tiles[ index ].samples : 0;
+	}
+
+	float TileError ( const uint32_t index ) const {
+		std::lock_guard< std::mutex > lock( mutex );
+		return ( index < tiles.size() ) ? PredictedError( tiles[ index ] ) : 0.0f;
+	}
+
+	// largest predicted error over the tiles with a variance estimate
+	float MaxError () const {
+		std::lock_guard< std::mutex > lock( mutex );
+		float result = 0.0f;
+		for ( auto& tile : tiles ) {
+			if ( tile.haveVariance ) result = std::max( result, PredictedError( tile ) );
+		}
+		return result;
+	}
+
+private:
+	struct tileState_t {
+		glm::ivec2 offset;
+		uint32_t samples = 0;			// times handed out
+		uint32_t lastRound = 0;			// round of the last visit
+		float variance = 0.0f;			// per-sample, as reported
+		bool haveVariance = false;
+		float cost = 0.0f;				// ms, 0 until reported
+	};
+
+	std::vector< tileState_t > tiles;
+	std::vector< uint32_t > round;		// tile indices for the current round, in dispatch order
+	size_t roundOffset = 0;
+	uint32_t rounds = 0;
+	uint64_t totalDispatched = 0;
+	uint64_t rngState = 0;
+	float msPerTile = 0.0f;				// running average over batches
+	bool haveVariance = false;
+	mutable std::mutex mutex;
+
+	// time since the last reset
+	std::chrono::time_point< std::chrono::steady_clock > tLastReset;
+
+	// the tile list for the current tileSize / image size, and a fresh start on everything else - called with the lock held
+	void BuildTileList () {
+		tiles.clear();
+		for ( uint32_t x = 0; x < imageWidth; x += tileSize ) {
+			for ( uint32_t y = 0; y < imageHeight; y += tileSize ) {
+				tileState_t tile;
+				tile.offset = glm::ivec2( x, y );
+				tiles.push_back( tile );
+			}
+		}
+		rngState = seed;
+		rounds = 0;
+		round.clear();
+		roundOffset = 0;
+		msPerTile = 0.0f;
+		haveVariance = false;
+		totalDispatched = 0;
+		tLastReset = std::chrono::steady_clock::now();
+		BuildRound();
+	}
+
+	// splitmix64 - the shuffle has to come out the same on every platform, which std::shuffle doesn't promise
+	uint64_t NextRandom () {
+		uint64_t z = ( rngState += 0x9E3779B97F4A7C15ull );
+		z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+		z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+		return z ^ ( z >> 31 );
+	}
+	float NextUniform () { return float( NextRandom() >> 40 ) / float( 1ull << 24 ); }
+
+	float PredictedCost ( const uint32_t index ) const {
+		return ( tiles[ index ].cost > 0.0f ) ? tiles[ index ].cost : msPerTile;
+	}
+
+	static float PredictedError ( const tileState_t &tile ) {
+		return std::sqrt( tile.variance / float( std::max( tile.samples, 1u ) ) );
+	}
+
+	tile_t Pop () {
+		if ( tiles.empty() ) return tile_t { glm::ivec2( 0 ), 0 };
+		if ( roundOffset == round.size() ) { // catch the case where we completed a round
+			rounds++;
+			BuildRound();
+		}
+		const uint32_t index = round[ roundOffset++ ];
+		tiles[ index ].samples++;
+		tiles[ index ].lastRound = rounds;
+		totalDispatched++;
+		return tile_t { tiles[ index ].offset, index };
+	}
+
+	void BuildRound () {
+		round.clear();
+		roundOffset = 0;
+		if ( !adaptivePriority || !haveVariance ) {
+			// every tile once
+			for ( uint32_t i = 0; i < tiles.size(); i++ ) round.push_back( i );
+		} else {
+			// tiles without an estimate get their one visit, converged tiles wait their turn, and the rest share
+				// the remaining visits by expected error reduction per ms - d( sqrt( v / n ) ) ~ error / 2n, over cost
+			std::vector< float > weight( tiles.size(), 0.0f );
+			float totalWeight = 0.0f;
+			uint32_t numActive = 0;
+			for ( uint32_t i = 0; i < tiles.size(); i++ ) {
+				const tileState_t &tile = tiles[ i ];
+				if ( !tile.haveVariance ) {
+					round.push_back( i );
+					continue;
+				}
+				const float error = PredictedError( tile );
+				if ( targetError > 0.0f && error < targetError ) {
+					if ( rounds - tile.lastRound >= convergedInterval ) round.push_back( i );
+					continue;
+				}
+				const float cost = std::max( PredictedCost( i ), 1e-6f );
+				weight[ i ] = error / ( 2.0f * float( std::max( tile.samples, 1u ) ) * ( msPerTile > 0.0f ? cost : 1.0f ) );
+				totalWeight += weight[ i ];
+				numActive++;
+			}
+			// one visit per active tile on average, so a round stays about as long as a pass
+			if ( totalWeight > 0.0f ) {
+				for ( uint32_t i = 0; i < tiles.size(); i++ ) {
+					if ( weight[ i ] == 0.0f ) continue;
+					const float share = std::min( float( maxVisitsPerRound ), weight[ i ] / totalWeight * numActive );
+					uint32_t visits = uint32_t( share );
+					if ( NextUniform() < share - float( visits ) ) visits++; // stochastic rounding, keeps the expectation
+					for ( uint32_t v = 0; v < visits; v++ ) round.push_back( i );
+				}
+			}
+			if ( round.empty() ) { // everything converged and resting - keep going anyways
+				for ( uint32_t i = 0; i < tiles.size(); i++ ) round.push_back( i );
+			}
+		}
+		// Fisher-Yates off of the seeded generator
+		for ( size_t i = round.size(); i > 1; i-- ) {
+			std::swap( round[ i - 1 ], round[ NextRandom() % i ] );
+		}
+	}
+};
+
+//===== Simulation ====================================================================================================
+// a synthetic image for the scheduler, no GPU - each tile has a per-sample variance and a cost per dispatch, drawn so
+	// that a few tiles ( caustics, glossy interreflection ) are noisy and expensive, and most ( sky, diffuse walls ) are
+	// neither. Compares the fixed batch, every-tile-every-pass schedule the old dispenser used against the adaptive one.
+struct tileSchedulerSimulation_t {
+	uint32_t tileSize = 128;
+	uint32_t width = 1920;
+	uint32_t height = 1080;
+	uint64_t seed = 1;
+	float frameBudgetMS = 16.0f;
+	float queryOverheadMS = 0.05f;		// a timer query + wait, per batch
+	float targetError = 0.01f;			// every tile has to reach this standard error
+	float varianceEstimateNoise = 0.2f;	// relative error on the variance the consumer reports
+
+	struct result_t {
+		uint32_t numTiles = 0;
+		// time to target noise, simulated GPU ms, including query overhead
+		double baselineMS = 0.0;
+		double adaptiveMS = 0.0;
+		uint64_t baselineTiles = 0;
+		uint64_t adaptiveTiles = 0;
+		// frame budgeting, fixed tilesBetweenQueries vs cost-adapted batches
+		float baselineOvershootMS = 0.0f;	// mean time past the budget, per frame
+		float adaptiveOvershootMS = 0.0f;
+		float baselineQueriesPerFrame = 0.0f;
+		float adaptiveQueriesPerFrame = 0.0f;
+		bool reproducible = false;			// same seed, same first rounds
+	};
+
+	result_t Run () const {
+		result_t result;
+
+		// the synthetic scene
+		uint64_t state = seed;
+		auto uniform = [ &state ] () {
+			uint64_t z = ( state += 0x9E3779B97F4A7C15ull );
+			z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+			z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+			return float( ( z ^ ( z >> 31 ) ) >> 40 ) / float( 1ull << 24 );
+		};
+		tileScheduler_t probe( tileSize, width, height, seed );
+		const uint32_t numTiles = probe.Count();
+		result.numTiles = numTiles;
+		std::vector< float > variance( numTiles ), cost( numTiles );
+		for ( uint32_t i = 0; i < numTiles; i++ ) {
+			const bool hard = uniform() < 0.15f;
+			variance[ i ] = hard ? 0.5f + 2.0f * uniform() : 0.002f + 0.03f * uniform();
+			cost[ i ] = ( hard ? 0.6f : 0.25f ) * ( 0.75f + 0.5f * uniform() );
+		}
+
+		auto simulate = [ & ] ( const bool adaptive, double &ms, uint64_t &dispatched, float &overshoot, float &queries ) {
+			tileScheduler_t scheduler;
+			scheduler.tileSize = tileSize; scheduler.imageWidth = width; scheduler.imageHeight = height; scheduler.seed = seed;
+			scheduler.tileTimeLimitMS = frameBudgetMS;
+			scheduler.adaptiveBatches = adaptive;
+			scheduler.adaptivePriority = adaptive;
+			scheduler.targetError = adaptive ? targetError : 0.0f;
+			scheduler.RegenerateTileList();
+
+			uint64_t noiseState = seed * 7 + 3;
+			auto noise = [ &noiseState ] () {
+				uint64_t z = ( noiseState += 0x9E3779B97F4A7C15ull );
+				z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+				return float( ( z ^ ( z >> 27 ) ) >> 40 ) / float( 1ull << 24 ) * 2.0f - 1.0f;
+			};
+
+			std::vector< uint32_t > samples( numTiles, 0 );
+			auto converged = [ & ] () {
+				for ( uint32_t i = 0; i < numTiles; i++ ) {
+					if ( samples[ i ] == 0 || std::sqrt( variance[ i ] / samples[ i ] ) > targetError ) return false;
+				}
+				return true;
+			};
+
+			ms = 0.0; dispatched = 0;
+			double overshootSum = 0.0;
+			uint64_t frames = 0, numQueries = 0;
+			const uint64_t limit = uint64_t( numTiles ) * 100000; // bail out, in case something never converges
+			while ( !converged() && dispatched < limit ) {
+				// one frame, run like the render loop - batches, then a timer query, until over budget
+				float elapsed = 0.0f;
+				while ( true ) {
+					const uint32_t batch = scheduler.NextBatchSize( elapsed );
+					float batchMS = 0.0f;
+					for ( uint32_t b = 0; b < batch; b++ ) {
+						const tileScheduler_t::tile_t tile = scheduler.NextTile();
+						batchMS += cost[ tile.index ];
+						samples[ tile.index ]++;
+						if ( adaptive ) { // the consumer's estimate, off by some amount
+							scheduler.ReportVariance( tile.index, variance[ tile.index ] * ( 1.0f + varianceEstimateNoise * noise() ) );
+						}
+					}
+					dispatched += batch;
+					elapsed += batchMS + queryOverheadMS;
+					numQueries++;
+					scheduler.ReportBatch( batch, batchMS );
+					if ( elapsed > frameBudgetMS ) break;
+				}
+				ms += elapsed;
+				overshootSum += elapsed - frameBudgetMS;
+				frames++;
+			}
+			overshoot = float( overshootSum / std::max( frames, uint64_t( 1 ) ) );
+			queries = float( double( numQueries ) / std::max( frames, uint64_t( 1 ) ) );
+		};
+
+		simulate( false, result.baselineMS, result.baselineTiles, result.baselineOvershootMS, result.baselineQueriesPerFrame );
+		simulate( true, result.adaptiveMS, result.adaptiveTiles, result.adaptiveOvershootMS, result.adaptiveQueriesPerFrame );
+
+		// same seed, same order
+		tileScheduler_t a( tileSize, width, height, seed ), b( tileSize, width, height, seed );
+		result.reproducible = true;
+		for ( uint32_t i = 0; i < numTiles * 3; i++ ) {
+			if ( a.NextTile().index != b.NextTile().index ) result.reproducible = false;
+		}
+		return result;
+	}
+};
+
+#endif // TILESCHEDULER_H
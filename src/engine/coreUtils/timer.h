@@ -7,6 +7,7 @@
 #include <algorithm>
 
 #include "math.h"
+#include "profiler.h"
 
 inline std::string timeDateString () {
 	auto now = std::chrono::system_clock::now();
@@ -199,7 +200,9 @@ class scopedTimer {
 public:
 	queryPair_CPU c;
 	queryPair_GPU q;
-	scopedTimer ( string label ) : c ( label ), q ( label ) {
+	cpuProfiler::scope_t profile; // same scope, in the hierarchical recorder - nested scopes and workers show up under it
+	scopedTimer ( string label ) : scopedTimer( label, cpuProfiler::Intern( label ) ) {}
+	scopedTimer ( string label, const uint32_t profileLabel ) : c ( label ), q ( label ), profile( profileLabel ) {
 		// GPU query prep
 		glGenQueries( 2, &q.queryID[ 0 ] );
 		glQueryCounter( q.queryID[ 0 ], GL_TIMESTAMP );
@@ -219,6 +222,11 @@ public:
 	}
 };
 
+// use through this, so the profiler label is interned once per call site instead of hashed on every construction
+#define SCOPED_TIMER( name ) \
+	static const uint32_t PROFILE_CONCAT( timerLabel_, __LINE__ ) = cpuProfiler::Intern( name ); \
+	scopedTimer PROFILE_CONCAT( scopedTimer_, __LINE__ ) ( name, PROFILE_CONCAT( timerLabel_, __LINE__ ) )
+
 // Timing for the initialization code, similar to scoped timers but outputs to CLI
 class Block {
 const int reportWidth = 40;
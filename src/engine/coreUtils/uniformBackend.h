@@ -0,0 +1,178 @@
+#pragma once
+#ifndef UNIFORM_BACKEND_H
+#define UNIFORM_BACKEND_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+// the GL calls the uniform cache makes - reflecting a program's active uniforms, and uploading values. Same split
+	// as textureBackend.h: uniformBackendGL_t forwards straight to GL, uniformBackendRecording_t holds mock programs
+	// with a declared uniform list and logs what would have been called, so the cache can run headless.
+
+// one entry from glGetActiveUniform, with its location - arrays show up once, as "name[0]", with size > 1
+struct activeUniform_t {
+	std::string name;
+	GLenum type;
+	GLint size;
+	GLint location;
+};
+
+// bytes one element of this type takes in a shadow copy - samplers and images hold a unit, as an int
+inline size_t UniformTypeBytes ( const GLenum type ) {
+	switch ( type ) {
+		case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2: return 8;
+		case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3: return 12;
+		case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4: case GL_FLOAT_MAT2: return 16;
+		case GL_FLOAT_MAT3: return 36;
+		case GL_FLOAT_MAT4: return 64;
+		default: return 4;
+	}
+}
+
+//===== GL Backend ====================================================================================================
+struct uniformBackendGL_t {
+	void ActiveUniforms ( GLuint program, std::vector< activeUniform_t > &uniforms ) {
+		GLint count = 0, maxLength = 0;
+		glGetProgramiv( program, GL_ACTIVE_UNIFORMS, &count );
+		glGetProgramiv( program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength );
+		std::vector< GLchar > name( std::max( maxLength, 1 ) );
+		for ( GLint i = 0; i < count; i++ ) {
+			activeUniform_t uniform;
+			GLsizei length = 0;
+			glGetActiveUniform( program, GLuint( i ), GLsizei( name.size() ), &length, &uniform.size, &uniform.type, name.data() );
+			uniform.name.assign( name.data(), length );
+			uniform.location = glGetUniformLocation( program, name.data() );
+			if ( uniform.location >= 0 ) { // uniform block members have no location, and aren't set this way
+				uniforms.push_back( uniform );
+			}
+		}
+	}
+
+	GLint GetUniformLocation ( GLuint program, const char * name ) { return glGetUniformLocation( program, name ); }
+
+	// count elements of the declared type, starting at location
+	void Upload ( GLuint program, GLint location, GLenum type, GLsizei count, const void * data ) {
+		const GLfloat * f = ( const GLfloat * ) data;
+		const GLint * i = ( const GLint * ) data;
+		const GLuint * u = ( const GLuint * ) data;
+		switch ( type ) {
+			case GL_FLOAT:				glProgramUniform1fv( program, location, count, f ); break;
+			case GL_FLOAT_VEC2:			glProgramUniform2fv( program, location, count, f ); break;
+			case GL_FLOAT_VEC3:			glProgramUniform3fv( program, location, count, f ); break;
+			case GL_FLOAT_VEC4:			glProgramUniform4fv( program, location, count, f ); break;
+			case GL_FLOAT_MAT2:			glProgramUniformMatrix2fv( program, location, count, GL_FALSE, f ); break;
+			case GL_FLOAT_MAT3:			glProgramUniformMatrix3fv( program, location, count, GL_FALSE, f ); break;
+			case GL_FLOAT_MAT4:			glProgramUniformMatrix4fv( program, location, count, GL_FALSE, f ); break;
+			case GL_INT_VEC2:
+			case GL_BOOL_VEC2:			glProgramUniform2iv( program, location, count, i ); break;
+			case GL_INT_VEC3:
+			case GL_BOOL_VEC3:			glProgramUniform3iv( program, location, count, i ); break;
+			case GL_INT_VEC4:
+			case GL_BOOL_VEC4:			glProgramUniform4iv( program, location, count, i ); break;
+			case GL_UNSIGNED_INT:		glProgramUniform1uiv( program, location, count, u ); break;
+			case GL_UNSIGNED_INT_VEC2:	glProgramUniform2uiv( program, location, count, u ); break;
+			case GL_UNSIGNED_INT_VEC3:	glProgramUniform3uiv( program, location, count, u ); break;
+			case GL_UNSIGNED_INT_VEC4:	glProgramUniform4uiv( program, location, count, u ); break;
+			default:					glProgramUniform1iv( program, location, count, i ); break; // int, bool, samplers, images
+		}
+	}
+};
+
+//===== Recording Backend =============================================================================================
+struct uniformBackendRecording_t {
+	enum call_e : uint8_t {
+		GET_PROGRAMIV, GET_ACTIVE_UNIFORM, GET_UNIFORM_LOCATION, UPLOAD, NUM_CALLS
+	};
+
+	struct call_t {
+		call_e call;
+		GLuint program;
+		GLint location;
+		GLenum type;
+		GLsizei count;
+		std::vector< uint8_t > data;	// what an upload sent
+	};
+
+	// turn off to only keep the counts, for long benchmark runs
+	bool keepLog = true;
+	std::vector< call_t > log;
+	size_t counts[ NUM_CALLS ] = { 0 };
+
+	size_t Count ( call_e call ) const { return counts[ call ]; }
+	size_t TotalCalls () const {
+		size_t total = 0;
+		for ( size_t c : counts ) total += c;
+		return total;
+	}
+
+	void Reset () {
+		log.clear();
+		for ( size_t &c : counts ) c = 0;
+	}
+
+	// declare what a mock program's link would have produced - { name, type, size }, locations are handed out in
+		// order, with arrays taking one per element like a real driver. Declaring it again is a relink.
+	void AddProgram ( GLuint program, const std::vector< activeUniform_t > &uniforms ) {
+		std::vector< activeUniform_t > &declared = programs[ program ];
+		declared.clear();
+		GLint location = 0;
+		for ( activeUniform_t uniform : uniforms ) {
+			if ( uniform.size > 1 && uniform.name.find( '[' ) == std::string::npos ) {
+				uniform.name += "[0]";
+			}
+			uniform.location = location;
+			location += std::max( uniform.size, 1 );
+			declared.push_back( uniform );
+		}
+	}
+
+	void ActiveUniforms ( GLuint program, std::vector< activeUniform_t > &uniforms ) {
+		Record( GET_PROGRAMIV, program );
+		Record( GET_PROGRAMIV, program );
+		auto it = programs.find( program );
+		if ( it == programs.end() ) return;
+		for ( auto &uniform : it->second ) {
+			Record( GET_ACTIVE_UNIFORM, program );
+			Record( GET_UNIFORM_LOCATION, program, uniform.location );
+			uniforms.push_back( uniform );
+		}
+	}
+
+	// "name" and "name[0]" both find an array, like the real thing - -1 for anything not declared
+	GLint GetUniformLocation ( GLuint program, const char * name ) {
+		GLint location = -1;
+		auto it = programs.find( program );
+		if ( it != programs.end() ) {
+			const size_t length = strlen( name );
+			for ( auto &uniform : it->second ) {
+				if ( uniform.name.compare( 0, length, name ) == 0 && ( uniform.name.size() == length || uniform.name.compare( length, std::string::npos, "[0]" ) == 0 ) ) {
+					location = uniform.location;
+					break;
+				}
+			}
+		}
+		Record( GET_UNIFORM_LOCATION, program, location );
+		return location;
+	}
+
+	void Upload ( GLuint program, GLint location, GLenum type, GLsizei count, const void * data ) {
+		counts[ UPLOAD ]++;
+		if ( keepLog ) {
+			const uint8_t * bytes = ( const uint8_t * ) data;
+			log.push_back( { UPLOAD, program, location, type, count, std::vector< uint8_t >( bytes, bytes + UniformTypeBytes( type ) * count ) } );
+		}
+	}
+
+private:
+	std::unordered_map< GLuint, std::vector< activeUniform_t > > programs;
+
+	void Record ( call_e call, GLuint program, GLint location = 0 ) {
+		counts[ call ]++;
+		if ( keepLog ) log.push_back( { call, program, location, 0, 0, {} } );
+	}
+};
+
+#endif // UNIFORM_BACKEND_H
@@ -0,0 +1,381 @@
+#pragma once
+#ifndef UNIFORMS_H
+#define UNIFORMS_H
+
+#include "../includes.h"
+#include "uniformBackend.h"
+
+// Uniform reflection cache - a program's active uniforms are queried once, the first time anything is set on it,
+	// and uniforms are then set through typed handles ( uniform_t ) that resolve to an index into that list on first
+	// use. Every value set is shadowed per program, and setting the value a uniform already holds makes no GL call.
+	// Programs replaced by a shader hot reload show up in shaderProgramCache_t::retired, and are dropped from here
+	// on the next Set - handles pointed at them resolve again against whatever program they're used with next.
+	// A uniform set through the cache should only ever be set through the cache, or the shadow goes stale - samplers
+	// and images excepted, they aren't shadowed, since the texture manager sets them too.
+
+//===== Typed Handles =================================================================================================
+template < typename T > struct uniformType_t; // no default, setting an unsupported type is a compile error
+template <> struct uniformType_t< float >		{ static constexpr GLenum type = GL_FLOAT; };
+template <> struct uniformType_t< vec2 >		{ static constexpr GLenum type = GL_FLOAT_VEC2; };
+template <> struct uniformType_t< vec3 >		{ static constexpr GLenum type = GL_FLOAT_VEC3; };
+template <> struct uniformType_t< vec4 >		{ static constexpr GLenum type = GL_FLOAT_VEC4; };
+template <> struct uniformType_t< int >			{ static constexpr GLenum type = GL_INT; };
+template <> struct uniformType_t< ivec2 >		{ static constexpr GLenum type = GL_INT_VEC2; };
+template <> struct uniformType_t< ivec3 >		{ static constexpr GLenum type = GL_INT_VEC3; };
+template <> struct uniformType_t< ivec4 >		{ static constexpr GLenum type = GL_INT_VEC4; };
+template <> struct uniformType_t< uint32_t >	{ static constexpr GLenum type = GL_UNSIGNED_INT; };
+template <> struct uniformType_t< uvec2 >		{ static constexpr GLenum type = GL_UNSIGNED_INT_VEC2; };
+template <> struct uniformType_t< uvec3 >		{ static constexpr GLenum type = GL_UNSIGNED_INT_VEC3; };
+template <> struct uniformType_t< uvec4 >		{ static constexpr GLenum type = GL_UNSIGNED_INT_VEC4; };
+template <> struct uniformType_t< mat2 >		{ static constexpr GLenum type = GL_FLOAT_MAT2; };
+template <> struct uniformType_t< mat3 >		{ static constexpr GLenum type = GL_FLOAT_MAT3; };
+template <> struct uniformType_t< mat4 >		{ static constexpr GLenum type = GL_FLOAT_MAT4; };
+
+// samplers and images - everything that isn't a scalar, vector or matrix
+inline bool UniformTypeIsOpaque ( const GLenum type ) {
+	switch ( type ) {
+		case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+		case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+		case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+		case GL_BOOL: case GL_BOOL_VEC2: case GL_BOOL_VEC3: case GL_BOOL_VEC4:
+		case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+		case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT3x2: case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3:
+		case GL_DOUBLE: case GL_DOUBLE_VEC2: case GL_DOUBLE_VEC3: case GL_DOUBLE_VEC4:
+		case GL_DOUBLE_MAT2: case GL_DOUBLE_MAT3: case GL_DOUBLE_MAT4:
+			return false;
+		default:
+			return true;
+	}
+}
+
+// can a value of type given be set on a uniform declared as declared - bools take ints, samplers and images take a unit
+inline bool UniformTypeAccepts ( const GLenum declared, const GLenum given ) {
+	if ( declared == given ) return true;
+	switch ( declared ) {
+		case GL_BOOL:		return given == GL_INT || given == GL_UNSIGNED_INT;
+		case GL_BOOL_VEC2:	return given == GL_INT_VEC2 || given == GL_UNSIGNED_INT_VEC2;
+		case GL_BOOL_VEC3:	return given == GL_INT_VEC3 || given == GL_UNSIGNED_INT_VEC3;
+		case GL_BOOL_VEC4:	return given == GL_INT_VEC4 || given == GL_UNSIGNED_INT_VEC4;
+		default:			return given == GL_INT && UniformTypeIsOpaque( declared );
+	}
+}
+
+// a named uniform, declared once ( e.g. as a member of a per-pass parameter struct ) and reused every frame - the name
+	// is only looked at when it's used with a program it hasn't been resolved against yet, so it has to outlive the handle
+template < typename T > struct uniform_t {
+	using value_t = T;
+	const char * name;
+	GLuint program = 0;			// what index was resolved against
+	uint32_t generation = 0;	// and which reflection of it, a relink or a Forget() bumps this
+	int32_t index = -1;			// into the program's reflected uniforms, -1 when not active or the wrong type
+	uniform_t ( const char * name ) : name( name ) {}
+};
+
+//===== Uniform Cache =================================================================================================
+template < typename backend_t > class uniformCacheBase_t {
+public:
+	uniformCacheBase_t ( const std::vector< uint32_t > * retiredPrograms = nullptr ) : retiredPrograms( retiredPrograms ) {}
+
+	// where the GL calls go - uniformBackendRecording_t for headless use
+	backend_t gl;
+
+	// handles of programs replaced by a rebuild, oldest first - normally ShaderProgramCache().retired
+	const std::vector< uint32_t > * retiredPrograms = nullptr;
+
+	// called after a sampler or image unit is written - the texture manager also writes these, and keeps its own
+		// per-program cache of them, so the engine points this at textureManager_t::ForgetSamplerUnits. For the same
+		// reason, opaque uniforms aren't shadowed here, every set of one goes to GL
+	std::function< void( GLuint program, GLint location, GLsizei count ) > onSamplerUpload;
+
+	// accumulated since the last ResetStats()
+	struct stats_t {
+		size_t sets = 0;				// Set calls
+		size_t uploads = 0;				// values that actually went to GL
+		size_t uploadsSkipped = 0;		// uniforms already holding the value
+		size_t reflections = 0;			// programs whose active uniforms were queried
+		size_t resolves = 0;			// handles looked up by name, first use or after their program changed
+		size_t missing = 0;				// names the program doesn't have active, e.g. optimized out
+		size_t typeMismatches = 0;		// handle type the shader doesn't declare - GL would reject the set, too
+		size_t programsRetired = 0;		// dropped after a hot reload replaced them
+	} stats;
+
+	template < typename T >
+	void Set ( const GLuint program, uniform_t< T > &uniform, const typename uniform_t< T >::value_t &value ) {
+		Set( program, uniform, &value, 1 );
+	}
+
+	// arrays, from element 0 - count is clamped to the declared size
+	template < typename T >
+	void Set ( const GLuint program, uniform_t< T > &uniform, const typename uniform_t< T >::value_t * values, const GLsizei count ) {
+		stats.sets++;
+		program_t &entry = Program( program );
+		if ( uniform.program != program || uniform.generation != entry.generation ) {
+			Resolve( program, entry, uniform );
+		}
+		if ( uniform.index < 0 ) return;
+
+		reflected_t &reflected = entry.uniforms[ uniform.index ];
+		const GLsizei n = std::min( count, reflected.size );
+		const size_t bytes = sizeof( T ) * n;
+		uint8_t * shadow = entry.shadow.data() + reflected.offset;
+		if ( !reflected.opaque && n <= reflected.known && memcmp( shadow, values, bytes ) == 0 ) {
+			stats.uploadsSkipped++;
+			return;
+		}
+		memcpy( shadow, values, bytes );
+		reflected.known = std::max( reflected.known, n );
+		gl.Upload( program, reflected.location, reflected.type, n, values );
+		stats.uploads++;
+		if ( reflected.opaque && onSamplerUpload ) {
+			onSamplerUpload( program, reflected.location, n );
+		}
+	}
+
+	// drop everything known about a program - the next Set on this handle reflects it again
+	void Forget ( const GLuint program ) {
+		programs.erase( program );
+		if ( program == lastProgram ) {
+			lastProgram = 0;
+			lastEntry = nullptr;
+		}
+	}
+
+	size_t NumPrograms () const { return programs.size(); }
+
+	void ResetStats () { stats = stats_t(); }
+
+	void Clear () {
+		programs.clear();
+		lastProgram = 0;
+		lastEntry = nullptr;
+		ResetStats();
+	}
+
+private:
+	struct reflected_t {
+		GLint location;
+		GLenum type;
+		GLsizei size;		// array elements, 1 for everything else
+		size_t offset;		// into the program's shadow
+		GLsizei known = 0;	// leading elements the shadow holds the uploaded value for
+		bool opaque;		// sampler or image, never skipped
+	};
+
+	struct program_t {
+		uint32_t generation = 0;
+		std::vector< reflected_t > uniforms;
+		std::unordered_map< std::string, int32_t > byName; // arrays under both "name[0]" and "name"
+		std::vector< uint8_t > shadow;
+	};
+
+	std::unordered_map< GLuint, program_t > programs;
+	uint32_t nextGeneration = 1;
+	size_t retiredSeen = 0;
+
+	// passes set several uniforms on one program in a row
+	GLuint lastProgram = 0;
+	program_t * lastEntry = nullptr;
+
+	program_t &Program ( const GLuint program ) {
+		if ( retiredPrograms != nullptr && retiredSeen != retiredPrograms->size() ) {
+			for ( ; retiredSeen < retiredPrograms->size(); retiredSeen++ ) {
+				const GLuint retired = ( *retiredPrograms )[ retiredSeen ];
+				stats.programsRetired += programs.count( retired );
+				Forget( retired );
+			}
+		}
+		if ( program == lastProgram && lastEntry != nullptr ) {
+			return *lastEntry;
+		}
+		auto it = programs.find( program );
+		if ( it == programs.end() ) {
+			it = programs.emplace( program, Reflect( program ) ).first;
+		}
+		lastProgram = program;
+		lastEntry = &it->second;
+		return it->second;
+	}
+
+	program_t Reflect ( const GLuint program ) {
+		stats.reflections++;
+		program_t entry;
+		entry.generation = nextGeneration++;
+		std::vector< activeUniform_t > active;
+		gl.ActiveUniforms( program, active );
+		size_t offset = 0;
+		for ( auto &uniform : active ) {
+			reflected_t reflected;
+			reflected.location = uniform.location;
+			reflected.type = uniform.type;
+			reflected.size = std::max( uniform.size, 1 );
+			reflected.opaque = UniformTypeIsOpaque( uniform.type );
+			reflected.offset = offset;
+			offset += UniformTypeBytes( uniform.type ) * reflected.size;
+
+			const int32_t index = int32_t( entry.uniforms.size() );
+			entry.uniforms.push_back( reflected );
+			entry.byName[ uniform.name ] = index;
+			const size_t length = uniform.name.size();
+			if ( length > 3 && uniform.name.compare( length - 3, 3, "[0]" ) == 0 ) {
+				entry.byName[ uniform.name.substr( 0, length - 3 ) ] = index;
+			}
+		}
+		entry.shadow.resize( offset );
+		return entry;
+	}
+
+	template < typename T >
+	void Resolve ( const GLuint program, program_t &entry, uniform_t< T > &uniform ) {
+		stats.resolves++;
+		uniform.program = program;
+		uniform.generation = entry.generation;
+		uniform.index = -1;
+		auto it = entry.byName.find( uniform.name );
+		if ( it == entry.byName.end() ) {
+			stats.missing++;
+		} else if ( !UniformTypeAccepts( entry.uniforms[ it->second ].type, uniformType_t< T >::type ) ) {
+			stats.typeMismatches++;
+		} else {
+			uniform.index = it->second;
+		}
+	}
+};
+
+// what the engine uses
+using uniformCache_t = uniformCacheBase_t< uniformBackendGL_t >;
+
+// one per process, like the shader caches, and watching the program cache for hot reloads
+inline uniformCache_t &UniformCache () {
+	static uniformCache_t cache( &ShaderProgramCache().retired );
+	return cache;
+}
+
+//===== Uniform Cache Benchmark =======================================================================================
+// a frame's worth of uniform sets, shaped like a path tracer pass, against the recording backend - a location query
+	// and an upload for every uniform every frame, versus handles through the cache. Halfway through, every program is
+	// replaced, the way a hot reload does it, so the cached path pays for reflecting them again.
+struct uniformCacheBenchmark_t {
+	size_t numSets = 0;
+	double directMs = 0.0;
+	double cachedMs = 0.0;
+	size_t directCalls = 0;		// recorded GL calls, direct path
+	size_t cachedCalls = 0;		// recorded GL calls, through the cache
+	size_t uploadsSkipped = 0;	// values the cache found unchanged
+	size_t reflections = 0;		// programs the cache reflected
+};
+
+inline uniformCacheBenchmark_t RunUniformCacheBenchmark ( const size_t numFrames ) {
+	uniformCacheBenchmark_t result;
+	std::vector< uint32_t > retired;
+	uniformCacheBase_t< uniformBackendRecording_t > cache( &retired );
+	cache.gl.keepLog = false;
+
+	// per program - a few dozen scalars and vectors, mostly settings that sit still, a rule table, and a
+		// couple that change every frame ( sample count, seed )
+	constexpr int numPrograms = 6;
+	constexpr int numFloats = 16;
+	constexpr int numInts = 14;
+	constexpr int numVec3s = 6;
+	constexpr int numVolatile = 2;
+	constexpr int ruleSize = 25;
+	std::vector< string > names;
+	for ( int i = 0; i < numFloats; i++ ) names.push_back( "float" + to_string( i ) );
+	for ( int i = 0; i < numInts; i++ ) names.push_back( "int" + to_string( i ) );
+	for ( int i = 0; i < numVec3s; i++ ) names.push_back( "vec3" + to_string( i ) );
+	names.push_back( "rule" );
+
+	std::vector< activeUniform_t > declaration;
+	for ( int i = 0; i < numFloats; i++ ) declaration.push_back( { names[ i ], GL_FLOAT, 1, 0 } );
+	for ( int i = 0; i < numInts; i++ ) declaration.push_back( { names[ numFloats + i ], ( i % 3 == 2 ) ? GLenum( GL_BOOL ) : GLenum( GL_INT ), 1, 0 } );
+	for ( int i = 0; i < numVec3s; i++ ) declaration.push_back( { names[ numFloats + numInts + i ], GL_FLOAT_VEC3, 1, 0 } );
+	declaration.push_back( { names.back(), GL_INT, ruleSize, 0 } );
+
+	GLuint handles[ numPrograms ];
+	for ( int p = 0; p < numPrograms; p++ ) {
+		handles[ p ] = GLuint( p + 1 );
+		cache.gl.AddProgram( handles[ p ], declaration );
+	}
+	auto hotReload = [ & ] () {
+		for ( int p = 0; p < numPrograms; p++ ) {
+			retired.push_back( handles[ p ] );
+			handles[ p ] += numPrograms;
+			cache.gl.AddProgram( handles[ p ], declaration );
+		}
+	};
+
+	int rule[ ruleSize ];
+	for ( int i = 0; i < ruleSize; i++ ) rule[ i ] = i % 3;
+	auto floatValue = [] ( int p, int i ) { return 0.1f * ( p + 1 ) + i; };
+	auto intValue = [] ( int p, int i, size_t frame ) { return ( i < numVolatile ) ? int( frame * 7 + p ) : p + i; };
+	auto vec3Value = [] ( int p, int i ) { return vec3( p, i, 0.5f ); };
+
+	auto tStart = std::chrono::high_resolution_clock::now();
+	auto elapsedMs = [ & ] () {
+		const double ms = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::high_resolution_clock::now() - tStart ).count() / 1000.0;
+		tStart = std::chrono::high_resolution_clock::now();
+		return ms;
+	};
+
+	// direct path, a location query by name in front of every upload, like before
+	cache.gl.Reset();
+	elapsedMs();
+	for ( size_t frame = 0; frame < numFrames; frame++ ) {
+		if ( frame == numFrames / 2 ) hotReload();
+		for ( int p = 0; p < numPrograms; p++ ) {
+			const GLuint program = handles[ p ];
+			for ( int i = 0; i < numFloats; i++ ) {
+				const float value = floatValue( p, i );
+				cache.gl.Upload( program, cache.gl.GetUniformLocation( program, names[ i ].c_str() ), GL_FLOAT, 1, &value );
+			}
+			for ( int i = 0; i < numInts; i++ ) {
+				const int value = intValue( p, i, frame );
+				cache.gl.Upload( program, cache.gl.GetUniformLocation( program, names[ numFloats + i ].c_str() ), GL_INT, 1, &value );
+			}
+			for ( int i = 0; i < numVec3s; i++ ) {
+				const vec3 value = vec3Value( p, i );
+				cache.gl.Upload( program, cache.gl.GetUniformLocation( program, names[ numFloats + numInts + i ].c_str() ), GL_FLOAT_VEC3, 1, &value );
+			}
+			cache.gl.Upload( program, cache.gl.GetUniformLocation( program, names.back().c_str() ), GL_INT, ruleSize, rule );
+		}
+	}
+	result.directMs = elapsedMs();
+	result.directCalls = cache.gl.TotalCalls();
+
+	// same values, through handles held by the pass
+	for ( int p = 0; p < numPrograms; p++ ) {
+		handles[ p ] = GLuint( p + 1 );
+	}
+	struct passUniforms_t {
+		std::vector< uniform_t< float > > floats;
+		std::vector< uniform_t< int > > ints;
+		std::vector< uniform_t< vec3 > > vec3s;
+		uniform_t< int > rule { "rule" };
+	};
+	std::vector< passUniforms_t > passes( numPrograms );
+	for ( auto &pass : passes ) {
+		for ( int i = 0; i < numFloats; i++ ) pass.floats.emplace_back( names[ i ].c_str() );
+		for ( int i = 0; i < numInts; i++ ) pass.ints.emplace_back( names[ numFloats + i ].c_str() );
+		for ( int i = 0; i < numVec3s; i++ ) pass.vec3s.emplace_back( names[ numFloats + numInts + i ].c_str() );
+	}
+	cache.gl.Reset();
+	elapsedMs();
+	for ( size_t frame = 0; frame < numFrames; frame++ ) {
+		if ( frame == numFrames / 2 ) hotReload();
+		for ( int p = 0; p < numPrograms; p++ ) {
+			const GLuint program = handles[ p ];
+			passUniforms_t &pass = passes[ p ];
+			for ( int i = 0; i < numFloats; i++ ) cache.Set( program, pass.floats[ i ], floatValue( p, i ) );
+			for ( int i = 0; i < numInts; i++ ) cache.Set( program, pass.ints[ i ], intValue( p, i, frame ) );
+			for ( int i = 0; i < numVec3s; i++ ) cache.Set( program, pass.vec3s[ i ], vec3Value( p, i ) );
+			cache.Set( program, pass.rule, rule, ruleSize );
+		}
+	}
+	result.cachedMs = elapsedMs();
+	result.cachedCalls = cache.gl.TotalCalls();
+	result.uploadsSkipped = cache.stats.uploadsSkipped;
+	result.reflections = cache.stats.reflections;
+	result.numSets = numFrames * numPrograms * ( numFloats + numInts + numVec3s + 1 );
+	return result;
+}
+
+#endif // UNIFORMS_H
@@ -27,6 +27,22 @@ protected:
 	colorGradeParameters tonemap;
 	void TonemapControlsWindow();
 	void SendTonemappingParameters( const bool passthrough = false );
+
+	// uniforms set every frame by the engine's own passes, through UniformCache()
+	struct tonemapUniforms_t {
+		uniform_t< vec3 > colorTempAdjust { "colorTempAdjust" };
+		uniform_t< int > tonemapMode { "tonemapMode" };
+		uniform_t< float > gamma { "gamma" };
+		uniform_t< float > postExposure { "postExposure" };
+		uniform_t< mat3 > saturation { "saturation" };
+		uniform_t< int > enableVignette { "enableVignette" };
+		uniform_t< float > vignettePower { "vignettePower" };
+		uniform_t< int > passthrough { "passthrough" };
+	} tonemapUniforms;
+
+	struct displayUniforms_t {
+		uniform_t< vec2 > resolution { "resolution" };
+	} displayUniforms;
 	void PostProcessImguiMenu();
 
 //====== Initialization =======================================================
@@ -191,6 +191,10 @@ void engineBase::SetupTextureData () {
 		Block Start( "Setting Up Textures" );
 
 		textureManager.Init();
+		textureManager.retiredPrograms = &ShaderProgramCache().retired;
+		UniformCache().onSamplerUpload = [ this ] ( GLuint program, GLint location, GLsizei count ) {
+			textureManager.ForgetSamplerUnits( program, location, count );
+		};
 		textureOptions_t opts;
 
 	// =======================================================================
@@ -252,6 +256,7 @@ void engineBase::SetupTextureData () {
 
 		// font renderer data textures created internal to each layer via textureManager_local
 		textureManager.Add( "Font Atlas", opts );
+		textRenderer.LoadAtlas( ( const uint8_t * ) fontAtlas.GetImageDataBasePtr(), fontAtlas.Width(), fontAtlas.Height() );
 	// =======================================================================
 
 	// =======================================================================
@@ -521,6 +526,221 @@ void engineBase::TerminalSetup () {
 			terminal.addLineBreak();
 		}, "Give the texture manager usage report." );
 
+		terminal.addCommand( { "textureBindingBenchmark" }, {
+			{ "frames", INT, "How many frames worth of binds to run." }
+		}, [=] ( args_t args ) {
+			const textureBindingBenchmark_t result = RunTextureBindingBenchmark( size_t( std::max( 1, int( args[ "frames" ].data.x ) ) ) );
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "Texture Binding Benchmark ", 3 ).append( "[ " + GetWithThousandsSeparator( result.numBinds ) + " binds, recording backend ]", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  by label:  ", GREY_DD ).append( to_string( result.labelMs ) + "ms, " ).append( GetWithThousandsSeparator( result.labelCalls ) + " GL calls" ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  by handle: ", GREY_DD ).append( to_string( result.handleMs ) + "ms, " ).append( GetWithThousandsSeparator( result.handleCalls ) + " GL calls" ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  clears uploaded ", GREY_DD ).append( GetWithThousandsSeparator( result.clearTexelsUploaded ) ).append( " texels from host memory", GREY_DD ).flush() );
+			terminal.addLineBreak();
+		}, "Time label vs handle texture binds, headless, against a GL call recording backend." );
+
+		// uniform cache, against the recording backend
+		terminal.addCommand( { "uniformCacheBenchmark" }, {
+			{ "frames", INT, "How many frames worth of uniform sets to run." }
+		}, [=] ( args_t args ) {
+			const uniformCacheBenchmark_t result = RunUniformCacheBenchmark( size_t( std::max( 1, int( args[ "frames" ].data.x ) ) ) );
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "Uniform Cache Benchmark ", 3 ).append( "[ " + GetWithThousandsSeparator( result.numSets ) + " sets, recording backend ]", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  by name:   ", GREY_DD ).append( to_string( result.directMs ) + "ms, " ).append( GetWithThousandsSeparator( result.directCalls ) + " GL calls" ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  by handle: ", GREY_DD ).append( to_string( result.cachedMs ) + "ms, " ).append( GetWithThousandsSeparator( result.cachedCalls ) + " GL calls" ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  unchanged, skipped ", GREY_DD ).append( GetWithThousandsSeparator( result.uploadsSkipped ) ).append( ", programs reflected ", GREY_DD ).append( to_string( result.reflections ) ).flush() );
+			terminal.addLineBreak();
+		}, "Time uniform sets by name vs cached handles, headless, against a GL call recording backend." );
+
+		// text layers, dirty spans vs full uploads, composited on the CPU from the loaded font atlas
+		terminal.addCommand( { "textCompositorBenchmark" }, {
+			{ "frames", INT, "How many frames of text to composite." }
+		}, [=] ( args_t args ) {
+			const textCompositorBenchmark_t result = RunTextCompositorBenchmark( size_t( std::max( 1, int( args[ "frames" ].data.x ) ) ), textRenderer.numBinsWidth, textRenderer.numBinsHeight, textRenderer.atlas );
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "Text Compositor Benchmark ", 3 ).append( "[ " + to_string( textRenderer.numBinsWidth ) + "x" + to_string( textRenderer.numBinsHeight ) + " cells, CPU compositor ]", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  full:  ", GREY_DD ).append( to_string( result.fullMs ) + "ms/frame, " ).append( GetWithThousandsSeparator( result.fullBytes ) + " bytes up, " + GetWithThousandsSeparator( result.fullCells ) + " cells dispatched" ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  dirty: ", GREY_DD ).append( to_string( result.dirtyMs ) + "ms/frame, " ).append( GetWithThousandsSeparator( result.dirtyBytes ) + " bytes up, " + GetWithThousandsSeparator( result.dirtyCells ) + " cells dispatched" ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  unchanged layers skipped ", GREY_DD ).append( GetWithThousandsSeparator( result.unchangedLayers ) ).append( ", output identical: ", GREY_DD ).append( result.identical ? "yes" : "no" ).flush() );
+			terminal.addLineBreak();
+		}, "Time the text layers composited in full vs by dirty span and visible band, headless." );
+
+		// tile scheduler, against a synthetic image - no GPU involved
+		terminal.addCommand( { "tileSchedulerBenchmark" }, {
+			{ "tileSize", INT, "Tile size, in pixels." },
+			{ "targetError", FLOAT, "Standard error every tile has to reach." }
+		}, [=] ( args_t args ) {
+			tileSchedulerSimulation_t simulation;
+			simulation.tileSize = std::clamp( int( args[ "tileSize" ].data.x ), 16, 2048 );
+			simulation.targetError = std::max( 0.001f, args[ "targetError" ].data.x );
+			const tileSchedulerSimulation_t::result_t result = simulation.Run();
+			stringstream times, frames;
+			times << std::fixed << std::setprecision( 1 ) << result.baselineMS << "ms fixed vs " << result.adaptiveMS << "ms adaptive ( " << result.baselineMS / std::max( result.adaptiveMS, 1e-3 ) << "x )";
+			frames << std::fixed << std::setprecision( 2 ) << result.baselineOvershootMS << "ms / " << result.baselineQueriesPerFrame << " queries fixed vs " << result.adaptiveOvershootMS << "ms / " << result.adaptiveQueriesPerFrame << " queries adaptive";
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "Tile Scheduler Benchmark ", 3 ).append( "[ " + to_string( result.numTiles ) + " tiles, simulated ]", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  time to target noise: ", GREY_DD ).append( times.str() ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  tiles dispatched: ", GREY_DD ).append( GetWithThousandsSeparator( result.baselineTiles ) + " vs " + GetWithThousandsSeparator( result.adaptiveTiles ) ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  per frame, over budget: ", GREY_DD ).append( frames.str() ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  seeded order reproducible: ", GREY_DD ).append( result.reproducible ? "yes" : "no" ).flush() );
+			terminal.addLineBreak();
+		}, "Simulate time to a target noise level, fixed vs adaptive tile scheduling." );
+
+		// noise throughput, old vs batch
+		terminal.addCommand( { "noiseBenchmark" }, {
+			{ "dim", INT, "Image size, in pixels on a side." }
+		}, [=] ( args_t args ) {
+			const batchNoise::benchmarkResult_t result = batchNoise::Benchmark( uint32_t( std::clamp( int( args[ "dim" ].data.x ), 64, 8192 ) ) );
+			auto rate = [] ( double samplesPerSecond ) {
+				stringstream ss;
+				ss << std::fixed << std::setprecision( 1 ) << samplesPerSecond / 1e6 << "M samples/sec";
+				return ss.str();
+			};
+			stringstream ds;
+			ds << std::fixed << std::setprecision( 2 ) << result.legacyDiamondSquareMs << "ms nested vectors vs " << result.diamondSquareMs << "ms flat";
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "Noise Benchmark ", 3 ).append( "[ " + to_string( result.dim ) + "x" + to_string( result.dim ) + ", " + to_string( result.numThreads ) + " threads ]", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  PerlinNoise::noise:  ", GREY_DD ).append( rate( result.legacySamplesPerSecond ) ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  batch, one thread:   ", GREY_DD ).append( rate( result.batchSamplesPerSecond ) ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  batch, all threads:  ", GREY_DD ).append( rate( result.parallelSamplesPerSecond ) ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  6 octave fBm:        ", GREY_DD ).append( rate( result.fbmSamplesPerSecond ) + " ( per octave )" ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  diamond square:      ", GREY_DD ).append( ds.str() ).flush() );
+			terminal.addLineBreak();
+		}, "Time noise generation, PerlinNoise vs the batch noise library, plus diamond square." );
+
+		// lens distortion, per-pixel reference vs the precomputed warp field
+		terminal.addCommand( { "lensWarpBenchmark" }, {
+			{ "dim", INT, "Image size, in pixels on a side." },
+			{ "iterations", INT, "Number of distortion taps per pixel." }
+		}, [=] ( args_t args ) {
+			const lensWarpBenchmark_t result = LensWarpBenchmark( uint32_t( std::clamp( int( args[ "dim" ].data.x ), 16, 4096 ) ), std::clamp( int( args[ "iterations" ].data.x ), 1, 256 ) );
+			stringstream times;
+			times << std::fixed << std::setprecision( 2 ) << result.referenceMs << "ms per-pixel vs " << result.buildMs << "ms build + " << result.applyMs << "ms apply ( " << result.referenceMs / std::max( result.applyMs, 0.001 ) << "x )";
+			stringstream error;
+			error << std::scientific << std::setprecision( 2 ) << result.maxError;
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "Lens Warp Benchmark ", 3 ).append( "[ " + to_string( result.dim ) + "x" + to_string( result.dim ) + ", " + to_string( result.iterations ) + " taps, " + to_string( result.numThreads ) + " threads ]", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  chromatic:  ", GREY_DD ).append( times.str() ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  max error:  ", GREY_DD ).append( error.str() ).flush() );
+			terminal.addLineBreak();
+		}, "Time the chromatic multisample lens distort, per-pixel evaluation vs the cached warp field." );
+
+		// Image2 resampling, separable filters vs stb_image_resize
+		terminal.addCommand( { "resampleBenchmark" }, {
+			{ "dim", INT, "Image size, in pixels on a side." }
+		}, [=] ( args_t args ) {
+			const resampleBenchmark_t result = ResampleBenchmark( uint32_t( std::clamp( int( args[ "dim" ].data.x ), 16, 8192 ) ) );
+			auto line = [] ( double ms, double psnr ) {
+				stringstream ss;
+				ss << std::fixed << std::setprecision( 2 ) << ms << "ms, round trip " << psnr << "dB";
+				return ss.str();
+			};
+			const string names[ resampleBenchmark_t::numFilters ] = { "  box:                ", "  tent:               ", "  lanczos3:           ", "  mitchell:           " };
+			stringstream mips;
+			mips << std::fixed << std::setprecision( 2 ) << result.stbMipMs << "ms stb vs " << result.mipChainMs << "ms BuildMipChain";
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "Resample Benchmark ", 3 ).append( "[ " + to_string( result.dim ) + "x" + to_string( result.dim ) + " RGBA32F, 2x down, " + to_string( result.numThreads ) + " threads ]", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  stb_image_resize:   ", GREY_DD ).append( line( result.stbMs, result.stbPSNR ) ).flush() );
+			for ( int f = 0; f < resampleBenchmark_t::numFilters; f++ ) {
+				terminal.addHistoryLine( terminal.csb.append( names[ f ], GREY_DD ).append( line( result.filterMs[ f ], result.filterPSNR[ f ] ) ).flush() );
+			}
+			terminal.addHistoryLine( terminal.csb.append( "  full mip chain:     ", GREY_DD ).append( mips.str() ).flush() );
+			terminal.addLineBreak();
+		}, "Time Image2 resampling per filter against stb_image_resize, with round trip PSNR, plus mip chain generation." );
+
+		// Image2 pixel sorting, comparison sort vs the radix engine
+		terminal.addCommand( { "pixelSortBenchmark" }, {
+			{ "width", INT, "Image width, in pixels." },
+			{ "height", INT, "Image height, in pixels." }
+		}, [=] ( args_t args ) {
+			const pixelSortBenchmark_t result = PixelSortBenchmark( uint32_t( std::clamp( int( args[ "width" ].data.x ), 16, 8192 ) ), uint32_t( std::clamp( int( args[ "height" ].data.x ), 16, 8192 ) ) );
+			auto line = [] ( double ms ) {
+				stringstream ss;
+				ss << std::fixed << std::setprecision( 2 ) << ms << "ms ( " << std::setprecision( 1 ) << 1000.0 / std::max( ms, 0.001 ) << " fps )";
+				return ss.str();
+			};
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "Pixel Sort Benchmark ", 3 ).append( "[ " + to_string( result.width ) + "x" + to_string( result.height ) + " RGBA8, " + to_string( result.numThreads ) + " threads ]", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  std::sort, luma columns:     ", GREY_DD ).append( line( result.referenceMs ) ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  radix, luma columns:         ", GREY_DD ).append( line( result.columnsMs ) ).append( result.matches ? "  matches" : "  MISMATCH", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  radix, hue intervals at 30:  ", GREY_DD ).append( line( result.angledMs ) ).flush() );
+			terminal.addLineBreak();
+		}, "Time pixel sorting, the per-line comparison sort vs radix sorted threshold intervals." );
+
+		// shader cache report - what the last reload(s) rebuilt, and what they got to skip
+		terminal.addCommand( { "shaderCacheReport" }, {},
+		[=] ( args_t args ) {
+			shaderProgramCache_t &programs = ShaderProgramCache();
+			shaderIncludeCache_t &includes = ShaderIncludeCache();
+			stringstream times;
+			times << std::fixed << std::setprecision( 2 ) << programs.stats.msSpent << "ms rebuilding, " << programs.stats.msSaved << "ms saved, " << programs.stats.msChecking << "ms checking";
+
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "Shader Cache Report ", 3 ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "[ Summary: ", GREY_DD ).append( to_string( programs.NumPrograms() ) ).append( " programs, ", GREY_DD ).append( to_string( includes.NumFiles() ) ).append( " include files cached ]", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  " + to_string( programs.stats.reused ) + " reused, " + to_string( programs.stats.rebuilt ) + " rebuilt since last report" ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  " + times.str() ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  include files: " + to_string( includes.stats.fileReads ) + " reads, " + to_string( includes.stats.cacheHits ) + " cache hits, " + to_string( includes.stats.invalidations ) + " invalidations", GREY_DD ).flush() );
+			for ( auto& key : programs.stats.rebuiltKeys ) {
+				terminal.addHistoryLine( terminal.csb.append( "  rebuilt: ", GREY_DD ).append( key, 2 ).flush() );
+			}
+			terminal.addLineBreak();
+			programs.ResetStats();
+		}, "Report shader program cache usage since the last report, including time saved on reload." );
+
+		terminal.addCommand( { "profilerReport" }, {},
+		[=] ( args_t args ) {
+			cpuProfiler::collector_t &collector = cpuProfiler::Collector();
+			std::lock_guard< std::mutex > guard( collector.lock );
+
+			// sort the labels that have seen any samples by total time spent
+			std::vector< uint32_t > order;
+			const uint32_t numLabels = std::min( cpuProfiler::Labels().count.load(), cpuProfiler::maxLabels );
+			for ( uint32_t i = 0; i < numLabels; i++ ) {
+				if ( collector.stats[ i ].count != 0 ) order.push_back( i );
+			}
+			std::sort( order.begin(), order.end(), [ &collector ] ( uint32_t a, uint32_t b ) {
+				return collector.stats[ a ].totalMs > collector.stats[ b ].totalMs;
+			} );
+
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "CPU Profiler Report ", 3 ).append( "[ " + GetWithThousandsSeparator( collector.collected ) + " scopes over " + GetWithThousandsSeparator( collector.frames ) + " frames, " + GetWithThousandsSeparator( collector.dropped ) + " dropped ]", GREY_DD ).flush() );
+			const size_t shown = std::min( order.size(), size_t( 20 ) );
+			for ( size_t i = 0; i < shown; i++ ) {
+				const cpuProfiler::labelStats_t &s = collector.stats[ order[ i ] ];
+				float p50, p99;
+				s.Percentiles( p50, p99 );
+				stringstream line;
+				line << std::fixed << std::setprecision( 3 ) << "  " << s.totalMs << "ms total, " << s.count << " calls, mean " << s.totalMs / s.count << "ms, p50 " << p50 << "ms, p99 " << p99 << "ms, max " << s.maxMs << "ms";
+				terminal.addHistoryLine( terminal.csb.append( "  " + cpuProfiler::LabelName( order[ i ] ), 2 ).flush() );
+				terminal.addHistoryLine( terminal.csb.append( line.str(), GREY_DD ).flush() );
+			}
+			terminal.addLineBreak();
+		}, "Report CPU profiler scopes by total time, with call counts, mean, p50, p99 and max over the recent window." );
+
+		terminal.addCommand( { "profilerCapture" }, { { "frames", INT, "Number of frames to capture." } },
+		[=] ( args_t args ) {
+			const uint32_t frames = uint32_t( std::max( 1, args[ "frames" ].data.x ) );
+			const string path = "profilerTrace_" + timeDateString() + ".json";
+			cpuProfiler::Collector().StartCapture( frames, path );
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "CPU Profiler Capture ", 3 ).append( "[ " + to_string( frames ) + " frames to " + path + " ]", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( "  open in chrome://tracing or ui.perfetto.dev", GREY_DD ).flush() );
+			terminal.addLineBreak();
+		}, "Capture every CPU profiler scope for the next N frames, and write them out as a Chrome trace." );
+
+		terminal.addCommand( { "profilerOverhead" }, { { "iterations", INT, "Number of nested scope pairs to record." } },
+		[=] ( args_t args ) {
+			const uint32_t iterations = uint32_t( std::max( 1, args[ "iterations" ].data.x ) );
+			const double timestampNs = cpuProfiler::TimestampCost( iterations );
+			const double scopeNs = cpuProfiler::MeasureOverhead( iterations );
+			stringstream line;
+			line << std::fixed << std::setprecision( 2 ) << "  " << scopeNs << "ns per scope, " << timestampNs << "ns per timestamp ( two per scope )";
+			terminal.addLineBreak();
+			terminal.addHistoryLine( terminal.csb.append( "CPU Profiler Overhead ", 3 ).append( "[ " + GetWithThousandsSeparator( iterations * 2 ) + " scopes ]", GREY_DD ).flush() );
+			terminal.addHistoryLine( terminal.csb.append( line.str() ).flush() );
+			terminal.addLineBreak();
+		}, "Measure the cost of recording an empty CPU profiler scope, against the cost of the timestamps it reads." );
+
 		// screenshots? not sure what exactly that's going to look like yet
 
 		// more...?
@@ -1,7 +1,7 @@
 #include "engine.h"
 
 void engineBase::ClearColorAndDepth () {
-	ZoneScoped; scopedTimer( "Clear Color and Depth" );
+	ZoneScoped; SCOPED_TIMER( "Clear Color and Depth" );
 
 	// clear the screen
 	glClearColor( config.clearColor.x, config.clearColor.y, config.clearColor.z, config.clearColor.w );
@@ -44,20 +44,21 @@ void engineBase::SendTonemappingParameters ( const bool passthrough ) {
 	}
 
 	const GLuint shader = shaders[ "Tonemap" ];
-	glUniform3fv( glGetUniformLocation( shader, "colorTempAdjust" ), 1, glm::value_ptr( temperatureColor ) );
-	glUniform1i( glGetUniformLocation( shader, "tonemapMode" ), tonemap.tonemapMode );
-	glUniform1f( glGetUniformLocation( shader, "gamma" ), tonemap.gamma );
-	glUniform1f( glGetUniformLocation( shader, "postExposure" ), tonemap.postExposure );
-	glUniformMatrix3fv( glGetUniformLocation( shader, "saturation" ), 1, false, glm::value_ptr( saturationMatrix ) );
-	glUniform1i( glGetUniformLocation( shader, "enableVignette" ), tonemap.enableVignette );
-	glUniform1f( glGetUniformLocation( shader, "vignettePower" ), tonemap.vignettePower );
+	uniformCache_t &uniforms = UniformCache();
+	uniforms.Set( shader, tonemapUniforms.colorTempAdjust, temperatureColor );
+	uniforms.Set( shader, tonemapUniforms.tonemapMode, tonemap.tonemapMode );
+	uniforms.Set( shader, tonemapUniforms.gamma, tonemap.gamma );
+	uniforms.Set( shader, tonemapUniforms.postExposure, tonemap.postExposure );
+	uniforms.Set( shader, tonemapUniforms.saturation, saturationMatrix );
+	uniforms.Set( shader, tonemapUniforms.enableVignette, tonemap.enableVignette );
+	uniforms.Set( shader, tonemapUniforms.vignettePower, tonemap.vignettePower );
 
 	// bypass/passthrough
-	glUniform1i( glGetUniformLocation( shader, "passthrough" ), passthrough );
+	uniforms.Set( shader, tonemapUniforms.passthrough, passthrough );
 }
 
 void engineBase::BlitToScreen () {
-	ZoneScoped; scopedTimer Start( "Blit to Screen" );
+	ZoneScoped; SCOPED_TIMER( "Blit to Screen" );
 	const GLuint shader = shaders[ "Display" ];
 	glUseProgram( shader );
 	glBindVertexArray( displayVAO );
@@ -68,7 +69,7 @@ void engineBase::BlitToScreen () {
 	glDepthMask( GL_FALSE );
 
 	const ivec2 windowSize = window.GetWindowSize();
-	glUniform2f( glGetUniformLocation( shader, "resolution" ), windowSize.x, windowSize.y );
+	UniformCache().Set( shader, displayUniforms.resolution, vec2( windowSize ) );
 	textureManager.BindTexForShader( "Display Texture", "current", shaders[ "Display" ], 0 );
 	glDrawArrays( GL_TRIANGLES, 0, 3 );
 
@@ -144,33 +145,40 @@ void engineBase::HandleQuitEvents () {
 void engineBase::PrepareProfilingData () {
 	timerQueries_engine.gather();
 
-	// get rid of last frame's prepared task data
-	tasks_GPU.clear();
-	tasks_CPU.clear();
+	// drain the per-thread scope rings into the rolling stats ( and the trace, if a capture is running )
+	cpuProfiler::Collect();
+
+	// reuse last frame's task data - the set of scopes is usually the same from frame to frame, so this only
+		// touches the names when they change, instead of reallocating every one of them every frame
+	const size_t numQueries = timerQueries_engine.queries_CPU.size();
+	tasks_CPU.resize( numQueries );
+	tasks_GPU.resize( numQueries );
 
 	int color = 0;
 	float offset_CPU = 0;
 	float offset_GPU = 0;
-	for ( unsigned int i = 0; i < timerQueries_engine.queries_CPU.size(); i++ ) {
+	for ( unsigned int i = 0; i < numQueries; i++ ) {
 		color++;
 		color = color % legit::Colors::colorList.size();
-		legit::ProfilerTask pt_CPU;
-		legit::ProfilerTask pt_GPU;
+		legit::ProfilerTask &pt_CPU = tasks_CPU[ i ];
+		legit::ProfilerTask &pt_GPU = tasks_GPU[ i ];
 
 		// calculate start and end times
 		pt_CPU.startTime = offset_CPU / 1000.0f;
 		offset_CPU = offset_CPU + timerQueries_engine.queries_CPU[ i ].result;
 		pt_CPU.endTime = offset_CPU / 1000.0f;
-		pt_CPU.name = timerQueries_engine.queries_CPU[ i ].label;
+		if ( pt_CPU.name != timerQueries_engine.queries_CPU[ i ].label ) {
+			pt_CPU.name = timerQueries_engine.queries_CPU[ i ].label;
+		}
 		pt_CPU.color = legit::Colors::colorList[ color ]; // do better
-		tasks_CPU.push_back( pt_CPU );
 
 		pt_GPU.startTime = offset_GPU / 1000.0f;
 		offset_GPU = offset_GPU + timerQueries_engine.queries_GPU[ i ].result;
 		pt_GPU.endTime = offset_GPU / 1000.0f;
-		pt_GPU.name = timerQueries_engine.queries_GPU[ i ].label;
+		if ( pt_GPU.name != timerQueries_engine.queries_GPU[ i ].label ) {
+			pt_GPU.name = timerQueries_engine.queries_GPU[ i ].label;
+		}
 		pt_GPU.color = legit::Colors::colorList[ color ]; // do better
-		tasks_GPU.push_back( pt_GPU );
 	}
 	timerQueries_engine.clear(); // prepare for next frame's data
 }
@@ -138,23 +138,27 @@ using XMLDocument = tinyxml2::XMLDocument;
 // simplified texture management
 #include "./coreUtils/texture.h"
 
+// per-thread, nestable CPU scopes, with rolling stats and Chrome trace export
+#include "./coreUtils/profiler.h"
+
 // simple std::chrono and OpenGL timer queries wrappers
 #include "./coreUtils/timer.h"
 
+// splitting CPU work across threads
+#include "./coreUtils/parallel.h"
+
+// tile ordering and frame budgeting for the tiled pathtracers
+#include "./coreUtils/tileScheduler.h"
+
 // more polished input handling
 #include "./coreUtils/inputHandler.h"
 
-// orientation trident
-#include "../utils/trident/trident.h"
-
 // terminal
 #include "./coreUtils/terminal.h"
 
-// font rendering header
-#include "../utils/fonts/fontRenderer/renderer.h"
-
 // software rasterizer reimplementation
 #include "../utils/SoftRast/SoftRast.h"
+#include "../utils/SoftRast/meshAssembly.h"
 
 // tinyBVH software BVH build/traversal
 // #include "../utils/tinybvh/tiny_bvh.h"
@@ -162,6 +166,15 @@ using XMLDocument = tinyxml2::XMLDocument;
 // shader compilation wrapper
 #include "shaders/lib/shaderWrapper.h"
 
+// per-program uniform reflection, typed handles, redundant uploads skipped
+#include "./coreUtils/uniforms.h"
+
+// orientation trident
+#include "../utils/trident/trident.h"
+
+// font rendering header
+#include "../utils/fonts/fontRenderer/renderer.h"
+
 // bayer patterns 2, 4, 8 + four channel helper func
 #include "../data/bayer.h"
 
@@ -177,6 +190,9 @@ using XMLDocument = tinyxml2::XMLDocument;
 // templated diamond square heightmap generation
 #include "../utils/noise/diamondSquare/diamond_square.h"
 
+// float SIMD noise, filling images across threads, and a flat diamond square
+#include "../utils/noise/batchNoise.h"
+
 // particle based erosion
 #include "../utils/erosion/particleBased.h"
 
@@ -0,0 +1,85 @@
+// decode for the packed impostor primitives, see src/utils/primitiveCodec/primitiveCodec.h for the bit layout - each
+	// primitive is a uvec4, quantized against the bounds in the header of its cluster of 1024, and comes back out as
+	// the same 16 float parameters_t that the shaders used to read straight out of the buffer
+
+struct parameters_t {
+	float data[ 16 ];
+};
+
+// 32 bytes, matches primitiveCodec::clusterHeader_t
+struct clusterHeader_t {
+	vec3 boundsMin;
+	float maxScalar;
+	vec3 boundsMax;
+	float maxScale;
+};
+
+const uint primitiveClusterSize = 1024; // primitiveCodec::clusterSize
+
+uint PrimitiveBits ( uvec4 p, uint offset, uint width ) {
+	const uint word = offset / 32u;
+	const uint shift = offset % 32u;
+	uint value = p[ word ] >> shift;
+	if ( shift + width > 32u ) { // straddles a word boundary
+		value |= p[ word + 1u ] << ( 32u - shift );
+	}
+	return ( width == 32u ) ? value : ( value & ( ( 1u << width ) - 1u ) );
+}
+
+float PrimitiveDequantize ( uint q, float lo, float hi, uint bits ) {
+	const float maxQ = float( ( 1u << bits ) - 1u );
+	return ( hi <= lo ) ? lo : lo + ( float( q ) / maxQ ) * ( hi - lo );
+}
+
+vec3 PrimitivePosition ( uvec4 p, uint offset, clusterHeader_t h ) {
+	return vec3(
+		PrimitiveDequantize( PrimitiveBits( p, offset, 16u ), h.boundsMin.x, h.boundsMax.x, 16u ),
+		PrimitiveDequantize( PrimitiveBits( p, offset + 16u, 16u ), h.boundsMin.y, h.boundsMax.y, 16u ),
+		PrimitiveDequantize( PrimitiveBits( p, offset + 32u, 16u ), h.boundsMin.z, h.boundsMax.z, 16u ) );
+}
+
+parameters_t DecodePrimitive ( uvec4 p, clusterHeader_t h ) {
+	parameters_t parameters;
+	for ( int i = 0; i < 16; i++ ) {
+		parameters.data[ i ] = 0.0f;
+	}
+
+	const uint type = PrimitiveBits( p, 96u, 2u );
+	parameters.data[ 0 ] = float( type );
+
+	const float scalar = ( PrimitiveBits( p, 99u, 1u ) != 0u ? -1.0f : 1.0f ) * PrimitiveDequantize( PrimitiveBits( p, 100u, 12u ), 0.0f, h.maxScalar, 12u );
+	const vec3 position = PrimitivePosition( p, 0u, h );
+	parameters.data[ 1 ] = position.x;
+	parameters.data[ 2 ] = position.y;
+	parameters.data[ 3 ] = position.z;
+
+	if ( type == 0u ) { // sphere
+		parameters.data[ 4 ] = abs( scalar );
+		parameters.data[ 5 ] = scalar;
+	} else if ( type == 1u ) { // capsule
+		const vec3 pointB = PrimitivePosition( p, 48u, h );
+		parameters.data[ 4 ] = scalar;
+		parameters.data[ 5 ] = pointB.x;
+		parameters.data[ 6 ] = pointB.y;
+		parameters.data[ 7 ] = pointB.z;
+	} else if ( type == 2u ) { // rounded box
+		// theta at the bin center, so floor() still recovers phi
+		const float theta = ( float( PrimitiveBits( p, 48u, 12u ) ) + 0.5f ) / 4096.0f;
+		const float phi = float( int( PrimitiveBits( p, 60u, 9u ) ) - 256 );
+		parameters.data[ 4 ] = phi + theta;
+		for ( uint i = 0u; i < 3u; i++ ) {
+			parameters.data[ 5u + i ] = PrimitiveDequantize( PrimitiveBits( p, 69u + i * 9u, 9u ), 0.0f, h.maxScale, 9u );
+		}
+		parameters.data[ 8 ] = scalar;
+	}
+
+	if ( PrimitiveBits( p, 98u, 1u ) != 0u ) { // RGB565
+		parameters.data[ 12 ] = PrimitiveDequantize( PrimitiveBits( p, 112u, 5u ), 0.0f, 1.0f, 5u );
+		parameters.data[ 13 ] = PrimitiveDequantize( PrimitiveBits( p, 117u, 6u ), 0.0f, 1.0f, 6u );
+		parameters.data[ 14 ] = PrimitiveDequantize( PrimitiveBits( p, 123u, 5u ), 0.0f, 1.0f, 5u );
+		parameters.data[ 15 ] = -1.0f;
+	} else { // palette select + value
+		parameters.data[ 15 ] = float( PrimitiveBits( p, 120u, 8u ) ) + ( float( PrimitiveBits( p, 112u, 8u ) ) + 0.5f ) / 256.0f;
+	}
+	return parameters;
+}
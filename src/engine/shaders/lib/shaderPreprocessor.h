@@ -0,0 +1,360 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <cstring>
+
+// #include processing for shader files, with caching - no GL calls in here, the GL side is in shaderWrapper.h
+
+// Include files are read once and kept, keyed by name, along with their content hash and fully expanded text.
+	// Before a cached file is used it's checked on disk ( write time + size ), and only reread + rehashed when that
+	// changed - if the hash actually changed, everything that ( transitively ) includes it is invalidated. The
+	// output is byte-identical to stb_include_string() with STB_INCLUDE_LINE_GLSL, which this replaces.
+
+namespace shaderPreprocessor {
+
+	inline uint64_t Hash ( const std::string &s ) { // FNV-1a
+		uint64_t hash = 14695981039346656037ull;
+		for ( unsigned char c : s ) {
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	struct directive_t {
+		size_t offset;			// start of the #include line
+		size_t end;				// position of the newline ending it
+		std::string filename;	// empty for #inject
+		int nextLine;			// line number following the directive
+	};
+
+	// same parse as stb_include_find_includes() - only '#include "name"' and '#inject' at the start of a line
+	inline std::vector< directive_t > FindIncludes ( const std::string &text ) {
+		std::vector< directive_t > list;
+		const char * base = text.c_str();
+		const char * s = base;
+		int lineCount = 1;
+		auto isSpace = [] ( int ch ) { return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n'; };
+		while ( *s ) {
+			const char * start = s;
+			while ( *s == ' ' || *s == '\t' ) ++s;
+			if ( *s == '#' ) {
+				++s;
+				while ( *s == ' ' || *s == '\t' ) ++s;
+				if ( strncmp( s, "include", 7 ) == 0 && isSpace( s[ 7 ] ) ) {
+					s += 7;
+					while ( *s == ' ' || *s == '\t' ) ++s;
+					if ( *s == '"' ) {
+						const char * t = ++s;
+						while ( *t != '"' && *t != '\n' && *t != '\r' && *t != 0 ) ++t;
+						if ( *t == '"' ) {
+							const std::string filename( s, t - s );
+							s = t;
+							while ( *s != '\r' && *s != '\n' && *s != 0 ) ++s;
+							list.push_back( { size_t( start - base ), size_t( s - base ), filename, lineCount + 1 } );
+						}
+					}
+				} else if ( strncmp( s, "inject", 6 ) == 0 && ( isSpace( s[ 6 ] ) || s[ 6 ] == 0 ) ) {
+					while ( *s != '\r' && *s != '\n' && *s != 0 ) ++s;
+					list.push_back( { size_t( start - base ), size_t( s - base ), std::string(), lineCount + 1 } );
+				}
+			}
+			while ( *s != '\r' && *s != '\n' && *s != 0 ) ++s;
+			if ( *s == '\r' || *s == '\n' ) {
+				s = s + ( s[ 0 ] + s[ 1 ] == '\r' + '\n' ? 2 : 1 );
+			}
+			++lineCount;
+		}
+		return list;
+	}
+
+	// stb_include_itoa() - right aligned in 7 characters, plus one trailing space
+	inline std::string LineNumberField ( int n ) {
+		char str[ 9 ];
+		for ( int i = 0; i < 8; ++i ) str[ i ] = ' ';
+		str[ 8 ] = 0;
+		for ( int i = 1; i < 8; ++i ) {
+			str[ 7 - i ] = char( '0' + ( n % 10 ) );
+			n /= 10;
+			if ( n == 0 ) break;
+		}
+		return std::string( str );
+	}
+
+	inline double MillisecondsSince ( const std::chrono::high_resolution_clock::time_point &t ) {
+		return std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::high_resolution_clock::now() - t ).count() / 1000.0;
+	}
+}
+
+//=============================================================================
+//==== Include Cache ==========================================================
+//=============================================================================
+
+class shaderIncludeCache_t {
+public:
+	std::string includePath = "src/engine/shaders/lib";
+
+	struct stats_t {
+		size_t fileReads = 0;		// include files read from disk
+		size_t cacheHits = 0;		// expanded include text reused
+		size_t expansions = 0;		// include files expanded from their text
+		size_t invalidations = 0;	// expanded text thrown out because something it includes changed
+	} stats;
+
+	// expand every #include in source - dependencies, if given, collects the names of all the transitively
+		// included files. Returns false and fills out error when an include is missing or recursive.
+	bool Expand ( const std::string &source, std::string &result, std::string &error, std::set< std::string > * dependencies = nullptr ) {
+		std::vector< std::string > stack;
+		std::set< std::string > deps;
+		const bool success = ExpandText( source, shaderPreprocessor::FindIncludes( source ), result, error, deps, stack );
+		if ( dependencies ) dependencies->insert( deps.begin(), deps.end() );
+		return success;
+	}
+
+	// current content hash of an include, after checking the file on disk - 0 if it can't be read
+	uint64_t CurrentHash ( const std::string &name ) {
+		includeFile_t * file = Touch( name );
+		return file ? file->contentHash : 0;
+	}
+
+	size_t NumFiles () const { return files.size(); }
+
+	void Clear () {
+		files.clear();
+	}
+
+private:
+	struct includeFile_t {
+		uint64_t contentHash = 0;
+		std::filesystem::file_time_type writeTime;
+		uintmax_t size = 0;
+		std::string text;
+		std::vector< shaderPreprocessor::directive_t > directives;
+
+		bool expandedValid = false;
+		std::string expanded;
+		std::set< std::string > dependencies;	// everything this file pulls in, transitively
+		std::set< std::string > includedBy;		// files that directly include this one - the reverse edges
+	};
+	std::unordered_map< std::string, includeFile_t > files;
+
+	// make sure the cached copy of this file matches what's on disk - nullptr if it can't be read
+	includeFile_t * Touch ( const std::string &name ) {
+		const std::filesystem::path path = std::filesystem::path( includePath ) / name;
+		std::error_code ec;
+		const auto writeTime = std::filesystem::last_write_time( path, ec );
+		const uintmax_t size = ec ? 0 : std::filesystem::file_size( path, ec );
+		if ( ec ) return nullptr;
+
+		auto it = files.find( name );
+		if ( it != files.end() && it->second.writeTime == writeTime && it->second.size == size ) {
+			return &it->second; // unchanged since we last looked
+		}
+
+		std::ifstream in( path, std::ios::binary );
+		if ( !in.is_open() ) return nullptr;
+		std::stringstream contents;
+		contents << in.rdbuf();
+		stats.fileReads++;
+
+		includeFile_t &file = files[ name ];
+		const std::string text = contents.str();
+		const uint64_t hash = shaderPreprocessor::Hash( text );
+		file.writeTime = writeTime;
+		file.size = size;
+		if ( hash != file.contentHash || file.text.size() != text.size() ) {
+			// new, or the contents actually changed - not just touched
+			file.text = text;
+			file.contentHash = hash;
+			file.directives = shaderPreprocessor::FindIncludes( file.text );
+			Invalidate( name );
+		}
+		return &file;
+	}
+
+	// this file and everything above it in the graph needs to be expanded again
+	void Invalidate ( const std::string &name ) {
+		auto it = files.find( name );
+		if ( it == files.end() || ( !it->second.expandedValid && it->second.expanded.empty() ) ) return;
+		if ( it->second.expandedValid ) stats.invalidations++;
+		it->second.expandedValid = false;
+		it->second.expanded.clear();
+		const std::set< std::string > parents = it->second.includedBy;
+		for ( auto& parent : parents ) Invalidate( parent );
+	}
+
+	bool ExpandInclude ( const std::string &name, std::string &result, std::string &error, std::set< std::string > &deps, std::vector< std::string > &stack ) {
+		for ( auto& s : stack ) {
+			if ( s == name ) {
+				error = "recursive include of " + name;
+				return false;
+			}
+		}
+
+		includeFile_t * file = Touch( name );
+		if ( !file ) {
+			error = "could not open include file " + includePath + "/" + name;
+			return false;
+		}
+
+		// check the files below this one in the graph, too - a change there invalidates this one
+		if ( file->expandedValid ) {
+			const std::set< std::string > below = file->dependencies;
+			for ( auto& dep : below ) {
+				if ( !Touch( dep ) ) {
+					Invalidate( name );
+					break;
+				}
+			}
+			file = &files[ name ];
+		}
+
+		if ( file->expandedValid ) {
+			stats.cacheHits++;
+		} else {
+			stack.push_back( name );
+			std::string expanded;
+			std::set< std::string > fileDeps;
+			const std::string text = file->text; // copies - the map can rehash while expanding children
+			const std::vector< shaderPreprocessor::directive_t > directives = file->directives;
+			const bool success = ExpandText( text, directives, expanded, error, fileDeps, stack );
+			stack.pop_back();
+			if ( !success ) return false;
+			for ( auto& directive : directives ) {
+				if ( !directive.filename.empty() ) files[ directive.filename ].includedBy.insert( name );
+			}
+			file = &files[ name ];
+			file->expanded = std::move( expanded );
+			file->dependencies = std::move( fileDeps );
+			file->expandedValid = true;
+			stats.expansions++;
+		}
+
+		deps.insert( name );
+		deps.insert( file->dependencies.begin(), file->dependencies.end() );
+		result.append( file->expanded );
+		return true;
+	}
+
+	// the splice from stb_include_string(), GLSL style #line directives - inject is always null here
+	bool ExpandText ( const std::string &text, const std::vector< shaderPreprocessor::directive_t > &directives, std::string &result, std::string &error, std::set< std::string > &deps, std::vector< std::string > &stack ) {
+		std::string out;
+		out.reserve( text.size() );
+		size_t last = 0;
+		for ( size_t i = 0; i < directives.size(); i++ ) {
+			out.append( text, last, directives[ i ].offset - last );
+			if ( !out.empty() ) { // GLSL #version must appear first, so don't put a #line at the top
+				out += "#line " + shaderPreprocessor::LineNumberField( 1 ) + " " + shaderPreprocessor::LineNumberField( int( i ) + 1 ) + "\n";
+			}
+			if ( !directives[ i ].filename.empty() ) {
+				if ( !ExpandInclude( directives[ i ].filename, out, error, deps, stack ) ) {
+					return false;
+				}
+			}
+			out += "\n#line" + shaderPreprocessor::LineNumberField( directives[ i ].nextLine ) + " " + shaderPreprocessor::LineNumberField( 0 );
+			last = directives[ i ].end;
+		}
+		out.append( text, last, std::string::npos );
+		result.append( out );
+		return true;
+	}
+};
+
+//=============================================================================
+//==== Program Cache ==========================================================
+//=============================================================================
+
+// remembers which program handle came from which sources + includes, so a reload can hand back the existing
+	// program when nothing it depends on has changed. Handles are plain integers here, GL stays in shaderWrapper.h
+class shaderProgramCache_t {
+public:
+	struct entry_t {
+		uint32_t handle = 0;
+		uint64_t sourceHash = 0;
+		std::vector< std::pair< std::string, uint64_t > > includes; // transitive includes, with their hash at build time
+		double buildMs = 0.0; // preprocess + compile + link, what a rebuild would cost again
+	};
+
+	// accumulated since the last ResetStats()
+	struct stats_t {
+		size_t reused = 0;
+		size_t rebuilt = 0;
+		double msSpent = 0.0;	// building the programs that needed it
+		double msSaved = 0.0;	// what the reused programs took to build last time
+		double msChecking = 0.0;// reading sources + checking includes, for all requests
+		std::vector< std::string > rebuiltKeys;
+	} stats;
+
+	// handles that were replaced by a rebuild of the same key, oldest first - anything keeping per-program state
+		// ( uniform locations, shadowed values ) reads this with its own cursor and drops them. Never cleared.
+	std::vector< uint32_t > retired;
+
+	// handle of an up to date program for this key, or 0 if it needs to be ( re )built
+	uint32_t Lookup ( const std::string &key, const uint64_t sourceHash, shaderIncludeCache_t &includeCache ) {
+		const auto tStart = std::chrono::high_resolution_clock::now();
+		uint32_t handle = 0;
+		auto it = entries.find( key );
+		if ( it != entries.end() && it->second.sourceHash == sourceHash ) {
+			bool upToDate = true;
+			for ( auto& include : it->second.includes ) {
+				if ( includeCache.CurrentHash( include.first ) != include.second ) {
+					upToDate = false;
+					break;
+				}
+			}
+			if ( upToDate ) {
+				handle = it->second.handle;
+				stats.reused++;
+				stats.msSaved += it->second.buildMs;
+			}
+		}
+		stats.msChecking += shaderPreprocessor::MillisecondsSince( tStart );
+		return handle;
+	}
+
+	void Store ( const std::string &key, const uint32_t handle, const uint64_t sourceHash, const std::set< std::string > &dependencies, shaderIncludeCache_t &includeCache, const double buildMs ) {
+		entry_t entry;
+		entry.handle = handle;
+		entry.sourceHash = sourceHash;
+		entry.buildMs = buildMs;
+		for ( auto& dep : dependencies ) {
+			entry.includes.push_back( { dep, includeCache.CurrentHash( dep ) } );
+		}
+		auto it = entries.find( key );
+		if ( it != entries.end() && it->second.handle != handle ) {
+			retired.push_back( it->second.handle );
+		}
+		entries[ key ] = std::move( entry );
+		stats.rebuilt++;
+		stats.msSpent += buildMs;
+		stats.rebuiltKeys.push_back( key );
+	}
+
+	// failed builds are not kept, so the next request tries again
+	void Forget ( const std::string &key ) {
+		entries.erase( key );
+	}
+
+	size_t NumPrograms () const { return entries.size(); }
+
+	void ResetStats () { stats = stats_t(); }
+
+	void Clear () {
+		entries.clear();
+		ResetStats();
+	}
+
+private:
+	std::unordered_map< std::string, entry_t > entries;
+};
+
+#endif
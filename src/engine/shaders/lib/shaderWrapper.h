@@ -1,8 +1,8 @@
 #ifndef SHADER_H
 #define SHADER_H
 
-// #include processing for shader files
-#include "stb_include.h"
+// #include processing for shader files - cached, see shaderPreprocessor.h
+#include "shaderPreprocessor.h"
 
 #include <string>
 #include <iostream>
@@ -22,17 +22,39 @@ using std::string;
 using std::vector;
 using std::ifstream;
 using std::stringstream;
+using std::to_string;
+
+/*==============================================================================
+Shared caches, one per process - parsed include files, and the programs built
+from them, so hot reload only rebuilds what actually changed
+==============================================================================*/
+inline shaderIncludeCache_t &ShaderIncludeCache () {
+	static shaderIncludeCache_t cache;
+	return cache;
+}
+
+inline shaderProgramCache_t &ShaderProgramCache () {
+	static shaderProgramCache_t cache;
+	return cache;
+}
+
+// set false to force every program to be rebuilt, e.g. to check for driver issues
+inline bool &ShaderProgramCacheEnabled () {
+	static bool enabled = true;
+	return enabled;
+}
 
 /*==============================================================================
 Take in a string, potentially containing one or more #include statements, and
 return a string which contains all the header stuff in place of these statements
 ==============================================================================*/
-static string ProcessIncludeString ( string source ) {
-	char includeError[ 256 ];
-	char * inject = nullptr;
-	char * filename = nullptr;
-	char * cstrCode = stb_include_string( source.c_str(), inject, const_cast<char*>( "src/engine/shaders/lib" ), filename, includeError );
-	return string( cstrCode );
+static string ProcessIncludeString ( string source, std::set< string > * dependencies = nullptr ) {
+	string result, error;
+	if ( !ShaderIncludeCache().Expand( source, result, error, dependencies ) ) {
+		cout << "Shader include processing failed: " << error << endl;
+		return source;
+	}
+	return result;
 }
 
 // glObjectLabel() to label the resource, next time
@@ -131,12 +153,32 @@ public:
 	stringstream report;
 	regularShader ( string pathV, string pathF ) {
 		// read the source
-		string codeV = ProcessIncludeString( LoadStringFromFile( pathV, success ) );
-		string codeF = ProcessIncludeString( LoadStringFromFile( pathF, success ) );
+		string sourceV = LoadStringFromFile( pathV, success );
+		string sourceF = LoadStringFromFile( pathF, success );
+
+		// same files and includes as last time, nothing to do
+		const string key = pathV + "|" + pathF;
+		const uint64_t sourceHash = shaderPreprocessor::Hash( sourceV + '\0' + sourceF );
+		shaderHandle = ShaderProgramCacheEnabled() && success ? ShaderProgramCache().Lookup( key, sourceHash, ShaderIncludeCache() ) : 0;
+		if ( shaderHandle != 0 ) {
+			report << "Reused cached program, sources and includes unchanged." << endl;
+			return;
+		}
+
+		const auto tStart = std::chrono::high_resolution_clock::now();
+		std::set< string > dependencies;
+		string codeV = ProcessIncludeString( sourceV, &dependencies );
+		string codeF = ProcessIncludeString( sourceF, &dependencies );
 		// compile it
 		GLuint shaderV = ShaderCompile( codeV.c_str(), GL_VERTEX_SHADER, success, report );
 		GLuint shaderF = ShaderCompile( codeF.c_str(), GL_FRAGMENT_SHADER, success, report );
 		AttachAndLink( shaderHandle, { shaderV, shaderF }, success, report );
+
+		if ( success ) {
+			ShaderProgramCache().Store( key, shaderHandle, sourceHash, dependencies, ShaderIncludeCache(), shaderPreprocessor::MillisecondsSince( tStart ) );
+		} else {
+			ShaderProgramCache().Forget( key );
+		}
 	}
 };
 
@@ -153,19 +195,40 @@ public:
 	stringstream report;
 	enum class shaderSource { fromFile, fromString };
 	computeShader ( string input, shaderSource source = shaderSource::fromFile ) {
+		string key;
 		switch ( source ) {
 		case shaderSource::fromFile:
 			// input becomes the shader source, loaded from the path
 			cout << endl << "Loading shader from file:" << input << endl;
+			key = input;
 			input = LoadStringFromFile( input, success );
-			[[fallthrough]];
+			break;
 		case shaderSource::fromString:
-			// compile with "input" treated as the program source
-			input = ProcessIncludeString( input );
-			GLuint shaderC = ShaderCompile( input.c_str(), GL_COMPUTE_SHADER, success, report );
-			AttachAndLink( shaderHandle, { shaderC }, success, report );
+			// generated source, the contents are the key
+			key = "fromString:" + to_string( shaderPreprocessor::Hash( input ) );
 			break;
 		}
+
+		// same source and includes as last time, nothing to do
+		const uint64_t sourceHash = shaderPreprocessor::Hash( input );
+		shaderHandle = ShaderProgramCacheEnabled() && success ? ShaderProgramCache().Lookup( key, sourceHash, ShaderIncludeCache() ) : 0;
+		if ( shaderHandle != 0 ) {
+			report << "Reused cached program, source and includes unchanged." << endl;
+			return;
+		}
+
+		// compile with "input" treated as the program source
+		const auto tStart = std::chrono::high_resolution_clock::now();
+		std::set< string > dependencies;
+		input = ProcessIncludeString( input, &dependencies );
+		GLuint shaderC = ShaderCompile( input.c_str(), GL_COMPUTE_SHADER, success, report );
+		AttachAndLink( shaderHandle, { shaderC }, success, report );
+
+		if ( success ) {
+			ShaderProgramCache().Store( key, shaderHandle, sourceHash, dependencies, ShaderIncludeCache(), shaderPreprocessor::MillisecondsSince( tStart ) );
+		} else {
+			ShaderProgramCache().Forget( key );
+		}
 	}
 };
 
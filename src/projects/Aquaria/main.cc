@@ -608,7 +608,7 @@ public:
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		// // current state of the whole keyboard
 		const uint8_t * state = SDL_GetKeyboardState( NULL );
@@ -866,7 +866,7 @@ public:
 		ZoneScoped;
 
 		{ // dummy draw - draw something into accumulatorTexture
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 			glUseProgram( shaders[ "Dummy Draw" ] );
 
@@ -897,7 +897,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -918,7 +918,7 @@ public:
 			// ...
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 
 			// get status from engine local progress bars, write them above the timestamp
 				// updated from worker thread, so we don't lock up like before
@@ -934,7 +934,7 @@ public:
 		}
 
 		// { // show trident with current orientation
-		// 	scopedTimer Start( "Trident" );
+		// 	SCOPED_TIMER( "Trident" );
 		// 	trident.Update( textureManager.Get( "Display Texture" ) );
 		// 	glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 		// }
@@ -964,7 +964,7 @@ public:
 	}};
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		// generate bar is updated internal to the generate functions - this is hacky but whatever
 		if ( aquariaConfig.workerThreadShouldRun || aquariaConfig.bufferReady ) {
@@ -1055,7 +1055,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
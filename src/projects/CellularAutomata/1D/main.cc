@@ -1,4 +1,5 @@
 #include "../../../engine/engine.h"
+#include "../elementary.h"
 
 class engineDemo final : public engineBase { // sample derived from base engine class
 public:
@@ -13,71 +14,104 @@ public:
 			// something to put some basic data in the accumulator texture
 			shaders[ "Draw" ] = computeShader( "./src/projects/CellularAutomata/1D/shaders/draw.cs.glsl" ).shaderHandle;
 
-			Image_4U test( 10000, 10000 );
-
-			// colors representing the two states
-			color_4U white( { 255, 255, 255, 255 } );
-			color_4U black( {   0,   0,   0, 255 } );
-
-			// seeding the first row
-			rng pick = rng( 0.0f, 1.0f );
-			for ( uint32_t x = 0; x < test.Width(); x++ ) {
-				test.SetAtXY( x, 0, ( pick() < 0.5f ) ? white : black );
-				// test.SetAtXY( x, 0, ( x == 400 ) ? white : black );
+			if ( benchmark ) {
+				Benchmark();
 			}
 
-			// // generate the rule (8 bits)
-			// uint8_t rule;
-			// for ( int i = 0; i < 8; i++ ) {
-			// 	rule += ( pick() < 0.5f ) ? ( 1 << i ) : 0;
-			// }
-
-			rngi ruleGen = rngi( 0, 255 );
-			rng flipChance = rng( 0.0f, 1.0f );
-			rng thresh = rng( 0.0f, 0.00001f );
-			// for ( uint8_t rule = 0; rule < 255; rule++ ) {
-			uint8_t rule = 99;
-			// uint8_t rule = 183;
-				string ruleString;
-				for ( int i = 0; i < 8; i++ ) {
-					ruleString += ( rule & ( 1 << i ) ) ? "1" : "0";
+			// 10000x10000 of rule 99, same noise and rule mutation as ReferenceLoop, stepped on packed rows
+			std::random_device r;
+			elementaryParams_t params = OriginalParams( ( uint64_t( r() ) << 32 ) | r() );
+			if ( sweepRules ) {
+				// every rule, statistics for each, and a 1-bit image of each
+				const std::vector< elementaryStats_t > stats = elementaryCA::Sweep( 10000, 10000, elementaryCA::AllRules( params ), true, [] ( size_t i, const elementaryCA &field, const elementaryStats_t & ) {
+					field.SavePBM( "rule" + to_string( i ) + ".pbm" );
+				} );
+				for ( size_t i = 0; i < stats.size(); i++ ) {
+					cout << "rule " << i << ": density " << stats[ i ].meanDensity << ", activity " << stats[ i ].meanActivity << ", " << stats[ i ].mutations << " mutations, ending on rule " << int( stats[ i ].endRule ) << newline;
 				}
-				std::reverse( ruleString.begin(), ruleString.end() );
-
-				// evaluate the rule, down the height of the image
-				for ( uint32_t y = 1; y < test.Height(); y++ ) {
-					for ( uint32_t x = 0; x < test.Width(); x++ ) { // per row
-						if ( flipChance() < thresh() )
-							rule = ruleGen(); // new rule
-
-						bool samples[ 3 ] = {
-							( test.GetAtXY( x - 1, y - 1 ) == white ),
-							( test.GetAtXY( x,     y - 1 ) == white ),
-							( test.GetAtXY( x + 1, y - 1 ) == white )
-						};
-						uint8_t sum = (
-							( samples[ 0 ] ? 4 : 0 ) +
-							( samples[ 1 ] ? 2 : 0 ) +
-							( samples[ 2 ] ? 1 : 0 ) );
-						uint8_t ruleTestMask = ( 1 << sum );
-						// test.SetAtXY( x, y, ( ( rule & ruleTestMask ) != 0 ) ? white : black );
-
-						test.SetAtXY( x, y, ( ( flipChance() < 0.001f ) ? ( ( rule & ruleTestMask ) != 0 ) : ( ( rule & ruleTestMask ) == 0 ) ) ? white : black );
-
-						// cout << "seeing " << ( samples[ 0 ] ? "1" : "0" ) << ( samples[ 1 ] ? "1" : "0" ) << ( samples[ 2 ] ? "1" : "0" ) << " (" << to_string( sum ) << "), rule " << to_string( rule ) << " is " << ruleString << " resulting in " << ( ( ( rule & ruleTestMask ) != 0 ) ? "living" : "dead" ) << endl;
-					}
-				}
-
-				test.Save( "test" + to_string( rule ) + ".png" );
-			// }
+			} else {
+				elementaryCA field( 10000, 10000 );
+				field.SeedRow( params );
+				const elementaryStats_t stats = field.Run( params );
+				Image_4U test( field.Width(), field.Height() );
+				field.Expand( test.GetImageDataBasePtr() );
+				test.Save( "test" + to_string( stats.endRule ) + ".png" );
+			}
 
 			config.oneShot = true;
 		}
 	}
 
+	// this project runs once and quits ( config.oneShot ) - these pick what that run does
+	bool sweepRules = false;	// all 256 rules, a .pbm and a line of statistics for each, instead of the one rule 99 .png
+	bool benchmark = false;		// time ReferenceLoop against the packed rows first, and report cells/sec
+
+	// what the original loop does, as elementaryParams_t - flipChance() < thresh() is a 0.000005 chance, on average
+	elementaryParams_t OriginalParams ( uint64_t seed ) {
+		elementaryParams_t params;
+		params.rule = 99;
+		params.invert = true;
+		params.flipChance = 0.001f;
+		params.mutationChance = 0.000005f;
+		params.seed = seed;
+		return params;
+	}
+
+	// the original per-pixel loop - three GetAtXY reads compared against white, and rng calls, for every cell
+	void ReferenceLoop ( Image_4U &test, uint8_t rule ) {
+		// colors representing the two states
+		color_4U white( { 255, 255, 255, 255 } );
+		color_4U black( {   0,   0,   0, 255 } );
+
+		// seeding the first row
+		rng pick = rng( 0.0f, 1.0f );
+		for ( uint32_t x = 0; x < test.Width(); x++ ) {
+			test.SetAtXY( x, 0, ( pick() < 0.5f ) ? white : black );
+			// test.SetAtXY( x, 0, ( x == 400 ) ? white : black );
+		}
+
+		rngi ruleGen = rngi( 0, 255 );
+		rng flipChance = rng( 0.0f, 1.0f );
+		rng thresh = rng( 0.0f, 0.00001f );
+
+		// evaluate the rule, down the height of the image
+		for ( uint32_t y = 1; y < test.Height(); y++ ) {
+			for ( uint32_t x = 0; x < test.Width(); x++ ) { // per row
+				if ( flipChance() < thresh() )
+					rule = ruleGen(); // new rule
+
+				bool samples[ 3 ] = {
+					( test.GetAtXY( x - 1, y - 1 ) == white ),
+					( test.GetAtXY( x,     y - 1 ) == white ),
+					( test.GetAtXY( x + 1, y - 1 ) == white )
+				};
+				uint8_t sum = (
+					( samples[ 0 ] ? 4 : 0 ) +
+					( samples[ 1 ] ? 2 : 0 ) +
+					( samples[ 2 ] ? 1 : 0 ) );
+				uint8_t ruleTestMask = ( 1 << sum );
+				test.SetAtXY( x, y, ( ( flipChance() < 0.001f ) ? ( ( rule & ruleTestMask ) != 0 ) : ( ( rule & ruleTestMask ) == 0 ) ) ? white : black );
+			}
+		}
+	}
+
+	void Benchmark () {
+		const uint32_t size = 2000;
+		Image_4U test( size, size );
+		auto tStart = std::chrono::steady_clock::now();
+		ReferenceLoop( test, 99 );
+		const double referenceSeconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - tStart ).count();
+		const double referenceRate = double( size ) * size / referenceSeconds;
+
+		const elementaryCA::benchmarkResult_t result = elementaryCA::Benchmark( size, size, OriginalParams( 0 ) );
+		cout << "reference loop:  " << GetWithThousandsSeparator( size_t( referenceRate ) ) << " cells/sec ( " << size << "x" << size << " in " << referenceSeconds * 1000.0 << "ms )" << newline;
+		cout << "packed rows:     " << GetWithThousandsSeparator( size_t( result.singleCellsPerSecond ) ) << " cells/sec, " << result.singleCellsPerSecond / referenceRate << "x" << newline;
+		cout << "256 rule sweep:  " << GetWithThousandsSeparator( size_t( result.sweepCellsPerSecond ) ) << " cells/sec on " << result.threads << " threads, " << result.sweepCellsPerSecond / referenceRate << "x" << newline;
+	}
+
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 	}
 
 	void ImguiPass () {
@@ -99,7 +133,7 @@ public:
 	}
 
 	void DrawAPIGeometry () {
-		ZoneScoped; scopedTimer Start( "API Geometry" );
+		ZoneScoped; SCOPED_TIMER( "API Geometry" );
 		// draw some shit - need to add a hello triangle to this, so I have an easier starting point for raster stuff
 	}
 
@@ -107,7 +141,7 @@ public:
 		ZoneScoped;
 
 		{ // dummy draw - draw something into accumulatorTexture
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 			glUseProgram( shaders[ "Draw" ] );
 			glUniform1f( glGetUniformLocation( shaders[ "Draw" ], "time" ), SDL_GetTicks() / 1600.0f );
@@ -116,7 +150,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -125,7 +159,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Clear();
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 
@@ -139,7 +173,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 		// application-specific update code
 	}
 
@@ -149,7 +183,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -17,6 +17,27 @@ public:
 	float brushRadius = 10.0f;
 	int brushMode = 0;
 
+	// per-pass uniforms, set through UniformCache()
+	struct drawUniforms_t {
+		uniform_t< float > zoom { "zoom" };
+		uniform_t< float > verticalOffset { "verticalOffset" };
+		uniform_t< vec3 > viewerPosition { "viewerPosition" };
+		uniform_t< int > sliceOffset { "sliceOffset" };
+	} drawUniforms;
+
+	struct updateUniforms_t {
+		uniform_t< int > userClicked { "userClicked" };
+		uniform_t< int > sliceOffset { "sliceOffset" };
+		uniform_t< vec3 > viewerPosition { "viewerPosition" };
+		uniform_t< int > rule { "rule" };
+		uniform_t< float > zoom { "zoom" };
+		uniform_t< float > verticalOffset { "verticalOffset" };
+		uniform_t< ivec2 > clickLocation { "clickLocation" };
+		uniform_t< ivec2 > sizeOfScreen { "sizeOfScreen" };
+		uniform_t< int > clickMode { "clickMode" };
+		uniform_t< float > brushRadius { "brushRadius" };
+	} updateUniforms;
+
 	int rule[ 25 ] = {
 		2, 0, 2, 2, 1,
 		0, 2, 0, 2, 2,
@@ -90,7 +111,7 @@ public:
 	}
 
 	void HandleCustomEvents () {
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		const uint8_t * state = SDL_GetKeyboardState( NULL );
 		if ( state[ SDL_SCANCODE_R ] ) {
@@ -186,16 +207,17 @@ public:
 		ZoneScoped;
 
 		{ // draw the current state of the front buffer
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 
 			const GLuint shader = shaders[ "Draw" ];
 			glUseProgram( shader );
 
-			glUniform1f( glGetUniformLocation( shader, "zoom" ), zoom );
-			glUniform1f( glGetUniformLocation( shader, "verticalOffset" ), verticalOffset );
-			glUniform3fv( glGetUniformLocation( shader, "viewerPosition" ), 1, glm::value_ptr( viewerPosition ) );
-			glUniform1i( glGetUniformLocation( shader, "sliceOffset" ), currentSlice );
+			uniformCache_t &uniforms = UniformCache();
+			uniforms.Set( shader, drawUniforms.zoom, zoom );
+			uniforms.Set( shader, drawUniforms.verticalOffset, verticalOffset );
+			uniforms.Set( shader, drawUniforms.viewerPosition, viewerPosition );
+			uniforms.Set( shader, drawUniforms.sliceOffset, currentSlice );
 			textureManager.BindImageForShader( "State Buffer", "CAStateBuffer", shader, 2 );
 
 			// put it in the accumulator
@@ -204,7 +226,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -213,7 +235,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -222,14 +244,15 @@ public:
 
 	void OnUpdate () {
 		// update the state of the CA
-		scopedTimer Start( "Update" );
+		SCOPED_TIMER( "Update" );
 		const GLuint shader = shaders[ "Update" ];
 		glUseProgram( shader );
 
-		glUniform1i( glGetUniformLocation( shader, "userClicked" ), 0 );
-		glUniform1i( glGetUniformLocation( shader, "sliceOffset" ), currentSlice );
-		glUniform3fv( glGetUniformLocation( shader, "viewerPosition" ), 1, glm::value_ptr( viewerPosition ) );
-		glUniform1iv( glGetUniformLocation( shader, "rule" ), 25, &rule[ 0 ] );
+		uniformCache_t &uniforms = UniformCache();
+		uniforms.Set( shader, updateUniforms.userClicked, 0 );
+		uniforms.Set( shader, updateUniforms.sliceOffset, currentSlice );
+		uniforms.Set( shader, updateUniforms.viewerPosition, viewerPosition );
+		uniforms.Set( shader, updateUniforms.rule, &rule[ 0 ], 25 );
 
 		textureManager.BindImageForShader( "State Buffer", "CAStateBuffer", shader, 2 );
 		IncrementSlice();
@@ -237,15 +260,14 @@ public:
 		ivec2 userClickLocation = ivec2( -1 );
 		uint32_t mouseState = SDL_GetMouseState( &userClickLocation.x, &userClickLocation.y );
 		if ( mouseState != 0 && !ImGui::GetIO().WantCaptureMouse ) {
-			glUniform1f( glGetUniformLocation( shader, "zoom" ), zoom );
-			glUniform1f( glGetUniformLocation( shader, "verticalOffset" ), verticalOffset );
-			glUniform3fv( glGetUniformLocation( shader, "viewerPosition" ), 1, glm::value_ptr( viewerPosition ) );
-
-			glUniform1i( glGetUniformLocation( shader, "userClicked" ), 1 );
-			glUniform2i( glGetUniformLocation( shader, "clickLocation" ), userClickLocation.x, userClickLocation.y );
-			glUniform2i( glGetUniformLocation( shader, "sizeOfScreen" ), config.width, config.height );
-			glUniform1i( glGetUniformLocation( shader, "clickMode" ), brushMode );
-			glUniform1f( glGetUniformLocation( shader, "brushRadius" ), brushRadius );
+			uniforms.Set( shader, updateUniforms.zoom, zoom );
+			uniforms.Set( shader, updateUniforms.verticalOffset, verticalOffset );
+
+			uniforms.Set( shader, updateUniforms.userClicked, 1 );
+			uniforms.Set( shader, updateUniforms.clickLocation, userClickLocation );
+			uniforms.Set( shader, updateUniforms.sizeOfScreen, ivec2( config.width, config.height ) );
+			uniforms.Set( shader, updateUniforms.clickMode, brushMode );
+			uniforms.Set( shader, updateUniforms.brushRadius, brushRadius );
 		}
 
 		// dispatch the compute shader to update the thing
@@ -259,7 +281,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -1,4 +1,5 @@
 #include "../../../engine/engine.h"
+#include "../bitSliced.h"
 
 struct CAConfig_t {
 	// CA buffer dimensions
@@ -44,12 +45,22 @@ public:
 			textureManager.Add( "Automata State Buffer 1", opts );
 
 			BufferReset();
+
+			// headless CPU version of the update, same initial state
+			terminal.addCommand( { "cpuBenchmark" }, {
+					{ "steps", INT, "Number of generations to step." },
+					{ "toroidal", BOOL, "Wrap at the edges, instead of reading zeroes." }
+				}, [=] ( args_t args ) {
+					bitSlicedCA cpuCA( CAConfig.dimensionX, CAConfig.dimensionY, 1, bitSlicedMode_t::SINGLE, args[ "toroidal" ].data.x != 0.0f );
+					cpuCA.Load( GenerateInitialData() );
+					const bitSlicedCA::benchmarkResult_t result = cpuCA.Benchmark( std::max( 1, int( args[ "steps" ].data.x ) ) );
+					terminal.addHistoryLine( terminal.csb.append( "Stepped " + to_string( result.steps ) + " generations in " + to_string( result.seconds * 1000.0 ) + "ms on " + to_string( result.threads ) + " threads" + ( result.avx2 ? " ( AVX2 )" : "" ) ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  " + GetWithThousandsSeparator( size_t( result.cellUpdatesPerSecond ) ) + " cell updates/sec, population " + to_string( cpuCA.Population() ) ).flush() );
+				}, "Run the CPU bit-sliced automata from a fresh initial state, and report cell updates/sec." );
 		}
 	}
 
-	void BufferReset () { // put random bits in the buffer
-		string backBufferLabel = string( "Automata State Buffer " ) + string( CAConfig.oddFrame ? "0" : "1" );
-
+	std::vector< uint32_t > GenerateInitialData () {
 		// random data init
 		std::vector< uint32_t > initialData;
 		rng gen( 0.0f, 1.0f );
@@ -57,6 +68,12 @@ public:
 			uint32_t value = ( gen() < CAConfig.generatorThreshold ) ? 1u : 0u;
 			initialData.push_back( value );
 		}
+		return initialData;
+	}
+
+	void BufferReset () { // put random bits in the buffer
+		string backBufferLabel = string( "Automata State Buffer " ) + string( CAConfig.oddFrame ? "0" : "1" );
+		std::vector< uint32_t > initialData = GenerateInitialData();
 
 		// no current functionality for updating the buffer - going to raw OpenGL
 		GLuint handle = textureManager.Get( backBufferLabel );
@@ -65,7 +82,7 @@ public:
 	}
 
 	void HandleCustomEvents () {
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		const uint8_t * state = SDL_GetKeyboardState( NULL );
 		if ( state[ SDL_SCANCODE_R ] ) {
@@ -99,7 +116,7 @@ public:
 		string frontBufferLabel = string( "Automata State Buffer " ) + string( CAConfig.oddFrame ? "1" : "0" );
 
 		{ // update the state of the CA
-			scopedTimer Start( "Update" );
+			SCOPED_TIMER( "Update" );
 			glUseProgram( shaders[ "Update" ] );
 
 			// bind front buffer, back buffer
@@ -112,7 +129,7 @@ public:
 		}
 
 		{ // draw the current state of the front buffer
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 			glUseProgram( shaders[ "Draw" ] );
 
@@ -128,7 +145,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -137,7 +154,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -153,7 +170,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -1,4 +1,5 @@
 #include "../../../engine/engine.h"
+#include "../bitSliced.h"
 
 struct CAConfig_t {
 	// CA buffer dimensions
@@ -46,12 +47,22 @@ public:
 			textureManager.Add( "Automata State Buffer 1", opts );
 
 			BufferReset();
+
+			// headless CPU version of the update, same initial state
+			terminal.addCommand( { "cpuBenchmark" }, {
+					{ "steps", INT, "Number of generations to step." },
+					{ "toroidal", BOOL, "Wrap at the edges, instead of reading zeroes." }
+				}, [=] ( args_t args ) {
+					bitSlicedCA cpuCA( CAConfig.dimensionX, CAConfig.dimensionY, CAConfig.numBitsActive, bitSlicedMode_t::PLANES, args[ "toroidal" ].data.x != 0.0f );
+					cpuCA.Load( GenerateInitialData() );
+					const bitSlicedCA::benchmarkResult_t result = cpuCA.Benchmark( std::max( 1, int( args[ "steps" ].data.x ) ) );
+					terminal.addHistoryLine( terminal.csb.append( "Stepped " + to_string( result.steps ) + " generations in " + to_string( result.seconds * 1000.0 ) + "ms on " + to_string( result.threads ) + " threads" + ( result.avx2 ? " ( AVX2 )" : "" ) ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  " + GetWithThousandsSeparator( size_t( result.cellUpdatesPerSecond ) ) + " cell updates/sec, population " + to_string( cpuCA.Population() ) ).flush() );
+				}, "Run the CPU bit-sliced automata from a fresh initial state, and report cell updates/sec." );
 		}
 	}
 
-	void BufferReset () { // put random bits in the buffer
-		string backBufferLabel = string( "Automata State Buffer " ) + string( CAConfig.oddFrame ? "0" : "1" );
-
+	std::vector< uint32_t > GenerateInitialData () {
 		// random data init
 		std::vector< uint32_t > initialData;
 		rng gen( 0.0f, 1.0f );
@@ -63,6 +74,12 @@ public:
 			}
 			initialData.push_back( value );
 		}
+		return initialData;
+	}
+
+	void BufferReset () { // put random bits in the buffer
+		string backBufferLabel = string( "Automata State Buffer " ) + string( CAConfig.oddFrame ? "0" : "1" );
+		std::vector< uint32_t > initialData = GenerateInitialData();
 
 		// no current functionality for updating the buffer - going to raw OpenGL
 		GLuint handle = textureManager.Get( backBufferLabel );
@@ -71,7 +88,7 @@ public:
 	}
 
 	void HandleCustomEvents () {
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		const uint8_t * state = SDL_GetKeyboardState( NULL );
 		if ( state[ SDL_SCANCODE_R ] ) {
@@ -105,7 +122,7 @@ public:
 		string frontBufferLabel = string( "Automata State Buffer " ) + string( CAConfig.oddFrame ? "1" : "0" );
 
 		{ // update the state of the CA
-			scopedTimer Start( "Update" );
+			SCOPED_TIMER( "Update" );
 			glUseProgram( shaders[ "Update" ] );
 
 			// bind front buffer, back buffer
@@ -118,7 +135,7 @@ public:
 		}
 
 		{ // draw the current state of the front buffer
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 			glUseProgram( shaders[ "Draw" ] );
 
@@ -135,7 +152,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -144,7 +161,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -160,7 +177,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -0,0 +1,393 @@
+#pragma once
+#ifndef BIT_SLICED_CA_H
+#define BIT_SLICED_CA_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+// the AVX2 kernel is compiled with a target attribute instead of a global -mavx2, and picked at runtime - GCC / Clang
+	// on x86 only, everything else gets the uint64_t kernel
+#if ( defined( __GNUC__ ) || defined( __clang__ ) ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define BIT_SLICED_AVX2
+#include <immintrin.h>
+#define BIT_SLICED_TARGET_AVX2 __attribute__(( target( "avx2" ) ))
+#endif
+
+#include "../../engine/coreUtils/parallel.h"
+
+// Headless CPU stepping for the GoL, bitPlanes, CAHistory and colorSplit projects
+	// the GPU versions keep one uint per cell in a GL_R32UI texture, with each bit being a separate layer -
+	// here each of those bits gets its own plane of packed bit rows, 64 cells per word, and the neighbor
+	// count is done with bit-sliced full adders, so one logic op advances 64 cells ( 256 with AVX2 ).
+
+// Life-like rule in B/S notation - bit n set means neighbor count n births / survives
+struct lifeRule_t {
+	uint16_t birthMask = 1u << 3;
+	uint16_t surviveMask = ( 1u << 2 ) | ( 1u << 3 );
+
+	lifeRule_t () {}
+	lifeRule_t ( uint16_t birth, uint16_t survive ) : birthMask( birth ), surviveMask( survive ) {}
+
+	// parse e.g. "B3/S23", "B36/S23"
+	static lifeRule_t FromString ( const std::string &s ) {
+		lifeRule_t rule( 0, 0 );
+		uint16_t * target = nullptr;
+		for ( char c : s ) {
+			if ( c == 'B' || c == 'b' ) target = &rule.birthMask;
+			else if ( c == 'S' || c == 's' ) target = &rule.surviveMask;
+			else if ( c >= '0' && c <= '8' && target != nullptr ) *target |= 1u << ( c - '0' );
+		}
+		return rule;
+	}
+
+	bool IsConway () const { return birthMask == ( 1u << 3 ) && surviveMask == ( ( 1u << 2 ) | ( 1u << 3 ) ); }
+};
+
+// how the packed uint state evolves, matching the update shaders
+enum class bitSlicedMode_t {
+	SINGLE,		// GoL - only bit 0 is stepped, everything else is dropped
+	PLANES,		// bitPlanes - every active bit is an independent automaton
+	HISTORY		// CAHistory, colorSplit - state = ( previous << 1 ) | step( bit 0 )
+};
+
+//=============================================================================
+//==== Bit-Sliced Kernels =====================================================
+//=============================================================================
+
+namespace bitSliced {
+	// word ops, so the kernel can be written once for uint64_t and 4-wide AVX2
+	struct scalarOps {
+		using word = uint64_t;
+		static constexpr int lanes = 1;
+		static word Load ( const uint64_t * p ) { return *p; }
+		static void Store ( uint64_t * p, word w ) { *p = w; }
+		static word And ( word a, word b ) { return a & b; }
+		static word Or ( word a, word b ) { return a | b; }
+		static word Xor ( word a, word b ) { return a ^ b; }
+		static word AndNot ( word a, word b ) { return ~a & b; } // same argument order as the x86 andnot intrinsics
+		static word Zero () { return 0; }
+		static word Ones () { return ~uint64_t( 0 ); }
+		// cell x - 1 / cell x + 1, pulling the carry bit in from the adjacent words
+		static word West ( const uint64_t * p ) { return ( p[ 0 ] << 1 ) | ( p[ -1 ] >> 63 ); }
+		static word East ( const uint64_t * p ) { return ( p[ 0 ] >> 1 ) | ( p[ 1 ] << 63 ); }
+	};
+
+#ifdef BIT_SLICED_AVX2
+	// the 64-bit lane shifts are AVX2, not AVX - the carries come from unaligned loads one word over
+	struct avx2Ops {
+		using word = __m256i;
+		static constexpr int lanes = 4;
+		BIT_SLICED_TARGET_AVX2 static word Load ( const uint64_t * p ) { return _mm256_loadu_si256( ( const __m256i * ) p ); }
+		BIT_SLICED_TARGET_AVX2 static void Store ( uint64_t * p, word w ) { _mm256_storeu_si256( ( __m256i * ) p, w ); }
+		BIT_SLICED_TARGET_AVX2 static word And ( word a, word b ) { return _mm256_and_si256( a, b ); }
+		BIT_SLICED_TARGET_AVX2 static word Or ( word a, word b ) { return _mm256_or_si256( a, b ); }
+		BIT_SLICED_TARGET_AVX2 static word Xor ( word a, word b ) { return _mm256_xor_si256( a, b ); }
+		BIT_SLICED_TARGET_AVX2 static word AndNot ( word a, word b ) { return _mm256_andnot_si256( a, b ); }
+		BIT_SLICED_TARGET_AVX2 static word Zero () { return _mm256_setzero_si256(); }
+		BIT_SLICED_TARGET_AVX2 static word Ones () { return _mm256_set1_epi64x( -1 ); }
+		BIT_SLICED_TARGET_AVX2 static word West ( const uint64_t * p ) { return _mm256_or_si256( _mm256_slli_epi64( Load( p ), 1 ), _mm256_srli_epi64( Load( p - 1 ), 63 ) ); }
+		BIT_SLICED_TARGET_AVX2 static word East ( const uint64_t * p ) { return _mm256_or_si256( _mm256_srli_epi64( Load( p ), 1 ), _mm256_slli_epi64( Load( p + 1 ), 63 ) ); }
+	};
+#endif
+
+	template < typename ops >
+	inline void FullAdd ( typename ops::word a, typename ops::word b, typename ops::word c, typename ops::word &sum, typename ops::word &carry ) {
+		const typename ops::word t = ops::Xor( a, b );
+		sum = ops::Xor( t, c );
+		carry = ops::Or( ops::And( a, b ), ops::And( t, c ) );
+	}
+
+	template < typename ops >
+	inline void HalfAdd ( typename ops::word a, typename ops::word b, typename ops::word &sum, typename ops::word &carry ) {
+		sum = ops::Xor( a, b );
+		carry = ops::And( a, b );
+	}
+
+	// one ops::word of output, given pointers to the same word index in the rows above, at and below
+	template < typename ops >
+	inline typename ops::word StepWord ( const uint64_t * above, const uint64_t * row, const uint64_t * below, const lifeRule_t &rule ) {
+		using word = typename ops::word;
+
+		// the 8 neighbors, as bit vectors
+		const word n0 = ops::West( above ), n1 = ops::Load( above ), n2 = ops::East( above );
+		const word n3 = ops::West( row ),                            n4 = ops::East( row );
+		const word n5 = ops::West( below ), n6 = ops::Load( below ), n7 = ops::East( below );
+		const word alive = ops::Load( row );
+
+		// sum them to a 4 bit count with a small adder tree
+		word sA, cA, sB, cB, sC, cC, bit0, cD;
+		FullAdd< ops >( n0, n1, n2, sA, cA );
+		FullAdd< ops >( n3, n4, n5, sB, cB );
+		HalfAdd< ops >( n6, n7, sC, cC );
+		FullAdd< ops >( sA, sB, sC, bit0, cD );	// weight 1
+		word sE, cE, bit1, cF;
+		FullAdd< ops >( cA, cB, cC, sE, cE );		// weight 2
+		HalfAdd< ops >( sE, cD, bit1, cF );
+		word bit2, bit3;
+		HalfAdd< ops >( cE, cF, bit2, bit3 );		// weight 4, 8
+
+		if ( rule.IsConway() ) { // count is 2 or 3 ( mod 8 is fine, count 8 lands on 0 ), and alive or odd
+			return ops::And( ops::AndNot( bit2, bit1 ), ops::Or( bit0, alive ) );
+		}
+
+		// general Life-like rule - or together a minterm for each count present in the rule
+		word born = ops::Zero();
+		word survive = ops::Zero();
+		const word bits[ 4 ] = { bit0, bit1, bit2, bit3 };
+		for ( int n = 0; n <= 8; n++ ) {
+			const bool b = rule.birthMask & ( 1u << n );
+			const bool s = rule.surviveMask & ( 1u << n );
+			if ( !b && !s ) continue;
+			word match = ops::Ones();
+			for ( int i = 0; i < 4; i++ ) {
+				match = ( n & ( 1 << i ) ) ? ops::And( match, bits[ i ] ) : ops::AndNot( bits[ i ], match );
+			}
+			if ( b ) born = ops::Or( born, match );
+			if ( s ) survive = ops::Or( survive, match );
+		}
+		return ops::Or( ops::AndNot( alive, born ), ops::And( alive, survive ) );
+	}
+
+	// words [ begin, end ) of one row
+	inline void StepRowScalar ( const uint64_t * above, const uint64_t * row, const uint64_t * below, uint64_t * out, uint32_t begin, uint32_t end, const lifeRule_t &rule ) {
+		for ( uint32_t w = begin; w < end; w++ ) {
+			out[ w ] = StepWord< scalarOps >( above + w, row + w, below + w, rule );
+		}
+	}
+
+#ifdef BIT_SLICED_AVX2
+	// flatten pulls StepWord and the ops into this function, where they pick up the avx2 target - returns how many
+		// words it did, a multiple of 4, the rest is left to the scalar kernel
+	BIT_SLICED_TARGET_AVX2 __attribute__(( flatten )) inline uint32_t StepRowAVX2 ( const uint64_t * above, const uint64_t * row, const uint64_t * below, uint64_t * out, uint32_t count, const lifeRule_t &rule ) {
+		uint32_t w = 0;
+		for ( ; w + 4 <= count; w += 4 ) {
+			avx2Ops::Store( out + w, StepWord< avx2Ops >( above + w, row + w, below + w, rule ) );
+		}
+		return w;
+	}
+
+	inline bool HasAVX2 () {
+		static const bool supported = __builtin_cpu_supports( "avx2" );
+		return supported;
+	}
+#else
+	inline uint32_t StepRowAVX2 ( const uint64_t *, const uint64_t *, const uint64_t *, uint64_t *, uint32_t, const lifeRule_t & ) { return 0; }
+	inline bool HasAVX2 () { return false; }
+#endif
+}
+
+//=============================================================================
+//==== Field ==================================================================
+//=============================================================================
+
+class bitSlicedCA {
+public:
+	bitSlicedCA () {}
+	bitSlicedCA ( uint32_t width_in, uint32_t height_in, uint32_t numPlanes_in = 1, bitSlicedMode_t mode_in = bitSlicedMode_t::SINGLE, bool toroidal_in = false ) {
+		Resize( width_in, height_in, numPlanes_in, mode_in, toroidal_in );
+	}
+
+	void Resize ( uint32_t width_in, uint32_t height_in, uint32_t numPlanes_in, bitSlicedMode_t mode_in, bool toroidal_in ) {
+		width = width_in;
+		height = height_in;
+		numPlanes = std::clamp( numPlanes_in, 1u, 32u );
+		mode = mode_in;
+		toroidal = toroidal_in;
+
+		// one extra bit past the end of the row, so the east neighbor of the last cell has somewhere to live
+		dataWords = ( width + 64 ) / 64;
+		// a guard word either side of the row, for the West / East carries
+		stride = dataWords + 2;
+
+		planes.assign( numPlanes, std::vector< uint64_t >( PlaneSize(), 0 ) );
+		scratch.assign( PlaneSize(), 0 );
+	}
+
+	uint32_t Width () const { return width; }
+	uint32_t Height () const { return height; }
+	uint32_t NumPlanes () const { return numPlanes; }
+
+	lifeRule_t rule;
+	bitSlicedMode_t mode = bitSlicedMode_t::SINGLE;
+	bool toroidal = false;		// false matches the GPU version, where imageLoad off the edge reads zero
+	uint32_t numThreads = 0;	// 0 is one per core
+	bool allowAVX2 = true;		// false forces the uint64_t kernel, e.g. to compare the two
+
+	// load from the packed one uint per cell layout that BufferReset() sends to the GL_R32UI texture
+	void Load ( const std::vector< uint32_t > &packed ) {
+		for ( auto& plane : planes ) std::fill( plane.begin(), plane.end(), 0 );
+		parallelForRanges( height, [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t y = begin; y < end; y++ ) {
+				const uint32_t * src = packed.data() + y * width;
+				for ( uint32_t p = 0; p < numPlanes; p++ ) {
+					uint64_t * dst = RowPtr( planes[ p ], y );
+					for ( uint32_t x = 0; x < width; x++ ) {
+						dst[ x >> 6 ] |= uint64_t( ( src[ x ] >> p ) & 1u ) << ( x & 63 );
+					}
+				}
+			}
+		}, numThreads );
+	}
+
+	// and back to that layout, e.g. for comparison against a glGetTexImage readback
+	std::vector< uint32_t > Store () const {
+		std::vector< uint32_t > packed( size_t( width ) * height, 0 );
+		parallelForRanges( height, [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t y = begin; y < end; y++ ) {
+				uint32_t * dst = packed.data() + y * width;
+				for ( uint32_t p = 0; p < numPlanes; p++ ) {
+					const uint64_t * src = RowPtr( planes[ p ], y );
+					for ( uint32_t x = 0; x < width; x++ ) {
+						dst[ x ] |= uint32_t( ( src[ x >> 6 ] >> ( x & 63 ) ) & 1u ) << p;
+					}
+				}
+			}
+		}, numThreads );
+		return packed;
+	}
+
+	bool GetCell ( uint32_t x, uint32_t y, uint32_t plane = 0 ) const {
+		return ( RowPtr( planes[ plane ], y )[ x >> 6 ] >> ( x & 63 ) ) & 1u;
+	}
+
+	void Step () {
+		switch ( mode ) {
+			case bitSlicedMode_t::SINGLE:
+				StepPlane( planes[ 0 ] );
+				for ( uint32_t p = 1; p < numPlanes; p++ ) std::fill( planes[ p ].begin(), planes[ p ].end(), 0 );
+				break;
+
+			case bitSlicedMode_t::PLANES:
+				for ( auto& plane : planes ) StepPlane( plane );
+				break;
+
+			case bitSlicedMode_t::HISTORY:
+				// the shift is just a rotation of the plane list, only bit 0 needs any real work - the top plane
+					// falls off the end, same as the bit shifted out of the uint in the shader
+				StepPlane( planes[ 0 ], false );
+				std::rotate( planes.rbegin(), planes.rbegin() + 1, planes.rend() );
+				std::swap( planes[ 0 ], scratch );
+				break;
+		}
+	}
+
+	void Step ( uint32_t count ) {
+		for ( uint32_t i = 0; i < count; i++ ) Step();
+	}
+
+	// count of live cells in a plane
+	size_t Population ( uint32_t plane = 0 ) const {
+		size_t total = 0;
+		const uint32_t lastWord = LastWord();
+		const uint64_t lastWordMask = LastWordMask();
+		for ( uint32_t y = 0; y < height; y++ ) {
+			const uint64_t * row = RowPtr( planes[ plane ], y );
+			for ( uint32_t w = 0; w < lastWord; w++ ) total += __builtin_popcountll( row[ w ] );
+			total += __builtin_popcountll( row[ lastWord ] & lastWordMask ); // leaves out the halo bit at x = width
+		}
+		return total;
+	}
+
+	struct benchmarkResult_t {
+		uint32_t steps = 0;
+		double seconds = 0.0;
+		double cellUpdatesPerSecond = 0.0;
+		uint32_t threads = 0;
+		bool avx2 = false;
+	};
+
+	// cell updates counts every bit plane that actually gets stepped, same as the 32 evaluations per texel on the GPU
+	benchmarkResult_t Benchmark ( uint32_t steps ) {
+		benchmarkResult_t result;
+		const auto tStart = std::chrono::steady_clock::now();
+		Step( steps );
+		result.seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - tStart ).count();
+		const double planesStepped = ( mode == bitSlicedMode_t::PLANES ) ? numPlanes : 1.0;
+		result.steps = steps;
+		result.cellUpdatesPerSecond = double( width ) * double( height ) * planesStepped * steps / std::max( result.seconds, 1e-9 );
+		result.threads = numThreads ? numThreads : parallelThreadCount();
+		result.avx2 = UseAVX2();
+		return result;
+	}
+
+private:
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t numPlanes = 1;
+	uint32_t dataWords = 0;
+	uint32_t stride = 0;
+
+	// one halo row above and below, guard words either side of each row
+	std::vector< std::vector< uint64_t > > planes;
+	std::vector< uint64_t > scratch;
+
+	size_t PlaneSize () const { return size_t( height + 2 ) * stride; }
+
+	bool UseAVX2 () const { return allowAVX2 && bitSliced::HasAVX2(); }
+
+	// the word holding cell width - 1, and the bits of it which are inside the row
+	uint32_t LastWord () const { return ( width - 1 ) >> 6; }
+	uint64_t LastWordMask () const { return ( width & 63 ) ? ( ( uint64_t( 1 ) << ( width & 63 ) ) - 1 ) : ~uint64_t( 0 ); }
+
+	// y in -1..height, including the halo rows, pointer is to the first data word ( x = 0..63 )
+	uint64_t * RowPtr ( std::vector< uint64_t > &plane, int64_t y ) { return plane.data() + ( y + 1 ) * stride + 1; }
+	const uint64_t * RowPtr ( const std::vector< uint64_t > &plane, int64_t y ) const { return plane.data() + ( y + 1 ) * stride + 1; }
+
+	void SetBit ( uint64_t * row, int64_t x, bool value ) {
+		const uint64_t mask = uint64_t( 1 ) << ( x & 63 );
+		uint64_t &w = row[ x >> 6 ]; // arithmetic shift, x = -1 lands in the guard word
+		w = value ? ( w | mask ) : ( w & ~mask );
+	}
+
+	// the only data that crosses band boundaries - bands read each other's edge rows straight out of the
+		// shared source plane, so the exchange is just setting up the ring of cells around the field
+	void RefreshHalo ( std::vector< uint64_t > &plane ) {
+		for ( int64_t y = 0; y < int64_t( height ); y++ ) {
+			uint64_t * row = RowPtr( plane, y );
+			SetBit( row, -1, toroidal && ( ( row[ ( width - 1 ) >> 6 ] >> ( ( width - 1 ) & 63 ) ) & 1u ) );
+			SetBit( row, width, toroidal && ( row[ 0 ] & 1u ) );
+		}
+		uint64_t * top = RowPtr( plane, -1 ) - 1;
+		uint64_t * bottom = RowPtr( plane, height ) - 1;
+		if ( toroidal ) {
+			std::copy( RowPtr( plane, height - 1 ) - 1, RowPtr( plane, height - 1 ) - 1 + stride, top );
+			std::copy( RowPtr( plane, 0 ) - 1, RowPtr( plane, 0 ) - 1 + stride, bottom );
+		} else {
+			std::fill( top, top + stride, 0 );
+			std::fill( bottom, bottom + stride, 0 );
+		}
+	}
+
+	// steps plane into scratch, and swaps them unless told otherwise
+	void StepPlane ( std::vector< uint64_t > &plane, bool swap = true ) {
+		RefreshHalo( plane );
+		const uint64_t lastWordMask = LastWordMask();
+		const uint32_t lastWord = LastWord();
+		const bool avx2 = UseAVX2();
+
+		parallelForRanges( height, [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t y = begin; y < end; y++ ) {
+				const uint64_t * above = RowPtr( plane, int64_t( y ) - 1 );
+				const uint64_t * row = RowPtr( plane, y );
+				const uint64_t * below = RowPtr( plane, y + 1 );
+				uint64_t * out = RowPtr( scratch, y );
+
+				const uint32_t w = avx2 ? bitSliced::StepRowAVX2( above, row, below, out, dataWords, rule ) : 0;
+				bitSliced::StepRowScalar( above, row, below, out, w, dataWords, rule );
+
+				// clear out anything computed past the end of the row
+				out[ lastWord ] &= lastWordMask;
+				for ( uint32_t w = lastWord + 1; w < dataWords; w++ ) out[ w ] = 0;
+			}
+		}, numThreads );
+
+		if ( swap ) {
+			std::swap( plane, scratch );
+		}
+	}
+};
+
+#endif // BIT_SLICED_CA_H
@@ -0,0 +1,367 @@
+#pragma once
+#ifndef ELEMENTARY_CA_H
+#define ELEMENTARY_CA_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+
+#include "../../engine/coreUtils/parallel.h"
+
+// Headless CPU stepping for the 1D project - elementary ( 3 cell neighborhood ) automata, one row per generation
+	// rows are packed 64 cells to a word, same bit order as bitSliced.h, and the rule is applied as a 3 level mux
+	// tree on whole words, so a handful of logic ops computes 64 cells. Noise comes from a counter-based hash of
+	// ( seed, row, draw ), so a run gives the same result no matter which thread runs it, or in what order.
+
+// one run - the 1D project's loop is rule 99, inverted, flip chance 0.001, mutation chance 0.000005
+struct elementaryParams_t {
+	uint8_t rule = 30;
+	bool invert = false;			// write the complement of the rule's output, as the 1D project's loop does
+	float flipChance = 0.0f;		// per cell, chance the output is flipped
+	float mutationChance = 0.0f;	// per cell, chance the rule is replaced with a random one, from that cell on
+	std::vector< uint8_t > schedule;// if not empty, row y uses schedule[ y % size ], instead of rule + mutation
+	bool toroidal = false;			// false matches Image2::GetAtXY, where reading off the edge is black
+	uint64_t seed = 0;
+	float density = 0.5f;			// initial row, chance each cell is set
+};
+
+struct elementaryStats_t {
+	uint8_t startRule = 0;
+	uint8_t endRule = 0;
+	uint32_t mutations = 0;
+	uint64_t flips = 0;
+	double meanDensity = 0.0;		// live fraction, over every row
+	double finalDensity = 0.0;		// live fraction, last row
+	double meanActivity = 0.0;		// fraction of cells that differ from the cell above
+};
+
+//=============================================================================
+//==== Word Kernels ===========================================================
+//=============================================================================
+
+namespace elementary {
+	// counter-based - splitmix64 finalizer over the combined inputs
+	inline uint64_t Hash ( uint64_t seed, uint64_t a, uint64_t b ) {
+		uint64_t z = seed + a * 0x9e3779b97f4a7c15ull + b * 0xc2b2ae3d27d4eb4full;
+		z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+		z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+		return z ^ ( z >> 31 );
+	}
+
+	// ( 0, 1 ] - never 0, so it's safe to take the log of
+	inline double Uniform ( uint64_t h ) {
+		return double( ( h >> 11 ) + 1 ) * ( 1.0 / 9007199254740992.0 );
+	}
+
+	// the rule as masks for a mux tree - neighborhood index is 4 * left + 2 * center + right, same as the 1D project.
+		// The first level picks by right between rule bits 2k and 2k + 1 - with constant inputs, that is always one of
+		// 0, ~0, r or ~r, so it's stored as ( r & select ) ^ base.
+	struct ruleMasks_t {
+		uint64_t base[ 4 ];
+		uint64_t select[ 4 ];
+
+		ruleMasks_t () {}
+		ruleMasks_t ( uint8_t rule ) {
+			for ( int k = 0; k < 4; k++ ) {
+				const uint64_t lo = ( rule >> ( 2 * k ) ) & 1u ? ~uint64_t( 0 ) : 0;
+				const uint64_t hi = ( rule >> ( 2 * k + 1 ) ) & 1u ? ~uint64_t( 0 ) : 0;
+				base[ k ] = lo;
+				select[ k ] = lo ^ hi;
+			}
+		}
+	};
+
+	inline uint64_t Mux ( uint64_t a, uint64_t b, uint64_t s ) { return a ^ ( ( a ^ b ) & s ); }
+
+	// 64 cells of the next row, given a pointer to the same word in the previous row
+	inline uint64_t StepWord ( const uint64_t * p, const ruleMasks_t &m ) {
+		const uint64_t l = ( p[ 0 ] << 1 ) | ( p[ -1 ] >> 63 );	// cell x - 1
+		const uint64_t c = p[ 0 ];
+		const uint64_t r = ( p[ 0 ] >> 1 ) | ( p[ 1 ] << 63 );	// cell x + 1
+		const uint64_t t0 = ( r & m.select[ 0 ] ) ^ m.base[ 0 ];	// l = 0, c = 0
+		const uint64_t t1 = ( r & m.select[ 1 ] ) ^ m.base[ 1 ];	// l = 0, c = 1
+		const uint64_t t2 = ( r & m.select[ 2 ] ) ^ m.base[ 2 ];	// l = 1, c = 0
+		const uint64_t t3 = ( r & m.select[ 3 ] ) ^ m.base[ 3 ];	// l = 1, c = 1
+		return Mux( Mux( t0, t1, c ), Mux( t2, t3, c ), l );
+	}
+}
+
+//=============================================================================
+//==== Field ==================================================================
+//=============================================================================
+
+class elementaryCA {
+public:
+	elementaryCA () {}
+	elementaryCA ( uint32_t width_in, uint32_t height_in, bool keepRows_in = true ) {
+		Resize( width_in, height_in, keepRows_in );
+	}
+
+	// with keepRows off, only the last two rows are stored - for runs that only want the statistics
+	void Resize ( uint32_t width_in, uint32_t height_in, bool keepRows_in = true ) {
+		width = std::max( 1u, width_in );
+		height = std::max( 1u, height_in );
+		keepRows = keepRows_in;
+
+		// one extra bit past the end of the row, for the toroidal wrap, and a guard word either side
+		dataWords = ( width + 64 ) / 64;
+		stride = dataWords + 2;
+		rows.assign( size_t( keepRows ? height : 2 ) * stride, 0 );
+	}
+
+	uint32_t Width () const { return width; }
+	uint32_t Height () const { return height; }
+	bool KeepsRows () const { return keepRows; }
+
+	// the whole image, if rows are kept - otherwise only the last row is valid
+	bool GetCell ( uint32_t x, uint32_t y ) const {
+		return ( RowPtr( y )[ x >> 6 ] >> ( x & 63 ) ) & 1u;
+	}
+	const uint64_t * Row ( uint32_t y ) const { return RowPtr( y ); }
+
+	// initial row, from the params' seed and density
+	void SeedRow ( const elementaryParams_t &params ) {
+		uint64_t * row = RowPtr( 0 );
+		std::fill( row - 1, row - 1 + stride, 0 );
+		const uint64_t threshold = uint64_t( double( std::clamp( params.density, 0.0f, 1.0f ) ) * 4294967296.0 );
+		for ( uint32_t x = 0; x < width; x++ ) {
+			if ( ( elementary::Hash( params.seed, ~uint64_t( 0 ), x ) >> 32 ) < threshold ) {
+				row[ x >> 6 ] |= uint64_t( 1 ) << ( x & 63 );
+			}
+		}
+	}
+
+	// or set it directly, e.g. a single live cell
+	void SetInitialCell ( uint32_t x, bool value ) {
+		uint64_t &w = RowPtr( 0 )[ x >> 6 ];
+		const uint64_t mask = uint64_t( 1 ) << ( x & 63 );
+		w = value ? ( w | mask ) : ( w & ~mask );
+	}
+
+	// steps from row 0 down to the last row
+	elementaryStats_t Run ( const elementaryParams_t &params ) {
+		PROFILE_SCOPE( "Elementary CA Run" );
+		elementaryStats_t stats;
+		uint8_t rule = params.schedule.empty() ? params.rule : params.schedule[ 0 ];
+		stats.startRule = rule;
+
+		const uint64_t lastWordMask = ( width & 63 ) ? ( ( uint64_t( 1 ) << ( width & 63 ) ) - 1 ) : ~uint64_t( 0 );
+		const uint32_t lastWord = ( width - 1 ) >> 6;
+		const double flipScale = ( params.flipChance > 0.0f && params.flipChance < 1.0f ) ? 1.0 / std::log1p( -double( params.flipChance ) ) : 0.0;
+		const double mutationScale = ( params.mutationChance > 0.0f && params.mutationChance < 1.0f ) ? 1.0 / std::log1p( -double( params.mutationChance ) ) : 0.0;
+		const bool mutating = params.schedule.empty() && params.mutationChance > 0.0f;
+		uint64_t mutationCounter = 0;	// mutation draws carry over from row to row, like the rule does
+
+		size_t population = RowPopulation( RowPtr( 0 ) );
+		size_t populationTotal = population;
+		size_t changesTotal = 0;
+
+		// positions where the rule changes in this row, and what it changes to
+		std::vector< std::pair< uint32_t, uint8_t > > changes;
+		uint64_t nextMutation = mutating ? NextGap( params.seed, 1, mutationCounter, mutationScale ) : ~uint64_t( 0 );
+
+		for ( uint32_t y = 1; y < height; y++ ) {
+			uint64_t * src = RowPtr( y - 1 );
+			uint64_t * dst = RowPtr( y );
+			SetHalo( src, params.toroidal );
+
+			if ( !params.schedule.empty() ) {
+				rule = params.schedule[ y % params.schedule.size() ];
+			}
+
+			// mutations are a stream of gaps, counted in cells, across the whole run
+			changes.clear();
+			while ( nextMutation < width ) {
+				const uint8_t newRule = uint8_t( elementary::Hash( params.seed, 2, mutationCounter ) );
+				changes.push_back( { uint32_t( nextMutation ), newRule } );
+				stats.mutations++;
+				nextMutation += 1 + NextGap( params.seed, 1, mutationCounter, mutationScale );
+			}
+			if ( nextMutation != ~uint64_t( 0 ) ) nextMutation -= width;
+
+			// whole row with the rule it started with, then redo the tail after each change
+			elementary::ruleMasks_t masks( params.invert ? uint8_t( ~rule ) : rule );
+			for ( uint32_t w = 0; w < dataWords; w++ ) {
+				dst[ w ] = elementary::StepWord( src + w, masks );
+			}
+			for ( auto &change : changes ) {
+				rule = change.second;
+				masks = elementary::ruleMasks_t( params.invert ? uint8_t( ~rule ) : rule );
+				const uint32_t first = change.first >> 6;
+				const uint64_t keep = ( uint64_t( 1 ) << ( change.first & 63 ) ) - 1;
+				dst[ first ] = ( dst[ first ] & keep ) | ( elementary::StepWord( src + first, masks ) & ~keep );
+				for ( uint32_t w = first + 1; w < dataWords; w++ ) {
+					dst[ w ] = elementary::StepWord( src + w, masks );
+				}
+			}
+
+			// stochastic flips - sparse, so skip straight to each one
+			if ( params.flipChance >= 1.0f ) {
+				for ( uint32_t w = 0; w < dataWords; w++ ) dst[ w ] = ~dst[ w ];
+				stats.flips += width;
+			} else if ( params.flipChance > 0.0f ) {
+				uint64_t counter = 0;
+				uint64_t x = NextGap( params.seed, 3 + uint64_t( y ) * 2, counter, flipScale );
+				while ( x < width ) {
+					dst[ x >> 6 ] ^= uint64_t( 1 ) << ( x & 63 );
+					stats.flips++;
+					x += 1 + NextGap( params.seed, 3 + uint64_t( y ) * 2, counter, flipScale );
+				}
+			}
+
+			// clear out anything computed past the end of the row
+			dst[ lastWord ] &= lastWordMask;
+			for ( uint32_t w = lastWord + 1; w < dataWords; w++ ) dst[ w ] = 0;
+
+			// src carries the halo bit at x = width by now, so stop at the last word and mask it off
+			size_t changed = __builtin_popcountll( ( dst[ lastWord ] ^ src[ lastWord ] ) & lastWordMask );
+			for ( uint32_t w = 0; w < lastWord; w++ ) changed += __builtin_popcountll( dst[ w ] ^ src[ w ] );
+			population = RowPopulation( dst );
+			populationTotal += population;
+			changesTotal += changed;
+		}
+
+		stats.endRule = rule;
+		stats.meanDensity = double( populationTotal ) / ( double( width ) * height );
+		stats.finalDensity = double( population ) / width;
+		stats.meanActivity = height > 1 ? double( changesTotal ) / ( double( width ) * ( height - 1 ) ) : 0.0;
+		return stats;
+	}
+
+	// 1-bit binary PBM, written straight from the packed rows - needs keepRows
+	bool SavePBM ( const std::string &filename ) const {
+		std::ofstream out( filename, std::ios::binary );
+		if ( !out.is_open() ) return false;
+		out << "P4\n" << width << " " << height << "\n";
+		std::vector< uint8_t > bytes( ( width + 7 ) / 8 );
+		for ( uint32_t y = 0; y < height; y++ ) {
+			const uint8_t * row = ( const uint8_t * ) RowPtr( y ); // little endian words, so byte b is cells 8b..8b+7
+			for ( size_t b = 0; b < bytes.size(); b++ ) {
+				// PBM is most significant bit first, and 1 is black - live cells are white, to match the PNGs
+				uint8_t v = row[ b ];
+				v = ( ( v & 0xF0 ) >> 4 ) | ( ( v & 0x0F ) << 4 );
+				v = ( ( v & 0xCC ) >> 2 ) | ( ( v & 0x33 ) << 2 );
+				v = ( ( v & 0xAA ) >> 1 ) | ( ( v & 0x55 ) << 1 );
+				bytes[ b ] = ~v;
+			}
+			out.write( ( const char * ) bytes.data(), bytes.size() );
+		}
+		return out.good();
+	}
+
+	// RGBA8, 255 for live, 0 for dead, alpha 255 - the same pixels as the 1D project's white / black Image_4U, needs keepRows
+	void Expand ( uint8_t * rgba ) const {
+		parallelForRanges( height, [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t y = begin; y < end; y++ ) {
+				const uint64_t * row = RowPtr( uint32_t( y ) );
+				uint32_t * dst = ( uint32_t * ) rgba + y * width;
+				for ( uint32_t x = 0; x < width; x++ ) {
+					dst[ x ] = ( ( row[ x >> 6 ] >> ( x & 63 ) ) & 1u ) ? 0xFFFFFFFFu : 0xFF000000u;
+				}
+			}
+		} );
+	}
+
+	// the same params for each of the 256 rules, with the rule swapped out
+	static std::vector< elementaryParams_t > AllRules ( const elementaryParams_t &base ) {
+		std::vector< elementaryParams_t > runs( 256, base );
+		for ( int r = 0; r < 256; r++ ) runs[ r ].rule = uint8_t( r );
+		return runs;
+	}
+
+	// independent runs spread across threads, one field per thread - onDone( runIndex, field, stats ) is called on
+		// the worker thread, while that field still holds the run ( e.g. to SavePBM it )
+	template < typename func_t >
+	static std::vector< elementaryStats_t > Sweep ( uint32_t w, uint32_t h, const std::vector< elementaryParams_t > &runs, bool keepRows, func_t onDone, uint32_t numThreads = 0 ) {
+		std::vector< elementaryStats_t > results( runs.size() );
+		if ( numThreads == 0 ) numThreads = parallelThreadCount();
+		std::vector< elementaryCA > fields( numThreads );
+		parallelForDynamic( runs.size(), [ & ] ( size_t i, uint32_t threadIndex ) {
+			elementaryCA &field = fields[ threadIndex ];
+			if ( field.Width() != w || field.Height() != h || field.KeepsRows() != keepRows ) {
+				field.Resize( w, h, keepRows );
+			}
+			field.SeedRow( runs[ i ] );
+			results[ i ] = field.Run( runs[ i ] );
+			onDone( i, field, results[ i ] );
+		}, 1, numThreads );
+		return results;
+	}
+
+	static std::vector< elementaryStats_t > Sweep ( uint32_t w, uint32_t h, const std::vector< elementaryParams_t > &runs, uint32_t numThreads = 0 ) {
+		return Sweep( w, h, runs, false, [] ( size_t, const elementaryCA &, const elementaryStats_t & ) {}, numThreads );
+	}
+
+	struct benchmarkResult_t {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t threads = 0;
+		double singleSeconds = 0.0;			// one run, keeping every row
+		double singleCellsPerSecond = 0.0;
+		double sweepSeconds = 0.0;			// all 256 rules, statistics only
+		double sweepCellsPerSecond = 0.0;
+	};
+
+	static benchmarkResult_t Benchmark ( uint32_t w, uint32_t h, const elementaryParams_t &params ) {
+		benchmarkResult_t result;
+		result.width = w;
+		result.height = h;
+		result.threads = parallelThreadCount();
+
+		elementaryCA field( w, h, true );
+		field.SeedRow( params );
+		auto tStart = std::chrono::steady_clock::now();
+		field.Run( params );
+		result.singleSeconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - tStart ).count();
+		result.singleCellsPerSecond = double( w ) * h / std::max( result.singleSeconds, 1e-9 );
+
+		tStart = std::chrono::steady_clock::now();
+		Sweep( w, h, AllRules( params ) );
+		result.sweepSeconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - tStart ).count();
+		result.sweepCellsPerSecond = 256.0 * double( w ) * h / std::max( result.sweepSeconds, 1e-9 );
+		return result;
+	}
+
+private:
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t dataWords = 0;
+	uint32_t stride = 0;
+	bool keepRows = true;
+
+	// guard word before each row, pointer is to the first data word ( x = 0..63 )
+	std::vector< uint64_t > rows;
+
+	uint64_t * RowPtr ( uint32_t y ) { return rows.data() + size_t( keepRows ? y : ( y & 1 ) ) * stride + 1; }
+	const uint64_t * RowPtr ( uint32_t y ) const { return rows.data() + size_t( keepRows ? y : ( y & 1 ) ) * stride + 1; }
+
+	size_t RowPopulation ( const uint64_t * row ) const {
+		size_t total = 0;
+		for ( uint32_t w = 0; w < dataWords; w++ ) total += __builtin_popcountll( row[ w ] );
+		return total;
+	}
+
+	// the neighbors of the end cells - zero, or the far end of the row
+	void SetHalo ( uint64_t * row, bool toroidal ) const {
+		const bool last = ( row[ ( width - 1 ) >> 6 ] >> ( ( width - 1 ) & 63 ) ) & 1u;
+		const bool first = row[ 0 ] & 1u;
+		row[ -1 ] = ( toroidal && last ) ? ( uint64_t( 1 ) << 63 ) : 0;
+		const uint64_t mask = uint64_t( 1 ) << ( width & 63 );
+		uint64_t &w = row[ width >> 6 ];
+		w = ( toroidal && first ) ? ( w | mask ) : ( w & ~mask );
+		row[ dataWords ] = 0;
+	}
+
+	// cells to skip before the next event, geometric for a per cell chance - scale is 1 / log( 1 - chance )
+	static uint64_t NextGap ( uint64_t seed, uint64_t stream, uint64_t &counter, double scale ) {
+		if ( scale == 0.0 ) return 0; // chance of 1
+		const double gap = std::floor( std::log( elementary::Uniform( elementary::Hash( seed, stream, counter++ ) ) ) * scale );
+		return gap < 1e18 ? uint64_t( gap ) : ~uint64_t( 0 ) >> 1;
+	}
+};
+
+#endif // ELEMENTARY_CA_H
@@ -1,4 +1,6 @@
 #include "../../../engine/engine.h"
+#include "tableRules.h"
+#include "tableRuleExplorer.h"
 
 struct CAConfig_t {
 	// CA buffer dimensions
@@ -99,32 +101,47 @@ public:
 			// field state buffer ( move to shader )
 			BufferReset();
 
-			// loading the list of rules...
-			json j2; ifstream i2 ( "./tableCArules.json" ); i2 >> j2; i2.close();
-			std::vector< std::vector< int > > rules;
-			for ( auto& rule : j2 ) {
-				std::vector< int > currentRule;
-				for ( auto& entry : rule ) {
-					currentRule.push_back( int( entry ) );
-				}
-				rules.push_back( currentRule );
-			}
-
-			for ( auto& rule : rules ) {
-				uvec2 encodedRule = uvec2( 0 );
-				for ( int i = 0; i < 16; i++ ) { // encode 0..15
-					encodedRule.x += ( rule[ i ] << ( 30 - 2 * i ) );
-				}
-
-				for ( int i = 16; i < 25; i++ ) { // encode 16..24
-					encodedRule.y += ( rule[ i ] << ( 30 - 2 * ( i - 16 ) ) );
-				}
-				CAConfig.encodedRules.push_back( encodedRule );
+			// loading the list of rules... binary cache next to the json, rebuilt when the json changes
+			tableRuleLibrary_t library;
+			if ( library.LoadCached( "./tableCArules.json", "./tableCArules.bin" ) ) {
+				CAConfig.encodedRules = library.rules;
+			} else {
+				cout << "Failed to load table CA rules" << endl;
+				CAConfig.encodedRules.push_back( tableRules::Encode( CAConfig.rule ) );
 			}
 
 			// put some contents into the rule buffer
 			newRule();
 
+			terminal.addCommand( { "exploreRules" }, {
+					{ "count", INT, "Number of candidate rules to evaluate." },
+					{ "steps", INT, "Number of generations to run each candidate." },
+					{ "mutate", BOOL, "Mutate rules from the loaded library, instead of generating random ones." }
+				}, [=] ( args_t args ) {
+					tableRuleLibrary_t parents;
+					for ( auto& rule : CAConfig.encodedRules ) parents.Add( rule );
+					static uint64_t seed = 1;
+					const std::vector< uvec2 > candidates = tableRuleExplorer::GenerateCandidates( std::max( 1, int( args[ "count" ].data.x ) ), seed++, ( args[ "mutate" ].data.x != 0.0f ) ? &parents : nullptr );
+
+					tableRuleExplorer explorer;
+					explorer.config.steps = std::max( 1, int( args[ "steps" ].data.x ) );
+					explorer.config.initialDensity = CAConfig.generatorThreshold;
+					auto tStart = std::chrono::high_resolution_clock::now();
+					std::vector< tableRuleStats_t > results = explorer.Evaluate( candidates );
+					const float seconds = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::high_resolution_clock::now() - tStart ).count() / 1e6f;
+					tableRuleExplorer::SortByScore( results );
+					tableRuleExplorer::WriteCSV( "./tableCAexplore.csv", results );
+
+					terminal.addHistoryLine( terminal.csb.append( "Evaluated " + to_string( results.size() ) + " rules in " + to_string( seconds * 1000.0f ) + "ms, wrote tableCAexplore.csv" ).flush() );
+					for ( size_t i = 0; i < std::min( size_t( 5 ), results.size() ); i++ ) {
+						int entries[ 25 ];
+						tableRules::Decode( results[ i ].rule, entries );
+						string ruleString;
+						for ( int j = 0; j < 25; j++ ) ruleString += to_string( entries[ j ] );
+						terminal.addHistoryLine( terminal.csb.append( "  " + ruleString + " score " + to_string( results[ i ].score ) + " activity " + to_string( results[ i ].meanActivity ) + " period " + to_string( results[ i ].period ) ).flush() );
+					}
+				}, "Evaluate a batch of candidate rules on the CPU, and write per-rule statistics to tableCAexplore.csv." );
+
 			/* {
 				const int glyphHeight = 17;
 				const int glyphWidth = 12;
@@ -243,28 +260,10 @@ public:
 
 				// identify duplicate rules, exact matches only
 				cout << "Removing duplicates..." << endl;
+				tableRuleLibrary_t deduplicated;
 				std::vector < std::vector< int > > finalRules;
-				for ( int i = 0; i < rules.size(); i++ ) {
-					std::vector< int > rule = rules[ i ];
-
-					bool found = false;
-					for ( int j = 0; j < finalRules.size(); j++ ) {
-						// if not found in the list of final rules
-						bool match = true;
-						for ( int k = 0; k < 25; k++ ) {
-							if ( rule[ k ] != finalRules[ j ][ k ] ) {
-								match = false;
-								break;
-							}
-						}
-
-						// found match invalidates the rule being added
-						if ( match == true ) {
-							found = true;
-						}
-					}
-
-					if ( !found ) {
+				for ( auto& rule : rules ) {
+					if ( deduplicated.Add( rule.data() ) ) {
 						finalRules.push_back( rule );
 					}
 				}
@@ -327,7 +326,7 @@ public:
 	}
 
 	void HandleCustomEvents () {
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		const uint8_t * state = SDL_GetKeyboardState( NULL );
 		if ( state[ SDL_SCANCODE_R ] ) {
@@ -369,7 +368,7 @@ public:
 		string frontBufferLabel;
 
 		{
-			scopedTimer Start( "Update" );
+			SCOPED_TIMER( "Update" );
 			bool bufferToggle = CAConfig.oddFrame;
 			for ( int i = 0; i < 64; i++ ) {
 				// swap buffers - precalculate strings for use later
@@ -397,7 +396,7 @@ public:
 		}
 
 		{ // draw the current state of the front buffer
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 			glUseProgram( shaders[ "Draw" ] );
 
@@ -413,7 +412,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -422,7 +421,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 
 			// for ( int i = 0; i < 5; i++ ) {
@@ -447,7 +446,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
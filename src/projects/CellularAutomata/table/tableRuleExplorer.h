@@ -0,0 +1,273 @@
+#pragma once
+#ifndef TABLE_RULE_EXPLORER_H
+#define TABLE_RULE_EXPLORER_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+
+#include "tableRules.h"
+#include "../../../engine/coreUtils/parallel.h"
+
+// Headless batch evaluation of table CA rules - each candidate gets its own small CPU field, stepped with the
+	// same update as update.cs.glsl ( bit 0 only, one rule over the whole field ), and we keep some statistics
+	// that separate the rules that die or freeze from the ones that keep doing something, to screen offline.
+
+struct tableRuleStats_t {
+	glm::uvec2 rule = glm::uvec2( 0 );
+	float finalDensity = 0.0f;		// fraction of live cells at the end
+	float meanActivity = 0.0f;		// fraction of cells changing state per step, over the measurement window
+	float blockEntropy = 0.0f;		// entropy of 2x2 block patterns in the final field, normalized to 0..1
+	float activityEntropy = 0.0f;	// entropy of the per-cell change counts over the measurement window, 0..1
+	uint32_t period = 0;			// 0 if no short cycle was found, 1 for a still field, N for an N-step oscillation
+	float score = 0.0f;				// heuristic "interesting-ness" used for sorting
+};
+
+struct tableRuleExplorerConfig_t {
+	uint32_t fieldSize = 64;		// square field, per candidate
+	uint32_t steps = 256;			// total steps
+	uint32_t measureSteps = 64;		// the tail of the run where statistics are collected
+	float initialDensity = 0.5f;
+	uint64_t seed = 1;
+	bool toroidal = true;			// false matches the GPU edges
+	bool sharedInitialState = true;	// every candidate starts from the same field, so results are comparable
+	uint32_t numThreads = 0;		// 0 is one per core
+};
+
+class tableRuleExplorer {
+public:
+	tableRuleExplorerConfig_t config;
+
+	// counter based, so every candidate / field is reproducible from the seed alone
+	static uint64_t SplitMix ( uint64_t &state ) {
+		uint64_t z = ( state += 0x9E3779B97F4A7C15ull );
+		z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+		z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+		return z ^ ( z >> 31 );
+	}
+
+	static glm::uvec2 RandomRule ( uint64_t &state ) {
+		int rule[ 25 ];
+		for ( int i = 0; i < 25; i++ ) rule[ i ] = int( SplitMix( state ) % 3 );
+		return tableRules::Encode( rule );
+	}
+
+	static glm::uvec2 Mutate ( const glm::uvec2 encodedRule, const int numMutations, uint64_t &state ) {
+		int rule[ 25 ];
+		tableRules::Decode( encodedRule, rule );
+		for ( int i = 0; i < numMutations; i++ ) {
+			const int index = int( SplitMix( state ) % 25 );
+			rule[ index ] = ( rule[ index ] + 1 + int( SplitMix( state ) % 2 ) ) % 3; // always a different value
+		}
+		return tableRules::Encode( rule );
+	}
+
+	// random rules, or single/double point mutations of a parent library when one is given - deduplicated
+		// against each other and against the parents
+	static std::vector< glm::uvec2 > GenerateCandidates ( const size_t count, const uint64_t seed, const tableRuleLibrary_t * parents = nullptr ) {
+		tableRuleLibrary_t seen;
+		if ( parents ) {
+			for ( auto& rule : parents->rules ) seen.Add( rule );
+		}
+		std::vector< glm::uvec2 > candidates;
+		candidates.reserve( count );
+		uint64_t state = seed;
+		size_t attempts = 0;
+		while ( candidates.size() < count && attempts++ < count * 16 ) {
+			const glm::uvec2 rule = ( parents && parents->Count() ) ?
+				Mutate( parents->rules[ SplitMix( state ) % parents->Count() ], 1 + int( SplitMix( state ) % 2 ), state ) :
+				RandomRule( state );
+			if ( seen.Add( rule ) ) {
+				candidates.push_back( rule );
+			}
+		}
+		return candidates;
+	}
+
+	std::vector< tableRuleStats_t > Evaluate ( const std::vector< glm::uvec2 > &candidates ) {
+		std::vector< tableRuleStats_t > results( candidates.size() );
+		const uint32_t numThreads = config.numThreads ? config.numThreads : parallelThreadCount();
+		std::vector< scratch_t > scratch( numThreads );
+		parallelForDynamic( candidates.size(), [ & ] ( size_t i, uint32_t threadIndex ) {
+			results[ i ] = EvaluateOne( candidates[ i ], i, scratch[ threadIndex ] );
+		}, 4, numThreads );
+		return results;
+	}
+
+	static void SortByScore ( std::vector< tableRuleStats_t > &results ) {
+		std::stable_sort( results.begin(), results.end(), [] ( const tableRuleStats_t &a, const tableRuleStats_t &b ) { return a.score > b.score; } );
+	}
+
+	static bool WriteCSV ( const std::string &path, const std::vector< tableRuleStats_t > &results ) {
+		std::ofstream file( path );
+		if ( !file.is_open() ) return false;
+		file << "ruleX,ruleY,rule,score,finalDensity,meanActivity,blockEntropy,activityEntropy,period\n";
+		for ( auto& r : results ) {
+			int entries[ 25 ];
+			tableRules::Decode( r.rule, entries );
+			std::string ruleString;
+			for ( int i = 0; i < 25; i++ ) ruleString += char( '0' + entries[ i ] );
+			file << r.rule.x << "," << r.rule.y << "," << ruleString << "," << r.score << "," << r.finalDensity << "," << r.meanActivity << ","
+				<< r.blockEntropy << "," << r.activityEntropy << "," << r.period << "\n";
+		}
+		return file.good();
+	}
+
+private:
+	// per-thread working memory, reused across candidates
+	struct scratch_t {
+		std::vector< uint8_t > front, back;
+		std::vector< uint16_t > changeCounts;
+		std::vector< uint64_t > hashHistory;
+	};
+
+	static constexpr uint32_t maxDetectedPeriod = 16;
+
+	tableRuleStats_t EvaluateOne ( const glm::uvec2 encodedRule, const size_t candidateIndex, scratch_t &s ) const {
+		const uint32_t n = config.fieldSize;
+		const uint32_t p = n + 2; // padded, with a one cell halo
+		s.front.assign( size_t( p ) * p, 0 );
+		s.back.assign( size_t( p ) * p, 0 );
+		s.changeCounts.assign( size_t( n ) * n, 0 );
+		s.hashHistory.clear();
+
+		// entry 2 keeps the previous state, 1 sets it, 0 clears it - as two masks, so the inner loop has no branch
+		int lut[ 25 ];
+		uint8_t keep[ 25 ], set[ 25 ];
+		tableRules::Decode( encodedRule, lut );
+		for ( int i = 0; i < 25; i++ ) {
+			keep[ i ] = ( lut[ i ] == 2 ) ? 1 : 0;
+			set[ i ] = ( lut[ i ] == 1 ) ? 1 : 0;
+		}
+
+		// initial state
+		uint64_t state = config.seed ^ ( config.sharedInitialState ? 0 : ( candidateIndex + 1 ) * 0x2545F4914F6CDD1Dull );
+		const uint64_t threshold = uint64_t( double( config.initialDensity ) * 4294967296.0 );
+		for ( uint32_t y = 0; y < n; y++ )
+			for ( uint32_t x = 0; x < n; x++ )
+				s.front[ ( y + 1 ) * p + x + 1 ] = ( ( SplitMix( state ) & 0xFFFFFFFFull ) < threshold ) ? 1 : 0;
+
+		tableRuleStats_t stats;
+		stats.rule = encodedRule;
+		const uint32_t measureStart = config.steps - std::min( config.measureSteps, config.steps );
+		uint64_t totalChanges = 0;
+
+		for ( uint32_t step = 0; step < config.steps; step++ ) {
+			RefreshHalo( s.front, n );
+			const bool measuring = step >= measureStart;
+			if ( measuring ) {
+				totalChanges += StepField< true >( s, n, keep, set );
+			} else {
+				StepField< false >( s, n, keep, set );
+			}
+			std::swap( s.front, s.back );
+
+			// cycle detection, only in the measurement window
+			if ( measuring && stats.period == 0 ) {
+				const uint64_t hash = HashField( s.front, n );
+				for ( uint32_t back = 1; back <= s.hashHistory.size() && back <= maxDetectedPeriod; back++ ) {
+					if ( s.hashHistory[ s.hashHistory.size() - back ] == hash ) {
+						stats.period = back;
+						break;
+					}
+				}
+				s.hashHistory.push_back( hash );
+			}
+		}
+
+		// statistics on the final field
+		const float cells = float( n ) * float( n );
+		size_t live = 0;
+		uint32_t blockCounts[ 16 ] = { 0 };
+		for ( uint32_t y = 1; y <= n; y++ ) {
+			for ( uint32_t x = 1; x <= n; x++ ) {
+				live += s.front[ y * p + x ];
+				if ( x < n && y < n ) {
+					blockCounts[ s.front[ y * p + x ] | ( s.front[ y * p + x + 1 ] << 1 ) | ( s.front[ ( y + 1 ) * p + x ] << 2 ) | ( s.front[ ( y + 1 ) * p + x + 1 ] << 3 ) ]++;
+				}
+			}
+		}
+		stats.finalDensity = float( live ) / cells;
+		stats.meanActivity = config.measureSteps ? float( totalChanges ) / ( cells * float( std::min( config.measureSteps, config.steps ) ) ) : 0.0f;
+		stats.blockEntropy = Entropy( blockCounts, 16 ) / 4.0f;
+
+		// how evenly the change is spread over the field - a single blinker in a dead field has high activity
+			// in a few cells and zero everywhere else, which shows up as low entropy here
+		const uint32_t window = std::min( config.measureSteps, config.steps );
+		std::vector< uint32_t > histogram( window + 1, 0 );
+		for ( auto c : s.changeCounts ) histogram[ std::min( uint32_t( c ), window ) ]++;
+		stats.activityEntropy = window ? Entropy( histogram.data(), window + 1 ) / std::log2( float( window + 1 ) ) : 0.0f;
+
+		// favor fields that stay busy, structured, and not stuck in a short loop
+		const float busy = std::clamp( stats.meanActivity / 0.05f, 0.0f, 1.0f ) * std::clamp( ( 0.6f - stats.meanActivity ) / 0.2f, 0.0f, 1.0f );
+		const float looping = ( stats.period == 0 ) ? 1.0f : ( stats.period == 1 ? 0.0f : 0.3f );
+		stats.score = busy * looping * ( 0.5f * stats.blockEntropy + 0.5f * stats.activityEntropy );
+		return stats;
+	}
+
+	// one generation from front to back, same update as update.cs.glsl - returns the number of cells that changed
+	template < bool measure >
+	static uint64_t StepField ( scratch_t &s, const uint32_t n, const uint8_t keep[ 25 ], const uint8_t set[ 25 ] ) {
+		const uint32_t p = n + 2;
+		uint64_t changes = 0;
+		for ( uint32_t y = 1; y <= n; y++ ) {
+			const uint8_t * above = &s.front[ ( y - 1 ) * p ];
+			const uint8_t * row = &s.front[ y * p ];
+			const uint8_t * below = &s.front[ ( y + 1 ) * p ];
+			uint8_t * out = &s.back[ y * p ];
+			for ( uint32_t x = 1; x <= n; x++ ) {
+				const int ortho = above[ x ] + below[ x ] + row[ x - 1 ] + row[ x + 1 ];
+				const int diag = above[ x - 1 ] + above[ x + 1 ] + below[ x - 1 ] + below[ x + 1 ];
+				const int index = ortho + 5 * diag;
+				out[ x ] = ( row[ x ] & keep[ index ] ) | set[ index ];
+				if ( measure ) {
+					const uint8_t changed = out[ x ] ^ row[ x ];
+					changes += changed;
+					s.changeCounts[ ( y - 1 ) * n + x - 1 ] += changed;
+				}
+			}
+		}
+		return changes;
+	}
+
+	void RefreshHalo ( std::vector< uint8_t > &field, const uint32_t n ) const {
+		const uint32_t p = n + 2;
+		if ( !config.toroidal ) return; // halo was zeroed on init and is never written
+		for ( uint32_t y = 1; y <= n; y++ ) {
+			field[ y * p ] = field[ y * p + n ];
+			field[ y * p + n + 1 ] = field[ y * p + 1 ];
+		}
+		std::copy( &field[ n * p ], &field[ n * p ] + p, &field[ 0 ] );
+		std::copy( &field[ p ], &field[ p ] + p, &field[ ( n + 1 ) * p ] );
+	}
+
+	static uint64_t HashField ( const std::vector< uint8_t > &field, const uint32_t n ) {
+		const uint32_t p = n + 2;
+		uint64_t hash = 14695981039346656037ull;
+		for ( uint32_t y = 1; y <= n; y++ ) {
+			for ( uint32_t x = 1; x <= n; x++ ) {
+				hash ^= field[ y * p + x ];
+				hash *= 1099511628211ull;
+			}
+		}
+		return hash;
+	}
+
+	static float Entropy ( const uint32_t * counts, const size_t n ) {
+		double total = 0.0;
+		for ( size_t i = 0; i < n; i++ ) total += counts[ i ];
+		if ( total == 0.0 ) return 0.0f;
+		double h = 0.0;
+		for ( size_t i = 0; i < n; i++ ) {
+			if ( counts[ i ] ) {
+				const double q = counts[ i ] / total;
+				h -= q * std::log2( q );
+			}
+		}
+		return float( h );
+	}
+};
+
+#endif // TABLE_RULE_EXPLORER_H
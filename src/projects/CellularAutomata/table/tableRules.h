@@ -0,0 +1,164 @@
+#pragma once
+#ifndef TABLE_RULES_H
+#define TABLE_RULES_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <unordered_set>
+#include <filesystem>
+
+#include "../../../utils/GLM/glm.hpp"
+#include "../../../utils/Serialization/JSON/json.hpp"
+
+// Rule storage for the table CA
+	// a rule is 25 entries, indexed by ( orthogonal neighbor count ) + 5 * ( diagonal neighbor count ), each one
+	// of 0 ( dead ), 1 ( alive ), 2 ( keep previous state ). The shaders take them packed 2 bits per entry into a
+	// uvec2 - entries 0..15 in x, 16..24 in y, first entry in the high bits.
+
+namespace tableRules {
+
+	inline glm::uvec2 Encode ( const int rule[ 25 ] ) {
+		glm::uvec2 encodedRule = glm::uvec2( 0 );
+		for ( int i = 0; i < 16; i++ ) { // encode 0..15
+			encodedRule.x += ( uint32_t( rule[ i ] ) << ( 30 - 2 * i ) );
+		}
+		for ( int i = 16; i < 25; i++ ) { // encode 16..24
+			encodedRule.y += ( uint32_t( rule[ i ] ) << ( 30 - 2 * ( i - 16 ) ) );
+		}
+		return encodedRule;
+	}
+
+	// same masking + clamp as getRuleValue() in update.cs.glsl
+	inline int GetEntry ( const glm::uvec2 encodedRule, const int index ) {
+		const uint32_t word = ( index < 16 ) ? encodedRule.x : encodedRule.y;
+		const int shift = 30 - 2 * ( ( index < 16 ) ? index : ( index - 16 ) );
+		return std::min( int( ( word >> shift ) & 3u ), 2 );
+	}
+
+	inline void Decode ( const glm::uvec2 encodedRule, int rule[ 25 ] ) {
+		for ( int i = 0; i < 25; i++ ) {
+			rule[ i ] = GetEntry( encodedRule, i );
+		}
+	}
+
+	inline uint64_t Key ( const glm::uvec2 encodedRule ) {
+		return ( uint64_t( encodedRule.x ) << 32 ) | encodedRule.y;
+	}
+
+	// FNV-1a, used to tell if the binary cache is stale relative to the json it was built from
+	inline uint64_t HashFile ( const std::string &path ) {
+		std::ifstream file( path, std::ios::binary );
+		std::vector< char > bytes( ( std::istreambuf_iterator< char >( file ) ), std::istreambuf_iterator< char >() );
+		uint64_t hash = 14695981039346656037ull;
+		for ( char c : bytes ) {
+			hash ^= uint8_t( c );
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+}
+
+//=============================================================================
+//==== Rule Library ===========================================================
+//=============================================================================
+
+struct tableRuleLibrary_t {
+	std::vector< glm::uvec2 > rules;
+	std::unordered_set< uint64_t > present; // exact-match deduplication
+
+	size_t Count () const { return rules.size(); }
+
+	void Clear () {
+		rules.clear();
+		present.clear();
+	}
+
+	// returns false if the rule is already in the library
+	bool Add ( const glm::uvec2 encodedRule ) {
+		if ( !present.insert( tableRules::Key( encodedRule ) ).second ) {
+			return false;
+		}
+		rules.push_back( encodedRule );
+		return true;
+	}
+
+	bool Add ( const int rule[ 25 ] ) {
+		return Add( tableRules::Encode( rule ) );
+	}
+
+	bool Contains ( const glm::uvec2 encodedRule ) const {
+		return present.count( tableRules::Key( encodedRule ) ) != 0;
+	}
+
+	// the harvested rule list, { "ruleIndex": { "entryIndex": value, ... }, ... }
+		// iteration order is kept identical to what the old per-launch parse did - nlohmann stores object keys
+		// sorted as strings, so both the rules and their entries come out in "0", "1", "10", "11", ... order
+	bool ImportJSON ( const std::string &path ) {
+		std::ifstream file( path );
+		if ( !file.is_open() ) return false;
+		nlohmann::json j; file >> j; file.close();
+		for ( auto& rule : j ) {
+			int entries[ 25 ] = { 0 };
+			int i = 0;
+			for ( auto& entry : rule ) {
+				if ( i < 25 ) entries[ i++ ] = int( entry );
+			}
+			Add( entries );
+		}
+		return true;
+	}
+
+	// binary layout: "TCAR", uint32 version, uint64 source hash, uint32 count, count x uvec2
+	static constexpr uint32_t magic = 0x52414354; // "TCAR", little endian
+	static constexpr uint32_t version = 1;
+
+	bool SaveBinary ( const std::string &path, const uint64_t sourceHash = 0 ) const {
+		std::ofstream file( path, std::ios::binary );
+		if ( !file.is_open() ) return false;
+		const uint32_t count = uint32_t( rules.size() );
+		file.write( ( const char * ) &magic, sizeof( magic ) );
+		file.write( ( const char * ) &version, sizeof( version ) );
+		file.write( ( const char * ) &sourceHash, sizeof( sourceHash ) );
+		file.write( ( const char * ) &count, sizeof( count ) );
+		file.write( ( const char * ) rules.data(), count * sizeof( glm::uvec2 ) );
+		return file.good();
+	}
+
+	// sourceHash is written out if non-null, so callers can check it against the json
+	bool LoadBinary ( const std::string &path, uint64_t * sourceHash = nullptr ) {
+		std::ifstream file( path, std::ios::binary );
+		if ( !file.is_open() ) return false;
+		uint32_t fileMagic = 0, fileVersion = 0, count = 0;
+		uint64_t hash = 0;
+		file.read( ( char * ) &fileMagic, sizeof( fileMagic ) );
+		file.read( ( char * ) &fileVersion, sizeof( fileVersion ) );
+		file.read( ( char * ) &hash, sizeof( hash ) );
+		file.read( ( char * ) &count, sizeof( count ) );
+		if ( !file.good() || fileMagic != magic || fileVersion != version ) return false;
+		std::vector< glm::uvec2 > loaded( count );
+		file.read( ( char * ) loaded.data(), count * sizeof( glm::uvec2 ) );
+		if ( !file.good() ) return false;
+		Clear();
+		for ( auto& rule : loaded ) Add( rule );
+		if ( sourceHash ) *sourceHash = hash;
+		return true;
+	}
+
+	// use the binary cache next to the json when it was built from the current json, otherwise parse and rewrite it
+	bool LoadCached ( const std::string &jsonPath, const std::string &binaryPath ) {
+		const bool haveJSON = std::filesystem::exists( jsonPath );
+		const uint64_t jsonHash = haveJSON ? tableRules::HashFile( jsonPath ) : 0;
+		uint64_t cachedHash = 0;
+		if ( LoadBinary( binaryPath, &cachedHash ) && ( !haveJSON || cachedHash == jsonHash ) ) {
+			return true;
+		}
+		Clear();
+		if ( !ImportJSON( jsonPath ) ) return false;
+		SaveBinary( binaryPath, jsonHash );
+		return true;
+	}
+};
+
+#endif // TABLE_RULES_H
@@ -102,7 +102,7 @@ public:
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 
 	}
@@ -126,7 +126,7 @@ public:
 	}
 
 	void DrawAPIGeometry () {
-		ZoneScoped; scopedTimer Start( "API Geometry" );
+		ZoneScoped; SCOPED_TIMER( "API Geometry" );
 		// draw some shit - need to add a hello triangle to this, so I have an easier starting point for raster stuff
 	}
 
@@ -134,7 +134,7 @@ public:
 		ZoneScoped;
 
 		{ // dummy draw - draw something into accumulatorTexture
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 			glUseProgram( shaders[ "Dummy Draw" ] );
 			glUniform1f( glGetUniformLocation( shaders[ "Dummy Draw" ], "time" ), SDL_GetTicks() / 1600.0f );
@@ -143,7 +143,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -158,7 +158,7 @@ public:
 			// ...
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Clear();
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 
@@ -171,14 +171,14 @@ public:
 		}
 
 		{ // show trident with current orientation
-			// scopedTimer Start( "Trident" );
+			// SCOPED_TIMER( "Trident" );
 			// trident.Update( textureManager.Get( "Display Texture" ) );
 			// glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 		}
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 		// application-specific update code
 	}
 
@@ -189,7 +189,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
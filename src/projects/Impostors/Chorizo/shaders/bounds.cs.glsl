@@ -17,11 +17,12 @@ layout( binding = 0, std430 ) buffer transformsBuffer {
 // ===================================================================================================
 // input to the bounds stage
 // ===================================================================================================
-struct parameters_t {
-	float data[ 16 ];
-};
+#include "primitiveCodec.glsl.h"
 layout( binding = 1, std430 ) buffer parametersBuffer {
-	parameters_t parametersList[];
+	uvec4 parametersList[];
+};
+layout( binding = 4, std430 ) buffer parametersClusterBuffer {
+	clusterHeader_t parametersClusters[];
 };
 
 // ===================================================================================================
@@ -94,7 +95,7 @@ void main () {
 
 	// getting this object's parameters
 	uint index = gl_GlobalInvocationID.x + 4096 * gl_GlobalInvocationID.y;
-	parameters_t parameters = parametersList[ index ];
+	parameters_t parameters = DecodePrimitive( parametersList[ index ], parametersClusters[ index / primitiveClusterSize ] );
 	mat4 result;
 
 	// changing behavior, based on the contained primitive
@@ -95,18 +95,19 @@ float SpiralAO ( vec2 uv, vec3 p, vec3 n, float rad ) {
 }
 
 // ===================================================================================================
-struct parameters_t {
-	float data[ 16 ];
-};
+#include "primitiveCodec.glsl.h"
 layout( binding = 1, std430 ) buffer parametersBuffer {
-	parameters_t parametersList[];
+	uvec4 parametersList[];
 };
-// ===================================================================================================
-struct pointSpriteParameters_t {
-	float data[ 16 ];
+layout( binding = 4, std430 ) buffer parametersClusterBuffer {
+	clusterHeader_t parametersClusters[];
 };
+// ===================================================================================================
 layout( binding = 2, std430 ) buffer pointSpriteParametersBuffer {
-	pointSpriteParameters_t pointSpriteParameters[];
+	uvec4 pointSpriteParameters[];
+};
+layout( binding = 5, std430 ) buffer pointSpriteClusterBuffer {
+	clusterHeader_t pointSpriteClusters[];
 };
 // ===================================================================================================
 uniform int numLights;
@@ -157,7 +158,7 @@ void main () {
 	if ( idSample.x != 0 ) { // these are texels which wrote out a fragment during the raster geo pass, bounding box impostors
 
 		drawing = true;
-		const parameters_t parameters = parametersList[ idSample.x - 1 ];
+		const parameters_t parameters = DecodePrimitive( parametersList[ idSample.x - 1 ], parametersClusters[ ( idSample.x - 1 ) / primitiveClusterSize ] );
 
 		float result = 0.0f;
 
@@ -212,7 +213,7 @@ void main () {
 		// this will need to be revisited... I don't know how they will get normals back out - not critical, for now
 
 		drawing = true;
-		pointSpriteParameters_t parameters = pointSpriteParameters[ idSample.y - 1 ];
+		parameters_t parameters = DecodePrimitive( pointSpriteParameters[ idSample.y - 1 ], pointSpriteClusters[ ( idSample.y - 1 ) / primitiveClusterSize ] );
 
 		emissive = ( parameters.data[ 4 ] != parameters.data[ 5 ] );
 		knownRadius = parameters.data[ 4 ];
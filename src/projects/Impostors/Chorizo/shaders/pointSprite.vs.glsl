@@ -11,20 +11,22 @@ uniform vec2 viewportSize;
 uniform mat4 viewTransform;
 uniform mat4 projTransform;
 
-struct parameters_t {
-	float data[ 16 ];
-};
+#include "primitiveCodec.glsl.h"
 layout( binding = 2, std430 ) buffer parametersBuffer {
-	parameters_t parameters[];
+	uvec4 parameters[];
+};
+layout( binding = 5, std430 ) buffer parametersClusterBuffer {
+	clusterHeader_t parametersClusters[];
 };
 
 void main() {
 	vofiIndex = gl_VertexID;
-	vec4 position = vec4( parameters[ vofiIndex ].data[ 1 ], parameters[ vofiIndex ].data[ 2 ], parameters[ vofiIndex ].data[ 3 ], 1.0f );
+	const parameters_t sprite = DecodePrimitive( parameters[ vofiIndex ], parametersClusters[ vofiIndex / primitiveClusterSize ] );
+	vec4 position = vec4( sprite.data[ 1 ], sprite.data[ 2 ], sprite.data[ 3 ], 1.0f );
 	vofiPosition = position.xyz;
 	gl_Position = viewTransform * position;
 
-	const float radius = parameters[ vofiIndex ].data[ 4 ];
+	const float radius = sprite.data[ 4 ];
 
 	// https://stackoverflow.com/questions/25780145/gl-pointsize-corresponding-to-world-space-size
 	center = ( 0.5f * gl_Position.xy / gl_Position.w + 0.5f ) * viewportSize;
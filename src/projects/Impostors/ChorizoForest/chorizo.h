@@ -6,6 +6,8 @@ struct ChorizoConfig_t {
 	GLuint shapeParametersBuffer;
 	GLuint boundsTransformBuffer;
 	GLuint pointSpriteParametersBuffer;
+	GLuint shapeClustersBuffer;
+	GLuint pointSpriteClustersBuffer;
 	GLuint lightsBuffer;
 	GLuint primaryFramebuffer[ 2 ];
 
@@ -110,6 +112,12 @@ public:
 
 			PrepSSBOs();
 
+			// == Packed Primitive Encoding Report ===================================================
+			primitiveCodec::AddReportCommand( terminal, {
+				{ "Bounding Box Impostors", &ChorizoConfig.geometryManager.primitivesReport },
+				{ "Point Sprite Impostors", &ChorizoConfig.geometryManager.pointSpritesReport }
+			} );
+
 			// == Render Framebuffer(s) ===========
 			textureOptions_t opts;
 			// ==== Depth =========================
@@ -247,7 +255,15 @@ public:
 		rng reject = rng( 0.0f, 1.0f );
 		rng jitter = rng( 0.2f, 1.1f );
 		rng di = rng( -0.3f, 0.3f );
-		PerlinNoise pNoise;
+
+		// grass mask for the whole map in one pass, rather than a noise call per placement attempt - offset by half
+			// a pixel so the samples land on the integer picks
+		Image_1F grassMask( w, h );
+		batchNoise::config_t grassNoise;
+		grassNoise.fractal = batchNoise::NONE;
+		grassNoise.frequency = 1.0f / 2000.0f;
+		grassNoise.offset = vec2( -0.5f );
+		batchNoise::Fill( grassMask, grassNoise );
 
 		palette::PaletteIndex = ChorizoConfig.grassPaletteID;
 		for ( int i = 0; i < 5000000; i++ ) {
@@ -255,7 +271,7 @@ public:
 				cout << "\radding grass " << i + 1 << " / 5000000";
 			}
 			const vec2 pick = vec2( x(), y() );
-			const float noiseValue = pNoise.noise( pick.x / 2000.0f, pick.y / 2000.0f, 0.0f );
+			const float noiseValue = grassMask.GetAtXY( uint32_t( pick.x ), uint32_t( pick.y ) )[ red ];
 			// if ( ( reject() ) > noiseValue ) {
 			if ( 0.5f > noiseValue ) {
 				vec3 normal = p.GetSurfaceNormal( uint( pick.x ), uint( pick.y ) );
@@ -341,6 +357,7 @@ public:
 	void PrepSSBOs () {
 
 		regenTree();
+		ChorizoConfig.geometryManager.Pack();
 
 		ChorizoConfig.numPrimitives = ChorizoConfig.geometryManager.count;
 		cout << newline << "Created " << ChorizoConfig.numPrimitives << " primitives" << newline;
@@ -354,18 +371,30 @@ public:
 		// shape parameterization buffer
 		glGenBuffers( 1, &ChorizoConfig.shapeParametersBuffer );
 		glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.shapeParametersBuffer );
-		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( vec4 ) * ChorizoConfig.numPrimitives * 4, ( GLvoid * ) ChorizoConfig.geometryManager.parametersList.data(), GL_DYNAMIC_COPY );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::packedPrimitive_t ) * ChorizoConfig.numPrimitives, ( GLvoid * ) ChorizoConfig.geometryManager.primitives.primitives.data(), GL_DYNAMIC_COPY );
 		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 1, ChorizoConfig.shapeParametersBuffer );
 
+		// per-cluster quantization bounds for the packed primitives
+		glGenBuffers( 1, &ChorizoConfig.shapeClustersBuffer );
+		glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.shapeClustersBuffer );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::clusterHeader_t ) * ChorizoConfig.geometryManager.primitives.clusters.size(), ( GLvoid * ) ChorizoConfig.geometryManager.primitives.clusters.data(), GL_DYNAMIC_COPY );
+		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 4, ChorizoConfig.shapeClustersBuffer );
+
 		ChorizoConfig.numPointSprites = ChorizoConfig.geometryManager.countPointSprite;
 		cout << newline << "Created " << ChorizoConfig.numPointSprites << " point sprites" << newline;
 
 		// point sprite spheres, separate from the bounding box impostors
 		glGenBuffers( 1, &ChorizoConfig.pointSpriteParametersBuffer );
 		glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.pointSpriteParametersBuffer );
-		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( vec4 ) * ChorizoConfig.numPointSprites * 4, ( GLvoid * ) ChorizoConfig.geometryManager.pointSpriteParametersList.data(), GL_DYNAMIC_COPY );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::packedPrimitive_t ) * ChorizoConfig.numPointSprites, ( GLvoid * ) ChorizoConfig.geometryManager.pointSprites.primitives.data(), GL_DYNAMIC_COPY );
 		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 2, ChorizoConfig.pointSpriteParametersBuffer );
 
+		// per-cluster quantization bounds for the packed point sprites
+		glGenBuffers( 1, &ChorizoConfig.pointSpriteClustersBuffer );
+		glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.pointSpriteClustersBuffer );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::clusterHeader_t ) * ChorizoConfig.geometryManager.pointSprites.clusters.size(), ( GLvoid * ) ChorizoConfig.geometryManager.pointSprites.clusters.data(), GL_DYNAMIC_COPY );
+		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 5, ChorizoConfig.pointSpriteClustersBuffer );
+
 		// setup the SSBO, with the initial data
 		ChorizoConfig.numLights = ChorizoConfig.lights.size() / 2;
 		glGenBuffers( 1, &ChorizoConfig.lightsBuffer );
@@ -404,7 +433,7 @@ public:
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		// // current state of the whole keyboard
 		const uint8_t * state = SDL_GetKeyboardState( NULL );
@@ -421,18 +450,29 @@ public:
 			ChorizoConfig.geometryManager.ClearLists();
 			ChorizoConfig.lights.clear();
 			regenTree();
+			ChorizoConfig.geometryManager.Pack();
 
 			ChorizoConfig.numPrimitives = ChorizoConfig.geometryManager.count;
 			glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.shapeParametersBuffer );
-			glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( vec4 ) * ChorizoConfig.numPrimitives * 4, ( GLvoid * ) ChorizoConfig.geometryManager.parametersList.data(), GL_DYNAMIC_COPY );
+			glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::packedPrimitive_t ) * ChorizoConfig.numPrimitives, ( GLvoid * ) ChorizoConfig.geometryManager.primitives.primitives.data(), GL_DYNAMIC_COPY );
 			glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 1, ChorizoConfig.shapeParametersBuffer );
 
+			// per-cluster quantization bounds for the packed primitives
+			glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.shapeClustersBuffer );
+			glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::clusterHeader_t ) * ChorizoConfig.geometryManager.primitives.clusters.size(), ( GLvoid * ) ChorizoConfig.geometryManager.primitives.clusters.data(), GL_DYNAMIC_COPY );
+			glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 4, ChorizoConfig.shapeClustersBuffer );
+
 			// point sprite spheres, separate from the bounding box impostors
 			ChorizoConfig.numPointSprites = ChorizoConfig.geometryManager.countPointSprite;
 			glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.pointSpriteParametersBuffer );
-			glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( vec4 ) * ChorizoConfig.numPointSprites * 4, ( GLvoid * ) ChorizoConfig.geometryManager.pointSpriteParametersList.data(), GL_DYNAMIC_COPY );
+			glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::packedPrimitive_t ) * ChorizoConfig.numPointSprites, ( GLvoid * ) ChorizoConfig.geometryManager.pointSprites.primitives.data(), GL_DYNAMIC_COPY );
 			glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 2, ChorizoConfig.pointSpriteParametersBuffer );
 
+			// per-cluster quantization bounds for the packed point sprites
+			glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.pointSpriteClustersBuffer );
+			glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::clusterHeader_t ) * ChorizoConfig.geometryManager.pointSprites.clusters.size(), ( GLvoid * ) ChorizoConfig.geometryManager.pointSprites.clusters.data(), GL_DYNAMIC_COPY );
+			glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 5, ChorizoConfig.pointSpriteClustersBuffer );
+
 			ChorizoConfig.numLights = ChorizoConfig.lights.size() / 2;
 			glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.lightsBuffer );
 			glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( vec4 ) * ChorizoConfig.numLights * 2, ( GLvoid * ) ChorizoConfig.lights.data(), GL_DYNAMIC_COPY );
@@ -726,10 +766,10 @@ public:
 	}
 
 	void DrawAPIGeometry () {
-		// ZoneScoped; scopedTimer Start( "API Geometry" );
+		// ZoneScoped; SCOPED_TIMER( "API Geometry" );
 
 
-		{	ZoneScoped; scopedTimer Start( "Bounding Box Compute" );
+		{	ZoneScoped; SCOPED_TIMER( "Bounding Box Compute" );
 			// prepare the bounding boxes
 			GLuint shader = shaders[ "Bounds" ];
 			glUseProgram( shader );
@@ -738,7 +778,7 @@ public:
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 		}
 
-		{	ZoneScoped; scopedTimer Start( "Bounding Box Impostors" );
+		{	ZoneScoped; SCOPED_TIMER( "Bounding Box Impostors" );
 			// then draw, using the prepared data
 			RasterGeoDataSetup();
 			glBindFramebuffer( GL_FRAMEBUFFER, ChorizoConfig.primaryFramebuffer[ ( ChorizoConfig.frameCount++ % 2 ) ] );
@@ -748,7 +788,7 @@ public:
 		}
 
 		// draw the point sprites, as well
-		{	ZoneScoped; scopedTimer Start( "Point Sprite Impostors" );
+		{	ZoneScoped; SCOPED_TIMER( "Point Sprite Impostors" );
 			RasterGeoDataSetupPointSprite();
 			glDrawArrays( GL_POINTS, 0, ChorizoConfig.numPointSprites );
 		}
@@ -783,7 +823,7 @@ public:
 		ZoneScoped;
 
 		{ // doing the deferred processing from rasterizer results to rendered result
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			const GLuint shader = shaders[ "Draw" ];
 			glUseProgram( shader );
 
@@ -822,7 +862,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -831,7 +871,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -839,7 +879,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 		const GLuint shader = shaders[ "Animate" ];
 		glUseProgram( shader );
 		glUniform1f( glGetUniformLocation( shader, "time" ), SDL_GetTicks() / 3000.0f );
@@ -855,7 +895,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -4,11 +4,12 @@ layout( local_size_x = 64, local_size_y = 1, local_size_z = 1 ) in;
 // ===================================================================================================
 // input to the bounds stage
 // ===================================================================================================
-struct parameters_t {
-	float data[ 16 ];
-};
+#include "primitiveCodec.glsl.h"
 layout( binding = 1, std430 ) buffer parametersBuffer {
-	parameters_t parametersList[];
+	uvec4 parametersList[];
+};
+layout( binding = 4, std430 ) buffer parametersClusterBuffer {
+	clusterHeader_t parametersClusters[];
 };
 // ===================================================================================================
 uniform float time;
@@ -17,7 +18,7 @@ void main () {
 
 	// getting this object's parameters
 	uint index = gl_GlobalInvocationID.x;
-	parameters_t parameters = parametersList[ index ];
+	parameters_t parameters = DecodePrimitive( parametersList[ index ], parametersClusters[ index / primitiveClusterSize ] );
 
 	// wiggle it around - this is very half assed, but definite proof of concept here
 	// parameters.data[ 1 ] += 0.001f * sin( time );
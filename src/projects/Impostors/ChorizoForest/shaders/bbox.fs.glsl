@@ -14,11 +14,12 @@ uniform float numPrimitives;
 // ===================================================================================================
 uniform mat4 viewTransform;
 // ===================================================================================================
-struct parameters_t {
-	float data[ 16 ];
-};
+#include "primitiveCodec.glsl.h"
 layout( binding = 1, std430 ) buffer parametersBuffer {
-	parameters_t parametersList[];
+	uvec4 parametersList[];
+};
+layout( binding = 4, std430 ) buffer parametersClusterBuffer {
+	clusterHeader_t parametersClusters[];
 };
 
 // TAA resources:
@@ -43,7 +44,7 @@ void main() {
 
 	float result = MAX_DIST_CP;
 	vec3 normal = vec3( 0.0f );
-	parameters_t parameters = parametersList[ vofiIndex ];
+	parameters_t parameters = DecodePrimitive( parametersList[ vofiIndex ], parametersClusters[ vofiIndex / primitiveClusterSize ] );
 	const int primitiveType = int( parameters.data[ 0 ] );
 
 	#define SPHERE 0
@@ -16,11 +16,12 @@ uniform float numPrimitives;
 uniform mat4 viewTransform;
 uniform mat4 invViewTransform;
 // ===================================================================================================
-struct parameters_t {
-	float data[ 16 ];
-};
+#include "primitiveCodec.glsl.h"
 layout( binding = 2, std430 ) buffer parametersBuffer {
-	parameters_t parameters[];
+	uvec4 parameters[];
+};
+layout( binding = 5, std430 ) buffer parametersClusterBuffer {
+	clusterHeader_t parametersClusters[];
 };
 
 // out float gl_FragDepth;
@@ -28,8 +29,9 @@ layout( location = 0 ) out vec4 normalResult;
 layout( location = 1 ) out uvec4 primitiveID;
 
 void main() {
-	vec4 position = vec4( parameters[ vofiIndex ].data[ 1 ], parameters[ vofiIndex ].data[ 2 ], parameters[ vofiIndex ].data[ 3 ], 1.0f );
-	const float radius = parameters[ vofiIndex ].data[ 4 ];
+	const parameters_t sprite = DecodePrimitive( parameters[ vofiIndex ], parametersClusters[ vofiIndex / primitiveClusterSize ] );
+	vec4 position = vec4( sprite.data[ 1 ], sprite.data[ 2 ], sprite.data[ 3 ], 1.0f );
+	const float radius = sprite.data[ 4 ];
 
 	// https://stackoverflow.com/questions/25780145/gl-pointsize-corresponding-to-world-space-size
 	vec2 coord = ( gl_FragCoord.xy - center ) / radiusPixels;
@@ -19,6 +19,8 @@ struct ChorizoConfig_t {
 	GLuint shapeParametersBuffer;
 	GLuint boundsTransformBuffer;
 	GLuint pointSpriteParametersBuffer;
+	GLuint shapeClustersBuffer;
+	GLuint pointSpriteClustersBuffer;
 	GLuint lightsBuffer;
 	GLuint primaryFramebuffer[ 2 ];
 
@@ -151,6 +153,12 @@ public:
 			AddLights();
 			PrepSSBOs();
 
+			// == Packed Primitive Encoding Report ===================================================
+			primitiveCodec::AddReportCommand( terminal, {
+				{ "Bounding Box Impostors", &ChorizoConfig.geometryManager.primitivesReport },
+				{ "Point Sprite Impostors", &ChorizoConfig.geometryManager.pointSpritesReport }
+			} );
+
 			// == Render Framebuffer(s) ===========
 			textureOptions_t opts;
 			// ==== Depth =========================
@@ -354,6 +362,7 @@ public:
 	void PrepSSBOs () {
 		static bool firstTime = true;
 		
+		ChorizoConfig.geometryManager.Pack();
 		ChorizoConfig.numPrimitives = ChorizoConfig.geometryManager.count;
 		// cout << newline << "Created " << ChorizoConfig.numPrimitives << " primitives" << newline;
 
@@ -370,9 +379,17 @@ public:
 			glGenBuffers( 1, &ChorizoConfig.shapeParametersBuffer );
 		}
 		glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.shapeParametersBuffer );
-		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( vec4 ) * ChorizoConfig.numPrimitives * 4, ( GLvoid * ) ChorizoConfig.geometryManager.parametersList.data(), GL_DYNAMIC_COPY );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::packedPrimitive_t ) * ChorizoConfig.numPrimitives, ( GLvoid * ) ChorizoConfig.geometryManager.primitives.primitives.data(), GL_DYNAMIC_COPY );
 		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 1, ChorizoConfig.shapeParametersBuffer );
 
+		// per-cluster quantization bounds for the packed primitives
+		if ( firstTime ) {
+			glGenBuffers( 1, &ChorizoConfig.shapeClustersBuffer );
+		}
+		glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.shapeClustersBuffer );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::clusterHeader_t ) * ChorizoConfig.geometryManager.primitives.clusters.size(), ( GLvoid * ) ChorizoConfig.geometryManager.primitives.clusters.data(), GL_DYNAMIC_COPY );
+		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 4, ChorizoConfig.shapeClustersBuffer );
+
 		ChorizoConfig.numPointSprites = ChorizoConfig.geometryManager.countPointSprite;
 		// cout << newline << "Created " << ChorizoConfig.numPointSprites << " point sprites" << newline;
 
@@ -381,9 +398,17 @@ public:
 			glGenBuffers( 1, &ChorizoConfig.pointSpriteParametersBuffer );
 		}
 		glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.pointSpriteParametersBuffer );
-		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( vec4 ) * ChorizoConfig.numPointSprites * 4, ( GLvoid * ) ChorizoConfig.geometryManager.pointSpriteParametersList.data(), GL_DYNAMIC_COPY );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::packedPrimitive_t ) * ChorizoConfig.numPointSprites, ( GLvoid * ) ChorizoConfig.geometryManager.pointSprites.primitives.data(), GL_DYNAMIC_COPY );
 		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 2, ChorizoConfig.pointSpriteParametersBuffer );
 
+		// per-cluster quantization bounds for the packed point sprites
+		if ( firstTime ) {
+			glGenBuffers( 1, &ChorizoConfig.pointSpriteClustersBuffer );
+		}
+		glBindBuffer( GL_SHADER_STORAGE_BUFFER, ChorizoConfig.pointSpriteClustersBuffer );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( primitiveCodec::clusterHeader_t ) * ChorizoConfig.geometryManager.pointSprites.clusters.size(), ( GLvoid * ) ChorizoConfig.geometryManager.pointSprites.clusters.data(), GL_DYNAMIC_COPY );
+		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 5, ChorizoConfig.pointSpriteClustersBuffer );
+
 		// setup the SSBO, with the initial data
 		ChorizoConfig.numLights = ChorizoConfig.lights.size() / 2;
 		if ( firstTime ) {
@@ -426,7 +451,7 @@ public:
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		// // current state of the whole keyboard
 		const uint8_t * state = SDL_GetKeyboardState( NULL );
@@ -766,9 +791,9 @@ public:
 	}
 
 	void DrawAPIGeometry () {
-		// ZoneScoped; scopedTimer Start( "API Geometry" );
+		// ZoneScoped; SCOPED_TIMER( "API Geometry" );
 
-		{	ZoneScoped; scopedTimer Start( "Bounding Box Compute" );
+		{	ZoneScoped; SCOPED_TIMER( "Bounding Box Compute" );
 			// prepare the bounding boxes
 			GLuint shader = shaders[ "Bounds" ];
 			glUseProgram( shader );
@@ -777,7 +802,7 @@ public:
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 		}
 
-		{	ZoneScoped; scopedTimer Start( "Bounding Box Impostors" );
+		{	ZoneScoped; SCOPED_TIMER( "Bounding Box Impostors" );
 			// then draw, using the prepared data
 			RasterGeoDataSetup();
 			glBindFramebuffer( GL_FRAMEBUFFER, ChorizoConfig.primaryFramebuffer[ ( ChorizoConfig.frameCount++ % 2 ) ] );
@@ -787,7 +812,7 @@ public:
 		}
 
 		// draw the point sprites, as well
-		{	ZoneScoped; scopedTimer Start( "Point Sprite Impostors" );
+		{	ZoneScoped; SCOPED_TIMER( "Point Sprite Impostors" );
 			RasterGeoDataSetupPointSprite();
 			glDrawArrays( GL_POINTS, 0, ChorizoConfig.numPointSprites );
 		}
@@ -822,7 +847,7 @@ public:
 		ZoneScoped;
 
 		{ // doing the deferred processing from rasterizer results to rendered result
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			const GLuint shader = shaders[ "Draw" ];
 			glUseProgram( shader );
 
@@ -861,7 +886,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -870,7 +895,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -878,7 +903,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 		// const GLuint shader = shaders[ "Animate" ];
 		// glUseProgram( shader );
 		// glUniform1f( glGetUniformLocation( shader, "time" ), SDL_GetTicks() / 3000.0f );
@@ -900,7 +925,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -1,4 +1,5 @@
 #include "../../../engine/includes.h"
+#include "../../../utils/primitiveCodec/primitiveCodec.h"
 
 struct geometryManager_t {
 	// 0..1 within the palette, with an integer palette select
@@ -12,7 +13,7 @@ struct geometryManager_t {
 	std::vector< float > pointSpriteParametersList;
 	int countPointSprite = 0;
 
-	void ClearLists() { count = 0; parametersList.clear(); countPointSprite = 0; pointSpriteParametersList.clear(); }
+	void ClearLists() { count = 0; parametersList.clear(); countPointSprite = 0; pointSpriteParametersList.clear(); primitives = {}; pointSprites = {}; }
 	void PreallocateLists( size_t count ) { parametersList.reserve( count ); pointSpriteParametersList.reserve( count ); }
 
 	void AddPointSprite( const float parameters[ 16 ] );
@@ -22,8 +23,29 @@ struct geometryManager_t {
 	void AddPrimitive( const float parameters[ 16 ] );
 	void AddCapsule( const vec3 pointA, const vec3 pointB, const float radius, const vec3 color );
 	void AddRoundedBox( const vec3 centerPoint, const vec3 scaleFactors, const vec2 eulerAngles, const float roundingFactor, const vec3 color );
+
+	// packed 16 byte encoding of the lists above, quantized against per-cluster bounds ( see primitiveCodec.h ) - this is
+		// what gets uploaded, Pack() encodes the float lists and then releases them, they're only staging for the Add*() calls
+	primitiveCodec::compressedList_t primitives;
+	primitiveCodec::compressedList_t pointSprites;
+	primitiveCodec::roundTripReport_t primitivesReport;
+	primitiveCodec::roundTripReport_t pointSpritesReport;
+	void Pack();
 };
 
+void geometryManager_t::Pack() {
+	auto PackList = [] ( std::vector< float > &list, primitiveCodec::compressedList_t &packed, primitiveCodec::roundTripReport_t &report ) {
+		const auto tStart = std::chrono::system_clock::now();
+		packed = primitiveCodec::Encode( list );
+		const float encodeMs = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::system_clock::now() - tStart ).count() / 1000.0f;
+		report = primitiveCodec::RoundTrip( list, packed );
+		report.encodeMs = encodeMs;
+		std::vector< float >().swap( list );
+	};
+	PackList( parametersList, primitives, primitivesReport );
+	PackList( pointSpriteParametersList, pointSprites, pointSpritesReport );
+}
+
 // Point sprites are faster - but distort, under perspective projection - use bounding box spheres, when correctness counts. Point sprites as filler...
 #define SPHERE		0
 #define CAPSULE		1
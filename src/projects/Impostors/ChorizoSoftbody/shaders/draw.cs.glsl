@@ -94,18 +94,19 @@ float SpiralAO ( vec2 uv, vec3 p, vec3 n, float rad ) {
 }
 
 // ===================================================================================================
-struct parameters_t {
-	float data[ 16 ];
-};
+#include "primitiveCodec.glsl.h"
 layout( binding = 1, std430 ) buffer parametersBuffer {
-	parameters_t parametersList[];
+	uvec4 parametersList[];
 };
-// ===================================================================================================
-struct pointSpriteParameters_t {
-	float data[ 16 ];
+layout( binding = 4, std430 ) buffer parametersClusterBuffer {
+	clusterHeader_t parametersClusters[];
 };
+// ===================================================================================================
 layout( binding = 2, std430 ) buffer pointSpriteParametersBuffer {
-	pointSpriteParameters_t pointSpriteParameters[];
+	uvec4 pointSpriteParameters[];
+};
+layout( binding = 5, std430 ) buffer pointSpriteClusterBuffer {
+	clusterHeader_t pointSpriteClusters[];
 };
 // ===================================================================================================
 uniform int numLights;
@@ -148,7 +149,7 @@ void main () {
 	if ( idSample.x != 0 ) { // these are texels which wrote out a fragment during the raster geo pass, bounding box impostors
 
 		drawing = true;
-		const parameters_t parameters = parametersList[ idSample.x - 1 ];
+		const parameters_t parameters = DecodePrimitive( parametersList[ idSample.x - 1 ], parametersClusters[ ( idSample.x - 1 ) / primitiveClusterSize ] );
 		// roughness = abs( parameters.data[ 15 ] );
 
 		if ( parameters.data[ 15 ] < 0.0f ) { // using the color out of the buffer
@@ -160,7 +161,7 @@ void main () {
 	} else if ( idSample.y != 0 ) { // using the second channel to signal
 
 		drawing = true;
-		pointSpriteParameters_t parameters = pointSpriteParameters[ idSample.y - 1 ];
+		parameters_t parameters = DecodePrimitive( pointSpriteParameters[ idSample.y - 1 ], pointSpriteClusters[ ( idSample.y - 1 ) / primitiveClusterSize ] );
 
 		emissive = ( parameters.data[ 4 ] != parameters.data[ 5 ] );
 		knownRadius = parameters.data[ 4 ];
@@ -25,11 +25,28 @@ public:
 			data.textureManager_local = &textureManager;
 			data.Reset();
 
+			terminal.addCommand( { "assemblyBenchmark" }, {
+					{ "triangles", INT, "Number of triangles, in thousands." },
+					{ "textures", INT, "Number of 2048x2048 array texture layers." }
+				}, [=] ( args_t args ) {
+					const std::vector< triangle > triangles = meshAssembly::GridTriangles( uint32_t( std::clamp( int( args[ "triangles" ].data.x ), 1, 10000 ) ) * 1000 );
+					const std::vector< Image_4U > images( std::clamp( int( args[ "textures" ].data.x ), 0, 64 ), Image_4U( 2048, 2048 ) );
+					const meshAssembly::benchmarkResult_t result = meshAssembly::Benchmark( triangles, images );
+					terminal.addLineBreak();
+					terminal.addHistoryLine( terminal.csb.append( "Mesh Assembly Benchmark ", 3 ).append( "[ " + GetWithThousandsSeparator( result.numTriangles ) + " triangles, " + to_string( result.numLayers ) + " layers, " + to_string( result.numThreads ) + " threads ]", GREY_DD ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  push_back vertices: " + to_string( result.legacyVertexMs ) + "ms, " + GetWithThousandsSeparator( result.legacyVertexBytes ) + " bytes" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  indexed full: " + to_string( result.fullMs ) + "ms, " + GetWithThousandsSeparator( result.fullBytes ) + " bytes" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  indexed quantized: " + to_string( result.quantizedMs ) + "ms, " + GetWithThousandsSeparator( result.quantizedBytes ) + " bytes" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  " + GetWithThousandsSeparator( result.uniqueVertices ) + " unique vertices, max direction error " + to_string( result.maxDirectionError ) + ", " + to_string( result.zeroDirections ) + " zero length", GREY_DD ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  push_back texture bytes: " + to_string( result.legacyTextureMs ) + "ms, layer copies: " + to_string( result.packMs ) + "ms" ).flush() );
+					terminal.addLineBreak();
+				}, "Time the indexed, interleaved mesh assembly and array texture packing against the old push_back loops." );
+
 		}
 	}
 
 	void HandleCustomEvents () {
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 		// application specific controls
 
 		const uint8_t *state = SDL_GetKeyboardState( NULL );
@@ -64,7 +81,7 @@ public:
 	}
 
 	void DrawAPIGeometry () {
-		ZoneScoped; scopedTimer Start( "API Geometry" );
+		ZoneScoped; SCOPED_TIMER( "API Geometry" );
 
 		// is there a way to jitter the subpixel samples easily? blending/reprojection - resolve more static spheres over several frames
 			// using the analytic model from the nvidia paper? would maybe be faster, too? tbd
@@ -85,7 +102,7 @@ public:
 		ZoneScoped;
 
 		// { // dummy draw - draw something into accumulatorTexture
-		// 	scopedTimer Start( "Background" );
+		// 	SCOPED_TIMER( "Background" );
 		// 	bindSets[ "Drawing" ].apply();
 		// 	glUseProgram( data.resources.shaders[ "Background" ] );
 		// 	glDispatchCompute( ( config.width + 15 ) / 16, ( config.height + 15 ) / 16, 1 );
@@ -94,13 +111,13 @@ public:
 
 		// todo: do the deferred update here
 		{	// I think this should go pretty smoothly once I have the Gbuffer
-			scopedTimer Start( "Deferred Pass" );
+			SCOPED_TIMER( "Deferred Pass" );
 			bindSets[ "Drawing" ].apply();
 			data.DeferredPass();
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -109,7 +126,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			if ( data.config.showTiming ) {
 				textRenderer.Update( ImGui::GetIO().DeltaTime );
 				textRenderer.Draw( textureManager.Get( "Display Texture" ) );
@@ -118,7 +135,7 @@ public:
 		}
 
 		{ // show trident with current orientation
-			scopedTimer Start( "Trident" );
+			SCOPED_TIMER( "Trident" );
 			if ( data.config.showTrident ) {
 				trident.Update( textureManager.Get( "Display Texture" ) );
 				glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -127,7 +144,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		// main view transform
 		data.config.basisX = trident.basisX;
@@ -145,7 +162,7 @@ public:
 		ComputePasses();			// draw the 
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -74,6 +74,7 @@ struct openGLResources {
 	int numPointsStaticSpheres = 0;
 	int numPointsDynamicSpheres = 0;
 	int sponzaNumTriangles = 0;
+	int sponzaNumIndices = 0;
 
 	// separate tridents for each shadowmap
 	// textures for each shadowmap
@@ -280,12 +281,11 @@ void APIGeometryContainer::Initialize () {
 			// comes from https://github.com/0xBAMA/SponzaRepack - expect it in the same directory as jbDE
 			s.LoadModel( "../SponzaRepack/sponza.obj", "../SponzaRepack/" );
 
-			// vertex data
-			std::vector<vec3> positions;
-			std::vector<vec3> texCoords;
-			std::vector<vec3> normals;
-			std::vector<vec3> tangents;
-			std::vector<vec3> bitangents;
+			// vertex data - interleaved, deduplicated, and indexed, with the directions quantized to 10:10:10:2
+			using sponzaVertex_t = meshAssembly::vertexQuantized_t;
+			const meshAssembly::mesh_t< sponzaVertex_t > mesh = meshAssembly::Assemble< sponzaVertex_t >( s.triangles );
+			resources.sponzaNumTriangles = s.triangles.size();
+			resources.sponzaNumIndices = mesh.indices.size();
 
 			// vec3 maxPosition = vec3( -10000000.0f );
 			// vec3 minPosition = vec3(  10000000.0f );
@@ -303,46 +303,16 @@ void APIGeometryContainer::Initialize () {
 			// cout << "   Bounding box is from " << minPosition.x << " " << minPosition.y << " " << minPosition.z << endl;
 			// cout << "                     to " << maxPosition.x << " " << maxPosition.y << " " << maxPosition.z << endl;
 
-			for ( auto& triangle : s.triangles ) {
-				positions.push_back( triangle.p0 );
-				positions.push_back( triangle.p1 );
-				positions.push_back( triangle.p2 );
-
-				texCoords.push_back( triangle.t0 );
-				texCoords.push_back( triangle.t1 );
-				texCoords.push_back( triangle.t2 );
-
-				normals.push_back( triangle.n0 );
-				normals.push_back( triangle.n1 );
-				normals.push_back( triangle.n2 );
-
-				// basis for normal mapping
-				tangents.push_back( triangle.t );
-				tangents.push_back( triangle.t );
-				tangents.push_back( triangle.t );
-
-				bitangents.push_back( triangle.b );
-				bitangents.push_back( triangle.b );
-				bitangents.push_back( triangle.b );
-
-				resources.sponzaNumTriangles++;
-			}
-
 			// prep the patient
 			glUseProgram( resources.shaders[ "Sponza" ] );
 
-			// send the data, set up the vertex attributes
-			uintptr_t numBytesPositions = positions.size() * sizeof( glm::vec3 );
-			uintptr_t numBytesTexCoords = texCoords.size() * sizeof( glm::vec3 );
-			uintptr_t numBytesNormals = normals.size() * sizeof( glm::vec3 );
-			uintptr_t numBytesTangents = tangents.size() * sizeof( glm::vec3 );
-			uintptr_t numBytesBitangents = bitangents.size() * sizeof( glm::vec3 );
-			size_t totalBytes = numBytesPositions + numBytesTexCoords + numBytesNormals + numBytesTangents + numBytesBitangents;
-
-			cout << endl << "   total size of Sponza vertex data: " << float( totalBytes ) / float( 1u << 20 ) << "MB ( " << totalBytes << " bytes )" << endl << endl;
+			const size_t totalBytes = mesh.VertexBytes() + mesh.IndexBytes();
+			const size_t soupBytes = s.triangles.size() * 3 * 5 * sizeof( glm::vec3 );
+			cout << endl << "   total size of Sponza vertex data: " << float( totalBytes ) / float( 1u << 20 ) << "MB ( " << totalBytes << " bytes, "
+				<< mesh.vertices.size() << " vertices for " << mesh.indices.size() << " indices, " << float( soupBytes ) / float( totalBytes ) << "x smaller than unindexed )" << endl << endl;
 
 		// send to the GPU
-			GLuint sponzaVAO, sponzaVBO;
+			GLuint sponzaVAO, sponzaVBO, sponzaEBO;
 
 			// VAO
 			glGenVertexArrays( 1, &sponzaVAO );
@@ -353,69 +323,61 @@ void APIGeometryContainer::Initialize () {
 			glGenBuffers( 1, &sponzaVBO );
 			glBindBuffer( GL_ARRAY_BUFFER, sponzaVBO );
 			resources.VBOs[ "Sponza" ] = sponzaVBO;
+			glBufferData( GL_ARRAY_BUFFER, mesh.VertexBytes(), mesh.vertices.data(), GL_STATIC_DRAW );
 
-			glBufferData( GL_ARRAY_BUFFER, numBytesPositions + numBytesTexCoords + numBytesNormals + numBytesTangents + numBytesBitangents, NULL, GL_DYNAMIC_DRAW );
-			uint bufferBase = 0;
-			glBufferSubData( GL_ARRAY_BUFFER, bufferBase, numBytesPositions, &positions[ 0 ] );
-			bufferBase += numBytesPositions;
-			glBufferSubData( GL_ARRAY_BUFFER, bufferBase, numBytesTexCoords, &texCoords[ 0 ] );
-			bufferBase += numBytesTexCoords;
-			glBufferSubData( GL_ARRAY_BUFFER, bufferBase, numBytesNormals, &normals[ 0 ] );
-			bufferBase += numBytesNormals;
-			glBufferSubData( GL_ARRAY_BUFFER, bufferBase, numBytesTangents, &tangents[ 0 ] );
-			bufferBase += numBytesTangents;
-			glBufferSubData( GL_ARRAY_BUFFER, bufferBase, numBytesBitangents, &bitangents[ 0 ] );
+			// index buffer binding is VAO state, so this stays attached to the Sponza VAO
+			glGenBuffers( 1, &sponzaEBO );
+			glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, sponzaEBO );
+			resources.VBOs[ "Sponza Indices" ] = sponzaEBO;
+			glBufferData( GL_ELEMENT_ARRAY_BUFFER, mesh.IndexBytes(), mesh.indices.data(), GL_STATIC_DRAW );
 
 		// set up the pointers to the vertex data... layout qualifiers on sponza.vs.glsl seem to be the easiest way to get this to go through
-			{
-				const GLvoid * base = ( GLvoid * ) 0;
-				glEnableVertexAttribArray( 0 );
-				glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, 0, base );
-			}
-			{
-				const GLvoid * base = ( GLvoid * ) numBytesPositions;
-				glEnableVertexAttribArray( 1 );
-				glVertexAttribPointer( 1, 3, GL_FLOAT, GL_FALSE, 0, base );
-			}
-			{
-				const GLvoid * base = ( GLvoid * ) ( numBytesPositions + numBytesTexCoords );
-				glEnableVertexAttribArray( 2 );
-				glVertexAttribPointer( 2, 3, GL_FLOAT, GL_FALSE, 0, base );
-			}
-			{
-				const GLvoid * base = ( GLvoid * ) ( numBytesPositions + numBytesTexCoords + numBytesNormals );
-				glEnableVertexAttribArray( 3 );
-				glVertexAttribPointer( 3, 3, GL_FLOAT, GL_FALSE, 0, base );
-			}
-			{
-				const GLvoid * base = ( GLvoid * ) ( numBytesPositions + numBytesTexCoords + numBytesNormals + numBytesTangents );
-				glEnableVertexAttribArray( 4 );
-				glVertexAttribPointer( 4, 3, GL_FLOAT, GL_FALSE, 0, base );
-			}
-
-		// the array texture
-
-			// linearize the data - all textures are 2048 by 2048
-			std::vector< uint8_t > arrayTextureData;
-			for ( uint32_t i = 0; i < s.texSet.size(); i++ ) {
-				for ( uint32_t o = 0; o < s.texSet[ i ].Height() * s.texSet[ i ].Width() * 4; o++ ) {
-					arrayTextureData.push_back( s.texSet[ i ].GetImageDataBasePtr()[ o ] );
-				}
-			}
-
-			// pass it as one big, fat array
+			const GLsizei stride = sizeof( sponzaVertex_t );
+			glEnableVertexAttribArray( 0 );
+			glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, stride, ( GLvoid * ) offsetof( sponzaVertex_t, position ) );
+			glEnableVertexAttribArray( 1 );
+			glVertexAttribPointer( 1, 3, GL_FLOAT, GL_FALSE, stride, ( GLvoid * ) offsetof( sponzaVertex_t, texCoord ) );
+			// packed directions come in normalized, the shader still sees a vec3
+			glEnableVertexAttribArray( 2 );
+			glVertexAttribPointer( 2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, ( GLvoid * ) offsetof( sponzaVertex_t, normal ) );
+			glEnableVertexAttribArray( 3 );
+			glVertexAttribPointer( 3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, ( GLvoid * ) offsetof( sponzaVertex_t, tangent ) );
+			glEnableVertexAttribArray( 4 );
+			glVertexAttribPointer( 4, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, ( GLvoid * ) offsetof( sponzaVertex_t, bitangent ) );
+
+		// the array texture - all textures are 2048 by 2048, each layer is uploaded straight out of the loaded image
+			const meshAssembly::arrayTextureLayout_t layout = meshAssembly::ArrayLayout( s.texSet );
 			textureOptions_t opts;
-			opts.width = s.texSet[ 0 ].Width();
-			opts.height = s.texSet[ 0 ].Height();
-			opts.depth = s.texSet.size();
+			opts.width = layout.width;
+			opts.height = layout.height;
+			opts.depth = layout.layers;
 			opts.textureType = GL_TEXTURE_2D_ARRAY;
 			opts.wrap = GL_REPEAT;
-			opts.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+			opts.minFilter = GL_LINEAR; // no mips yet, they get built after the layers are in
 			opts.magFilter = GL_LINEAR;
 			opts.dataType = GL_RGBA8;
 			opts.pixelDataType = GL_UNSIGNED_BYTE;
-			opts.initialData = ( void * ) &arrayTextureData[ 0 ];
+			opts.initialData = nullptr;
 			textureManager_local->Add( "Sponza Array Texture", opts );
+
+			glBindTexture( GL_TEXTURE_2D_ARRAY, textureManager_local->Get( "Sponza Array Texture" ) );
+			if ( layout.uniform ) {
+				for ( uint32_t i = 0; i < layout.layers; i++ ) {
+					glTexSubImage3D( GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, layout.width, layout.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, s.texSet[ i ].GetImageDataBasePtr() );
+				}
+			} else {
+				// mismatched sizes would read past the end of the smaller images, so they get packed ( and cropped ) first
+				std::vector< uint8_t > arrayTextureData( size_t( layout.layers ) * layout.layerBytes );
+				for ( uint32_t i = 0; i < layout.layers; i++ ) {
+					const size_t rowBytes = size_t( std::min( layout.width, uint32_t( s.texSet[ i ].Width() ) ) ) * 4;
+					for ( uint32_t y = 0; y < std::min( layout.height, uint32_t( s.texSet[ i ].Height() ) ); y++ ) {
+						memcpy( &arrayTextureData[ i * layout.layerBytes + y * layout.width * 4 ], s.texSet[ i ].GetImageDataBasePtr() + y * s.texSet[ i ].Width() * 4, rowBytes );
+					}
+				}
+				glTexSubImage3D( GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, layout.width, layout.height, layout.layers, GL_RGBA, GL_UNSIGNED_BYTE, arrayTextureData.data() );
+			}
+			glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+			glGenerateMipmap( GL_TEXTURE_2D_ARRAY );
 		}
 
 		firstTime = false;
@@ -558,7 +520,8 @@ void APIGeometryContainer::Render () {
 
 	// render to framebuffer, at the specified resolution
 	glViewport( 0, 0, config.framebufferX, config.framebufferY );
-	glDrawArrays( GL_TRIANGLES, 0, 3 * resources.sponzaNumTriangles );
+	glBindVertexArray( resources.VAOs[ "Sponza" ] );
+	glDrawElements( GL_TRIANGLES, resources.sponzaNumIndices, GL_UNSIGNED_INT, 0 );
 
 	// populate the SSBO with the points
 	glUseProgram( resources.shaders[ "Buffer Populate" ] );
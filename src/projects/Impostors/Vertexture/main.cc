@@ -29,7 +29,7 @@ public:
 	}
 
 	void HandleCustomEvents () {
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 		// application specific controls
 
 		const uint8_t *state = SDL_GetKeyboardState( NULL );
@@ -64,7 +64,7 @@ public:
 	}
 
 	void DrawAPIGeometry () {
-		ZoneScoped; scopedTimer Start( "API Geometry" );
+		ZoneScoped; SCOPED_TIMER( "API Geometry" );
 
 		// is there a way to jitter the subpixel samples easily? blending/reprojection - resolve more static spheres over several frames
 			// using the analytic model from the nvidia paper? would maybe be faster, too? tbd
@@ -85,7 +85,7 @@ public:
 		ZoneScoped;
 
 		// { // dummy draw - draw something into accumulatorTexture
-		// 	scopedTimer Start( "Background" );
+		// 	SCOPED_TIMER( "Background" );
 		// 	bindSets[ "Drawing" ].apply();
 		// 	glUseProgram( data.resources.shaders[ "Background" ] );
 		// 	glDispatchCompute( ( config.width + 15 ) / 16, ( config.height + 15 ) / 16, 1 );
@@ -94,13 +94,13 @@ public:
 
 		// todo: do the deferred update here
 		{	// I think this should go pretty smoothly once I have the Gbuffer
-			scopedTimer Start( "Deferred Pass" );
+			SCOPED_TIMER( "Deferred Pass" );
 			bindSets[ "Drawing" ].apply();
 			data.DeferredPass();
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -109,7 +109,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			if ( data.config.showTiming ) {
 				textRenderer.Update( ImGui::GetIO().DeltaTime );
 				textRenderer.Draw( textureManager.Get( "Display Texture" ) );
@@ -118,7 +118,7 @@ public:
 		}
 
 		{ // show trident with current orientation
-			scopedTimer Start( "Trident" );
+			SCOPED_TIMER( "Trident" );
 			if ( data.config.showTrident ) {
 				trident.Update( textureManager.Get( "Display Texture" ) );
 				glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -127,7 +127,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		// main view transform
 		data.config.basisX = trident.basisX;
@@ -145,7 +145,7 @@ public:
 		ComputePasses();			// draw the 
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -0,0 +1,358 @@
+#pragma once
+#ifndef TERRAIN_GRID_H
+#define TERRAIN_GRID_H
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+#include "../../../utils/GLM/glm.hpp"
+#include "../../../engine/coreUtils/parallel.h"
+
+// flat, indexed grid for the displaced ground / water planes - replaces the recursive quad split:
+	//	- the grid is cut into square chunks, and each chunk's vertices are written straight to their final spot, chunks
+	//		spread over threads. No intermediate allocations, every vertex is written exactly once
+	//	- one small index buffer is shared by all chunks, drawn with a base vertex. It holds a template for each LOD
+	//		level, and each combination of coarser neighbors - the edges facing a coarser neighbor snap their odd
+	//		vertices down onto the coarser neighbor's vertices, so there are no cracks at the seams
+	//	- chunks are culled against the view and given a level from their projected size on the CPU, each frame
+
+namespace terrainGrid {
+
+//===== Recursive Reference ===========================================================================================
+// the old recursive quad subdivision, kept around for the benchmark - emits 6 unindexed vertices per leaf quad, and
+	// allocates a temporary vector at every level of the recursion
+inline void SubdivideRecursive (
+	std::vector< glm::vec3 > &pointsVector,
+	const std::vector< glm::vec3 > inputPoints,
+	const float minDisplacement = 0.01f ) {
+
+	if ( glm::distance( inputPoints[ 0 ], inputPoints[ 2 ] ) < minDisplacement ) {
+		// triangle 1 ABC
+		pointsVector.push_back( inputPoints[ 0 ] );
+		pointsVector.push_back( inputPoints[ 1 ] );
+		pointsVector.push_back( inputPoints[ 2 ] );
+		// triangle 2 BCD
+		pointsVector.push_back( inputPoints[ 1 ] );
+		pointsVector.push_back( inputPoints[ 2 ] );
+		pointsVector.push_back( inputPoints[ 3 ] );
+	} else {
+		const glm::vec3 center = ( inputPoints[ 0 ] +  inputPoints[ 1 ] + inputPoints[ 2 ] + inputPoints[ 3 ] ) / 4.0f;
+		// midpoints between corners
+		const glm::vec3 midpoint13 = ( inputPoints[ 1 ] + inputPoints[ 3 ] ) / 2.0f;
+		const glm::vec3 midpoint01 = ( inputPoints[ 0 ] + inputPoints[ 1 ] ) / 2.0f;
+		const glm::vec3 midpoint23 = ( inputPoints[ 2 ] + inputPoints[ 3 ] ) / 2.0f;
+		const glm::vec3 midpoint02 = ( inputPoints[ 0 ] + inputPoints[ 2 ] ) / 2.0f;
+		// recursive calls, next level of subdivision
+		SubdivideRecursive( pointsVector, { midpoint01, inputPoints[ 1 ], center, midpoint13 }, minDisplacement );
+		SubdivideRecursive( pointsVector, { inputPoints[ 0 ], midpoint01, midpoint02, center }, minDisplacement );
+		SubdivideRecursive( pointsVector, { center, midpoint13, midpoint23, inputPoints[ 3 ] }, minDisplacement );
+		SubdivideRecursive( pointsVector, { midpoint02, center, inputPoints[ 2 ], midpoint23 }, minDisplacement );
+	}
+}
+
+// number of leaf quads along one side that SubdivideRecursive would produce - it splits until the quad's edge is
+	// shorter than minDisplacement, so this is always a power of two
+inline uint32_t QuadsPerSide ( const float extent, const float minDisplacement ) {
+	uint32_t quads = 1;
+	float edge = 2.0f * extent;
+	while ( edge >= minDisplacement && quads < ( 1u << 15 ) ) {
+		edge /= 2.0f;
+		quads *= 2;
+	}
+	return quads;
+}
+
+//===== Grid ==========================================================================================================
+struct gridConfig_t {
+	float extent = 1.0f;			// grid covers -extent..extent on x and y
+	float height = 0.0f;			// z of every vertex, displacement happens in the vertex shader
+	float minDisplacement = 0.01f;	// same stopping rule as the recursive version
+	uint32_t chunkQuads = 32;		// quads along a chunk edge, power of two
+	uint32_t lodLevels = 4;			// level l uses every 2^l'th vertex
+};
+
+// bits of the stitch mask, set when the neighbor on that side is drawn one level coarser
+enum stitch_t : uint32_t {
+	STITCH_NEG_X = 1,
+	STITCH_POS_X = 2,
+	STITCH_NEG_Y = 4,
+	STITCH_POS_Y = 8
+};
+
+struct indexRange_t {
+	uint32_t firstIndex = 0;
+	uint32_t count = 0;
+};
+
+// everything needed for one glMultiDrawElementsBaseVertex call
+struct drawList_t {
+	std::vector< int32_t > counts;
+	std::vector< const void * > offsets;	// byte offsets into the index buffer
+	std::vector< int32_t > baseVertices;
+	std::vector< uint8_t > chunkLevels;		// per chunk, after balancing - for debug display
+	uint32_t numTriangles = 0;
+
+	uint32_t Size () const { return uint32_t( counts.size() ); }
+};
+
+struct grid_t {
+	gridConfig_t config;
+	uint32_t quadsPerSide = 0;
+	uint32_t chunksPerSide = 0;
+	uint32_t verticesPerChunkSide = 0;		// chunkQuads + 1, edge vertices are duplicated between chunks
+	uint32_t verticesPerChunk = 0;
+
+	std::vector< glm::vec3 > vertices;		// chunk-major, rows of chunkQuads + 1 within a chunk
+	std::vector< uint32_t > indices;		// chunk-local templates
+	std::vector< indexRange_t > ranges;		// [ level * 16 + stitch mask ]
+
+	size_t VertexBytes () const { return vertices.size() * sizeof( glm::vec3 ); }
+	size_t IndexBytes () const { return indices.size() * sizeof( uint32_t ); }
+	uint32_t NumChunks () const { return chunksPerSide * chunksPerSide; }
+	const indexRange_t &Range ( const uint32_t level, const uint32_t mask ) const { return ranges[ level * 16 + mask ]; }
+
+	// position of a grid point - computed from the integer coordinates, so the copies on either side of a chunk
+		// seam come out bit identical
+	glm::vec3 GridPoint ( const uint32_t gx, const uint32_t gy ) const {
+		const float step = 2.0f * config.extent / float( quadsPerSide );
+		return glm::vec3( -config.extent + step * float( gx ), -config.extent + step * float( gy ), config.height );
+	}
+
+	void Generate ( const gridConfig_t &configIn, uint32_t numThreads = 0 ) {
+		config = configIn;
+		quadsPerSide = QuadsPerSide( config.extent, config.minDisplacement );
+		config.chunkQuads = std::min( std::max( 1u, config.chunkQuads ), quadsPerSide );
+		while ( config.chunkQuads & ( config.chunkQuads - 1 ) ) { // round down to a power of two, so chunks tile the grid
+			config.chunkQuads &= config.chunkQuads - 1;				// and every level's step divides the chunk edge
+		}
+		uint32_t maxLevels = 1;
+		while ( ( 1u << maxLevels ) <= config.chunkQuads ) maxLevels++;
+		config.lodLevels = std::clamp( config.lodLevels, 1u, maxLevels );
+
+		chunksPerSide = quadsPerSide / config.chunkQuads;
+		verticesPerChunkSide = config.chunkQuads + 1;
+		verticesPerChunk = verticesPerChunkSide * verticesPerChunkSide;
+
+		// vertices, a chunk at a time
+		vertices.resize( size_t( NumChunks() ) * verticesPerChunk );
+		parallelForRanges( NumChunks(), [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t chunk = begin; chunk < end; chunk++ ) {
+				const uint32_t baseX = uint32_t( chunk % chunksPerSide ) * config.chunkQuads;
+				const uint32_t baseY = uint32_t( chunk / chunksPerSide ) * config.chunkQuads;
+				glm::vec3 * out = &vertices[ chunk * verticesPerChunk ];
+				for ( uint32_t y = 0; y < verticesPerChunkSide; y++ ) {
+					for ( uint32_t x = 0; x < verticesPerChunkSide; x++ ) {
+						*out++ = GridPoint( baseX + x, baseY + y );
+					}
+				}
+			}
+		}, numThreads );
+
+		// index templates - small, and the same for every chunk
+		indices.clear();
+		ranges.assign( config.lodLevels * 16, indexRange_t() );
+		const uint32_t n = config.chunkQuads;
+		for ( uint32_t level = 0; level < config.lodLevels; level++ ) {
+			const uint32_t step = 1u << level;
+			const uint32_t coarse = step * 2;
+			for ( uint32_t mask = 0; mask < 16; mask++ ) {
+				if ( mask != 0 && level + 1 == config.lodLevels ) { // nothing is coarser than the last level
+					ranges[ level * 16 + mask ] = ranges[ level * 16 ];
+					continue;
+				}
+				// vertices on an edge facing a coarser neighbor slide down to the neighbor's vertices, which flattens some
+					// triangles ( skipped ), and stretches the rest over the coarse edge
+				auto vertex = [ & ] ( uint32_t x, uint32_t y ) {
+					if ( ( x == 0 && ( mask & STITCH_NEG_X ) ) || ( x == n && ( mask & STITCH_POS_X ) ) ) y = ( y / coarse ) * coarse;
+					if ( ( y == 0 && ( mask & STITCH_NEG_Y ) ) || ( y == n && ( mask & STITCH_POS_Y ) ) ) x = ( x / coarse ) * coarse;
+					return y * verticesPerChunkSide + x;
+				};
+				auto triangle = [ & ] ( const uint32_t a, const uint32_t b, const uint32_t c ) {
+					const int64_t ax = a % verticesPerChunkSide, ay = a / verticesPerChunkSide;
+					const int64_t bx = b % verticesPerChunkSide, by = b / verticesPerChunkSide;
+					const int64_t cx = c % verticesPerChunkSide, cy = c / verticesPerChunkSide;
+					if ( ( bx - ax ) * ( cy - ay ) == ( by - ay ) * ( cx - ax ) ) return; // collapsed to a point or a line
+					indices.push_back( a );
+					indices.push_back( b );
+					indices.push_back( c );
+				};
+				indexRange_t &range = ranges[ level * 16 + mask ];
+				range.firstIndex = uint32_t( indices.size() );
+				for ( uint32_t y = 0; y < n; y += step ) {
+					for ( uint32_t x = 0; x < n; x += step ) {
+						// same corner order and diagonal as the recursive version
+						const uint32_t A = vertex( x, y );
+						const uint32_t B = vertex( x, y + step );
+						const uint32_t C = vertex( x + step, y );
+						const uint32_t D = vertex( x + step, y + step );
+						triangle( A, B, C );
+						triangle( B, C, D );
+					}
+				}
+				range.count = uint32_t( indices.size() ) - range.firstIndex;
+			}
+		}
+	}
+
+	//===== Chunk Selection ===========================================================================================
+	// clipFromWorld takes grid space to clip space, minZ / maxZ bound the displaced height. Chunks entirely outside the
+		// view are dropped, the rest halve their detail until their quads are at least targetQuadPixels across on
+		// screen. Neighboring levels are then limited to differ by one, which is what the stitching can handle
+	void Select ( drawList_t &list, const glm::mat4 &clipFromWorld, const float minZ, const float maxZ,
+		const glm::vec2 viewportSize, const float targetQuadPixels ) const {
+
+		const uint32_t numChunks = NumChunks();
+		std::vector< uint8_t > &levels = list.chunkLevels;
+		levels.resize( numChunks );
+		std::vector< uint8_t > visible( numChunks );
+		const float chunkSize = 2.0f * config.extent / float( chunksPerSide );
+
+		for ( uint32_t chunk = 0; chunk < numChunks; chunk++ ) {
+			const glm::vec2 lo = glm::vec2( -config.extent ) + chunkSize * glm::vec2( chunk % chunksPerSide, chunk / chunksPerSide );
+			const glm::vec2 hi = lo + glm::vec2( chunkSize );
+
+			// frustum test - clip space corners of the bounding box, culled if all of them are past the same plane
+			glm::vec4 corners[ 8 ];
+			for ( int i = 0; i < 8; i++ ) {
+				corners[ i ] = clipFromWorld * glm::vec4( ( i & 1 ) ? hi.x : lo.x, ( i & 2 ) ? hi.y : lo.y, ( i & 4 ) ? maxZ : minZ, 1.0f );
+			}
+			bool culled = false;
+			for ( int axis = 0; axis < 3 && !culled; axis++ ) {
+				bool allBelow = true, allAbove = true;
+				for ( int i = 0; i < 8; i++ ) {
+					allBelow = allBelow && corners[ i ][ axis ] < -corners[ i ].w;
+					allAbove = allAbove && corners[ i ][ axis ] > corners[ i ].w;
+				}
+				culled = allBelow || allAbove;
+			}
+			visible[ chunk ] = !culled;
+
+			// level from the longest projected edge of the chunk, at mid height - anything reaching behind the eye is
+				// drawn at full detail
+			uint32_t level = 0;
+			const float midZ = ( minZ + maxZ ) * 0.5f;
+			const glm::vec4 mid[ 4 ] = {
+				clipFromWorld * glm::vec4( lo.x, lo.y, midZ, 1.0f ), clipFromWorld * glm::vec4( hi.x, lo.y, midZ, 1.0f ),
+				clipFromWorld * glm::vec4( hi.x, hi.y, midZ, 1.0f ), clipFromWorld * glm::vec4( lo.x, hi.y, midZ, 1.0f ) };
+			if ( mid[ 0 ].w > 1e-4f && mid[ 1 ].w > 1e-4f && mid[ 2 ].w > 1e-4f && mid[ 3 ].w > 1e-4f ) {
+				float longestEdge = 0.0f;
+				for ( int i = 0; i < 4; i++ ) {
+					const glm::vec2 a = glm::vec2( mid[ i ] ) / mid[ i ].w;
+					const glm::vec2 b = glm::vec2( mid[ ( i + 1 ) % 4 ] ) / mid[ ( i + 1 ) % 4 ].w;
+					longestEdge = std::max( longestEdge, glm::length( ( a - b ) * 0.5f * viewportSize ) );
+				}
+				float quadPixels = longestEdge / float( config.chunkQuads );
+				while ( level + 1 < config.lodLevels && quadPixels < targetQuadPixels ) {
+					quadPixels *= 2.0f;
+					level++;
+				}
+			}
+			levels[ chunk ] = uint8_t( level );
+		}
+
+		// neighbors can only be one level apart - only ever lowers levels, so this settles in at most lodLevels sweeps
+		for ( bool changed = true; changed; ) {
+			changed = false;
+			for ( uint32_t chunk = 0; chunk < numChunks; chunk++ ) {
+				const uint32_t x = chunk % chunksPerSide, y = chunk / chunksPerSide;
+				uint32_t limit = levels[ chunk ];
+				if ( x > 0 ) limit = std::min( limit, levels[ chunk - 1 ] + 1u );
+				if ( x + 1 < chunksPerSide ) limit = std::min( limit, levels[ chunk + 1 ] + 1u );
+				if ( y > 0 ) limit = std::min( limit, levels[ chunk - chunksPerSide ] + 1u );
+				if ( y + 1 < chunksPerSide ) limit = std::min( limit, levels[ chunk + chunksPerSide ] + 1u );
+				if ( limit < levels[ chunk ] ) {
+					levels[ chunk ] = uint8_t( limit );
+					changed = true;
+				}
+			}
+		}
+
+		list.counts.clear();
+		list.offsets.clear();
+		list.baseVertices.clear();
+		list.numTriangles = 0;
+		for ( uint32_t chunk = 0; chunk < numChunks; chunk++ ) {
+			if ( !visible[ chunk ] ) continue;
+			const uint32_t x = chunk % chunksPerSide, y = chunk / chunksPerSide;
+			const uint32_t level = levels[ chunk ];
+			uint32_t mask = 0;
+			if ( x > 0 && levels[ chunk - 1 ] > level ) mask |= STITCH_NEG_X;
+			if ( x + 1 < chunksPerSide && levels[ chunk + 1 ] > level ) mask |= STITCH_POS_X;
+			if ( y > 0 && levels[ chunk - chunksPerSide ] > level ) mask |= STITCH_NEG_Y;
+			if ( y + 1 < chunksPerSide && levels[ chunk + chunksPerSide ] > level ) mask |= STITCH_POS_Y;
+			const indexRange_t &range = Range( level, mask );
+			list.counts.push_back( int32_t( range.count ) );
+			list.offsets.push_back( ( const void * ) ( uintptr_t( range.firstIndex ) * sizeof( uint32_t ) ) );
+			list.baseVertices.push_back( int32_t( chunk * verticesPerChunk ) );
+			list.numTriangles += range.count / 3;
+		}
+	}
+};
+
+//===== Benchmark =====================================================================================================
+struct benchmarkResult_t {
+	float minDisplacement = 0.0f;
+	uint32_t quadsPerSide = 0;
+	uint32_t chunkQuads = 0;
+	uint32_t numThreads = 0;
+
+	float recursiveMs = 0.0f;
+	size_t recursiveVertices = 0;
+	size_t recursiveBytes = 0;
+	size_t recursiveCalls = 0;		// each one allocates its own vector of corners
+
+	float gridMs = 0.0f;
+	size_t gridVertices = 0;
+	size_t gridBytes = 0;			// vertices + index templates
+	float selectMs = 0.0f;			// one full selection, everything in view
+	uint32_t selectedTriangles = 0;
+};
+
+inline benchmarkResult_t Benchmark ( const float minDisplacement, const uint32_t chunkQuads ) {
+	benchmarkResult_t result;
+	result.minDisplacement = minDisplacement;
+	result.numThreads = parallelThreadCount();
+	auto msSince = [] ( const std::chrono::high_resolution_clock::time_point t ) {
+		return std::chrono::duration< float, std::milli >( std::chrono::high_resolution_clock::now() - t ).count();
+	};
+
+	auto t = std::chrono::high_resolution_clock::now();
+	{
+		std::vector< glm::vec3 > world;
+		SubdivideRecursive( world, { glm::vec3( -1.0f, -1.0f, 0.0f ), glm::vec3( -1.0f, 1.0f, 0.0f ), glm::vec3( 1.0f, -1.0f, 0.0f ), glm::vec3( 1.0f, 1.0f, 0.0f ) }, minDisplacement );
+		result.recursiveVertices = world.size();
+		result.recursiveBytes = world.size() * sizeof( glm::vec3 );
+	}
+	result.recursiveMs = msSince( t );
+
+	t = std::chrono::high_resolution_clock::now();
+	grid_t grid;
+	gridConfig_t config;
+	config.minDisplacement = minDisplacement;
+	config.chunkQuads = chunkQuads;
+	grid.Generate( config );
+	result.gridMs = msSince( t );
+	result.quadsPerSide = grid.quadsPerSide;
+	result.chunkQuads = grid.config.chunkQuads;
+	result.gridVertices = grid.vertices.size();
+	result.gridBytes = grid.VertexBytes() + grid.IndexBytes();
+
+	// one call per level of the recursion, 4^level of them
+	for ( uint32_t quads = 1; quads <= grid.quadsPerSide; quads *= 2 ) {
+		result.recursiveCalls += size_t( quads ) * quads;
+	}
+
+	t = std::chrono::high_resolution_clock::now();
+	drawList_t list;
+	grid.Select( list, glm::mat4( 1.0f ), -1.0f, 1.0f, glm::vec2( 1920.0f, 1080.0f ), 4.0f );
+	result.selectMs = msSince( t );
+	result.selectedTriangles = list.numTriangles;
+
+	return result;
+}
+
+}
+
+#endif // TERRAIN_GRID_H
@@ -32,11 +32,25 @@ public:
 			data.textureManager_local = &textureManager;
 			data.Reset();
 
+			terminal.addCommand( { "terrainGridBenchmark" }, {
+					{ "minDisplacement", FLOAT, "Quads are split until their edge is shorter than this, on the -1..1 plane." },
+					{ "chunkQuads", INT, "Quads along the edge of a LOD chunk, rounded down to a power of two." }
+				}, [=] ( args_t args ) {
+					const float minDisplacement = std::clamp( args[ "minDisplacement" ].data.x, 0.0005f, 2.0f );
+					const terrainGrid::benchmarkResult_t result = terrainGrid::Benchmark( minDisplacement, uint32_t( std::clamp( int( args[ "chunkQuads" ].data.x ), 1, 1024 ) ) );
+					terminal.addLineBreak();
+					terminal.addHistoryLine( terminal.csb.append( "Terrain Grid Benchmark ", 3 ).append( "[ " + to_string( result.quadsPerSide ) + "x" + to_string( result.quadsPerSide ) + " quads, " + to_string( result.chunkQuads ) + " per chunk, " + to_string( result.numThreads ) + " threads ]", GREY_DD ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  recursive: " + to_string( result.recursiveMs ) + "ms, " + GetWithThousandsSeparator( result.recursiveVertices ) + " vertices, " + GetWithThousandsSeparator( result.recursiveBytes ) + " bytes" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  chunked grid: " + to_string( result.gridMs ) + "ms, " + GetWithThousandsSeparator( result.gridVertices ) + " vertices, " + GetWithThousandsSeparator( result.gridBytes ) + " bytes with index templates" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  " + GetWithThousandsSeparator( result.recursiveCalls ) + " temporary corner vectors avoided, chunk selection " + to_string( result.selectMs ) + "ms ( " + GetWithThousandsSeparator( result.selectedTriangles ) + " triangles )", GREY_DD ).flush() );
+					terminal.addLineBreak();
+				}, "Time the chunked, indexed terrain grid against the recursive quad subdivision." );
+
 		}
 	}
 
 	void HandleCustomEvents () {
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 		// application specific controls
 
 		const uint8_t *state = SDL_GetKeyboardState( NULL );
@@ -71,7 +85,7 @@ public:
 	}
 
 	void DrawAPIGeometry () {
-		ZoneScoped; scopedTimer Start( "API Geometry" );
+		ZoneScoped; SCOPED_TIMER( "API Geometry" );
 
 		// is there a way to jitter the subpixel samples easily? blending/reprojection - resolve more static spheres over several frames
 			// using the analytic model from the nvidia paper? would maybe be faster, too? tbd
@@ -92,7 +106,7 @@ public:
 		ZoneScoped;
 
 		// { // dummy draw - draw something into accumulatorTexture
-		// 	scopedTimer Start( "Background" );
+		// 	SCOPED_TIMER( "Background" );
 		// 	bindSets[ "Drawing" ].apply();
 		// 	glUseProgram( data.resources.shaders[ "Background" ] );
 		// 	glDispatchCompute( ( config.width + 15 ) / 16, ( config.height + 15 ) / 16, 1 );
@@ -101,13 +115,13 @@ public:
 
 		// todo: do the deferred update here
 		{	// I think this should go pretty smoothly once I have the Gbuffer
-			scopedTimer Start( "Deferred Pass" );
+			SCOPED_TIMER( "Deferred Pass" );
 			bindSets[ "Drawing" ].apply();
 			data.DeferredPass();
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -116,7 +130,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			if ( data.config.showTiming ) {
 				textRenderer.Update( ImGui::GetIO().DeltaTime );
 				textRenderer.Draw( textureManager.Get( "Display Texture" ) );
@@ -125,7 +139,7 @@ public:
 		}
 
 		{ // show trident with current orientation
-			scopedTimer Start( "Trident" );
+			SCOPED_TIMER( "Trident" );
 			if ( data.config.showTrident ) {
 				trident.Update( textureManager.Get( "Display Texture" ) );
 				glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -134,7 +148,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		// main view transform
 		data.config.basisX = trident.basisX;
@@ -152,7 +166,7 @@ public:
 		ComputePasses();			// draw the 
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -4,6 +4,7 @@
 #include "../../../../../src/engine/coreUtils/random.h"
 #include "../../../../../src/utils/trident/trident.h"
 #include "../../../../../src/data/colors.h"
+#include "../Vertexture/terrainGrid.h"
 
 // program config
 struct vertextureConfig {
@@ -24,6 +25,9 @@ struct vertextureConfig {
 	bool showLightDebugLocations;
 	vec3 groundColor;
 
+	// ground / water LOD - chunks coarsen until their quads are about this many pixels across
+	float terrainQuadPixels = 4.0f;
+
 	// output settings
 	bool showTiming;
 	bool showTrident;
@@ -92,46 +96,6 @@ inline float Remap ( float value, float from1, float to1, float from2, float to2
 	return ( value - from1 ) / ( to1 - from1 ) * ( to2 - from2 ) + from2;
 }
 
-// quad subdivision ( recursive )
-inline void subdivide (
-	std::vector< vec3 > &pointsVector,
-	const std::vector< vec3 > inputPoints,
-	const float minDisplacement = 0.01f ) {
-
-	if ( glm::distance( inputPoints[ 0 ], inputPoints[ 2 ] ) < minDisplacement ) {
-		/* corner-to-corner distance is small, time to write API geometry
-			A ( 0 )	@=======@ B ( 1 )
-					|      /|
-					|     / |
-					|    /  |
-					|   /   |
-					|  /    |
-					| /     |
-					|/      |
-			C ( 2 )	@=======@ D ( 3 ) --> X */
-		// triangle 1 ABC
-		pointsVector.push_back( inputPoints[ 0 ] );
-		pointsVector.push_back( inputPoints[ 1 ] );
-		pointsVector.push_back( inputPoints[ 2 ] );
-		// triangle 2 BCD
-		pointsVector.push_back( inputPoints[ 1 ] );
-		pointsVector.push_back( inputPoints[ 2 ] );
-		pointsVector.push_back( inputPoints[ 3 ] );
-	} else {
-		const vec3 center = ( inputPoints[ 0 ] +  inputPoints[ 1 ] + inputPoints[ 2 ] + inputPoints[ 3 ] ) / 4.0f;
-		// midpoints between corners
-		const vec3 midpoint13 = ( inputPoints[ 1 ] + inputPoints[ 3 ] ) / 2.0f;
-		const vec3 midpoint01 = ( inputPoints[ 0 ] + inputPoints[ 1 ] ) / 2.0f;
-		const vec3 midpoint23 = ( inputPoints[ 2 ] + inputPoints[ 3 ] ) / 2.0f;
-		const vec3 midpoint02 = ( inputPoints[ 0 ] + inputPoints[ 2 ] ) / 2.0f;
-		// recursive calls, next level of subdivision
-		subdivide( pointsVector, { midpoint01, inputPoints[ 1 ], center, midpoint13 }, minDisplacement );
-		subdivide( pointsVector, { inputPoints[ 0 ], midpoint01, midpoint02, center }, minDisplacement );
-		subdivide( pointsVector, { center, midpoint13, midpoint23, inputPoints[ 3 ] }, minDisplacement );
-		subdivide( pointsVector, { midpoint02, center, inputPoints[ 2 ], midpoint23 }, minDisplacement );
-	}
-}
-
 /* ==========================================================================================================================
 Consolidating the resources for the API geometry
 ========================================================================================================================== */
@@ -171,6 +135,10 @@ struct APIGeometryContainer {
 	openGLResources resources;
 	rnGenerators rngs;
 
+	// chunked ground / water grid, and the chunks picked for the current frame
+	terrainGrid::grid_t terrain;
+	terrainGrid::drawList_t terrainDraws;
+
 };
 
 void APIGeometryContainer::LoadConfig () {
@@ -387,27 +355,23 @@ void APIGeometryContainer::Initialize () {
 		// shader, vao / vbo
 		// heightmap texture
 	{
-		std::vector< vec3 > world;
-		std::vector< vec3 > basePoints;
-
-		{
-			basePoints.resize( 4 );
-			basePoints[ 0 ] = vec3( -1.0f, -1.0f, 0.0f );
-			basePoints[ 1 ] = vec3( -1.0f,  1.0f, 0.0f );
-			basePoints[ 2 ] = vec3(  1.0f, -1.0f, 0.0f );
-			basePoints[ 3 ] = vec3(  1.0f,  1.0f, 0.0f );
-			subdivide( world, basePoints );
-		}
+		terrainGrid::gridConfig_t gridConfig;
+		gridConfig.height = 0.0f;
+		terrain.Generate( gridConfig );
 
-		GLuint vao, vbo;
+		GLuint vao, vbo, ebo;
 		glGenVertexArrays( 1, &vao );
 		glBindVertexArray( vao );
 		glGenBuffers( 1, &vbo );
 		glBindBuffer( GL_ARRAY_BUFFER, vbo );
-		resources.numPointsGround = world.size();
-		size_t numBytesPoints = sizeof( vec3 ) * resources.numPointsGround;
-		glBufferData( GL_ARRAY_BUFFER, numBytesPoints, NULL, GL_STATIC_DRAW );
-		glBufferSubData( GL_ARRAY_BUFFER, 0, numBytesPoints, &world[ 0 ] );
+		resources.numPointsGround = terrain.vertices.size();
+		glBufferData( GL_ARRAY_BUFFER, terrain.VertexBytes(), terrain.vertices.data(), GL_STATIC_DRAW );
+
+		// LOD index templates, shared by every chunk - the water VAO binds this same buffer
+		glGenBuffers( 1, &ebo );
+		glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ebo );
+		glBufferData( GL_ELEMENT_ARRAY_BUFFER, terrain.IndexBytes(), terrain.indices.data(), GL_STATIC_DRAW );
+		resources.VBOs[ "Terrain Indices" ] = ebo;
 
 		GLuint vPosition = glGetAttribLocation( resources.shaders[ "Ground" ], "vPosition" );
 		glEnableVertexAttribArray( vPosition );
@@ -626,25 +590,20 @@ void APIGeometryContainer::Initialize () {
 		// shader, vao / vbo
 		// 3x textures
 	{
-		std::vector< vec3 > world;
-		std::vector< vec3 > basePoints;
-
-		basePoints.resize( 4 );
-		basePoints[ 0 ] = vec3( -1.0f, -1.0f, 0.01f );
-		basePoints[ 1 ] = vec3( -1.0f,  1.0f, 0.01f );
-		basePoints[ 2 ] = vec3(  1.0f, -1.0f, 0.01f );
-		basePoints[ 3 ] = vec3(  1.0f,  1.0f, 0.01f );
-		subdivide( world, basePoints );
+		// same chunk layout as the ground, just raised a little - so it can use the same index buffer and draw list
+		terrainGrid::grid_t water;
+		terrainGrid::gridConfig_t gridConfig = terrain.config;
+		gridConfig.height = 0.01f;
+		water.Generate( gridConfig );
 
 		GLuint vao, vbo;
 		glGenVertexArrays( 1, &vao );
 		glBindVertexArray( vao );
 		glGenBuffers( 1, &vbo );
 		glBindBuffer( GL_ARRAY_BUFFER, vbo );
-		resources.numPointsWater = world.size();
-		size_t numBytesPoints = sizeof( vec3 ) * resources.numPointsWater;
-		glBufferData( GL_ARRAY_BUFFER, numBytesPoints, NULL, GL_STATIC_DRAW );
-		glBufferSubData( GL_ARRAY_BUFFER, 0, numBytesPoints, &world[ 0 ] );
+		resources.numPointsWater = water.vertices.size();
+		glBufferData( GL_ARRAY_BUFFER, water.VertexBytes(), water.vertices.data(), GL_STATIC_DRAW );
+		glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, resources.VBOs[ "Terrain Indices" ] );
 
 		GLuint vPosition = glGetAttribLocation( resources.shaders[ "Water" ], "vPosition" );
 		glEnableVertexAttribArray( vPosition );
@@ -666,7 +625,10 @@ void APIGeometryContainer::InitReport () {
 	cout << "\tSkirts:\t\t\t" << resources.numPointsSkirts << newline;
 	cout << "\tSpheres:\t\t" << resources.numPointsSpheres << newline;
 	cout << "\tMoving Spheres:\t\t" << resources.numPointsMovingSpheres << newline;
-	cout << "\tWater:\t\t\t" << resources.numPointsWater << newline << newline;
+	cout << "\tWater:\t\t\t" << resources.numPointsWater << newline;
+	cout << "Terrain Grid:\n";
+	cout << "\tQuads:\t\t\t" << terrain.quadsPerSide << "x" << terrain.quadsPerSide << " in " << terrain.chunksPerSide << "x" << terrain.chunksPerSide << " chunks, " << terrain.config.lodLevels << " LOD levels" << newline;
+	cout << "\tIndex Templates:\t" << terrain.indices.size() << " ( " << terrain.IndexBytes() / 1024.0f << "kb )" << newline << newline;
 }
 
 void APIGeometryContainer::Terminate () {
@@ -767,6 +729,11 @@ void APIGeometryContainer::Render () {
 	glBindFramebuffer( GL_FRAMEBUFFER, resources.FBOs[ "Primary" ] );
 	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
+	// pick the ground / water chunks for this frame - the vertex shaders don't use a projection, clip space is just
+		// the scaled trident transform with the aspect ratio applied to y, and displacement stays under the water's top
+	const mat4 clipFromWorld = mat4( mat3( 1.0f, 0.0f, 0.0f, 0.0f, config.screenAR, 0.0f, 0.0f, 0.0f, 1.0f ) * ( config.scale * tridentMat ) );
+	terrain.Select( terrainDraws, clipFromWorld, std::min( -config.heightScale, 0.0f ), std::max( 0.02f, -config.heightScale ), vec2( config.width, config.height ), config.terrainQuadPixels );
+
 	// ground
 	glBindVertexArray( resources.VAOs[ "Ground" ] );
 	glUseProgram( resources.shaders[ "Ground" ] );
@@ -779,7 +746,7 @@ void APIGeometryContainer::Render () {
 	glUniform1f( glGetUniformLocation( resources.shaders[ "Ground" ], "scale" ), config.scale );
 	textureManager_local->BindTexForShader( "Ground Heightmap", "heightmap", resources.shaders[ "Ground" ], 0 );
 	glUniformMatrix3fv( glGetUniformLocation( resources.shaders[ "Ground" ], "trident" ), 1, GL_FALSE, glm::value_ptr( tridentMat ) );
-	glDrawArrays( GL_TRIANGLES, 0, resources.numPointsGround );
+	glMultiDrawElementsBaseVertex( GL_TRIANGLES, terrainDraws.counts.data(), GL_UNSIGNED_INT, terrainDraws.offsets.data(), terrainDraws.Size(), terrainDraws.baseVertices.data() );
 
 	// spheres
 	glBindVertexArray( resources.VAOs[ "Sphere" ] );
@@ -830,7 +797,7 @@ void APIGeometryContainer::Render () {
 	textureManager_local->BindTexForShader( "Water Normal Map", "normalMap", resources.shaders[ "Water" ], 1 );
 	textureManager_local->BindTexForShader( "Water Heightmap", "heightMap", resources.shaders[ "Water" ], 2 );
 	glUniformMatrix3fv( glGetUniformLocation( resources.shaders[ "Water" ], "trident" ), 1, GL_FALSE, glm::value_ptr( tridentMat ) );
-	glDrawArrays( GL_TRIANGLES, 0, resources.numPointsWater );
+	glMultiDrawElementsBaseVertex( GL_TRIANGLES, terrainDraws.counts.data(), GL_UNSIGNED_INT, terrainDraws.offsets.data(), terrainDraws.Size(), terrainDraws.baseVertices.data() );
 
 	// skirts
 	glBindVertexArray( resources.VAOs[ "Skirts" ] );
@@ -889,6 +856,10 @@ void APIGeometryContainer::ControlWindow () {
 	ImGui::Checkbox( "Show Timing", &config.showTiming );
 	ImGui::Checkbox( "Show Trident", &config.showTrident );
 
+	ImGui::Text( "Terrain" );
+	ImGui::SliderFloat( "Quad Size ( Pixels )", &config.terrainQuadPixels, 0.5f, 32.0f, "%.1f" );
+	ImGui::Text( "%u of %u chunks, %u triangles", terrainDraws.Size(), terrain.NumChunks(), terrainDraws.numTriangles );
+
 	// etc
 
 	ImGui::End();
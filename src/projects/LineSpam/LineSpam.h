@@ -1,15 +1,18 @@
-struct line {
-	vec4 p0, p1;	// width in .a?
-	vec4 color0, color1;
-};
+#include "lineSpamCPU.h" // struct line, and the CPU renderer
 
 struct LineSpamConfig_t {
 	ivec2 dimensions = ivec2( 1920, 1080 );
 
 	textureManager_t * textureManager;
 
-	GLuint opaqueLineSSBO;
-	GLuint transparentLineSSBO;
+	// SSBOs grow by doubling, and only lines added since the last upload get sent
+	struct lineBuffer_t {
+		GLuint ssbo = 0;
+		size_t capacity = 0;	// in lines
+		size_t uploaded = 0;
+	};
+	lineBuffer_t opaqueLineBuffer;
+	lineBuffer_t transparentLineBuffer;
 
 	GLuint opaquePreZShader;
 	GLuint opaqueDrawShader;
@@ -20,6 +23,7 @@ struct LineSpamConfig_t {
 	void CreateTextures();
 	void CompileShaders();
 	void PrepLineBuffers();
+	void UploadLines( lineBuffer_t &buffer, const vector< line > &list, const GLuint binding, const string label );
 
 	void UpdateTransform( inputHandler_t &input );
 	void ClearPass();
@@ -29,10 +33,16 @@ struct LineSpamConfig_t {
 
 	bool dirty = true;
 	mat4 transform = mat4( 1.0f );
-	vector< line > lines;
 	vector< line > opaqueLines;
 	vector< line > transparentLines;
-	void AddLine( line l ) { dirty = true; lines.push_back( l ); }
+	void AddLine( line l ) { // sorted into opaque and transparent as they come in
+		dirty = true;
+		if ( l.color1.a == 1.0f ) {
+			opaqueLines.push_back( l );
+		} else {
+			transparentLines.push_back( l );
+		}
+	}
 
 	float depthRange = 2.0f;
 };
@@ -78,32 +88,30 @@ void LineSpamConfig_t::PrepLineBuffers() {
 	// unset flag
 	dirty = false;
 
-	// sorting the list of lines into opaque and transparent
-	opaqueLines.clear();
-	// opaqueLines.reserve( lines.size() );
-	transparentLines.clear();
-	// transparentLines.reserve( lines.size() );
-	for ( auto& l : lines ) {
-		if ( l.color1.a == 1.0f ) {
-			opaqueLines.push_back( l );
-		} else {
-			transparentLines.push_back( l );
-		}
-	}
-
-	// create the buffers
-	glGenBuffers( 1, &opaqueLineSSBO );
-	glGenBuffers( 1, &transparentLineSSBO );
+	// send whatever has been added since last time
+	UploadLines( opaqueLineBuffer, opaqueLines, 0, "Opaque Line Data" );
+	UploadLines( transparentLineBuffer, transparentLines, 1, "Transparent Line Data" );
+}
 
-	glBindBuffer( GL_SHADER_STORAGE_BUFFER, opaqueLineSSBO );
-	glBufferData( GL_SHADER_STORAGE_BUFFER, 4 * sizeof( vec4 ) * opaqueLines.size(), ( void * ) opaqueLines.data(), GL_DYNAMIC_COPY );
-	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 0, opaqueLineSSBO );
-	glObjectLabel( GL_BUFFER, opaqueLineSSBO, -1, string( "Opaque Line Data" ).c_str() );
+void LineSpamConfig_t::UploadLines( lineBuffer_t &buffer, const vector< line > &list, const GLuint binding, const string label ) {
+	if ( buffer.ssbo == 0 ) {
+		glGenBuffers( 1, &buffer.ssbo );
+	}
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, buffer.ssbo );
+
+	if ( list.size() > buffer.capacity || buffer.capacity == 0 ) {
+		// out of room, reallocate and send everything
+		buffer.capacity = std::max( { list.size(), buffer.capacity * 2, size_t( 1024 ) } );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, sizeof( line ) * buffer.capacity, nullptr, GL_DYNAMIC_COPY );
+		glObjectLabel( GL_BUFFER, buffer.ssbo, -1, label.c_str() );
+		buffer.uploaded = 0;
+	}
 
-	glBindBuffer( GL_SHADER_STORAGE_BUFFER, transparentLineSSBO );
-	glBufferData( GL_SHADER_STORAGE_BUFFER, 4 * sizeof( vec4 ) * transparentLines.size(), ( void * ) transparentLines.data(), GL_DYNAMIC_COPY );
-	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 1, transparentLineSSBO );
-	glObjectLabel( GL_BUFFER, transparentLineSSBO, -1, string( "Transparent Line Data" ).c_str() );
+	if ( list.size() > buffer.uploaded ) {
+		glBufferSubData( GL_SHADER_STORAGE_BUFFER, sizeof( line ) * buffer.uploaded, sizeof( line ) * ( list.size() - buffer.uploaded ), ( void * ) ( list.data() + buffer.uploaded ) );
+		buffer.uploaded = list.size();
+	}
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, binding, buffer.ssbo );
 }
 
 void LineSpamConfig_t::UpdateTransform( inputHandler_t &input ) {
@@ -0,0 +1,513 @@
+#pragma once
+#ifndef LINE_SPAM_CPU_H
+#define LINE_SPAM_CPU_H
+
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#include "../../utils/GLM/glm.hpp"
+#include "../../engine/coreUtils/parallel.h"
+
+// same layout as line_t in the shaders
+struct line {
+	glm::vec4 p0, p1;	// width in .a?
+	glm::vec4 color0, color1;
+};
+
+// CPU version of the LineSpam passes - opaque pre-z and depth-equals ID, additive transparent tallies, and the composite.
+	// Lines go through the same screen mapping, plotLineWidth walk, AA factor and depth lerp as the compute shaders, so
+	// they cover the same pixels with the same values. Lines are set up and binned into screen tiles, and then each tile is
+	// rasterized by one thread, start to finish - a tile owns its pixels, so none of the image atomics are needed. This
+	// does not need a GL context, so it also runs headless.
+// Lines appended while the view holds still only get set up, binned and drawn themselves, on top of what is already
+	// in the buffers - opaque lines can only raise the depth, and a raised pixel loses its old ID ( no earlier line can
+	// equal the new depth there ), so the depth / ID result stays exact. New opaque lines do invalidate the transparent
+	// tallies ( they were depth tested against the old depth ), so those get redrawn.
+// Differences: the ID pass race between lines with equal depth goes to the last line in order, and float to uint
+	// conversions saturate, where GLSL leaves out of range values undefined. The composite treats ID 0 as empty, where
+	// composite.cs.glsl tests the index after subtracting one.
+class lineSpamCPU {
+public:
+	static constexpr int tileSize = 64;
+	static constexpr int tilePixels = tileSize * tileSize;
+
+	uint32_t numThreads = 0;		// 0 is one per core
+	float persistence = 0.3f;		// composite mixes in this much of the last frame, like composite.cs.glsl
+
+	struct frameStats_t {
+		bool incremental = false;
+		size_t opaqueDrawn = 0;		// lines set up and binned this frame
+		size_t transparentDrawn = 0;
+		size_t binEntries = 0;		// ( line, tile ) pairs
+	} lastFrame;
+
+	void Resize ( const uint32_t w, const uint32_t h ) {
+		width = w;
+		height = h;
+		tilesX = ( width + tileSize - 1 ) / tileSize;
+		tilesY = ( height + tileSize - 1 ) / tileSize;
+		const size_t numTiledPixels = size_t( tilesX ) * tilesY * tilePixels;
+		depthBuffer.assign( numTiledPixels, 0 );
+		idBuffer.assign( numTiledPixels, 0 );
+		tallies.assign( numTiledPixels, glm::uvec4( 0 ) );
+		composite.assign( size_t( width ) * height, glm::vec4( 0.0f ) );
+		Invalidate();
+	}
+
+	uint32_t Width () const { return width; }
+	uint32_t Height () const { return height; }
+	const glm::vec4 * GetOutput () const { return composite.data(); }
+
+	// next Render starts from clear buffers
+	void Invalidate () { fullRedraw = true; }
+
+	// draws lines added since the last call, or all of them if the view changed
+	void Render ( const std::vector< line > &opaque, const std::vector< line > &transparent, const glm::mat4 &transform, const float depthRange ) {
+		const bool viewChanged = transform != lastTransform || depthRange != lastDepthRange || opaque.size() < opaqueDone || transparent.size() < transparentDone;
+		lastFrame = frameStats_t();
+		lastFrame.incremental = !( fullRedraw || viewChanged );
+		if ( !lastFrame.incremental ) {
+			ClearAll();
+			opaqueDone = transparentDone = 0;
+			fullRedraw = false;
+			lastTransform = transform;
+			lastDepthRange = depthRange;
+		}
+
+		// tallies were depth tested against the old opaque depths
+		if ( opaque.size() > opaqueDone && transparentDone > 0 ) {
+			ClearTallies();
+			transparentDone = 0;
+		}
+
+		SetupAndBin( opaque, opaqueDone, transform, depthRange, opaqueSegments, opaqueBins );
+		SetupAndBin( transparent, transparentDone, transform, depthRange, transparentSegments, transparentBins );
+		lastFrame.opaqueDrawn = opaque.size() - opaqueDone;
+		lastFrame.transparentDrawn = transparent.size() - transparentDone;
+		lastFrame.binEntries = opaqueBins.entries.size() + transparentBins.entries.size();
+
+		parallelForDynamic( size_t( tilesX ) * tilesY, [ & ] ( const size_t tile, uint32_t ) {
+			const int tx = int( tile % tilesX ), ty = int( tile / tilesX );
+			const glm::ivec4 rect( tx * tileSize, ty * tileSize, std::min( int( width ), ( tx + 1 ) * tileSize ) - 1, std::min( int( height ), ( ty + 1 ) * tileSize ) - 1 );
+			OpaqueTile( tile, rect );
+			TransparentTile( tile, rect, transparent );
+			CompositeTile( tile, rect, opaque, depthRange );
+		}, 1, numThreads );
+
+		opaqueDone = opaque.size();
+		transparentDone = transparent.size();
+	}
+
+	struct benchmarkResult_t {
+		size_t numLines = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t numThreads = 0;
+		float fullFrameMs = 0.0f;		// every line, view changing each frame
+		double linesPerSecond = 0.0;
+		size_t appended = 0;
+		float appendFrameMs = 0.0f;		// same view, a few transparent lines added
+		size_t binEntriesPerLine = 0;
+	};
+
+	// random lines, same distribution as the LineSpam demo scene
+	static void GenerateLines ( const size_t count, std::vector< line > &opaque, std::vector< line > &transparent, const uint32_t seed = 0 ) {
+		std::mt19937 gen( seed );
+		std::normal_distribution< float > position( 0.0f, 0.3f );
+		std::uniform_real_distribution< float > brightness( 0.2f, 0.9f );
+		std::uniform_real_distribution< float > lineWidth( 1.2f, 3.0f );
+		for ( size_t i = 0; i < count; i++ ) {
+			line l;
+			l.p0 = glm::vec4( position( gen ), position( gen ), position( gen ), lineWidth( gen ) );
+			l.p1 = glm::vec4( position( gen ), position( gen ), position( gen ), 1.0f );
+			if ( i % 2 == 0 ) {
+				const float b = brightness( gen );
+				l.color0 = l.color1 = glm::vec4( 0.9f * b, 0.2f * b, 0.1f * b, 0.1f );
+				transparent.push_back( l );
+			} else {
+				l.color0 = l.color1 = glm::vec4( glm::vec3( 0.1f * brightness( gen ) ), 1.0f );
+				opaque.push_back( l );
+			}
+		}
+	}
+
+	static benchmarkResult_t Benchmark ( const size_t numLines, const uint32_t w, const uint32_t h, const uint32_t frames ) {
+		benchmarkResult_t result;
+		result.numLines = numLines;
+		result.width = w;
+		result.height = h;
+		result.numThreads = parallelThreadCount();
+
+		std::vector< line > opaque, transparent;
+		GenerateLines( numLines, opaque, transparent );
+		lineSpamCPU renderer;
+		renderer.Resize( w, h );
+
+		auto tStart = std::chrono::high_resolution_clock::now();
+		for ( uint32_t i = 0; i < frames; i++ ) {
+			const glm::mat4 transform = glm::mat4( glm::vec4( std::cos( i * 0.01f ), 0.0f, std::sin( i * 0.01f ), 0.0f ), glm::vec4( 0.0f, 1.0f, 0.0f, 0.0f ), glm::vec4( -std::sin( i * 0.01f ), 0.0f, std::cos( i * 0.01f ), 0.0f ), glm::vec4( 0.0f, 0.0f, 0.0f, 1.0f ) );
+			renderer.Render( opaque, transparent, transform, 2.0f );
+		}
+		const double seconds = std::chrono::duration< double >( std::chrono::high_resolution_clock::now() - tStart ).count();
+		result.fullFrameMs = float( seconds * 1000.0 / frames );
+		result.linesPerSecond = double( numLines ) * frames / seconds;
+		result.binEntriesPerLine = renderer.lastFrame.binEntries / std::max( size_t( 1 ), numLines );
+
+		// hold the view, and add a handful of transparent lines each frame
+		std::vector< line > extraOpaque, extra;
+		GenerateLines( std::max( size_t( 2 ), numLines / 500 ), extraOpaque, extra, 1 );
+		const glm::mat4 held = glm::mat4( 1.0f );
+		renderer.Render( opaque, transparent, held, 2.0f );
+		tStart = std::chrono::high_resolution_clock::now();
+		for ( uint32_t i = 0; i < frames; i++ ) {
+			transparent.insert( transparent.end(), extra.begin(), extra.end() );
+			renderer.Render( opaque, transparent, held, 2.0f );
+		}
+		result.appended = extra.size();
+		result.appendFrameMs = float( std::chrono::duration< double, std::milli >( std::chrono::high_resolution_clock::now() - tStart ).count() / frames );
+		return result;
+	}
+
+private:
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t tilesX = 0;
+	uint32_t tilesY = 0;
+
+	// same contents as the GL_R32UI textures, but stored a tile at a time so a tile's pixels are contiguous - row major
+		// across the whole screen touches a different page per row of the tile. The r, g, b, count tallies are together.
+	std::vector< uint32_t > depthBuffer, idBuffer;
+	std::vector< glm::uvec4 > tallies;
+	std::vector< glm::vec4 > composite;	// row major
+
+	// what's already in the buffers
+	bool fullRedraw = true;
+	glm::mat4 lastTransform = glm::mat4( 1.0f );
+	float lastDepthRange = 0.0f;
+	size_t opaqueDone = 0;
+	size_t transparentDone = 0;
+
+	// a line in screen space, as the shaders see it - endpoints stay in the line's own order, plotLineWidth is not symmetric
+	struct segment_t {
+		int x0, y0, x1, y1;	// pixel coords
+		float d0, d1;		// endpoint depths, as float( uint ) for the mix()
+		float width;		// p0.w, before plotLineWidth halves it
+		uint32_t id;		// index + 1, 0 is reserved for empty
+	};
+	std::vector< segment_t > opaqueSegments, transparentSegments;
+
+	// segment indices per tile - tiles[ t ] to tiles[ t + 1 ] in entries, in segment order
+	struct bins_t {
+		std::vector< uint32_t > tiles;
+		std::vector< uint32_t > entries;
+		std::vector< uint32_t > counts;	// [ partition ][ tile ]
+	} opaqueBins, transparentBins;
+
+	void ClearAll () {
+		std::fill( depthBuffer.begin(), depthBuffer.end(), 0u );
+		std::fill( idBuffer.begin(), idBuffer.end(), 0u );
+		ClearTallies();
+	}
+
+	void ClearTallies () {
+		std::fill( tallies.begin(), tallies.end(), glm::uvec4( 0 ) );
+	}
+
+	// transform, project, and orient the lines in [ first, end ), then bin them into tiles
+	void SetupAndBin ( const std::vector< line > &lines, const size_t first, const glm::mat4 &transform, const float depthRange, std::vector< segment_t > &segments, bins_t &bins ) {
+		const size_t count = lines.size() - first;
+		const size_t numTiles = size_t( tilesX ) * tilesY;
+		segments.resize( count );
+		bins.tiles.assign( numTiles + 1, 0 );
+		bins.entries.clear();
+		if ( count == 0 ) return;
+
+		const float ratio = float( width ) / float( height );
+		const size_t partitions = std::max( size_t( 1 ), std::min( size_t( numThreads ? numThreads : parallelThreadCount() ), count ) );
+		bins.counts.assign( partitions * numTiles, 0 );
+
+		// count pass also does the setup, fill pass writes the segment indices
+		parallelForRanges( count, [ & ] ( size_t begin, size_t end, uint32_t p ) {
+			uint32_t * counts = &bins.counts[ p * numTiles ];
+			for ( size_t i = begin; i < end; i++ ) {
+				segments[ i ] = Setup( lines[ first + i ], uint32_t( first + i + 1 ), transform, ratio, depthRange );
+				VisitTiles( segments[ i ], [ counts ] ( const uint32_t tile ) { counts[ tile ]++; } );
+			}
+		}, uint32_t( partitions ) );
+
+		// exclusive prefix sum in ( tile, partition ) order, so entries land in segment order within each tile
+		uint32_t total = 0;
+		for ( size_t t = 0; t < numTiles; t++ ) {
+			bins.tiles[ t ] = total;
+			for ( size_t p = 0; p < partitions; p++ ) {
+				const uint32_t c = bins.counts[ p * numTiles + t ];
+				bins.counts[ p * numTiles + t ] = total;
+				total += c;
+			}
+		}
+		bins.tiles[ numTiles ] = total;
+		bins.entries.resize( total );
+
+		parallelForRanges( count, [ & ] ( size_t begin, size_t end, uint32_t p ) {
+			uint32_t * offsets = &bins.counts[ p * numTiles ];
+			for ( size_t i = begin; i < end; i++ ) {
+				VisitTiles( segments[ i ], [ & ] ( const uint32_t tile ) { bins.entries[ offsets[ tile ]++ ] = uint32_t( i ); } );
+			}
+		}, uint32_t( partitions ) );
+	}
+
+	static constexpr float preZWidth = 1.5f; // opaquePreZ.cs.glsl draws every line at this width, opaqueDraw.cs.glsl at p0.w
+
+	// RangeRemapValue from mathUtils.h, and the shader's float to uint conversion
+	static float RangeRemapValue ( const float value, const float inLow, const float inHigh, const float outLow, const float outHigh ) {
+		return outLow + ( value - inLow ) * ( outHigh - outLow ) / ( inHigh - inLow );
+	}
+	static uint32_t ToUint ( const float value ) {
+		return ( value <= 0.0f ) ? 0u : ( value >= 4294967295.0f ) ? 4294967295u : uint32_t( value );
+	}
+
+	segment_t Setup ( const line &l, const uint32_t id, const glm::mat4 &transform, const float ratio, const float depthRange ) const {
+		const glm::vec3 a = glm::vec3( transform * glm::vec4( glm::vec3( l.p0 ), 1.0f ) );
+		const glm::vec3 b = glm::vec3( transform * glm::vec4( glm::vec3( l.p1 ), 1.0f ) );
+
+		// NDC to screen coords, truncated toward zero like the shader's int(), and depth to uint range ( larger is closer ) -
+			// the clamp only keeps lines far off screen from overflowing the int, the walk is still that long
+		auto toPixel = [] ( const float v, const float range, const uint32_t size ) {
+			return int( std::clamp( RangeRemapValue( v, -range, range, 0.0f, float( size ) ), -1e7f, 1e7f ) );
+		};
+		auto toDepth = [ depthRange ] ( const float z ) {
+			return float( ToUint( RangeRemapValue( z, -depthRange, depthRange, 4294967296.0f, 1.0f ) ) );
+		};
+
+		segment_t s;
+		s.x0 = toPixel( a.x, ratio, width );
+		s.y0 = toPixel( a.y, 1.0f, height );
+		s.x1 = toPixel( b.x, ratio, width );
+		s.y1 = toPixel( b.y, 1.0f, height );
+		s.d0 = toDepth( a.z );
+		s.d1 = toDepth( b.z );
+		s.width = l.p0.w;
+		s.id = id;
+		return s;
+	}
+
+	// conservative tile coverage - plotLineWidth stays inside the endpoints' bounding box and within its half width of
+		// the line, so pad both by that plus a couple pixels, and step through the tiles along the major axis
+	template < typename func_t >
+	void VisitTiles ( const segment_t &s, func_t func ) const {
+		const float pad = ( std::max( s.width, preZWidth ) + 1.0f ) / 2.0f + 2.0f;
+		const bool xMajor = std::abs( s.x1 - s.x0 ) >= std::abs( s.y1 - s.y0 );
+		float mA = float( xMajor ? s.x0 : s.y0 ), nA = float( xMajor ? s.y0 : s.x0 );
+		float mB = float( xMajor ? s.x1 : s.y1 ), nB = float( xMajor ? s.y1 : s.x1 );
+		if ( mB < mA ) {
+			std::swap( mA, mB );
+			std::swap( nA, nB );
+		}
+		const float major = mB - mA, minor = nB - nA;
+		const float slope = ( major == 0.0f ) ? 0.0f : minor / major;
+		const float halfSpan = ( major == 0.0f ) ? pad : pad * std::sqrt( major * major + minor * minor ) / major;
+		const float nMin = std::min( nA, nB ) - pad, nMax = std::max( nA, nB ) + pad;
+
+		const int majorSize = xMajor ? width : height, minorSize = xMajor ? height : width;
+		const int mLo = int( std::max( 0.0f, std::floor( mA - pad ) ) ), mHi = int( std::min( float( majorSize - 1 ), std::ceil( mB + pad ) ) );
+		for ( int tm = mLo / tileSize; mLo <= mHi && tm <= mHi / tileSize; tm++ ) {
+			const float ca = nA + slope * ( float( std::max( mLo, tm * tileSize ) ) - mA );
+			const float cb = nA + slope * ( float( std::min( mHi, tm * tileSize + tileSize - 1 ) ) - mA );
+			const float lo = std::max( nMin, std::min( ca, cb ) - halfSpan ), hi = std::min( nMax, std::max( ca, cb ) + halfSpan );
+			const int nLo = std::max( 0, int( std::ceil( lo ) ) ), nHi = std::min( minorSize - 1, int( std::floor( hi ) ) );
+			for ( int tn = nLo / tileSize; nLo <= nHi && tn <= nHi / tileSize; tn++ ) {
+				func( uint32_t( xMajor ? ( tn * tilesX + tm ) : ( tm * tilesX + tn ) ) );
+			}
+		}
+	}
+
+	// setPixelColor's depth - lerp along whichever axes the line moves on. The two remaps are taken separately, since a
+		// side loop holds one of them fixed.
+	static float MixX ( const segment_t &s, const int x ) {
+		return ( s.x0 == s.x1 ) ? 0.0f : RangeRemapValue( float( x ), float( s.x0 ), float( s.x1 ), 0.0f, 1.0f );
+	}
+	static float MixY ( const segment_t &s, const int y ) {
+		return ( s.y0 == s.y1 ) ? 0.0f : RangeRemapValue( float( y ), float( s.y0 ), float( s.y1 ), 0.0f, 1.0f );
+	}
+	static uint32_t Depth ( const segment_t &s, const float mixX, const float mixY ) {
+		const bool isVertical = ( s.x0 == s.x1 );
+		const bool isHorizontal = ( s.y0 == s.y1 );
+		float depthMix;
+		if ( isVertical && isHorizontal ) {
+			depthMix = 0.5f; // single pixel line
+		} else if ( isVertical ) {
+			depthMix = mixY;
+		} else if ( isHorizontal ) {
+			depthMix = mixX;
+		} else {
+			depthMix = ( mixX + mixY ) / 2.0f;
+		}
+		return ToUint( s.d0 * ( 1.0f - depthMix ) + s.d1 * depthMix );
+	}
+
+	// plotLineWidth, from https://zingl.github.io/bresenham.html, as in the shaders - calls func( pixelIndex, depth, AAFactor )
+		// for the pixels inside rect ( inclusive, x0 y0 x1 y1 ), with the pixel index relative to the tile. Every pass of
+		// the pixel loop steps the major axis once, and the minor axis steps before pass i have a closed form, so the walk
+		// jumps to the first pass whose side loops can reach the tile, and stops once the main pixel is past it. The side
+		// loops only run when they can reach the tile - they never touch err, so skipping them doesn't change the walk.
+	template < typename func_t >
+	void Rasterize ( const segment_t &s, const float lineWidth, const glm::ivec4 &rect, func_t func ) const {
+		int x0 = s.x0, y0 = s.y0;
+		const int x1 = s.x1, y1 = s.y1;
+		const int dx = std::abs( x1 - x0 ), sx = x0 < x1 ? 1 : -1;
+		const int dy = std::abs( y1 - y0 ), sy = y0 < y1 ? 1 : -1;
+		int err = dx - dy, e2, x2, y2;
+		const float ed = dx + dy == 0 ? 1.0f : std::sqrt( float( dx ) * float( dx ) + float( dy ) * float( dy ) );
+		const float wd = ( lineWidth + 1.0f ) / 2.0f;
+
+		// how far a side loop runs along the major axis - it starts at least ( major - minor / 2 ) and adds minor per pixel
+		const bool xMajor = dx >= dy;
+		const int major = xMajor ? dx : dy, minor = xMajor ? dy : dx;
+		const int reach = ( minor == 0 ) ? 0 : std::clamp( int( std::ceil( ( ed * wd - major + 0.5f * minor ) / minor ) ) + 1, 0, major );
+		const int64_t skip = xMajor ? ( ( sx > 0 ) ? rect.x - reach - x0 : x0 - reach - rect.z ) : ( ( sy > 0 ) ? rect.y - reach - y0 : y0 - reach - rect.w );
+		if ( skip > 0 && major > 0 ) {
+			const int64_t i = std::min( int64_t( major ), skip );
+			const int64_t j = ( ( 2 * i + 1 ) * minor ) / ( 2 * major );
+			if ( j > minor ) return; // took the minor axis break before getting here
+			if ( xMajor ) {
+				x0 += int( sx * i );
+				y0 += int( sy * j );
+				err = int( dx - dy - i * dy + j * dx );
+			} else {
+				y0 += int( sy * i );
+				x0 += int( sx * j );
+				err = int( dx - dy - j * dy + i * dx );
+			}
+		}
+
+		auto AAFactor = [ ed, wd ] ( const int e ) {
+			return std::max( 0.0f, 255.0f - 255.0f * ( float( std::abs( e ) ) / ed - wd + 1.0f ) );
+		};
+		auto plot = [ & ] ( const int x, const int y, const float mixX, const float mixY, const float AA ) {
+			func( uint32_t( ( y - rect.y ) * tileSize + ( x - rect.x ) ), Depth( s, mixX, mixY ), AA );
+		};
+
+		for ( ;; ) {
+			const bool xIn = x0 >= rect.x && x0 <= rect.z, yIn = y0 >= rect.y && y0 <= rect.w;
+			if ( ( sx > 0 ? x0 > rect.z : x0 < rect.x ) || ( sy > 0 ? y0 > rect.w : y0 < rect.y ) ) break;
+			if ( xIn && yIn ) plot( x0, y0, MixX( s, x0 ), MixY( s, y0 ), AAFactor( err - dx + dy ) );
+			e2 = err; x2 = x0;
+			if ( 2 * e2 >= -dx ) { // x step
+				if ( xIn ) {
+					const float mixX = MixX( s, x0 );
+					for ( e2 += dy, y2 = y0; float( e2 ) < ed * wd && ( y1 != y2 || dx > dy ); e2 += dx ) {
+						y2 += sy;
+						if ( sy > 0 ? y2 > rect.w : y2 < rect.y ) break;
+						if ( y2 >= rect.y && y2 <= rect.w ) plot( x0, y2, mixX, MixY( s, y2 ), AAFactor( e2 ) );
+					}
+				}
+				if ( x0 == x1 ) break;
+				e2 = err; err -= dy; x0 += sx;
+			}
+			if ( 2 * e2 <= dy ) { // y step
+				if ( yIn ) {
+					const float mixY = MixY( s, y0 );
+					for ( e2 = dx - e2; float( e2 ) < ed * wd && ( x1 != x2 || dx < dy ); e2 += dy ) {
+						x2 += sx;
+						if ( sx > 0 ? x2 > rect.z : x2 < rect.x ) break;
+						if ( x2 >= rect.x && x2 <= rect.z ) plot( x2, y0, MixX( s, x2 ), mixY, AAFactor( e2 ) );
+					}
+				}
+				if ( y0 == y1 ) break;
+				err += dx; y0 += sy;
+			}
+		}
+	}
+
+	void OpaqueTile ( const size_t tile, const glm::ivec4 &rect ) {
+		uint32_t * depths = &depthBuffer[ tile * tilePixels ];
+		uint32_t * ids = &idBuffer[ tile * tilePixels ];
+		const uint32_t first = opaqueBins.tiles[ tile ], last = opaqueBins.tiles[ tile + 1 ];
+
+		// pre-z, max depth at the fixed width - a pixel this raises loses its ID, only a line at the new depth can claim it
+		for ( uint32_t e = first; e < last; e++ ) {
+			Rasterize( opaqueSegments[ opaqueBins.entries[ e ] ], preZWidth, rect, [ depths, ids ] ( const uint32_t pixel, const uint32_t depth, float ) {
+				if ( depth > depths[ pixel ] ) {
+					depths[ pixel ] = depth;
+					ids[ pixel ] = 0;
+				}
+			} );
+		}
+
+		// depth-equals ID pass, at the line's own width
+		for ( uint32_t e = first; e < last; e++ ) {
+			const segment_t &s = opaqueSegments[ opaqueBins.entries[ e ] ];
+			const uint32_t id = s.id;
+			Rasterize( s, s.width, rect, [ depths, ids, id ] ( const uint32_t pixel, const uint32_t depth, float ) {
+				if ( depth == depths[ pixel ] ) {
+					ids[ pixel ] = id;
+				}
+			} );
+		}
+	}
+
+	void TransparentTile ( const size_t tile, const glm::ivec4 &rect, const std::vector< line > &transparent ) {
+		const uint32_t * depths = &depthBuffer[ tile * tilePixels ];
+		glm::uvec4 * tally = &tallies[ tile * tilePixels ];
+		for ( uint32_t e = transparentBins.tiles[ tile ]; e < transparentBins.tiles[ tile + 1 ]; e++ ) {
+			const segment_t &s = transparentSegments[ transparentBins.entries[ e ] ];
+			const glm::vec4 color = transparent[ s.id - 1 ].color0;
+			const glm::vec4 scale = glm::vec4( color.a * color.r * 1024, color.a * color.g * 1024, color.a * color.b * 1024, color.a );
+		#ifdef __AVX__
+			const __m128 scale4 = _mm_loadu_ps( &scale.x );
+			Rasterize( s, s.width, rect, [ depths, tally, scale4 ] ( const uint32_t pixel, const uint32_t depth, const float AAFactor ) {
+				if ( depths[ pixel ] < depth ) { // depth check, all four tallies in one add
+					__m128i * t = ( __m128i * ) &tally[ pixel ];
+					_mm_storeu_si128( t, _mm_add_epi32( _mm_loadu_si128( t ), _mm_cvttps_epi32( _mm_mul_ps( scale4, _mm_set1_ps( AAFactor ) ) ) ) );
+				}
+			} );
+		#else
+			Rasterize( s, s.width, rect, [ depths, tally, scale ] ( const uint32_t pixel, const uint32_t depth, const float AAFactor ) {
+				if ( depths[ pixel ] < depth ) { // depth check
+					tally[ pixel ] += glm::uvec4( scale * AAFactor );
+				}
+			} );
+		#endif
+		}
+	}
+
+	void CompositeTile ( const size_t tile, const glm::ivec4 &rect, const std::vector< line > &opaque, const float depthRange ) {
+		for ( int y = rect.y; y <= rect.w; y++ ) {
+			for ( int x = rect.x; x <= rect.z; x++ ) {
+				const size_t pixel = tile * tilePixels + ( y - rect.y ) * tileSize + ( x - rect.x );
+				const size_t outputPixel = size_t( y ) * width + x;
+
+				// opaque color comes from the ID buffer, 0 is empty
+				const uint32_t id = idBuffer[ pixel ];
+				glm::vec4 opaqueColor = ( id == 0 ) ? glm::vec4( 0.0f ) : opaque[ id - 1 ].color0;
+
+				// transparent color resolve, and a Beer's-law-ish term for density
+				const glm::vec4 tallySamples = glm::vec4( tallies[ pixel ] ) / glm::vec4( 256.0f * 1024.0f, 256.0f * 1024.0f, 256.0f * 1024.0f, 256.0f );
+				const glm::vec4 transparentColor = glm::vec4( glm::vec3( tallySamples ), std::sqrt( 1.0f - std::clamp( std::exp( -0.3f * tallySamples.a ), 0.0f, 1.0f ) ) );
+
+				// darken with distance
+				const float zPos = -depthRange + 2.0f * depthRange * ( float( depthBuffer[ pixel ] ) - 1.0f ) / 4294967294.0f;
+				opaqueColor = glm::vec4( glm::vec3( opaqueColor ) * ( ( zPos + depthRange ) / ( 2.0f * depthRange ) ), opaqueColor.a );
+
+				// blend the transparent over the opaque
+				glm::vec3 finalColor = glm::vec3( opaqueColor );
+				if ( transparentColor.a != 0.0f ) {
+					const float a0 = transparentColor.a + opaqueColor.a * ( 1.0f - transparentColor.a );
+					finalColor = ( glm::vec3( transparentColor ) * transparentColor.a + glm::vec3( opaqueColor ) * opaqueColor.a * ( 1.0f - transparentColor.a ) ) / a0;
+				}
+				composite[ outputPixel ] = glm::vec4( glm::mix( finalColor, glm::vec3( composite[ outputPixel ] ), persistence ), 1.0f );
+			}
+		}
+	}
+};
+
+#endif // LINE_SPAM_CPU_H
@@ -9,6 +9,10 @@ public:
 
 	LineSpamConfig_t LineSpamConfig;
 
+	// rasterize on the CPU, instead of the compute shaders
+	bool CPURender = false;
+	lineSpamCPU CPURenderer;
+
 	void OnInit () {
 		ZoneScoped;
 		{
@@ -73,11 +77,26 @@ public:
 
 			// prepare the line buffers
 			LineSpamConfig.PrepLineBuffers();
+
+			CPURenderer.Resize( LineSpamConfig.dimensions.x, LineSpamConfig.dimensions.y );
+
+			terminal.addCommand( { "cpuLineSpamBenchmark" }, {
+					{ "lines", INT, "Number of lines, in thousands." },
+					{ "frames", INT, "Number of frames to render." }
+				}, [=] ( args_t args ) {
+					const lineSpamCPU::benchmarkResult_t result = lineSpamCPU::Benchmark( size_t( std::clamp( int( args[ "lines" ].data.x ), 1, 100000 ) ) * 1000, LineSpamConfig.dimensions.x, LineSpamConfig.dimensions.y, uint32_t( std::max( 1, int( args[ "frames" ].data.x ) ) ) );
+					terminal.addLineBreak();
+					terminal.addHistoryLine( terminal.csb.append( "LineSpam CPU Benchmark ", 3 ).append( "[ " + GetWithThousandsSeparator( result.numLines ) + " lines at " + to_string( result.width ) + "x" + to_string( result.height ) + ", " + to_string( result.numThreads ) + " threads ]", GREY_DD ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  " + to_string( result.fullFrameMs ) + "ms per frame, " + GetWithThousandsSeparator( size_t( result.linesPerSecond ) ) + " lines/sec" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  appending " + to_string( result.appended ) + " lines to a held view: " + to_string( result.appendFrameMs ) + "ms per frame" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  " + to_string( result.binEntriesPerLine ) + " tiles per line, on average", GREY_DD ).flush() );
+					terminal.addLineBreak();
+				}, "Time the CPU LineSpam renderer on a random scene, full redraws and incremental appends." );
 		}
 	}
 
 	void HandleCustomEvents () { // application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 	}
 
 	void ImguiPass () {
@@ -87,6 +106,10 @@ public:
 		ImGui::Text( "Loaded %d opaque lines", LineSpamConfig.opaqueLines.size() );
 		ImGui::Text( "Loaded %d transparent lines", LineSpamConfig.transparentLines.size() );
 		ImGui::SliderFloat( "Depth Range", &LineSpamConfig.depthRange, 0.001f, 10.0f );
+		ImGui::Checkbox( "CPU Renderer", &CPURender );
+		if ( CPURender ) {
+			ImGui::Text( "%s, drew %d opaque and %d transparent lines", CPURenderer.lastFrame.incremental ? "Incremental" : "Full redraw", int( CPURenderer.lastFrame.opaqueDrawn ), int( CPURenderer.lastFrame.transparentDrawn ) );
+		}
 		ImGui::End();
 
 		if ( tonemap.showTonemapWindow ) {
@@ -109,16 +132,25 @@ public:
 		ZoneScoped;
 
 		{ // update the frame
-			scopedTimer Start( "LineSpam Update" );
+			SCOPED_TIMER( "LineSpam Update" );
 			LineSpamConfig.UpdateTransform( inputHandler );
-			LineSpamConfig.ClearPass();
-			LineSpamConfig.OpaquePass();
-			LineSpamConfig.TransparentPass();
-			LineSpamConfig.CompositePass();
+			if ( CPURender ) {
+				CPURenderer.Render( LineSpamConfig.opaqueLines, LineSpamConfig.transparentLines, LineSpamConfig.transform, LineSpamConfig.depthRange );
+				glBindTexture( GL_TEXTURE_2D, textureManager.Get( "Composite Target" ) );
+				glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, CPURenderer.Width(), CPURenderer.Height(), GL_RGBA, GL_FLOAT, ( void * ) CPURenderer.GetOutput() );
+			} else {
+				if ( LineSpamConfig.dirty ) {
+					LineSpamConfig.PrepLineBuffers();
+				}
+				LineSpamConfig.ClearPass();
+				LineSpamConfig.OpaquePass();
+				LineSpamConfig.TransparentPass();
+				LineSpamConfig.CompositePass();
+			}
 		}
 
 		{ // copy the composited image into accumulatorTexture
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 			glUseProgram( shaders[ "Draw" ] );
 			textureManager.BindTexForShader( "Composite Target", "compositedResult", shaders[ "Draw" ], 2 );
@@ -127,7 +159,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -136,7 +168,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Clear();
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 
@@ -155,7 +187,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -392,6 +392,7 @@ struct bvh_t {
 	}
 
 	void BuildTree () {
+		PROFILE_SCOPE( "BVH Build" );
 		// maximum possible size is 2N + 1 nodes, where N is the number of triangles
 			// ( N leaves have N/2 parents, N/4 granparents, etc... )
 		bvhNodes.resize( triangleList.size() * 2 - 1 );
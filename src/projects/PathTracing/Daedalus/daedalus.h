@@ -1,5 +1,6 @@
 #include "../../../engine/engine.h"
 #include "daedalusConfig.h"
+#include "skyImportance.h"
 
 class Daedalus final : public engineBase {
 public:
@@ -109,12 +110,41 @@ public:
 				opts.magFilter		= GL_LINEAR;
 				textureManager.Add( "Vectorscope Composite", opts );
 			}
+
+			// importance sampling tables for the loaded sky - test the one that's loaded, benchmark on a synthetic one
+			terminal.addCommand( { "skyImportanceTest" }, {
+					{ "samples", INT, "How many samples to bin, in millions." }
+				}, [=] ( args_t args ) {
+					if ( !skyImportance.Valid() ) {
+						terminal.addHistoryLine( terminal.csb.append( "  no sky tables, load an EXR first" ).flush() );
+						return;
+					}
+					skyImportance.invert = daedalusConfig.render.scene.skyInvert;
+					const size_t numSamples = size_t( std::max( 1, int( args[ "samples" ].data.x ) ) ) * 1000000;
+					for ( const bool useAlias : { true, false } ) {
+						const skyImportance_t::chiSquare_t result = skyImportance.ChiSquareTest( numSamples, 64, 32, useAlias );
+						terminal.addHistoryLine( terminal.csb.append( string( useAlias ? "  alias: " : "  CDF:   " ) + "chi-square " + to_string( result.statistic ) + " over " + to_string( result.dof ) +
+							" dof, p = " + to_string( result.pValue ) + ", pdf integrates to " + to_string( result.pdfIntegral ) + ( result.pass ? ", pass" : ", FAIL" ) ).flush() );
+					}
+				}, "Chi-square test of the sky importance sampling tables against their own pdf." );
+
+			terminal.addCommand( { "skyImportanceBenchmark" }, {
+					{ "width", INT, "Width of the synthetic sky, height is half of it." }
+				}, [=] ( args_t args ) {
+					const uint32_t width = uint32_t( std::max( 2, int( args[ "width" ].data.x ) ) );
+					const skyImportance_t::benchmarkResult_t result = skyImportance_t::Benchmark( width, width / 2 );
+					terminal.addHistoryLine( terminal.csb.append( "  " + to_string( result.width ) + "x" + to_string( result.height ) + ", " + to_string( result.tableBytes >> 20 ) + "MB of tables" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  build: " + to_string( result.singleMs ) + "ms on 1 thread, " + to_string( result.multiMs ) + "ms on " + to_string( result.threads ) ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  hash: " + to_string( result.hashMs ) + "ms, cache write " + to_string( result.saveMs ) + "ms, cached load " + to_string( result.loadMs ) + "ms" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  sampling: " + to_string( int64_t( result.aliasSamplesPerSecond ) ) + "/s alias, " + to_string( int64_t( result.cdfSamplesPerSecond ) ) + "/s CDF" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  chi-square p = " + to_string( result.test.pValue ) + ( result.test.pass ? ", pass" : ", FAIL" ) ).flush() );
+				}, "Build time for sky importance sampling tables on a synthetic HDRI, one thread vs all of them." );
 		}
 	}
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		// get new data into the input handler
 		inputHandler.update();
@@ -290,6 +320,49 @@ public:
 	void SendSkyCacheUniforms();
 	void SendBasePathtraceUniforms();
 	void SendInnerLoopPathtraceUniforms();
+
+	// the pathtrace pass sets these every frame, and the last two for every tile - held here so the locations are
+		// only looked up once, and values that haven't changed since the last dispatch aren't sent again
+	struct pathtraceUniforms_t {
+		uniform_t< ivec2 > noiseOffset { "noiseOffset" };
+		uniform_t< int > subpixelJitterMethod { "subpixelJitterMethod" };
+		uniform_t< int > sampleNumber { "sampleNumber" };
+		uniform_t< int > bokehMode { "bokehMode" };
+		uniform_t< int > cameraType { "cameraType" };
+		uniform_t< float > voraldoCameraScalar { "voraldoCameraScalar" };
+		uniform_t< int > cameraOriginJitter { "cameraOriginJitter" };
+		uniform_t< float > uvScalar { "uvScalar" };
+		uniform_t< float > exposure { "exposure" };
+		uniform_t< float > FoV { "FoV" };
+		uniform_t< float > maxDistance { "maxDistance" };
+		uniform_t< float > epsilon { "epsilon" };
+		uniform_t< int > maxBounces { "maxBounces" };
+		uniform_t< float > skyClamp { "skyClamp" };
+		uniform_t< int > skyInvert { "skyInvert" };
+		uniform_t< float > skyBrightnessScalar { "skyBrightnessScalar" };
+		uniform_t< int > raymarchEnable { "raymarchEnable" };
+		uniform_t< int > raymarchMaxSteps { "raymarchMaxSteps" };
+		uniform_t< float > raymarchUnderstep { "raymarchUnderstep" };
+		uniform_t< float > raymarchMaxDistance { "raymarchMaxDistance" };
+		uniform_t< float > marbleRadius { "marbleRadius" };
+		uniform_t< int > ddaSpheresEnable { "ddaSpheresEnable" };
+		uniform_t< vec3 > ddaSpheresBoundSize { "ddaSpheresBoundSize" };
+		uniform_t< int > ddaSpheresResolution { "ddaSpheresResolution" };
+		uniform_t< int > maskedPlaneEnable { "maskedPlaneEnable" };
+		uniform_t< int > numExplicitPrimitives { "numExplicitPrimitives" };
+		uniform_t< int > explicitListEnable { "explicitListEnable" };
+		uniform_t< vec3 > viewerPosition { "viewerPosition" };
+		uniform_t< vec3 > basisX { "basisX" };
+		uniform_t< vec3 > basisY { "basisY" };
+		uniform_t< vec3 > basisZ { "basisZ" };
+		uniform_t< int > thinLensEnable { "thinLensEnable" };
+		uniform_t< float > thinLensFocusDistance { "thinLensFocusDistance" };
+		uniform_t< float > thinLensJitterRadiusInner { "thinLensJitterRadiusInner" };
+		uniform_t< float > thinLensJitterRadiusOuter { "thinLensJitterRadiusOuter" };
+		uniform_t< ivec2 > tileOffset { "tileOffset" };
+		uniform_t< int > wangSeed { "wangSeed" };
+	} pathtraceUniforms;
+
 	void SendPrepareUniforms();
 	void SendPresentUniforms();
 	void SendWaveformPrepareUniforms();
@@ -310,6 +383,9 @@ public:
 	void ClearColorGradingVectorscopeBuffer();
 	void LoadSkyBoxEXRFromString( string label );
 
+	// importance sampling tables for the sky, built when an EXR is loaded
+	skyImportance_t skyImportance;
+
 	GLuint64 SubmitTimerAndWait( GLuint timer ) {
 		ZoneScoped;
 		glQueryCounter( timer, GL_TIMESTAMP );
@@ -346,7 +422,7 @@ public:
 		}
 
 		{
-			scopedTimer Start( "Sky Cache" );
+			SCOPED_TIMER( "Sky Cache" );
 			if ( daedalusConfig.render.scene.skyNeedsUpdate == true && daedalusConfig.render.scene.skyMode != 6 ) {
 				daedalusConfig.render.scene.skyNeedsUpdate = false;
 				// dispatch for every pixel in the sky cache texture
@@ -357,7 +433,7 @@ public:
 		}
 
 		{ // do some tiles, update the buffer
-			scopedTimer Start( "Tiled Update" );
+			SCOPED_TIMER( "Tiled Update" );
 
 			const GLuint shader = shaders[ "Pathtrace" ];
 			glUseProgram( shader );
@@ -374,13 +450,18 @@ public:
 			uint32_t tilesThisFrame = 0;
 			SendBasePathtraceUniforms();
 			const uint32_t tileSize = daedalusConfig.tiles.tileSize;
+			float loopTime = 0.0f;
 			while ( daedalusConfig.render.render && !quitConfirm ) {
-				for ( uint32_t tile = 0; tile < daedalusConfig.tiles.tilesBetweenQueries; tile++ ) {
+				// batch size comes from the measured cost per tile, so the last batch lands near the time limit
+				const uint32_t batchSize = daedalusConfig.tiles.NextBatchSize( loopTime );
+				for ( uint32_t tile = 0; tile < batchSize; tile++ ) {
 					SendInnerLoopPathtraceUniforms();
 					glDispatchCompute( tileSize / 16, tileSize / 16, 1 );
 					tilesThisFrame++;
 				}
-				float loopTime = ( SubmitTimerAndWait( t[ 1 ] ) - tStart ) / 1e6f; // convert ns -> ms
+				const float previousLoopTime = loopTime;
+				loopTime = ( SubmitTimerAndWait( t[ 1 ] ) - tStart ) / 1e6f; // convert ns -> ms
+				daedalusConfig.tiles.ReportBatch( batchSize, loopTime - previousLoopTime );
 				if ( loopTime > daedalusConfig.tiles.tileTimeLimitMS ) {
 					UpdatePerfMonitor( loopTime, tilesThisFrame );
 					break;
@@ -390,7 +471,7 @@ public:
 		}
 
 		{	// this is the tonemapping stage, on the result ( accumulator(s) -> tonemapped )
-			scopedTimer Start( "Prepare" );
+			SCOPED_TIMER( "Prepare" );
 			const GLuint shader = shaders[ "Prepare" ];
 			glUseProgram( shader );
 			SendPrepareUniforms();
@@ -404,7 +485,7 @@ public:
 		}
 
 		if ( daedalusConfig.render.grading.updateHistogram == true ) {	// prepping the image of the color/luminance histogram
-			scopedTimer Start( "Histogram Prep" );
+			SCOPED_TIMER( "Histogram Prep" );
 			const GLuint shader = shaders[ "Histogram" ];
 			glUseProgram( shader );
 			textureManager.BindImageForShader( "Histogram Composite", "histogram", shader, 0 );
@@ -413,7 +494,7 @@ public:
 		}
 
 		if ( daedalusConfig.render.grading.updateWaveform == true || daedalusConfig.render.grading.updateParade == true ) {	// prepping the waveform display
-			scopedTimer Start( "Waveform Prep/Composite" );
+			SCOPED_TIMER( "Waveform Prep/Composite" );
 
 			// initialize the min/max buffers
 			ClearColorGradingWaveformBuffer();
@@ -446,7 +527,7 @@ public:
 		}
 
 		if ( daedalusConfig.render.grading.updateVectorscope == true ) {
-			scopedTimer Start( "Vectorscope Prep/Composite" );
+			SCOPED_TIMER( "Vectorscope Prep/Composite" );
 
 			// initialize the max count value
 			ClearColorGradingVectorscopeBuffer();
@@ -468,7 +549,7 @@ public:
 		}
 
 		{	// this is the matting, with guides
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			const GLuint shader = shaders[ "Present" ];
 			glUseProgram( shader );
 			SendPresentUniforms();
@@ -477,7 +558,7 @@ public:
 		}
 
 		{ // text rendering - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 
 			textRenderer.Clear();
 
@@ -517,7 +598,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -1,5 +1,3 @@
-#include "tileDispenser.h"
-
 struct rngen_t {
 	rngi wangSeeder = rngi( 0, 10000000 );
 	rngi blueNoiseOffset = rngi( 0, 512 );
@@ -128,8 +126,8 @@ struct daedalusConfig_t {
 		targetHeight = 1080;
 		tileSize = 256;
 
-		// initialize the tile dispenser
-		tiles = tileDispenser( tileSize, targetWidth, targetHeight );
+		// initialize the tile scheduler
+		tiles.Reset( tileSize, targetWidth, targetHeight );
 
 		// setup performance monitor
 		performanceHistorySamples = 250;
@@ -216,7 +214,7 @@ struct daedalusConfig_t {
 	uint32_t targetWidth;
 	uint32_t targetHeight;
 	uint32_t tileSize;
-	tileDispenser tiles;
+	tileScheduler_t tiles;
 
 	// performance settings / monitoring
 	uint32_t performanceHistorySamples;
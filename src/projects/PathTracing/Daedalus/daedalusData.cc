@@ -5,7 +5,7 @@ void Daedalus::ResetAccumulators() {
 	textureManager.ZeroTexture2D( "Color Accumulator" );
 	textureManager.ZeroTexture2D( "Depth/Normals Accumulator" );
 	textureManager.ZeroTexture2D( "Tonemapped" );
-	daedalusConfig.tiles.RegenerateTileList(); // timer / sample count reset
+	daedalusConfig.tiles.ResetAccumulation(); // timer / sample count reset, keeps the cost estimate
 }
 
 void Daedalus::ResizeAccumulators( uint32_t x, uint32_t y ) {
@@ -100,46 +100,47 @@ void Daedalus::SendBasePathtraceUniforms() {
 	static ivec2 blueNoiseOffset;
 	if ( sampleCount != daedalusConfig.tiles.SampleCount() ) sampleCount = daedalusConfig.tiles.SampleCount(),
 		blueNoiseOffset = ivec2( daedalusConfig.rng.blueNoiseOffset(), daedalusConfig.rng.blueNoiseOffset() );
-	glUniform2i( glGetUniformLocation( shader, "noiseOffset" ), blueNoiseOffset.x, blueNoiseOffset.y );
-	glUniform1i( glGetUniformLocation( shader, "subpixelJitterMethod" ), daedalusConfig.render.subpixelJitterMethod );
-	glUniform1i( glGetUniformLocation( shader, "sampleNumber" ), daedalusConfig.tiles.SampleCount() );
-	glUniform1i( glGetUniformLocation( shader, "bokehMode" ), daedalusConfig.render.bokehMode );
-	glUniform1i( glGetUniformLocation( shader, "cameraType" ), daedalusConfig.render.cameraType );
-	glUniform1f( glGetUniformLocation( shader, "voraldoCameraScalar" ), daedalusConfig.render.voraldoCameraScalar );
-	glUniform1i( glGetUniformLocation( shader, "cameraOriginJitter" ), daedalusConfig.render.cameraOriginJitter );
-	glUniform1f( glGetUniformLocation( shader, "uvScalar" ), daedalusConfig.render.uvScalar ); // consider making this 2d
-	glUniform1f( glGetUniformLocation( shader, "exposure" ), daedalusConfig.render.exposure );
-	glUniform1f( glGetUniformLocation( shader, "FoV" ), daedalusConfig.render.FoV );
-	glUniform1f( glGetUniformLocation( shader, "maxDistance" ), daedalusConfig.render.maxDistance );
-	glUniform1f( glGetUniformLocation( shader, "epsilon" ), daedalusConfig.render.epsilon );
-	glUniform1i( glGetUniformLocation( shader, "maxBounces" ), daedalusConfig.render.maxBounces );
-	glUniform1f( glGetUniformLocation( shader, "skyClamp" ), daedalusConfig.render.scene.skyClamp );
-	glUniform1i( glGetUniformLocation( shader, "skyInvert" ), daedalusConfig.render.scene.skyInvert );
-	glUniform1f( glGetUniformLocation( shader, "skyBrightnessScalar" ), daedalusConfig.render.scene.skyBrightnessScalar );
-
-	glUniform1i( glGetUniformLocation( shader, "raymarchEnable" ), daedalusConfig.render.scene.raymarchEnable );
-	glUniform1i( glGetUniformLocation( shader, "raymarchMaxSteps" ), daedalusConfig.render.scene.raymarchMaxSteps );
-	glUniform1f( glGetUniformLocation( shader, "raymarchUnderstep" ), daedalusConfig.render.scene.raymarchUnderstep );
-	glUniform1f( glGetUniformLocation( shader, "raymarchMaxDistance" ), daedalusConfig.render.scene.raymarchMaxDistance );
-	glUniform1f( glGetUniformLocation( shader, "marbleRadius" ), daedalusConfig.render.scene.marbleRadius );
-
-	glUniform1i( glGetUniformLocation( shader, "ddaSpheresEnable" ), daedalusConfig.render.scene.ddaSpheresEnable );
-	glUniform3fv( glGetUniformLocation( shader, "ddaSpheresBoundSize" ), 1, glm::value_ptr( daedalusConfig.render.scene.ddaSpheresBoundSize ) );
-	glUniform1i( glGetUniformLocation( shader, "ddaSpheresResolution" ), daedalusConfig.render.scene.ddaSpheresResolution );
-
-	glUniform1i( glGetUniformLocation( shader, "maskedPlaneEnable" ), daedalusConfig.render.scene.maskedPlaneEnable );
-
-	glUniform1i( glGetUniformLocation( shader, "numExplicitPrimitives" ), daedalusConfig.render.scene.numExplicitPrimitives );
-	glUniform1i( glGetUniformLocation( shader, "explicitListEnable" ), daedalusConfig.render.scene.explicitListEnable );
-
-	glUniform3fv( glGetUniformLocation( shader, "viewerPosition" ), 1, glm::value_ptr( daedalusConfig.render.viewerPosition ) );
-	glUniform3fv( glGetUniformLocation( shader, "basisX" ), 1, glm::value_ptr( daedalusConfig.render.basisX ) );
-	glUniform3fv( glGetUniformLocation( shader, "basisY" ), 1, glm::value_ptr( daedalusConfig.render.basisY ) );
-	glUniform3fv( glGetUniformLocation( shader, "basisZ" ), 1, glm::value_ptr( daedalusConfig.render.basisZ ) );
-	glUniform1i( glGetUniformLocation( shader, "thinLensEnable" ), daedalusConfig.render.thinLensEnable );
-	glUniform1f( glGetUniformLocation( shader, "thinLensFocusDistance" ), daedalusConfig.render.thinLensFocusDistance );
-	glUniform1f( glGetUniformLocation( shader, "thinLensJitterRadiusInner" ), daedalusConfig.render.thinLensJitterRadiusInner );
-	glUniform1f( glGetUniformLocation( shader, "thinLensJitterRadiusOuter" ), daedalusConfig.render.thinLensJitterRadiusOuter );
+	uniformCache_t &uniforms = UniformCache();
+	uniforms.Set( shader, pathtraceUniforms.noiseOffset, blueNoiseOffset );
+	uniforms.Set( shader, pathtraceUniforms.subpixelJitterMethod, daedalusConfig.render.subpixelJitterMethod );
+	uniforms.Set( shader, pathtraceUniforms.sampleNumber, daedalusConfig.tiles.SampleCount() );
+	uniforms.Set( shader, pathtraceUniforms.bokehMode, daedalusConfig.render.bokehMode );
+	uniforms.Set( shader, pathtraceUniforms.cameraType, daedalusConfig.render.cameraType );
+	uniforms.Set( shader, pathtraceUniforms.voraldoCameraScalar, daedalusConfig.render.voraldoCameraScalar );
+	uniforms.Set( shader, pathtraceUniforms.cameraOriginJitter, daedalusConfig.render.cameraOriginJitter );
+	uniforms.Set( shader, pathtraceUniforms.uvScalar, daedalusConfig.render.uvScalar ); // consider making this 2d
+	uniforms.Set( shader, pathtraceUniforms.exposure, daedalusConfig.render.exposure );
+	uniforms.Set( shader, pathtraceUniforms.FoV, daedalusConfig.render.FoV );
+	uniforms.Set( shader, pathtraceUniforms.maxDistance, daedalusConfig.render.maxDistance );
+	uniforms.Set( shader, pathtraceUniforms.epsilon, daedalusConfig.render.epsilon );
+	uniforms.Set( shader, pathtraceUniforms.maxBounces, daedalusConfig.render.maxBounces );
+	uniforms.Set( shader, pathtraceUniforms.skyClamp, daedalusConfig.render.scene.skyClamp );
+	uniforms.Set( shader, pathtraceUniforms.skyInvert, daedalusConfig.render.scene.skyInvert );
+	uniforms.Set( shader, pathtraceUniforms.skyBrightnessScalar, daedalusConfig.render.scene.skyBrightnessScalar );
+
+	uniforms.Set( shader, pathtraceUniforms.raymarchEnable, daedalusConfig.render.scene.raymarchEnable );
+	uniforms.Set( shader, pathtraceUniforms.raymarchMaxSteps, daedalusConfig.render.scene.raymarchMaxSteps );
+	uniforms.Set( shader, pathtraceUniforms.raymarchUnderstep, daedalusConfig.render.scene.raymarchUnderstep );
+	uniforms.Set( shader, pathtraceUniforms.raymarchMaxDistance, daedalusConfig.render.scene.raymarchMaxDistance );
+	uniforms.Set( shader, pathtraceUniforms.marbleRadius, daedalusConfig.render.scene.marbleRadius );
+
+	uniforms.Set( shader, pathtraceUniforms.ddaSpheresEnable, daedalusConfig.render.scene.ddaSpheresEnable );
+	uniforms.Set( shader, pathtraceUniforms.ddaSpheresBoundSize, daedalusConfig.render.scene.ddaSpheresBoundSize );
+	uniforms.Set( shader, pathtraceUniforms.ddaSpheresResolution, daedalusConfig.render.scene.ddaSpheresResolution );
+
+	uniforms.Set( shader, pathtraceUniforms.maskedPlaneEnable, daedalusConfig.render.scene.maskedPlaneEnable );
+
+	uniforms.Set( shader, pathtraceUniforms.numExplicitPrimitives, daedalusConfig.render.scene.numExplicitPrimitives );
+	uniforms.Set( shader, pathtraceUniforms.explicitListEnable, daedalusConfig.render.scene.explicitListEnable );
+
+	uniforms.Set( shader, pathtraceUniforms.viewerPosition, daedalusConfig.render.viewerPosition );
+	uniforms.Set( shader, pathtraceUniforms.basisX, daedalusConfig.render.basisX );
+	uniforms.Set( shader, pathtraceUniforms.basisY, daedalusConfig.render.basisY );
+	uniforms.Set( shader, pathtraceUniforms.basisZ, daedalusConfig.render.basisZ );
+	uniforms.Set( shader, pathtraceUniforms.thinLensEnable, daedalusConfig.render.thinLensEnable );
+	uniforms.Set( shader, pathtraceUniforms.thinLensFocusDistance, daedalusConfig.render.thinLensFocusDistance );
+	uniforms.Set( shader, pathtraceUniforms.thinLensJitterRadiusInner, daedalusConfig.render.thinLensJitterRadiusInner );
+	uniforms.Set( shader, pathtraceUniforms.thinLensJitterRadiusOuter, daedalusConfig.render.thinLensJitterRadiusOuter );
 
 	textureManager.BindImageForShader( "Blue Noise", "blueNoise", shader, 0 );
 	textureManager.BindImageForShader( "Color Accumulator", "accumulatorColor", shader, 1 );
@@ -153,8 +154,9 @@ void Daedalus::SendBasePathtraceUniforms() {
 void Daedalus::SendInnerLoopPathtraceUniforms() {
 	const GLuint shader = shaders[ "Pathtrace" ];
 	const ivec2 tileOffset = daedalusConfig.tiles.GetTile(); // send uniforms ( unique per loop iteration )
-	glUniform2i( glGetUniformLocation( shader, "tileOffset" ),	tileOffset.x, tileOffset.y );
-	glUniform1i( glGetUniformLocation( shader, "wangSeed" ),	daedalusConfig.rng.wangSeeder() );
+	uniformCache_t &uniforms = UniformCache();
+	uniforms.Set( shader, pathtraceUniforms.tileOffset, tileOffset );
+	uniforms.Set( shader, pathtraceUniforms.wangSeed, daedalusConfig.rng.wangSeeder() );
 }
 
 void Daedalus::SendPrepareUniforms() {
@@ -816,4 +818,12 @@ void Daedalus::LoadSkyBoxEXRFromString( const string label ) {
 	opts.pixelDataType	= GL_FLOAT;
 	opts.initialData	= ( void * ) loadedImage.GetImageDataBasePtr();
 	textureManager.Add( "Sky Cache", opts );
+
+	// importance sampling tables, from the cache next to the EXR if the pixels haven't changed
+	skyImportanceOptions_t importanceOptions;
+	importanceOptions.maxWidth = 2048;
+	skyImportance.invert = daedalusConfig.render.scene.skyInvert;
+	skyImportance.BuildCached( label, loadedImage.GetImageDataBasePtr(), loadedImage.Width(), loadedImage.Height(), importanceOptions );
+	cout << "Sky importance tables for " << label << ": " << skyImportance.width << "x" << skyImportance.height << ( skyImportance.timing.fromCache ? ", from cache" : ", built" ) <<
+		" in " << skyImportance.timing.totalMs << "ms" << endl;
 }
\ No newline at end of file
@@ -243,7 +243,10 @@ void Daedalus::ShowDaedalusConfigWindow() {
 			if ( ImGui::SmallButton( " + " ) ) {
 				daedalusConfig.tiles.Reset( daedalusConfig.tiles.tileSize * 2, daedalusConfig.targetWidth, daedalusConfig.targetHeight );
 			}
-			ImGui::SliderInt( "Tiles Between Queries", ( int * )&daedalusConfig.tiles.tilesBetweenQueries, 1, 15 );
+			ImGui::Checkbox( "Adaptive Batch Size", &daedalusConfig.tiles.adaptiveBatches );
+			if ( !daedalusConfig.tiles.adaptiveBatches ) {
+				ImGui::SliderInt( "Tiles Between Queries", ( int * )&daedalusConfig.tiles.tilesBetweenQueries, 1, 15 );
+			}
 			ImGui::SliderFloat( "Frame Time Limit (ms)", &daedalusConfig.tiles.tileTimeLimitMS, 16.0f, 100.0f );
 
 			ImGui::EndTabItem();
@@ -0,0 +1,639 @@
+#pragma once
+#ifndef SKY_IMPORTANCE_H
+#define SKY_IMPORTANCE_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+
+#include "../../../utils/GLM/glm.hpp"
+#include "../../../engine/coreUtils/parallel.h"
+
+// Importance sampling tables for the EXR skies - built on the CPU from the loaded RGBA float image, in parallel. Each
+	// table cell is weighted by luminance times the solid angle it covers, then there's a CDF per row ( conditional )
+	// and one over the rows ( marginal ), and the same split as alias tables - one over the rows, one per row - so a
+	// sample is two table lookups, and every row builds independently. Tables are cached next to the EXR, keyed by a
+	// hash of the decoded pixels. Mapping to directions follows SkyColor() in pathtrace.cs.glsl, which reads u from
+	// atan( x, z ) and v linear in y - an equal area projection, so there every texel covers the same solid angle.
+
+enum skyMapping_e : uint8_t {
+	SKY_EQUAL_AREA = 0,		// v = ( y + 1 ) / 2, what SkyColor() does
+	SKY_EQUIRECT = 1		// v = polar angle / pi, for lat-long data - texels shrink toward the poles by sin( theta )
+};
+
+struct skyImportanceOptions_t {
+	skyMapping_e mapping = SKY_EQUAL_AREA;
+	uint32_t maxWidth = 0;		// box filter down by powers of two until the tables are no wider than this, 0 keeps full res
+	uint32_t numThreads = 0;	// 0 uses every core
+};
+
+struct skyAliasEntry_t {
+	float threshold;	// keep this entry below it, else take the alias
+	uint32_t alias;
+};
+
+struct skySample_t {
+	glm::vec3 direction;
+	glm::vec2 uv;
+	float pdf;			// per steradian
+};
+
+class skyImportance_t {
+public:
+	// source image, and the tables built from it
+	uint32_t imageWidth = 0;
+	uint32_t imageHeight = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t factor = 1;		// image texels per table cell, along each axis
+	skyImportanceOptions_t options;
+	uint64_t contentHash = 0;
+
+	std::vector< float > func;						// luminance * solid angle weight, per cell
+	std::vector< float > conditionalCdf;			// height rows of width + 1
+	std::vector< float > marginalCdf;				// height + 1
+	std::vector< skyAliasEntry_t > conditionalAlias;// height rows of width
+	std::vector< skyAliasEntry_t > marginalAlias;	// height
+	float integral = 0.0f;							// mean of func - func / integral is the density over uv
+
+	// skyInvert - flips y on the way to and from directions, the tables don't change
+	bool invert = false;
+
+	// how the last Build() / BuildCached() went
+	struct timing_t {
+		double hashMs = 0.0;
+		double weightsMs = 0.0;	// downsample + luminance + solid angle
+		double tablesMs = 0.0;	// CDFs + alias tables
+		double cacheMs = 0.0;	// reading or writing the cache file
+		double totalMs = 0.0;
+		bool fromCache = false;
+	} timing;
+
+	bool Valid () const { return width != 0 && height != 0; }
+
+	size_t TableBytes () const {
+		return func.size() * sizeof( float ) + conditionalCdf.size() * sizeof( float ) + marginalCdf.size() * sizeof( float ) +
+			( conditionalAlias.size() + marginalAlias.size() ) * sizeof( skyAliasEntry_t );
+	}
+
+//===== Building ======================================================================================================
+	// always hashes the pixels - the hash is what Save() keys the cache file on
+	void Build ( const float * rgba, const uint32_t w, const uint32_t h, const skyImportanceOptions_t &opts = skyImportanceOptions_t() ) {
+		const auto tStart = std::chrono::high_resolution_clock::now();
+		const uint64_t hash = ContentHash( rgba, w, h, opts.numThreads );
+		const double hashMs = MillisecondsSince( tStart );
+		BuildKnownHash( rgba, w, h, hash, opts );
+		timing.hashMs = hashMs;
+		timing.totalMs = MillisecondsSince( tStart );
+	}
+
+	// the tables cached next to the EXR, if they were built from the same pixels with the same options - else build
+		// them, and write the cache for next time
+	void BuildCached ( const std::string &exrPath, const float * rgba, const uint32_t w, const uint32_t h, const skyImportanceOptions_t &opts = skyImportanceOptions_t() ) {
+		const auto tStart = std::chrono::high_resolution_clock::now();
+		const uint64_t hash = ContentHash( rgba, w, h, opts.numThreads );
+		const double hashMs = MillisecondsSince( tStart );
+		const std::string cachePath = CachePath( exrPath );
+
+		auto tStep = std::chrono::high_resolution_clock::now();
+		if ( Load( cachePath, hash, w, h, opts ) ) {
+			timing = timing_t();
+			timing.fromCache = true;
+			timing.hashMs = hashMs;
+			timing.cacheMs = MillisecondsSince( tStep );
+			timing.totalMs = MillisecondsSince( tStart );
+			return;
+		}
+
+		BuildKnownHash( rgba, w, h, hash, opts );
+		timing.hashMs = hashMs;
+
+		tStep = std::chrono::high_resolution_clock::now();
+		Save( cachePath );
+		timing.cacheMs = MillisecondsSince( tStep );
+		timing.totalMs = MillisecondsSince( tStart );
+	}
+
+	static std::string CachePath ( const std::string &exrPath ) { return exrPath + ".importance"; }
+
+	// over the decoded pixels, in fixed size chunks, so it comes out the same on any number of threads
+	static uint64_t ContentHash ( const float * rgba, const uint32_t w, const uint32_t h, const uint32_t numThreads = 0 ) {
+		const size_t numWords = size_t( w ) * h * 2; // 4 floats, 2 64-bit words per texel
+		constexpr size_t chunkWords = size_t( 1 ) << 18;
+		const size_t numChunks = ( numWords + chunkWords - 1 ) / chunkWords;
+		std::vector< uint64_t > chunkHashes( numChunks );
+		parallelForDynamic( numChunks, [ & ] ( size_t chunk, uint32_t ) {
+			const size_t begin = chunk * chunkWords;
+			const size_t end = std::min( begin + chunkWords, numWords );
+			uint64_t hash = 0x9E3779B97F4A7C15ull ^ chunk;
+			for ( size_t i = begin; i < end; i++ ) {
+				uint64_t word;
+				memcpy( &word, reinterpret_cast< const uint8_t * >( rgba ) + i * 8, 8 );
+				hash = Mix( hash ^ word );
+			}
+			chunkHashes[ chunk ] = hash;
+		}, 4, numThreads );
+		uint64_t hash = Mix( ( uint64_t( w ) << 32 ) | h );
+		for ( uint64_t chunkHash : chunkHashes ) {
+			hash = Mix( hash ^ chunkHash );
+		}
+		return hash == 0 ? 1 : hash; // 0 means no hash yet
+	}
+
+//===== Cache File ====================================================================================================
+	bool Save ( const std::string &path ) const {
+		std::ofstream out( path, std::ios::binary );
+		if ( !out ) return false;
+		const header_t header = Header();
+		out.write( ( const char * ) &header, sizeof( header ) );
+		out.write( ( const char * ) func.data(), func.size() * sizeof( float ) );
+		out.write( ( const char * ) conditionalCdf.data(), conditionalCdf.size() * sizeof( float ) );
+		out.write( ( const char * ) marginalCdf.data(), marginalCdf.size() * sizeof( float ) );
+		out.write( ( const char * ) conditionalAlias.data(), conditionalAlias.size() * sizeof( skyAliasEntry_t ) );
+		out.write( ( const char * ) marginalAlias.data(), marginalAlias.size() * sizeof( skyAliasEntry_t ) );
+		return bool( out );
+	}
+
+	// only succeeds for a file written from the same pixels, at the same size, with the same mapping and max width
+	bool Load ( const std::string &path, const uint64_t hash, const uint32_t w, const uint32_t h, const skyImportanceOptions_t &opts ) {
+		std::ifstream in( path, std::ios::binary );
+		if ( !in ) return false;
+		header_t header;
+		if ( !in.read( ( char * ) &header, sizeof( header ) ) ) return false;
+		if ( memcmp( header.magic, "SKYIMP01", 8 ) != 0 || header.contentHash != hash || header.imageWidth != w || header.imageHeight != h ||
+			header.mapping != opts.mapping || header.maxWidth != opts.maxWidth || header.width == 0 || header.height == 0 ) {
+			return false;
+		}
+		const size_t cells = size_t( header.width ) * header.height;
+		std::vector< float > inFunc( cells ), inConditionalCdf( cells + header.height ), inMarginalCdf( header.height + 1 );
+		std::vector< skyAliasEntry_t > inConditionalAlias( cells ), inMarginalAlias( header.height );
+		in.read( ( char * ) inFunc.data(), inFunc.size() * sizeof( float ) );
+		in.read( ( char * ) inConditionalCdf.data(), inConditionalCdf.size() * sizeof( float ) );
+		in.read( ( char * ) inMarginalCdf.data(), inMarginalCdf.size() * sizeof( float ) );
+		in.read( ( char * ) inConditionalAlias.data(), inConditionalAlias.size() * sizeof( skyAliasEntry_t ) );
+		in.read( ( char * ) inMarginalAlias.data(), inMarginalAlias.size() * sizeof( skyAliasEntry_t ) );
+		if ( !in ) return false; // truncated
+
+		imageWidth = w;
+		imageHeight = h;
+		width = header.width;
+		height = header.height;
+		factor = header.factor;
+		options = opts;
+		contentHash = hash;
+		integral = header.integral;
+		func = std::move( inFunc );
+		conditionalCdf = std::move( inConditionalCdf );
+		marginalCdf = std::move( inMarginalCdf );
+		conditionalAlias = std::move( inConditionalAlias );
+		marginalAlias = std::move( inMarginalAlias );
+		return true;
+	}
+
+//===== Sampling ======================================================================================================
+	// O(1) - a row off the marginal alias table, a cell off that row's, and what's left of each random number places
+		// the sample inside the cell
+	skySample_t Sample ( const float u1, const float u2 ) const {
+		float remapY, remapX;
+		const uint32_t y = SampleAlias( marginalAlias.data(), height, u1, remapY );
+		const uint32_t x = SampleAlias( conditionalAlias.data() + size_t( y ) * width, width, u2, remapX );
+		return MakeSample( glm::vec2( ( x + remapX ) / width, ( y + remapY ) / height ), func[ size_t( y ) * width + x ] );
+	}
+
+	// inverting the CDFs, a binary search per axis - slower, but it keeps stratified input stratified
+	skySample_t SampleCdf ( const float u1, const float u2 ) const {
+		float offsetY, offsetX;
+		const uint32_t y = SampleCdfRow( marginalCdf.data(), height, u1, offsetY );
+		const uint32_t x = SampleCdfRow( conditionalCdf.data() + size_t( y ) * ( width + 1 ), width, u2, offsetX );
+		return MakeSample( glm::vec2( ( x + offsetX ) / width, ( y + offsetY ) / height ), func[ size_t( y ) * width + x ] );
+	}
+
+	// density over the unit square of uv
+	float PdfUV ( const glm::vec2 uv ) const {
+		const uint32_t x = std::min( uint32_t( std::max( uv.x, 0.0f ) * width ), width - 1 );
+		const uint32_t y = std::min( uint32_t( std::max( uv.y, 0.0f ) * height ), height - 1 );
+		return func[ size_t( y ) * width + x ] / integral;
+	}
+
+	// per steradian, for a ray direction, e.g. for MIS against BSDF sampling
+	float Pdf ( const glm::vec3 direction ) const {
+		const glm::vec2 uv = DirectionToUV( direction );
+		const float jacobian = Jacobian( uv.y );
+		return ( jacobian > 0.0f ) ? PdfUV( uv ) / jacobian : 0.0f;
+	}
+
+	// SkyColor()'s lookup, run backwards
+	glm::vec3 UVToDirection ( const glm::vec2 uv ) const {
+		const float phi = ( uv.x * 2.0f - 1.0f ) * float( M_PI );
+		const float y = ( options.mapping == SKY_EQUIRECT ) ? -std::cos( float( M_PI ) * uv.y ) : uv.y * 2.0f - 1.0f;
+		const float r = std::sqrt( std::max( 0.0f, 1.0f - y * y ) );
+		return glm::vec3( r * std::sin( phi ), invert ? -y : y, r * std::cos( phi ) );
+	}
+
+	glm::vec2 DirectionToUV ( glm::vec3 direction ) const {
+		direction = glm::normalize( direction );
+		if ( invert ) direction.y = -direction.y;
+		const float u = ( std::atan2( direction.x, direction.z ) + float( M_PI ) ) / float( 2.0 * M_PI );
+		const float y = std::clamp( direction.y, -1.0f, 1.0f );
+		const float v = ( options.mapping == SKY_EQUIRECT ) ? std::acos( -y ) / float( M_PI ) : ( y + 1.0f ) * 0.5f;
+		return glm::vec2( std::min( u, 1.0f ), std::min( v, 1.0f ) );
+	}
+
+	// steradians per unit area of uv, at this v
+	float Jacobian ( const float v ) const {
+		return ( options.mapping == SKY_EQUIRECT ) ? float( 2.0 * M_PI * M_PI ) * std::sin( float( M_PI ) * v ) : float( 4.0 * M_PI );
+	}
+
+//===== Statistical Test ==============================================================================================
+	// Pearson's chi-square - samples binned over uv ( via the direction, so the mapping both ways is part of it ),
+		// against the probability the tables give each bin. Bins expecting fewer than 5 samples are pooled.
+	struct chiSquare_t {
+		double statistic = 0.0;
+		uint32_t dof = 0;
+		double pValue = 1.0;		// Wilson-Hilferty normal approximation
+		double pdfIntegral = 0.0;	// Pdf( direction ) over the sphere, cell by cell - should be 1
+		double maxRoundTrip = 0.0;	// largest | pdf from Sample() - Pdf( direction ) |, relative
+		bool pass = false;			// pValue above 0.001, and the pdf integrates to 1 within 1%
+	};
+
+	chiSquare_t ChiSquareTest ( const size_t numSamples, const uint32_t binsX = 64, const uint32_t binsY = 32, const bool useAlias = true, const uint64_t seed = 1 ) const {
+		chiSquare_t result;
+		const uint32_t numBins = binsX * binsY;
+
+		// expected probability per bin - each cell spread over the bins it overlaps, tables are constant over a cell
+		std::vector< double > expected( numBins, 0.0 );
+		const double cellProbabilityScale = 1.0 / ( double( integral ) * width * height );
+		for ( uint32_t y = 0; y < height; y++ ) {
+			const double cy0 = double( y ) / height, cy1 = double( y + 1 ) / height;
+			for ( uint32_t by = uint32_t( cy0 * binsY ); by < binsY && double( by ) / binsY < cy1; by++ ) {
+				const double oy = ( std::min( cy1, double( by + 1 ) / binsY ) - std::max( cy0, double( by ) / binsY ) ) * height;
+				for ( uint32_t x = 0; x < width; x++ ) {
+					const double p = func[ size_t( y ) * width + x ] * cellProbabilityScale * oy;
+					if ( p == 0.0 ) continue;
+					const double cx0 = double( x ) / width, cx1 = double( x + 1 ) / width;
+					for ( uint32_t bx = uint32_t( cx0 * binsX ); bx < binsX && double( bx ) / binsX < cx1; bx++ ) {
+						const double ox = ( std::min( cx1, double( bx + 1 ) / binsX ) - std::max( cx0, double( bx ) / binsX ) ) * width;
+						expected[ by * binsX + bx ] += p * ox;
+					}
+				}
+			}
+		}
+
+		// sample, per thread counts
+		const uint32_t numThreads = std::max( 1u, std::min( parallelThreadCount(), uint32_t( numSamples / 65536 + 1 ) ) );
+		std::vector< std::vector< uint64_t > > counts( numThreads, std::vector< uint64_t >( numBins, 0 ) );
+		std::vector< double > maxRoundTrip( numThreads, 0.0 );
+		parallelForRanges( numSamples, [ & ] ( size_t begin, size_t end, uint32_t t ) {
+			uint64_t state = seed * 0x9E3779B97F4A7C15ull + begin;
+			for ( size_t i = begin; i < end; i++ ) {
+				const float u1 = RandomFloat( state ), u2 = RandomFloat( state );
+				const skySample_t s = useAlias ? Sample( u1, u2 ) : SampleCdf( u1, u2 );
+				const glm::vec2 uv = DirectionToUV( s.direction );
+				const uint32_t bx = std::min( uint32_t( uv.x * binsX ), binsX - 1 );
+				const uint32_t by = std::min( uint32_t( uv.y * binsY ), binsY - 1 );
+				counts[ t ][ by * binsX + bx ]++;
+				if ( ( i & 255 ) == 0 && s.pdf > 0.0f ) { // same cell both ways, unless it landed right on an edge
+					const float pdf = Pdf( s.direction );
+					if ( std::abs( pdf - s.pdf ) > 1e-4f * s.pdf && PdfUV( uv ) != PdfUV( s.uv ) ) continue;
+					maxRoundTrip[ t ] = std::max( maxRoundTrip[ t ], double( std::abs( pdf - s.pdf ) / s.pdf ) );
+				}
+			}
+		}, numThreads );
+		for ( uint32_t t = 0; t < numThreads; t++ ) {
+			result.maxRoundTrip = std::max( result.maxRoundTrip, maxRoundTrip[ t ] );
+		}
+
+		double pooledObserved = 0.0, pooledExpected = 0.0;
+		uint32_t usedBins = 0;
+		for ( uint32_t b = 0; b < numBins; b++ ) {
+			double observed = 0.0;
+			for ( uint32_t t = 0; t < numThreads; t++ ) observed += double( counts[ t ][ b ] );
+			const double e = expected[ b ] * numSamples;
+			if ( e < 5.0 ) {
+				pooledObserved += observed;
+				pooledExpected += e;
+			} else {
+				result.statistic += ( observed - e ) * ( observed - e ) / e;
+				usedBins++;
+			}
+		}
+		if ( pooledExpected >= 5.0 ) {
+			result.statistic += ( pooledObserved - pooledExpected ) * ( pooledObserved - pooledExpected ) / pooledExpected;
+			usedBins++;
+		} else if ( pooledObserved > 0.0 && pooledExpected == 0.0 ) {
+			result.statistic = INFINITY; // samples where the tables say there can be none
+		}
+		result.dof = std::max( 1u, usedBins ) - 1;
+		if ( result.dof > 0 ) {
+			const double k = result.dof;
+			const double z = ( std::cbrt( result.statistic / k ) - ( 1.0 - 2.0 / ( 9.0 * k ) ) ) / std::sqrt( 2.0 / ( 9.0 * k ) );
+			result.pValue = 0.5 * std::erfc( z / std::sqrt( 2.0 ) );
+		}
+
+		// Pdf( direction ) at each cell's center, times the exact solid angle of the cell
+		std::vector< double > rowIntegrals( height );
+		parallelForRanges( height, [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t y = begin; y < end; y++ ) {
+				const double v0 = double( y ) / height, v1 = double( y + 1 ) / height;
+				const double solidAngle = ( ( options.mapping == SKY_EQUIRECT ) ? 2.0 * M_PI * ( std::cos( M_PI * v0 ) - std::cos( M_PI * v1 ) ) : 4.0 * M_PI * ( v1 - v0 ) ) / width;
+				double sum = 0.0;
+				for ( uint32_t x = 0; x < width; x++ ) {
+					sum += Pdf( UVToDirection( glm::vec2( ( x + 0.5f ) / width, ( y + 0.5f ) / height ) ) );
+				}
+				rowIntegrals[ y ] = sum * solidAngle;
+			}
+		}, numThreads );
+		for ( double rowIntegral : rowIntegrals ) result.pdfIntegral += rowIntegral;
+		result.pass = result.pValue > 0.001 && std::abs( result.pdfIntegral - 1.0 ) < 0.01;
+		return result;
+	}
+
+//===== Benchmark =====================================================================================================
+	// a synthetic sky - gradient, plus a small, very bright sun - at the given size, built on one thread and on all of
+		// them, then written to and read back from the cache, and sampled
+	struct benchmarkResult_t {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t threads = 0;
+		double singleMs = 0.0;		// build, one thread
+		double multiMs = 0.0;		// build, all threads
+		double hashMs = 0.0;
+		double saveMs = 0.0;
+		double loadMs = 0.0;		// cached path, including the hash
+		size_t tableBytes = 0;
+		double aliasSamplesPerSecond = 0.0;
+		double cdfSamplesPerSecond = 0.0;
+		chiSquare_t test;
+	};
+
+	static benchmarkResult_t Benchmark ( const uint32_t w = 8192, const uint32_t h = 4096, const skyImportanceOptions_t &opts = skyImportanceOptions_t() ) {
+		benchmarkResult_t result;
+		result.width = w;
+		result.height = h;
+		result.threads = opts.numThreads ? opts.numThreads : parallelThreadCount();
+
+		std::vector< float > sky( size_t( w ) * h * 4 );
+		parallelForRanges( h, [ & ] ( size_t begin, size_t end, uint32_t ) {
+			const glm::vec2 sun( 0.3f, 0.8f );
+			for ( size_t y = begin; y < end; y++ ) {
+				for ( uint32_t x = 0; x < w; x++ ) {
+					const glm::vec2 uv( ( x + 0.5f ) / w, ( y + 0.5f ) / h );
+					const float sunFalloff = std::exp( -glm::dot( uv - sun, uv - sun ) * 40000.0f );
+					float * texel = &sky[ 4 * ( y * w + x ) ];
+					texel[ 0 ] = 0.2f + 0.6f * uv.y + 50000.0f * sunFalloff;
+					texel[ 1 ] = 0.3f + 0.5f * uv.y + 45000.0f * sunFalloff;
+					texel[ 2 ] = 0.5f + 0.4f * uv.y + 40000.0f * sunFalloff;
+					texel[ 3 ] = 1.0f;
+				}
+			}
+		}, opts.numThreads );
+
+		skyImportance_t tables;
+		skyImportanceOptions_t single = opts;
+		single.numThreads = 1;
+		tables.Build( sky.data(), w, h, single );
+		result.singleMs = tables.timing.totalMs - tables.timing.hashMs;
+		result.hashMs = tables.timing.hashMs;
+		tables.BuildKnownHash( sky.data(), w, h, tables.contentHash, opts ); // same pixels, so no second hash
+		result.multiMs = tables.timing.totalMs;
+		result.tableBytes = tables.TableBytes();
+
+		// cache round trip, through a temp file
+		const std::string exrPath = ( std::filesystem::temp_directory_path() / "skyImportanceBenchmark.exr" ).string();
+		auto tStart = std::chrono::high_resolution_clock::now();
+		tables.Save( CachePath( exrPath ) );
+		result.saveMs = MillisecondsSince( tStart );
+		skyImportance_t cached;
+		cached.BuildCached( exrPath, sky.data(), w, h, opts );
+		result.loadMs = cached.timing.totalMs;
+		std::filesystem::remove( CachePath( exrPath ) );
+
+		// sampling throughput, single thread
+		constexpr size_t numSamples = 1 << 22;
+		uint64_t state = 7;
+		float sink = 0.0f;
+		[[maybe_unused]] volatile float escape; // the sums go out through here before each timer read, so the loops can't be dropped
+		tStart = std::chrono::high_resolution_clock::now();
+		for ( size_t i = 0; i < numSamples; i++ ) {
+			sink += tables.Sample( RandomFloat( state ), RandomFloat( state ) ).pdf;
+		}
+		escape = sink;
+		result.aliasSamplesPerSecond = numSamples / ( MillisecondsSince( tStart ) / 1000.0 );
+		tStart = std::chrono::high_resolution_clock::now();
+		for ( size_t i = 0; i < numSamples; i++ ) {
+			sink += tables.SampleCdf( RandomFloat( state ), RandomFloat( state ) ).pdf;
+		}
+		escape = sink;
+		result.cdfSamplesPerSecond = numSamples / ( MillisecondsSince( tStart ) / 1000.0 );
+		result.test = cached.ChiSquareTest( size_t( 1 ) << 24 );
+		return result;
+	}
+
+private:
+	struct header_t {
+		char magic[ 8 ] = { 'S', 'K', 'Y', 'I', 'M', 'P', '0', '1' };
+		uint64_t contentHash;
+		uint32_t imageWidth;
+		uint32_t imageHeight;
+		uint32_t width;
+		uint32_t height;
+		uint32_t factor;
+		uint32_t maxWidth;
+		uint32_t mapping;
+		float integral;
+	};
+
+	header_t Header () const {
+		header_t header;
+		header.contentHash = contentHash;
+		header.imageWidth = imageWidth;
+		header.imageHeight = imageHeight;
+		header.width = width;
+		header.height = height;
+		header.factor = factor;
+		header.maxWidth = options.maxWidth;
+		header.mapping = options.mapping;
+		header.integral = integral;
+		return header;
+	}
+
+	static double MillisecondsSince ( const std::chrono::high_resolution_clock::time_point tStart ) {
+		return std::chrono::duration< double, std::milli >( std::chrono::high_resolution_clock::now() - tStart ).count();
+	}
+
+	static uint64_t Mix ( uint64_t x ) { // splitmix64 finalizer
+		x = ( x ^ ( x >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+		x = ( x ^ ( x >> 27 ) ) * 0x94D049BB133111EBull;
+		return x ^ ( x >> 31 );
+	}
+
+	static float RandomFloat ( uint64_t &state ) {
+		state += 0x9E3779B97F4A7C15ull;
+		return float( Mix( state ) >> 40 ) * ( 1.0f / 16777216.0f );
+	}
+
+	// Build() for pixels whose ContentHash() the caller just computed - private, since a stale hash would end up keying
+		// the cache file for a different image
+	void BuildKnownHash ( const float * rgba, const uint32_t w, const uint32_t h, const uint64_t hash, const skyImportanceOptions_t &opts ) {
+		const auto tStart = std::chrono::high_resolution_clock::now();
+		timing = timing_t();
+		contentHash = hash;
+		imageWidth = w;
+		imageHeight = h;
+		options = opts;
+		factor = 1;
+		while ( options.maxWidth != 0 && ( imageWidth + factor - 1 ) / factor > options.maxWidth ) factor *= 2;
+		width = std::max( 1u, ( imageWidth + factor - 1 ) / factor );
+		height = std::max( 1u, ( imageHeight + factor - 1 ) / factor );
+
+		// per cell weight - mean luminance over the cell's texels, times the solid angle it covers
+		auto tStep = std::chrono::high_resolution_clock::now();
+		func.resize( size_t( width ) * height );
+		parallelForRanges( height, [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t y = begin; y < end; y++ ) {
+				const float solidAngle = ( options.mapping == SKY_EQUIRECT ) ? std::sin( float( M_PI ) * ( y + 0.5f ) / height ) : 1.0f;
+				const uint32_t y0 = uint32_t( y ) * factor;
+				const uint32_t y1 = std::min( y0 + factor, imageHeight );
+				for ( uint32_t x = 0; x < width; x++ ) {
+					const uint32_t x0 = x * factor;
+					const uint32_t x1 = std::min( x0 + factor, imageWidth );
+					float sum = 0.0f;
+					for ( uint32_t sy = y0; sy < y1; sy++ ) {
+						const float * texel = rgba + 4 * ( size_t( sy ) * imageWidth + x0 );
+						for ( uint32_t sx = x0; sx < x1; sx++, texel += 4 ) {
+							const float luminance = 0.2126f * texel[ 0 ] + 0.7152f * texel[ 1 ] + 0.0722f * texel[ 2 ];
+							sum += std::isfinite( luminance ) ? std::max( luminance, 0.0f ) : 0.0f;
+						}
+					}
+					func[ y * width + x ] = solidAngle * sum / float( ( x1 - x0 ) * ( y1 - y0 ) );
+				}
+			}
+		}, options.numThreads );
+		timing.weightsMs = MillisecondsSince( tStep );
+
+		tStep = std::chrono::high_resolution_clock::now();
+		BuildTables();
+		timing.tablesMs = MillisecondsSince( tStep );
+		timing.totalMs = MillisecondsSince( tStart );
+	}
+
+	// CDFs and alias tables from func - rows in parallel, then the marginal over the row sums
+	void BuildTables () {
+		conditionalCdf.resize( size_t( width + 1 ) * height );
+		conditionalAlias.resize( size_t( width ) * height );
+		marginalCdf.resize( height + 1 );
+		marginalAlias.resize( height );
+
+		// nothing to go on - all black, or not finite - fall back to uniform
+		double total = 0.0;
+		for ( float f : func ) total += f;
+		if ( !( total > 0.0 ) || !std::isfinite( total ) ) {
+			std::fill( func.begin(), func.end(), 1.0f );
+		}
+
+		std::vector< double > rowSums( height );
+		const uint32_t numThreads = options.numThreads ? options.numThreads : parallelThreadCount();
+		std::vector< std::vector< double > > scratch( numThreads );
+		std::vector< std::vector< uint32_t > > small( numThreads ), large( numThreads );
+		parallelForDynamic( height, [ & ] ( size_t y, uint32_t t ) {
+			const float * row = func.data() + y * width;
+			float * cdf = conditionalCdf.data() + y * ( width + 1 );
+			double sum = 0.0;
+			cdf[ 0 ] = 0.0f;
+			for ( uint32_t x = 0; x < width; x++ ) {
+				sum += row[ x ];
+				cdf[ x + 1 ] = float( sum );
+			}
+			rowSums[ y ] = sum;
+			NormalizeCdf( cdf, width, sum );
+			BuildAlias( row, width, sum, conditionalAlias.data() + y * width, scratch[ t ], small[ t ], large[ t ] );
+		}, 16, numThreads );
+
+		std::vector< float > rowFunc( height );
+		double sum = 0.0;
+		marginalCdf[ 0 ] = 0.0f;
+		for ( uint32_t y = 0; y < height; y++ ) {
+			rowFunc[ y ] = float( rowSums[ y ] );
+			sum += rowSums[ y ];
+			marginalCdf[ y + 1 ] = float( sum );
+		}
+		NormalizeCdf( marginalCdf.data(), height, sum );
+		BuildAlias( rowFunc.data(), height, sum, marginalAlias.data(), scratch[ 0 ], small[ 0 ], large[ 0 ] );
+		integral = float( sum / ( double( width ) * height ) );
+	}
+
+	// running sums to [ 0, 1 ], a zero row becomes uniform
+	static void NormalizeCdf ( float * cdf, const uint32_t n, const double sum ) {
+		for ( uint32_t i = 1; i <= n; i++ ) {
+			cdf[ i ] = ( sum > 0.0 ) ? float( cdf[ i ] / sum ) : float( i ) / n;
+		}
+		cdf[ n ] = 1.0f;
+	}
+
+	// Vose's method - weights scaled so the mean is 1, split into under and over full, each under full entry topped
+		// up from an over full one until everything is accounted for
+	static void BuildAlias ( const float * weights, const uint32_t n, const double sum, skyAliasEntry_t * table,
+		std::vector< double > &scaled, std::vector< uint32_t > &small, std::vector< uint32_t > &large ) {
+		scaled.resize( n );
+		small.clear();
+		large.clear();
+		for ( uint32_t i = 0; i < n; i++ ) {
+			scaled[ i ] = ( sum > 0.0 ) ? weights[ i ] * double( n ) / sum : 1.0;
+			( scaled[ i ] < 1.0 ? small : large ).push_back( i );
+		}
+		while ( !small.empty() && !large.empty() ) {
+			const uint32_t s = small.back(); small.pop_back();
+			const uint32_t l = large.back();
+			table[ s ] = { float( scaled[ s ] ), l };
+			scaled[ l ] -= 1.0 - scaled[ s ];
+			if ( scaled[ l ] < 1.0 ) {
+				large.pop_back();
+				small.push_back( l );
+			}
+		}
+		// what's left is full, up to rounding
+		for ( uint32_t i : large ) table[ i ] = { 1.0f, i };
+		for ( uint32_t i : small ) table[ i ] = { 1.0f, i };
+	}
+
+	// pick an entry, and reuse what's left of u as a fresh [ 0, 1 ) number
+	static uint32_t SampleAlias ( const skyAliasEntry_t * table, const uint32_t n, const float u, float &remapped ) {
+		const double scaled = double( u ) * n;
+		const uint32_t i = std::min( uint32_t( scaled ), n - 1 );
+		const double f = std::min( scaled - i, 1.0 );
+		const skyAliasEntry_t &entry = table[ i ];
+		if ( f < entry.threshold ) {
+			remapped = float( f / entry.threshold );
+			return i;
+		}
+		remapped = float( ( f - entry.threshold ) / ( 1.0 - entry.threshold ) );
+		return entry.alias;
+	}
+
+	// last entry of cdf at or below u, and how far into it u sits
+	static uint32_t SampleCdfRow ( const float * cdf, const uint32_t n, const float u, float &offset ) {
+		const uint32_t i = uint32_t( std::clamp< ptrdiff_t >( std::upper_bound( cdf, cdf + n + 1, u ) - cdf - 1, 0, n - 1 ) );
+		const float width = cdf[ i + 1 ] - cdf[ i ];
+		offset = ( width > 0.0f ) ? ( u - cdf[ i ] ) / width : 0.5f;
+		return i;
+	}
+
+	skySample_t MakeSample ( glm::vec2 uv, const float f ) const {
+		constexpr float oneMinusEpsilon = 0x1.fffffep-1f;
+		uv = glm::min( uv, glm::vec2( oneMinusEpsilon ) );
+		skySample_t s;
+		s.uv = uv;
+		s.direction = UVToDirection( uv );
+		const float jacobian = Jacobian( uv.y );
+		s.pdf = ( jacobian > 0.0f ) ? ( f / integral ) / jacobian : 0.0f;
+		return s;
+	}
+};
+
+#endif // SKY_IMPORTANCE_H
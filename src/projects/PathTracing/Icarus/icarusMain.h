@@ -30,7 +30,7 @@ public:
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		// click and drag handling
 		if ( !ImGui::GetIO().WantCaptureMouse ) {
@@ -80,23 +80,23 @@ public:
 		ZoneScoped;
 
 		{ // propagate data up through the mips
-			scopedTimer Start( "MIP" );
+			SCOPED_TIMER( "MIP" );
 			AdamUpdate( icarusState );
 		}
 
 		{ // the mipchain generated by Adam goes into the postprocessing step
-			scopedTimer Start( "Post" );
+			SCOPED_TIMER( "Post" );
 			PostProcess( icarusState );
 		}
 
 		{ // this samples the prepared image, and gives the click and drag interface
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			DrawViewer( icarusState, viewerState );
 		}
 
 		{	// this is now basically just a passthrough... extra copy? might make more sense to drop this and do it in a more straightforward way
 				// Basically the only thing it does is flip the image...
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 
@@ -110,7 +110,7 @@ public:
 
 		// this will stay very similiar
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Clear();
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 
@@ -124,7 +124,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		RayUpdate( icarusState );
 	}
@@ -135,7 +135,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
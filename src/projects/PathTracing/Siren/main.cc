@@ -1,4 +1,5 @@
 #include "../../../engine/engine.h"
+#include "sirenAnimation.h"
 
 // current state of the animation
 struct animation_t {
@@ -12,8 +13,11 @@ struct animation_t {
 	uint32_t numFrames = 720 * 2;
 	uint32_t frameNumber = 0;
 
-	// setup operations, then per-frame operations
-	json animationData;
+	// setup operations, then per-frame operations, compiled to keyframe tracks
+	sirenAnimation_t compiled;
+
+	// every frame's settings, evaluated up front when the animation is loaded
+	std::vector< sirenAnimationState_t > frames;
 };
 
 #define OUTPUT		0
@@ -45,8 +49,7 @@ struct sirenConfig_t {
 	float tilesMSLimit;
 	bool tileListNeedsUpdate = true;	// need to generate new tile list ( if e.g. tile size changes )
 	bool rendererNeedsUpdate = true;	// eventually to allow for the preview modes to render once between orientation etc changes
-	std::vector< ivec2 > tileOffsets;	// shuffled list of tiles
-	uint32_t tileOffset = 0;			// offset into tile list - start at first element
+	tileScheduler_t tiles;				// seeded tile order + batch sizing
 	int subpixelJitterMethod;
 	float exposure;
 	float renderFoV;
@@ -168,12 +171,51 @@ public:
 
 			// create the stack
 			PrepGlyphBuffer();
+
+			// animation files, without rendering them - compile, evaluate a shard of the frames, check and dump them
+			terminal.addCommand( { "animationCheck" }, {
+					{ "path", STRING, "The animation JSON." },
+					{ "shard", INT, "Which shard of the frames to evaluate." },
+					{ "numShards", INT, "How many shards the frames are split into." }
+				}, [=] ( args_t args ) {
+					sirenAnimation_t animation;
+					const bool compiled = animation.Load( args[ "path" ].stringData );
+					for ( auto& warning : animation.warnings ) terminal.addHistoryLine( terminal.csb.append( "  warning: " + warning ).flush() );
+					for ( auto& error : animation.errors ) terminal.addHistoryLine( terminal.csb.append( "  error: " + error ).flush() );
+					if ( !compiled ) return;
+
+					const uint32_t numShards = uint32_t( std::max( 1, int( args[ "numShards" ].data.x ) ) );
+					const uint32_t shard = uint32_t( std::clamp( int( args[ "shard" ].data.x ), 0, int( numShards ) - 1 ) );
+					uint32_t first, count;
+					animation.ShardRange( shard, numShards, first, count );
+					const std::vector< sirenAnimationState_t > frames = animation.EvaluateRange( first, count, animation.Baseline( CaptureAnimationState() ) );
+					const std::vector< string > problems = sirenAnimation_t::Validate( first, frames );
+					for ( auto& problem : problems ) terminal.addHistoryLine( terminal.csb.append( "  " + problem ).flush() );
+
+					const string csvPath = args[ "path" ].stringData + ".shard" + to_string( shard ) + ".csv";
+					sirenAnimation_t::WriteCSV( csvPath, first, frames );
+					terminal.addHistoryLine( terminal.csb.append( "  frames " + to_string( first ) + " to " + to_string( first + count ) + " of " + to_string( animation.numFrames ) +
+						", " + to_string( animation.tracks.size() ) + " tracks, " + to_string( problems.size() ) + " problems, written to " + csvPath ).flush() );
+				}, "Compile an animation file and evaluate one shard of its frames, without rendering." );
+
+			terminal.addCommand( { "animationBenchmark" }, {
+					{ "frames", INT, "Length of the synthetic animation." }
+				}, [=] ( args_t args ) {
+					const sirenAnimation_t::benchmarkResult_t result = sirenAnimation_t::Benchmark( uint32_t( std::max( 1, int( args[ "frames" ].data.x ) ) ) );
+					terminal.addHistoryLine( terminal.csb.append( "  " + to_string( result.numFrames ) + " frames, compiled in " + to_string( result.compileMs ) + "ms" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  JSON walk: " + to_string( int64_t( result.jsonFramesPerSecond ) ) + " frames/s" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  evaluate:  " + to_string( int64_t( result.evaluateFramesPerSecond ) ) + " frames/s" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  batch:     " + to_string( int64_t( result.batchFramesPerSecond ) ) + " frames/s" ).flush() );
+					if ( result.mismatches != 0 ) {
+						terminal.addHistoryLine( terminal.csb.append( "  " + to_string( result.mismatches ) + " frames differ between the JSON walk and the compiled tracks" ).flush() );
+					}
+				}, "Frames per second for JSON walking vs compiled keyframe evaluation, on a synthetic camera flight." );
 		}
 	}
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 		const uint8_t * state = SDL_GetKeyboardState( NULL );
 
 		// modifier keys state
@@ -539,7 +581,10 @@ public:
 				sirenConfig.tileListNeedsUpdate = true;
 			}
 
-			ImGui::SliderInt( "Tiles Between Queries", ( int * ) &sirenConfig.tilesBetweenQueries, 0, 45, "%d" );
+			ImGui::Checkbox( "Adaptive Batch Size", &sirenConfig.tiles.adaptiveBatches );
+			if ( !sirenConfig.tiles.adaptiveBatches ) {
+				ImGui::SliderInt( "Tiles Between Queries", ( int * ) &sirenConfig.tilesBetweenQueries, 1, 45, "%d" );
+			}
 			ImGui::SliderFloat( "Frame Time Limit (ms)", &sirenConfig.tilesMSLimit, 1.0f, 1000.0f, "%.3f", ImGuiSliderFlags_Logarithmic );
 
 			ImGui::EndChild();
@@ -714,7 +759,7 @@ public:
 		ZoneScoped;
 
 		{	// dispatch the shader to update the sky, if needed
-			scopedTimer Start( "Sky Update" );
+			SCOPED_TIMER( "Sky Update" );
 			static float skyTime_cache = 0.0f; // reenble latch once done debugging
 			if ( skyTime_cache != sirenConfig.skyTime ) {
 				skyTime_cache = sirenConfig.skyTime;
@@ -731,7 +776,7 @@ public:
 		}
 
 		{
-			scopedTimer Start( "Tiled Update" );
+			SCOPED_TIMER( "Tiled Update" );
 			const GLuint shader = shaders[ "Pathtrace" ];
 			glUseProgram( shader );
 
@@ -749,9 +794,14 @@ public:
 			// for monitoring number of completed tiles
 			uint32_t tilesThisFrame = 0;
 
+			sirenConfig.tiles.tilesBetweenQueries = sirenConfig.tilesBetweenQueries;
+			sirenConfig.tiles.tileTimeLimitMS = sirenConfig.tilesMSLimit;
+			float loopTime = 0.0f;
+
 			while ( 1 && !quitConfirm ) {
-				// run some N tiles out of the list
-				for ( uint32_t tile = 0; tile < sirenConfig.tilesBetweenQueries; tile++ ) {
+				// run some N tiles out of the list - N sized from the measured cost per tile, to land near the limit
+				const uint32_t batchSize = sirenConfig.tiles.NextBatchSize( loopTime );
+				for ( uint32_t tile = 0; tile < batchSize; tile++ ) {
 					const ivec2 tileOffset = GetTile(); // send uniforms ( unique per loop iteration )
 					glUniform2i( glGetUniformLocation( shader, "tileOffset" ),		tileOffset.x, tileOffset.y );
 					glUniform1i( glGetUniformLocation( shader, "wangSeed" ),		sirenConfig.wangSeeder() );
@@ -765,7 +815,9 @@ public:
 				tCheck = SubmitTimerAndWait( t[ 1 ] );
 
 				// evaluate how long it we've taken in the infinite loop, and break if 16.6ms is exceeded
-				float loopTime = ( tCheck - t0 ) / 1e6f; // convert ns -> ms
+				const float previousLoopTime = loopTime;
+				loopTime = ( tCheck - t0 ) / 1e6f; // convert ns -> ms
+				sirenConfig.tiles.ReportBatch( batchSize, loopTime - previousLoopTime );
 				if ( loopTime > sirenConfig.tilesMSLimit ) {
 					// update performance monitors with latest data
 					UpdatePerfMonitor( loopTime, tilesThisFrame );
@@ -776,7 +828,7 @@ public:
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
 			// potentially add stuff like dithering, SSAO, depth fog, etc
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			const GLuint shader = shaders[ "Postprocess" ];
 			glUseProgram( shader );
 
@@ -826,7 +878,7 @@ public:
 
 		// { // text rendering timestamp - required texture binds are handled internally
 		// 	if ( sirenConfig.showTimeStamp == true ) {
-		// 		scopedTimer Start( "Text Rendering" );
+		// 		SCOPED_TIMER( "Text Rendering" );
 		// 		textRenderer.Update( ImGui::GetIO().DeltaTime );
 		// 		textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 		// 		glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -860,9 +912,9 @@ public:
 		glBindTexture( GL_TEXTURE_2D, handle );
 		glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA32F, zeroes.Width(), zeroes.Height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, ( void * ) zeroes.GetImageDataBasePtr() );
 
-		// reset number of samples + tile offset
+		// reset number of samples + tile order, keeping the scheduler's timing estimate
 		sirenConfig.numFullscreenPasses = 0;
-		sirenConfig.tileOffset = 0;
+		sirenConfig.tiles.ResetAccumulation();
 
 		// reset time since last reset
 		sirenConfig.tLastReset = std::chrono::steady_clock::now();
@@ -964,131 +1016,110 @@ public:
 		if ( sirenConfig.tileListNeedsUpdate == true ) {
 			// construct the tile list ( runs at frame 0 and again any time the tilesize changes )
 			sirenConfig.tileListNeedsUpdate = false;
-			sirenConfig.tileOffset = 0;
-			sirenConfig.tileOffsets.resize( 0 );
-			for ( uint32_t x = 0; x <= sirenConfig.targetWidth; x += sirenConfig.tileSize ) {
-				for ( uint32_t y = 0; y <= sirenConfig.targetHeight; y += sirenConfig.tileSize ) {
-					sirenConfig.tileOffsets.push_back( ivec2( x, y ) );
-				}
-			}
-			// shuffle the generated array
-			std::random_device rd;
-			std::mt19937 rngen( rd() );
-			std::shuffle( sirenConfig.tileOffsets.begin(), sirenConfig.tileOffsets.end(), rngen );
-		} else { // check if the offset needs to be reset, this means a full pass has been completed
-			if ( ++sirenConfig.tileOffset == sirenConfig.tileOffsets.size() ) {
-				sirenConfig.tileOffset = 0;
-				sirenConfig.numFullscreenPasses++;
-				UpdateNoiseOffset();
-			}
+			sirenConfig.tiles.tileSize = sirenConfig.tileSize;
+			sirenConfig.tiles.imageWidth = sirenConfig.targetWidth;
+			sirenConfig.tiles.imageHeight = sirenConfig.targetHeight;
+			sirenConfig.tiles.RegenerateTileList();
+		}
+		// the scheduler starting a new round means a full pass has been completed
+		const uint32_t rounds = sirenConfig.tiles.SampleCount();
+		const ivec2 tile = sirenConfig.tiles.GetTile();
+		if ( sirenConfig.tiles.SampleCount() != rounds ) {
+			sirenConfig.numFullscreenPasses++;
+			UpdateNoiseOffset();
 		}
-		return sirenConfig.tileOffsets[ sirenConfig.tileOffset ];
+		return tile;
 	}
 
-	void ProcessAnimationJson ( json j ) {
-		ZoneScoped;
+	// the animatable subset of the current settings
+	sirenAnimationState_t CaptureAnimationState () {
+		sirenAnimationState_t state;
+		state.numSamples			= sirenConfig.animation.numSamples;
+		state.viewerPosition		= sirenConfig.viewerPosition;
+		state.basisX				= sirenConfig.basisX;
+		state.basisY				= sirenConfig.basisY;
+		state.basisZ				= sirenConfig.basisZ;
+		state.exposure				= sirenConfig.exposure;
+		state.raymarchMaxSteps		= sirenConfig.raymarchMaxSteps;
+		state.raymarchMaxBounces	= sirenConfig.raymarchMaxBounces;
+		state.raymarchMaxDistance	= sirenConfig.raymarchMaxDistance;
+		state.raymarchEpsilon		= sirenConfig.raymarchEpsilon;
+		state.raymarchUnderstep		= sirenConfig.raymarchUnderstep;
+		state.tonemapMode			= tonemap.tonemapMode;
+		state.gamma					= tonemap.gamma;
+		state.saturation			= tonemap.saturation;
+		state.colorTemperature		= tonemap.colorTemp;
+		state.thinLensEnable		= sirenConfig.thinLensEnable;
+		state.thinLensFocusDistance	= sirenConfig.thinLensFocusDistance;
+		state.thinLensJitterRadius	= sirenConfig.thinLensJitterRadius;
+		state.renderFoV				= sirenConfig.renderFoV;
+		state.uvScalar				= sirenConfig.uvScalar;
+		state.cameraType			= sirenConfig.cameraType;
+		state.skylightColor			= sirenConfig.skylightColor;
+		return state;
+	}
 
-		// use this for parsing setup ops + per-frame ops
-		for ( auto& element : j.items() ) {
-			string label = element.key();
-
-			// this is where any settings will change, based on the label of the operation
-			// cout << "got an operation: " << label << " with value " << element.value() << endl;
-
-		// operations that can be specified
-			if ( label == "numSamples" ) { // number of samples, dynamic per frame if desired
-				sirenConfig.animation.numSamples = element.value();
-			} else if ( label == "viewerPosition" ) { // viewer position
-				sirenConfig.viewerPosition.x = element.value()[ "x" ];
-				sirenConfig.viewerPosition.y = element.value()[ "y" ];
-				sirenConfig.viewerPosition.z = element.value()[ "z" ];
-			} else if ( label == "basisX" ) { // basis vectors
-				sirenConfig.basisX.x = element.value()[ "x" ];
-				sirenConfig.basisX.y = element.value()[ "y" ];
-				sirenConfig.basisX.z = element.value()[ "z" ];
-				sirenConfig.basisX = glm::normalize( sirenConfig.basisX );
-			} else if ( label == "basisY" ) {
-				sirenConfig.basisY.x = element.value()[ "x" ];
-				sirenConfig.basisY.y = element.value()[ "y" ];
-				sirenConfig.basisY.z = element.value()[ "z" ];
-				sirenConfig.basisY = glm::normalize( sirenConfig.basisY );
-			} else if ( label == "basisZ" ) {
-				sirenConfig.basisZ.x = element.value()[ "x" ];
-				sirenConfig.basisZ.y = element.value()[ "y" ];
-				sirenConfig.basisZ.z = element.value()[ "z" ];
-				sirenConfig.basisZ = glm::normalize( sirenConfig.basisZ );
-			} else if ( label == "LookAt" ) { // also support basis, position via LookAt()
-				vec3 eye = vec3( element.value()[ "eye" ][ "x" ], element.value()[ "eye" ][ "y" ], element.value()[ "eye" ][ "x" ] );
-				vec3 at = vec3( element.value()[ "at" ][ "x" ], element.value()[ "at" ][ "y" ], element.value()[ "at" ][ "x" ] );
-				vec3 up = vec3( element.value()[ "up" ][ "x" ], element.value()[ "up" ][ "y" ], element.value()[ "up" ][ "x" ] );
-				LookAt( eye, at, up );
-			} else if ( label == "clear" ) {
-				// when this works, will need to remove the default clear in the loop
-
-				// clear the buffer... partial clears, as well, via setting sample count lower than
-					// the existing values ( color accumulator alpha )- tbd semantics on this one, to support partial clears
-
-				// eventually maybe get into some kind of reprojection of the data in the buffer, tbd
-
-			} else if ( label == "exposure" ) { // exposure adjustment
-				sirenConfig.exposure = element.value();
-			} else if ( label == "raymarchMaxSteps" ) {
-				sirenConfig.raymarchMaxSteps = element.value();
-			} else if ( label == "raymarchMaxBounces" ) {
-				sirenConfig.raymarchMaxBounces = element.value();
-			} else if ( label == "raymarchMaxDistance" ) {
-				sirenConfig.raymarchMaxDistance = element.value();
-			} else if ( label == "raymarchEpsilon" ) {
-				sirenConfig.raymarchEpsilon = element.value();
-			} else if ( label == "raymarchUnderstep" ) {
-				sirenConfig.raymarchUnderstep = element.value();
-			} else if ( label == "tonemapMode" ) {
-				tonemap.tonemapMode = element.value();
-			} else if ( label == "gamma" ) {
-				tonemap.gamma = element.value();
-			} else if ( label == "saturation" ) {
-				tonemap.saturation = element.value();
-			} else if ( label == "colorTemperature" ) {
-				tonemap.colorTemp = element.value();
-			} else if ( label == "thinLensEnable" ) { // thin lens enable
-				sirenConfig.thinLensEnable = element.value();
-			} else if ( label == "thinLensFocusDistance" ) { // thin lens focus distance
-				sirenConfig.thinLensFocusDistance = element.value();
-			} else if ( label == "thinLensJitterRadius" ) { // thin lens focus effect intensity
-				sirenConfig.thinLensJitterRadius = element.value();
-			} else if ( label == "autofocus" ) {
-				// autofocus - take one sample, then set thin lens parameters... implementation tbd
-					// probably want to specify the x,y picking location
-
-			} else if ( label == "renderFoV" ) { // render field of view
-				sirenConfig.renderFoV = element.value();
-			} else if ( label == "uvScalar" ) { // uv scalar
-				sirenConfig.uvScalar = element.value();
-			} else if ( label == "cameraType" ) { // camera type
-				sirenConfig.cameraType = element.value();
-			} else if ( label == "skylightColor" ) { // skylight color - tbd if this is going to extend to handle skybox
-				sirenConfig.skylightColor.r = element.value()[ "r" ];
-				sirenConfig.skylightColor.g = element.value()[ "g" ];
-				sirenConfig.skylightColor.b = element.value()[ "b" ];
-			}
-		}
+	// only the parameters the animation drives are written, so the menus still work for everything else
+	void ApplyAnimationState ( const sirenAnimationState_t &state, const uint32_t mask ) {
+		ZoneScoped;
+		auto driven = [ mask ] ( int parameter ) { return ( mask >> parameter ) & 1u; };
+		if ( driven( ANIM_NUM_SAMPLES ) )				sirenConfig.animation.numSamples = state.numSamples;
+		if ( driven( ANIM_VIEWER_POSITION ) )			sirenConfig.viewerPosition = state.viewerPosition;
+		if ( driven( ANIM_BASIS_X ) )					sirenConfig.basisX = state.basisX;
+		if ( driven( ANIM_BASIS_Y ) )					sirenConfig.basisY = state.basisY;
+		if ( driven( ANIM_BASIS_Z ) )					sirenConfig.basisZ = state.basisZ;
+		if ( driven( ANIM_EXPOSURE ) )					sirenConfig.exposure = state.exposure;
+		if ( driven( ANIM_RAYMARCH_MAX_STEPS ) )		sirenConfig.raymarchMaxSteps = state.raymarchMaxSteps;
+		if ( driven( ANIM_RAYMARCH_MAX_BOUNCES ) )		sirenConfig.raymarchMaxBounces = state.raymarchMaxBounces;
+		if ( driven( ANIM_RAYMARCH_MAX_DISTANCE ) )		sirenConfig.raymarchMaxDistance = state.raymarchMaxDistance;
+		if ( driven( ANIM_RAYMARCH_EPSILON ) )			sirenConfig.raymarchEpsilon = state.raymarchEpsilon;
+		if ( driven( ANIM_RAYMARCH_UNDERSTEP ) )		sirenConfig.raymarchUnderstep = state.raymarchUnderstep;
+		if ( driven( ANIM_TONEMAP_MODE ) )				tonemap.tonemapMode = state.tonemapMode;
+		if ( driven( ANIM_GAMMA ) )						tonemap.gamma = state.gamma;
+		if ( driven( ANIM_SATURATION ) )				tonemap.saturation = state.saturation;
+		if ( driven( ANIM_COLOR_TEMPERATURE ) )			tonemap.colorTemp = state.colorTemperature;
+		if ( driven( ANIM_THIN_LENS_ENABLE ) )			sirenConfig.thinLensEnable = state.thinLensEnable;
+		if ( driven( ANIM_THIN_LENS_FOCUS_DISTANCE ) )	sirenConfig.thinLensFocusDistance = state.thinLensFocusDistance;
+		if ( driven( ANIM_THIN_LENS_JITTER_RADIUS ) )	sirenConfig.thinLensJitterRadius = state.thinLensJitterRadius;
+		if ( driven( ANIM_RENDER_FOV ) )				sirenConfig.renderFoV = state.renderFoV;
+		if ( driven( ANIM_UV_SCALAR ) )					sirenConfig.uvScalar = state.uvScalar;
+		if ( driven( ANIM_CAMERA_TYPE ) )				sirenConfig.cameraType = state.cameraType;
+		if ( driven( ANIM_SKYLIGHT_COLOR ) )			sirenConfig.skylightColor = state.skylightColor;
 	}
 
 	void InitiailizeAnimation ( string filename ) {
 		ZoneScoped;
 
-		// load the json from the specified file
-		json j; ifstream i ( filename ); i >> j; i.close();
-		sirenConfig.animation.animationData = j;
+		// load the json from the specified file, and compile it to keyframe tracks
+		animation_t &animation = sirenConfig.animation;
+		const bool compiled = animation.compiled.Load( filename );
+		for ( auto& warning : animation.compiled.warnings ) {
+			cout << "animation warning: " << warning << newline;
+		}
+		for ( auto& error : animation.compiled.errors ) {
+			cout << "animation error: " << error << newline;
+		}
+		if ( !compiled ) {
+			animation.animationRunning = false;
+			return;
+		}
 
 		// initial setup
-		sirenConfig.animation.numFrames		= j[ "setup" ][ "numFrames" ];
-		sirenConfig.animation.numSamples	= j[ "setup" ][ "numSamples" ];
+		animation.numFrames		= animation.compiled.numFrames;
+		animation.numSamples	= animation.compiled.numSamples;
+		animation.frameNumber	= 0;
 
 		// resolution, perf scalars are configured through the default config or on the menus
 
-		// do any desired setup operations
-		ProcessAnimationJson( sirenConfig.animation.animationData[ "setup" ] );
+		// evaluate every frame now, starting from the current settings + the setup operations
+		const sirenAnimationState_t baseline = animation.compiled.Baseline( CaptureAnimationState() );
+		animation.frames = animation.compiled.EvaluateAll( baseline );
+		cout << "animation compiled in " << animation.compiled.compileMs << "ms, " << animation.frames.size() << " frames" << newline;
+
+		// settings for frame 0
+		if ( !animation.frames.empty() ) {
+			ApplyAnimationState( animation.frames[ 0 ], animation.compiled.trackedMask );
+		}
 	}
 
 	void AnimationUpdate () {
@@ -1107,16 +1138,17 @@ public:
 					ResetAccumulators();
 				}
 
-				// update any desired operations for this frame - run only once, at frame init
-				ProcessAnimationJson( sirenConfig.animation.animationData[ to_string( sirenConfig.animation.frameNumber ) ] );
-
 				// increment frame number - 0..numFrames-1, so this will hit numFrames for the check
 				sirenConfig.animation.frameNumber++;
-				if ( sirenConfig.animation.frameNumber == sirenConfig.animation.numFrames ) {
+				if ( sirenConfig.animation.frameNumber >= sirenConfig.animation.numFrames ) {
 					cout << "finished at " << timeDateString() << " after " << TotalTime() / 1000.0f << " seconds" << endl;
 					abort(); // maybe do this in a nicer way
 				}
 
+				// settings for the frame we're starting - already evaluated, this is just a copy
+				if ( sirenConfig.animation.frameNumber < sirenConfig.animation.frames.size() ) {
+					ApplyAnimationState( sirenConfig.animation.frames[ sirenConfig.animation.frameNumber ], sirenConfig.animation.compiled.trackedMask );
+				}
 			}
 		}
 	}
@@ -1615,7 +1647,7 @@ public:
 		ClearColorAndDepth();		// if I just disable depth testing, this can disappear
 		ComputePasses();			// multistage update of displayTexture
 		{	// imgui is now used to show the content of the program directly via ImGui::ImageButton
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -0,0 +1,560 @@
+#pragma once
+#ifndef SIREN_ANIMATION_H
+#define SIREN_ANIMATION_H
+
+#include <cmath>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+#include <algorithm>
+
+#include "../../../utils/GLM/glm.hpp"
+#include "../../../utils/Serialization/JSON/json.hpp"
+#include "../../../engine/coreUtils/parallel.h"
+
+// Siren's animation files, compiled once into one sorted keyframe track per parameter. The file format is the
+	// same as before: a "setup" block, then objects keyed by frame number, holding the operations for that frame.
+	// A frame is evaluated with a binary search per track, with no JSON access and no string compares. Nothing
+	// here needs GL, so a sequence can be evaluated, checked and split into shards by an offline job.
+
+//===== Parameters ====================================================================================================
+// everything an animation can drive - the values that go out in SendBasePathtraceUniforms(), plus tonemap
+struct sirenAnimationState_t {
+	uint32_t numSamples = 256;
+	glm::vec3 viewerPosition = glm::vec3( 0.0f );
+	glm::vec3 basisX = glm::vec3( 1.0f, 0.0f, 0.0f );
+	glm::vec3 basisY = glm::vec3( 0.0f, 1.0f, 0.0f );
+	glm::vec3 basisZ = glm::vec3( 0.0f, 0.0f, 1.0f );
+	float exposure = 1.0f;
+	uint32_t raymarchMaxSteps = 100;
+	uint32_t raymarchMaxBounces = 10;
+	float raymarchMaxDistance = 100.0f;
+	float raymarchEpsilon = 0.001f;
+	float raymarchUnderstep = 1.0f;
+	int tonemapMode = 6;
+	float gamma = 1.1f;
+	float saturation = 1.0f;
+	float colorTemperature = 6500.0f;
+	bool thinLensEnable = false;
+	float thinLensFocusDistance = 1.0f;
+	float thinLensJitterRadius = 1.0f;
+	float renderFoV = 1.0f;
+	float uvScalar = 1.0f;
+	int cameraType = 0;
+	glm::vec3 skylightColor = glm::vec3( 0.0f );
+};
+
+enum sirenAnimationParameter_e {
+	ANIM_NUM_SAMPLES, ANIM_VIEWER_POSITION, ANIM_BASIS_X, ANIM_BASIS_Y, ANIM_BASIS_Z, ANIM_EXPOSURE,
+	ANIM_RAYMARCH_MAX_STEPS, ANIM_RAYMARCH_MAX_BOUNCES, ANIM_RAYMARCH_MAX_DISTANCE, ANIM_RAYMARCH_EPSILON,
+	ANIM_RAYMARCH_UNDERSTEP, ANIM_TONEMAP_MODE, ANIM_GAMMA, ANIM_SATURATION, ANIM_COLOR_TEMPERATURE,
+	ANIM_THIN_LENS_ENABLE, ANIM_THIN_LENS_FOCUS_DISTANCE, ANIM_THIN_LENS_JITTER_RADIUS, ANIM_RENDER_FOV,
+	ANIM_UV_SCALAR, ANIM_CAMERA_TYPE, ANIM_SKYLIGHT_COLOR, ANIM_NUM_PARAMETERS
+};
+
+// ints and bools always hold until the next key, the rest can interpolate
+enum sirenAnimationKind_e { ANIM_KIND_INT, ANIM_KIND_BOOL, ANIM_KIND_FLOAT, ANIM_KIND_VEC3, ANIM_KIND_DIRECTION };
+
+struct sirenAnimationParameterInfo_t {
+	const char * label;		// the operation name in the JSON
+	sirenAnimationKind_e kind;
+	const char * components;	// key names for the vector kinds
+};
+
+inline const sirenAnimationParameterInfo_t &sirenAnimationParameterInfo ( const int parameter ) {
+	static const sirenAnimationParameterInfo_t info[ ANIM_NUM_PARAMETERS ] = {
+		{ "numSamples",				ANIM_KIND_INT,			"" },
+		{ "viewerPosition",			ANIM_KIND_VEC3,			"xyz" },
+		{ "basisX",					ANIM_KIND_DIRECTION,	"xyz" },
+		{ "basisY",					ANIM_KIND_DIRECTION,	"xyz" },
+		{ "basisZ",					ANIM_KIND_DIRECTION,	"xyz" },
+		{ "exposure",				ANIM_KIND_FLOAT,		"" },
+		{ "raymarchMaxSteps",		ANIM_KIND_INT,			"" },
+		{ "raymarchMaxBounces",		ANIM_KIND_INT,			"" },
+		{ "raymarchMaxDistance",	ANIM_KIND_FLOAT,		"" },
+		{ "raymarchEpsilon",		ANIM_KIND_FLOAT,		"" },
+		{ "raymarchUnderstep",		ANIM_KIND_FLOAT,		"" },
+		{ "tonemapMode",			ANIM_KIND_INT,			"" },
+		{ "gamma",					ANIM_KIND_FLOAT,		"" },
+		{ "saturation",				ANIM_KIND_FLOAT,		"" },
+		{ "colorTemperature",		ANIM_KIND_FLOAT,		"" },
+		{ "thinLensEnable",			ANIM_KIND_BOOL,			"" },
+		{ "thinLensFocusDistance",	ANIM_KIND_FLOAT,		"" },
+		{ "thinLensJitterRadius",	ANIM_KIND_FLOAT,		"" },
+		{ "renderFoV",				ANIM_KIND_FLOAT,		"" },
+		{ "uvScalar",				ANIM_KIND_FLOAT,		"" },
+		{ "cameraType",				ANIM_KIND_INT,			"" },
+		{ "skylightColor",			ANIM_KIND_VEC3,			"rgb" }
+	};
+	return info[ parameter ];
+}
+
+// all values go through a vec3, scalars in x
+inline glm::vec3 sirenAnimationRead ( const sirenAnimationState_t &s, const int parameter ) {
+	switch ( parameter ) {
+		case ANIM_NUM_SAMPLES:				return glm::vec3( float( s.numSamples ), 0.0f, 0.0f );
+		case ANIM_VIEWER_POSITION:			return s.viewerPosition;
+		case ANIM_BASIS_X:					return s.basisX;
+		case ANIM_BASIS_Y:					return s.basisY;
+		case ANIM_BASIS_Z:					return s.basisZ;
+		case ANIM_EXPOSURE:					return glm::vec3( s.exposure, 0.0f, 0.0f );
+		case ANIM_RAYMARCH_MAX_STEPS:		return glm::vec3( float( s.raymarchMaxSteps ), 0.0f, 0.0f );
+		case ANIM_RAYMARCH_MAX_BOUNCES:		return glm::vec3( float( s.raymarchMaxBounces ), 0.0f, 0.0f );
+		case ANIM_RAYMARCH_MAX_DISTANCE:	return glm::vec3( s.raymarchMaxDistance, 0.0f, 0.0f );
+		case ANIM_RAYMARCH_EPSILON:			return glm::vec3( s.raymarchEpsilon, 0.0f, 0.0f );
+		case ANIM_RAYMARCH_UNDERSTEP:		return glm::vec3( s.raymarchUnderstep, 0.0f, 0.0f );
+		case ANIM_TONEMAP_MODE:				return glm::vec3( float( s.tonemapMode ), 0.0f, 0.0f );
+		case ANIM_GAMMA:					return glm::vec3( s.gamma, 0.0f, 0.0f );
+		case ANIM_SATURATION:				return glm::vec3( s.saturation, 0.0f, 0.0f );
+		case ANIM_COLOR_TEMPERATURE:		return glm::vec3( s.colorTemperature, 0.0f, 0.0f );
+		case ANIM_THIN_LENS_ENABLE:			return glm::vec3( s.thinLensEnable ? 1.0f : 0.0f, 0.0f, 0.0f );
+		case ANIM_THIN_LENS_FOCUS_DISTANCE:	return glm::vec3( s.thinLensFocusDistance, 0.0f, 0.0f );
+		case ANIM_THIN_LENS_JITTER_RADIUS:	return glm::vec3( s.thinLensJitterRadius, 0.0f, 0.0f );
+		case ANIM_RENDER_FOV:				return glm::vec3( s.renderFoV, 0.0f, 0.0f );
+		case ANIM_UV_SCALAR:				return glm::vec3( s.uvScalar, 0.0f, 0.0f );
+		case ANIM_CAMERA_TYPE:				return glm::vec3( float( s.cameraType ), 0.0f, 0.0f );
+		case ANIM_SKYLIGHT_COLOR:			return s.skylightColor;
+		default:							return glm::vec3( 0.0f );
+	}
+}
+
+inline void sirenAnimationWrite ( sirenAnimationState_t &s, const int parameter, const glm::vec3 v ) {
+	switch ( parameter ) {
+		case ANIM_NUM_SAMPLES:				s.numSamples = uint32_t( v.x ); break;
+		case ANIM_VIEWER_POSITION:			s.viewerPosition = v; break;
+		case ANIM_BASIS_X:					s.basisX = glm::normalize( v ); break;
+		case ANIM_BASIS_Y:					s.basisY = glm::normalize( v ); break;
+		case ANIM_BASIS_Z:					s.basisZ = glm::normalize( v ); break;
+		case ANIM_EXPOSURE:					s.exposure = v.x; break;
+		case ANIM_RAYMARCH_MAX_STEPS:		s.raymarchMaxSteps = uint32_t( v.x ); break;
+		case ANIM_RAYMARCH_MAX_BOUNCES:		s.raymarchMaxBounces = uint32_t( v.x ); break;
+		case ANIM_RAYMARCH_MAX_DISTANCE:	s.raymarchMaxDistance = v.x; break;
+		case ANIM_RAYMARCH_EPSILON:			s.raymarchEpsilon = v.x; break;
+		case ANIM_RAYMARCH_UNDERSTEP:		s.raymarchUnderstep = v.x; break;
+		case ANIM_TONEMAP_MODE:				s.tonemapMode = int( v.x ); break;
+		case ANIM_GAMMA:					s.gamma = v.x; break;
+		case ANIM_SATURATION:				s.saturation = v.x; break;
+		case ANIM_COLOR_TEMPERATURE:		s.colorTemperature = v.x; break;
+		case ANIM_THIN_LENS_ENABLE:			s.thinLensEnable = ( v.x != 0.0f ); break;
+		case ANIM_THIN_LENS_FOCUS_DISTANCE:	s.thinLensFocusDistance = v.x; break;
+		case ANIM_THIN_LENS_JITTER_RADIUS:	s.thinLensJitterRadius = v.x; break;
+		case ANIM_RENDER_FOV:				s.renderFoV = v.x; break;
+		case ANIM_UV_SCALAR:				s.uvScalar = v.x; break;
+		case ANIM_CAMERA_TYPE:				s.cameraType = int( v.x ); break;
+		case ANIM_SKYLIGHT_COLOR:			s.skylightColor = v; break;
+		default: break;
+	}
+}
+
+//===== Operation Parsing =============================================================================================
+namespace sirenAnimationOps {
+	struct op_t {
+		int parameter;
+		glm::vec3 value;
+	};
+
+	inline bool ReadNumber ( const nlohmann::json &j, float &out ) {
+		if ( !j.is_number() ) return false;
+		out = j.get< float >();
+		return true;
+	}
+
+	inline bool ReadVector ( const nlohmann::json &j, const char * components, glm::vec3 &out ) {
+		if ( !j.is_object() ) return false;
+		for ( int c = 0; c < 3; c++ ) {
+			auto it = j.find( std::string( 1, components[ c ] ) );
+			if ( it == j.end() || !ReadNumber( *it, out[ c ] ) ) return false;
+		}
+		return true;
+	}
+
+	// same basis construction as Siren::LookAt()
+	inline void LookAt ( const glm::vec3 eye, const glm::vec3 at, const glm::vec3 up, glm::vec3 basis[ 3 ] ) {
+		basis[ 2 ] = glm::normalize( at - eye );
+		basis[ 0 ] = glm::normalize( glm::cross( up, basis[ 2 ] ) );
+		basis[ 1 ] = glm::normalize( glm::cross( basis[ 2 ], basis[ 0 ] ) );
+	}
+
+	inline bool Finite ( const glm::vec3 v ) {
+		return std::isfinite( v.x ) && std::isfinite( v.y ) && std::isfinite( v.z );
+	}
+
+	// one JSON object of operations to a list of parameter writes, in the order they apply - this is the only place
+		// operation names are matched. Problems go in errors, if given, prefixed with where.
+	inline void Parse ( const nlohmann::json &ops, std::vector< op_t > &out, std::vector< std::string > * errors, const std::string &where ) {
+		auto report = [ & ] ( const std::string &message ) {
+			if ( errors ) errors->push_back( where + ": " + message );
+		};
+		if ( !ops.is_object() ) {
+			report( "expected an object of operations" );
+			return;
+		}
+		for ( auto& element : ops.items() ) {
+			const std::string &label = element.key();
+			const nlohmann::json &value = element.value();
+
+			if ( label == "LookAt" ) { // position and basis, together
+				glm::vec3 eye, at, up, basis[ 3 ];
+				auto e = value.find( "eye" ), a = value.find( "at" ), u = value.find( "up" );
+				if ( !value.is_object() || e == value.end() || a == value.end() || u == value.end() ||
+					!ReadVector( *e, "xyz", eye ) || !ReadVector( *a, "xyz", at ) || !ReadVector( *u, "xyz", up ) ) {
+					report( "LookAt needs eye, at and up, each with x, y and z" );
+					continue;
+				}
+				LookAt( eye, at, up, basis );
+				if ( !Finite( basis[ 0 ] ) || !Finite( basis[ 1 ] ) || !Finite( basis[ 2 ] ) ) {
+					report( "LookAt is degenerate ( eye == at, or up parallel to the view direction )" );
+					continue;
+				}
+				out.push_back( { ANIM_VIEWER_POSITION, eye } );
+				out.push_back( { ANIM_BASIS_X, basis[ 0 ] } );
+				out.push_back( { ANIM_BASIS_Y, basis[ 1 ] } );
+				out.push_back( { ANIM_BASIS_Z, basis[ 2 ] } );
+				continue;
+			}
+
+			// placeholders in the format, nothing to do yet
+			if ( label == "clear" || label == "autofocus" ) continue;
+
+			int parameter = -1;
+			for ( int p = 0; p < ANIM_NUM_PARAMETERS && parameter == -1; p++ ) {
+				if ( label == sirenAnimationParameterInfo( p ).label ) parameter = p;
+			}
+			if ( parameter == -1 ) {
+				report( "unknown operation \"" + label + "\"" );
+				continue;
+			}
+
+			const sirenAnimationParameterInfo_t &info = sirenAnimationParameterInfo( parameter );
+			glm::vec3 v( 0.0f );
+			bool ok = true;
+			switch ( info.kind ) {
+				case ANIM_KIND_BOOL:
+					ok = value.is_boolean();
+					if ( ok ) v.x = value.get< bool >() ? 1.0f : 0.0f;
+				break;
+				case ANIM_KIND_INT:
+				case ANIM_KIND_FLOAT:
+					ok = ReadNumber( value, v.x );
+				break;
+				case ANIM_KIND_VEC3:
+				case ANIM_KIND_DIRECTION:
+					ok = ReadVector( value, info.components, v );
+					if ( ok && info.kind == ANIM_KIND_DIRECTION && glm::dot( v, v ) == 0.0f ) ok = false;
+				break;
+			}
+			if ( !ok ) {
+				report( "bad value for \"" + label + "\"" );
+				continue;
+			}
+			out.push_back( { parameter, v } );
+		}
+	}
+}
+
+//===== Compiled Animation ============================================================================================
+class sirenAnimation_t {
+public:
+	enum interpolation_e { STEP, LINEAR };
+
+	struct track_t {
+		int parameter;
+		std::vector< uint32_t > frames;		// sorted, unique
+		std::vector< glm::vec3 > values;
+	};
+
+	uint32_t numFrames = 0;
+	uint32_t numSamples = 256;
+	interpolation_e interpolation = STEP;	// "interpolation" in setup - "step" ( default, how files always played ) or "linear"
+
+	std::vector< track_t > tracks;
+	std::vector< sirenAnimationOps::op_t > setup;	// applied once, ahead of every frame
+	uint32_t trackedMask = 0;	// bit per parameter, set if the setup or any frame writes it
+
+	std::vector< std::string > errors;		// the file can't be used as given
+	std::vector< std::string > warnings;	// it can, but probably isn't what was meant
+	double compileMs = 0.0;
+
+	bool Compile ( const nlohmann::json &j ) {
+		const auto tStart = std::chrono::high_resolution_clock::now();
+		*this = sirenAnimation_t();
+
+		auto s = j.find( "setup" );
+		if ( !j.is_object() || s == j.end() || !s->is_object() ) {
+			errors.push_back( "missing \"setup\" block" );
+			return false;
+		}
+		auto nf = s->find( "numFrames" ), ns = s->find( "numSamples" );
+		if ( nf == s->end() || !nf->is_number_unsigned() ) errors.push_back( "setup: numFrames must be a positive integer" );
+		else numFrames = nf->get< uint32_t >();
+		if ( ns == s->end() || !ns->is_number_unsigned() ) errors.push_back( "setup: numSamples must be a positive integer" );
+		else numSamples = ns->get< uint32_t >();
+		auto in = s->find( "interpolation" );
+		if ( in != s->end() ) {
+			if ( *in == "linear" ) interpolation = LINEAR;
+			else if ( *in != "step" ) warnings.push_back( "setup: interpolation should be \"step\" or \"linear\", using step" );
+		}
+
+		// the setup block also carries the frame count and the interpolation mode, which aren't operations
+		nlohmann::json setupOps = *s;
+		setupOps.erase( "numFrames" );
+		setupOps.erase( "interpolation" );
+		sirenAnimationOps::Parse( setupOps, setup, &errors, "setup" );
+		for ( auto& op : setup ) trackedMask |= 1u << op.parameter;
+
+		// gather keys per parameter - object keys come out in string order ( "10" before "2" ), so sort after
+		std::vector< std::vector< std::pair< uint32_t, glm::vec3 > > > keys( ANIM_NUM_PARAMETERS );
+		std::vector< sirenAnimationOps::op_t > ops;
+		for ( auto& frame : j.items() ) {
+			if ( frame.key() == "setup" ) continue;
+			uint32_t frameNumber = 0;
+			if ( !ParseFrameNumber( frame.key(), frameNumber ) ) {
+				errors.push_back( "\"" + frame.key() + "\" is not a frame number" );
+				continue;
+			}
+			if ( frameNumber >= numFrames ) {
+				warnings.push_back( "frame " + frame.key() + " is past the end of the animation ( " + std::to_string( numFrames ) + " frames )" );
+			}
+			ops.clear();
+			sirenAnimationOps::Parse( frame.value(), ops, &warnings, "frame " + frame.key() );
+			for ( auto& op : ops ) {
+				keys[ op.parameter ].push_back( { frameNumber, op.value } );
+			}
+		}
+
+		for ( int p = 0; p < ANIM_NUM_PARAMETERS; p++ ) {
+			if ( keys[ p ].empty() ) continue;
+			// stable, so where one frame writes a parameter twice ( LookAt, then basisX ) the later one wins
+			std::stable_sort( keys[ p ].begin(), keys[ p ].end(), [] ( const auto &a, const auto &b ) { return a.first < b.first; } );
+			track_t track;
+			track.parameter = p;
+			for ( auto& key : keys[ p ] ) {
+				if ( !track.frames.empty() && track.frames.back() == key.first ) {
+					track.values.back() = key.second;
+				} else {
+					track.frames.push_back( key.first );
+					track.values.push_back( key.second );
+				}
+			}
+			tracks.push_back( std::move( track ) );
+			trackedMask |= 1u << p;
+		}
+
+		compileMs = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::high_resolution_clock::now() - tStart ).count() / 1000.0;
+		return errors.empty();
+	}
+
+	bool Load ( const std::string &path ) {
+		std::ifstream file( path );
+		if ( !file.is_open() ) {
+			*this = sirenAnimation_t();
+			errors.push_back( "could not open " + path );
+			return false;
+		}
+		nlohmann::json j = nlohmann::json::parse( file, nullptr, false );
+		if ( j.is_discarded() ) {
+			*this = sirenAnimation_t();
+			errors.push_back( path + " is not valid JSON" );
+			return false;
+		}
+		return Compile( j );
+	}
+
+	// the state before frame 0 - defaults ( usually the current settings ) with the setup block applied
+	sirenAnimationState_t Baseline ( const sirenAnimationState_t &defaults ) const {
+		sirenAnimationState_t state = defaults;
+		state.numSamples = numSamples;
+		for ( auto& op : setup ) {
+			sirenAnimationWrite( state, op.parameter, op.value );
+		}
+		return state;
+	}
+
+	// keys hold until the next key on the same track, or interpolate toward it - before a track's first key,
+		// the baseline value stands
+	void Evaluate ( const uint32_t frame, const sirenAnimationState_t &baseline, sirenAnimationState_t &out ) const {
+		out = baseline;
+		for ( auto& track : tracks ) {
+			const size_t upper = size_t( std::upper_bound( track.frames.begin(), track.frames.end(), frame ) - track.frames.begin() );
+			if ( upper == 0 ) continue;
+			const size_t i = upper - 1;
+			const sirenAnimationKind_e kind = sirenAnimationParameterInfo( track.parameter ).kind;
+			if ( interpolation == STEP || upper == track.frames.size() || kind == ANIM_KIND_INT || kind == ANIM_KIND_BOOL ) {
+				sirenAnimationWrite( out, track.parameter, track.values[ i ] );
+			} else {
+				const float t = float( frame - track.frames[ i ] ) / float( track.frames[ upper ] - track.frames[ i ] );
+				sirenAnimationWrite( out, track.parameter, glm::mix( track.values[ i ], track.values[ upper ], t ) );
+			}
+		}
+	}
+
+	// every frame in [ first, first + count ), up front, split across threads
+	std::vector< sirenAnimationState_t > EvaluateRange ( const uint32_t first, const uint32_t count, const sirenAnimationState_t &baseline, const uint32_t numThreads = 0 ) const {
+		std::vector< sirenAnimationState_t > frames( count );
+		parallelForRanges( count, [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t i = begin; i < end; i++ ) {
+				Evaluate( first + uint32_t( i ), baseline, frames[ i ] );
+			}
+		}, numThreads );
+		return frames;
+	}
+
+	std::vector< sirenAnimationState_t > EvaluateAll ( const sirenAnimationState_t &baseline, const uint32_t numThreads = 0 ) const {
+		return EvaluateRange( 0, numFrames, baseline, numThreads );
+	}
+
+	// contiguous [ first, first + count ) for one of numShards machines - evaluation is independent per frame, so
+		// each shard only needs the file and its index
+	void ShardRange ( const uint32_t shard, const uint32_t numShards, uint32_t &first, uint32_t &count ) const {
+		const uint64_t begin = uint64_t( numFrames ) * shard / numShards;
+		const uint64_t end = uint64_t( numFrames ) * ( shard + 1 ) / numShards;
+		first = uint32_t( begin );
+		count = uint32_t( end - begin );
+	}
+
+	// one row per frame, every parameter - for checking a sequence before committing render time to it
+	static void WriteCSV ( const std::string &path, const uint32_t first, const std::vector< sirenAnimationState_t > &frames ) {
+		std::ofstream file( path );
+		file << "frame";
+		for ( int p = 0; p < ANIM_NUM_PARAMETERS; p++ ) {
+			const sirenAnimationParameterInfo_t &info = sirenAnimationParameterInfo( p );
+			if ( info.kind == ANIM_KIND_VEC3 || info.kind == ANIM_KIND_DIRECTION ) {
+				for ( int c = 0; c < 3; c++ ) file << "," << info.label << "." << info.components[ c ];
+			} else {
+				file << "," << info.label;
+			}
+		}
+		file << "\n";
+		for ( size_t f = 0; f < frames.size(); f++ ) {
+			file << first + f;
+			for ( int p = 0; p < ANIM_NUM_PARAMETERS; p++ ) {
+				const sirenAnimationParameterInfo_t &info = sirenAnimationParameterInfo( p );
+				const glm::vec3 v = sirenAnimationRead( frames[ f ], p );
+				file << "," << v.x;
+				if ( info.kind == ANIM_KIND_VEC3 || info.kind == ANIM_KIND_DIRECTION ) file << "," << v.y << "," << v.z;
+			}
+			file << "\n";
+		}
+	}
+
+	// frames that would render something broken - non-finite values, zero sample counts
+	static std::vector< std::string > Validate ( const uint32_t first, const std::vector< sirenAnimationState_t > &frames ) {
+		std::vector< std::string > problems;
+		for ( size_t f = 0; f < frames.size(); f++ ) {
+			for ( int p = 0; p < ANIM_NUM_PARAMETERS; p++ ) {
+				if ( !sirenAnimationOps::Finite( sirenAnimationRead( frames[ f ], p ) ) ) {
+					problems.push_back( "frame " + std::to_string( first + f ) + ": " + sirenAnimationParameterInfo( p ).label + " is not finite" );
+				}
+			}
+			if ( frames[ f ].numSamples == 0 ) {
+				problems.push_back( "frame " + std::to_string( first + f ) + ": numSamples is zero" );
+			}
+		}
+		return problems;
+	}
+
+	//===== Benchmark =================================================================================================
+	struct benchmarkResult_t {
+		uint32_t numFrames = 0;
+		double compileMs = 0.0;
+		double jsonFramesPerSecond = 0.0;		// walking the JSON per frame, like AnimationUpdate used to
+		double evaluateFramesPerSecond = 0.0;	// Evaluate(), one frame at a time
+		double batchFramesPerSecond = 0.0;		// EvaluateAll(), threaded
+		size_t mismatches = 0;					// step mode, JSON walk vs compiled, should be zero
+	};
+
+	// a camera flight with parameter changes riding along, keyed the way a hand-written file would be
+	static nlohmann::json SyntheticAnimation ( const uint32_t frames ) {
+		nlohmann::json j;
+		j[ "setup" ][ "numFrames" ] = frames;
+		j[ "setup" ][ "numSamples" ] = 64;
+		j[ "setup" ][ "exposure" ] = 1.5f;
+		for ( uint32_t f = 0; f < frames; f++ ) {
+			nlohmann::json ops = nlohmann::json::object();
+			const float t = float( f ) / float( frames );
+			if ( f % 4 == 0 ) {
+				ops[ "viewerPosition" ] = { { "x", 10.0f * std::cos( 6.28f * t ) }, { "y", 2.0f + t }, { "z", 10.0f * std::sin( 6.28f * t ) } };
+			}
+			if ( f % 48 == 0 ) {
+				ops[ "LookAt" ] = {
+					{ "eye", { { "x", 10.0f * std::cos( 6.28f * t ) }, { "y", 2.0f + t }, { "z", 10.0f * std::sin( 6.28f * t ) } } },
+					{ "at", { { "x", 0.0f }, { "y", 0.0f }, { "z", 0.0f } } },
+					{ "up", { { "x", 0.0f }, { "y", 1.0f }, { "z", 0.0f } } } };
+			}
+			if ( f % 10 == 0 ) ops[ "thinLensFocusDistance" ] = 5.0f + 3.0f * std::sin( 12.0f * t );
+			if ( f % 25 == 0 ) ops[ "renderFoV" ] = 0.8f + 0.4f * t;
+			if ( f % 100 == 0 ) ops[ "skylightColor" ] = { { "r", t }, { "g", 0.5f }, { "b", 1.0f - t } };
+			if ( f % 500 == 0 ) ops[ "thinLensEnable" ] = ( f / 500 ) % 2 == 0;
+			if ( !ops.empty() ) j[ std::to_string( f ) ] = ops;
+		}
+		return j;
+	}
+
+	static benchmarkResult_t Benchmark ( const uint32_t frames, const uint32_t numThreads = 0 ) {
+		benchmarkResult_t result;
+		result.numFrames = frames;
+		const nlohmann::json j = SyntheticAnimation( frames );
+		auto seconds = [] ( std::chrono::high_resolution_clock::time_point tStart ) {
+			return std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::high_resolution_clock::now() - tStart ).count() / 1e6;
+		};
+
+		sirenAnimation_t animation;
+		animation.Compile( j );
+		result.compileMs = animation.compileMs;
+		const sirenAnimationState_t baseline = animation.Baseline( sirenAnimationState_t() );
+
+		// the old way - look the frame up by string, walk its operations, accumulate into the running state
+		std::vector< sirenAnimationState_t > walked( frames );
+		std::vector< sirenAnimationOps::op_t > ops;
+		auto tStart = std::chrono::high_resolution_clock::now();
+		sirenAnimationState_t running = baseline;
+		for ( uint32_t f = 0; f < frames; f++ ) {
+			auto it = j.find( std::to_string( f ) );
+			if ( it != j.end() ) {
+				const nlohmann::json frameOps = *it; // ProcessAnimationJson() took it by value
+				ops.clear();
+				sirenAnimationOps::Parse( frameOps, ops, nullptr, "" );
+				for ( auto& op : ops ) sirenAnimationWrite( running, op.parameter, op.value );
+			}
+			walked[ f ] = running;
+		}
+		result.jsonFramesPerSecond = frames / std::max( 1e-9, seconds( tStart ) );
+
+		std::vector< sirenAnimationState_t > evaluated( frames );
+		tStart = std::chrono::high_resolution_clock::now();
+		for ( uint32_t f = 0; f < frames; f++ ) {
+			animation.Evaluate( f, baseline, evaluated[ f ] );
+		}
+		result.evaluateFramesPerSecond = frames / std::max( 1e-9, seconds( tStart ) );
+
+		tStart = std::chrono::high_resolution_clock::now();
+		const std::vector< sirenAnimationState_t > batch = animation.EvaluateAll( baseline, numThreads );
+		result.batchFramesPerSecond = frames / std::max( 1e-9, seconds( tStart ) );
+
+		for ( uint32_t f = 0; f < frames; f++ ) {
+			for ( int p = 0; p < ANIM_NUM_PARAMETERS; p++ ) {
+				if ( sirenAnimationRead( walked[ f ], p ) != sirenAnimationRead( evaluated[ f ], p ) ||
+					sirenAnimationRead( evaluated[ f ], p ) != sirenAnimationRead( batch[ f ], p ) ) {
+					result.mismatches++;
+					break;
+				}
+			}
+		}
+		return result;
+	}
+
+private:
+	static bool ParseFrameNumber ( const std::string &key, uint32_t &frame ) {
+		if ( key.empty() || key.length() > 9 ) return false;
+		frame = 0;
+		for ( char c : key ) {
+			if ( c < '0' || c > '9' ) return false;
+			frame = frame * 10 + uint32_t( c - '0' );
+		}
+		return true;
+	}
+};
+
+#endif // SIREN_ANIMATION_H
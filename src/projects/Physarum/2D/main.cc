@@ -1,4 +1,5 @@
 #include "../../../engine/engine.h"
+#include "../physarumCPU.h"
 
 struct preset_t {
 	float senseAngle;
@@ -92,13 +93,12 @@ public:
 				vec2 direction;
 			};
 
-			std::vector< agent_t > agentsInitialData;
+			// same distribution as before, filled in parallel by the CPU sim's seeding
+			physarum2D seeding;
+			seeding.Seed( physarumConfig.numAgents, physarumConfig.wangSeed() );
+			std::vector< agent_t > agentsInitialData( physarumConfig.numAgents );
 			size_t bufferSize = 4 * sizeof( GLfloat ) * physarumConfig.numAgents;
-			rng dist( -1.0f, 1.0f );
-
-			for ( uint32_t i = 0; i < physarumConfig.numAgents; i++ ) {
-				agentsInitialData.push_back( { { dist(), dist() }, glm::normalize( vec2( dist(), dist() ) ) } );
-			}
+			seeding.CopyAgents( ( float * ) agentsInitialData.data() );
 
 			glGenBuffers( 1, &agentSSBO );
 			glBindBuffer( GL_SHADER_STORAGE_BUFFER, agentSSBO );
@@ -113,12 +113,36 @@ public:
 			opts.textureType	= GL_TEXTURE_2D;
 			textureManager.Add( "Pheremone Continuum Buffer 0", opts );
 			textureManager.Add( "Pheremone Continuum Buffer 1", opts );
+
+			// the same presets on the CPU sim, at this project's map size
+			terminal.active = false;
+			terminal.addCommand( { "physarumBenchmark" }, {
+					{ "preset", INT, "Index into presets.json." },
+					{ "agents", INT, "Number of agents." },
+					{ "steps", INT, "Number of steps to run." }
+				}, [=] ( args_t args ) {
+					const std::vector< physarumPreset_t > cpuPresets = LoadPhysarumPresets( "src/projects/Physarum/presets.json" );
+					const int index = std::clamp( int( args[ "preset" ].data.x ), 0, int( cpuPresets.size() ) - 1 );
+					const physarumBenchmark_t result = physarum2D::Benchmark( physarumConfig.dimensionX, physarumConfig.dimensionY, uint32_t( std::max( 1, int( args[ "agents" ].data.x ) ) ), cpuPresets[ index ], uint32_t( std::max( 1, int( args[ "steps" ].data.x ) ) ) );
+					terminal.addLineBreak();
+					terminal.addHistoryLine( terminal.csb.append( "Physarum Benchmark ", 3 ).append( "[ preset " + to_string( index ) + ", " + GetWithThousandsSeparator( result.agents ) + " agents at " + to_string( physarumConfig.dimensionX ) + "x" + to_string( physarumConfig.dimensionY ) + ", " + to_string( result.steps ) + " steps, " + to_string( result.threads ) + " threads ]", GREY_DD ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  agents: " + GetWithThousandsSeparator( size_t( result.agentStepsPerSecond ) ) + " agent-steps/sec" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  diffuse and decay: " + GetWithThousandsSeparator( size_t( result.cellsPerSecond ) ) + " cells/sec" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  trail: mean " + to_string( result.trail.mean ) + ", max " + GetWithThousandsSeparator( result.trail.max ) + ", coverage " + to_string( result.trail.coverage ) ).flush() );
+					terminal.addLineBreak();
+				}, "Run a preset on the CPU Physarum sim, seeded the same every time, and report agent-steps/sec." );
 		}
 	}
 
 	void HandleCustomEvents () {
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 		// application specific controls
+
+		// get new data into the input handler
+		inputHandler.update();
+
+		// pass any signals into the terminal
+		terminal.update( inputHandler );
 	}
 
 	void ImguiPass () {
@@ -244,14 +268,14 @@ public:
 	}
 
 	void DrawAPIGeometry () {
-		ZoneScoped; scopedTimer Start( "API Geometry" );
+		ZoneScoped; SCOPED_TIMER( "API Geometry" );
 	}
 
 	void ComputePasses () {
 		ZoneScoped;
 
 		{ // update agents, held in the SSBO
-			scopedTimer Start( "Agent Sim" );
+			SCOPED_TIMER( "Agent Sim" );
 
 			// send the simulation parameters
 			glUseProgram( shaders[ "Agents" ] );
@@ -274,7 +298,7 @@ public:
 		}
 
 		{ // dummy draw - draw something into accumulatorTexture
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 
 			glUseProgram( shaders[ "Buffer Copy" ] );
@@ -288,7 +312,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -297,7 +321,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -316,7 +340,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		// run the shader to do the gaussian blur
 		glUseProgram( shaders[ "Diffuse and Decay" ] );
@@ -339,7 +363,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -1,4 +1,5 @@
 #include "../../../engine/engine.h"
+#include "../physarumCPU.h"
 
 struct preset_t {
 	float senseAngle;
@@ -135,6 +136,25 @@ public:
 				}, "Report the state of the viewer."
 			);
 
+			// the same presets on the CPU sim - the map size is an argument, since the full volume is slow on the CPU
+			terminal.addCommand( { "physarumBenchmark" }, {
+					{ "preset", INT, "Index into presets.json." },
+					{ "agents", INT, "Number of agents." },
+					{ "steps", INT, "Number of steps to run." },
+					{ "size", INT, "Edge length of the volume." }
+				}, [=] ( args_t args ) {
+					const std::vector< physarumPreset_t > cpuPresets = LoadPhysarumPresets( "src/projects/Physarum/3D/presets.json" );
+					const int index = std::clamp( int( args[ "preset" ].data.x ), 0, int( cpuPresets.size() ) - 1 );
+					const uint32_t size = uint32_t( std::max( 3, int( args[ "size" ].data.x ) ) );
+					const physarumBenchmark_t result = physarum3D::Benchmark( size, size, size, uint32_t( std::max( 1, int( args[ "agents" ].data.x ) ) ), cpuPresets[ index ], uint32_t( std::max( 1, int( args[ "steps" ].data.x ) ) ) );
+					terminal.addLineBreak();
+					terminal.addHistoryLine( terminal.csb.append( "Physarum Benchmark ", 3 ).append( "[ preset " + to_string( index ) + ", " + GetWithThousandsSeparator( result.agents ) + " agents at " + to_string( size ) + "^3, " + to_string( result.steps ) + " steps, " + to_string( result.threads ) + " threads ]", GREY_DD ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  agents: " + GetWithThousandsSeparator( size_t( result.agentStepsPerSecond ) ) + " agent-steps/sec" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  diffuse and decay: " + GetWithThousandsSeparator( size_t( result.cellsPerSecond ) ) + " cells/sec" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  trail: mean " + to_string( result.trail.mean ) + ", max " + GetWithThousandsSeparator( result.trail.max ) + ", coverage " + to_string( result.trail.coverage ) ).flush() );
+					terminal.addLineBreak();
+				}, "Run a preset on the CPU Physarum sim, seeded the same every time, and report agent-steps/sec." );
+
 			// other commands?
 				// seeding
 				// stamping
@@ -199,7 +219,7 @@ public:
 	}
 
 	void HandleCustomEvents () {
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 		// application specific controls
 
 		// get new data into the input handler
@@ -423,7 +443,7 @@ public:
 	}
 
 	void DrawAPIGeometry () {
-		ZoneScoped; scopedTimer Start( "API Geometry" );
+		ZoneScoped; SCOPED_TIMER( "API Geometry" );
 
 	}
 
@@ -431,7 +451,7 @@ public:
 		ZoneScoped;
 
 		if ( physarumConfig.runSim ) { // update agents, held in the SSBO
-			scopedTimer Start( "Agent Sim" );
+			SCOPED_TIMER( "Agent Sim" );
 
 			// send the simulation parameters
 			const GLuint shader = shaders[ "Agents" ];
@@ -454,7 +474,7 @@ public:
 		}
 
 		{ // dummy draw - draw something into accumulatorTexture
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 
 			const GLuint shader = shaders[ "Draw" ];
@@ -480,7 +500,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -489,7 +509,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Clear();
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 
@@ -512,7 +532,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		if ( physarumConfig.runSim ) {
 			// run the shader to do the gaussian blur
@@ -537,7 +557,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
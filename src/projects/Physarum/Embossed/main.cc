@@ -1,4 +1,5 @@
 #include "../../../engine/engine.h"
+#include "../physarumCPU.h"
 
 struct preset_t {
 	float senseAngle;
@@ -96,13 +97,12 @@ public:
 				vec2 direction;
 			};
 
-			std::vector< agent_t > agentsInitialData;
+			// same distribution as before, filled in parallel by the CPU sim's seeding
+			physarum2D seeding;
+			seeding.Seed( physarumConfig.numAgents, physarumConfig.wangSeed() );
+			std::vector< agent_t > agentsInitialData( physarumConfig.numAgents );
 			size_t bufferSize = 4 * sizeof( GLfloat ) * physarumConfig.numAgents;
-			rng dist( -1.0f, 1.0f );
-
-			for ( uint32_t i = 0; i < physarumConfig.numAgents; i++ ) {
-				agentsInitialData.push_back( { { dist(), dist() }, glm::normalize( vec2( dist(), dist() ) ) } );
-			}
+			seeding.CopyAgents( ( float * ) agentsInitialData.data() );
 
 			glGenBuffers( 1, &agentSSBO );
 			glBindBuffer( GL_SHADER_STORAGE_BUFFER, agentSSBO );
@@ -124,7 +124,7 @@ public:
 	}
 
 	void HandleCustomEvents () {
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 		// application specific controls
 
 		// // current state of the whole keyboard
@@ -266,14 +266,14 @@ public:
 	}
 
 	void DrawAPIGeometry () {
-		ZoneScoped; scopedTimer Start( "API Geometry" );
+		ZoneScoped; SCOPED_TIMER( "API Geometry" );
 	}
 
 	void ComputePasses () {
 		ZoneScoped;
 
 		{ // update agents, held in the SSBO
-			scopedTimer Start( "Agent Sim" );
+			SCOPED_TIMER( "Agent Sim" );
 
 			// send the simulation parameters
 			glUseProgram( shaders[ "Agents" ] );
@@ -296,7 +296,7 @@ public:
 		}
 
 		{ // dummy draw - draw something into accumulatorTexture
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 
 			glUseProgram( shaders[ "Buffer Copy" ] );
@@ -319,7 +319,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -328,14 +328,14 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 		}
 
 		{ // show trident with current orientation
-			// scopedTimer Start( "Trident" );
+			// SCOPED_TIMER( "Trident" );
 			// trident.Update( textureManager.Get( "Display Texture" ) );
 			// glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 		}
@@ -352,7 +352,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		// run the shader to do the gaussian blur
 		glUseProgram( shaders[ "Diffuse and Decay" ] );
@@ -375,7 +375,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -0,0 +1,1048 @@
+#pragma once
+#ifndef PHYSARUM_CPU_H
+#define PHYSARUM_CPU_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#include "../../utils/GLM/glm.hpp"
+#include "../../utils/Serialization/JSON/json.hpp"
+#include "../../engine/coreUtils/parallel.h"
+
+// Headless CPU version of the Physarum agent sims - the 2D agents ( 2D, 2.5D, Embossed ) and the 3D basis agents
+	// agents are held as separate arrays per component, and stepped 8 at a time. Sensing reads the map as it stood
+	// after diffuse and decay, and the deposits are binned by band of the map, per thread, then added by whichever
+	// thread owns that band - so there are no atomics, and a run with a given seed gives the same map on any number
+	// of threads. Diffuse and decay is the same 1-2-1 kernel as the shaders, applied one axis at a time.
+
+// same fields as presets.json - the 3D presets have no writeBack, the 3D agents always keep their new basis
+struct physarumPreset_t {
+	float senseAngle = 1.6163f;
+	float senseDistance = 0.005f;
+	float turnAngle = 1.9923f;
+	float stepSize = 0.0005f;
+	float decayFactor = 0.96f;
+	uint32_t depositAmount = 65400;
+	bool writeBack = true;
+};
+
+inline std::vector< physarumPreset_t > LoadPhysarumPresets ( const std::string &path ) {
+	std::vector< physarumPreset_t > presets;
+	std::ifstream i( path );
+	if ( !i.good() ) return presets;
+	nlohmann::json j; i >> j; i.close();
+	for ( auto& data : j[ "PhysarumPresets" ] ) {
+		physarumPreset_t preset;
+		preset.senseAngle		= data[ "senseAngle" ];
+		preset.senseDistance	= data[ "senseDistance" ];
+		preset.turnAngle		= data[ "turnAngle" ];
+		preset.stepSize			= data[ "stepSize" ];
+		preset.decayFactor		= data[ "decayFactor" ];
+		preset.depositAmount	= data[ "depositAmount" ];
+		if ( data.contains( "writeBack" ) ) {
+			preset.writeBack	= data[ "writeBack" ];
+		}
+		presets.push_back( preset );
+	}
+	return presets;
+}
+
+struct physarumTrailStats_t {
+	double mean = 0.0;
+	uint32_t max = 0;
+	double coverage = 0.0;		// fraction of cells that are nonzero
+};
+
+struct physarumBenchmark_t {
+	uint32_t agents = 0;
+	uint32_t steps = 0;
+	uint32_t threads = 0;
+	size_t cells = 0;
+	double agentSeconds = 0.0;		// sense, rotate, move, deposit
+	double diffuseSeconds = 0.0;	// diffuse and decay
+	double agentStepsPerSecond = 0.0;
+	double cellsPerSecond = 0.0;
+	physarumTrailStats_t trail;
+};
+
+//=============================================================================
+//==== Shared Kernels =========================================================
+//=============================================================================
+
+namespace physarum {
+	// counter-based - splitmix64 finalizer, used to derive per-step seeds from the run seed
+	inline uint64_t Hash ( uint64_t seed, uint64_t a ) {
+		uint64_t z = seed + a * 0x9e3779b97f4a7c15ull;
+		z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+		z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+		return z ^ ( z >> 31 );
+	}
+
+	// same as wangHash() in the agent shaders
+	inline uint32_t WangHash ( uint32_t &seed ) {
+		seed = ( seed ^ 61u ) ^ ( seed >> 16 );
+		seed *= 9u;
+		seed = seed ^ ( seed >> 4 );
+		seed *= 0x27d4eb2du;
+		seed = seed ^ ( seed >> 15 );
+		return seed;
+	}
+
+	// [ 0, 1 ) from the top 24 bits, so the 8-wide path ( signed conversion ) gets the same float
+	inline float RandomFloat ( uint32_t &seed ) {
+		return float( WangHash( seed ) >> 8 ) * ( 1.0f / 16777216.0f );
+	}
+
+	// float to uint, as uint( decayFactor * g ) does in the shader - clamped, so 2^32 can't come back as 0
+	inline uint32_t ToUint ( float f ) {
+		return uint32_t( std::min( f, 4294967040.0f ) );
+	}
+
+	// mat3 from the shaders' mathUtils.h
+	inline glm::mat3 Rotate3D ( const float angle, const glm::vec3 axis ) {
+		const glm::vec3 a = glm::normalize( axis );
+		const float s = std::sin( angle );
+		const float c = std::cos( angle );
+		const float r = 1.0f - c;
+		return glm::mat3(
+			a.x * a.x * r + c,
+			a.y * a.x * r + a.z * s,
+			a.z * a.x * r - a.y * s,
+			a.x * a.y * r - a.z * s,
+			a.y * a.y * r + c,
+			a.z * a.y * r + a.x * s,
+			a.x * a.z * r + a.y * s,
+			a.y * a.z * r - a.x * s,
+			a.z * a.z * r + c
+		);
+	}
+
+	// one row of the map as doubles - sums of up to 64 uint32 values are still exact
+	inline void LoadRow ( const uint32_t * src, double * dst, const int w ) {
+		int x = 0;
+	#ifdef __AVX__
+		// flip the sign bit, convert as signed, add 2^31 back
+		const __m128i bias = _mm_set1_epi32( int( 0x80000000u ) );
+		const __m256d offset = _mm256_set1_pd( 2147483648.0 );
+		for ( ; x + 4 <= w; x += 4 ) {
+			const __m128i v = _mm_xor_si128( _mm_loadu_si128( ( const __m128i * ) ( src + x ) ), bias );
+			_mm256_storeu_pd( dst + x, _mm256_add_pd( _mm256_cvtepi32_pd( v ), offset ) );
+		}
+	#endif
+		for ( ; x < w; x++ ) {
+			dst[ x ] = double( src[ x ] );
+		}
+	}
+
+	// sums / weight, floored as the shader's integer divide, then decayed
+	inline void DecayRow ( const double * sums, uint32_t * dst, const int w, const double inverseWeight, const float decay ) {
+		int x = 0;
+	#ifdef __AVX__
+		const __m256d scale = _mm256_set1_pd( inverseWeight );
+		const __m256 d = _mm256_set1_ps( decay );
+		const __m256 limit = _mm256_set1_ps( 4294967040.0f );
+		const __m256 half = _mm256_set1_ps( 2147483648.0f );
+		for ( ; x + 8 <= w; x += 8 ) {
+			const __m128 lo = _mm256_cvtpd_ps( _mm256_floor_pd( _mm256_mul_pd( _mm256_loadu_pd( sums + x ), scale ) ) );
+			const __m128 hi = _mm256_cvtpd_ps( _mm256_floor_pd( _mm256_mul_pd( _mm256_loadu_pd( sums + x + 4 ), scale ) ) );
+			const __m256 f = _mm256_min_ps( _mm256_mul_ps( d, _mm256_insertf128_ps( _mm256_castps128_ps256( lo ), hi, 1 ) ), limit );
+			// unsigned truncation - take 2^31 off of the big ones, convert as signed, and set the top bit back
+			const __m256 big = _mm256_cmp_ps( f, half, _CMP_GE_OQ );
+			const __m256i i = _mm256_cvttps_epi32( _mm256_sub_ps( f, _mm256_and_ps( big, half ) ) );
+			const __m256 topBit = _mm256_and_ps( big, _mm256_castsi256_ps( _mm256_set1_epi32( int( 0x80000000u ) ) ) );
+			_mm256_storeu_si256( ( __m256i * ) ( dst + x ), _mm256_castps_si256( _mm256_or_ps( _mm256_castsi256_ps( i ), topBit ) ) );
+		}
+	#endif
+		for ( ; x < w; x++ ) {
+			dst[ x ] = ToUint( decay * float( std::floor( sums[ x ] * inverseWeight ) ) );
+		}
+	}
+
+	// rows [ y0, y1 ) of the 1-2-1 x 1-2-1 sum ( weight 16 ) over a w x h map, zero outside - out( y, rowOfSums )
+	template < typename func_t >
+	inline void BlurRows ( const uint32_t * src, const int w, const int h, const int y0, const int y1, std::vector< double > &scratch, func_t out ) {
+		scratch.resize( 5 * size_t( w ) + 2 );
+		double * padded = scratch.data();		// w + 2, zeroes at both ends
+		double * ring[ 3 ] = { padded + w + 2, padded + 2 * w + 2, padded + 3 * w + 2 };
+		double * sum = padded + 4 * w + 2;
+		padded[ 0 ] = padded[ w + 1 ] = 0.0;
+
+		auto Horizontal = [ & ] ( const int y, double * row ) {
+			if ( y < 0 || y >= h ) {
+				std::fill( row, row + w, 0.0 );
+				return;
+			}
+			LoadRow( src + size_t( y ) * w, padded + 1, w );
+			for ( int x = 0; x < w; x++ ) {
+				row[ x ] = padded[ x ] + 2.0 * padded[ x + 1 ] + padded[ x + 2 ];
+			}
+		};
+
+		Horizontal( y0 - 1, ring[ 0 ] );
+		Horizontal( y0, ring[ 1 ] );
+		for ( int y = y0; y < y1; y++ ) {
+			Horizontal( y + 1, ring[ 2 ] );
+			const double * a = ring[ 0 ];
+			const double * b = ring[ 1 ];
+			const double * c = ring[ 2 ];
+			for ( int x = 0; x < w; x++ ) {
+				sum[ x ] = a[ x ] + 2.0 * b[ x ] + c[ x ];
+			}
+			out( y, ( const double * ) sum );
+			std::rotate( ring, ring + 1, ring + 3 );
+		}
+	}
+
+	// deposits, binned per thread by band of the map, so each band is only ever written by one thread
+	struct depositBins_t {
+		uint32_t threads = 1;
+		uint32_t bands = 1;
+		uint32_t shift = 0;
+		std::vector< std::vector< uint32_t > > bins; // [ thread * bands + band ], capacity kept between steps
+
+		uint32_t Prepare ( const uint32_t numThreads, const size_t cells ) {
+			threads = numThreads ? numThreads : parallelThreadCount();
+			// a power of two cells per band, around four bands per thread
+			const size_t target = std::max( size_t( 1 ), ( cells + 4 * threads - 1 ) / ( 4 * threads ) );
+			shift = 0;
+			while ( ( size_t( 1 ) << shift ) < target ) shift++;
+			bands = uint32_t( ( std::max( cells, size_t( 1 ) ) - 1 ) >> shift ) + 1;
+			bins.resize( size_t( threads ) * bands );
+			for ( auto& bin : bins ) {
+				bin.clear();
+			}
+			return threads;
+		}
+
+		void Add ( const uint32_t thread, const uint32_t cell ) {
+			bins[ size_t( thread ) * bands + ( cell >> shift ) ].push_back( cell );
+		}
+
+		void Deposit ( uint32_t * map, const uint32_t amount ) {
+			parallelForDynamic( bands, [ & ] ( size_t band, uint32_t ) {
+				for ( uint32_t t = 0; t < threads; t++ ) {
+					for ( const uint32_t cell : bins[ size_t( t ) * bands + band ] ) {
+						map[ cell ] += amount; // wraps, same as imageAtomicAdd
+					}
+				}
+			}, 1, threads );
+		}
+	};
+
+	inline physarumTrailStats_t TrailStats ( const uint32_t * map, const size_t cells, const uint32_t numThreads ) {
+		const uint32_t threads = numThreads ? numThreads : parallelThreadCount();
+		std::vector< double > sums( threads, 0.0 );
+		std::vector< size_t > nonzero( threads, 0 );
+		std::vector< uint32_t > maxes( threads, 0 );
+		parallelForRanges( cells, [ & ] ( size_t begin, size_t end, uint32_t t ) {
+			double sum = 0.0;
+			size_t count = 0;
+			uint32_t m = 0;
+			for ( size_t i = begin; i < end; i++ ) {
+				sum += map[ i ];
+				count += ( map[ i ] != 0 );
+				m = std::max( m, map[ i ] );
+			}
+			sums[ t ] = sum;
+			nonzero[ t ] = count;
+			maxes[ t ] = m;
+		}, threads );
+		physarumTrailStats_t stats;
+		size_t count = 0;
+		for ( uint32_t t = 0; t < threads; t++ ) {
+			stats.mean += sums[ t ];
+			count += nonzero[ t ];
+			stats.max = std::max( stats.max, maxes[ t ] );
+		}
+		stats.mean /= double( std::max( cells, size_t( 1 ) ) );
+		stats.coverage = double( count ) / double( std::max( cells, size_t( 1 ) ) );
+		return stats;
+	}
+
+#ifdef __AVX__
+	inline __m256 Mask8 ( const __m128i lo, const __m128i hi ) {
+		return _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_castsi128_ps( lo ) ), _mm_castsi128_ps( hi ), 1 );
+	}
+
+	// toroidal cell coordinate, from a position in units of the map size - fract, scale, clamp, truncate
+	inline __m256i WrapCoord8 ( __m256 u, const __m256 size, const __m256 sizeMax ) {
+		u = _mm256_sub_ps( u, _mm256_floor_ps( u ) );
+		return _mm256_cvttps_epi32( _mm256_min_ps( _mm256_mul_ps( u, size ), sizeMax ) );
+	}
+
+	// ( z * h + y ) * w + x, 4 lanes at a time
+	inline void CellIndex8 ( const __m256i x, const __m256i y, const __m256i z, const int w, const int h, uint32_t * out ) {
+		const __m128i W = _mm_set1_epi32( w );
+		const __m128i H = _mm_set1_epi32( h );
+		const __m128i lo = _mm_add_epi32( _mm_mullo_epi32( _mm_add_epi32( _mm_mullo_epi32( _mm256_castsi256_si128( z ), H ), _mm256_castsi256_si128( y ) ), W ), _mm256_castsi256_si128( x ) );
+		const __m128i hi = _mm_add_epi32( _mm_mullo_epi32( _mm_add_epi32( _mm_mullo_epi32( _mm256_extractf128_si256( z, 1 ), H ), _mm256_extractf128_si256( y, 1 ) ), W ), _mm256_extractf128_si256( x, 1 ) );
+		_mm_storeu_si128( ( __m128i * ) out, lo );
+		_mm_storeu_si128( ( __m128i * ) ( out + 4 ), hi );
+	}
+
+	// unsigned a > b, for the sampled trail values
+	inline __m256 GreaterU8 ( const uint32_t * a, const uint32_t * b ) {
+		const __m128i bias = _mm_set1_epi32( int( 0x80000000u ) );
+		const __m128i lo = _mm_cmpgt_epi32( _mm_xor_si128( _mm_loadu_si128( ( const __m128i * ) a ), bias ), _mm_xor_si128( _mm_loadu_si128( ( const __m128i * ) b ), bias ) );
+		const __m128i hi = _mm_cmpgt_epi32( _mm_xor_si128( _mm_loadu_si128( ( const __m128i * ) ( a + 4 ) ), bias ), _mm_xor_si128( _mm_loadu_si128( ( const __m128i * ) ( b + 4 ) ), bias ) );
+		return Mask8( lo, hi );
+	}
+
+	// WangHash() + RandomFloat(), on 4 lanes
+	inline __m128 RandomFloat4 ( __m128i s ) {
+		s = _mm_xor_si128( _mm_xor_si128( s, _mm_set1_epi32( 61 ) ), _mm_srli_epi32( s, 16 ) );
+		s = _mm_mullo_epi32( s, _mm_set1_epi32( 9 ) );
+		s = _mm_xor_si128( s, _mm_srli_epi32( s, 4 ) );
+		s = _mm_mullo_epi32( s, _mm_set1_epi32( 0x27d4eb2d ) );
+		s = _mm_xor_si128( s, _mm_srli_epi32( s, 15 ) );
+		return _mm_mul_ps( _mm_cvtepi32_ps( _mm_srli_epi32( s, 8 ) ), _mm_set1_ps( 1.0f / 16777216.0f ) );
+	}
+#endif
+}
+
+//=============================================================================
+//==== 2D Agents ==============================================================
+//=============================================================================
+
+// the 2D, 2.5D and Embossed projects - positions in [ -1, 1 ], one trail map of width x height
+class physarum2D {
+public:
+	uint32_t numThreads = 0; // 0 = parallelThreadCount()
+
+	physarum2D () {}
+	physarum2D ( uint32_t w, uint32_t h ) { Resize( w, h ); }
+
+	void Resize ( uint32_t w, uint32_t h ) {
+		width = w;
+		height = h;
+		trail[ 0 ].assign( size_t( w ) * h, 0 );
+		trail[ 1 ].assign( size_t( w ) * h, 0 );
+	}
+
+	uint32_t Width () const { return width; }
+	uint32_t Height () const { return height; }
+	uint32_t NumAgents () const { return uint32_t( posX.size() ); }
+	uint64_t StepCount () const { return stepCount; }
+
+	// the map the agents last sensed and deposited in
+	const uint32_t * Trail () const { return trail[ current ].data(); }
+	physarumTrailStats_t TrailStats () const { return physarum::TrailStats( Trail(), trail[ current ].size(), numThreads ); }
+
+	void ClearTrail () {
+		std::fill( trail[ 0 ].begin(), trail[ 0 ].end(), 0 );
+		std::fill( trail[ 1 ].begin(), trail[ 1 ].end(), 0 );
+	}
+
+	// same distribution as the 2D OnInit - positions uniform over [ -1, 1 ], normalized random directions
+	void Seed ( uint32_t numAgents, uint64_t seed_in ) {
+		seed = seed_in;
+		stepCount = 0;
+		posX.resize( numAgents );
+		posY.resize( numAgents );
+		dirX.resize( numAgents );
+		dirY.resize( numAgents );
+		const uint32_t base = uint32_t( physarum::Hash( seed, 0 ) );
+		parallelForRanges( numAgents, [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t i = begin; i < end; i++ ) {
+				uint32_t s = base + 69u * uint32_t( i );
+				posX[ i ] = physarum::RandomFloat( s ) * 2.0f - 1.0f;
+				posY[ i ] = physarum::RandomFloat( s ) * 2.0f - 1.0f;
+				const float x = physarum::RandomFloat( s ) * 2.0f - 1.0f;
+				const float y = physarum::RandomFloat( s ) * 2.0f - 1.0f;
+				const float len = std::sqrt( x * x + y * y );
+				dirX[ i ] = ( len > 0.0f ) ? x / len : 1.0f;
+				dirY[ i ] = ( len > 0.0f ) ? y / len : 0.0f;
+			}
+		}, numThreads );
+	}
+
+	// interleaved position and direction, the agent_t layout of the 2D projects' SSBOs
+	void CopyAgents ( float * dst ) const {
+		parallelForRanges( posX.size(), [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t i = begin; i < end; i++ ) {
+				dst[ 4 * i + 0 ] = posX[ i ];
+				dst[ 4 * i + 1 ] = posY[ i ];
+				dst[ 4 * i + 2 ] = dirX[ i ];
+				dst[ 4 * i + 3 ] = dirY[ i ];
+			}
+		}, numThreads );
+	}
+
+	// one frame of the 2D projects - OnUpdate's diffuse and decay, then the agent pass, on the diffused map
+	void Step ( const physarumPreset_t &preset ) {
+		DiffuseAndDecay( preset.decayFactor );
+		UpdateAgents( preset );
+	}
+
+	void DiffuseAndDecay ( const float decayFactor ) {
+		PROFILE_SCOPE( "Physarum 2D Diffuse" );
+		const uint32_t * src = trail[ current ].data();
+		uint32_t * dst = trail[ current ^ 1 ].data();
+		const uint32_t threads = numThreads ? numThreads : parallelThreadCount();
+		scratch.resize( threads );
+		parallelForRanges( height, [ & ] ( size_t y0, size_t y1, uint32_t t ) {
+			physarum::BlurRows( src, width, height, int( y0 ), int( y1 ), scratch[ t ], [ & ] ( int y, const double * sums ) {
+				physarum::DecayRow( sums, dst + size_t( y ) * width, width, 1.0 / 16.0, decayFactor );
+			} );
+		}, threads );
+		current ^= 1;
+	}
+
+	void UpdateAgents ( const physarumPreset_t &preset ) {
+		PROFILE_SCOPE( "Physarum 2D Agents" );
+		constants_t k;
+		k.cosSense = std::cos( preset.senseAngle );
+		k.sinSense = std::sin( preset.senseAngle );
+		k.cosTurn = std::cos( preset.turnAngle );
+		k.sinTurn = std::sin( preset.turnAngle );
+		k.senseDistance = preset.senseDistance;
+		k.stepSize = preset.stepSize;
+		k.writeBack = preset.writeBack;
+		k.frameSeed = uint32_t( physarum::Hash( seed, ++stepCount ) );
+
+		const size_t count = posX.size();
+		const uint32_t * map = trail[ current ].data();
+		const uint32_t threads = bins.Prepare( numThreads, trail[ current ].size() );
+		parallelForRanges( ( count + 7 ) / 8, [ & ] ( size_t b0, size_t b1, uint32_t t ) {
+			for ( size_t b = b0; b < b1; b++ ) {
+				const size_t i = b * 8;
+			#ifdef __AVX__
+				if ( i + 8 <= count ) {
+					StepBlock( i, k, map, t );
+					continue;
+				}
+			#endif
+				for ( size_t j = i; j < std::min( i + 8, count ); j++ ) {
+					StepAgent( j, k, map, t );
+				}
+			}
+		}, threads );
+		bins.Deposit( trail[ current ].data(), preset.depositAmount );
+	}
+
+	static physarumBenchmark_t Benchmark ( uint32_t w, uint32_t h, uint32_t numAgents, const physarumPreset_t &preset, uint32_t steps, uint64_t seed = 0 ) {
+		physarumBenchmark_t result;
+		result.agents = numAgents;
+		result.steps = steps;
+		result.threads = parallelThreadCount();
+		result.cells = size_t( w ) * h;
+
+		physarum2D sim( w, h );
+		sim.Seed( numAgents, seed );
+		for ( uint32_t i = 0; i < steps; i++ ) {
+			auto tStart = std::chrono::steady_clock::now();
+			sim.DiffuseAndDecay( preset.decayFactor );
+			auto tMid = std::chrono::steady_clock::now();
+			sim.UpdateAgents( preset );
+			result.diffuseSeconds += std::chrono::duration< double >( tMid - tStart ).count();
+			result.agentSeconds += std::chrono::duration< double >( std::chrono::steady_clock::now() - tMid ).count();
+		}
+		result.agentStepsPerSecond = double( numAgents ) * steps / std::max( result.agentSeconds, 1e-9 );
+		result.cellsPerSecond = double( result.cells ) * steps / std::max( result.diffuseSeconds, 1e-9 );
+		result.trail = sim.TrailStats();
+		return result;
+	}
+
+private:
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint64_t seed = 0;
+	uint64_t stepCount = 0;
+
+	std::vector< float > posX, posY, dirX, dirY;
+	std::vector< uint32_t > trail[ 2 ];
+	int current = 0;
+
+	physarum::depositBins_t bins;
+	std::vector< std::vector< double > > scratch; // per thread, for the diffuse
+
+	struct constants_t {
+		float cosSense, sinSense;
+		float cosTurn, sinTurn;
+		float senseDistance;
+		float stepSize;
+		bool writeBack;
+		uint32_t frameSeed;
+	};
+
+	// randomInUnitDisk() from the shader - xy of a random unit vector, so not normalized
+	static void RandomDirection ( uint32_t s, float &x, float &y ) {
+		const float z = physarum::RandomFloat( s ) * 2.0f - 1.0f;
+		const float a = physarum::RandomFloat( s ) * 2.0f * 3.14159265358979323846f;
+		const float r = std::sqrt( 1.0f - z * z );
+		x = r * std::cos( a );
+		y = r * std::sin( a );
+	}
+
+	uint32_t SenseCell ( const float px, const float py, const float ox, const float oy, const float sd ) const {
+		float u = 0.5f * ( px + sd * ox + 1.0f );
+		float v = 0.5f * ( py + sd * oy + 1.0f );
+		u = u - std::floor( u );
+		v = v - std::floor( v );
+		const uint32_t x = uint32_t( std::min( u * float( width ), float( width - 1 ) ) );
+		const uint32_t y = uint32_t( std::min( v * float( height ), float( height - 1 ) ) );
+		return y * width + x;
+	}
+
+	uint32_t DepositCell ( const float px, const float py ) const {
+		const float u = 0.5f * ( px + 1.0f ) * float( width );
+		const float v = 0.5f * ( py + 1.0f ) * float( height );
+		const uint32_t x = uint32_t( std::min( std::max( u, 0.0f ), float( width - 1 ) ) );
+		const uint32_t y = uint32_t( std::min( std::max( v, 0.0f ), float( height - 1 ) ) );
+		return y * width + x;
+	}
+
+	// the agent shader, one agent - also the reference for StepBlock
+	void StepAgent ( const size_t i, const constants_t &k, const uint32_t * map, const uint32_t t ) {
+		const float px = posX[ i ], py = posY[ i ];
+		float dx = dirX[ i ], dy = dirY[ i ];
+
+		// sensors at rotate( d, -senseAngle ), d, rotate( d, senseAngle )
+		const uint32_t R = map[ SenseCell( px, py, k.cosSense * dx - k.sinSense * dy, k.cosSense * dy + k.sinSense * dx, k.senseDistance ) ];
+		const uint32_t M = map[ SenseCell( px, py, dx, dy, k.senseDistance ) ];
+		const uint32_t L = map[ SenseCell( px, py, k.cosSense * dx + k.sinSense * dy, k.cosSense * dy - k.sinSense * dx, k.senseDistance ) ];
+
+		if ( M > L && M > R ) {
+			// keep going straight
+		} else if ( M < L && M < R ) {
+			RandomDirection( k.frameSeed + 69u * uint32_t( i ), dx, dy );
+		} else if ( R > M && M > L ) {
+			const float x = k.cosTurn * dx + k.sinTurn * dy;
+			dy = k.cosTurn * dy - k.sinTurn * dx;
+			dx = x;
+		} else if ( L > M && M > R ) {
+			const float x = k.cosTurn * dx - k.sinTurn * dy;
+			dy = k.cosTurn * dy + k.sinTurn * dx;
+			dx = x;
+		}
+
+		float nx = px + k.stepSize * dx;
+		float ny = py + k.stepSize * dy;
+		if ( nx >= 1.0f ) nx -= 2.0f;
+		if ( nx <= -1.0f ) nx += 2.0f;
+		if ( ny >= 1.0f ) ny -= 2.0f;
+		if ( ny <= -1.0f ) ny += 2.0f;
+
+		posX[ i ] = nx;
+		posY[ i ] = ny;
+		if ( k.writeBack ) {
+			dirX[ i ] = dx;
+			dirY[ i ] = dy;
+		}
+		bins.Add( t, DepositCell( nx, ny ) );
+	}
+
+#ifdef __AVX__
+	// StepAgent, for agents [ i, i + 8 )
+	void StepBlock ( const size_t i, const constants_t &k, const uint32_t * map, const uint32_t t ) {
+		const __m256 px = _mm256_loadu_ps( &posX[ i ] );
+		const __m256 py = _mm256_loadu_ps( &posY[ i ] );
+		__m256 dx = _mm256_loadu_ps( &dirX[ i ] );
+		__m256 dy = _mm256_loadu_ps( &dirY[ i ] );
+
+		const __m256 half = _mm256_set1_ps( 0.5f );
+		const __m256 one = _mm256_set1_ps( 1.0f );
+		const __m256 two = _mm256_set1_ps( 2.0f );
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 sd = _mm256_set1_ps( k.senseDistance );
+		const __m256 cs = _mm256_set1_ps( k.cosSense );
+		const __m256 ss = _mm256_set1_ps( k.sinSense );
+		const __m256 ct = _mm256_set1_ps( k.cosTurn );
+		const __m256 st = _mm256_set1_ps( k.sinTurn );
+		const __m256 fw = _mm256_set1_ps( float( width ) );
+		const __m256 fh = _mm256_set1_ps( float( height ) );
+		const __m256 fwMax = _mm256_set1_ps( float( width - 1 ) );
+		const __m256 fhMax = _mm256_set1_ps( float( height - 1 ) );
+		const __m256i zeroi = _mm256_setzero_si256();
+
+		// sense - right, middle, left
+		alignas( 32 ) uint32_t cells[ 8 ];
+		alignas( 32 ) uint32_t samples[ 3 ][ 8 ];
+		const __m256 ox[ 3 ] = { _mm256_sub_ps( _mm256_mul_ps( cs, dx ), _mm256_mul_ps( ss, dy ) ), dx, _mm256_add_ps( _mm256_mul_ps( cs, dx ), _mm256_mul_ps( ss, dy ) ) };
+		const __m256 oy[ 3 ] = { _mm256_add_ps( _mm256_mul_ps( cs, dy ), _mm256_mul_ps( ss, dx ) ), dy, _mm256_sub_ps( _mm256_mul_ps( cs, dy ), _mm256_mul_ps( ss, dx ) ) };
+		for ( int s = 0; s < 3; s++ ) {
+			const __m256 u = _mm256_mul_ps( half, _mm256_add_ps( _mm256_add_ps( px, _mm256_mul_ps( sd, ox[ s ] ) ), one ) );
+			const __m256 v = _mm256_mul_ps( half, _mm256_add_ps( _mm256_add_ps( py, _mm256_mul_ps( sd, oy[ s ] ) ), one ) );
+			physarum::CellIndex8( physarum::WrapCoord8( u, fw, fwMax ), physarum::WrapCoord8( v, fh, fhMax ), zeroi, width, 0, cells );
+			for ( int j = 0; j < 8; j++ ) {
+				samples[ s ][ j ] = map[ cells[ j ] ];
+			}
+		}
+		const uint32_t * R = samples[ 0 ];
+		const uint32_t * M = samples[ 1 ];
+		const uint32_t * L = samples[ 2 ];
+
+		// the turn cases don't overlap - straight and random leave d alone, here
+		const __m256 mGreaterL = physarum::GreaterU8( M, L );
+		const __m256 mGreaterR = physarum::GreaterU8( M, R );
+		const __m256 lGreaterM = physarum::GreaterU8( L, M );
+		const __m256 rGreaterM = physarum::GreaterU8( R, M );
+		const __m256 turnRight = _mm256_and_ps( rGreaterM, mGreaterL );
+		const __m256 turnLeft = _mm256_and_ps( lGreaterM, mGreaterR );
+		const __m256 rightX = _mm256_add_ps( _mm256_mul_ps( ct, dx ), _mm256_mul_ps( st, dy ) );
+		const __m256 rightY = _mm256_sub_ps( _mm256_mul_ps( ct, dy ), _mm256_mul_ps( st, dx ) );
+		const __m256 leftX = _mm256_sub_ps( _mm256_mul_ps( ct, dx ), _mm256_mul_ps( st, dy ) );
+		const __m256 leftY = _mm256_add_ps( _mm256_mul_ps( ct, dy ), _mm256_mul_ps( st, dx ) );
+		dx = _mm256_blendv_ps( _mm256_blendv_ps( dx, rightX, turnRight ), leftX, turnLeft );
+		dy = _mm256_blendv_ps( _mm256_blendv_ps( dy, rightY, turnRight ), leftY, turnLeft );
+
+		// random directions are rare enough to do one lane at a time, with the scalar trig
+		int random = _mm256_movemask_ps( _mm256_and_ps( lGreaterM, rGreaterM ) );
+		if ( random ) {
+			alignas( 32 ) float x[ 8 ], y[ 8 ];
+			_mm256_store_ps( x, dx );
+			_mm256_store_ps( y, dy );
+			while ( random ) {
+				const int j = __builtin_ctz( random );
+				random &= random - 1;
+				RandomDirection( k.frameSeed + 69u * uint32_t( i + j ), x[ j ], y[ j ] );
+			}
+			dx = _mm256_load_ps( x );
+			dy = _mm256_load_ps( y );
+		}
+
+		// move, and wrap back into [ -1, 1 ]
+		__m256 nx = _mm256_add_ps( px, _mm256_mul_ps( _mm256_set1_ps( k.stepSize ), dx ) );
+		__m256 ny = _mm256_add_ps( py, _mm256_mul_ps( _mm256_set1_ps( k.stepSize ), dy ) );
+		const __m256 minusOne = _mm256_set1_ps( -1.0f );
+		nx = _mm256_sub_ps( nx, _mm256_and_ps( _mm256_cmp_ps( nx, one, _CMP_GE_OQ ), two ) );
+		nx = _mm256_add_ps( nx, _mm256_and_ps( _mm256_cmp_ps( nx, minusOne, _CMP_LE_OQ ), two ) );
+		ny = _mm256_sub_ps( ny, _mm256_and_ps( _mm256_cmp_ps( ny, one, _CMP_GE_OQ ), two ) );
+		ny = _mm256_add_ps( ny, _mm256_and_ps( _mm256_cmp_ps( ny, minusOne, _CMP_LE_OQ ), two ) );
+
+		_mm256_storeu_ps( &posX[ i ], nx );
+		_mm256_storeu_ps( &posY[ i ], ny );
+		if ( k.writeBack ) {
+			_mm256_storeu_ps( &dirX[ i ], dx );
+			_mm256_storeu_ps( &dirY[ i ], dy );
+		}
+
+		// deposit
+		const __m256 u = _mm256_min_ps( _mm256_max_ps( _mm256_mul_ps( _mm256_mul_ps( half, _mm256_add_ps( nx, one ) ), fw ), zero ), fwMax );
+		const __m256 v = _mm256_min_ps( _mm256_max_ps( _mm256_mul_ps( _mm256_mul_ps( half, _mm256_add_ps( ny, one ) ), fh ), zero ), fhMax );
+		physarum::CellIndex8( _mm256_cvttps_epi32( u ), _mm256_cvttps_epi32( v ), zeroi, width, 0, cells );
+		for ( int j = 0; j < 8; j++ ) {
+			bins.Add( t, cells[ j ] );
+		}
+	}
+#endif
+};
+
+//=============================================================================
+//==== 3D Agents ==============================================================
+//=============================================================================
+
+// the 3D project - positions in voxels, each agent carries an orthonormal basis, Z is forwards
+class physarum3D {
+public:
+	uint32_t numThreads = 0; // 0 = parallelThreadCount()
+
+	physarum3D () {}
+	physarum3D ( uint32_t x, uint32_t y, uint32_t z ) { Resize( x, y, z ); }
+
+	void Resize ( uint32_t x, uint32_t y, uint32_t z ) {
+		dimX = x;
+		dimY = y;
+		dimZ = z;
+		trail[ 0 ].assign( size_t( x ) * y * z, 0 );
+		trail[ 1 ].assign( size_t( x ) * y * z, 0 );
+	}
+
+	uint32_t DimX () const { return dimX; }
+	uint32_t DimY () const { return dimY; }
+	uint32_t DimZ () const { return dimZ; }
+	uint32_t NumAgents () const { return uint32_t( pos[ 0 ].size() ); }
+	uint64_t StepCount () const { return stepCount; }
+
+	const uint32_t * Trail () const { return trail[ current ].data(); }
+	physarumTrailStats_t TrailStats () const { return physarum::TrailStats( Trail(), trail[ current ].size(), numThreads ); }
+
+	void ClearTrail () {
+		std::fill( trail[ 0 ].begin(), trail[ 0 ].end(), 0 );
+		std::fill( trail[ 1 ].begin(), trail[ 1 ].end(), 0 );
+	}
+
+	// the 3D init shader's modes - 0 is a slab with 100 voxel margins, 1 a blob at the corner, 2 a blob at the center
+	void Seed ( uint32_t numAgents, uint64_t seed_in, int mode = 2 ) {
+		seed = seed_in;
+		stepCount = 0;
+		for ( int c = 0; c < 3; c++ ) {
+			pos[ c ].resize( numAgents );
+			basisX[ c ].resize( numAgents );
+			basisY[ c ].resize( numAgents );
+			basisZ[ c ].resize( numAgents );
+		}
+		const uint32_t base = uint32_t( physarum::Hash( seed, 0 ) );
+		const glm::vec3 dims = glm::vec3( dimX, dimY, dimZ );
+		parallelForRanges( numAgents, [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t i = begin; i < end; i++ ) {
+				uint32_t s = base + 69420u * uint32_t( i );
+				glm::vec3 p = glm::vec3( 0.0f );
+				if ( mode == 0 ) {
+					p.x = 100.0f + physarum::RandomFloat( s ) * ( dims.x - 200.0f );
+					p.y = 100.0f + physarum::RandomFloat( s ) * ( dims.y - 200.0f );
+					p.z = 100.0f + physarum::RandomFloat( s ) * ( dims.z - 200.0f );
+				} else if ( mode == 1 || mode == 2 ) {
+					const float r = physarum::RandomFloat( s );
+					const float z = physarum::RandomFloat( s ) * 2.0f - 1.0f;
+					const float a = physarum::RandomFloat( s ) * 2.0f * 3.14159265358979323846f;
+					const float rxy = std::sqrt( 1.0f - z * z );
+					p = r * glm::vec3( rxy * std::cos( a ), rxy * std::sin( a ), z );
+					if ( mode == 2 ) p += dims / 2.0f;
+				}
+
+				// random rotations about each of the basis vectors in turn
+				glm::vec3 X = glm::vec3( 1.0f, 0.0f, 0.0f );
+				glm::vec3 Y = glm::vec3( 0.0f, 1.0f, 0.0f );
+				glm::vec3 Z = glm::vec3( 0.0f, 0.0f, 1.0f );
+				for ( int axis = 0; axis < 3; axis++ ) {
+					const glm::mat3 rot = physarum::Rotate3D( 2.0f * 3.14159265358979323846f * physarum::RandomFloat( s ), axis == 0 ? X : ( axis == 1 ? Y : Z ) );
+					X = rot * X;
+					Y = rot * Y;
+					Z = rot * Z;
+				}
+
+				for ( int c = 0; c < 3; c++ ) {
+					pos[ c ][ i ] = p[ c ];
+					basisX[ c ][ i ] = X[ c ];
+					basisY[ c ][ i ] = Y[ c ];
+					basisZ[ c ][ i ] = Z[ c ];
+				}
+			}
+		}, numThreads );
+	}
+
+	void Step ( const physarumPreset_t &preset ) {
+		DiffuseAndDecay( preset.decayFactor );
+		UpdateAgents( preset );
+	}
+
+	// 1-2-1 on x and y per slice, then 1-2-1 across a ring of three blurred slices - weight 64, as the shader's 27 taps
+	void DiffuseAndDecay ( const float decayFactor ) {
+		PROFILE_SCOPE( "Physarum 3D Diffuse" );
+		const uint32_t * src = trail[ current ].data();
+		uint32_t * dst = trail[ current ^ 1 ].data();
+		const size_t sliceSize = size_t( dimX ) * dimY;
+		const uint32_t threads = numThreads ? numThreads : parallelThreadCount();
+		scratch.resize( threads );
+		sliceScratch.resize( threads );
+		parallelForRanges( dimZ, [ & ] ( size_t z0, size_t z1, uint32_t t ) {
+			std::vector< double > &slices = sliceScratch[ t ];
+			slices.resize( 3 * sliceSize + dimX );
+			double * ring[ 3 ] = { slices.data(), slices.data() + sliceSize, slices.data() + 2 * sliceSize };
+			double * sum = slices.data() + 3 * sliceSize;
+
+			auto BlurSlice = [ & ] ( const int z, double * out ) {
+				if ( z < 0 || z >= int( dimZ ) ) {
+					std::fill( out, out + sliceSize, 0.0 );
+					return;
+				}
+				physarum::BlurRows( src + size_t( z ) * sliceSize, dimX, dimY, 0, dimY, scratch[ t ], [ & ] ( int y, const double * sums ) {
+					std::memcpy( out + size_t( y ) * dimX, sums, dimX * sizeof( double ) );
+				} );
+			};
+
+			BlurSlice( int( z0 ) - 1, ring[ 0 ] );
+			BlurSlice( int( z0 ), ring[ 1 ] );
+			for ( size_t z = z0; z < z1; z++ ) {
+				BlurSlice( int( z ) + 1, ring[ 2 ] );
+				for ( uint32_t y = 0; y < dimY; y++ ) {
+					const double * a = ring[ 0 ] + size_t( y ) * dimX;
+					const double * b = ring[ 1 ] + size_t( y ) * dimX;
+					const double * c = ring[ 2 ] + size_t( y ) * dimX;
+					for ( uint32_t x = 0; x < dimX; x++ ) {
+						sum[ x ] = a[ x ] + 2.0 * b[ x ] + c[ x ];
+					}
+					physarum::DecayRow( sum, dst + z * sliceSize + size_t( y ) * dimX, dimX, 1.0 / 64.0, decayFactor );
+				}
+				std::rotate( ring, ring + 1, ring + 3 );
+			}
+		}, threads );
+		current ^= 1;
+	}
+
+	void UpdateAgents ( const physarumPreset_t &preset ) {
+		PROFILE_SCOPE( "Physarum 3D Agents" );
+		const constants_t k = Constants( preset, uint32_t( physarum::Hash( seed, ++stepCount ) ) );
+		const size_t count = pos[ 0 ].size();
+		const uint32_t * map = trail[ current ].data();
+		const uint32_t threads = bins.Prepare( numThreads, trail[ current ].size() );
+		parallelForRanges( ( count + 7 ) / 8, [ & ] ( size_t b0, size_t b1, uint32_t t ) {
+			for ( size_t b = b0; b < b1; b++ ) {
+				const size_t i = b * 8;
+			#ifdef __AVX__
+				if ( i + 8 <= count ) {
+					StepBlock( i, k, map, t );
+					continue;
+				}
+			#endif
+				for ( size_t j = i; j < std::min( i + 8, count ); j++ ) {
+					StepAgent( j, k, map, t );
+				}
+			}
+		}, threads );
+		bins.Deposit( trail[ current ].data(), preset.depositAmount );
+	}
+
+	static physarumBenchmark_t Benchmark ( uint32_t x, uint32_t y, uint32_t z, uint32_t numAgents, const physarumPreset_t &preset, uint32_t steps, uint64_t seed = 0 ) {
+		physarumBenchmark_t result;
+		result.agents = numAgents;
+		result.steps = steps;
+		result.threads = parallelThreadCount();
+		result.cells = size_t( x ) * y * z;
+
+		physarum3D sim( x, y, z );
+		sim.Seed( numAgents, seed );
+		for ( uint32_t i = 0; i < steps; i++ ) {
+			auto tStart = std::chrono::steady_clock::now();
+			sim.DiffuseAndDecay( preset.decayFactor );
+			auto tMid = std::chrono::steady_clock::now();
+			sim.UpdateAgents( preset );
+			result.diffuseSeconds += std::chrono::duration< double >( tMid - tStart ).count();
+			result.agentSeconds += std::chrono::duration< double >( std::chrono::steady_clock::now() - tMid ).count();
+		}
+		result.agentStepsPerSecond = double( numAgents ) * steps / std::max( result.agentSeconds, 1e-9 );
+		result.cellsPerSecond = double( result.cells ) * steps / std::max( result.diffuseSeconds, 1e-9 );
+		result.trail = sim.TrailStats();
+		return result;
+	}
+
+private:
+	uint32_t dimX = 0;
+	uint32_t dimY = 0;
+	uint32_t dimZ = 0;
+	uint64_t seed = 0;
+	uint64_t stepCount = 0;
+
+	std::vector< float > pos[ 3 ], basisX[ 3 ], basisY[ 3 ], basisZ[ 3 ];
+	std::vector< uint32_t > trail[ 2 ];
+	int current = 0;
+
+	physarum::depositBins_t bins;
+	std::vector< std::vector< double > > scratch;		// per thread, rows for the diffuse
+	std::vector< std::vector< double > > sliceScratch;	// per thread, three blurred slices
+
+	// the shader's sense and move positions and basis updates, in terms of the agent's own basis - choice 0 is
+		// straight ahead, 1..3 are tipped off of forwards and rolled 2 pi / 3 apart. Constant for a preset, so the
+		// per-agent work is just weighted sums of the basis vectors.
+	struct constants_t {
+		float sense[ 4 ][ 3 ];		// sensor k at pos + sense[ k ][ 0 ] * X + sense[ k ][ 1 ] * Y + sense[ k ][ 2 ] * Z
+		float move[ 4 ][ 3 ];		// same, for the step
+		float basis[ 4 ][ 9 ];		// new X, Y, Z, each as weights on the old X, Y, Z
+		uint32_t frameSeed;
+	};
+
+	static constants_t Constants ( const physarumPreset_t &preset, const uint32_t frameSeed ) {
+		constants_t k;
+		k.frameSeed = frameSeed;
+		const float sa = std::sin( preset.senseAngle ), ca = std::cos( preset.senseAngle );
+		const float st = std::sin( preset.turnAngle ), ct = std::cos( preset.turnAngle );
+		for ( int s = 0; s < 4; s++ ) {
+			// Rotate3D( phi, Z ) * Rotate3D( angle, X ) takes Z to ( sin phi sin angle, -cos phi sin angle, cos angle )
+			const float phi = 2.0f * 3.14159265358979323846f * float( s ) / 3.0f;
+			const float sp = ( s == 0 ) ? 0.0f : std::sin( phi );
+			const float cp = ( s == 0 ) ? 1.0f : std::cos( phi );
+			const float sSense = ( s == 0 ) ? 0.0f : sa, cSense = ( s == 0 ) ? 1.0f : ca;
+			const float sTurn = ( s == 0 ) ? 0.0f : st, cTurn = ( s == 0 ) ? 1.0f : ct;
+			k.sense[ s ][ 0 ] = preset.senseDistance * ( sp * sSense );
+			k.sense[ s ][ 1 ] = preset.senseDistance * ( -cp * sSense );
+			k.sense[ s ][ 2 ] = preset.senseDistance * cSense;
+			k.move[ s ][ 0 ] = preset.stepSize * ( sp * sTurn );
+			k.move[ s ][ 1 ] = preset.stepSize * ( -cp * sTurn );
+			k.move[ s ][ 2 ] = preset.stepSize * cTurn;
+
+			// the basis turns by the sense angle, as in the shader, not the turn angle
+			const float b[ 9 ] = {
+				cp, sp, 0.0f,
+				-sp * cSense, cp * cSense, sSense,
+				sp * sSense, -cp * sSense, cSense
+			};
+			std::copy( b, b + 9, k.basis[ s ] );
+		}
+		return k;
+	}
+
+	uint32_t SenseCell ( const float x, const float y, const float z ) const {
+		float u = x * ( 1.0f / float( dimX ) );
+		float v = y * ( 1.0f / float( dimY ) );
+		float w = z * ( 1.0f / float( dimZ ) );
+		u = u - std::floor( u );
+		v = v - std::floor( v );
+		w = w - std::floor( w );
+		const uint32_t cx = uint32_t( std::min( u * float( dimX ), float( dimX - 1 ) ) );
+		const uint32_t cy = uint32_t( std::min( v * float( dimY ), float( dimY - 1 ) ) );
+		const uint32_t cz = uint32_t( std::min( w * float( dimZ ), float( dimZ - 1 ) ) );
+		return ( cz * dimY + cy ) * dimX + cx;
+	}
+
+	// the agent shader, one agent - also the reference for StepBlock
+	void StepAgent ( const size_t i, const constants_t &k, const uint32_t * map, const uint32_t t ) {
+		const float p[ 3 ] = { pos[ 0 ][ i ], pos[ 1 ][ i ], pos[ 2 ][ i ] };
+		const float X[ 3 ] = { basisX[ 0 ][ i ], basisX[ 1 ][ i ], basisX[ 2 ][ i ] };
+		const float Y[ 3 ] = { basisY[ 0 ][ i ], basisY[ 1 ][ i ], basisY[ 2 ][ i ] };
+		const float Z[ 3 ] = { basisZ[ 0 ][ i ], basisZ[ 1 ][ i ], basisZ[ 2 ][ i ] };
+
+		uint32_t samples[ 4 ];
+		for ( int s = 0; s < 4; s++ ) {
+			float q[ 3 ];
+			for ( int c = 0; c < 3; c++ ) {
+				q[ c ] = p[ c ] + k.sense[ s ][ 0 ] * X[ c ] + k.sense[ s ][ 1 ] * Y[ c ] + k.sense[ s ][ 2 ] * Z[ c ];
+			}
+			samples[ s ] = map[ SenseCell( q[ 0 ], q[ 1 ], q[ 2 ] ) ];
+		}
+
+		// ties between all four pick any, ties between the three flanking samples pick one of those
+		const uint32_t maxSample = std::max( std::max( samples[ 0 ], samples[ 1 ] ), std::max( samples[ 2 ], samples[ 3 ] ) );
+		const bool eq[ 4 ] = { samples[ 0 ] == maxSample, samples[ 1 ] == maxSample, samples[ 2 ] == maxSample, samples[ 3 ] == maxSample };
+		uint32_t s = k.frameSeed + 69420u * uint32_t( i );
+		const float r = physarum::RandomFloat( s ) - 0.001f;
+		float selected = 3.0f;
+		if ( eq[ 0 ] && eq[ 1 ] && eq[ 2 ] && eq[ 3 ] ) {
+			selected = std::trunc( r * 4.0f );
+		} else if ( eq[ 1 ] && eq[ 2 ] && eq[ 3 ] ) {
+			selected = std::trunc( r * 3.0f ) + 1.0f;
+		} else if ( eq[ 0 ] ) {
+			selected = 0.0f;
+		} else if ( eq[ 1 ] ) {
+			selected = 1.0f;
+		} else if ( eq[ 2 ] ) {
+			selected = 2.0f;
+		}
+		const int sel = int( std::min( std::max( selected, 0.0f ), 3.0f ) );
+
+		// step with the old basis, then update it
+		const float dims[ 3 ] = { float( dimX ), float( dimY ), float( dimZ ) };
+		const float dimsMax[ 3 ] = { float( dimX - 1 ), float( dimY - 1 ), float( dimZ - 1 ) };
+		uint32_t cell[ 3 ];
+		for ( int c = 0; c < 3; c++ ) {
+			float n = p[ c ] + k.move[ sel ][ 0 ] * X[ c ] + k.move[ sel ][ 1 ] * Y[ c ] + k.move[ sel ][ 2 ] * Z[ c ];
+			if ( n >= dims[ c ] ) n -= dims[ c ];
+			if ( n < 0.0f ) n += dims[ c ];
+			pos[ c ][ i ] = n;
+			cell[ c ] = uint32_t( std::min( std::max( n, 0.0f ), dimsMax[ c ] ) );
+
+			const float * b = k.basis[ sel ];
+			basisX[ c ][ i ] = b[ 0 ] * X[ c ] + b[ 1 ] * Y[ c ] + b[ 2 ] * Z[ c ];
+			basisY[ c ][ i ] = b[ 3 ] * X[ c ] + b[ 4 ] * Y[ c ] + b[ 5 ] * Z[ c ];
+			basisZ[ c ][ i ] = b[ 6 ] * X[ c ] + b[ 7 ] * Y[ c ] + b[ 8 ] * Z[ c ];
+		}
+		bins.Add( t, ( cell[ 2 ] * dimY + cell[ 1 ] ) * dimX + cell[ 0 ] );
+	}
+
+#ifdef __AVX__
+	// StepAgent, for agents [ i, i + 8 )
+	void StepBlock ( const size_t i, const constants_t &k, const uint32_t * map, const uint32_t t ) {
+		__m256 p[ 3 ], X[ 3 ], Y[ 3 ], Z[ 3 ];
+		for ( int c = 0; c < 3; c++ ) {
+			p[ c ] = _mm256_loadu_ps( &pos[ c ][ i ] );
+			X[ c ] = _mm256_loadu_ps( &basisX[ c ][ i ] );
+			Y[ c ] = _mm256_loadu_ps( &basisY[ c ][ i ] );
+			Z[ c ] = _mm256_loadu_ps( &basisZ[ c ][ i ] );
+		}
+		const __m256 dims[ 3 ] = { _mm256_set1_ps( float( dimX ) ), _mm256_set1_ps( float( dimY ) ), _mm256_set1_ps( float( dimZ ) ) };
+		const __m256 dimsMax[ 3 ] = { _mm256_set1_ps( float( dimX - 1 ) ), _mm256_set1_ps( float( dimY - 1 ) ), _mm256_set1_ps( float( dimZ - 1 ) ) };
+		const __m256 inverseDims[ 3 ] = { _mm256_set1_ps( 1.0f / float( dimX ) ), _mm256_set1_ps( 1.0f / float( dimY ) ), _mm256_set1_ps( 1.0f / float( dimZ ) ) };
+
+		// weighted sum of the basis vectors, for component c
+		auto Offset = [ & ] ( const float * w, const int c ) {
+			return _mm256_add_ps( _mm256_add_ps( _mm256_add_ps( p[ c ],
+				_mm256_mul_ps( _mm256_set1_ps( w[ 0 ] ), X[ c ] ) ),
+				_mm256_mul_ps( _mm256_set1_ps( w[ 1 ] ), Y[ c ] ) ),
+				_mm256_mul_ps( _mm256_set1_ps( w[ 2 ] ), Z[ c ] ) );
+		};
+
+		// sense
+		alignas( 32 ) uint32_t cells[ 8 ];
+		alignas( 32 ) uint32_t samples[ 4 ][ 8 ];
+		for ( int s = 0; s < 4; s++ ) {
+			__m256i coord[ 3 ];
+			for ( int c = 0; c < 3; c++ ) {
+				coord[ c ] = physarum::WrapCoord8( _mm256_mul_ps( Offset( k.sense[ s ], c ), inverseDims[ c ] ), dims[ c ], dimsMax[ c ] );
+			}
+			physarum::CellIndex8( coord[ 0 ], coord[ 1 ], coord[ 2 ], dimX, dimY, cells );
+			for ( int j = 0; j < 8; j++ ) {
+				samples[ s ][ j ] = map[ cells[ j ] ];
+			}
+		}
+
+		// which samples equal the max
+		__m128i eqLo[ 4 ], eqHi[ 4 ];
+		{
+			__m128i lo[ 4 ], hi[ 4 ];
+			for ( int s = 0; s < 4; s++ ) {
+				lo[ s ] = _mm_load_si128( ( const __m128i * ) samples[ s ] );
+				hi[ s ] = _mm_load_si128( ( const __m128i * ) ( samples[ s ] + 4 ) );
+			}
+			const __m128i maxLo = _mm_max_epu32( _mm_max_epu32( lo[ 0 ], lo[ 1 ] ), _mm_max_epu32( lo[ 2 ], lo[ 3 ] ) );
+			const __m128i maxHi = _mm_max_epu32( _mm_max_epu32( hi[ 0 ], hi[ 1 ] ), _mm_max_epu32( hi[ 2 ], hi[ 3 ] ) );
+			for ( int s = 0; s < 4; s++ ) {
+				eqLo[ s ] = _mm_cmpeq_epi32( lo[ s ], maxLo );
+				eqHi[ s ] = _mm_cmpeq_epi32( hi[ s ], maxHi );
+			}
+		}
+		const __m256 eq0 = physarum::Mask8( eqLo[ 0 ], eqHi[ 0 ] );
+		const __m256 eq1 = physarum::Mask8( eqLo[ 1 ], eqHi[ 1 ] );
+		const __m256 eq2 = physarum::Mask8( eqLo[ 2 ], eqHi[ 2 ] );
+		const __m256 eq3 = physarum::Mask8( eqLo[ 3 ], eqHi[ 3 ] );
+		const __m256 flanking = _mm256_and_ps( _mm256_and_ps( eq1, eq2 ), eq3 );
+		const __m256 all = _mm256_and_ps( flanking, eq0 );
+
+		// the shader's selection, lowest priority first
+		const __m128i seedLo = _mm_add_epi32( _mm_set1_epi32( int( k.frameSeed ) ), _mm_mullo_epi32( _mm_setr_epi32( int( i ), int( i + 1 ), int( i + 2 ), int( i + 3 ) ), _mm_set1_epi32( 69420 ) ) );
+		const __m128i seedHi = _mm_add_epi32( seedLo, _mm_set1_epi32( 4 * 69420 ) );
+		const __m256 r = _mm256_sub_ps( _mm256_insertf128_ps( _mm256_castps128_ps256( physarum::RandomFloat4( seedLo ) ), physarum::RandomFloat4( seedHi ), 1 ), _mm256_set1_ps( 0.001f ) );
+		__m256 selected = _mm256_set1_ps( 3.0f );
+		selected = _mm256_blendv_ps( selected, _mm256_set1_ps( 2.0f ), eq2 );
+		selected = _mm256_blendv_ps( selected, _mm256_set1_ps( 1.0f ), eq1 );
+		selected = _mm256_blendv_ps( selected, _mm256_setzero_ps(), eq0 );
+		selected = _mm256_blendv_ps( selected, _mm256_add_ps( _mm256_round_ps( _mm256_mul_ps( r, _mm256_set1_ps( 3.0f ) ), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ), _mm256_set1_ps( 1.0f ) ), flanking );
+		selected = _mm256_blendv_ps( selected, _mm256_round_ps( _mm256_mul_ps( r, _mm256_set1_ps( 4.0f ) ), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC ), all );
+		selected = _mm256_min_ps( _mm256_max_ps( selected, _mm256_setzero_ps() ), _mm256_set1_ps( 3.0f ) );
+		const __m256 is1 = _mm256_cmp_ps( selected, _mm256_set1_ps( 1.0f ), _CMP_EQ_OQ );
+		const __m256 is2 = _mm256_cmp_ps( selected, _mm256_set1_ps( 2.0f ), _CMP_EQ_OQ );
+		const __m256 is3 = _mm256_cmp_ps( selected, _mm256_set1_ps( 3.0f ), _CMP_EQ_OQ );
+		auto Select = [ & ] ( const float a, const float b, const float c, const float d ) {
+			return _mm256_blendv_ps( _mm256_blendv_ps( _mm256_blendv_ps( _mm256_set1_ps( a ), _mm256_set1_ps( b ), is1 ), _mm256_set1_ps( c ), is2 ), _mm256_set1_ps( d ), is3 );
+		};
+
+		// step with the old basis, then update it
+		__m256 move[ 3 ], basis[ 9 ];
+		for ( int w = 0; w < 3; w++ ) {
+			move[ w ] = Select( k.move[ 0 ][ w ], k.move[ 1 ][ w ], k.move[ 2 ][ w ], k.move[ 3 ][ w ] );
+		}
+		for ( int w = 0; w < 9; w++ ) {
+			basis[ w ] = Select( k.basis[ 0 ][ w ], k.basis[ 1 ][ w ], k.basis[ 2 ][ w ], k.basis[ 3 ][ w ] );
+		}
+		__m256i cell[ 3 ];
+		for ( int c = 0; c < 3; c++ ) {
+			__m256 n = _mm256_add_ps( _mm256_add_ps( _mm256_add_ps( p[ c ], _mm256_mul_ps( move[ 0 ], X[ c ] ) ), _mm256_mul_ps( move[ 1 ], Y[ c ] ) ), _mm256_mul_ps( move[ 2 ], Z[ c ] ) );
+			n = _mm256_sub_ps( n, _mm256_and_ps( _mm256_cmp_ps( n, dims[ c ], _CMP_GE_OQ ), dims[ c ] ) );
+			n = _mm256_add_ps( n, _mm256_and_ps( _mm256_cmp_ps( n, _mm256_setzero_ps(), _CMP_LT_OQ ), dims[ c ] ) );
+			_mm256_storeu_ps( &pos[ c ][ i ], n );
+			cell[ c ] = _mm256_cvttps_epi32( _mm256_min_ps( _mm256_max_ps( n, _mm256_setzero_ps() ), dimsMax[ c ] ) );
+
+			_mm256_storeu_ps( &basisX[ c ][ i ], _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( basis[ 0 ], X[ c ] ), _mm256_mul_ps( basis[ 1 ], Y[ c ] ) ), _mm256_mul_ps( basis[ 2 ], Z[ c ] ) ) );
+			_mm256_storeu_ps( &basisY[ c ][ i ], _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( basis[ 3 ], X[ c ] ), _mm256_mul_ps( basis[ 4 ], Y[ c ] ) ), _mm256_mul_ps( basis[ 5 ], Z[ c ] ) ) );
+			_mm256_storeu_ps( &basisZ[ c ][ i ], _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( basis[ 6 ], X[ c ] ), _mm256_mul_ps( basis[ 7 ], Y[ c ] ) ), _mm256_mul_ps( basis[ 8 ], Z[ c ] ) ) );
+		}
+
+		// deposit
+		physarum::CellIndex8( cell[ 0 ], cell[ 1 ], cell[ 2 ], dimX, dimY, cells );
+		for ( int j = 0; j < 8; j++ ) {
+			bins.Add( t, cells[ j ] );
+		}
+	}
+#endif
+};
+
+#endif // PHYSARUM_CPU_H
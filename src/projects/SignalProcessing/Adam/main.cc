@@ -1,4 +1,5 @@
 #include "../../../engine/engine.h"
+#include "pushPull.h"
 
 class Adam final : public engineBase { // sample derived from base engine class
 public:
@@ -9,6 +10,16 @@ public:
 	const int hInitial = 1024;
 	int numLevels = 0;
 
+	// samples go in a batch per frame, into the CPU pyramid - then either the CPU pull pass fills in the image, or level 0
+		// is uploaded and the GPU mip sweep + draw shader walk do it
+	pushPullCPU pushPull;
+	bool CPUReconstruction = true;
+	bool bilinearFill = false;
+	int samplesPerFrame = 1024;
+	std::vector< pushPullCPU::sample_t > batch;
+	std::vector< vec4 > sampleColors;
+	std::vector< pushPullCPU::region_t > sampleRegions;
+	rng jitter = rng( 0.0f, 1.0f );
 
 	void OnInit () {
 		ZoneScoped;
@@ -30,6 +41,8 @@ public:
 			opts.dataType = GL_RGBA32F;
 			textureManager.Add( "Adam Color", opts );
 
+			textureManager.Add( "Adam Reconstruction", opts );
+
 			opts.dataType = GL_R32UI;
 			textureManager.Add( "Adam Count", opts );
 
@@ -51,13 +64,28 @@ public:
 			numLevels = level;
 
 			// now that we have the textures setup, OnUpdate will hook and compute the mips
+			pushPull.Resize( wInitial, hInitial );
 			NewOffsets();
+
+			terminal.addCommand( { "pushPullBenchmark" }, {
+					{ "batch", INT, "Samples per batch." }
+				}, [=] ( args_t args ) {
+					const pushPullCPU::benchmarkResult_t result = pushPullCPU::Benchmark( wInitial, hInitial, size_t( std::max( 1, int( args[ "batch" ].data.x ) ) ) );
+					terminal.addLineBreak();
+					terminal.addHistoryLine( terminal.csb.append( "Push-Pull Benchmark ", 3 ).append( "[ " + GetWithThousandsSeparator( result.numSamples ) + " samples at " + to_string( result.width ) + "x" + to_string( result.height ) + ", " + to_string( result.numThreads ) + " threads ]", GREY_DD ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  batches of " + GetWithThousandsSeparator( result.batchSize ) + ": " + GetWithThousandsSeparator( size_t( result.samplesPerSecond ) ) + " samples/sec, " + to_string( result.batchMs ) + "ms per batch" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  full mip sweep: " + to_string( result.rebuildMs ) + "ms, pyramid " ).append( result.matches ? "matches" : "MISMATCH", GREY_DD ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  one batch of everything: " + GetWithThousandsSeparator( size_t( result.bigBatchSamplesPerSecond ) ) + " samples/sec" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  reconstruct at half coverage: " + to_string( result.nearestMs ) + "ms nearest, " + to_string( result.bilinearMs ) + "ms bilinear" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  per batch, second half: " + to_string( result.incrementalMs ) + "ms incremental reconstruct, " + GetWithThousandsSeparator( size_t( result.uploadBytes ) ) + " bytes in " + to_string( int( result.uploadRegions ) ) + " uploads, output " ).append( result.reconstructMatches ? "matches" : "MISMATCH", GREY_DD ).flush() );
+					terminal.addLineBreak();
+				}, "Time the CPU push-pull pyramid, batched inserts and reconstruction, on Adam's sample order." );
 		}
 	}
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		// get new data into the input handler
 		inputHandler.update();
@@ -83,6 +111,13 @@ public:
 			profilerWindow.Render(); // GPU graph is presented on top, CPU on bottom
 		}
 
+		ImGui::Begin( "Adam", NULL );
+		ImGui::Text( "%d samples", int( pushPull.NumSamples() ) );
+		ImGui::Checkbox( "CPU Reconstruction", &CPUReconstruction );
+		ImGui::Checkbox( "Bilinear Fill", &bilinearFill );
+		ImGui::SliderInt( "Samples Per Frame", &samplesPerFrame, 1, 65536 );
+		ImGui::End();
+
 		QuitConf( &quitConfirm ); // show quit confirm window, if triggered
 
 		if ( showDemoWindow ) ImGui::ShowDemoWindow( &showDemoWindow );
@@ -94,24 +129,28 @@ public:
 		{ // dummy draw - draw something into accumulatorTexture
 
 			// do the mip sweep, so everything propagates to higher mip levels
-			MipSweep();
+			if ( !CPUReconstruction ) {
+				MipSweep();
+			}
 
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 			const GLuint shader = shaders[ "Draw" ];
 			glUseProgram( shader );
 
 			glUniform1f( glGetUniformLocation( shader, "time" ), SDL_GetTicks() / 1600.0f );
 			glUniform1f( glGetUniformLocation( shader, "percentDone" ), 1.0f - ( float( offsets.size() ) / float( wInitial * hInitial ) ) );
+			glUniform1i( glGetUniformLocation( shader, "cpuReconstruction" ), CPUReconstruction );
 			textureManager.BindTexForShader( "Adam Count", "adamCount", shader, 2 );
 			textureManager.BindTexForShader( "Adam Color", "adamColor", shader, 3 );
+			textureManager.BindTexForShader( "Adam Reconstruction", "adamReconstruction", shader, 4 );
 
 			glDispatchCompute( ( config.width + 15 ) / 16, ( config.height + 15 ) / 16, 1 );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -120,7 +159,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Clear();
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 
@@ -134,51 +173,63 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		// are there offsets left?
 		if ( offsets.size() > 0 ) {
-			// doing 16 pixels per frame... that's a full 256x256 update in 4096 frames = ~68 seconds
-			for ( int i = 0; i < 1024; i++ ) {
-				// write data for one more pixel, at that offset...
-				ivec2 loc = offsets[ offsets.size() - 1 ];
+			// build this frame's samples all at once, then add them to the pyramid as one batch
+			batch.clear();
+			for ( int i = 0; i < samplesPerFrame && offsets.size() > 0; i++ ) {
+				const ivec2 loc = offsets[ offsets.size() - 1 ];
 
-				// put a 1 into the pixel for the count...
-				uint32_t dataU = 1;
-				glBindTexture( GL_TEXTURE_2D, textureManager.Get( "Adam Count" ) );
-				glTexSubImage2D( GL_TEXTURE_2D, 0, loc.x, loc.y, 1, 1, getFormat( GL_R32UI ), GL_UNSIGNED_INT, &dataU );
-
-				// put a color sample of a circular mask into the pixel for the color...
-				rng col = rng( 0.0f, 1.0f );
-				vec4 dataC = ( fmod( glm::distance( vec2( loc ), vec2( wInitial / 2.0f, hInitial / 2.0f ) ), 100.0f ) < 35.0f ) ? vec4( ( loc.x % 80 < 40 ) ? 0.0f : 1.0f, col(), ( loc.x % 80 < 40 ) ? 1.0f : 0.0f, 1.0f ) : vec4( 0.0f, 0.0f, 0.0f, 1.0f );
+				// a color sample of a circular mask, at that offset...
+				vec4 dataC = ( fmod( glm::distance( vec2( loc ), vec2( wInitial / 2.0f, hInitial / 2.0f ) ), 100.0f ) < 35.0f ) ? vec4( ( loc.x % 80 < 40 ) ? 0.0f : 1.0f, jitter(), ( loc.x % 80 < 40 ) ? 1.0f : 0.0f, 1.0f ) : vec4( 0.0f, 0.0f, 0.0f, 1.0f );
 
 				// static Image_4F testImage( "test2.png" );
 				// Image_4F::color col = testImage.GetAtXY( loc.x, loc.y );
 				// vec4 dataC = vec4( col[ red ], col[ green ], col[ blue ], 1.0f );
 
-				glBindTexture( GL_TEXTURE_2D, textureManager.Get( "Adam Color" ) );
-				glTexSubImage2D( GL_TEXTURE_2D, 0, loc.x, loc.y, 1, 1, getFormat( GL_RGBA32F ), GL_FLOAT, &dataC );
+				batch.push_back( { uint32_t( loc.x ), uint32_t( loc.y ), dataC } );
 
 				// pop that entry off the list
 				offsets.pop_back();
 			}
+			pushPull.Insert( batch );
 		} else {
-			const int w = wInitial;
-			const int h = hInitial;
-
-			// clear the first layer of the buffer (this propagates to all levels, next mip sweep)
-			static Image_4U zeroesU( w, h );
-			static Image_4F zeroesF( w, h );
-
-			glBindTexture( GL_TEXTURE_2D, textureManager.Get( "Adam Color" ) );
-			glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA32F, w, h, 0, getFormat( GL_RGBA32F ), GL_FLOAT, ( void * ) zeroesF.GetImageDataBasePtr() );
+			// clear the pyramid ( the textures get it next upload ), and generate new offsets
+			pushPull.Clear();
+			NewOffsets();
+		}
 
-			glBindTexture( GL_TEXTURE_2D, textureManager.Get( "Adam Count" ) );
-			glTexImage2D( GL_TEXTURE_2D, 0, GL_R32UI, w, h, 0, getFormat( GL_R32UI ), GL_UNSIGNED_BYTE, ( void * ) zeroesU.GetImageDataBasePtr() );
+		{
+			SCOPED_TIMER( "Push-Pull Upload" );
+
+			// only what this batch touched goes up - level 0 samples either way, the right half of the display shows
+				// them directly, and the counts, so the GPU mip sweep can take over at any time
+			pushPull.TakeSampleRegions( sampleRegions );
+			pushPull.ResolveSamples( sampleColors, sampleRegions );
+			UploadRegions( "Adam Color", sampleRegions, GL_RGBA32F, GL_FLOAT, sampleColors.data(), sizeof( vec4 ) );
+			UploadRegions( "Adam Count", sampleRegions, GL_R32UI, GL_UNSIGNED_INT, pushPull.GetCounts(), sizeof( uint32_t ) );
+
+			if ( CPUReconstruction ) {
+				// redoes only the cells that can have changed, nothing at all if the batch was empty
+				pushPull.fill = bilinearFill ? pushPullCPU::fill_t::BILINEAR : pushPullCPU::fill_t::NEAREST;
+				pushPull.Reconstruct();
+				UploadRegions( "Adam Reconstruction", pushPull.OutputRegions(), GL_RGBA32F, GL_FLOAT, pushPull.GetOutput(), sizeof( vec4 ) );
+			}
+		}
+	}
 
-			// generate new offsets
-			NewOffsets();
+	// rects out of a full size, tightly packed level 0 buffer
+	void UploadRegions ( const string &texture, const std::vector< pushPullCPU::region_t > &regions, GLenum internalFormat, GLenum type, const void * data, size_t texelBytes ) {
+		if ( regions.empty() ) return;
+		glBindTexture( GL_TEXTURE_2D, textureManager.Get( texture ) );
+		glPixelStorei( GL_UNPACK_ROW_LENGTH, wInitial );
+		for ( const pushPullCPU::region_t &r : regions ) {
+			const uint8_t * start = ( const uint8_t * ) data + ( size_t( r.y ) * wInitial + r.x ) * texelBytes;
+			glTexSubImage2D( GL_TEXTURE_2D, 0, r.x, r.y, r.width, r.height, getFormat( internalFormat ), type, ( void * ) start );
 		}
+		glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
 	}
 
 	std::vector< ivec2 > offsets;
@@ -196,7 +247,7 @@ public:
 	}
 
 	void MipSweep () {
-		scopedTimer Start( "MIP" );
+		SCOPED_TIMER( "MIP" );
 		int w = wInitial / 2;
 		int h = hInitial / 2;
 		const GLuint shader = shaders[ "Up Mip" ];
@@ -224,7 +275,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -0,0 +1,651 @@
+#pragma once
+#ifndef PUSH_PULL_CPU_H
+#define PUSH_PULL_CPU_H
+
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "../../../utils/GLM/glm.hpp"
+#include "../../../engine/coreUtils/parallel.h"
+
+// CPU version of the Adam mip sweep - the same color / count pyramid as the "Adam Color" and "Adam Count" mips,
+	// where each cell holds the sum of the samples under it. Samples come in as batches of scattered points. Each one
+	// marks its parent dirty, and only the dirty cells ( and, in turn, their parents ) get rebuilt from their four
+	// children - a batch of a thousand samples touches a few thousand cells, instead of sweeping the whole chain.
+// Reconstruction is the pull half: starting from the 1x1 level, each empty cell takes its color from the level
+	// above it, either the parent texel ( same as draw.cs.glsl ) or a bilinear lookup, for a smoother fill. Cells whose
+	// mean changed are tracked per level, so after the first pass only those, and the empty cells that read from them,
+	// get pulled again. Both the new samples and the changed output come back as level 0 regions, for partial uploads.
+class pushPullCPU {
+public:
+	struct sample_t {
+		uint32_t x, y;
+		glm::vec4 color;
+	};
+
+	// a rect of level 0 texels, for glTexSubImage2D with GL_UNPACK_ROW_LENGTH set to the full width
+	struct region_t {
+		uint32_t x, y, width, height;
+	};
+
+	enum class fill_t { NEAREST, BILINEAR };
+
+	uint32_t numThreads = 0;		// 0 is one per core
+	fill_t fill = fill_t::NEAREST;
+
+	void Resize ( const uint32_t w, const uint32_t h ) {
+		levels.clear();
+		uint32_t lw = std::max( 1u, w ), lh = std::max( 1u, h );
+		while ( true ) {
+			level_t l;
+			l.width = lw;
+			l.height = lh;
+			const size_t cells = size_t( lw ) * lh;
+			l.sum.assign( cells, glm::vec4( 0.0f ) );
+			l.count.assign( cells, 0 );
+			l.dirty.assign( cells, 0 );
+			l.filled.assign( cells, glm::vec4( 0.0f ) );
+			l.stale.assign( cells, 0 );
+			levels.push_back( std::move( l ) );
+			if ( lw == 1 && lh == 1 ) break;
+			// odd sizes round up, so the last row / column has a parent of its own
+			lw = ( lw + 1 ) / 2;
+			lh = ( lh + 1 ) / 2;
+		}
+		touched.assign( levels[ 0 ].count.size(), 0 );
+		touchedList.clear();
+		numSamples = 0;
+		allTouched = true;
+		reconstructAll = true;
+	}
+
+	uint32_t Width () const { return levels.empty() ? 0 : levels[ 0 ].width; }
+	uint32_t Height () const { return levels.empty() ? 0 : levels[ 0 ].height; }
+	uint32_t NumLevels () const { return uint32_t( levels.size() ); }
+	size_t NumSamples () const { return numSamples; }
+
+	// per level sums and counts, for upload - counts match the GL_R32UI "Adam Count" layout
+	const glm::vec4 * GetSums ( const uint32_t level = 0 ) const { return levels[ level ].sum.data(); }
+	const uint32_t * GetCounts ( const uint32_t level = 0 ) const { return levels[ level ].count.data(); }
+
+	// full resolution result of the last Reconstruct
+	const glm::vec4 * GetOutput () const { return levels[ 0 ].filled.data(); }
+
+	// what the last Reconstruct changed in GetOutput() - empty if nothing did
+	const std::vector< region_t > &OutputRegions () const { return outputRegions; }
+
+	// level 0 texels that got samples ( or were cleared ) since the last call - what "Adam Color" and "Adam Count" need
+	void TakeSampleRegions ( std::vector< region_t > &out ) {
+		out.clear();
+		if ( allTouched ) {
+			out.push_back( { 0, 0, Width(), Height() } );
+		} else {
+			BuildRegions( touchedList, Width(), out );
+		}
+		for ( uint32_t index : touchedList ) touched[ index ] = 0;
+		touchedList.clear();
+		allTouched = false;
+	}
+
+	// next Reconstruct does every cell, e.g. after the output was lost
+	void InvalidateReconstruction () { reconstructAll = true; }
+
+	void Clear () {
+		for ( auto &l : levels ) {
+			std::fill( l.sum.begin(), l.sum.end(), glm::vec4( 0.0f ) );
+			std::fill( l.count.begin(), l.count.end(), 0 );
+			std::fill( l.dirty.begin(), l.dirty.end(), 0 );
+			l.dirtyList.clear();
+			std::fill( l.stale.begin(), l.stale.end(), 0 );
+			l.staleList.clear();
+		}
+		std::fill( touched.begin(), touched.end(), 0 );
+		touchedList.clear();
+		numSamples = 0;
+		allTouched = true;
+		reconstructAll = true;
+	}
+
+	// adds the samples into level 0 and updates every level above it - samples outside the image are dropped
+	void Insert ( const sample_t *samples, const size_t count ) {
+		PROFILE_SCOPE( "Push-Pull Insert" );
+		if ( levels.size() < 2 ) { // 1x1, nothing above it to update
+			for ( size_t i = 0; i < count; i++ ) {
+				if ( samples[ i ].x == 0 && samples[ i ].y == 0 ) {
+					levels[ 0 ].sum[ 0 ] += samples[ i ].color;
+					levels[ 0 ].count[ 0 ]++;
+					numSamples++;
+					MarkTouched( 0 );
+				}
+			}
+			return;
+		}
+
+		level_t &base = levels[ 0 ];
+		level_t &parents = levels[ 1 ];
+		const uint32_t threads = ResolveThreads( count, 1u << 16 );
+		if ( threads == 1 ) {
+			for ( size_t i = 0; i < count; i++ ) {
+				const sample_t &s = samples[ i ];
+				if ( s.x >= base.width || s.y >= base.height ) continue;
+				const size_t index = size_t( s.y ) * base.width + s.x;
+				base.sum[ index ] += s.color;
+				base.count[ index ]++;
+				numSamples++;
+				MarkTouched( uint32_t( index ) );
+				MarkDirty( parents, s.x / 2, s.y / 2 );
+			}
+		} else {
+			// each thread owns a band of rows, and only takes the samples that land in it - every thread reads the whole
+				// batch, but the writes need no atomics and keep their order, so the sums come out the same as one thread.
+				// Bands are split on even rows so that no parent row is shared, and the dirty list is built afterwards.
+			const uint32_t parentRows = parents.height;
+			std::vector< size_t > accepted( threads, 0 );
+			std::vector< std::vector< uint32_t > > newlyTouched( threads ); // bands don't share cells, so the flags dedupe these
+			std::vector< std::vector< uint32_t > > newlyStale( threads ); // separate from touched, which lasts until TakeSampleRegions
+			parallelForRanges( threads, [ & ] ( size_t, size_t, uint32_t t ) {
+				const uint32_t y0 = uint32_t( ( size_t( parentRows ) * t ) / threads ) * 2;
+				const uint32_t y1 = std::min( base.height, uint32_t( ( size_t( parentRows ) * ( t + 1 ) ) / threads ) * 2 );
+				size_t taken = 0;
+				for ( size_t i = 0; i < count; i++ ) {
+					const sample_t &s = samples[ i ];
+					if ( s.y < y0 || s.y >= y1 || s.x >= base.width ) continue;
+					const size_t index = size_t( s.y ) * base.width + s.x;
+					base.sum[ index ] += s.color;
+					base.count[ index ]++;
+					parents.dirty[ size_t( s.y / 2 ) * parents.width + s.x / 2 ] = 1;
+					if ( !touched[ index ] ) {
+						touched[ index ] = 1;
+						newlyTouched[ t ].push_back( uint32_t( index ) );
+					}
+					if ( !base.stale[ index ] ) {
+						base.stale[ index ] = 1;
+						newlyStale[ t ].push_back( uint32_t( index ) );
+					}
+					taken++;
+				}
+				accepted[ t ] = taken;
+			}, threads );
+			for ( size_t t : accepted ) numSamples += t;
+			for ( auto &list : newlyTouched ) touchedList.insert( touchedList.end(), list.begin(), list.end() );
+			for ( auto &list : newlyStale ) base.staleList.insert( base.staleList.end(), list.begin(), list.end() );
+
+			// gather the marked parents, keeping anything that was already queued
+			for ( uint32_t index : parents.dirtyList ) parents.dirty[ index ] = 2;
+			for ( size_t i = 0; i < parents.dirty.size(); i++ ) {
+				if ( parents.dirty[ i ] == 1 ) {
+					parents.dirtyList.push_back( uint32_t( i ) );
+				}
+			}
+			for ( uint32_t index : parents.dirtyList ) parents.dirty[ index ] = 1;
+		}
+		Propagate();
+	}
+	void Insert ( const std::vector< sample_t > &samples ) { Insert( samples.data(), samples.size() ); }
+
+	// rebuilds every dirty cell from its children, level by level, marking its parent in turn
+	void Propagate () {
+		PROFILE_SCOPE( "Push-Pull Propagate" );
+		for ( size_t l = 1; l < levels.size(); l++ ) {
+			level_t &current = levels[ l ];
+			if ( current.dirtyList.empty() ) break; // nothing dirty here means nothing dirty above, either
+
+			const level_t &children = levels[ l - 1 ];
+			const std::vector< uint32_t > &list = current.dirtyList;
+			parallelForRanges( list.size(), [ & ] ( size_t begin, size_t end, uint32_t ) {
+				for ( size_t i = begin; i < end; i++ ) {
+					RebuildCell( current, children, list[ i ] );
+				}
+			}, ResolveThreads( list.size(), 1u << 14 ) );
+
+			const bool last = ( l + 1 ) == levels.size();
+			for ( uint32_t index : list ) {
+				current.dirty[ index ] = 0;
+				MarkStale( current, index );
+				if ( !last ) {
+					MarkDirty( levels[ l + 1 ], ( index % current.width ) / 2, ( index / current.width ) / 2 );
+				}
+			}
+			current.dirtyList.clear();
+		}
+	}
+
+	// rebuilds every level above 0 from scratch - the whole mip sweep, for comparison
+	void Rebuild () {
+		PROFILE_SCOPE( "Push-Pull Rebuild" );
+		for ( size_t l = 1; l < levels.size(); l++ ) {
+			level_t &current = levels[ l ];
+			const level_t &children = levels[ l - 1 ];
+			parallelForRanges( current.height, [ & ] ( size_t begin, size_t end, uint32_t ) {
+				for ( size_t y = begin; y < end; y++ ) {
+					for ( uint32_t x = 0; x < current.width; x++ ) {
+						RebuildCell( current, children, uint32_t( y * current.width + x ) );
+					}
+				}
+			}, ResolveThreads( size_t( current.width ) * current.height, 1u << 14 ) );
+			std::fill( current.dirty.begin(), current.dirty.end(), 0 );
+			current.dirtyList.clear();
+		}
+		reconstructAll = true;
+	}
+
+	// pull pass, coarse to fine - each cell with samples is their mean, each empty one is filled from the level above.
+		// Only cells that can have changed are redone, unless everything is invalid ( first pass, Clear, fill change )
+	void Reconstruct () {
+		PROFILE_SCOPE( "Push-Pull Reconstruct" );
+		outputRegions.clear();
+		if ( reconstructAll || fill != lastFill ) {
+			ReconstructAll();
+			outputRegions.push_back( { 0, 0, Width(), Height() } );
+			return;
+		}
+
+		const int top = int( levels.size() ) - 1;
+		if ( levels[ top ].staleList.empty() ) return; // every sample changes the top cell, so nothing changed at all
+		levels[ top ].filled[ 0 ] = Mean( levels[ top ], 0 );
+		for ( int l = top - 1; l >= 0; l-- ) {
+			level_t &current = levels[ l ];
+			level_t &above = levels[ l + 1 ];
+
+			// on top of the cells with a new mean, the empty ones reading from a parent that changed - the parent texel,
+				// or for bilinear, any of the four parents around it
+			const int reach = ( fill == fill_t::NEAREST ) ? 0 : 1;
+			for ( uint32_t parent : above.staleList ) {
+				const int px = int( parent % above.width ), py = int( parent / above.width );
+				const int x0 = std::max( 0, 2 * px - reach ), x1 = std::min( int( current.width ) - 1, 2 * px + 1 + reach );
+				const int y0 = std::max( 0, 2 * py - reach ), y1 = std::min( int( current.height ) - 1, 2 * py + 1 + reach );
+				for ( int y = y0; y <= y1; y++ ) {
+					for ( int x = x0; x <= x1; x++ ) {
+						const uint32_t index = uint32_t( y ) * current.width + uint32_t( x );
+						if ( current.count[ index ] == 0 ) MarkStale( current, index );
+					}
+				}
+			}
+
+			const std::vector< uint32_t > &list = current.staleList;
+			parallelForRanges( list.size(), [ & ] ( size_t begin, size_t end, uint32_t ) {
+				for ( size_t i = begin; i < end; i++ ) {
+					if ( fill == fill_t::NEAREST ) {
+						PullCellNearest( current, above, list[ i ] );
+					} else {
+						PullCellBilinear( current, above, list[ i ] );
+					}
+				}
+			}, ResolveThreads( list.size(), 1u << 14 ) );
+			ClearStale( above );
+		}
+		BuildRegions( levels[ 0 ].staleList, Width(), outputRegions );
+		ClearStale( levels[ 0 ] );
+	}
+
+	// every cell, every level
+	void ReconstructAll () {
+		PROFILE_SCOPE( "Push-Pull Reconstruct All" );
+		const int top = int( levels.size() ) - 1;
+		levels[ top ].filled[ 0 ] = Mean( levels[ top ], 0 );
+		for ( int l = top - 1; l >= 0; l-- ) {
+			level_t &current = levels[ l ];
+			const level_t &above = levels[ l + 1 ];
+			parallelForRanges( current.height, [ & ] ( size_t begin, size_t end, uint32_t ) {
+				for ( size_t y = begin; y < end; y++ ) {
+					if ( fill == fill_t::NEAREST ) {
+						PullRowNearest( current, above, uint32_t( y ) );
+					} else {
+						PullRowBilinear( current, above, uint32_t( y ) );
+					}
+				}
+			}, ResolveThreads( size_t( current.width ) * current.height, 1u << 14 ) );
+		}
+		for ( auto &l : levels ) ClearStale( l );
+		reconstructAll = false;
+		lastFill = fill;
+	}
+
+	// just the samples - the mean at each level 0 pixel, zero where there are none
+	void ResolveSamples ( std::vector< glm::vec4 > &out ) const {
+		const level_t &base = levels[ 0 ];
+		out.resize( base.sum.size() );
+		parallelForRanges( base.height, [ & ] ( size_t begin, size_t end, uint32_t ) {
+			for ( size_t i = begin * base.width; i < end * base.width; i++ ) {
+				out[ i ] = Mean( base, i );
+			}
+		}, ResolveThreads( base.sum.size(), 1u << 14 ) );
+	}
+
+	// the same, only inside these regions - out has to be full size already, everything else is left as it was
+	void ResolveSamples ( std::vector< glm::vec4 > &out, const std::vector< region_t > &regions ) const {
+		const level_t &base = levels[ 0 ];
+		out.resize( base.sum.size() );
+		for ( const region_t &r : regions ) {
+			parallelForRanges( r.height, [ & ] ( size_t begin, size_t end, uint32_t ) {
+				for ( size_t y = r.y + begin; y < r.y + end; y++ ) {
+					for ( size_t i = y * base.width + r.x; i < y * base.width + r.x + r.width; i++ ) {
+						out[ i ] = Mean( base, i );
+					}
+				}
+			}, ResolveThreads( size_t( r.width ) * r.height, 1u << 14 ) );
+		}
+	}
+
+	static size_t RegionTexels ( const std::vector< region_t > &regions ) {
+		size_t texels = 0;
+		for ( const region_t &r : regions ) texels += size_t( r.width ) * r.height;
+		return texels;
+	}
+
+	struct benchmarkResult_t {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t numThreads = 0;
+		size_t numSamples = 0;
+		size_t batchSize = 0;
+		double samplesPerSecond = 0.0;	// insertion, with the dirty cells propagated after each batch
+		float batchMs = 0.0f;
+		float rebuildMs = 0.0f;			// full sweep of every level, what each batch would cost without the dirty lists
+		float nearestMs = 0.0f;			// reconstruction, half the pixels covered
+		float bilinearMs = 0.0f;
+		double bigBatchSamplesPerSecond = 0.0; // the whole set in one batch, for the banded insert
+		bool matches = false;			// incremental pyramid is identical to a full rebuild
+		float incrementalMs = 0.0f;		// Reconstruct after every batch, averaged over the second half of the run
+		double uploadBytes = 0.0;		// per batch, samples + counts + reconstruction regions, same half
+		double uploadRegions = 0.0;		// glTexSubImage2D calls per batch, same half
+		bool reconstructMatches = false;// incremental output is identical to a full pass
+	};
+
+	// samples in the same order as Adam's shuffled offsets - each pixel once, in random order
+	static std::vector< sample_t > GenerateSamples ( const uint32_t w, const uint32_t h, const size_t count, const uint32_t seed = 0 ) {
+		std::vector< uint32_t > order( size_t( w ) * h );
+		for ( size_t i = 0; i < order.size(); i++ ) order[ i ] = uint32_t( i );
+		std::mt19937 gen( seed );
+		std::shuffle( order.begin(), order.end(), gen );
+		std::uniform_real_distribution< float > value( 0.0f, 1.0f );
+		std::vector< sample_t > samples( std::min( count, order.size() ) );
+		for ( size_t i = 0; i < samples.size(); i++ ) {
+			samples[ i ].x = order[ i ] % w;
+			samples[ i ].y = order[ i ] / w;
+			samples[ i ].color = glm::vec4( value( gen ), value( gen ), value( gen ), 1.0f );
+		}
+		return samples;
+	}
+
+	static benchmarkResult_t Benchmark ( const uint32_t w, const uint32_t h, const size_t batchSize ) {
+		benchmarkResult_t result;
+		result.width = w;
+		result.height = h;
+		result.numThreads = parallelThreadCount();
+		result.batchSize = std::max( size_t( 1 ), batchSize );
+
+		const std::vector< sample_t > samples = GenerateSamples( w, h, size_t( w ) * h );
+		result.numSamples = samples.size();
+		pushPullCPU pp;
+		pp.Resize( w, h );
+		std::vector< region_t > sampleRegions;
+		pp.TakeSampleRegions( sampleRegions );
+
+		// batches, like Adam's per frame updates - reconstruct timed at the halfway point
+		size_t batches = 0;
+		auto tStart = std::chrono::high_resolution_clock::now();
+		double insertSeconds = 0.0;
+		for ( size_t i = 0; i < samples.size(); i += result.batchSize ) {
+			pp.Insert( samples.data() + i, std::min( result.batchSize, samples.size() - i ) );
+			batches++;
+			if ( i < samples.size() / 2 && i + result.batchSize >= samples.size() / 2 ) {
+				insertSeconds += std::chrono::duration< double >( std::chrono::high_resolution_clock::now() - tStart ).count();
+				pp.fill = fill_t::NEAREST;
+				auto t = std::chrono::high_resolution_clock::now();
+				pp.Reconstruct();
+				result.nearestMs = float( std::chrono::duration< double, std::milli >( std::chrono::high_resolution_clock::now() - t ).count() );
+				pp.fill = fill_t::BILINEAR;
+				t = std::chrono::high_resolution_clock::now();
+				pp.Reconstruct();
+				result.bilinearMs = float( std::chrono::duration< double, std::milli >( std::chrono::high_resolution_clock::now() - t ).count() );
+				tStart = std::chrono::high_resolution_clock::now();
+			}
+		}
+		insertSeconds += std::chrono::duration< double >( std::chrono::high_resolution_clock::now() - tStart ).count();
+		result.samplesPerSecond = double( samples.size() ) / insertSeconds;
+		result.batchMs = float( insertSeconds * 1000.0 / std::max( size_t( 1 ), batches ) );
+
+		// the same run again, with Adam's per frame reconstruct and uploads - measured over the second half
+		pushPullCPU frames;
+		frames.Resize( w, h );
+		frames.fill = fill_t::NEAREST;
+		double incrementalSeconds = 0.0;
+		size_t measuredBatches = 0;
+		for ( size_t i = 0; i < samples.size(); i += result.batchSize ) {
+			frames.Insert( samples.data() + i, std::min( result.batchSize, samples.size() - i ) );
+			frames.TakeSampleRegions( sampleRegions );
+			const auto t = std::chrono::high_resolution_clock::now();
+			frames.Reconstruct();
+			if ( i >= samples.size() / 2 ) {
+				incrementalSeconds += std::chrono::duration< double >( std::chrono::high_resolution_clock::now() - t ).count();
+				result.uploadBytes += double( RegionTexels( sampleRegions ) ) * ( sizeof( glm::vec4 ) + sizeof( uint32_t ) ) + double( RegionTexels( frames.OutputRegions() ) ) * sizeof( glm::vec4 );
+				result.uploadRegions += double( 2 * sampleRegions.size() + frames.OutputRegions().size() );
+				measuredBatches++;
+			}
+		}
+		measuredBatches = std::max( size_t( 1 ), measuredBatches );
+		result.incrementalMs = float( incrementalSeconds * 1000.0 / measuredBatches );
+		result.uploadBytes /= measuredBatches;
+		result.uploadRegions /= measuredBatches;
+		pushPullCPU full = frames;
+		full.InvalidateReconstruction();
+		full.Reconstruct();
+		result.reconstructMatches = memcmp( full.GetOutput(), frames.GetOutput(), size_t( w ) * h * sizeof( glm::vec4 ) ) == 0;
+
+		// the full sweep has to give exactly the same pyramid - same cells, same adds, same order
+		pushPullCPU reference = pp;
+		tStart = std::chrono::high_resolution_clock::now();
+		reference.Rebuild();
+		result.rebuildMs = float( std::chrono::duration< double, std::milli >( std::chrono::high_resolution_clock::now() - tStart ).count() );
+		result.matches = true;
+		for ( size_t l = 0; l < pp.levels.size() && result.matches; l++ ) {
+			result.matches = pp.levels[ l ].count == reference.levels[ l ].count && pp.levels[ l ].sum == reference.levels[ l ].sum;
+		}
+
+		// everything at once
+		pp.Clear();
+		tStart = std::chrono::high_resolution_clock::now();
+		pp.Insert( samples );
+		result.bigBatchSamplesPerSecond = double( samples.size() ) / std::chrono::duration< double >( std::chrono::high_resolution_clock::now() - tStart ).count();
+		for ( size_t l = 0; l < pp.levels.size() && result.matches; l++ ) {
+			result.matches = pp.levels[ l ].count == reference.levels[ l ].count && pp.levels[ l ].sum == reference.levels[ l ].sum;
+		}
+		return result;
+	}
+
+private:
+	struct level_t {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector< glm::vec4 > sum;		// sum of the sample colors under each cell
+		std::vector< uint32_t > count;		// number of samples under each cell
+		std::vector< uint8_t > dirty;		// queued in dirtyList, needs a rebuild from the level below
+		std::vector< uint32_t > dirtyList;
+		std::vector< glm::vec4 > filled;	// Reconstruct output for this level
+		std::vector< uint8_t > stale;		// queued in staleList, filled needs redoing
+		std::vector< uint32_t > staleList;
+	};
+	std::vector< level_t > levels;
+	size_t numSamples = 0;
+
+	// level 0 cells with new samples, not yet handed out by TakeSampleRegions - allTouched after a Clear
+	std::vector< uint8_t > touched;
+	std::vector< uint32_t > touchedList;
+	bool allTouched = true;
+
+	bool reconstructAll = true;
+	fill_t lastFill = fill_t::NEAREST;
+	std::vector< region_t > outputRegions;
+
+	// texels this close together on a row go up as one run, rather than another call - and about what another call
+		// is worth, in texels uploaded for nothing, when growing a rect by a row
+	static constexpr uint32_t regionGap = 64;
+	static constexpr size_t regionWaste = 64;
+
+	uint32_t ResolveThreads ( const size_t work, const size_t minimumPerThread ) const {
+		const uint32_t threads = numThreads ? numThreads : parallelThreadCount();
+		return uint32_t( std::max( size_t( 1 ), std::min( size_t( threads ), work / minimumPerThread ) ) );
+	}
+
+	void MarkTouched ( const uint32_t index ) {
+		if ( !touched[ index ] ) {
+			touched[ index ] = 1;
+			touchedList.push_back( index );
+		}
+		MarkStale( levels[ 0 ], index );
+	}
+
+	static void MarkStale ( level_t &l, const uint32_t index ) {
+		if ( !l.stale[ index ] ) {
+			l.stale[ index ] = 1;
+			l.staleList.push_back( index );
+		}
+	}
+
+	static void ClearStale ( level_t &l ) {
+		for ( uint32_t index : l.staleList ) l.stale[ index ] = 0;
+		l.staleList.clear();
+	}
+
+	// cells to rects - runs along each row, merging across gaps up to regionGap, then a run on the next row grows a
+		// rect downwards if that uploads at most regionWaste texels that weren't asked for, so dense updates come out
+		// as a few big uploads
+	static void BuildRegions ( std::vector< uint32_t > cells, const uint32_t width, std::vector< region_t > &out ) {
+		out.clear();
+		if ( cells.empty() ) return;
+		std::sort( cells.begin(), cells.end() );
+		size_t open = 0; // regions from here on ended on the previous row, and can still grow downwards
+		size_t i = 0;
+		while ( i < cells.size() ) {
+			const uint32_t y = cells[ i ] / width;
+			const size_t rowStart = out.size();
+			while ( i < cells.size() && cells[ i ] / width == y ) {
+				const uint32_t x0 = cells[ i ] % width;
+				uint32_t x1 = x0;
+				for ( i++; i < cells.size() && cells[ i ] / width == y && cells[ i ] % width <= x1 + regionGap; i++ ) {
+					x1 = cells[ i ] % width;
+				}
+
+				// extend a rect from the row above, if one lines up
+				bool merged = false;
+				for ( size_t r = open; r < rowStart && !merged; r++ ) {
+					region_t &region = out[ r ];
+					if ( region.y + region.height != y ) continue;
+					const uint32_t left = std::min( region.x, x0 );
+					const uint32_t right = std::max( region.x + region.width - 1, x1 );
+					const size_t grown = size_t( right - left + 1 ) * ( region.height + 1 );
+					const size_t parts = size_t( region.width ) * region.height + ( x1 - x0 + 1 );
+					if ( grown - parts <= regionWaste ) {
+						region.x = left;
+						region.width = right - left + 1;
+						region.height++;
+						merged = true;
+					}
+				}
+				if ( !merged ) out.push_back( { x0, y, x1 - x0 + 1, 1 } );
+			}
+
+			// anything that didn't reach this row is closed - move the ones that did to the back, so they stay open
+			open = size_t( std::stable_partition( out.begin() + open, out.end(), [ y ] ( const region_t &r ) { return r.y + r.height <= y; } ) - out.begin() );
+		}
+
+		// mostly covered anyway, one band of full rows is cheaper than all those calls
+		const uint32_t y0 = cells.front() / width, y1 = cells.back() / width;
+		if ( RegionTexels( out ) * 2 >= size_t( width ) * ( y1 - y0 + 1 ) ) {
+			out.assign( 1, { 0, y0, width, y1 - y0 + 1 } );
+		}
+	}
+
+	static void MarkDirty ( level_t &l, const uint32_t x, const uint32_t y ) {
+		const uint32_t index = y * l.width + x;
+		if ( !l.dirty[ index ] ) {
+			l.dirty[ index ] = 1;
+			l.dirtyList.push_back( index );
+		}
+	}
+
+	static glm::vec4 Mean ( const level_t &l, const size_t index ) {
+		const uint32_t c = l.count[ index ];
+		return c ? l.sum[ index ] / float( c ) : glm::vec4( 0.0f );
+	}
+
+	// sum of the ( up to ) four children - the upmip.cs.glsl weighted average, without dividing back out
+	static void RebuildCell ( level_t &current, const level_t &children, const uint32_t index ) {
+		const uint32_t x = ( index % current.width ) * 2;
+		const uint32_t y = ( index / current.width ) * 2;
+		const bool right = x + 1 < children.width;
+		const bool down = y + 1 < children.height;
+		const size_t i0 = size_t( y ) * children.width + x;
+		const size_t i1 = i0 + children.width;
+
+		glm::vec4 sum = children.sum[ i0 ];
+		uint32_t count = children.count[ i0 ];
+		if ( right ) { sum += children.sum[ i0 + 1 ]; count += children.count[ i0 + 1 ]; }
+		if ( down ) { sum += children.sum[ i1 ]; count += children.count[ i1 ]; }
+		if ( right && down ) { sum += children.sum[ i1 + 1 ]; count += children.count[ i1 + 1 ]; }
+		current.sum[ index ] = sum;
+		current.count[ index ] = count;
+	}
+
+	static void PullRowNearest ( level_t &current, const level_t &above, const uint32_t y ) {
+		const size_t row = size_t( y ) * current.width;
+		const glm::vec4 *parentRow = above.filled.data() + size_t( y / 2 ) * above.width;
+		for ( uint32_t x = 0; x < current.width; x++ ) {
+			// half covered is the worst case for a branch here, so it's a blend with a 0 or 1 weight
+			const uint32_t c = current.count[ row + x ];
+			const float covered = c ? 1.0f : 0.0f;
+			current.filled[ row + x ] = current.sum[ row + x ] * ( covered / float( std::max( c, 1u ) ) ) + ( 1.0f - covered ) * parentRow[ x / 2 ];
+		}
+	}
+
+	// single cell versions for the incremental pass - same arithmetic as the rows, so the output matches bit for bit
+	static void PullCellNearest ( level_t &current, const level_t &above, const uint32_t index ) {
+		const uint32_t x = index % current.width, y = index / current.width;
+		const uint32_t c = current.count[ index ];
+		const float covered = c ? 1.0f : 0.0f;
+		current.filled[ index ] = current.sum[ index ] * ( covered / float( std::max( c, 1u ) ) ) + ( 1.0f - covered ) * above.filled[ size_t( y / 2 ) * above.width + x / 2 ];
+	}
+
+	static void PullCellBilinear ( level_t &current, const level_t &above, const uint32_t index ) {
+		const uint32_t x = index % current.width, y = index / current.width;
+		const uint32_t c = current.count[ index ];
+		if ( c ) {
+			current.filled[ index ] = current.sum[ index ] / float( c );
+		} else {
+			const int py = int( y / 2 );
+			const int pyn = std::clamp( ( y & 1 ) ? py + 1 : py - 1, 0, int( above.height ) - 1 );
+			const int px = int( x / 2 );
+			const int pxn = std::clamp( ( x & 1 ) ? px + 1 : px - 1, 0, int( above.width ) - 1 );
+			const glm::vec4 *r0 = above.filled.data() + size_t( py ) * above.width;
+			const glm::vec4 *r1 = above.filled.data() + size_t( pyn ) * above.width;
+			current.filled[ index ] = 0.5625f * r0[ px ] + 0.1875f * ( r0[ pxn ] + r1[ px ] ) + 0.0625f * r1[ pxn ];
+		}
+	}
+
+	// parent texel centers sit at 2x + 0.5 in this level, so the weights only alternate between 1/4 and 3/4
+	static void PullRowBilinear ( level_t &current, const level_t &above, const uint32_t y ) {
+		const size_t row = size_t( y ) * current.width;
+		const int py = int( y / 2 );
+		const int pyn = std::clamp( ( y & 1 ) ? py + 1 : py - 1, 0, int( above.height ) - 1 );
+		const glm::vec4 *r0 = above.filled.data() + size_t( py ) * above.width;
+		const glm::vec4 *r1 = above.filled.data() + size_t( pyn ) * above.width;
+		for ( uint32_t x = 0; x < current.width; x++ ) {
+			const uint32_t c = current.count[ row + x ];
+			if ( c ) {
+				current.filled[ row + x ] = current.sum[ row + x ] / float( c );
+			} else {
+				const int px = int( x / 2 );
+				const int pxn = std::clamp( ( x & 1 ) ? px + 1 : px - 1, 0, int( above.width ) - 1 );
+				current.filled[ row + x ] = 0.5625f * r0[ px ] + 0.1875f * ( r0[ pxn ] + r1[ px ] ) + 0.0625f * r1[ pxn ];
+			}
+		}
+	}
+};
+
+#endif // PUSH_PULL_CPU_H
@@ -6,6 +6,8 @@ layout( binding = 1, rgba16f ) uniform image2D accumulatorTexture;
 
 uniform sampler2D adamColor;
 uniform usampler2D adamCount;
+uniform sampler2D adamReconstruction;
+uniform bool cpuReconstruction;
 
 uniform float time;
 uniform float percentDone;
@@ -15,7 +17,10 @@ void main () {
 	ivec2 writeLoc = ivec2( gl_GlobalInvocationID.xy );
 	vec3 col = vec3( 0.0f );
 
-	if ( writeLoc.x < 1024 ) {
+	if ( writeLoc.x < 1024 && cpuReconstruction ) {
+		// pull pass already done on the CPU
+		col = texelFetch( adamReconstruction, writeLoc, 0 ).rgb;
+	} else if ( writeLoc.x < 1024 ) {
 		// textureQueryLevels gives number of mipmaps... not sure if that's really useful right now
 		const int numLevels = textureQueryLevels( adamCount );
 
@@ -135,7 +135,7 @@ public:
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		// get new data into the input handler
 		inputHandler.update();
@@ -175,7 +175,7 @@ public:
 		if ( CantorDustConfig.needsUpdate ) {
 			CantorDustConfig.needsUpdate = false;
 
-			scopedTimer Start( "Update" );
+			SCOPED_TIMER( "Update" );
 			const GLuint shader = shaders[ "Update" ];
 			glUseProgram( shader );
 
@@ -205,7 +205,7 @@ public:
 		}
 
 		{
-			scopedTimer Start( "DDA Block Prep" );
+			SCOPED_TIMER( "DDA Block Prep" );
 			const GLuint shader = shaders[ "Block" ];
 			glUseProgram( shader );
 
@@ -220,7 +220,7 @@ public:
 		}
 
 		{ // dummy draw - draw something into accumulatorTexture
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 
 			const GLuint shader = shaders[ "Draw" ];
@@ -241,7 +241,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -250,7 +250,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Clear();
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 
@@ -264,7 +264,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 		// application-specific update code
 	}
 
@@ -274,7 +274,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -1,137 +1,5 @@
 #include "../../../engine/engine.h"
-
-// float lerp(f0,f1,p)
-// float f0, f1, p;
-// {
-// 	return ( ( f0 * ( 1.0 - p ) ) + ( f1 * p ) );
-// }
-
-float lerp ( float f0, float f1, float p ){
-	return ( ( f0 * ( 1.0 - p ) ) + ( f1 * p ) );
-}
-
-struct quad {
-	vec2 p1, p2, p3, p4;
-};
-
-struct strokeFilter_t {
-	float curx, cury;
-	float velx, vely, vel;
-	float accx, accy, acc;
-	float angx, angy;
-	float mass, drag;
-	float lastx, lasty;
-	bool fixedangle = true;
-
-	// previously global state
-	float currMass = 0.5f, currDrag = 0.15f;
-	float initWidth = 1.5f;
-	float odelX, odelY;
-
-	// reset filter parameterization
-	void init ( vec2 mouse ) {
-		// update positions
-		lastx = curx = mouse.x;
-		lasty = cury = mouse.y;
-		// upate other terms
-		velx = accx = odelX = 0.0f;
-		vely = accy = odelY = 0.0f;
-		active = true;
-	}
-
-	// apply the filter - return false on static conditions
-	void filterApply ( vec2 mouse ) {
-		float mass, drag;
-		float fx, fy;
-
-	/* calculate mass and drag */
-		mass = lerp( 1.0f, 160.0f, currMass );
-		drag = lerp( 0.00f, 0.5f, currDrag * currDrag );
-
-	/* calculate force and acceleration */
-		fx = mouse.x - curx;
-		fy = mouse.y - cury;
-		acc = sqrt( fx * fx + fy * fy );
-		if ( acc < 0.000001f ) {
-			active = false; // computed stroke length goes to zero for low acceleration
-			return;
-		}
-		accx = fx / mass;
-		accy = fy / mass;
-
-	/* calculate new velocity */
-		velx += accx;
-		vely += accy;
-		vel = sqrt( velx * velx + vely * vely );
-		angx = -vely;
-		angy = velx;
-		if ( vel < 0.000001f ) {
-			active = false; // computed stroke length goes to zero for low velocity
-			return;
-		}
-
-	/* calculate angle of drawing tool */
-		angx /= vel;
-		angy /= vel;
-		if ( fixedangle ) {
-			angx = 0.6f;
-			angy = 0.2f;
-		}
-
-	/* apply drag */
-		velx = velx * ( 1.0f - drag );
-		vely = vely * ( 1.0f - drag );
-
-	/* update position */
-		lastx = curx;
-		lasty = cury;
-		curx = curx + velx;
-		cury = cury + vely;
-	}
-
-	quad currentQuad;
-	quad getStrokeQuad () {
-		float delx, dely;
-		float wid;
-		float px, py, nx, ny;
-
-		wid = 0.04f - vel;
-		wid = wid * initWidth;
-		if( wid < 0.00001f ) {
-			wid = 0.00001f;
-		}
-		delx = angx * wid;
-		dely = angy * wid;
-
-		px = lastx;
-		py = lasty;
-		nx = curx;
-		ny = cury;
-
-		// the four points for the quad
-		currentQuad.p1 = vec2( px + odelX, py + odelY );
-		currentQuad.p2 = vec2( px - odelX, py - odelY );
-		currentQuad.p3 = vec2( nx - delx, ny - dely );
-		currentQuad.p4 = vec2( nx + delx, ny + dely );
-
-		// updating deltas
-		odelY = dely;
-		odelX = delx;
-
-		return currentQuad;
-	}
-
-	bool active = false;
-	void update ( vec2 mouse ) {
-
-		if ( active ) {
-			// apply the brush dynamics
-			filterApply( mouse );
-			// this needs to get drawn, eventually
-			getStrokeQuad();
-		}
-	}
-};
+#include "paintCanvas.h"
 
 struct jbPaintState {
 	float brushRadius = 25.0f;
@@ -140,6 +8,7 @@ struct jbPaintState {
 	vec3 brushColor = vec3( 0.1f );
 
 	strokeFilter_t stroke;
+	int filterStepsPerFrame = 1;
 };
 
 class jbPaint final : public engineBase { // sample derived from base engine class
@@ -149,6 +18,22 @@ public:
 
 	jbPaintState state;
 
+	// CPU canvas takes all of a frame's stroke segments at once, and keeps the undo history
+	paintCanvasCPU canvas;
+	bool CPUCanvas = true;
+
+	// mouse positions for each stroke drawn, for replaying in the benchmark
+	std::vector< paintCanvasCPU::inputPath_t > recordedPaths;
+
+	paintCanvasCPU::brush_t CurrentBrush () const {
+		paintCanvasCPU::brush_t brush;
+		brush.radius = paintCanvasCPU::VelocityRadius( state.brushRadius, state.stroke.vel );
+		brush.slope = state.brushSlope;
+		brush.threshold = state.brushThreshold;
+		brush.color = state.brushColor;
+		return brush;
+	}
+
 	void CompileShaders () {
 		// something to put some basic data in the accumulator texture
 		shaders[ "Draw" ] = computeShader( "./src/projects/SignalProcessing/jbPaint/shaders/draw.cs.glsl" ).shaderHandle;
@@ -170,6 +55,28 @@ public:
 			opts.textureType	= GL_TEXTURE_2D;
 			textureManager.Add( "Paint Buffer", opts );
 
+			canvas.Resize( config.width, config.height );
+
+			terminal.addCommand( { "paintBenchmark" }, {
+					{ "paths", INT, "Number of generated paths, when there are no recorded strokes." },
+					{ "steps", INT, "Filter updates per frame." }
+				}, [=] ( args_t args ) {
+					const bool recorded = !recordedPaths.empty();
+					const std::vector< paintCanvasCPU::inputPath_t > paths = recorded ? recordedPaths : paintCanvasCPU::GeneratePaths( size_t( std::clamp( int( args[ "paths" ].data.x ), 1, 10000 ) ), float( config.width ) / float( config.height ) );
+					paintCanvasCPU::brush_t brush;
+					brush.radius = state.brushRadius;
+					brush.slope = state.brushSlope;
+					brush.threshold = state.brushThreshold;
+					brush.color = state.brushColor;
+					const paintCanvasCPU::benchmarkResult_t result = paintCanvasCPU::Benchmark( paths, config.width, config.height, state.stroke, brush, std::max( 1, int( args[ "steps" ].data.x ) ) );
+					terminal.addLineBreak();
+					terminal.addHistoryLine( terminal.csb.append( "Paint Canvas Benchmark ", 3 ).append( "[ " + to_string( result.numPaths ) + ( recorded ? " recorded" : " generated" ) + " strokes, " + GetWithThousandsSeparator( result.numSegments ) + " segments at " + to_string( result.width ) + "x" + to_string( result.height ) + ", " + to_string( result.numThreads ) + " threads ]", GREY_DD ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  " + to_string( result.strokesPerSecond ) + " strokes/sec, " + GetWithThousandsSeparator( size_t( result.segmentsPerSecond ) ) + " segments/sec, " + to_string( result.tilesPerFrame ) + " tiles per frame" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  flushing every segment: " + GetWithThousandsSeparator( size_t( result.unbatchedSegmentsPerSecond ) ) + " segments/sec" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  undo history " + GetWithThousandsSeparator( result.historyBytes ) + " bytes, vs " + GetWithThousandsSeparator( result.fullSnapshotBytes ) + " for full snapshots" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  undo all " + to_string( result.undoAllMs ) + "ms, redo all " + to_string( result.redoAllMs ) + "ms, " ).append( result.undoMatches ? "matches" : "MISMATCH", GREY_DD ).flush() );
+					terminal.addLineBreak();
+				}, "Replay recorded ( or generated ) strokes through the CPU paint canvas, and time it." );
 		}
 	}
 
@@ -198,6 +105,17 @@ public:
 			ImGui::Separator();
 			ImGui::SliderFloat( "Mass", &state.stroke.currMass, 0.0f, 3.0f );
 			ImGui::SliderFloat( "Drag", &state.stroke.currDrag, 0.0f, 1.0f );
+			ImGui::SliderInt( "Filter Steps Per Frame", &state.filterStepsPerFrame, 1, 16 );
+			ImGui::SeparatorText( "Canvas" );
+			if ( ImGui::Checkbox( "CPU Canvas", &CPUCanvas ) && CPUCanvas ) {
+				canvas.Invalidate(); // the GPU path drew over it
+			}
+			if ( CPUCanvas ) {
+				ImGui::Text( "%d undo, %d redo ( Ctrl+Z / Ctrl+Shift+Z )", int( canvas.UndoSteps() ), int( canvas.RedoSteps() ) );
+				ImGui::Text( "History: %.1f MB, canvas: %.1f MB", canvas.HistoryBytes() / 1e6f, canvas.CanvasBytes() / 1e6f );
+				ImGui::Text( "Last flush: %d segments, %d tiles", int( canvas.lastFlush.segments ), int( canvas.lastFlush.tiles ) );
+			}
+			ImGui::End();
 		}
 
 		QuitConf( &quitConfirm ); // show quit confirm window, if triggered
@@ -209,7 +127,7 @@ public:
 		ZoneScoped;
 
 		{ // draw - draw something into accumulatorTexture
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 
 			const GLuint shader = shaders[ "Draw" ];
@@ -222,7 +140,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -231,7 +149,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Clear();
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 
@@ -245,74 +163,122 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		if ( inputHandler.getState4( KEY_R ) == KEYSTATE_RISING ) {
 			textureManager.ZeroTexture2D( "Paint Buffer" );
+			canvas.Clear();
 		}
 
 		if ( inputHandler.getState4( KEY_Y ) == KEYSTATE_RISING ) {
 			CompileShaders();
 		}
 
+		// undo / redo, on the CPU canvas
+		const bool control = inputHandler.getState( KEY_LEFT_CTRL ) || inputHandler.getState( KEY_RIGHT_CTRL );
+		const bool shift = inputHandler.getState( KEY_LEFT_SHIFT ) || inputHandler.getState( KEY_RIGHT_SHIFT );
+		if ( CPUCanvas && control && inputHandler.getState4( KEY_Z ) == KEYSTATE_RISING ) {
+			if ( shift ) {
+				canvas.Redo();
+			} else {
+				canvas.Undo();
+			}
+		}
+
+		const float scale = float( std::min( config.width, config.height ) );
+
+		const bool mouseState = inputHandler.getState( MOUSE_BUTTON_LEFT ) && !ImGui::GetIO().WantCaptureMouse;
+		ivec2 mousePos = inputHandler.getMousePos();
+		vec2 mousePosNorm = vec2( mousePos.x, mousePos.y ) / scale;
+
+		if ( mouseState ) {
+			switch ( inputHandler.getState4( MOUSE_BUTTON_LEFT ) ) {
+				case KEYSTATE_OFF: break;
+				case KEYSTATE_RISING:
+					// set initial filter parameters
+					state.stroke.init( mousePosNorm );
+					canvas.BeginStroke();
+					recordedPaths.push_back( { mousePosNorm } );
+					break;
+				case KEYSTATE_ON:
+					// to handle more than one state update per frame - the CPU canvas takes them all in one batch
+					for ( int i = 0; i < state.filterStepsPerFrame; i++ ) {
+						// update the filter
+						state.stroke.update( mousePosNorm + vec2( 0.01f ) );
+						if ( CPUCanvas ) {
+							const quad &q = state.stroke.currentQuad;
+							canvas.AddSegment( { scale * q.p1, scale * q.p2, scale * q.p3, scale * q.p4 }, CurrentBrush() );
+						} else {
+							DispatchStrokeSegment( scale, mouseState );
+						}
+					}
+					if ( !recordedPaths.empty() ) {
+						recordedPaths.back().push_back( mousePosNorm );
+					}
+					break;
+				case KEYSTATE_FALLING:
+					// state.stroke.active = false;
+					break;
+			}
+		} else {
+			canvas.EndStroke();
+		}
+
+		if ( CPUCanvas ) {
+			canvas.Flush();
+			UploadCanvas();
+		}
+	}
+
+	// one dispatch over the whole paint buffer, for the current stroke quad
+	void DispatchStrokeSegment ( const float scale, const bool mouseState ) {
 		const GLuint shader = shaders[ "Update" ];
 		glUseProgram( shader );
 
 		textureManager.BindImageForShader( "Blue Noise", "blueNoiseTexture", shader, 0 );
 		textureManager.BindImageForShader( "Paint Buffer", "paintBuffer", shader, 2 );
 
-		// to handle more than one state update per frame
-		const int numUpdates = 1;
-		for ( int i = 0 ; i < numUpdates; i++ ) {
+		static rngi noiseOffset = rngi( 0, 512 );
+		glUniform2i( glGetUniformLocation( shader, "noiseOffset" ), noiseOffset(), noiseOffset() );
 
-			static rngi noiseOffset = rngi( 0, 512 );
-			glUniform2i( glGetUniformLocation( shader, "noiseOffset" ), noiseOffset(), noiseOffset() );
+		vec2 values[ 4 ] = {
+			scale * state.stroke.currentQuad.p1,
+			scale * state.stroke.currentQuad.p2,
+			scale * state.stroke.currentQuad.p3,
+			scale * state.stroke.currentQuad.p4
+		};
 
-			const float scale = float( std::min( config.width, config.height ) );
+		glUniform2fv( glGetUniformLocation( shader, "quadPoints" ), 4, ( float* ) &values );
 
-			const bool mouseState = inputHandler.getState( MOUSE_BUTTON_LEFT ) && !ImGui::GetIO().WantCaptureMouse;
-			ivec2 mousePos = inputHandler.getMousePos();
-			vec2 mousePosNorm = vec2( mousePos.x, mousePos.y ) / scale;
-			// glUniform3i( glGetUniformLocation( shader, "mouseState" ), mousePos.x, mousePos.y, mouseState );
+		// glUniform3i( glGetUniformLocation( shader, "mouseState" ), scale * state.stroke.curx, scale * state.stroke.cury, mouseState ? 1 : 0 );
+		glUniform3i( glGetUniformLocation( shader, "mouseState" ), scale * state.stroke.lastx, scale * state.stroke.lasty, mouseState ? 1 : 0 );
 
-			if ( mouseState ) {
-				switch ( inputHandler.getState4( MOUSE_BUTTON_LEFT ) ) {
-					case KEYSTATE_OFF: break;
-					case KEYSTATE_RISING:
-						// set initial filter parameters
-						state.stroke.init( mousePosNorm );
-						break;
-					case KEYSTATE_ON:
-						// update the filter
-						state.stroke.update( mousePosNorm + vec2( 0.01f ) );
-						break;
-					case KEYSTATE_FALLING:
-						// state.stroke.active = false;
-						break;
-				}
-
-				vec2 values[ 4 ] = {
-					scale * state.stroke.currentQuad.p1,
-					scale * state.stroke.currentQuad.p2,
-					scale * state.stroke.currentQuad.p3,
-					scale * state.stroke.currentQuad.p4
-				};
-
-				glUniform2fv( glGetUniformLocation( shader, "quadPoints" ), 4, ( float* ) &values );
-
-				// glUniform3i( glGetUniformLocation( shader, "mouseState" ), scale * state.stroke.curx, scale * state.stroke.cury, mouseState ? 1 : 0 );
-				glUniform3i( glGetUniformLocation( shader, "mouseState" ), scale * state.stroke.lastx, scale * state.stroke.lasty, mouseState ? 1 : 0 );
-
-				glUniform1f( glGetUniformLocation( shader, "brushRadius" ), state.brushRadius * std::min( std::max( ( 1.0f - 29.0f * state.stroke.vel ), 0.1f ), 1.0f ) );
-				// glUniform1f( glGetUniformLocation( shader, "brushRadius" ), state.brushRadius );
-				glUniform1f( glGetUniformLocation( shader, "brushSlope" ), state.brushSlope );
-				glUniform1f( glGetUniformLocation( shader, "brushThreshold" ), state.brushThreshold );
-				glUniform3f( glGetUniformLocation( shader, "brushColor" ), state.brushColor.r, state.brushColor.g, state.brushColor.b );
-
-				glDispatchCompute( ( config.width + 15 ) / 16, ( config.height + 15 ) / 16, 1 );
-				glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
-			}
+		glUniform1f( glGetUniformLocation( shader, "brushRadius" ), paintCanvasCPU::VelocityRadius( state.brushRadius, state.stroke.vel ) );
+		// glUniform1f( glGetUniformLocation( shader, "brushRadius" ), state.brushRadius );
+		glUniform1f( glGetUniformLocation( shader, "brushSlope" ), state.brushSlope );
+		glUniform1f( glGetUniformLocation( shader, "brushThreshold" ), state.brushThreshold );
+		glUniform3f( glGetUniformLocation( shader, "brushColor" ), state.brushColor.r, state.brushColor.g, state.brushColor.b );
+
+		glDispatchCompute( ( config.width + 15 ) / 16, ( config.height + 15 ) / 16, 1 );
+		glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
+	}
+
+	// tiles changed by painting, undo / redo or clear go up as 64x64 subimages
+	void UploadCanvas () {
+		SCOPED_TIMER( "Canvas Upload" );
+		if ( canvas.DirtyTiles().empty() ) return;
+		static const std::vector< vec4 > blank( paintCanvasCPU::tilePixels, vec4( 0.0f ) );
+		const int tileSize = paintCanvasCPU::tileSize;
+		glBindTexture( GL_TEXTURE_2D, textureManager.Get( "Paint Buffer" ) );
+		glPixelStorei( GL_UNPACK_ROW_LENGTH, tileSize );
+		for ( uint32_t index : canvas.DirtyTiles() ) {
+			const int x = int( index % canvas.TilesX() ) * tileSize;
+			const int y = int( index / canvas.TilesX() ) * tileSize;
+			const paintCanvasCPU::tile_t *tile = canvas.GetTile( index );
+			glTexSubImage2D( GL_TEXTURE_2D, 0, x, y, std::min( tileSize, int( canvas.Width() ) - x ), std::min( tileSize, int( canvas.Height() ) - y ), GL_RGBA, GL_FLOAT, tile ? ( void * ) tile->pixels : ( void * ) blank.data() );
 		}
+		glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+		canvas.ClearDirty();
 	}
 
 	void OnRender () {
@@ -321,7 +287,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
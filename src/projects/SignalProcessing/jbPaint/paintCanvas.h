@@ -0,0 +1,682 @@
+#pragma once
+#ifndef PAINT_CANVAS_H
+#define PAINT_CANVAS_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#include "../../../utils/GLM/glm.hpp"
+#include "../../../engine/coreUtils/parallel.h"
+
+// float lerp(f0,f1,p)
+// float f0, f1, p;
+// {
+// 	return ( ( f0 * ( 1.0 - p ) ) + ( f1 * p ) );
+// }
+
+inline float lerp ( float f0, float f1, float p ){
+	return ( ( f0 * ( 1.0 - p ) ) + ( f1 * p ) );
+}
+
+struct quad {
+	glm::vec2 p1, p2, p3, p4;
+};
+
+struct strokeFilter_t {
+	float curx, cury;
+	float velx, vely, vel;
+	float accx, accy, acc;
+	float angx, angy;
+	float mass, drag;
+	float lastx, lasty;
+	bool fixedangle = true;
+
+	// previously global state
+	float currMass = 0.5f, currDrag = 0.15f;
+	float initWidth = 1.5f;
+	float odelX, odelY;
+
+	// reset filter parameterization
+	void init ( glm::vec2 mouse ) {
+		// update positions
+		lastx = curx = mouse.x;
+		lasty = cury = mouse.y;
+		// upate other terms
+		velx = accx = odelX = 0.0f;
+		vely = accy = odelY = 0.0f;
+		active = true;
+	}
+
+	// apply the filter - return false on static conditions
+	void filterApply ( glm::vec2 mouse ) {
+		float mass, drag;
+		float fx, fy;
+
+	/* calculate mass and drag */
+		mass = lerp( 1.0f, 160.0f, currMass );
+		drag = lerp( 0.00f, 0.5f, currDrag * currDrag );
+
+	/* calculate force and acceleration */
+		fx = mouse.x - curx;
+		fy = mouse.y - cury;
+		acc = sqrt( fx * fx + fy * fy );
+		if ( acc < 0.000001f ) {
+			active = false; // computed stroke length goes to zero for low acceleration
+			return;
+		}
+		accx = fx / mass;
+		accy = fy / mass;
+
+	/* calculate new velocity */
+		velx += accx;
+		vely += accy;
+		vel = sqrt( velx * velx + vely * vely );
+		angx = -vely;
+		angy = velx;
+		if ( vel < 0.000001f ) {
+			active = false; // computed stroke length goes to zero for low velocity
+			return;
+		}
+
+	/* calculate angle of drawing tool */
+		angx /= vel;
+		angy /= vel;
+		if ( fixedangle ) {
+			angx = 0.6f;
+			angy = 0.2f;
+		}
+
+	/* apply drag */
+		velx = velx * ( 1.0f - drag );
+		vely = vely * ( 1.0f - drag );
+
+	/* update position */
+		lastx = curx;
+		lasty = cury;
+		curx = curx + velx;
+		cury = cury + vely;
+	}
+
+	quad currentQuad;
+	quad getStrokeQuad () {
+		float delx, dely;
+		float wid;
+		float px, py, nx, ny;
+
+		wid = 0.04f - vel;
+		wid = wid * initWidth;
+		if( wid < 0.00001f ) {
+			wid = 0.00001f;
+		}
+		delx = angx * wid;
+		dely = angy * wid;
+
+		px = lastx;
+		py = lasty;
+		nx = curx;
+		ny = cury;
+
+		// the four points for the quad
+		currentQuad.p1 = glm::vec2( px + odelX, py + odelY );
+		currentQuad.p2 = glm::vec2( px - odelX, py - odelY );
+		currentQuad.p3 = glm::vec2( nx - delx, ny - dely );
+		currentQuad.p4 = glm::vec2( nx + delx, ny + dely );
+
+		// updating deltas
+		odelY = dely;
+		odelX = delx;
+
+		return currentQuad;
+	}
+
+	bool active = false;
+	void update ( glm::vec2 mouse ) {
+
+		if ( active ) {
+			// apply the brush dynamics
+			filterApply( mouse );
+			// this needs to get drawn, eventually
+			getStrokeQuad();
+		}
+	}
+};
+
+// CPU version of update.cs.glsl's QUADLINES mode, on a canvas of 64x64 tiles. Stroke quads are queued as they come
+	// out of the filter, and each Flush bins the whole batch by the tiles their brush footprint touches, then each
+	// touched tile runs its segments in order on one thread - same result as a dispatch per segment, but only the
+	// pixels near the stroke get looked at, and no tile is shared between threads.
+// Tiles are reference counted and copy-on-write. The first time a stroke writes a tile, the old tile goes into
+	// that stroke's undo record, and the canvas gets a copy to draw on - so history costs one tile per tile touched,
+	// and undo / redo swap pointers. Tiles that have never been painted are null, and read as zero.
+class paintCanvasCPU {
+public:
+	static constexpr int tileSize = 64;
+	static constexpr int tilePixels = tileSize * tileSize;
+
+	struct tile_t {
+		glm::vec4 pixels[ tilePixels ];	// row major, same layout as a 64x64 glTexSubImage2D
+	};
+
+	struct brush_t {
+		float radius = 25.0f;
+		float slope = 10.0f;
+		float threshold = 0.4f;
+		glm::vec3 color = glm::vec3( 0.1f );
+	};
+
+	uint32_t numThreads = 0;		// 0 is one per core
+	size_t maxUndoSteps = 128;
+
+	// what jbPaint does to the radius - the brush thins out as it speeds up
+	static float VelocityRadius ( const float radius, const float vel ) {
+		return radius * std::min( std::max( ( 1.0f - 29.0f * vel ), 0.1f ), 1.0f );
+	}
+
+	void Resize ( const uint32_t w, const uint32_t h ) {
+		width = w;
+		height = h;
+		tilesX = ( width + tileSize - 1 ) / tileSize;
+		tilesY = ( height + tileSize - 1 ) / tileSize;
+		tiles.assign( size_t( tilesX ) * tilesY, nullptr );
+		strokeStamps.assign( tiles.size(), 0 );
+		bins.assign( tiles.size(), std::vector< uint32_t >() );
+		dirty.assign( tiles.size(), 0 );
+		dirtyList.clear();
+		pending.clear();
+		undoStack.clear();
+		redoStack.clear();
+		strokeOpen = false;
+		Invalidate();
+	}
+
+	uint32_t Width () const { return width; }
+	uint32_t Height () const { return height; }
+	uint32_t TilesX () const { return tilesX; }
+	uint32_t TilesY () const { return tilesY; }
+
+	// null for a blank tile
+	const tile_t * GetTile ( const uint32_t index ) const { return tiles[ index ].get(); }
+	glm::vec4 GetPixel ( const uint32_t x, const uint32_t y ) const {
+		const tile_t *t = tiles[ ( y / tileSize ) * tilesX + x / tileSize ].get();
+		return t ? t->pixels[ ( y % tileSize ) * tileSize + x % tileSize ] : glm::vec4( 0.0f );
+	}
+
+	// marks every tile for the next upload
+	void Invalidate () {
+		for ( uint32_t i = 0; i < tiles.size(); i++ ) MarkDirty( i );
+	}
+
+	// tiles changed since the last ClearDirty - by paint, undo, redo or clear
+	const std::vector< uint32_t > & DirtyTiles () const { return dirtyList; }
+	void ClearDirty () {
+		for ( uint32_t index : dirtyList ) dirty[ index ] = 0;
+		dirtyList.clear();
+	}
+
+	// strokes group segments into one undo step
+	void BeginStroke () {
+		EndStroke();
+		undoStack.push_back( record_t() );
+		strokeOpen = true;
+		strokeID++;
+	}
+
+	void EndStroke () {
+		if ( !strokeOpen ) return;
+		Flush();
+		strokeOpen = false;
+		if ( undoStack.back().tiles.empty() ) {
+			undoStack.pop_back(); // nothing got painted
+		} else {
+			redoStack.clear();
+			while ( undoStack.size() > maxUndoSteps ) undoStack.pop_front();
+		}
+	}
+
+	// segment in pixels, queued until the next Flush
+	void AddSegment ( const quad &q, const brush_t &brush ) {
+		segment_t s;
+		s.p[ 0 ] = q.p1; s.p[ 1 ] = q.p2; s.p[ 2 ] = q.p3; s.p[ 3 ] = q.p4;
+		s.brush = brush;
+		s.serial = segmentSerial++;
+		pending.push_back( s );
+	}
+
+	// draws everything queued - outside of a stroke, the batch becomes its own undo step
+	void Flush () {
+		if ( pending.empty() ) return;
+		PROFILE_SCOPE( "Paint Canvas Flush" );
+		const bool implicitStroke = !strokeOpen;
+		if ( implicitStroke ) {
+			undoStack.push_back( record_t() );
+			strokeOpen = true;
+			strokeID++;
+		}
+
+		// edges and footprints, and bin them - segments go into each tile's list in the order they were added
+		touched.clear();
+		for ( uint32_t i = 0; i < pending.size(); i++ ) {
+			segment_t &s = pending[ i ];
+			SetupSegment( s );
+			if ( s.x0 > s.x1 || s.y0 > s.y1 ) continue;
+			for ( int ty = s.y0 / tileSize; ty <= s.y1 / tileSize; ty++ ) {
+				for ( int tx = s.x0 / tileSize; tx <= s.x1 / tileSize; tx++ ) {
+					const uint32_t index = ty * tilesX + tx;
+					if ( bins[ index ].empty() ) touched.push_back( index );
+					bins[ index ].push_back( i );
+				}
+			}
+		}
+
+		// copy on write - keep the old tile for undo, and draw on a copy of it
+		for ( uint32_t index : touched ) {
+			MakeWritable( index );
+		}
+
+		parallelForDynamic( touched.size(), [ & ] ( size_t i, uint32_t ) {
+			const uint32_t index = touched[ i ];
+			DrawTile( index );
+			bins[ index ].clear();
+		}, 1, ResolveThreads( touched.size() ) );
+
+		lastFlush.segments = pending.size();
+		lastFlush.tiles = touched.size();
+		pending.clear();
+
+		if ( implicitStroke ) {
+			strokeOpen = false;
+			redoStack.clear();
+			while ( undoStack.size() > maxUndoSteps ) undoStack.pop_front();
+		}
+	}
+
+	// blanks the canvas, as an undo step of its own
+	void Clear () {
+		EndStroke();
+		record_t r;
+		for ( uint32_t i = 0; i < tiles.size(); i++ ) {
+			if ( tiles[ i ] ) {
+				r.tiles.push_back( { i, std::move( tiles[ i ] ) } );
+				tiles[ i ] = nullptr;
+				MarkDirty( i );
+			}
+		}
+		if ( !r.tiles.empty() ) {
+			undoStack.push_back( std::move( r ) );
+			redoStack.clear();
+			while ( undoStack.size() > maxUndoSteps ) undoStack.pop_front();
+		}
+	}
+
+	bool CanUndo () const { return !undoStack.empty() || strokeOpen; }
+	bool CanRedo () const { return !redoStack.empty(); }
+	size_t UndoSteps () const { return undoStack.size(); }
+	size_t RedoSteps () const { return redoStack.size(); }
+
+	// swapping a record's tiles with the canvas's turns it from an undo into a redo, and back
+	bool Undo () {
+		EndStroke();
+		if ( undoStack.empty() ) return false;
+		SwapRecord( undoStack.back() );
+		redoStack.push_back( std::move( undoStack.back() ) );
+		undoStack.pop_back();
+		return true;
+	}
+
+	bool Redo () {
+		EndStroke();
+		if ( redoStack.empty() ) return false;
+		SwapRecord( redoStack.back() );
+		undoStack.push_back( std::move( redoStack.back() ) );
+		redoStack.pop_back();
+		return true;
+	}
+
+	// memory held by painted tiles on the canvas, and by the undo / redo records
+	size_t CanvasBytes () const {
+		size_t count = 0;
+		for ( auto &t : tiles ) count += t ? 1 : 0;
+		return count * sizeof( tile_t );
+	}
+	size_t HistoryBytes () const {
+		size_t count = 0;
+		for ( auto &r : undoStack ) for ( auto &t : r.tiles ) count += t.second ? 1 : 0;
+		for ( auto &r : redoStack ) for ( auto &t : r.tiles ) count += t.second ? 1 : 0;
+		return count * sizeof( tile_t );
+	}
+	size_t FullSnapshotBytes () const { return size_t( width ) * height * sizeof( glm::vec4 ); }
+
+	struct flushStats_t {
+		size_t segments = 0;
+		size_t tiles = 0;
+	} lastFlush;
+
+	// mouse positions, normalized the same way jbPaint does it - one per frame, one path per stroke
+	typedef std::vector< glm::vec2 > inputPath_t;
+
+	// wandering strokes, for when there's nothing recorded yet
+	static std::vector< inputPath_t > GeneratePaths ( const size_t count, const float aspect, const uint32_t seed = 0 ) {
+		std::mt19937 gen( seed );
+		std::uniform_real_distribution< float > uniform( 0.0f, 1.0f );
+		std::vector< inputPath_t > paths( count );
+		for ( auto &path : paths ) {
+			glm::vec2 p = glm::vec2( uniform( gen ) * aspect, uniform( gen ) );
+			float heading = uniform( gen ) * 6.2831853f;
+			const float turn = ( uniform( gen ) - 0.5f ) * 0.2f;
+			const size_t frames = 60 + size_t( uniform( gen ) * 120.0f );
+			for ( size_t f = 0; f < frames; f++ ) {
+				path.push_back( p );
+				heading += turn + ( uniform( gen ) - 0.5f ) * 0.3f;
+				p += 0.008f * glm::vec2( std::cos( heading ), std::sin( heading ) );
+				p = glm::clamp( p, glm::vec2( 0.0f ), glm::vec2( aspect, 1.0f ) );
+			}
+		}
+		return paths;
+	}
+
+	struct benchmarkResult_t {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t numThreads = 0;
+		size_t numPaths = 0;
+		size_t numSegments = 0;
+		size_t numFrames = 0;
+		double segmentsPerSecond = 0.0;		// one Flush per frame, like jbPaint
+		double strokesPerSecond = 0.0;
+		double unbatchedSegmentsPerSecond = 0.0; // one Flush per segment, like the dispatch per segment
+		float tilesPerFrame = 0.0f;
+		size_t historyBytes = 0;			// undo records for every stroke
+		size_t fullSnapshotBytes = 0;		// one whole canvas copy per stroke, for comparison
+		float undoAllMs = 0.0f;
+		float redoAllMs = 0.0f;
+		bool undoMatches = false;			// undo all is blank, and redo all gets back the same pixels
+	};
+
+	// replays the paths through the stroke filter, same as jbPaint's update with stepsPerFrame filter updates per frame
+	static benchmarkResult_t Benchmark ( const std::vector< inputPath_t > &paths, const uint32_t w, const uint32_t h, const strokeFilter_t &filterSettings, const brush_t &brush, const int stepsPerFrame ) {
+		benchmarkResult_t result;
+		result.width = w;
+		result.height = h;
+		result.numThreads = parallelThreadCount();
+		result.numPaths = paths.size();
+
+		paintCanvasCPU canvas;
+		canvas.Resize( w, h );
+		canvas.maxUndoSteps = paths.size() + 1;
+		const float scale = float( std::min( w, h ) );
+
+		// replay helper - flushes once per frame, or once per segment
+		size_t tilesTotal = 0;
+		auto replay = [ & ] ( paintCanvasCPU &c, const bool perSegment ) {
+			size_t segments = 0;
+			for ( auto &path : paths ) {
+				if ( path.empty() ) continue;
+				strokeFilter_t filter = filterSettings;
+				filter.init( path[ 0 ] );
+				c.BeginStroke();
+				for ( size_t f = 1; f < path.size(); f++ ) {
+					for ( int s = 0; s < stepsPerFrame; s++ ) {
+						filter.update( path[ f ] + glm::vec2( 0.01f ) );
+						const quad &q = filter.currentQuad;
+						brush_t b = brush;
+						b.radius = VelocityRadius( brush.radius, filter.vel );
+						c.AddSegment( { scale * q.p1, scale * q.p2, scale * q.p3, scale * q.p4 }, b );
+						segments++;
+						if ( perSegment ) c.Flush();
+					}
+					if ( !perSegment ) {
+						c.Flush();
+						tilesTotal += c.lastFlush.tiles;
+					}
+				}
+				c.EndStroke();
+			}
+			return segments;
+		};
+
+		auto tStart = std::chrono::high_resolution_clock::now();
+		result.numSegments = replay( canvas, false );
+		double seconds = std::chrono::duration< double >( std::chrono::high_resolution_clock::now() - tStart ).count();
+		result.segmentsPerSecond = double( result.numSegments ) / seconds;
+		result.strokesPerSecond = double( paths.size() ) / seconds;
+		for ( auto &path : paths ) result.numFrames += path.empty() ? 0 : path.size() - 1;
+		result.tilesPerFrame = float( tilesTotal ) / float( std::max( size_t( 1 ), result.numFrames ) );
+		result.historyBytes = canvas.HistoryBytes();
+		result.fullSnapshotBytes = canvas.FullSnapshotBytes() * canvas.UndoSteps();
+
+		paintCanvasCPU unbatched;
+		unbatched.Resize( w, h );
+		tStart = std::chrono::high_resolution_clock::now();
+		replay( unbatched, true );
+		seconds = std::chrono::duration< double >( std::chrono::high_resolution_clock::now() - tStart ).count();
+		result.unbatchedSegmentsPerSecond = double( result.numSegments ) / seconds;
+
+		// keep the painted result, undo everything, redo everything
+		std::vector< glm::vec4 > painted( size_t( w ) * h );
+		for ( uint32_t y = 0; y < h; y++ ) for ( uint32_t x = 0; x < w; x++ ) painted[ y * w + x ] = canvas.GetPixel( x, y );
+		tStart = std::chrono::high_resolution_clock::now();
+		while ( canvas.Undo() );
+		result.undoAllMs = float( std::chrono::duration< double, std::milli >( std::chrono::high_resolution_clock::now() - tStart ).count() );
+		result.undoMatches = canvas.CanvasBytes() == 0;
+		tStart = std::chrono::high_resolution_clock::now();
+		while ( canvas.Redo() );
+		result.redoAllMs = float( std::chrono::duration< double, std::milli >( std::chrono::high_resolution_clock::now() - tStart ).count() );
+		for ( uint32_t y = 0; y < h && result.undoMatches; y++ ) {
+			for ( uint32_t x = 0; x < w && result.undoMatches; x++ ) {
+				result.undoMatches = canvas.GetPixel( x, y ) == painted[ y * w + x ] && unbatched.GetPixel( x, y ) == painted[ y * w + x ];
+			}
+		}
+		return result;
+	}
+
+private:
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t tilesX = 0;
+	uint32_t tilesY = 0;
+
+	std::vector< std::shared_ptr< tile_t > > tiles;
+	std::vector< uint32_t > strokeStamps;	// last stroke to save this tile into its undo record
+	uint32_t strokeID = 0;
+	bool strokeOpen = false;
+
+	// the tiles a step replaced - index, and the tile that was there before ( null for blank )
+	struct record_t {
+		std::vector< std::pair< uint32_t, std::shared_ptr< tile_t > > > tiles;
+	};
+	std::deque< record_t > undoStack;
+	std::deque< record_t > redoStack;
+
+	struct segment_t {
+		glm::vec2 p[ 4 ];
+		brush_t brush;
+		uint32_t serial;
+
+		// setup - the four edges update.cs.glsl measures against, and the pixel footprint
+		glm::vec2 a[ 4 ], ba[ 4 ];
+		float invLengthSquared[ 4 ];
+		int x0, y0, x1, y1;
+	};
+	std::vector< segment_t > pending;
+	uint32_t segmentSerial = 0;
+
+	std::vector< std::vector< uint32_t > > bins;	// per tile, indices into pending
+	std::vector< uint32_t > touched;
+	std::vector< uint8_t > dirty;
+	std::vector< uint32_t > dirtyList;
+
+	uint32_t ResolveThreads ( const size_t work ) const {
+		const uint32_t threads = numThreads ? numThreads : parallelThreadCount();
+		return uint32_t( std::max( size_t( 1 ), std::min( size_t( threads ), work ) ) );
+	}
+
+	void MarkDirty ( const uint32_t index ) {
+		if ( !dirty[ index ] ) {
+			dirty[ index ] = 1;
+			dirtyList.push_back( index );
+		}
+	}
+
+	void MakeWritable ( const uint32_t index ) {
+		std::shared_ptr< tile_t > &t = tiles[ index ];
+		if ( strokeStamps[ index ] != strokeID ) {
+			strokeStamps[ index ] = strokeID;
+			undoStack.back().tiles.push_back( { index, t } );
+		}
+		if ( !t ) {
+			t = std::make_shared< tile_t >();
+			memset( t->pixels, 0, sizeof( t->pixels ) );
+		} else if ( t.use_count() > 1 ) {
+			t = std::make_shared< tile_t >( *t );
+		}
+		MarkDirty( index );
+	}
+
+	void SwapRecord ( record_t &r ) {
+		for ( auto &entry : r.tiles ) {
+			std::swap( tiles[ entry.first ], entry.second );
+			MarkDirty( entry.first );
+		}
+	}
+
+	// edges 1-2, 1-3, 2-3 and 3-0 - the set update.cs.glsl takes the min over
+	void SetupSegment ( segment_t &s ) const {
+		static const int edges[ 4 ][ 2 ] = { { 1, 2 }, { 1, 3 }, { 2, 3 }, { 3, 0 } };
+		for ( int e = 0; e < 4; e++ ) {
+			s.a[ e ] = s.p[ edges[ e ][ 0 ] ];
+			s.ba[ e ] = s.p[ edges[ e ][ 1 ] ] - s.a[ e ];
+			const float l2 = glm::dot( s.ba[ e ], s.ba[ e ] );
+			s.invLengthSquared[ e ] = l2 > 0.0f ? 1.0f / l2 : 0.0f; // degenerate edge is the distance to a point
+		}
+		glm::vec2 lo = glm::min( glm::min( s.p[ 0 ], s.p[ 1 ] ), glm::min( s.p[ 2 ], s.p[ 3 ] ) ) - glm::vec2( s.brush.radius );
+		glm::vec2 hi = glm::max( glm::max( s.p[ 0 ], s.p[ 1 ] ), glm::max( s.p[ 2 ], s.p[ 3 ] ) ) + glm::vec2( s.brush.radius );
+		s.x0 = std::max( 0, int( std::ceil( lo.x ) ) );
+		s.y0 = std::max( 0, int( std::ceil( lo.y ) ) );
+		s.x1 = std::min( int( width ) - 1, int( std::floor( hi.x ) ) );
+		s.y1 = std::min( int( height ) - 1, int( std::floor( hi.y ) ) );
+		if ( !( s.brush.radius > 0.0f ) ) {
+			s.x0 = s.y0 = 1;
+			s.x1 = s.y1 = 0;
+		}
+	}
+
+	// stands in for the blue noise texture - a 64x64 tile of hashed values in [ 0.618, 1 ], with each row stored twice
+		// so a row of up to 64 pixels starting anywhere reads it without wrapping. Each segment gets its own offset into
+		// it, the way each dispatch gets a new noiseOffset.
+	static const float * NoiseTable () {
+		static const std::vector< float > table = [] () {
+			std::vector< float > t( tileSize * tileSize * 2 );
+			for ( uint32_t y = 0; y < tileSize; y++ ) {
+				for ( uint32_t x = 0; x < tileSize; x++ ) {
+					uint32_t h = x * 0x8da6b343u ^ y * 0xd8163841u;
+					h ^= h >> 16; h *= 0x7feb352du; h ^= h >> 15; h *= 0x846ca68bu; h ^= h >> 16;
+					t[ y * tileSize * 2 + x ] = t[ y * tileSize * 2 + x + tileSize ] = 0.618f + 0.382f * float( h >> 8 ) * ( 1.0f / 16777216.0f );
+				}
+			}
+			return t;
+		} ();
+		return table.data();
+	}
+
+	void DrawTile ( const uint32_t index ) {
+		tile_t &t = *tiles[ index ];
+		const int tx0 = int( index % tilesX ) * tileSize;
+		const int ty0 = int( index / tilesX ) * tileSize;
+		const float *noiseTable = NoiseTable();
+
+		// per row scratch - the brush weight and hit count, for each pixel
+		alignas( 32 ) float weight[ tileSize ];
+		alignas( 32 ) float hit[ tileSize ];
+
+		for ( uint32_t segmentIndex : bins[ index ] ) {
+			const segment_t &s = pending[ segmentIndex ];
+			const int x0 = std::max( s.x0, tx0 ), x1 = std::min( s.x1, tx0 + tileSize - 1 );
+			const int y0 = std::max( s.y0, ty0 ), y1 = std::min( s.y1, ty0 + tileSize - 1 );
+			const int n = x1 - x0 + 1;
+			const float radius = s.brush.radius;
+			const float radius2 = radius * radius;
+			const float invRadius = 1.0f / radius;
+			const float slope = s.brush.slope, threshold = s.brush.threshold;
+			const uint32_t noiseX = ( s.serial * 0x9e3779b9u ) >> 26, noiseY = ( s.serial * 0x85ebca6bu ) >> 26;
+
+			for ( int y = y0; y <= y1; y++ ) {
+				const float py = float( y );
+				const float *noise = noiseTable + ( ( y + noiseY ) % tileSize ) * tileSize * 2 + ( x0 + noiseX ) % tileSize;
+#ifdef __AVX__
+				// 8 pixels at a time, the last group running past n into scratch that gets ignored
+				const __m256 lane = _mm256_set_ps( 7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f );
+				const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps( 1.0f );
+				for ( int i = 0; i < n; i += 8 ) {
+					const __m256 px = _mm256_add_ps( _mm256_set1_ps( float( x0 + i ) ), lane );
+
+					// lineSegmentSDF, squared, min over the four edges
+					__m256 dist2 = _mm256_set1_ps( radius2 );
+					for ( int e = 0; e < 4; e++ ) {
+						const __m256 bx = _mm256_set1_ps( s.ba[ e ].x ), by = _mm256_set1_ps( s.ba[ e ].y );
+						const __m256 pax = _mm256_sub_ps( px, _mm256_set1_ps( s.a[ e ].x ) );
+						const __m256 pay = _mm256_set1_ps( py - s.a[ e ].y );
+						__m256 h = _mm256_mul_ps( _mm256_add_ps( _mm256_mul_ps( pax, bx ), _mm256_mul_ps( pay, by ) ), _mm256_set1_ps( s.invLengthSquared[ e ] ) );
+						h = _mm256_min_ps( _mm256_max_ps( h, zero ), one );
+						const __m256 vx = _mm256_sub_ps( pax, _mm256_mul_ps( bx, h ) );
+						const __m256 vy = _mm256_sub_ps( pay, _mm256_mul_ps( by, h ) );
+						dist2 = _mm256_min_ps( dist2, _mm256_add_ps( _mm256_mul_ps( vx, vx ), _mm256_mul_ps( vy, vy ) ) );
+					}
+
+					// biasGain, both sides, and pick - then the falloff, times the noise
+					const __m256 inside = _mm256_cmp_ps( dist2, _mm256_set1_ps( radius2 ), _CMP_LT_OQ );
+					const __m256 value = _mm256_mul_ps( _mm256_sqrt_ps( dist2 ), _mm256_set1_ps( invRadius ) );
+					const __m256 thresholdV = _mm256_set1_ps( threshold );
+					const __m256 slopeTerm = _mm256_mul_ps( _mm256_set1_ps( slope ), _mm256_sub_ps( thresholdV, value ) );
+					const __m256 eps = _mm256_set1_ps( 1e-10f );
+					const __m256 below = _mm256_div_ps( _mm256_mul_ps( value, thresholdV ), _mm256_add_ps( _mm256_add_ps( value, slopeTerm ), eps ) );
+					const __m256 above = _mm256_add_ps( one, _mm256_div_ps( _mm256_mul_ps( _mm256_sub_ps( one, thresholdV ), _mm256_sub_ps( value, one ) ), _mm256_add_ps( _mm256_sub_ps( _mm256_sub_ps( one, value ), slopeTerm ), eps ) ) );
+					const __m256 bias = _mm256_blendv_ps( above, below, _mm256_cmp_ps( value, thresholdV, _CMP_LT_OQ ) );
+					const __m256 falloff = _mm256_mul_ps( _mm256_sub_ps( one, bias ), _mm256_loadu_ps( noise + i ) );
+					_mm256_store_ps( weight + i, _mm256_and_ps( falloff, inside ) );
+					_mm256_store_ps( hit + i, _mm256_and_ps( one, inside ) );
+				}
+#else
+				float d2[ tileSize ];
+				for ( int i = 0; i < n; i++ ) {
+					const glm::vec2 p = glm::vec2( float( x0 + i ), py );
+					float dist2 = radius2;
+					for ( int e = 0; e < 4; e++ ) {
+						const glm::vec2 pa = p - s.a[ e ];
+						const float h = glm::clamp( glm::dot( pa, s.ba[ e ] ) * s.invLengthSquared[ e ], 0.0f, 1.0f );
+						const glm::vec2 v = pa - s.ba[ e ] * h;
+						dist2 = std::min( dist2, glm::dot( v, v ) );
+					}
+					d2[ i ] = dist2;
+				}
+				for ( int i = 0; i < n; i++ ) {
+					const bool inside = d2[ i ] < radius2;
+					const float value = std::sqrt( d2[ i ] ) * invRadius;
+					const float bias = ( value < threshold ) ?
+						( value * threshold ) / ( value + slope * ( threshold - value ) + 1e-10f ) :
+						1.0f + ( ( 1.0f - threshold ) * ( value - 1.0f ) ) / ( 1.0f - value - slope * ( threshold - value ) + 1e-10f );
+					weight[ i ] = inside ? ( 1.0f - bias ) * noise[ i ] : 0.0f;
+					hit[ i ] = inside ? 1.0f : 0.0f;
+				}
+#endif
+				// pixels outside the brush get a zero weight, and adding zero changes nothing
+				glm::vec4 *row = t.pixels + ( y - ty0 ) * tileSize + ( x0 - tx0 );
+				for ( int i = 0; i < n; i++ ) {
+					row[ i ] += glm::vec4( weight[ i ] * s.brush.color, hit[ i ] );
+				}
+			}
+		}
+	}
+};
+
+#endif // PAINT_CANVAS_H
@@ -96,12 +96,12 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 		simulationModel.Update(); // update the CPU model
 	}
 
 	void DrawAPIGeometry () {
-		ZoneScoped; scopedTimer Start( "API Geometry" );
+		ZoneScoped; SCOPED_TIMER( "API Geometry" );
 		simulationModel.Display(); // draw the raster geometry
 	}
 
@@ -111,7 +111,7 @@ public:
 		// potentially doing the GPU model update here
 
 		{ // dummy draw - draw something into accumulatorTexture
-			scopedTimer Start( "Draw Background" );
+			SCOPED_TIMER( "Draw Background" );
 			bindSets[ "Drawing" ].apply();
 			glUseProgram( shaders[ "Background" ] );
 			glDispatchCompute( ( config.width + 15 ) / 16, ( config.height + 15 ) / 16, 1 );
@@ -119,7 +119,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -128,14 +128,14 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 		}
 
 		{ // show trident with current orientation
-			scopedTimer Start( "Trident" );
+			SCOPED_TIMER( "Trident" );
 			trident.Update( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 		}
@@ -148,7 +148,7 @@ public:
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		DrawAPIGeometry();			// draw the model
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -159,7 +159,7 @@ public:
 	bool MainLoop () { // this is what's called from the loop in main
 		ZoneScoped;
 
-		{ scopedTimer Start( "Handle Events" );
+		{ SCOPED_TIMER( "Handle Events" );
 			HandleTridentEvents();
 			HandleCustomEvents();
 			HandleQuitEvents();
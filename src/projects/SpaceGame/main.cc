@@ -6,7 +6,8 @@ public:
 	SpaceGame () { Init(); OnInit(); PostInit(); }
 	~SpaceGame () { Quit(); }
 
-	spaceGameData_t spaceGameData;
+	spaceGameSim_t sim;
+	bool simRunning = true;
 
 	void OnInit () {
 		ZoneScoped;
@@ -16,6 +17,22 @@ public:
 			// something to put some basic data in the accumulator texture - specific to the demo project
 			shaders[ "Dummy Draw" ] = computeShader( "./src/projects/SpaceGame/shaders/draw.cs.glsl" ).shaderHandle;
 
+			// headless run of the economy at scale, separate from the one in the window
+			terminal.addCommand( { "spaceGameBenchmark" }, {
+					{ "workers", INT, "Number of workers, in thousands." },
+					{ "ticks", INT, "Number of sim ticks to run." }
+				}, [=] ( args_t args ) {
+					const spaceGameSim_t::benchmarkResult_t result = spaceGameSim_t::Benchmark( uint32_t( std::clamp( int( args[ "workers" ].data.x ), 1, 100000 ) ) * 1000u, uint32_t( std::max( 1, int( args[ "ticks" ].data.x ) ) ) );
+					stringstream ss;
+					ss << std::fixed << std::setprecision( 2 ) << result.gridQueryUs << "us grid vs " << result.linearQueryUs << "us linear scan";
+					terminal.addLineBreak();
+					terminal.addHistoryLine( terminal.csb.append( "SpaceGame Benchmark ", 3 ).append( "[ " + GetWithThousandsSeparator( result.numWorkers ) + " workers, " + to_string( result.numThreads ) + " threads ]", GREY_DD ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  " + to_string( result.ticksPerSecond ) + " ticks/sec, " + GetWithThousandsSeparator( size_t( result.agentsPerSecond ) ) + " agent updates/sec" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  nearest source query: ", GREY_DD ).append( ss.str() + ( result.queryMismatches ? " ( " + to_string( result.queryMismatches ) + " mismatches! )" : "" ) ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  1 thread vs all threads: ", GREY_DD ).append( result.deterministic ? "identical" : "DIVERGED" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  " + GetWithThousandsSeparator( result.stats.sales ) + " sales, " + GetWithThousandsSeparator( result.stats.meals ) + " meals", GREY_DD ).flush() );
+					terminal.addLineBreak();
+				}, "Run the SpaceGame economy headless, and report ticks/sec, spatial query cost, and determinism across thread counts." );
 
 		}
 
@@ -23,7 +40,7 @@ public:
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 
 		// new data into the input handler
 		inputHandler.update();
@@ -36,54 +53,54 @@ public:
 		// =============================================================
 		ImGui::Begin( "Window" );
 		// =============================================================
+		ImGui::Text( "Tick %llu, %u workers, %u sources, %u markets", ( unsigned long long ) sim.tick, sim.config.numWorkers, sim.config.numSources, sim.config.numMarkets );
+		ImGui::Checkbox( "Running", &simRunning );
+		ImGui::SameLine();
+		if ( ImGui::Button( "Step" ) ) sim.Tick();
 		ImGui::Text( "Workers have resources:" );
 		ImGui::Indent();
-		for ( int i = 0; i < NUM_WORKERS; i++ ) {
+		for ( uint32_t i = 0; i < std::min( 16u, sim.config.numWorkers ); i++ ) {
 			std::stringstream ss;
 			if ( i < 10 ) ss << " ";
 			ss << "| ";
 			for ( int j = 0; j < NUM_RESOURCES; j++ ) {
 				// listen, I don't even want to hear about it
-				ss << std::setprecision( 2 ) << std::setw( 8 ) << std::setfill( '.' ) << std::fixed << spaceGameData.workers[ i ].ledger[ j ] << " | ";
+				ss << std::setprecision( 2 ) << std::setw( 8 ) << std::setfill( '.' ) << std::fixed << sim.ledger[ j ][ i ] << " | ";
 			}
-			ImGui::Text( "Worker %d has %s", i, ss.str().c_str() );
+			ImGui::Text( "Worker %d ( state %d, $%.2f ) has %s", i, int( sim.state[ i ] ), sim.money[ i ], ss.str().c_str() );
 		}
 		ImGui::Unindent();
 		// =============================================================
 		ImGui::Text( "Markets have resources:" );
 		ImGui::Indent();
-		for ( int i = 0; i < NUM_MARKETS; i++ ) {
+		for ( uint32_t i = 0; i < std::min( 16u, sim.config.numMarkets ); i++ ) {
 			std::stringstream ss;
 			if ( i < 10 ) ss << " ";
 			ss << "| ";
 			for ( int j = 0; j < NUM_RESOURCES; j++ ) {
-				// listen, I don't even want to hear about it
-				ss << std::setprecision( 2 ) << std::setw( 8 ) << std::setfill( '.' ) << std::fixed << spaceGameData.markets[ i ].ledger[ j ] << " | ";
+				ss << std::setprecision( 2 ) << std::setw( 8 ) << std::setfill( '.' ) << std::fixed << sim.stock[ j ][ i ] << " @ " << sim.prices[ j ][ i ] << " | ";
 			}
-			ImGui::Text( "Market %d has %s", i, ss.str().c_str() );
+			ImGui::Text( "Market %d ( $%.2f ) has %s", i, sim.marketMoney[ i ], ss.str().c_str() );
 		}
 		ImGui::Unindent();
 		// =============================================================
 		ImGui::Text( "Sources have resources:" );
 		ImGui::Indent();
-		for ( int i = 0; i < NUM_SOURCES; i++ ) {
+		for ( uint32_t i = 0; i < std::min( 16u, sim.config.numSources ); i++ ) {
 			std::stringstream ss;
 			if ( i < 10 ) ss << " ";
 			ss << "| ";
 			for ( int j = 0; j < NUM_RESOURCES; j++ ) {
-				// listen, I don't even want to hear about it
-				ss << std::setprecision( 2 ) << std::setw( 8 ) << std::setfill( '.' ) << std::fixed << spaceGameData.sources[ i ].dropAmounts[ j ] << " | ";
+				ss << std::setprecision( 2 ) << std::setw( 8 ) << std::setfill( '.' ) << std::fixed << sim.dropAmounts[ j ][ i ] << " | ";
 			}
-			ImGui::Text( "Source %d (%.2f remaining) gives %s", i, spaceGameData.sources[ i ].amountLeft, ss.str().c_str() );
+			ImGui::Text( "Source %d (%.2f remaining) gives %s", i, sim.amountLeft[ i ], ss.str().c_str() );
 		}
 		ImGui::Unindent();
 		// =============================================================
-		spaceGameData.update();
 
-		// if ( ImGui::Button( "Reset" ) ) {
-			// but also you can call functions etc
-			// spaceGameData
-		// }
+		if ( ImGui::Button( "Reset" ) ) {
+			sim.Reset( sim.config );
+		}
 
 		ImGui::End();
 		// =============================================================
@@ -99,7 +116,7 @@ public:
 	}
 
 	void DrawAPIGeometry () {
-		ZoneScoped; scopedTimer Start( "API Geometry" );
+		ZoneScoped; SCOPED_TIMER( "API Geometry" );
 		// draw some shit - need to add a hello triangle to this, so I have an easier starting point for raster stuff
 	}
 
@@ -107,7 +124,7 @@ public:
 		ZoneScoped;
 
 		{ // dummy draw - draw something into accumulatorTexture
-			scopedTimer Start( "Drawing" );
+			SCOPED_TIMER( "Drawing" );
 			bindSets[ "Drawing" ].apply();
 			glUseProgram( shaders[ "Dummy Draw" ] );
 			glUniform1f( glGetUniformLocation( shaders[ "Dummy Draw" ], "time" ), SDL_GetTicks() / 1600.0f );
@@ -116,7 +133,7 @@ public:
 		}
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			bindSets[ "Postprocessing" ].apply();
 			glUseProgram( shaders[ "Tonemap" ] );
 			SendTonemappingParameters();
@@ -131,22 +148,23 @@ public:
 			// ...
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 		}
 
 		{ // show trident with current orientation
-			// scopedTimer Start( "Trident" );
+			// SCOPED_TIMER( "Trident" );
 			// trident.Update( textureManager.Get( "Display Texture" ) );
 			// glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 		}
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 		// application-specific update code
+		if ( simRunning ) sim.Tick();
 	}
 
 	void OnRender () {
@@ -156,7 +174,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
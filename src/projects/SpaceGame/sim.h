@@ -1,17 +1,34 @@
-#include "../../engine/includes.h"
+#pragma once
+#ifndef SPACEGAME_SIM_H
+#define SPACEGAME_SIM_H
+
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+
+#include "../../utils/GLM/glm.hpp"
+#include "../../engine/coreUtils/parallel.h"
+
+// the SpaceGame economy - workers gather resources at sources, carry them to markets, sell them, and spend the money
+	// on food. State is kept as structure of arrays, one array per field ( and one per resource, for the ledgers ), so
+	// a tick streams through memory. Workers are updated in fixed size chunks, spread over threads:
+	//	- each chunk has its own random number stream, seeded from ( seed, tick, chunk ), so a run is the same on any
+	//		number of threads
+	//	- nothing shared is written during the parallel passes - requests to sources and sales to markets go into
+	//		per-chunk ledgers, which are merged in chunk order afterwards
+	//	- nearest source / market queries go through a uniform grid over the universe
+	// There is no GL in here, so the sim can run headless for larger studies.
 
 // how many types of resources exist in the sim
 #define NUM_RESOURCES	16
-#define NUM_WORKERS		16
-#define NUM_MARKETS		2
-#define NUM_SOURCES		16
-
-// general purpose 0..1 rng
-rng gen = rng( 0.0f, 1.0f );
 
 // a worker is a finite state machine
 // it has a position in space, a target location, a ledger of held resources, and a state
-enum workerState_t {
+enum workerState_t : uint8_t {
 	INITIAL = 0,
 	EATING,
 	WORKING,
@@ -24,155 +41,502 @@ enum workerState_t {
 	// ...
 };
 
-vec3 getRandomPositionInUniverse () {
-	return vec3( 1000.0f * ( gen() - 0.5f ), 1000.0f * ( gen() - 0.5f ), 1000.0f * ( gen() - 0.5f ) );
-}
+struct spaceGameConfig_t {
+	uint32_t numWorkers = 16;
+	uint32_t numSources = 16;
+	uint32_t numMarkets = 2;
+	uint64_t seed = 1;
+	uint32_t numThreads = 0;			// 0 for one per core
 
-struct worker_t {
-	worker_t () {
-		// generate an initial position...
-		position = getRandomPositionInUniverse();
-	}
+	float universeSize = 1000.0f;		// positions in [ -size / 2, size / 2 ] on each axis
+	float workRadius = 5.0f;			// how close counts as arrived
 
-	workerState_t state = INITIAL;
+	// workers
+	float hungerRate = 0.002f;			// per tick
+	float hungerLimit = 1.0f;			// go eat, once past this
+	float mealCost = 5.0f;
+	float cargoCapacity = 20.0f;		// head for a market with this much
 
-	// tbd
-	float hunger = 0.0f;
-	float money = 0.0f;
-	float speed = 1.0f; // how quickly do I move
+	// sources
+	float sourceRegen = 0.5f;			// amount back per tick, up to the starting amount
 
-	vec3 position; // where am I
-	vec3 targetPosition; // where am I going
+	// markets
+	float basePrice = 1.0f;
+	float targetStock = 1000.0f;		// price is basePrice at this stock, higher below it, lower above
+	float consumption = 0.001f;			// fraction of stock used up per tick
+};
 
-	float ledger[ NUM_RESOURCES ] = { 0.0f };
+//===== Spatial Index ==================================================================================================
+// uniform grid of points, built once - nearest neighbor queries search outward a shell of cells at a time, and stop
+	// once the shell is further away than the best hit so far
+class spaceGameGrid_t {
+public:
+	void Build ( const float * x, const float * y, const float * z, const uint32_t count, const float universeSize ) {
+		px = x; py = y; pz = z;
+		numPoints = count;
+		cellsPerAxis = std::clamp( int( std::cbrt( float( count ) / 2.0f ) ), 1, 64 );
+		cellSize = universeSize / cellsPerAxis;
+		origin = -universeSize / 2.0f;
 
-	void getResources ( float ledgerIncrement[ NUM_RESOURCES ], float scalar ) {
-		for ( int i = 0; i < NUM_RESOURCES; i++ ) {
-			ledger[ i ] += ledgerIncrement[ i ] * scalar;
+		// counting sort into cells
+		const size_t numCells = size_t( cellsPerAxis ) * cellsPerAxis * cellsPerAxis;
+		cellStart.assign( numCells + 1, 0 );
+		std::vector< uint32_t > cellOf( count );
+		for ( uint32_t i = 0; i < count; i++ ) {
+			cellOf[ i ] = CellIndex( CellCoord( x[ i ] ), CellCoord( y[ i ] ), CellCoord( z[ i ] ) );
+			cellStart[ cellOf[ i ] + 1 ]++;
 		}
+		for ( size_t c = 0; c < numCells; c++ ) cellStart[ c + 1 ] += cellStart[ c ];
+		entries.resize( count );
+		std::vector< uint32_t > fill( cellStart.begin(), cellStart.end() - 1 );
+		for ( uint32_t i = 0; i < count; i++ ) entries[ fill[ cellOf[ i ] ]++ ] = i;
 	}
 
-	void moveTowardsTargetPosition() {
-		// may need to update state, if position is reached
-		vec3 offset = targetPosition - position;
-		float distance = length( offset );
-		vec3 normalized = normalize( offset );
-
-		float amt = gen();
-		if ( ( speed * amt ) < distance ) {
-			position += speed * amt * normalized;
-		} else {
-			// overshoot, change state
-			position = targetPosition;
-			state = ARRIVED_AT_TARGET;
+	// index of the closest point where accept( index ) is true, or -1 if there are none
+	template < typename accept_t >
+	int32_t Nearest ( const glm::vec3 p, accept_t accept ) const {
+		const int cx = CellCoord( p.x ), cy = CellCoord( p.y ), cz = CellCoord( p.z );
+		int32_t best = -1;
+		float bestDistSq = std::numeric_limits< float >::max();
+		for ( int r = 0; r < cellsPerAxis; r++ ) {
+			// everything in shell r is at least ( r - 1 ) cells away
+			if ( best != -1 ) {
+				const float shellDist = std::max( 0, r - 1 ) * cellSize;
+				if ( shellDist * shellDist > bestDistSq ) break;
+			}
+			for ( int z = cz - r; z <= cz + r; z++ ) {
+				if ( z < 0 || z >= cellsPerAxis ) continue;
+				for ( int y = cy - r; y <= cy + r; y++ ) {
+					if ( y < 0 || y >= cellsPerAxis ) continue;
+					const bool faceYZ = ( std::abs( z - cz ) == r ) || ( std::abs( y - cy ) == r );
+					for ( int x = cx - r; x <= cx + r; x += ( faceYZ ? 1 : std::max( 1, 2 * r ) ) ) {
+						if ( x < 0 || x >= cellsPerAxis ) continue;
+						const uint32_t cell = CellIndex( x, y, z );
+						for ( uint32_t e = cellStart[ cell ]; e < cellStart[ cell + 1 ]; e++ ) {
+							const uint32_t i = entries[ e ];
+							if ( !accept( i ) ) continue;
+							const float dx = px[ i ] - p.x, dy = py[ i ] - p.y, dz = pz[ i ] - p.z;
+							const float d = dx * dx + dy * dy + dz * dz;
+							if ( d < bestDistSq || ( d == bestDistSq && int32_t( i ) < best ) ) {
+								bestDistSq = d;
+								best = int32_t( i );
+							}
+						}
+					}
+				}
+			}
 		}
+		return best;
 	}
-};
 
-// this is a location where resources can be taken from
-struct source_t {
-	source_t () {
-		for ( int i = 0; i < NUM_RESOURCES; i++ ) {
-			dropAmounts[ i ] = gen();
+	// reference version, for checking the grid
+	template < typename accept_t >
+	int32_t NearestLinear ( const glm::vec3 p, accept_t accept ) const {
+		int32_t best = -1;
+		float bestDistSq = std::numeric_limits< float >::max();
+		for ( uint32_t i = 0; i < numPoints; i++ ) {
+			if ( !accept( i ) ) continue;
+			const float dx = px[ i ] - p.x, dy = py[ i ] - p.y, dz = pz[ i ] - p.z;
+			const float d = dx * dx + dy * dy + dz * dz;
+			if ( d < bestDistSq ) { bestDistSq = d; best = int32_t( i ); }
 		}
-		amountLeft = 10000.0f * gen();
-		position = getRandomPositionInUniverse();
+		return best;
 	}
 
-	float gather () {
-		float amount = gen() * gen();
-		if ( amountLeft > 0.0f ) {
-			amountLeft -= amount;
-		} else { // not enough left
-			amount = 0.0f;
-		}
-		return amount;
-	}
+private:
+	const float * px = nullptr;
+	const float * py = nullptr;
+	const float * pz = nullptr;
+	uint32_t numPoints = 0;
+	int cellsPerAxis = 1;
+	float cellSize = 1.0f;
+	float origin = 0.0f;
+	std::vector< uint32_t > cellStart;	// prefix sum of points per cell
+	std::vector< uint32_t > entries;	// point indices, sorted by cell
 
-	vec3 position;
-	// amount of each resource to give
-	float dropAmounts[ NUM_RESOURCES ];
-	// amount of "stuff" left
-	float amountLeft;
+	int CellCoord ( const float v ) const { return std::clamp( int( ( v - origin ) / cellSize ), 0, cellsPerAxis - 1 ); }
+	uint32_t CellIndex ( const int x, const int y, const int z ) const { return uint32_t( ( z * cellsPerAxis + y ) * cellsPerAxis + x ); }
 };
 
-struct market_t {
-	market_t () {
-		// initial location
-		position = getRandomPositionInUniverse();
+//===== Sim ============================================================================================================
+class spaceGameSim_t {
+public:
+	static constexpr uint32_t workersPerChunk = 4096;
+
+	spaceGameConfig_t config;
+	uint64_t tick = 0;
+
+	// workers
+	std::vector< float > workerX, workerY, workerZ;
+	std::vector< float > targetX, targetY, targetZ;
+	std::vector< workerState_t > state;
+	std::vector< int32_t > targetIndex;		// source or market, depending on state
+	std::vector< float > hunger, money, speed, cargo;
+	std::vector< float > request;			// this tick's ask from the source being worked
+	std::vector< float > ledger[ NUM_RESOURCES ];
+
+	// sources - locations where resources can be taken from
+	std::vector< float > sourceX, sourceY, sourceZ;
+	std::vector< float > amountLeft, amountMax;
+	std::vector< float > dropAmounts[ NUM_RESOURCES ];	// amount of each resource given, per unit gathered
+	std::vector< float > grantRatio;		// fraction of this tick's requests that were filled
+	std::vector< uint8_t > sourceAlive;		// had anything left at the start of the tick
+
+	// markets
+	std::vector< float > marketX, marketY, marketZ;
+	std::vector< float > marketMoney;
+	std::vector< float > stock[ NUM_RESOURCES ];
+	std::vector< float > prices[ NUM_RESOURCES ];
 
+	struct stats_t {
+		uint64_t workerUpdates = 0;
+		uint64_t sales = 0;
+		uint64_t meals = 0;
+		double gathered = 0.0;
+	} stats;
+
+	spaceGameSim_t () { Reset( config ); }
+	spaceGameSim_t ( const spaceGameConfig_t &c ) { Reset( c ); }
+
+	void Reset ( const spaceGameConfig_t &c ) {
+		config = c;
+		tick = 0;
+		stats = stats_t();
+		const uint32_t W = config.numWorkers, S = std::max( 1u, config.numSources ), M = std::max( 1u, config.numMarkets );
+		config.numSources = S;
+		config.numMarkets = M;
+
+		for ( auto * v : { &workerX, &workerY, &workerZ, &targetX, &targetY, &targetZ, &hunger, &money, &speed, &cargo, &request } ) v->assign( W, 0.0f );
+		for ( auto& l : ledger ) l.assign( W, 0.0f );
+		state.assign( W, INITIAL );
+		targetIndex.assign( W, -1 );
+
+		// sources and markets come off of a serial stream, workers off of the chunk streams
+		random_t r( config.seed, 0xFFFFFFFFu, 0 );
+		for ( auto * v : { &sourceX, &sourceY, &sourceZ, &amountLeft, &amountMax, &grantRatio } ) v->assign( S, 0.0f );
+		for ( auto& d : dropAmounts ) d.assign( S, 0.0f );
+		sourceAlive.assign( S, 1 );
+		for ( uint32_t s = 0; s < S; s++ ) {
+			sourceX[ s ] = r.Position( config.universeSize ); sourceY[ s ] = r.Position( config.universeSize ); sourceZ[ s ] = r.Position( config.universeSize );
+			for ( int i = 0; i < NUM_RESOURCES; i++ ) dropAmounts[ i ][ s ] = r.Float();
+			amountLeft[ s ] = amountMax[ s ] = 10000.0f * r.Float();
+		}
+		for ( auto * v : { &marketX, &marketY, &marketZ, &marketMoney } ) v->assign( M, 0.0f );
 		for ( int i = 0; i < NUM_RESOURCES; i++ ) {
-			// some amount of initial resources
-			ledger[ i ] = 100.0f * gen();
-			// some initial price for each resource
-			ledger[ i ] = 100.0f * gen();
+			stock[ i ].assign( M, 0.0f );
+			prices[ i ].assign( M, 0.0f );
 		}
+		for ( uint32_t m = 0; m < M; m++ ) {
+			marketX[ m ] = r.Position( config.universeSize ); marketY[ m ] = r.Position( config.universeSize ); marketZ[ m ] = r.Position( config.universeSize );
+			for ( int i = 0; i < NUM_RESOURCES; i++ ) {
+				// some amount of initial resources
+				stock[ i ][ m ] = 100.0f * r.Float();
+			}
+		}
+		UpdatePrices();
+
+		parallelForDynamic( NumChunks(), [ & ] ( const size_t chunk, uint32_t ) {
+			random_t cr( config.seed, 0xFFFFFFFEu, uint32_t( chunk ) );
+			for ( uint32_t i = ChunkBegin( chunk ); i < ChunkEnd( chunk ); i++ ) {
+				workerX[ i ] = cr.Position( config.universeSize );
+				workerY[ i ] = cr.Position( config.universeSize );
+				workerZ[ i ] = cr.Position( config.universeSize );
+				speed[ i ] = 0.5f + cr.Float();
+			}
+		}, 1, config.numThreads );
+
+		sourceGrid.Build( sourceX.data(), sourceY.data(), sourceZ.data(), S, config.universeSize );
+		marketGrid.Build( marketX.data(), marketY.data(), marketZ.data(), M, config.universeSize );
+
+		chunkRequests.assign( size_t( NumChunks() ) * S, 0.0f );
+		chunkSales.assign( size_t( NumChunks() ) * M * NUM_RESOURCES, 0.0f );
+		chunkMarketMoney.assign( size_t( NumChunks() ) * M, 0.0f );
+		chunkStats.assign( NumChunks(), stats_t() );
 	}
-	vec3 position;
-	float ledger[ NUM_RESOURCES ] = { 0.0f };
-	float prices[ NUM_RESOURCES ] = { 0.0f };
 
-	// functions to transact with the market
-		// todo
-};
+	uint32_t NumChunks () const { return ( config.numWorkers + workersPerChunk - 1 ) / workersPerChunk; }
+
+	void Tick () {
+		for ( uint32_t s = 0; s < config.numSources; s++ ) sourceAlive[ s ] = amountLeft[ s ] > 0.0f;
 
-struct spaceGameData_t {
+		// decide, move, gather requests and sell - per chunk, into the chunk's own ledgers
+		parallelForDynamic( NumChunks(), [ & ] ( const size_t chunk, uint32_t ) { UpdateChunk( uint32_t( chunk ) ); }, 1, config.numThreads );
 
-	worker_t workers[ NUM_WORKERS ];
-	market_t markets[ NUM_MARKETS ];
-	source_t sources[ NUM_SOURCES ];
+		// fill what the sources can, proportionally when they can't cover everything
+		MergeRequests();
 
-	spaceGameData_t () {
-		// initialization
-			// place markets
-			// place sources
-			// place workers
+		// hand out what was granted
+		parallelForDynamic( NumChunks(), [ & ] ( const size_t chunk, uint32_t ) { ApplyGrants( uint32_t( chunk ) ); }, 1, config.numThreads );
+
+		MergeSales();
+		UpdatePrices();
+		tick++;
 	}
 
-	void update () {
-		for ( int i = 0; i < NUM_WORKERS; i++ ) {
-			// switch on worker state
-			switch ( workers[ i ].state ) {
-				case INITIAL:
-					// figure out a goal (start here, and return each time a task is completed)
+	// order independent summary of the whole state, for comparing runs
+	uint64_t Checksum () const {
+		uint64_t h = 0xCBF29CE484222325ull;
+		auto mix = [ &h ] ( const void * data, const size_t bytes ) {
+			const uint8_t * p = ( const uint8_t * ) data;
+			for ( size_t i = 0; i < bytes; i++ ) { h ^= p[ i ]; h *= 0x100000001B3ull; }
+		};
+		for ( auto * v : { &workerX, &workerY, &workerZ, &money, &hunger, &cargo } ) mix( v->data(), v->size() * sizeof( float ) );
+		mix( state.data(), state.size() );
+		mix( amountLeft.data(), amountLeft.size() * sizeof( float ) );
+		for ( int i = 0; i < NUM_RESOURCES; i++ ) mix( stock[ i ].data(), stock[ i ].size() * sizeof( float ) );
+		return h;
+	}
+
+	struct benchmarkResult_t {
+		uint32_t numWorkers = 0;
+		uint32_t numThreads = 0;
+		uint32_t ticks = 0;
+		double ticksPerSecond = 0.0;
+		double agentsPerSecond = 0.0;
+		bool deterministic = false;		// one thread and all threads ended up in the same state
+		uint32_t queryMismatches = 0;	// grid vs linear nearest source
+		float gridQueryUs = 0.0f;		// per query
+		float linearQueryUs = 0.0f;
+		stats_t stats;
+	};
+
+	static benchmarkResult_t Benchmark ( const uint32_t numWorkers, const uint32_t ticks, const uint32_t numSources = 4096, const uint32_t numMarkets = 64 ) {
+		benchmarkResult_t result;
+		result.numWorkers = numWorkers;
+		result.ticks = ticks;
+		result.numThreads = parallelThreadCount();
+
+		spaceGameConfig_t c;
+		c.numWorkers = numWorkers;
+		c.numSources = numSources;
+		c.numMarkets = numMarkets;
+		spaceGameSim_t sim( c );
+		const auto t = std::chrono::steady_clock::now();
+		for ( uint32_t i = 0; i < ticks; i++ ) sim.Tick();
+		const double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - t ).count();
+		result.ticksPerSecond = ticks / seconds;
+		result.agentsPerSecond = double( numWorkers ) * ticks / seconds;
+		result.stats = sim.stats;
 
+		// same run, smaller, on one thread vs all of them
+		c.numWorkers = std::min( numWorkers, 50000u );
+		c.numThreads = 1;
+		spaceGameSim_t a( c );
+		c.numThreads = 0;
+		spaceGameSim_t b( c );
+		for ( uint32_t i = 0; i < 50; i++ ) { a.Tick(); b.Tick(); }
+		result.deterministic = a.Checksum() == b.Checksum();
+
+		// nearest live source, grid vs scanning everything
+		const uint32_t numQueries = 20000;
+		random_t r( 7, 7, 7 );
+		std::vector< glm::vec3 > points( numQueries );
+		for ( auto& p : points ) p = glm::vec3( r.Position( c.universeSize ), r.Position( c.universeSize ), r.Position( c.universeSize ) );
+		auto alive = [ &sim ] ( uint32_t s ) { return sim.amountLeft[ s ] > 0.0f; };
+		std::vector< int32_t > gridHits( numQueries ), linearHits( numQueries );
+		auto tq = std::chrono::steady_clock::now();
+		for ( uint32_t q = 0; q < numQueries; q++ ) gridHits[ q ] = sim.sourceGrid.Nearest( points[ q ], alive );
+		result.gridQueryUs = float( std::chrono::duration< double, std::micro >( std::chrono::steady_clock::now() - tq ).count() / numQueries );
+		tq = std::chrono::steady_clock::now();
+		for ( uint32_t q = 0; q < numQueries; q++ ) linearHits[ q ] = sim.sourceGrid.NearestLinear( points[ q ], alive );
+		result.linearQueryUs = float( std::chrono::duration< double, std::micro >( std::chrono::steady_clock::now() - tq ).count() / numQueries );
+		for ( uint32_t q = 0; q < numQueries; q++ ) result.queryMismatches += ( gridHits[ q ] != linearHits[ q ] );
+		return result;
+	}
+
+private:
+	spaceGameGrid_t sourceGrid;
+	spaceGameGrid_t marketGrid;
+
+	// per-chunk ledgers, merged in chunk order after each parallel pass
+	std::vector< float > chunkRequests;		// [ chunk ][ source ]
+	std::vector< float > chunkSales;		// [ chunk ][ market ][ resource ]
+	std::vector< float > chunkMarketMoney;	// [ chunk ][ market ]
+	std::vector< stats_t > chunkStats;
+
+	// splitmix64, one stream per ( seed, tick, chunk )
+	struct random_t {
+		uint64_t state;
+		random_t ( const uint64_t seed, const uint64_t tick, const uint32_t chunk ) {
+			state = seed ^ ( tick * 0xD1B54A32D192ED03ull ) ^ ( uint64_t( chunk ) * 0x8CB92BA72F3D8DD7ull );
+		}
+		uint64_t Next () {
+			uint64_t z = ( state += 0x9E3779B97F4A7C15ull );
+			z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+			z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+			return z ^ ( z >> 31 );
+		}
+		float Float () { return float( Next() >> 40 ) / float( 1ull << 24 ); }
+		float Position ( const float size ) { return size * ( Float() - 0.5f ); }
+	};
+
+	uint32_t ChunkBegin ( const size_t chunk ) const { return uint32_t( chunk ) * workersPerChunk; }
+	uint32_t ChunkEnd ( const size_t chunk ) const { return std::min( config.numWorkers, uint32_t( chunk + 1 ) * workersPerChunk ); }
+
+	void SetTarget ( const uint32_t i, const float x, const float y, const float z, const int32_t index, const workerState_t s ) {
+		targetX[ i ] = x; targetY[ i ] = y; targetZ[ i ] = z;
+		targetIndex[ i ] = index;
+		state[ i ] = s;
+	}
+
+	void UpdateChunk ( const uint32_t chunk ) {
+		const uint32_t S = config.numSources, M = config.numMarkets;
+		float * requests = &chunkRequests[ size_t( chunk ) * S ];
+		float * sales = &chunkSales[ size_t( chunk ) * M * NUM_RESOURCES ];
+		float * marketIncome = &chunkMarketMoney[ size_t( chunk ) * M ];
+		std::fill_n( requests, S, 0.0f );
+		std::fill_n( sales, M * NUM_RESOURCES, 0.0f );
+		std::fill_n( marketIncome, M, 0.0f );
+		stats_t &cs = chunkStats[ chunk ];
+		cs = stats_t();
+
+		random_t r( config.seed, tick, chunk );
+		auto alive = [ this ] ( uint32_t s ) { return sourceAlive[ s ] != 0; };
+		auto anyMarket = [] ( uint32_t ) { return true; };
+
+		for ( uint32_t i = ChunkBegin( chunk ); i < ChunkEnd( chunk ); i++ ) {
+			hunger[ i ] += config.hungerRate;
+			request[ i ] = 0.0f;
+			const glm::vec3 position( workerX[ i ], workerY[ i ], workerZ[ i ] );
+
+			switch ( state[ i ] ) {
+				case INITIAL: {
+					// figure out a goal (start here, and return each time a task is completed)
+					const bool needMarket = cargo[ i ] >= config.cargoCapacity || ( hunger[ i ] > config.hungerLimit && money[ i ] >= config.mealCost );
+					const int32_t source = needMarket ? -1 : sourceGrid.Nearest( position, alive );
+					if ( source != -1 ) {
+						SetTarget( i, sourceX[ source ], sourceY[ source ], sourceZ[ source ], source, MOVING_TOWARDS_WORK );
+					} else if ( needMarket || cargo[ i ] > 0.0f ) {
+						const int32_t market = marketGrid.Nearest( position, anyMarket );
+						SetTarget( i, marketX[ market ], marketY[ market ], marketZ[ market ], market, MOVING_TOWARDS_MARKET );
+					} // else nothing to do but wait for a source to refill
 					break;
+				}
 
 				// this dude is eating
 				case EATING:
-					// todo
+					if ( money[ i ] >= config.mealCost ) {
+						money[ i ] -= config.mealCost;
+						marketIncome[ targetIndex[ i ] ] += config.mealCost;
+						hunger[ i ] = 0.0f;
+						cs.meals++;
+					}
+					state[ i ] = TASK_COMPLETE;
 					break;
 
-				// this dude is at a source, working
+				// this dude is at a source, working - ask for some, find out next pass how much was there
 				case WORKING:
-					// do some work
-					for ( int i = 0; i < NUM_SOURCES; i++ ) {
-						if ( distance( workers[ i ].position, sources[ i ].position ) < 5.0f ) {
-							// don't know what the stop criterion is yet
-							workers[ i ].getResources( sources[ i ].dropAmounts, sources[ i ].gather() );
-						}
+					if ( !sourceAlive[ targetIndex[ i ] ] || cargo[ i ] >= config.cargoCapacity ) {
+						state[ i ] = TASK_COMPLETE;
+					} else {
+						request[ i ] = r.Float() * r.Float();
+						requests[ targetIndex[ i ] ] += request[ i ];
 					}
 					break;
 
-				// this dude is at a market
-				case DOING_BUSINESS:
-					// todo
+				// this dude is at a market, sells everything at this tick's prices
+				case DOING_BUSINESS: {
+					const uint32_t m = uint32_t( targetIndex[ i ] );
+					float proceeds = 0.0f;
+					for ( int k = 0; k < NUM_RESOURCES; k++ ) {
+						const float amount = ledger[ k ][ i ];
+						proceeds += amount * prices[ k ][ m ];
+						sales[ m * NUM_RESOURCES + k ] += amount;
+						ledger[ k ][ i ] = 0.0f;
+					}
+					money[ i ] += proceeds;
+					marketIncome[ m ] -= proceeds;
+					cargo[ i ] = 0.0f;
+					cs.sales++;
+					state[ i ] = ( hunger[ i ] > config.hungerLimit ) ? EATING : TASK_COMPLETE;
 					break;
+				}
 
 				// this dude is on the move
 				case MOVING_TOWARDS_WORK:
-				case MOVING_TOWARDS_MARKET:
-					workers[ i ].moveTowardsTargetPosition();
+				case MOVING_TOWARDS_MARKET: {
+					const glm::vec3 offset = glm::vec3( targetX[ i ], targetY[ i ], targetZ[ i ] ) - position;
+					const float distance = glm::length( offset );
+					const float step = speed[ i ] * r.Float();
+					if ( step < distance - config.workRadius ) {
+						const glm::vec3 p = position + offset * ( step / distance );
+						workerX[ i ] = p.x; workerY[ i ] = p.y; workerZ[ i ] = p.z;
+					} else {
+						// close enough, start on whatever we came here for next tick
+						state[ i ] = ( state[ i ] == MOVING_TOWARDS_WORK ) ? WORKING : DOING_BUSINESS;
+					}
 					break;
+				}
 
 				// woo hoo
 				case TASK_COMPLETE: // get a new goal next update
-					workers[ i ].state = INITIAL;
+					state[ i ] = INITIAL;
 					break;
 
 				default:
 					break;
 			}
 		}
+		cs.workerUpdates = ChunkEnd( chunk ) - ChunkBegin( chunk );
 	}
-};
\ No newline at end of file
+
+	void MergeRequests () {
+		const uint32_t S = config.numSources;
+		std::vector< float > total( S, 0.0f );
+		for ( uint32_t c = 0; c < NumChunks(); c++ ) {
+			const float * requests = &chunkRequests[ size_t( c ) * S ];
+			for ( uint32_t s = 0; s < S; s++ ) total[ s ] += requests[ s ];
+		}
+		for ( uint32_t s = 0; s < S; s++ ) {
+			const float granted = std::min( total[ s ], std::max( 0.0f, amountLeft[ s ] ) );
+			grantRatio[ s ] = ( total[ s ] > 0.0f ) ? granted / total[ s ] : 0.0f;
+			amountLeft[ s ] = std::min( amountMax[ s ], amountLeft[ s ] - granted + config.sourceRegen );
+			stats.gathered += granted;
+		}
+	}
+
+	void ApplyGrants ( const uint32_t chunk ) {
+		for ( uint32_t i = ChunkBegin( chunk ); i < ChunkEnd( chunk ); i++ ) {
+			if ( request[ i ] == 0.0f ) continue;
+			const uint32_t s = uint32_t( targetIndex[ i ] );
+			const float amount = request[ i ] * grantRatio[ s ];
+			float total = 0.0f;
+			for ( int k = 0; k < NUM_RESOURCES; k++ ) {
+				const float got = dropAmounts[ k ][ s ] * amount;
+				ledger[ k ][ i ] += got;
+				total += got;
+			}
+			cargo[ i ] += total;
+		}
+	}
+
+	void MergeSales () {
+		const uint32_t M = config.numMarkets;
+		for ( uint32_t c = 0; c < NumChunks(); c++ ) {
+			const float * sales = &chunkSales[ size_t( c ) * M * NUM_RESOURCES ];
+			const float * income = &chunkMarketMoney[ size_t( c ) * M ];
+			for ( uint32_t m = 0; m < M; m++ ) {
+				for ( int k = 0; k < NUM_RESOURCES; k++ ) stock[ k ][ m ] += sales[ m * NUM_RESOURCES + k ];
+				marketMoney[ m ] += income[ m ];
+			}
+			stats.workerUpdates += chunkStats[ c ].workerUpdates;
+			stats.sales += chunkStats[ c ].sales;
+			stats.meals += chunkStats[ c ].meals;
+		}
+		// the rest of the galaxy uses some up
+		for ( int k = 0; k < NUM_RESOURCES; k++ ) {
+			for ( uint32_t m = 0; m < M; m++ ) stock[ k ][ m ] *= 1.0f - config.consumption;
+		}
+	}
+
+	// scarce goods cost more
+	void UpdatePrices () {
+		for ( int k = 0; k < NUM_RESOURCES; k++ ) {
+			for ( uint32_t m = 0; m < config.numMarkets; m++ ) {
+				prices[ k ][ m ] = config.basePrice * 2.0f * config.targetStock / ( config.targetStock + stock[ k ][ m ] );
+			}
+		}
+	}
+};
+
+#endif // SPACEGAME_SIM_H
@@ -1,4 +1,5 @@
 #include "../../../engine/engine.h"
+#include "mapAtlas.h"
 
 struct VoxelSpaceConfig_t {
 
@@ -22,6 +23,9 @@ struct VoxelSpaceConfig_t {
 	bool adaptiveHeight	= false;
 	ivec2 mapDims		= ivec2( 1024, 1024 );
 
+	// render the main view on the CPU, instead of the compute shader
+	bool CPURender		= false;
+
 };
 
 class VoxelSpace final : public engineBase {
@@ -32,6 +36,9 @@ public:
 	VoxelSpaceConfig_t voxelSpaceConfig;
 	GLuint renderFramebuffer;
 
+	mapAtlas_t mapAtlas;
+	voxelSpaceCPU CPURenderer;
+
 	void OnInit () {
 		ZoneScoped;
 		{
@@ -80,12 +87,13 @@ public:
 			textureManager.Add( "Main Rendered View", opts );		// create the image to draw the regular map into
 			textureManager.Add( "Minimap Rendered View", opts );	// create the image to draw the minimap into
 
-			// load one of the maps, just to get some dimensions
-			Image_4U mapHeight( string( "./src/projects/VoxelSpace/CommancheMaps/data/map" ) + std::to_string( voxelSpaceConfig.mode + 1 ) + string( "Height.png" ) );
+			// start decoding all the maps in the background, the current one first - this one we wait for, for the dimensions
+			mapAtlas.Start( "./src/projects/VoxelSpace/CommancheMaps/data/map", 30, voxelSpaceConfig.mode );
+			const mapAtlas_t::map_t &map = mapAtlas.Get( voxelSpaceConfig.mode );
 
 			// create the texture from the combined image
-			opts.width = mapHeight.Width();
-			opts.height = mapHeight.Height();
+			opts.width = map.width;
+			opts.height = map.height;
 			opts.dataType = GL_RGBA8UI;
 			opts.textureType = GL_TEXTURE_2D;
 			opts.pixelDataType = GL_UNSIGNED_BYTE;
@@ -93,29 +101,45 @@ public:
 			textureManager.Add( "Map", opts );
 			UpdateMap();
 
+			CPURenderer.Resize( config.width, config.height );
+
+			terminal.addCommand( { "cpuRenderBenchmark" }, {
+					{ "frames", INT, "Number of frames to render." }
+				}, [=] ( args_t args ) {
+					const int frames = std::max( 1, int( args[ "frames" ].data.x ) );
+					const voxelSpaceMapView_t view = mapAtlas.Get( voxelSpaceConfig.mode ).View();
+					auto tStart = std::chrono::high_resolution_clock::now();
+					for ( int i = 0; i < frames; i++ ) {
+						CPURenderer.Render( view, GetCPURenderParameters() );
+					}
+					const float ms = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::high_resolution_clock::now() - tStart ).count() / 1000.0f;
+					terminal.addHistoryLine( terminal.csb.append( "Rendered " + to_string( frames ) + " frames at " + to_string( CPURenderer.Width() ) + "x" + to_string( CPURenderer.Height() ) + ", " + to_string( ms / frames ) + "ms per frame" ).flush() );
+					terminal.addHistoryLine( terminal.csb.append( "  " + to_string( mapAtlas.NumReady() ) + " of " + to_string( mapAtlas.Count() ) + " maps in the atlas" ).flush() );
+				}, "Time the CPU VoxelSpace renderer on the current map and view." );
 		}
 	}
 
-	void UpdateMap () {
-		// we want to load one of the basic maps from disk - color in the rgb + height in alpha
-		Image_4U mapHeight( string( "./src/projects/VoxelSpace/CommancheMaps/data/map" ) + std::to_string( voxelSpaceConfig.mode + 1 ) + string( "Height.png" ) );
-		Image_4U mapColor( string( "./src/projects/VoxelSpace/CommancheMaps/data/map" ) + std::to_string( voxelSpaceConfig.mode + 1 ) + string( "Color.png" ) );
-
-		// combining the height and color data into one texture - height in alpha - separate images end up being significantly smaller on disk
-		Image_4U combinedMap( mapColor.Width(), mapColor.Height() );
-		for ( uint32_t y = 0; y < mapColor.Height(); y++ ) {
-			for ( uint32_t x = 0; x < mapColor.Width(); x++ ) {
-				color_4U heightRead = mapHeight.GetAtXY( x, y );
-				color_4U colorRead = mapColor.GetAtXY( x, y );
-				color_4U combined = color_4U( { colorRead[ red ], colorRead[ green ], colorRead[ blue ], heightRead[ red ] } );
-				combinedMap.SetAtXY( x, y, combined );
-			}
-		}
+	voxelSpaceParameters_t GetCPURenderParameters () const {
+		voxelSpaceParameters_t p;
+		p.viewPosition	= voxelSpaceConfig.viewPosition;
+		p.viewerHeight	= float( voxelSpaceConfig.viewerHeight );
+		p.viewAngle		= voxelSpaceConfig.viewAngle;
+		p.maxDistance	= voxelSpaceConfig.maxDistance;
+		p.horizonLine	= float( voxelSpaceConfig.horizonLine );
+		p.heightScalar	= voxelSpaceConfig.heightScalar;
+		p.offsetScalar	= voxelSpaceConfig.offsetScalar;
+		p.fogScalar		= voxelSpaceConfig.fogScalar;
+		p.stepIncrement	= voxelSpaceConfig.stepIncrement;
+		p.FoVScalar		= voxelSpaceConfig.FoVScalar;
+		return p;
+	}
 
+	void UpdateMap () {
+		// decoded and interleaved in the background by the atlas - color in the rgb + height in alpha
+		const mapAtlas_t::map_t &map = mapAtlas.Get( voxelSpaceConfig.mode );
 		GLuint handle = textureManager.Get( "Map" );
 		glBindTexture( GL_TEXTURE_2D, handle );
-		glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, combinedMap.Width(), combinedMap.Height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, ( void * ) combinedMap.GetImageDataBasePtr() );
-
+		glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, map.width, map.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, ( void * ) map.texels.data() );
 	}
 
 	void positionAdjust ( float amt ) {
@@ -137,7 +161,7 @@ public:
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 		const uint8_t * state = SDL_GetKeyboardState( NULL );
 
 		// handle specific keys
@@ -192,6 +216,7 @@ public:
 		ImGui::SliderFloat( "Step Increment", &voxelSpaceConfig.stepIncrement, 0.0f, 0.5f, "%.3f" );
 		ImGui::SliderFloat( "FoV", &voxelSpaceConfig.FoVScalar, 0.001f, 15.0f, "%.3f" );
 		ImGui::Checkbox( "Height follows Player Height", &voxelSpaceConfig.adaptiveHeight );
+		ImGui::Checkbox( "CPU Renderer", &voxelSpaceConfig.CPURender );
 		ImGui::Text( " " );
 		ImGui::SliderFloat( "View Bump", &voxelSpaceConfig.viewBump, 0.0f, 500.0f, "%.3f" );
 		ImGui::SliderFloat( "Minimap Scalar", &voxelSpaceConfig.minimapScalar, 0.1f, 5.0f, "%.3f" );
@@ -220,24 +245,30 @@ public:
 		ZoneScoped;
 
 		{
-			scopedTimer Start( "VoxelSpace Render" );
+			SCOPED_TIMER( "VoxelSpace Render" );
 
 			// update the main rendered view - draw the map
-			glUseProgram( shaders[ "VoxelSpace" ] );
-			glUniform2i( glGetUniformLocation( shaders[ "VoxelSpace" ], "resolution" ), config.width, config.height );
-			glUniform2f( glGetUniformLocation( shaders[ "VoxelSpace" ], "viewPosition" ), voxelSpaceConfig.viewPosition.x, voxelSpaceConfig.viewPosition.y );
-			glUniform1i( glGetUniformLocation( shaders[ "VoxelSpace" ], "viewerHeight" ), voxelSpaceConfig.viewerHeight );
-			glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "viewAngle" ), voxelSpaceConfig.viewAngle );
-			glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "maxDistance" ), voxelSpaceConfig.maxDistance );
-			glUniform1i( glGetUniformLocation( shaders[ "VoxelSpace" ], "horizonLine" ), voxelSpaceConfig.horizonLine );
-			glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "heightScalar" ), voxelSpaceConfig.heightScalar );
-			glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "offsetScalar" ), voxelSpaceConfig.offsetScalar );
-			glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "fogScalar" ), voxelSpaceConfig.fogScalar );
-			glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "stepIncrement" ), voxelSpaceConfig.stepIncrement );
-			glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "FoVScalar" ), voxelSpaceConfig.FoVScalar );
-			textureManager.BindImageForShader( "Map", "map", shaders[ "VoxelSpace" ], 1 );
-			textureManager.BindImageForShader( "Main Rendered View", "target", shaders[ "VoxelSpace" ], 2 );
-			glDispatchCompute( ( config.width + 63 ) / 64, 1, 1 );
+			if ( voxelSpaceConfig.CPURender ) {
+				CPURenderer.Render( mapAtlas.Get( voxelSpaceConfig.mode ).View(), GetCPURenderParameters() );
+				glBindTexture( GL_TEXTURE_2D, textureManager.Get( "Main Rendered View" ) );
+				glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, CPURenderer.Width(), CPURenderer.Height(), GL_RGBA, GL_UNSIGNED_BYTE, ( void * ) CPURenderer.GetOutput() );
+			} else {
+				glUseProgram( shaders[ "VoxelSpace" ] );
+				glUniform2i( glGetUniformLocation( shaders[ "VoxelSpace" ], "resolution" ), config.width, config.height );
+				glUniform2f( glGetUniformLocation( shaders[ "VoxelSpace" ], "viewPosition" ), voxelSpaceConfig.viewPosition.x, voxelSpaceConfig.viewPosition.y );
+				glUniform1i( glGetUniformLocation( shaders[ "VoxelSpace" ], "viewerHeight" ), voxelSpaceConfig.viewerHeight );
+				glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "viewAngle" ), voxelSpaceConfig.viewAngle );
+				glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "maxDistance" ), voxelSpaceConfig.maxDistance );
+				glUniform1i( glGetUniformLocation( shaders[ "VoxelSpace" ], "horizonLine" ), voxelSpaceConfig.horizonLine );
+				glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "heightScalar" ), voxelSpaceConfig.heightScalar );
+				glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "offsetScalar" ), voxelSpaceConfig.offsetScalar );
+				glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "fogScalar" ), voxelSpaceConfig.fogScalar );
+				glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "stepIncrement" ), voxelSpaceConfig.stepIncrement );
+				glUniform1f( glGetUniformLocation( shaders[ "VoxelSpace" ], "FoVScalar" ), voxelSpaceConfig.FoVScalar );
+				textureManager.BindImageForShader( "Map", "map", shaders[ "VoxelSpace" ], 1 );
+				textureManager.BindImageForShader( "Main Rendered View", "target", shaders[ "VoxelSpace" ], 2 );
+				glDispatchCompute( ( config.width + 63 ) / 64, 1, 1 );
+			}
 
 			// update the minimap rendered view - draw the area of the map near the user
 			glUseProgram( shaders[ "MiniMap" ] );
@@ -256,7 +287,7 @@ public:
 		}
 
 		{
-			scopedTimer Start( "Fullscreen Triangle Passes" );
+			SCOPED_TIMER( "Fullscreen Triangle Passes" );
 
 			// bind the framebuffer for drawing the layers
 			glBindFramebuffer( GL_FRAMEBUFFER, renderFramebuffer );
@@ -292,7 +323,7 @@ public:
 		// this framebuffer's color attachment becomes the input for the postprocessing step
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			glUseProgram( shaders[ "Tonemap" ] );
 			glBindImageTexture( 0, textureManager.Get( "Framebuffer Color" ), 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA16F );
 			glBindImageTexture( 1, textureManager.Get( "Display Texture" ), 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA8UI );
@@ -302,7 +333,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -318,7 +349,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
@@ -0,0 +1,138 @@
+#pragma once
+#ifndef MAP_ATLAS_H
+#define MAP_ATLAS_H
+
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+#include "../../../engine/includes.h"
+#include "voxelSpaceCPU.h"
+
+// all the Commanche maps, decoded once and kept in memory as interleaved RGBA8 ( color in rgb, height in
+	// alpha ) - a worker thread fills it in the background, starting from whichever map was asked for first.
+	// Switching maps is then just a texture upload, and the CPU renderer can read the same texels directly.
+
+class mapAtlas_t {
+public:
+	struct map_t {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector< uint32_t > texels;
+
+		voxelSpaceMapView_t View () const {
+			voxelSpaceMapView_t view;
+			view.texels = texels.data();
+			view.width = width;
+			view.height = height;
+			return view;
+		}
+	};
+
+	~mapAtlas_t () { Stop(); }
+
+	// kick off the background load, first map to load is firstIndex
+	void Start ( const string &pathPrefix, const int count, const int firstIndex = 0 ) {
+		Stop();
+		prefix = pathPrefix;
+		maps.clear();
+		maps.resize( count );
+		loaded.assign( count, false );
+		requested = std::clamp( firstIndex, 0, count - 1 );
+		stopRequested = false;
+		worker = std::thread( [ this ] () { WorkerLoop(); } );
+	}
+
+	void Stop () {
+		stopRequested = true;
+		if ( worker.joinable() ) worker.join();
+	}
+
+	int Count () const { return int( maps.size() ); }
+
+	bool Ready ( const int index ) {
+		std::lock_guard< std::mutex > lock( mutex );
+		return loaded[ index ];
+	}
+
+	size_t NumReady () {
+		std::lock_guard< std::mutex > lock( mutex );
+		return size_t( std::count( loaded.begin(), loaded.end(), true ) );
+	}
+
+	// returns immediately if the map is already decoded, otherwise moves it to the front of the queue and waits
+	const map_t &Get ( const int index ) {
+		std::unique_lock< std::mutex > lock( mutex );
+		if ( !loaded[ index ] ) {
+			requested = index;
+			ready.wait( lock, [ & ] () { return bool( loaded[ index ] ); } );
+		}
+		return maps[ index ];
+	}
+
+private:
+	string prefix; // path up to the map number, e.g. "./data/map", + "Color.png" / "Height.png"
+	std::vector< map_t > maps;
+	std::vector< bool > loaded;
+	std::atomic< int > requested { 0 };
+	std::atomic< bool > stopRequested { false };
+	std::mutex mutex;
+	std::condition_variable ready;
+	std::thread worker;
+
+	void WorkerLoop () {
+		while ( !stopRequested ) {
+			// take the requested map if it is still pending, otherwise the next one that is
+			int index = -1;
+			{
+				std::lock_guard< std::mutex > lock( mutex );
+				const int r = requested;
+				if ( !loaded[ r ] ) {
+					index = r;
+				} else {
+					for ( int i = 0; i < int( loaded.size() ); i++ ) {
+						if ( !loaded[ ( r + i ) % loaded.size() ] ) {
+							index = ( r + i ) % int( loaded.size() );
+							break;
+						}
+					}
+				}
+			}
+			if ( index == -1 ) break; // everything is loaded
+
+			map_t map = Decode( index );
+			{
+				std::lock_guard< std::mutex > lock( mutex );
+				maps[ index ] = std::move( map );
+				loaded[ index ] = true;
+			}
+			ready.notify_all();
+		}
+	}
+
+	map_t Decode ( const int index ) const {
+		// separate images end up being significantly smaller on disk, so they're kept that way and merged here
+		Image_4U mapHeight( prefix + std::to_string( index + 1 ) + string( "Height.png" ) );
+		Image_4U mapColor( prefix + std::to_string( index + 1 ) + string( "Color.png" ) );
+
+		map_t map;
+		map.width = mapColor.Width();
+		map.height = mapColor.Height();
+		map.texels.resize( size_t( map.width ) * map.height );
+		if ( mapHeight.Width() != map.width || mapHeight.Height() != map.height ) {
+			cout << "height and color dimensions differ for map " << index + 1 << newline;
+			return map;
+		}
+
+		// straight off the base pointers, instead of per-pixel GetAtXY / SetAtXY
+		const uint8_t * color = mapColor.GetImageDataBasePtr();
+		const uint8_t * height = mapHeight.GetImageDataBasePtr();
+		for ( size_t i = 0; i < map.texels.size(); i++ ) {
+			map.texels[ i ] = uint32_t( color[ 4 * i + 0 ] ) | ( uint32_t( color[ 4 * i + 1 ] ) << 8 ) |
+				( uint32_t( color[ 4 * i + 2 ] ) << 16 ) | ( uint32_t( height[ 4 * i ] ) << 24 );
+		}
+		return map;
+	}
+};
+
+#endif // MAP_ATLAS_H
@@ -0,0 +1,184 @@
+#pragma once
+#ifndef VOXEL_SPACE_CPU_H
+#define VOXEL_SPACE_CPU_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#include "../../../utils/GLM/glm.hpp"
+#include "../../../engine/coreUtils/parallel.h"
+
+// CPU version of VoxelSpace.cs.glsl - same column marching, y-buffer occlusion, fog term, and step growth
+	// ( dz += stepIncrement ), so the output matches what the compute shader writes into "Main Rendered View".
+	// This does not need a GL context, so it also runs headless.
+
+// map texels are packed RGBA8, color in rgb, height in alpha - same layout as the "Map" texture
+struct voxelSpaceMapView_t {
+	const uint32_t * texels = nullptr;
+	uint32_t width = 0;
+	uint32_t height = 0;
+};
+
+struct voxelSpaceParameters_t {
+	glm::vec2 viewPosition	= glm::vec2( 512.0f, 512.0f );
+	float viewerHeight		= 75.0f;
+	float viewAngle			= -0.425f;
+	float maxDistance		= 800.0f;
+	float horizonLine		= 700.0f;
+	float heightScalar		= 1200.0f;
+	float offsetScalar		= 0.0f;
+	float fogScalar			= 0.451f;
+	float stepIncrement		= 0.0f;
+	float FoVScalar			= 0.85f;
+};
+
+class voxelSpaceCPU {
+public:
+	// columns are marched in packets of this many, in lockstep - every column takes the same sequence of
+		// distances, so one packet shares the loop control and the per-step math is done 8-wide
+	static constexpr uint32_t packetWidth = 8;
+
+	uint32_t numThreads = 0; // 0 is one per core
+
+	void Resize ( const uint32_t w, const uint32_t h ) {
+		width = w;
+		height = h;
+		paddedWidth = ( width + packetWidth - 1 ) / packetWidth * packetWidth;
+		columns.assign( size_t( paddedWidth ) * height, 0 );
+		output.assign( size_t( width ) * height, 0 );
+	}
+
+	uint32_t Width () const { return width; }
+	uint32_t Height () const { return height; }
+
+	// row major, RGBA8, alpha is the fog term - ready for glTexSubImage2D into "Main Rendered View"
+	const uint32_t * GetOutput () const { return output.data(); }
+
+	void Render ( const voxelSpaceMapView_t &map, const voxelSpaceParameters_t &p ) {
+		if ( width == 0 || height == 0 ) return;
+		const uint32_t numPackets = paddedWidth / packetWidth;
+
+		// march into a column major buffer, so that the span fills for a column are contiguous
+		parallelForDynamic( numPackets, [ & ] ( size_t packet, uint32_t ) {
+			MarchPacket( map, p, uint32_t( packet ) * packetWidth );
+		}, 4, numThreads );
+
+		// transpose to row major, in tiles to keep both sides in cache
+		constexpr uint32_t tile = 32;
+		const uint32_t tilesX = ( width + tile - 1 ) / tile;
+		const uint32_t tilesY = ( height + tile - 1 ) / tile;
+		parallelForDynamic( size_t( tilesX ) * tilesY, [ & ] ( size_t t, uint32_t ) {
+			const uint32_t x0 = uint32_t( t % tilesX ) * tile;
+			const uint32_t y0 = uint32_t( t / tilesX ) * tile;
+			const uint32_t x1 = std::min( x0 + tile, width );
+			const uint32_t y1 = std::min( y0 + tile, height );
+			for ( uint32_t y = y0; y < y1; y++ ) {
+				for ( uint32_t x = x0; x < x1; x++ ) {
+					output[ size_t( y ) * width + x ] = columns[ size_t( x ) * height + y ];
+				}
+			}
+		}, 4, numThreads );
+	}
+
+private:
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t paddedWidth = 0;
+	std::vector< uint32_t > columns;	// column major, paddedWidth columns of height texels
+	std::vector< uint32_t > output;		// row major, width x height
+
+	// imageLoad() returns zero outside the image, keep that behavior
+	static inline uint32_t MapReference ( const voxelSpaceMapView_t &map, const int x, const int y ) {
+		if ( x < 0 || y < 0 || uint32_t( x ) >= map.width || uint32_t( y ) >= map.height ) return 0u;
+		return map.texels[ size_t( y ) * map.width + x ];
+	}
+
+	void MarchPacket ( const voxelSpaceMapView_t &map, const voxelSpaceParameters_t &p, const uint32_t xBase ) {
+		const float wPixels = float( width );
+		const float hPixels = float( height );
+
+		// per-column setup, same as the top of main() in the shader
+		alignas( 32 ) float originX[ packetWidth ], originY[ packetWidth ];
+		alignas( 32 ) float directionX[ packetWidth ], directionY[ packetWidth ];
+		alignas( 32 ) float yBuffer[ packetWidth ];
+		for ( uint32_t lane = 0; lane < packetWidth; lane++ ) {
+			const float FoVAdjust = -1.0f + float( xBase + lane ) * 2.0f / wPixels;
+			const float angle = p.viewAngle + FoVAdjust * p.FoVScalar;
+			// Rotate2D( r ) * vec2( 1, 0 ) = ( cos r, sin r ); side vector is cross( ( dx, 0, dy ), ( 0, 1, 0 ) ).xz = ( -dy, dx )
+			directionX[ lane ] = std::cos( angle );
+			directionY[ lane ] = std::sin( angle );
+			originX[ lane ] = p.viewPosition.x - directionY[ lane ] * FoVAdjust * p.offsetScalar;
+			originY[ lane ] = p.viewPosition.y + directionX[ lane ] * FoVAdjust * p.offsetScalar;
+			// lanes past the right edge of the screen are parked at the top, so they never draw or hold up the packet
+			yBuffer[ lane ] = ( xBase + lane < width ) ? 0.0f : hPixels;
+		}
+
+		// initial clear
+		for ( uint32_t lane = 0; lane < packetWidth; lane++ ) {
+			std::fill_n( &columns[ size_t( xBase + lane ) * height ], height, 0u );
+		}
+
+		alignas( 32 ) int sampleX[ packetWidth ], sampleY[ packetWidth ];
+		alignas( 32 ) float heightOnScreen[ packetWidth ];
+		uint32_t texels[ packetWidth ];
+
+		for ( float dSample = 1.0f, dz = 0.2f; dSample < p.maxDistance; dSample += dz, dz += p.stepIncrement ) {
+			const float invDistance = 1.0f / dSample;
+			uint32_t drawMask = 0;
+
+		#ifdef __AVX__
+			alignas( 32 ) float sampleHeight[ packetWidth ];
+			const __m256 d = _mm256_set1_ps( dSample );
+			const __m256 yb = _mm256_load_ps( yBuffer );
+			if ( _mm256_movemask_ps( _mm256_cmp_ps( yb, _mm256_set1_ps( hPixels ), _CMP_LT_OQ ) ) == 0 ) break; // every column is filled
+
+			// ivec2( viewPositionLocal + dSample * direction ), truncating like the shader does
+			_mm256_store_si256( ( __m256i * ) sampleX, _mm256_cvttps_epi32( _mm256_add_ps( _mm256_load_ps( originX ), _mm256_mul_ps( d, _mm256_load_ps( directionX ) ) ) ) );
+			_mm256_store_si256( ( __m256i * ) sampleY, _mm256_cvttps_epi32( _mm256_add_ps( _mm256_load_ps( originY ), _mm256_mul_ps( d, _mm256_load_ps( directionY ) ) ) ) );
+			for ( uint32_t lane = 0; lane < packetWidth; lane++ ) {
+				texels[ lane ] = MapReference( map, sampleX[ lane ], sampleY[ lane ] );
+				sampleHeight[ lane ] = float( texels[ lane ] >> 24 );
+			}
+			const __m256 hos = _mm256_add_ps( _mm256_mul_ps( _mm256_mul_ps( _mm256_sub_ps( _mm256_load_ps( sampleHeight ), _mm256_set1_ps( p.viewerHeight ) ),
+				_mm256_set1_ps( invDistance ) ), _mm256_set1_ps( p.heightScalar ) ), _mm256_set1_ps( p.horizonLine ) );
+			_mm256_store_ps( heightOnScreen, hos );
+			drawMask = uint32_t( _mm256_movemask_ps( _mm256_cmp_ps( hos, yb, _CMP_GT_OQ ) ) );
+		#else
+			bool anyOpen = false;
+			for ( uint32_t lane = 0; lane < packetWidth; lane++ ) anyOpen = anyOpen || ( yBuffer[ lane ] < hPixels );
+			if ( !anyOpen ) break;
+			for ( uint32_t lane = 0; lane < packetWidth; lane++ ) {
+				sampleX[ lane ] = int( originX[ lane ] + dSample * directionX[ lane ] );
+				sampleY[ lane ] = int( originY[ lane ] + dSample * directionY[ lane ] );
+				texels[ lane ] = MapReference( map, sampleX[ lane ], sampleY[ lane ] );
+				heightOnScreen[ lane ] = ( float( texels[ lane ] >> 24 ) - p.viewerHeight ) * invDistance * p.heightScalar + p.horizonLine;
+				drawMask |= ( heightOnScreen[ lane ] > yBuffer[ lane ] ) ? ( 1u << lane ) : 0u;
+			}
+		#endif
+
+			if ( drawMask == 0 ) continue;
+			const uint32_t depthTerm = uint32_t( std::max( 0.0f, 255.0f - dSample * p.fogScalar ) );
+			while ( drawMask ) {
+				const uint32_t lane = uint32_t( __builtin_ctz( drawMask ) );
+				drawMask &= drawMask - 1;
+				// DrawVerticalLine( x, int( yBuffer ), int( heightOnScreen ), ... ), clamped to the image
+				const int yMin = std::clamp( int( yBuffer[ lane ] ), 0, int( height ) );
+				const int yMax = std::clamp( int( heightOnScreen[ lane ] ), 0, int( height ) );
+				if ( yMin < yMax ) {
+					std::fill( &columns[ size_t( xBase + lane ) * height + yMin ], &columns[ size_t( xBase + lane ) * height + yMax ],
+						( texels[ lane ] & 0x00FFFFFFu ) | ( std::min( depthTerm, 255u ) << 24 ) );
+				}
+				yBuffer[ lane ] = float( uint32_t( heightOnScreen[ lane ] ) );
+			}
+		}
+	}
+};
+
+#endif // VOXEL_SPACE_CPU_H
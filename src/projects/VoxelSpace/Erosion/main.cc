@@ -139,7 +139,7 @@ public:
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 		const uint8_t * state = SDL_GetKeyboardState( NULL );
 
 		// handle specific keys
@@ -215,7 +215,7 @@ public:
 		ZoneScoped;
 
 		{
-			scopedTimer Start( "VoxelSpace Render" );
+			SCOPED_TIMER( "VoxelSpace Render" );
 
 			// update the main rendered view - draw the map
 			glUseProgram( shaders[ "VoxelSpace" ] );
@@ -253,7 +253,7 @@ public:
 		}
 
 		{
-			scopedTimer Start( "Fullscreen Triangle Passes" );
+			SCOPED_TIMER( "Fullscreen Triangle Passes" );
 
 			// bind the framebuffer for drawing the layers
 			glBindFramebuffer( GL_FRAMEBUFFER, renderFramebuffer );
@@ -291,7 +291,7 @@ public:
 		// this framebuffer's color attachment becomes the input for the postprocessing step
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			glUseProgram( shaders[ "Tonemap" ] );
 			glBindImageTexture( 0, textureManager.Get( "Framebuffer Color" ), 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA16F );
 			glBindImageTexture( 1, textureManager.Get( "Display Texture" ), 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA8UI );
@@ -301,7 +301,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -337,7 +337,7 @@ public:
 	}};
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		const int w = voxelSpaceConfig.p.model.Width();
 		const int h = voxelSpaceConfig.p.model.Height();
@@ -373,7 +373,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
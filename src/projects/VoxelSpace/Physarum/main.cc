@@ -1,4 +1,5 @@
 #include "../../../engine/engine.h"
+#include "../../Physarum/physarumCPU.h"
 
 struct VoxelSpaceConfig_t {
 
@@ -126,13 +127,12 @@ public:
 				vec2 direction;
 			};
 
-			std::vector< agent_t > agentsInitialData;
+			// same distribution as before, filled in parallel by the CPU sim's seeding
+			physarum2D seeding;
+			seeding.Seed( physarumConfig.numAgents, physarumConfig.wangSeed() );
+			std::vector< agent_t > agentsInitialData( physarumConfig.numAgents );
 			size_t bufferSize = 4 * sizeof( GLfloat ) * physarumConfig.numAgents;
-			rng dist( -1.0f, 1.0f );
-
-			for ( uint32_t i = 0; i < physarumConfig.numAgents; i++ ) {
-				agentsInitialData.push_back( { { dist(), dist() }, glm::normalize( vec2( dist(), dist() ) ) } );
-			}
+			seeding.CopyAgents( ( float * ) agentsInitialData.data() );
 
 			glGenBuffers( 1, &agentSSBO );
 			glBindBuffer( GL_SHADER_STORAGE_BUFFER, agentSSBO );
@@ -162,7 +162,7 @@ public:
 
 	void HandleCustomEvents () {
 		// application specific controls
-		ZoneScoped; scopedTimer Start( "HandleCustomEvents" );
+		ZoneScoped; SCOPED_TIMER( "HandleCustomEvents" );
 		const uint8_t * state = SDL_GetKeyboardState( NULL );
 
 		// handle specific keys
@@ -285,7 +285,7 @@ public:
 		ZoneScoped;
 
 		{
-			scopedTimer Start( "VoxelSpace Render" );
+			SCOPED_TIMER( "VoxelSpace Render" );
 
 			// update the main rendered view - draw the map
 			glUseProgram( shaders[ "VoxelSpace" ] );
@@ -323,7 +323,7 @@ public:
 		}
 
 		{
-			scopedTimer Start( "Fullscreen Triangle Passes" );
+			SCOPED_TIMER( "Fullscreen Triangle Passes" );
 
 			// bind the framebuffer for drawing the layers
 			glBindFramebuffer( GL_FRAMEBUFFER, renderFramebuffer );
@@ -361,7 +361,7 @@ public:
 		// this framebuffer's color attachment becomes the input for the postprocessing step
 
 		{ // postprocessing - shader for color grading ( color temp, contrast, gamma ... ) + tonemapping
-			scopedTimer Start( "Postprocess" );
+			SCOPED_TIMER( "Postprocess" );
 			glUseProgram( shaders[ "Tonemap" ] );
 			glBindImageTexture( 0, textureManager.Get( "Framebuffer Color" ), 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA16F );
 			glBindImageTexture( 1, textureManager.Get( "Display Texture" ), 0, GL_TRUE, 0, GL_READ_WRITE, GL_RGBA8UI );
@@ -371,7 +371,7 @@ public:
 		}
 
 		{ // text rendering timestamp - required texture binds are handled internally
-			scopedTimer Start( "Text Rendering" );
+			SCOPED_TIMER( "Text Rendering" );
 			textRenderer.Update( ImGui::GetIO().DeltaTime );
 			textRenderer.Draw( textureManager.Get( "Display Texture" ) );
 			glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
@@ -382,7 +382,7 @@ public:
 	}
 
 	void OnUpdate () {
-		ZoneScoped; scopedTimer Start( "Update" );
+		ZoneScoped; SCOPED_TIMER( "Update" );
 
 		// run the shader to do the gaussian blur
 		glUseProgram( shaders[ "Diffuse and Decay" ] );
@@ -420,7 +420,7 @@ public:
 		ComputePasses();			// multistage update of displayTexture
 		BlitToScreen();				// fullscreen triangle copying to the screen
 		{
-			scopedTimer Start( "ImGUI Pass" );
+			SCOPED_TIMER( "ImGUI Pass" );
 			ImguiFrameStart();		// start the imgui frame
 			ImguiPass();			// do all the gui stuff
 			ImguiFrameEnd();		// finish imgui frame and put it in the framebuffer
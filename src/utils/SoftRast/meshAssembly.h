@@ -0,0 +1,371 @@
+#pragma once
+#ifndef MESH_ASSEMBLY_H
+#define MESH_ASSEMBLY_H
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#include "SoftRast.h"
+#include "../../engine/coreUtils/parallel.h"
+
+// turning SoftRast's triangle soup and texture set into GPU-ready data - everything is sized up front, and filled in
+	// parallel:
+	//	- vertices are written interleaved, one struct per vertex, optionally with the direction vectors quantized
+	//	- identical vertices are merged, and the triangles are put back together with an index buffer
+	//	- texture set images are copied into an array texture layout a whole layer at a time, or left where they are
+	//		for the GL upload to read from in place
+
+namespace meshAssembly {
+
+//===== Vertex Formats ================================================================================================
+// same five attributes as the separate arrays that Sponza used to use, 60 bytes
+struct vertexFull_t {
+	glm::vec3 position;
+	glm::vec3 texCoord;		// xy texcoord, z texture index
+	glm::vec3 normal;
+	glm::vec3 tangent;
+	glm::vec3 bitangent;
+
+	static vertexFull_t FromTriangle ( const triangle &t, const int corner ) {
+		const glm::vec3 p[ 3 ] = { t.p0, t.p1, t.p2 };
+		const glm::vec3 tc[ 3 ] = { t.t0, t.t1, t.t2 };
+		const glm::vec3 n[ 3 ] = { t.n0, t.n1, t.n2 };
+		return { p[ corner ], tc[ corner ], n[ corner ], t.t, t.b };
+	}
+};
+
+// packing a direction into GL_INT_2_10_10_10_REV, normalized - x in the low bits, w left at zero
+inline uint32_t PackSnorm1010102 ( const glm::vec3 v ) {
+	auto component = [] ( const float f ) {
+		const float scaled = std::clamp( f, -1.0f, 1.0f ) * 511.0f;
+		return uint32_t( int32_t( scaled + ( scaled < 0.0f ? -0.5f : 0.5f ) ) ) & 0x3FFu; // round half away from zero
+	};
+	return component( v.x ) | ( component( v.y ) << 10 ) | ( component( v.z ) << 20 );
+}
+
+inline glm::vec3 UnpackSnorm1010102 ( const uint32_t p ) {
+	auto component = [] ( const uint32_t bits ) { // sign extend 10 bits
+		return std::max( -1.0f, float( int32_t( bits << 22 ) >> 22 ) / 511.0f );
+	};
+	return glm::vec3( component( p & 0x3FFu ), component( ( p >> 10 ) & 0x3FFu ), component( ( p >> 20 ) & 0x3FFu ) );
+}
+
+// SoftRast leaves the tangent and bitangent scaled by 1 / det of the UV deltas, so they can have any length - the snorm
+	// clamp would bend long ones and flush short ones to zero, so they get normalized first. Degenerate UVs ( zero,
+	// infinite or NaN length ) fall back to a basis around the normal
+inline bool NormalizeDirection ( glm::vec3 &v ) {
+	const float m = std::max( std::abs( v.x ), std::max( std::abs( v.y ), std::abs( v.z ) ) );
+	if ( !( m > 0.0f ) || !std::isfinite( m ) ) return false; // scaled by the largest component first, so the length can't overflow
+	v = glm::normalize( v / m );
+	return true;
+}
+
+inline void TangentFrame ( glm::vec3 n, glm::vec3 &t, glm::vec3 &b ) {
+	const bool tangentOk = NormalizeDirection( t );
+	const bool bitangentOk = NormalizeDirection( b );
+	if ( tangentOk && bitangentOk ) return;
+	if ( !NormalizeDirection( n ) ) n = glm::vec3( 0.0f, 0.0f, 1.0f );
+	if ( tangentOk ) {
+		b = glm::cross( n, t );
+		if ( NormalizeDirection( b ) ) return;
+	} else if ( bitangentOk ) {
+		t = glm::cross( b, n );
+		if ( NormalizeDirection( t ) ) return;
+	}
+	// Duff et al. 2017, "Building an Orthonormal Basis, Revisited"
+	const float sign = std::copysign( 1.0f, n.z );
+	const float a = -1.0f / ( sign + n.z );
+	const float c = n.x * n.y * a;
+	t = glm::vec3( 1.0f + sign * n.x * n.x * a, sign * c, -sign * n.x );
+	b = glm::vec3( c, sign + n.y * n.y * a, -n.y );
+}
+
+// 36 bytes - position and texcoord stay full precision ( texcoords repeat, and have to address 2k textures ), the
+	// three directions go to 10:10:10:2, which is plenty since the shader renormalizes them anyway
+struct vertexQuantized_t {
+	glm::vec3 position;
+	glm::vec3 texCoord;
+	uint32_t normal;
+	uint32_t tangent;
+	uint32_t bitangent;
+
+	static vertexQuantized_t FromTriangle ( const triangle &t, const int corner ) {
+		vertexFull_t v = vertexFull_t::FromTriangle( t, corner );
+		TangentFrame( v.normal, v.tangent, v.bitangent );
+		return { v.position, v.texCoord, PackSnorm1010102( v.normal ), PackSnorm1010102( v.tangent ), PackSnorm1010102( v.bitangent ) };
+	}
+};
+
+template < typename vertex_t >
+struct mesh_t {
+	std::vector< vertex_t > vertices;
+	std::vector< uint32_t > indices;	// three per triangle
+
+	size_t VertexBytes () const { return vertices.size() * sizeof( vertex_t ); }
+	size_t IndexBytes () const { return indices.size() * sizeof( uint32_t ); }
+};
+
+// 64-bit hash of the raw bytes, a word at a time - vertex formats are all 4 byte fields, so there's no padding
+template < typename vertex_t >
+inline uint64_t HashVertex ( const vertex_t &v ) {
+	static_assert( sizeof( vertex_t ) % sizeof( uint32_t ) == 0, "vertex formats are made of 4 byte fields" );
+	uint32_t words[ sizeof( vertex_t ) / sizeof( uint32_t ) ];
+	memcpy( words, &v, sizeof( vertex_t ) );
+	uint64_t h = 0x9E3779B97F4A7C15ull;
+	for ( const uint32_t w : words ) {
+		h ^= w;
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 32;
+	}
+	return h;
+}
+
+//===== Mesh Assembly =================================================================================================
+// interleaved, indexed vertex stream for the triangle list - merged vertices keep the order of their first use,
+	// so the result is the same for any number of threads
+template < typename vertex_t >
+mesh_t< vertex_t > Assemble ( const std::vector< triangle > &triangles, uint32_t numThreads = 0 ) {
+	if ( numThreads == 0 ) numThreads = parallelThreadCount();
+	const size_t numCorners = triangles.size() * 3;
+	mesh_t< vertex_t > mesh;
+	if ( numCorners == 0 ) return mesh;
+
+	// vertices are cheap to rebuild from the triangles, so only the hash of each corner's vertex is kept around
+	auto cornerVertex = [ &triangles ] ( const size_t c ) { return vertex_t::FromTriangle( triangles[ c / 3 ], int( c % 3 ) ); };
+	std::vector< uint64_t > hashes( numCorners );
+	parallelForRanges( numCorners, [ & ] ( size_t begin, size_t end, uint32_t ) {
+		for ( size_t c = begin; c < end; c++ ) {
+			hashes[ c ] = HashVertex( cornerVertex( c ) );
+		}
+	}, numThreads );
+
+	// each partition of the hash space finds the first corner with each distinct vertex, with its own open addressed
+		// table - every thread reads all the hashes, but only probes for its own share
+	const uint32_t partitions = uint32_t( std::min( size_t( numThreads ), numCorners ) );
+	std::vector< uint32_t > first( numCorners );
+	parallelForRanges( partitions, [ & ] ( size_t begin, size_t end, uint32_t ) {
+		for ( size_t p = begin; p < end; p++ ) {
+			size_t members = 0;
+			for ( size_t c = 0; c < numCorners; c++ ) members += ( ( hashes[ c ] >> 40 ) % partitions == p );
+			size_t tableSize = 16;
+			while ( tableSize < members * 2 ) tableSize <<= 1;
+			// entries are the high half of the hash and corner + 1, so most mismatches don't have to go look at the vertex
+			std::vector< uint64_t > table( tableSize, 0 ); // zero is empty
+			for ( size_t c = 0; c < numCorners; c++ ) {
+				if ( ( hashes[ c ] >> 40 ) % partitions != p ) continue;
+				const uint64_t tag = hashes[ c ] & 0xFFFFFFFF00000000ull;
+				size_t slot = hashes[ c ] & ( tableSize - 1 );
+				while ( true ) {
+					const uint64_t entry = table[ slot ];
+					if ( entry == 0 ) {
+						table[ slot ] = tag | uint64_t( c + 1 );
+						first[ c ] = uint32_t( c );
+						break;
+					}
+					const uint32_t corner = uint32_t( entry ) - 1;
+					if ( ( entry & 0xFFFFFFFF00000000ull ) == tag ) {
+						const vertex_t a = cornerVertex( corner ), b = cornerVertex( c );
+						if ( memcmp( &a, &b, sizeof( vertex_t ) ) == 0 ) {
+							first[ c ] = corner;
+							break;
+						}
+					}
+					slot = ( slot + 1 ) & ( tableSize - 1 );
+				}
+			}
+		}
+	}, partitions );
+
+	// compact the distinct vertices, in order of first use
+	std::vector< uint32_t > remap( numCorners );
+	uint32_t numVertices = 0;
+	for ( size_t c = 0; c < numCorners; c++ ) {
+		if ( first[ c ] == c ) remap[ c ] = numVertices++;
+	}
+	mesh.vertices.resize( numVertices );
+	mesh.indices.resize( numCorners );
+	parallelForRanges( numCorners, [ & ] ( size_t begin, size_t end, uint32_t ) {
+		for ( size_t c = begin; c < end; c++ ) {
+			if ( first[ c ] == c ) mesh.vertices[ remap[ c ] ] = cornerVertex( c );
+			mesh.indices[ c ] = remap[ first[ c ] ];
+		}
+	}, numThreads );
+
+	return mesh;
+}
+
+//===== Array Texture Assembly ========================================================================================
+struct arrayTextureLayout_t {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t layers = 0;
+	size_t layerBytes = 0;
+	bool uniform = true;	// all layers are the same size, which the array texture needs
+};
+
+template < typename image_t >
+arrayTextureLayout_t ArrayLayout ( const std::vector< image_t > &images ) {
+	arrayTextureLayout_t layout;
+	layout.layers = uint32_t( images.size() );
+	if ( images.empty() ) return layout;
+	layout.width = images[ 0 ].Width();
+	layout.height = images[ 0 ].Height();
+	layout.layerBytes = size_t( layout.width ) * layout.height * 4;
+	for ( auto& image : images ) {
+		layout.uniform = layout.uniform && image.Width() == layout.width && image.Height() == layout.height;
+	}
+	return layout;
+}
+
+// one memcpy per layer, layers spread over threads - destination holds layout.layers * layout.layerBytes
+template < typename image_t >
+void PackArrayTexture ( const std::vector< image_t > &images, const arrayTextureLayout_t &layout, uint8_t * destination, uint32_t numThreads = 0 ) {
+	parallelForDynamic( images.size(), [ & ] ( const size_t i, uint32_t ) {
+		memcpy( destination + i * layout.layerBytes, images[ i ].GetImageDataBasePtr(), layout.layerBytes );
+	}, 1, numThreads );
+}
+
+//===== Benchmark =====================================================================================================
+// tangent and bitangent from the UV deltas, the same way SoftRast computes them for a loaded model - not normalized
+inline void UVTangents ( triangle &t ) {
+	const glm::vec3 edge1 = t.p1 - t.p0;
+	const glm::vec3 edge2 = t.p2 - t.p0;
+	const glm::vec2 deltaUV1 = glm::vec2( t.t1 - t.t0 );
+	const glm::vec2 deltaUV2 = glm::vec2( t.t2 - t.t0 );
+	const float f = 1.0f / ( deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y );
+	t.t = f * ( deltaUV2.y * edge1 - deltaUV1.y * edge2 );
+	t.b = f * ( -deltaUV2.x * edge1 + deltaUV1.x * edge2 );
+}
+
+// a grid of quads, with shared corners - stands in for a loaded model, when one isn't around. Tangents come from the
+	// UVs, so they're well short of unit length on the flats and longer on the slopes, and every 61st quad has collapsed
+	// UVs to hit the fallback
+inline std::vector< triangle > GridTriangles ( const uint32_t numTriangles ) {
+	const uint32_t side = std::max( 1u, uint32_t( std::sqrt( numTriangles / 2.0f ) ) );
+	std::vector< triangle > triangles;
+	triangles.reserve( size_t( side ) * side * 2 );
+	auto corner = [ side ] ( uint32_t x, uint32_t y ) { return glm::vec3( float( x ) / side, std::sin( x * 0.1f ) * std::cos( y * 0.1f ), float( y ) / side ); };
+	for ( uint32_t y = 0; y < side; y++ ) {
+		for ( uint32_t x = 0; x < side; x++ ) {
+			const float layer = float( ( x / 16 + y / 16 ) % 8 );
+			triangle t0, t1;
+			t0.p0 = corner( x, y );		t0.p1 = corner( x + 1, y );		t0.p2 = corner( x + 1, y + 1 );
+			t1.p0 = corner( x, y );		t1.p1 = corner( x + 1, y + 1 );	t1.p2 = corner( x, y + 1 );
+			// one texture repeat per quad
+			t0.t0 = t1.t0 = glm::vec3( float( x ), float( y ), layer );
+			t0.t1 = glm::vec3( float( x + 1 ), float( y ), layer );
+			t0.t2 = t1.t1 = glm::vec3( float( x + 1 ), float( y + 1 ), layer );
+			t1.t2 = glm::vec3( float( x ), float( y + 1 ), layer );
+			t0.n0 = t0.n1 = t0.n2 = t1.n0 = t1.n1 = t1.n2 = glm::vec3( 0.0f, 1.0f, 0.0f );
+			t0.c0 = t0.c1 = t0.c2 = t1.c0 = t1.c1 = t1.c2 = glm::vec3( 1.0f );
+			if ( ( y * side + x ) % 61 == 0 ) {
+				t0.t1 = t0.t2 = t1.t1 = t1.t2 = t0.t0;
+			}
+			UVTangents( t0 );
+			UVTangents( t1 );
+			triangles.push_back( t0 );
+			triangles.push_back( t1 );
+		}
+	}
+	return triangles;
+}
+
+struct benchmarkResult_t {
+	size_t numTriangles = 0;
+	uint32_t numLayers = 0;
+	uint32_t numThreads = 0;
+
+	// push_back into five attribute arrays, and a byte at a time into the array texture data
+	float legacyVertexMs = 0.0f;
+	float legacyTextureMs = 0.0f;
+	size_t legacyVertexBytes = 0;
+
+	float fullMs = 0.0f;
+	float quantizedMs = 0.0f;
+	float packMs = 0.0f;
+	size_t uniqueVertices = 0;
+	size_t fullBytes = 0;		// vertices + indices
+	size_t quantizedBytes = 0;
+	float maxDirectionError = 0.0f; // quantized vs full, per component, after normalizing the tangent frame
+	size_t zeroDirections = 0;		// quantized directions that came out shorter than half length, should be none
+};
+
+template < typename image_t >
+benchmarkResult_t Benchmark ( const std::vector< triangle > &triangles, const std::vector< image_t > &images ) {
+	benchmarkResult_t result;
+	result.numTriangles = triangles.size();
+	result.numLayers = uint32_t( images.size() );
+	result.numThreads = parallelThreadCount();
+	auto msSince = [] ( const std::chrono::high_resolution_clock::time_point t ) {
+		return std::chrono::duration< float, std::milli >( std::chrono::high_resolution_clock::now() - t ).count();
+	};
+
+	// what ProjectedFramebuffers used to do
+	auto t = std::chrono::high_resolution_clock::now();
+	{
+		std::vector< glm::vec3 > positions, texCoords, normals, tangents, bitangents;
+		for ( auto& triangle : triangles ) {
+			positions.push_back( triangle.p0 ); positions.push_back( triangle.p1 ); positions.push_back( triangle.p2 );
+			texCoords.push_back( triangle.t0 ); texCoords.push_back( triangle.t1 ); texCoords.push_back( triangle.t2 );
+			normals.push_back( triangle.n0 ); normals.push_back( triangle.n1 ); normals.push_back( triangle.n2 );
+			tangents.push_back( triangle.t ); tangents.push_back( triangle.t ); tangents.push_back( triangle.t );
+			bitangents.push_back( triangle.b ); bitangents.push_back( triangle.b ); bitangents.push_back( triangle.b );
+		}
+		result.legacyVertexBytes = 5 * positions.size() * sizeof( glm::vec3 );
+	}
+	result.legacyVertexMs = msSince( t );
+
+	t = std::chrono::high_resolution_clock::now();
+	{
+		std::vector< uint8_t > arrayTextureData;
+		for ( uint32_t i = 0; i < images.size(); i++ ) {
+			for ( uint32_t o = 0; o < images[ i ].Height() * images[ i ].Width() * 4; o++ ) {
+				arrayTextureData.push_back( images[ i ].GetImageDataBasePtr()[ o ] );
+			}
+		}
+	}
+	result.legacyTextureMs = msSince( t );
+
+	// new path
+	t = std::chrono::high_resolution_clock::now();
+	const mesh_t< vertexFull_t > full = Assemble< vertexFull_t >( triangles );
+	result.fullMs = msSince( t );
+	result.uniqueVertices = full.vertices.size();
+	result.fullBytes = full.VertexBytes() + full.IndexBytes();
+
+	t = std::chrono::high_resolution_clock::now();
+	const mesh_t< vertexQuantized_t > quantized = Assemble< vertexQuantized_t >( triangles );
+	result.quantizedMs = msSince( t );
+	result.quantizedBytes = quantized.VertexBytes() + quantized.IndexBytes();
+
+	// quantization error, on a golden ratio spread of the corners - a fixed stride can alias with the grid pattern
+	for ( uint32_t i = 0; i < std::min( size_t( 4096 ), full.indices.size() ); i++ ) {
+		const size_t c = size_t( std::fmod( i * 0.6180339887498949, 1.0 ) * full.indices.size() );
+		vertexFull_t a = full.vertices[ full.indices[ c ] ];
+		TangentFrame( a.normal, a.tangent, a.bitangent );
+		const vertexQuantized_t &b = quantized.vertices[ quantized.indices[ c ] ];
+		const glm::vec3 tangent = UnpackSnorm1010102( b.tangent );
+		const glm::vec3 bitangent = UnpackSnorm1010102( b.bitangent );
+		const glm::vec3 e = glm::max( glm::abs( a.normal - UnpackSnorm1010102( b.normal ) ), glm::max( glm::abs( a.tangent - tangent ), glm::abs( a.bitangent - bitangent ) ) );
+		result.maxDirectionError = std::max( result.maxDirectionError, std::max( e.x, std::max( e.y, e.z ) ) );
+		result.zeroDirections += ( glm::dot( tangent, tangent ) < 0.25f ) + ( glm::dot( bitangent, bitangent ) < 0.25f );
+	}
+
+	t = std::chrono::high_resolution_clock::now();
+	const arrayTextureLayout_t layout = ArrayLayout( images );
+	std::unique_ptr< uint8_t[] > packed( new uint8_t[ layout.layers * layout.layerBytes ] );
+	PackArrayTexture( images, layout, packed.get() );
+	result.packMs = msSince( t );
+
+	return result;
+}
+
+}
+
+#endif // MESH_ASSEMBLY_H
@@ -10,66 +10,16 @@ public:
 
 	// functions
 	void InitWithDiamondSquare () {
-		long unsigned int seed = std::chrono::system_clock::now().time_since_epoch().count();
+		const uint32_t seed = uint32_t( std::chrono::system_clock::now().time_since_epoch().count() );
 
-		std::default_random_engine engine{ seed };
-		std::uniform_real_distribution< float > distribution{ 0.0f, 1.0f };
-
-		// todo: make this variable ( data array cannot be variable size in c++ )
+		// todo: make this variable
 		const uint32_t dim = 1024;
 		// const uint32_t dim = 4096;
 
-	// #define TILE
-	#ifdef TILE
-		const auto size = dim;
-	#else
-		const auto size = dim + 1; // for no_wrap
-	#endif
-
-		const auto edge = size - 1;
-		// float data[ size ][ size ] = { { 0.0f } };
-		std::vector< std::vector< float > > data;
-		data.resize( size );
-		for ( uint i = 0; i < size; i++ ) {
-			data[ i ].resize( size );
-		}
-
-		// data[ 0 ][ 0 ] = data[ edge ][ 0 ] = data[ 0 ][ edge ] = data[ edge ][ edge ] = 0.25f;
-
+		// flat array, written in place, passes split across threads - variance halves each level, like before
 		rng pos = rng( 0.0f, 1.5f );
-		data[ 0 ][ 0 ] = pos();
-		data[ edge ][ 0 ] = pos();
-		data[ 0 ][ edge ] = pos();
-		data[ edge ][ edge ] = pos();
-
-	#ifdef TILE
-		heightfield::diamond_square_wrap
-	#else
-		heightfield::diamond_square_no_wrap
-	#endif
-		(size,
-			// random
-			[ &engine, &distribution ]( float range ) {
-				return distribution( engine ) * range;
-			},
-			// variance
-			[]( int level ) -> float {
-				return std::pow( 0.5f, level );
-				// return static_cast<float>( std::numeric_limits<float>::max() / 2 ) * std::pow(0.5f, level);
-				// return static_cast<float>(std::numeric_limits<float>::max()/1.6) * std::pow(0.5f, level);
-			},
-			// at
-			[ &data ]( int x, int y ) -> float& {
-				return data[ x ][ y ];
-			}
-		);
-
-		model = Image_1F( size, size );
-		for ( uint y = 0; y < size; y++ ) {
-			for ( uint x = 0; x < size; x++ ) {
-				model.SetAtXY( x, y, color_1F( { data[ x ][ y ] } ) );
-			}
-		}
+		const vec4 corners = vec4( pos(), pos(), pos(), pos() );
+		model = batchNoise::DiamondSquare( dim + 1, seed, corners, 0.5f, 1.0f );
 
 		// model.Save( "test.exr", Image_1F::backend::TINYEXR );
 	}
@@ -4,6 +4,9 @@ layout( binding = 0, rgba8ui ) uniform uimage2D fontAtlas;
 layout( binding = 1, rgba8ui ) uniform uimage2D dataTexture;
 layout( binding = 2, rgba8ui ) uniform uimage2D writeTarget;
 
+// dispatches cover bands of cells, this is the first cell of the band
+uniform ivec2 binOffset;
+
 ivec2 getCurrentGlyphBase( int index ) {
 	// 16x16 array of glyphs, each of which is 8x16 pixels
 	ivec2 location;
@@ -14,7 +17,7 @@ ivec2 getCurrentGlyphBase( int index ) {
 
 void main () {
 	// location within the compute dispatch
-	ivec2 invokeLoc = ivec2( gl_GlobalInvocationID.xy );
+	ivec2 invokeLoc = ivec2( gl_GlobalInvocationID.xy ) + binOffset * ivec2( 8, 16 );
 
 	// which glyph ID/character color to pull dataTexture
 	ivec2 bin = ivec2( invokeLoc.x / 8, invokeLoc.y / 16 );
@@ -1,5 +1,6 @@
 #include "../../../engine/includes.h"
 #include "../../../data/colors.h"
+#include "textCompositor.h"
 
 #ifndef FONTRENDERER_H
 #define FONTRENDERER_H
@@ -69,51 +70,65 @@ public:
 	void Resize ( int w, int h ) {
 		if ( bufferBase != nullptr ) { free( bufferBase ); }
 		bufferBase = ( cChar * ) malloc( sizeof( cChar ) * w * h );
+		uploadState.Resize( w, h );
 		ClearBuffer();
 	}
 
-	void Resend () {
-		// this will also need some massaging, with the new texture manager 
-		glActiveTexture( GL_TEXTURE2 );
-		glBindTexture( GL_TEXTURE_2D, textureManager_local->Get( layerLabel ) );
-		if ( bufferDirty ) {
-			glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8UI, width, height, 0, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, bufferBase );
-			bufferDirty = false;
+	void Resend ( const textGlyphAtlas_t &atlas ) {
+		// bufferDirty only says something was written - what actually goes up is what differs from the last upload
+		if ( !bufferDirty ) return;
+		bufferDirty = false;
+		if ( uploadState.Update( ( const uint8_t * ) bufferBase, atlas, uploadRects ) ) {
+			// this will also need some massaging, with the new texture manager
+			glActiveTexture( GL_TEXTURE2 );
+			glBindTexture( GL_TEXTURE_2D, textureManager_local->Get( layerLabel ) );
+			glPixelStorei( GL_UNPACK_ROW_LENGTH, width );
+			for ( auto &r : uploadRects ) {
+				glTexSubImage2D( GL_TEXTURE_2D, 0, r.x, r.y, r.w, r.h, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, bufferBase + r.x + r.y * width );
+			}
+			glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
 		}
 	}
 
-	void Draw () { // bind the data texture and dispatch
-		if ( bufferDirty ) {
-			Resend();
-		}
+	void Draw ( GLuint shader, uniform_t< ivec2 > &binOffset, const textGlyphAtlas_t &atlas ) { // bind the data texture and dispatch
+		Resend( atlas );
+
+		// nothing drawable in this layer, nothing it would write
+		if ( uploadState.Visible().empty() ) return;
 
 		// bind the data texture to slot 1 - this will need massaging eventually to use the new bindsets
 		glBindImageTexture( 1, textureManager_local->Get( layerLabel ), 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA8UI );
 
-		// this is actually very sexy - workgroup is 8x16, same as a glyph's dimensions
-		glDispatchCompute( width, height, 1 );
+		// this is actually very sexy - workgroup is 8x16, same as a glyph's dimensions - one dispatch per band of rows
+			// holding anything drawable, rather than every cell of the layer
+		for ( auto &band : uploadState.Visible() ) {
+			UniformCache().Set( shader, binOffset, ivec2( band.x, band.y ) );
+			glDispatchCompute( band.w, band.h, 1 );
+		}
 	}
 
 	void ClearBuffer () {
+		bufferDirty = true;
 		size_t numBytes = sizeof( cChar ) * width * height;
 		memset( ( void * ) bufferBase, 0, numBytes );
 	}
 
 	cChar GetCharAt ( glm::uvec2 position ) {
 		if ( position.x < width && position.y < height ) // >= 0 is implicit with unsigned
-			return *( bufferBase + sizeof( cChar ) * ( position.x + position.y * width ) );
+			return bufferBase[ position.x + position.y * width ];
 		else
 			return cChar();
 	}
 
 	void WriteCharAt ( glm::uvec2 position, cChar c ) {
 		if ( position.x < width && position.y < height ) {
+			bufferDirty = true;
 			int index = position.x + position.y * width;
 			bufferBase[ index ] = c;
 		}
 	}
 
-	void WriteString ( glm::uvec2 min, glm::uvec2 max, std::string str, glm::ivec3 color ) {
+	void WriteString ( glm::uvec2 min, glm::uvec2 max, const std::string &str, glm::ivec3 color ) {
 		bufferDirty = true;
 		glm::uvec2 cursor = min;
 		for ( auto c : str ) {
@@ -141,19 +156,19 @@ public:
 		}
 	}
 
-	void WriteCCharVector ( glm::uvec2 min, glm::uvec2 max, std::vector< cChar > vec ) {
+	void WriteCCharVector ( glm::uvec2 min, glm::uvec2 max, const std::vector< cChar > &vec ) {
 		bufferDirty = true;
 		glm::uvec2 cursor = min;
 		for ( unsigned int i = 0; i < vec.size(); i++ ) {
-			if ( vec[ i ].data[ 4 ] == '\t' ) {
+			if ( vec[ i ].data[ 3 ] == '\t' ) {
 				cursor.x += 2;
-			} else if ( vec[ i ].data[ 4 ] == '\n' ) {
+			} else if ( vec[ i ].data[ 3 ] == '\n' ) {
 				cursor.y++;
 				cursor.x = min.x;
 				if ( cursor.y > max.y ) {
 					break;
 				}
-			} else if ( vec[ i ].data[ 4 ] == 0 ) { // special no-write character
+			} else if ( vec[ i ].data[ 3 ] == 0 ) { // special no-write character
 				cursor.x++;
 			} else {
 				WriteCharAt( cursor, vec[ i ] );
@@ -248,9 +263,13 @@ public:
 
 	unsigned int width, height;
 	textureManager_t * textureManager_local = nullptr;
-	bool bufferDirty;
+	bool bufferDirty = true;
 	string layerLabel;
 	cChar * bufferBase = nullptr;
+
+	// what the data texture holds, and the rects of the last diff against it
+	textLayerState_t uploadState;
+	std::vector< textRect_t > uploadRects;
 };
 
 class layerManager {
@@ -284,6 +303,15 @@ public:
 		fontWriteShader = shader;
 	}
 
+	// the atlas the shader reads, kept CPU side too - decides which glyphs can write anything, and feeds the CPU compositor
+	void LoadAtlas ( const uint8_t * rgba, int w, int h ) {
+		atlas.Load( rgba, w, h );
+		for ( auto& layer : layers ) {
+			layer.uploadState.Invalidate();
+			layer.bufferDirty = true;
+		}
+	}
+
 	void DrawProgressBarString ( int offset, progressBar p ) {
 		// background
 		layers[ 0 ].DrawRectConstant( glm::uvec2( layers[ 0 ].width - p.currentState().length(), offset ), glm::uvec2( layers[ 0 ].width, offset ), cChar( BLACK, FILL_100 ) );
@@ -372,10 +400,11 @@ public:
 			ms += ( msHistory[ i ] / msHistory.size() );
 		}
 
-		std::stringstream ss;
-		ss << " frame total: " << std::setw( 10 ) << std::setfill( ' ' ) << std::setprecision( 4 ) << std::fixed << ms << "ms";
-		layers[ 0 ].DrawRectConstant( glm::uvec2( layers[ 0 ].width - ss.str().length(), 0 ), glm::uvec2( layers[ 0 ].width, 0 ), cChar( BLACK, FILL_100 ) );
-		layers[ 1 ].WriteString( glm::uvec2( layers[ 1 ].width - ss.str().length(), 0 ), glm::uvec2( layers[ 1 ].width, 0 ), ss.str(), WHITE );
+		// fixed buffer, same format the stringstream gave ( setw( 10 ), setprecision( 4 ), fixed )
+		char frameTotal[ 64 ];
+		const unsigned int length = std::max( 0, snprintf( frameTotal, sizeof( frameTotal ), " frame total: %10.4fms", ms ) );
+		layers[ 0 ].DrawRectConstant( glm::uvec2( layers[ 0 ].width - length, 0 ), glm::uvec2( layers[ 0 ].width, 0 ), cChar( BLACK, FILL_100 ) );
+		layers[ 1 ].WriteString( glm::uvec2( layers[ 1 ].width - length, 0 ), glm::uvec2( layers[ 1 ].width, 0 ), frameTotal, WHITE );
 
 		// the above writes a string 20 chars long
 		// layers[ 0 ].DrawRectConstant( glm::uvec2( layers[ 0 ].width - ss.str().length(), 1 ), glm::uvec2( layers[ 0 ].width, 7 ), cChar( GOLD, FILL_25 ) );
@@ -387,8 +416,8 @@ public:
 		glBindImageTexture( 0, textureManager_local->Get( "Font Atlas" ), 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA8UI );
 		// this will also need to be massaged a little bit, tbd
 		glBindImageTexture( 2, writeTarget, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA8UI );
-		for ( auto layer : layers ) {
-			layer.Draw(); // data texture( 1 ) is bound internal to this function, since it is unique to each layer
+		for ( auto& layer : layers ) {
+			layer.Draw( fontWriteShader, binOffset, atlas ); // data texture( 1 ) is bound internal to this function, since it is unique to each layer
 		}
 	}
 
@@ -399,6 +428,8 @@ public:
 	glm::ivec2 basePt;
 
 	GLuint fontWriteShader;
+	uniform_t< ivec2 > binOffset { "binOffset" }; // first cell of the band being dispatched
+	textGlyphAtlas_t atlas;
 
 	// allocation of the textures happens in TextRenderLayer()
 	std::vector< TextRenderLayer > layers;
@@ -0,0 +1,306 @@
+#ifndef TEXT_COMPOSITOR_H
+#define TEXT_COMPOSITOR_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+// the bookkeeping behind the text layers, with no GL in it - renderer.h does the uploads and the dispatches. Cells
+	// are 4 bytes each, laid out like cChar: rgb, then the glyph index.
+
+// a rectangle of glyph cells
+struct textRect_t {
+	int x, y, w, h;
+};
+
+//===== Glyph Atlas ===================================================================================================
+// the font atlas, as the engine loads it ( flipped vertically, so row 0 is the bottom ) - 16x16 glyphs, 8x16 pixels
+	// each, addressed the same way as font.cs.glsl does it
+struct textGlyphAtlas_t {
+	int width = 0;
+	int height = 0;
+	std::vector< uint8_t > pixels;	// RGBA8
+	bool drawable[ 256 ];			// glyph has at least one pixel with nonzero alpha
+
+	textGlyphAtlas_t () { std::fill( drawable, drawable + 256, true ); } // until loaded, anything might draw
+
+	void Load ( const uint8_t * rgba, const int w, const int h ) {
+		width = w;
+		height = h;
+		pixels.assign( rgba, rgba + size_t( w ) * h * 4 );
+		for ( int glyph = 0; glyph < 256; glyph++ ) {
+			drawable[ glyph ] = false;
+			for ( int py = 0; py < 16 && !drawable[ glyph ]; py++ ) {
+				for ( int px = 0; px < 8; px++ ) {
+					const uint8_t * texel = Texel( glyph, px, py );
+					if ( texel != nullptr && texel[ 3 ] != 0 ) {
+						drawable[ glyph ] = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	bool Loaded () const { return !pixels.empty(); }
+
+	// getCurrentGlyphBase( glyph ) + loc from the shader, nullptr where imageLoad would be out of bounds
+	const uint8_t * Texel ( const int glyph, const int px, const int py ) const {
+		const int x = 8 * ( glyph % 16 ) + px;
+		const int y = 239 - 16 * ( glyph / 16 ) + py + 1;
+		if ( x < 0 || y < 0 || x >= width || y >= height ) return nullptr;
+		return &pixels[ 4 * ( size_t( x ) + size_t( y ) * width ) ];
+	}
+};
+
+//===== Layer Upload State ============================================================================================
+// a copy of what a layer's data texture holds, so a frame's writes can be diffed against it. Only rows that differ go
+	// up, as rects spanning their changed cells, and a layer that comes out identical makes no calls at all. It also
+	// keeps the bands of rows holding anything drawable - those are all that needs dispatching, the rest of the cells
+	// would not write a pixel.
+class textLayerState_t {
+public:
+	// accumulated since construction
+	struct stats_t {
+		size_t updates = 0;			// Update calls
+		size_t unchanged = 0;		// that found nothing to upload
+		size_t rects = 0;			// upload rects handed out
+		size_t cellsUploaded = 0;
+	} stats;
+
+	void Resize ( const int w, const int h ) {
+		width = w;
+		height = h;
+		uploaded.assign( size_t( w ) * h * 4, 0 );
+		rowMin.assign( h, w );
+		rowMax.assign( h, -1 );
+		visible.clear();
+		valid = false;
+	}
+
+	// the texture's contents are unknown ( new texture, or the atlas changed what counts as drawable ), send it all
+	void Invalidate () { valid = false; }
+
+	// diff against the last upload, replacing uploads with the rects to send - false when there is nothing to send
+	bool Update ( const uint8_t * cells, const textGlyphAtlas_t &atlas, std::vector< textRect_t > &uploads ) {
+		stats.updates++;
+		uploads.clear();
+		const size_t rowBytes = size_t( width ) * 4;
+		for ( int y = 0; y < height; y++ ) {
+			const uint8_t * row = cells + y * rowBytes;
+			uint8_t * shadow = uploaded.data() + y * rowBytes;
+			int x0 = 0, x1 = width - 1;
+			if ( valid ) {
+				if ( memcmp( row, shadow, rowBytes ) == 0 ) continue;
+				while ( memcmp( row + 4 * x0, shadow + 4 * x0, 4 ) == 0 ) x0++;
+				while ( memcmp( row + 4 * x1, shadow + 4 * x1, 4 ) == 0 ) x1--;
+			}
+			memcpy( shadow + 4 * x0, row + 4 * x0, size_t( x1 - x0 + 1 ) * 4 );
+
+			// drawable extent of this row
+			rowMin[ y ] = width;
+			rowMax[ y ] = -1;
+			for ( int x = 0; x < width; x++ ) {
+				if ( atlas.drawable[ shadow[ 4 * x + 3 ] ] ) {
+					rowMin[ y ] = std::min( rowMin[ y ], x );
+					rowMax[ y ] = x;
+				}
+			}
+
+			// continue the last rect if it ended on the row above, else start a new one
+			if ( !uploads.empty() && uploads.back().y + uploads.back().h == y ) {
+				textRect_t &r = uploads.back();
+				const int right = std::max( r.x + r.w - 1, x1 );
+				r.x = std::min( r.x, x0 );
+				r.w = right - r.x + 1;
+				r.h++;
+			} else {
+				uploads.push_back( { x0, y, x1 - x0 + 1, 1 } );
+			}
+		}
+		valid = true;
+
+		if ( uploads.empty() ) {
+			stats.unchanged++;
+			return false;
+		}
+		stats.rects += uploads.size();
+		for ( auto &r : uploads ) {
+			stats.cellsUploaded += size_t( r.w ) * r.h;
+		}
+
+		// runs of rows with anything drawable, each spanning the union of its rows' extents
+		visible.clear();
+		for ( int y = 0; y < height; y++ ) {
+			if ( rowMax[ y ] < 0 ) continue;
+			if ( !visible.empty() && visible.back().y + visible.back().h == y ) {
+				textRect_t &r = visible.back();
+				const int right = std::max( r.x + r.w - 1, rowMax[ y ] );
+				r.x = std::min( r.x, rowMin[ y ] );
+				r.w = right - r.x + 1;
+				r.h++;
+			} else {
+				visible.push_back( { rowMin[ y ], y, rowMax[ y ] - rowMin[ y ] + 1, 1 } );
+			}
+		}
+		return true;
+	}
+
+	const std::vector< textRect_t > &Visible () const { return visible; }
+
+	// cells a dispatch of every visible band covers
+	size_t VisibleCells () const {
+		size_t count = 0;
+		for ( auto &r : visible ) count += size_t( r.w ) * r.h;
+		return count;
+	}
+
+private:
+	int width = 0;
+	int height = 0;
+	bool valid = false;
+	std::vector< uint8_t > uploaded;
+	std::vector< int > rowMin;	// drawable cells per row, rowMax < 0 when there are none
+	std::vector< int > rowMax;
+	std::vector< textRect_t > visible;
+};
+
+//===== CPU Compositor ================================================================================================
+// font.cs.glsl on the CPU, one pixel per invocation the same way, for the cells in rect - target is RGBA8, 8 * width
+	// pixels across, with at least 16 * ( rect.y + rect.h ) rows
+inline void CompositeTextLayer ( const textGlyphAtlas_t &atlas, const uint8_t * cells, const int width, const textRect_t &rect, uint8_t * target ) {
+	const size_t targetWidth = size_t( width ) * 8;
+	for ( int cy = rect.y; cy < rect.y + rect.h; cy++ ) {
+		for ( int cx = rect.x; cx < rect.x + rect.w; cx++ ) {
+			const uint8_t * cell = cells + 4 * ( size_t( cx ) + size_t( cy ) * width );
+			for ( int py = 0; py < 16; py++ ) {
+				uint8_t * out = target + 4 * ( size_t( cx ) * 8 + ( size_t( cy ) * 16 + py ) * targetWidth );
+				for ( int px = 0; px < 8; px++, out += 4 ) {
+					const uint8_t * texel = atlas.Texel( cell[ 3 ], px, py );
+					if ( texel != nullptr && texel[ 3 ] != 0 ) {
+						out[ 0 ] = cell[ 0 ];
+						out[ 1 ] = cell[ 1 ];
+						out[ 2 ] = cell[ 2 ];
+						out[ 3 ] = texel[ 3 ];
+					}
+				}
+			}
+		}
+	}
+}
+
+//===== Compositor Benchmark ==========================================================================================
+// frames shaped like what the projects do - clear every layer, write the frame time in the corner, draw an open
+	// terminal with a blinking cursor - composited by the CPU compositor both ways. Full is the old path: every layer
+	// uploaded and every cell dispatched, every frame. Dirty diffs against the last upload and composites the visible
+	// bands. Both outputs are compared every frame.
+struct textCompositorBenchmark_t {
+	size_t numFrames = 0;
+	double fullMs = 0.0;			// per frame, compositing every cell of every layer
+	double dirtyMs = 0.0;			// per frame, diffing + compositing the visible bands
+	size_t fullBytes = 0;			// uploaded per frame
+	size_t dirtyBytes = 0;
+	size_t fullCells = 0;			// dispatched per frame
+	size_t dirtyCells = 0;
+	size_t unchangedLayers = 0;		// layer updates with nothing to send, over the run
+	bool identical = true;
+};
+
+inline textCompositorBenchmark_t RunTextCompositorBenchmark ( const size_t numFrames, const int width, const int height, const textGlyphAtlas_t &atlas ) {
+	textCompositorBenchmark_t result;
+	result.numFrames = numFrames;
+	constexpr int numLayers = 3; // background, foreground, cursor - like layerManager::Init
+	const size_t layerBytes = size_t( width ) * height * 4;
+	std::vector< uint8_t > layers[ numLayers ];
+	textLayerState_t states[ numLayers ];
+	for ( int l = 0; l < numLayers; l++ ) {
+		layers[ l ].resize( layerBytes );
+		states[ l ].Resize( width, height );
+	}
+	const size_t targetBytes = layerBytes * 8 * 16;
+	std::vector< uint8_t > fullTarget( targetBytes ), dirtyTarget( targetBytes );
+	std::vector< textRect_t > uploads;
+
+	auto put = [ & ] ( int l, int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t glyph ) {
+		if ( x < 0 || y < 0 || x >= width || y >= height ) return;
+		uint8_t * cell = layers[ l ].data() + 4 * ( size_t( x ) + size_t( y ) * width );
+		cell[ 0 ] = r; cell[ 1 ] = g; cell[ 2 ] = b; cell[ 3 ] = glyph;
+	};
+	auto write = [ & ] ( int l, int x, int y, const char * s, uint8_t r, uint8_t g, uint8_t b ) {
+		for ( ; *s != 0; s++, x++ ) put( l, x, y, r, g, b, uint8_t( *s ) );
+	};
+
+	// terminal placement, inside whatever fits
+	const int termX = std::min( 10, width / 8 );
+	const int termY = std::min( 10, height / 8 );
+	const int termW = std::max( 0, std::min( 80, width - 2 * termX ) );
+	const int termH = std::max( 0, std::min( 24, height - 2 * termY ) );
+
+	double fullSeconds = 0.0, dirtySeconds = 0.0;
+	for ( size_t frame = 0; frame < numFrames; frame++ ) {
+		// the frame's writes
+		for ( int l = 0; l < numLayers; l++ ) {
+			memset( layers[ l ].data(), 0, layerBytes );
+		}
+		char fps[ 64 ];
+		const int length = snprintf( fps, sizeof( fps ), " frame total: %10.4fms", 16.6 + 0.25 * std::sin( double( frame ) ) );
+		for ( int x = width - length; x <= width; x++ ) put( 0, x, 0, 16, 16, 16, 219 );
+		write( 1, width - length, 0, fps, 255, 255, 255 );
+		for ( int y = termY; y <= termY + termH; y++ ) {
+			for ( int x = termX; x <= termX + termW; x++ ) put( 0, x, y, 17, 35, 24, 219 );
+		}
+		for ( int line = 1; line <= termH; line++ ) {
+			char text[ 64 ];
+			snprintf( text, sizeof( text ), "[%02d:%02d] history line %d", line / 60, line % 60, line );
+			write( 1, termX, termY + line, text, 137, 162, 87 );
+		}
+		write( 1, termX, termY, "[00:00] > textCompositorBenchmark", 137, 162, 87 );
+		const uint8_t blink = uint8_t( 191.0 * std::abs( std::sin( frame * 0.1 ) ) );
+		put( 2, termX + 33, termY, blink, blink, blink, '_' );
+
+		std::fill( fullTarget.begin(), fullTarget.end(), 0 );
+		std::fill( dirtyTarget.begin(), dirtyTarget.end(), 0 );
+
+		// every layer, every cell
+		auto tStart = std::chrono::high_resolution_clock::now();
+		for ( int l = 0; l < numLayers; l++ ) {
+			CompositeTextLayer( atlas, layers[ l ].data(), width, { 0, 0, width, height }, fullTarget.data() );
+		}
+		fullSeconds += std::chrono::duration< double >( std::chrono::high_resolution_clock::now() - tStart ).count();
+		result.fullBytes += numLayers * layerBytes;
+		result.fullCells += numLayers * size_t( width ) * height;
+
+		// changed spans up, visible bands composited
+		tStart = std::chrono::high_resolution_clock::now();
+		for ( int l = 0; l < numLayers; l++ ) {
+			if ( states[ l ].Update( layers[ l ].data(), atlas, uploads ) ) {
+				for ( auto &r : uploads ) result.dirtyBytes += size_t( r.w ) * r.h * 4;
+			} else {
+				result.unchangedLayers++;
+			}
+			for ( auto &band : states[ l ].Visible() ) {
+				CompositeTextLayer( atlas, layers[ l ].data(), width, band, dirtyTarget.data() );
+			}
+			result.dirtyCells += states[ l ].VisibleCells();
+		}
+		dirtySeconds += std::chrono::duration< double >( std::chrono::high_resolution_clock::now() - tStart ).count();
+
+		result.identical = result.identical && ( fullTarget == dirtyTarget );
+	}
+
+	const size_t frames = std::max( numFrames, size_t( 1 ) );
+	result.fullMs = fullSeconds * 1000.0 / frames;
+	result.dirtyMs = dirtySeconds * 1000.0 / frames;
+	result.fullBytes /= frames;
+	result.dirtyBytes /= frames;
+	result.fullCells /= frames;
+	result.dirtyCells /= frames;
+	return result;
+}
+
+#endif // TEXT_COMPOSITOR_H
@@ -0,0 +1,641 @@
+#pragma once
+#ifndef BATCH_NOISE_H
+#define BATCH_NOISE_H
+
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#include "../GLM/glm.hpp"
+#include "../../engine/coreUtils/image2.h"
+#include "../../engine/coreUtils/parallel.h"
+#include "perlin.h"
+#include "diamondSquare/diamond_square.h"
+
+// float noise, evaluated in blocks of LANES points at a time instead of one double sample per call. The lattice
+	// hash is arithmetic instead of a permutation table lookup, so a block is straight-line math - with AVX that's
+	// one 256-bit register per value ( integer hash on the two SSE4.1 halves ), without it the same math in plain
+	// loops. Fill() covers an Image_1F region with row bands split across threads.
+	//	- PERLIN, PERLIN_3D ( slice at config.z ), SIMPLEX, VALUE
+	//	- NONE / FBM / RIDGED octave summation
+	//	- tileable output via config.tilePeriod, for PERLIN, PERLIN_3D ( in x and y ) and VALUE - SIMPLEX's
+	//		skewed lattice doesn't wrap onto a rectangle, so it ignores the period
+	// DiamondSquare() is the midpoint displacement from heightfield::diamond_square_no_wrap, on a flat array,
+	// with a counter-based random number per point so that each pass can be split across threads and the result
+	// still only depends on the seed.
+
+namespace batchNoise {
+
+constexpr int LANES = 8;
+
+enum noiseType_e { PERLIN, PERLIN_3D, SIMPLEX, VALUE };
+enum fractalType_e { NONE, FBM, RIDGED };
+
+struct config_t {
+	noiseType_e type = PERLIN;
+	fractalType_e fractal = FBM;
+	uint32_t seed = 0;
+	uint32_t octaves = 6;
+	float frequency = 1.0f / 256.0f;	// lattice cells per unit ( per pixel, for Fill )
+	float lacunarity = 2.0f;
+	float gain = 0.5f;
+	glm::vec2 offset = glm::vec2( 0.0f );	// added to positions before scaling
+	float z = 0.0f;						// slice position, for PERLIN_3D
+	glm::ivec2 tilePeriod = glm::ivec2( 0 );	// units until the pattern repeats, 0 for no tiling
+	bool remap01 = true;				// [ -1, 1 ] -> [ 0, 1 ], like PerlinNoise::noise
+};
+
+//===== Lattice ========================================================================================================
+inline uint32_t Hash ( const uint32_t x, const uint32_t y, const uint32_t z, const uint32_t seed ) {
+	uint32_t h = seed ^ ( z * 0xCB1AB31Fu ) ^ ( x * 0x8DA6B343u ) ^ ( y * 0xD8163841u );
+	h ^= h >> 16; h *= 0x7FEB352Du;
+	h ^= h >> 15; h *= 0x846CA68Bu;
+	h ^= h >> 16;
+	return h;
+}
+
+inline float Fade ( const float t ) { return t * t * t * ( t * ( t * 6.0f - 15.0f ) + 10.0f ); }
+
+// 8 directions of length sqrt( 2 ) - four diagonals and four axes, picked by the low hash bits
+inline float Grad2 ( const uint32_t h, const float x, const float y ) {
+	const float sxx = ( h & 1u ) ? x : -x;
+	const float syy = ( h & 2u ) ? y : -y;
+	const float axis = 1.41421356f * ( ( h & 8u ) ? sxx : syy );
+	return ( h & 4u ) ? sxx + syy : axis;
+}
+
+// Ken Perlin's 12 edge directions, from the improved noise reference
+inline float Grad3 ( const uint32_t hash, const float x, const float y, const float z ) {
+	const uint32_t h = hash & 15u;
+	const float u = h < 8u ? x : y;
+	const float v = h < 4u ? y : ( h == 12u || h == 14u ) ? x : z;
+	return ( ( h & 1u ) ? -u : u ) + ( ( h & 2u ) ? -v : v );
+}
+
+// lattice cell for a coordinate, wrapped into [ 0, period ) when tiling
+template < bool tiled >
+inline void Cell ( const float f, const float period, int32_t &i0, int32_t &i1 ) {
+	if ( tiled ) {
+		const float w = f - period * std::floor( f / period );
+		i0 = int32_t( w );
+		i1 = ( w + 1.0f >= period ) ? 0 : i0 + 1;
+	} else {
+		i0 = int32_t( f );
+		i1 = i0 + 1;
+	}
+}
+
+#ifdef __AVX__
+// same functions, eight lanes at a time. AVX has no 256-bit integer instructions ( that came with AVX2 ), so the
+	// hash runs on the two SSE4.1 halves, and everything else stays in float. Results match the scalar path exactly.
+namespace avx {
+
+inline __m128i HashHalf ( const __m128i x, const __m128i y, const __m128i seed ) {
+	__m128i h = _mm_xor_si128( seed, _mm_xor_si128( _mm_mullo_epi32( x, _mm_set1_epi32( int( 0x8DA6B343u ) ) ), _mm_mullo_epi32( y, _mm_set1_epi32( int( 0xD8163841u ) ) ) ) );
+	h = _mm_mullo_epi32( _mm_xor_si128( h, _mm_srli_epi32( h, 16 ) ), _mm_set1_epi32( 0x7FEB352D ) );
+	h = _mm_mullo_epi32( _mm_xor_si128( h, _mm_srli_epi32( h, 15 ) ), _mm_set1_epi32( int( 0x846CA68Bu ) ) );
+	return _mm_xor_si128( h, _mm_srli_epi32( h, 16 ) );
+}
+
+// z folds into the seed, the same as the scalar Hash()
+inline __m256i Hash ( const __m256i x, const __m256i y, const uint32_t z, const uint32_t seed ) {
+	const __m128i s = _mm_set1_epi32( int( seed ^ ( z * 0xCB1AB31Fu ) ) );
+	const __m128i lo = HashHalf( _mm256_castsi256_si128( x ), _mm256_castsi256_si128( y ), s );
+	const __m128i hi = HashHalf( _mm256_extractf128_si256( x, 1 ), _mm256_extractf128_si256( y, 1 ), s );
+	return _mm256_insertf128_si256( _mm256_castsi128_si256( lo ), hi, 1 );
+}
+
+// all ones in the lanes where bit k of h is set - spread with a shift pair on each half
+template < int k >
+inline __m256 Bit ( const __m256i h ) {
+	const __m128i lo = _mm_srai_epi32( _mm_slli_epi32( _mm256_castsi256_si128( h ), 31 - k ), 31 );
+	const __m128i hi = _mm_srai_epi32( _mm_slli_epi32( _mm256_extractf128_si256( h, 1 ), 31 - k ), 31 );
+	return _mm256_castsi256_ps( _mm256_insertf128_si256( _mm256_castsi128_si256( lo ), hi, 1 ) );
+}
+
+// b where mask is set, else a - with and / andnot rather than blendv, which GCC likes to rewrite as an integer
+	// compare against zero, and then split into scalar code since AVX doesn't have that at 256 bits
+inline __m256 Select ( const __m256 a, const __m256 b, const __m256 mask ) {
+	return _mm256_or_ps( _mm256_and_ps( mask, b ), _mm256_andnot_ps( mask, a ) );
+}
+
+inline __m256 Fade ( const __m256 t ) {
+	const __m256 inner = _mm256_add_ps( _mm256_mul_ps( t, _mm256_sub_ps( _mm256_mul_ps( t, _mm256_set1_ps( 6.0f ) ), _mm256_set1_ps( 15.0f ) ) ), _mm256_set1_ps( 10.0f ) );
+	return _mm256_mul_ps( _mm256_mul_ps( _mm256_mul_ps( t, t ), t ), inner );
+}
+
+inline __m256 Lerp ( const __m256 a, const __m256 b, const __m256 t ) {
+	return _mm256_add_ps( a, _mm256_mul_ps( t, _mm256_sub_ps( b, a ) ) );
+}
+
+inline __m256 Grad2 ( const __m256i h, const __m256 x, const __m256 y ) {
+	const __m256 sxx = Select( _mm256_sub_ps( _mm256_setzero_ps(), x ), x, Bit< 0 >( h ) );
+	const __m256 syy = Select( _mm256_sub_ps( _mm256_setzero_ps(), y ), y, Bit< 1 >( h ) );
+	const __m256 axis = _mm256_mul_ps( _mm256_set1_ps( 1.41421356f ), Select( syy, sxx, Bit< 3 >( h ) ) );
+	return Select( axis, _mm256_add_ps( sxx, syy ), Bit< 2 >( h ) );
+}
+
+// h < 8 is bit 3 clear, h < 4 is bits 3 and 2 clear, h == 12 || h == 14 is bits 3 and 2 set with bit 0 clear
+inline __m256 Grad3 ( const __m256i h, const __m256 x, const __m256 y, const __m256 z ) {
+	const __m256 b0 = Bit< 0 >( h ), b1 = Bit< 1 >( h ), b2 = Bit< 2 >( h ), b3 = Bit< 3 >( h );
+	const __m256 u = Select( x, y, b3 );
+	const __m256 xOrZ = Select( z, x, _mm256_andnot_ps( b0, _mm256_and_ps( b3, b2 ) ) );
+	const __m256 v = Select( y, xOrZ, _mm256_or_ps( b3, b2 ) );
+	const __m256 su = Select( u, _mm256_sub_ps( _mm256_setzero_ps(), u ), b0 );
+	const __m256 sv = Select( v, _mm256_sub_ps( _mm256_setzero_ps(), v ), b1 );
+	return _mm256_add_ps( su, sv );
+}
+
+template < bool tiled >
+inline void Cell ( const __m256 f, const float period, __m256i &i0, __m256i &i1 ) {
+	if ( tiled ) {
+		const __m256 p = _mm256_set1_ps( period );
+		const __m256 w = _mm256_sub_ps( f, _mm256_mul_ps( p, _mm256_floor_ps( _mm256_div_ps( f, p ) ) ) );
+		const __m256 next = _mm256_add_ps( w, _mm256_set1_ps( 1.0f ) );
+		i0 = _mm256_cvttps_epi32( w );
+		i1 = _mm256_cvttps_epi32( Select( next, _mm256_setzero_ps(), _mm256_cmp_ps( next, p, _CMP_GE_OQ ) ) );
+	} else {
+		i0 = _mm256_cvttps_epi32( f );
+		i1 = _mm256_cvttps_epi32( _mm256_add_ps( f, _mm256_set1_ps( 1.0f ) ) );
+	}
+}
+
+} // namespace avx
+#endif
+
+//===== Kernels ========================================================================================================
+// one octave for LANES points, x / y / z already scaled to lattice units - output in about [ -1, 1 ]
+template < bool tiled >
+inline void PerlinLanes ( const float * x, const float * y, const uint32_t seed, const float px, const float py, float * out ) {
+#ifdef __AVX__
+	const __m256 vx = _mm256_load_ps( x ), vy = _mm256_load_ps( y );
+	const __m256 fx = _mm256_floor_ps( vx ), fy = _mm256_floor_ps( vy );
+	const __m256 tx = _mm256_sub_ps( vx, fx ), ty = _mm256_sub_ps( vy, fy );
+	const __m256 tx1 = _mm256_sub_ps( tx, _mm256_set1_ps( 1.0f ) ), ty1 = _mm256_sub_ps( ty, _mm256_set1_ps( 1.0f ) );
+	__m256i x0, x1, y0, y1;
+	avx::Cell< tiled >( fx, px, x0, x1 );
+	avx::Cell< tiled >( fy, py, y0, y1 );
+	const __m256 g00 = avx::Grad2( avx::Hash( x0, y0, 0, seed ), tx, ty );
+	const __m256 g10 = avx::Grad2( avx::Hash( x1, y0, 0, seed ), tx1, ty );
+	const __m256 g01 = avx::Grad2( avx::Hash( x0, y1, 0, seed ), tx, ty1 );
+	const __m256 g11 = avx::Grad2( avx::Hash( x1, y1, 0, seed ), tx1, ty1 );
+	const __m256 u = avx::Fade( tx ), v = avx::Fade( ty );
+	_mm256_store_ps( out, avx::Lerp( avx::Lerp( g00, g10, u ), avx::Lerp( g01, g11, u ), v ) );
+#else
+	for ( int l = 0; l < LANES; l++ ) {
+		const float fx = std::floor( x[ l ] ), fy = std::floor( y[ l ] );
+		const float tx = x[ l ] - fx, ty = y[ l ] - fy;
+		int32_t x0, x1, y0, y1;
+		Cell< tiled >( fx, px, x0, x1 );
+		Cell< tiled >( fy, py, y0, y1 );
+		const float g00 = Grad2( Hash( x0, y0, 0, seed ), tx, ty );
+		const float g10 = Grad2( Hash( x1, y0, 0, seed ), tx - 1.0f, ty );
+		const float g01 = Grad2( Hash( x0, y1, 0, seed ), tx, ty - 1.0f );
+		const float g11 = Grad2( Hash( x1, y1, 0, seed ), tx - 1.0f, ty - 1.0f );
+		const float u = Fade( tx ), v = Fade( ty );
+		const float a = g00 + u * ( g10 - g00 );
+		const float b = g01 + u * ( g11 - g01 );
+		out[ l ] = a + v * ( b - a );
+	}
+#endif
+}
+
+template < bool tiled >
+inline void Perlin3Lanes ( const float * x, const float * y, const float z, const uint32_t seed, const float px, const float py, float * out ) {
+	const float fz = std::floor( z );
+	const float tz = z - fz;
+	const uint32_t z0 = uint32_t( int32_t( fz ) ), z1 = z0 + 1;
+	const float w = Fade( tz );
+#ifdef __AVX__
+	const __m256 vx = _mm256_load_ps( x ), vy = _mm256_load_ps( y );
+	const __m256 fx = _mm256_floor_ps( vx ), fy = _mm256_floor_ps( vy );
+	const __m256 tx = _mm256_sub_ps( vx, fx ), ty = _mm256_sub_ps( vy, fy );
+	const __m256 tx1 = _mm256_sub_ps( tx, _mm256_set1_ps( 1.0f ) ), ty1 = _mm256_sub_ps( ty, _mm256_set1_ps( 1.0f ) );
+	const __m256 vz0 = _mm256_set1_ps( tz ), vz1 = _mm256_set1_ps( tz - 1.0f );
+	__m256i x0, x1, y0, y1;
+	avx::Cell< tiled >( fx, px, x0, x1 );
+	avx::Cell< tiled >( fy, py, y0, y1 );
+	const __m256 u = avx::Fade( tx ), v = avx::Fade( ty );
+	const __m256 c0 = avx::Lerp(
+		avx::Lerp( avx::Grad3( avx::Hash( x0, y0, z0, seed ), tx, ty, vz0 ), avx::Grad3( avx::Hash( x1, y0, z0, seed ), tx1, ty, vz0 ), u ),
+		avx::Lerp( avx::Grad3( avx::Hash( x0, y1, z0, seed ), tx, ty1, vz0 ), avx::Grad3( avx::Hash( x1, y1, z0, seed ), tx1, ty1, vz0 ), u ), v );
+	const __m256 c1 = avx::Lerp(
+		avx::Lerp( avx::Grad3( avx::Hash( x0, y0, z1, seed ), tx, ty, vz1 ), avx::Grad3( avx::Hash( x1, y0, z1, seed ), tx1, ty, vz1 ), u ),
+		avx::Lerp( avx::Grad3( avx::Hash( x0, y1, z1, seed ), tx, ty1, vz1 ), avx::Grad3( avx::Hash( x1, y1, z1, seed ), tx1, ty1, vz1 ), u ), v );
+	_mm256_store_ps( out, avx::Lerp( c0, c1, _mm256_set1_ps( w ) ) );
+#else
+	for ( int l = 0; l < LANES; l++ ) {
+		const float fx = std::floor( x[ l ] ), fy = std::floor( y[ l ] );
+		const float tx = x[ l ] - fx, ty = y[ l ] - fy;
+		int32_t x0, x1, y0, y1;
+		Cell< tiled >( fx, px, x0, x1 );
+		Cell< tiled >( fy, py, y0, y1 );
+		const float u = Fade( tx ), v = Fade( ty );
+		const float g000 = Grad3( Hash( x0, y0, z0, seed ), tx, ty, tz );
+		const float g100 = Grad3( Hash( x1, y0, z0, seed ), tx - 1.0f, ty, tz );
+		const float g010 = Grad3( Hash( x0, y1, z0, seed ), tx, ty - 1.0f, tz );
+		const float g110 = Grad3( Hash( x1, y1, z0, seed ), tx - 1.0f, ty - 1.0f, tz );
+		const float g001 = Grad3( Hash( x0, y0, z1, seed ), tx, ty, tz - 1.0f );
+		const float g101 = Grad3( Hash( x1, y0, z1, seed ), tx - 1.0f, ty, tz - 1.0f );
+		const float g011 = Grad3( Hash( x0, y1, z1, seed ), tx, ty - 1.0f, tz - 1.0f );
+		const float g111 = Grad3( Hash( x1, y1, z1, seed ), tx - 1.0f, ty - 1.0f, tz - 1.0f );
+		const float a0 = g000 + u * ( g100 - g000 ), b0 = g010 + u * ( g110 - g010 );
+		const float a1 = g001 + u * ( g101 - g001 ), b1 = g011 + u * ( g111 - g011 );
+		const float c0 = a0 + v * ( b0 - a0 ), c1 = a1 + v * ( b1 - a1 );
+		out[ l ] = c0 + w * ( c1 - c0 );
+	}
+#endif
+}
+
+// lattice values from the low 24 bits of the hash, mapped to [ -1, 1 )
+template < bool tiled >
+inline void ValueLanes ( const float * x, const float * y, const uint32_t seed, const float px, const float py, float * out ) {
+	constexpr float toSigned = 2.0f / 16777216.0f;
+#ifdef __AVX__
+	const __m256 vx = _mm256_load_ps( x ), vy = _mm256_load_ps( y );
+	const __m256 fx = _mm256_floor_ps( vx ), fy = _mm256_floor_ps( vy );
+	__m256i x0, x1, y0, y1;
+	avx::Cell< tiled >( fx, px, x0, x1 );
+	avx::Cell< tiled >( fy, py, y0, y1 );
+	const __m256 low24 = _mm256_castsi256_ps( _mm256_set1_epi32( 0xFFFFFF ) );
+	auto value = [ & ] ( const __m256i h ) {
+		const __m256 bits = _mm256_cvtepi32_ps( _mm256_castps_si256( _mm256_and_ps( _mm256_castsi256_ps( h ), low24 ) ) );
+		return _mm256_sub_ps( _mm256_mul_ps( bits, _mm256_set1_ps( toSigned ) ), _mm256_set1_ps( 1.0f ) );
+	};
+	const __m256 u = avx::Fade( _mm256_sub_ps( vx, fx ) ), v = avx::Fade( _mm256_sub_ps( vy, fy ) );
+	const __m256 a = avx::Lerp( value( avx::Hash( x0, y0, 0, seed ) ), value( avx::Hash( x1, y0, 0, seed ) ), u );
+	const __m256 b = avx::Lerp( value( avx::Hash( x0, y1, 0, seed ) ), value( avx::Hash( x1, y1, 0, seed ) ), u );
+	_mm256_store_ps( out, avx::Lerp( a, b, v ) );
+#else
+	for ( int l = 0; l < LANES; l++ ) {
+		const float fx = std::floor( x[ l ] ), fy = std::floor( y[ l ] );
+		const float tx = x[ l ] - fx, ty = y[ l ] - fy;
+		int32_t x0, x1, y0, y1;
+		Cell< tiled >( fx, px, x0, x1 );
+		Cell< tiled >( fy, py, y0, y1 );
+		const float v00 = float( Hash( x0, y0, 0, seed ) & 0xFFFFFFu ) * toSigned - 1.0f;
+		const float v10 = float( Hash( x1, y0, 0, seed ) & 0xFFFFFFu ) * toSigned - 1.0f;
+		const float v01 = float( Hash( x0, y1, 0, seed ) & 0xFFFFFFu ) * toSigned - 1.0f;
+		const float v11 = float( Hash( x1, y1, 0, seed ) & 0xFFFFFFu ) * toSigned - 1.0f;
+		const float u = Fade( tx ), v = Fade( ty );
+		const float a = v00 + u * ( v10 - v00 );
+		const float b = v01 + u * ( v11 - v01 );
+		out[ l ] = a + v * ( b - a );
+	}
+#endif
+}
+
+inline void SimplexLanes ( const float * x, const float * y, const uint32_t seed, float * out ) {
+	constexpr float F2 = 0.36602540378f;	// ( sqrt( 3 ) - 1 ) / 2
+	constexpr float G2 = 0.21132486540f;	// ( 3 - sqrt( 3 ) ) / 6
+#ifdef __AVX__
+	const __m256 vx = _mm256_load_ps( x ), vy = _mm256_load_ps( y );
+	const __m256 s = _mm256_mul_ps( _mm256_add_ps( vx, vy ), _mm256_set1_ps( F2 ) );
+	const __m256 fi = _mm256_floor_ps( _mm256_add_ps( vx, s ) ), fj = _mm256_floor_ps( _mm256_add_ps( vy, s ) );
+	const __m256 t = _mm256_mul_ps( _mm256_add_ps( fi, fj ), _mm256_set1_ps( G2 ) );
+	const __m256 x0 = _mm256_sub_ps( vx, _mm256_sub_ps( fi, t ) ), y0 = _mm256_sub_ps( vy, _mm256_sub_ps( fj, t ) );
+	// which triangle of the cell
+	const __m256 one = _mm256_set1_ps( 1.0f );
+	const __m256 i1 = _mm256_and_ps( _mm256_cmp_ps( x0, y0, _CMP_GT_OQ ), one );
+	const __m256 j1 = _mm256_sub_ps( one, i1 );
+	const __m256 x1 = _mm256_add_ps( _mm256_sub_ps( x0, i1 ), _mm256_set1_ps( G2 ) ), y1 = _mm256_add_ps( _mm256_sub_ps( y0, j1 ), _mm256_set1_ps( G2 ) );
+	const __m256 x2 = _mm256_add_ps( _mm256_sub_ps( x0, one ), _mm256_set1_ps( 2.0f * G2 ) ), y2 = _mm256_add_ps( _mm256_sub_ps( y0, one ), _mm256_set1_ps( 2.0f * G2 ) );
+	auto corner = [ & ] ( const __m256 cx, const __m256 cy, const __m256 ci, const __m256 cj ) {
+		__m256 falloff = _mm256_max_ps( _mm256_setzero_ps(), _mm256_sub_ps( _mm256_sub_ps( _mm256_set1_ps( 0.5f ), _mm256_mul_ps( cx, cx ) ), _mm256_mul_ps( cy, cy ) ) );
+		falloff = _mm256_mul_ps( falloff, falloff );
+		falloff = _mm256_mul_ps( falloff, falloff );
+		return _mm256_mul_ps( falloff, avx::Grad2( avx::Hash( _mm256_cvttps_epi32( ci ), _mm256_cvttps_epi32( cj ), 0, seed ), cx, cy ) );
+	};
+	const __m256 n = _mm256_add_ps( _mm256_add_ps( corner( x0, y0, fi, fj ), corner( x1, y1, _mm256_add_ps( fi, i1 ), _mm256_add_ps( fj, j1 ) ) ),
+		corner( x2, y2, _mm256_add_ps( fi, one ), _mm256_add_ps( fj, one ) ) );
+	_mm256_store_ps( out, _mm256_mul_ps( _mm256_set1_ps( 70.0f ), n ) );
+#else
+	for ( int l = 0; l < LANES; l++ ) {
+		const float s = ( x[ l ] + y[ l ] ) * F2;
+		const float fi = std::floor( x[ l ] + s ), fj = std::floor( y[ l ] + s );
+		const float t = ( fi + fj ) * G2;
+		const float x0 = x[ l ] - ( fi - t ), y0 = y[ l ] - ( fj - t );
+		const int32_t i = int32_t( fi ), j = int32_t( fj );
+		const int32_t i1 = x0 > y0 ? 1 : 0, j1 = 1 - i1;
+		const float x1 = x0 - float( i1 ) + G2, y1 = y0 - float( j1 ) + G2;
+		const float x2 = x0 - 1.0f + 2.0f * G2, y2 = y0 - 1.0f + 2.0f * G2;
+		float t0 = std::max( 0.0f, 0.5f - x0 * x0 - y0 * y0 );
+		float t1 = std::max( 0.0f, 0.5f - x1 * x1 - y1 * y1 );
+		float t2 = std::max( 0.0f, 0.5f - x2 * x2 - y2 * y2 );
+		t0 *= t0; t1 *= t1; t2 *= t2;
+		const float n0 = t0 * t0 * Grad2( Hash( i, j, 0, seed ), x0, y0 );
+		const float n1 = t1 * t1 * Grad2( Hash( i + i1, j + j1, 0, seed ), x1, y1 );
+		const float n2 = t2 * t2 * Grad2( Hash( i + 1, j + 1, 0, seed ), x2, y2 );
+		out[ l ] = 70.0f * ( n0 + n1 + n2 );
+	}
+#endif
+}
+
+//===== Evaluation =====================================================================================================
+// the per-octave constants, worked out once per Fill() / Evaluate() instead of once per block
+struct plan_t {
+	static constexpr uint32_t maxOctaves = 16;
+	struct octave_t {
+		float fx, fy;		// frequency, per axis - when tiling, each octave snaps to a whole number of cells across the period
+		float px, py;		// period in cells, when tiling
+		float z;			// PERLIN_3D slice, in cells
+		float amplitude;
+		uint32_t seed;
+	};
+	octave_t octaves[ maxOctaves ];
+	uint32_t numOctaves;
+	bool tiled;
+	float scale;			// 1 / sum of amplitudes
+	noiseType_e type;
+	fractalType_e fractal;
+	glm::vec2 offset;
+	bool remap01;
+};
+
+inline plan_t Plan ( const config_t &config ) {
+	plan_t plan;
+	plan.numOctaves = ( config.fractal == NONE ) ? 1 : std::clamp( config.octaves, 1u, plan_t::maxOctaves );
+	plan.tiled = config.tilePeriod.x > 0 && config.tilePeriod.y > 0 && config.type != SIMPLEX;
+	plan.type = config.type;
+	plan.fractal = config.fractal;
+	plan.offset = config.offset;
+	plan.remap01 = config.remap01;
+	float frequency = config.frequency;
+	float amplitude = 1.0f;
+	float amplitudeSum = 0.0f;
+	for ( uint32_t o = 0; o < plan.numOctaves; o++ ) {
+		plan_t::octave_t &octave = plan.octaves[ o ];
+		octave.fx = octave.fy = frequency;
+		octave.px = octave.py = 0.0f;
+		if ( plan.tiled ) {
+			octave.px = std::max( 1.0f, std::round( config.tilePeriod.x * frequency ) );
+			octave.py = std::max( 1.0f, std::round( config.tilePeriod.y * frequency ) );
+			octave.fx = octave.px / config.tilePeriod.x;
+			octave.fy = octave.py / config.tilePeriod.y;
+		}
+		octave.z = config.z * frequency;
+		octave.amplitude = amplitude;
+		octave.seed = config.seed + o * 0x9E3779B9u;
+		amplitudeSum += amplitude;
+		amplitude *= config.gain;
+		frequency *= config.lacunarity;
+	}
+	plan.scale = 1.0f / amplitudeSum;
+	return plan;
+}
+
+// LANES points, positions in the same units as config.frequency ( before offset and scaling )
+inline void EvaluateLanes ( const plan_t &plan, const float * x, const float * y, float * out ) {
+	alignas( 32 ) float sx[ LANES ], sy[ LANES ], n[ LANES ], sum[ LANES ], weight[ LANES ];
+	for ( int l = 0; l < LANES; l++ ) { sum[ l ] = 0.0f; weight[ l ] = 1.0f; }
+
+	for ( uint32_t o = 0; o < plan.numOctaves; o++ ) {
+		const plan_t::octave_t &octave = plan.octaves[ o ];
+		for ( int l = 0; l < LANES; l++ ) {
+			sx[ l ] = ( x[ l ] + plan.offset.x ) * octave.fx;
+			sy[ l ] = ( y[ l ] + plan.offset.y ) * octave.fy;
+		}
+		const float px = octave.px, py = octave.py;
+		const uint32_t seed = octave.seed;
+		switch ( plan.type ) {
+			case PERLIN:	plan.tiled ? PerlinLanes< true >( sx, sy, seed, px, py, n ) : PerlinLanes< false >( sx, sy, seed, px, py, n ); break;
+			case PERLIN_3D:	plan.tiled ? Perlin3Lanes< true >( sx, sy, octave.z, seed, px, py, n ) : Perlin3Lanes< false >( sx, sy, octave.z, seed, px, py, n ); break;
+			case SIMPLEX:	SimplexLanes( sx, sy, seed, n ); break;
+			case VALUE:		plan.tiled ? ValueLanes< true >( sx, sy, seed, px, py, n ) : ValueLanes< false >( sx, sy, seed, px, py, n ); break;
+		}
+		if ( plan.fractal == RIDGED ) {
+			// sharp creases where the noise crosses zero, each octave weighted by the one before it
+			for ( int l = 0; l < LANES; l++ ) {
+				float r = 1.0f - std::fabs( n[ l ] );
+				r = r * r * weight[ l ];
+				weight[ l ] = std::min( 1.0f, std::max( 0.0f, r * 2.0f ) );
+				sum[ l ] += r * octave.amplitude;
+			}
+		} else {
+			for ( int l = 0; l < LANES; l++ ) {
+				sum[ l ] += n[ l ] * octave.amplitude;
+			}
+		}
+	}
+
+	// FBM / NONE land in [ -1, 1 ], RIDGED in [ 0, 1 ]
+	for ( int l = 0; l < LANES; l++ ) {
+		const float v = sum[ l ] * plan.scale;
+		if ( plan.fractal == RIDGED ) {
+			out[ l ] = plan.remap01 ? v : v * 2.0f - 1.0f;
+		} else {
+			out[ l ] = plan.remap01 ? v * 0.5f + 0.5f : v;
+		}
+	}
+}
+
+// arbitrary points, e.g. scattered placement tests
+inline void Evaluate ( const config_t &config, const float * x, const float * y, const size_t count, float * out ) {
+	const plan_t plan = Plan( config );
+	alignas( 32 ) float bx[ LANES ], by[ LANES ], bo[ LANES ];
+	size_t i = 0;
+	for ( ; i + LANES <= count; i += LANES ) {
+		EvaluateLanes( plan, x + i, y + i, out + i );
+	}
+	if ( i < count ) { // ragged end, padded out with the last point
+		for ( int l = 0; l < LANES; l++ ) {
+			const size_t idx = std::min( i + l, count - 1 );
+			bx[ l ] = x[ idx ]; by[ l ] = y[ idx ];
+		}
+		EvaluateLanes( plan, bx, by, bo );
+		for ( size_t l = 0; i + l < count; l++ ) out[ i + l ] = bo[ l ];
+	}
+}
+
+// single point - still goes through the block path, use Evaluate() / Fill() when there's more than one
+inline float Sample ( const config_t &config, const float x, const float y ) {
+	float result;
+	Evaluate( config, &x, &y, 1, &result );
+	return result;
+}
+
+// write the region [ origin, origin + size ) of image, sampled at pixel centers - pixel ( x, y ) is at position
+	// ( x + 0.5, y + 0.5 ), so a region can be filled separately from the rest and still line up
+inline void Fill ( Image_1F &image, const config_t &config, glm::uvec2 origin, glm::uvec2 size, const uint32_t numThreads = 0 ) {
+	const uint32_t w = image.Width(), h = image.Height();
+	if ( origin.x >= w || origin.y >= h ) return;
+	size.x = std::min( size.x, w - origin.x );
+	size.y = std::min( size.y, h - origin.y );
+	float * data = image.GetImageDataBasePtr();
+	const plan_t plan = Plan( config );
+	parallelForDynamic( size.y, [ & ] ( const size_t row, uint32_t ) {
+		alignas( 32 ) float bx[ LANES ], by[ LANES ], bo[ LANES ];
+		const uint32_t y = origin.y + uint32_t( row );
+		float * dst = data + size_t( y ) * w + origin.x;
+		for ( int l = 0; l < LANES; l++ ) by[ l ] = y + 0.5f;
+		for ( uint32_t x = 0; x < size.x; x += LANES ) {
+			for ( int l = 0; l < LANES; l++ ) bx[ l ] = origin.x + x + l + 0.5f;
+			EvaluateLanes( plan, bx, by, bo );
+			const uint32_t n = std::min( uint32_t( LANES ), size.x - x );
+			for ( uint32_t l = 0; l < n; l++ ) dst[ x + l ] = bo[ l ];
+		}
+	}, 4, numThreads );
+}
+
+inline void Fill ( Image_1F &image, const config_t &config, const uint32_t numThreads = 0 ) {
+	Fill( image, config, glm::uvec2( 0 ), glm::uvec2( image.Width(), image.Height() ), numThreads );
+}
+
+//===== Diamond-Square =================================================================================================
+// size must be 2^n + 1, at least 5 - corners are ( 0, 0 ), ( edge, 0 ), ( 0, edge ), ( edge, edge ). Displacement at
+	// level L is uniform in [ -range, range ), range = initialRange * roughness^L, as with the variance callback in
+	// particleEroder. Edges average three neighbors, same as diamond_square_no_wrap.
+inline Image_1F DiamondSquare ( const uint32_t size, const uint32_t seed, const glm::vec4 corners, const float roughness = 0.5f, const float initialRange = 1.0f, const uint32_t numThreads = 0 ) {
+	Image_1F result( size, size );
+	if ( size < 5 || ( ( size - 1 ) & ( size - 2 ) ) != 0 ) return result;
+
+	float * d = result.GetImageDataBasePtr();
+	const int32_t s = int32_t( size );
+	const int32_t end = s - 1;
+	d[ 0 ] = corners.x;
+	d[ end ] = corners.y;
+	d[ size_t( end ) * s ] = corners.z;
+	d[ size_t( end ) * s + end ] = corners.w;
+
+	// every point is written exactly once, so hashing its coordinates is as good as a sequential stream
+	auto displacement = [ seed ] ( const int32_t x, const int32_t y, const float range ) {
+		return ( float( Hash( x, y, 0x5bd1e995u, seed ) >> 8 ) * ( 2.0f / 16777216.0f ) - 1.0f ) * range;
+	};
+
+	int32_t level = 0;
+	for ( int32_t stride = end; stride > 1; stride /= 2, level++ ) {
+		const int32_t half = stride / 2;
+		const float range = initialRange * std::pow( roughness, float( level ) );
+		// below this, spawning threads costs more than the pass
+		const uint32_t threads = ( size_t( end / stride ) * ( end / stride ) < 4096 ) ? 1 : numThreads;
+
+		// diamond step - centers of each square, from its four corners
+		const int32_t numSquares = end / stride;
+		parallelForRanges( numSquares, [ & ] ( const size_t begin, const size_t finish, uint32_t ) {
+			for ( size_t r = begin; r < finish; r++ ) {
+				const int32_t y = half + int32_t( r ) * stride;
+				const float * above = d + size_t( y - half ) * s;
+				const float * below = d + size_t( y + half ) * s;
+				float * row = d + size_t( y ) * s;
+				for ( int32_t x = half; x < end; x += stride ) {
+					row[ x ] = ( above[ x - half ] + above[ x + half ] + below[ x - half ] + below[ x + half ] ) * 0.25f + displacement( x, y, range );
+				}
+			}
+		}, threads );
+
+		// square step - edge midpoints, from the diamond centers and corners around them ( three on the border )
+		const int32_t numRows = end / half + 1;
+		parallelForRanges( numRows, [ & ] ( const size_t begin, const size_t finish, uint32_t ) {
+			for ( size_t r = begin; r < finish; r++ ) {
+				const int32_t y = int32_t( r ) * half;
+				float * row = d + size_t( y ) * s;
+				for ( int32_t x = ( ( y / half ) & 1 ) ? 0 : half; x <= end; x += stride ) {
+					float total = 0.0f;
+					int count = 0;
+					if ( y >= half ) { total += d[ size_t( y - half ) * s + x ]; count++; }
+					if ( y + half <= end ) { total += d[ size_t( y + half ) * s + x ]; count++; }
+					if ( x >= half ) { total += row[ x - half ]; count++; }
+					if ( x + half <= end ) { total += row[ x + half ]; count++; }
+					row[ x ] = total / float( count ) + displacement( x, y, range );
+				}
+			}
+		}, threads );
+	}
+	return result;
+}
+
+//===== Benchmark ======================================================================================================
+struct benchmarkResult_t {
+	uint32_t dim = 0;
+	uint32_t numThreads = 0;
+	// samples / sec, one octave of Perlin
+	double legacySamplesPerSecond = 0.0;		// PerlinNoise::noise, one double at a time
+	double batchSamplesPerSecond = 0.0;			// Fill(), one thread
+	double parallelSamplesPerSecond = 0.0;		// Fill(), all threads
+	double fbmSamplesPerSecond = 0.0;			// Fill(), 6 octave fBm, all threads
+	// diamond-square at ( dim + 1 )^2
+	float legacyDiamondSquareMs = 0.0f;			// heightfield::diamond_square_no_wrap into nested vectors + copy
+	float diamondSquareMs = 0.0f;
+	float checksum = 0.0f;						// keeps the legacy loop from being optimized out
+};
+
+inline benchmarkResult_t Benchmark ( const uint32_t dim = 1024 ) {
+	benchmarkResult_t result;
+	result.dim = dim;
+	result.numThreads = parallelThreadCount();
+	const double samples = double( dim ) * dim;
+	auto seconds = [] ( std::chrono::steady_clock::time_point t ) {
+		return std::chrono::duration< double >( std::chrono::steady_clock::now() - t ).count();
+	};
+
+	{
+		PerlinNoise legacy;
+		double total = 0.0;
+		const auto t = std::chrono::steady_clock::now();
+		for ( uint32_t y = 0; y < dim; y++ ) {
+			for ( uint32_t x = 0; x < dim; x++ ) {
+				total += legacy.noise( ( x + 0.5 ) / 256.0, ( y + 0.5 ) / 256.0, 0.0 );
+			}
+		}
+		result.legacySamplesPerSecond = samples / seconds( t );
+		result.checksum += float( total / samples );
+	}
+
+	Image_1F image( dim, dim );
+	config_t config;
+	config.fractal = NONE;
+	{
+		const auto t = std::chrono::steady_clock::now();
+		Fill( image, config, 1 );
+		result.batchSamplesPerSecond = samples / seconds( t );
+	}
+	{
+		const auto t = std::chrono::steady_clock::now();
+		Fill( image, config );
+		result.parallelSamplesPerSecond = samples / seconds( t );
+	}
+	{
+		config.fractal = FBM;
+		config.octaves = 6;
+		const auto t = std::chrono::steady_clock::now();
+		Fill( image, config );
+		result.fbmSamplesPerSecond = samples * config.octaves / seconds( t );
+	}
+
+	{
+		const int size = int( dim ) + 1;
+		const auto t = std::chrono::steady_clock::now();
+		std::default_random_engine engine{ 1 };
+		std::uniform_real_distribution< float > distribution{ 0.0f, 1.0f };
+		std::vector< std::vector< float > > data( size, std::vector< float >( size, 0.0f ) );
+		heightfield::diamond_square_no_wrap( size,
+			[ &engine, &distribution ] ( float range ) { return distribution( engine ) * range; },
+			[] ( int level ) -> float { return std::pow( 0.5f, level ); },
+			[ &data ] ( int x, int y ) -> float& { return data[ x ][ y ]; } );
+		Image_1F copy( size, size );
+		for ( int y = 0; y < size; y++ ) {
+			for ( int x = 0; x < size; x++ ) {
+				copy.SetAtXY( x, y, color_1F( { data[ x ][ y ] } ) );
+			}
+		}
+		result.legacyDiamondSquareMs = float( seconds( t ) * 1000.0 );
+		result.checksum += copy.GetAtXY( size / 2, size / 2 )[ red ];
+	}
+	{
+		const auto t = std::chrono::steady_clock::now();
+		Image_1F heightfield = DiamondSquare( dim + 1, 1, glm::vec4( 0.5f ) );
+		result.diamondSquareMs = float( seconds( t ) * 1000.0 );
+		result.checksum += heightfield.GetAtXY( dim / 2, dim / 2 )[ red ];
+	}
+	return result;
+}
+
+} // namespace batchNoise
+
+#endif // BATCH_NOISE_H
@@ -0,0 +1,441 @@
+#pragma once
+#ifndef PRIMITIVE_CODEC_H
+#define PRIMITIVE_CODEC_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "../GLM/glm.hpp"
+
+// Compact encoding for the Chorizo impostor primitives ( geometryManager_t, in the Chorizo* projects )
+//   The float layout is 16 floats per primitive, 64 bytes - four of those are always zero, the type tag is
+//   stored as a float, and the positions are all full precision floats. This packs each one into 4 uints,
+//   with positions quantized to 16 bits per axis, relative to the bounds of a cluster of primitives.
+//   geometryManager_t::Pack() encodes the lists before the SSBO upload, the shaders decode with the port of
+//   DecodePrimitive() in engine/shaders/lib/primitiveCodec.glsl.h - keep the two in sync.
+
+// float layout, for reference ( see generate.h ):
+	// SPHERE:		type, position.xyz,		abs( radius ), radius, 0, 0,		0, 0, 0, 0,			color
+	// CAPSULE:		type, pointA.xyz,		radius, pointB.xyz,					0, 0, 0, 0,			color
+	// ROUNDEDBOX:	type, center.xyz,		packedEuler, scaleFactors.xyz,		rounding, 0, 0, 0,	color
+	// color is either ( 0, 0, 0, paletteSelect + paletteValue ) or ( r, g, b, -1 )
+
+// packed layout, 128 bits:
+	// bits   0..95 are geometry, depending on type:
+		// SPHERE:		position 3x16
+		// CAPSULE:		pointA 3x16, pointB 3x16
+		// ROUNDEDBOX:	center 3x16, theta 12, phi 9, scaleFactors 3x9
+	// bits  96..97 type
+	// bit   98     color mode ( 0 palette, 1 rgb )
+	// bits  99..111 signed scalar - radius for spheres and capsules, rounding factor for rounded boxes ( sign + 12 bits )
+	// bits 112..127 color - palette: 8 bit value + 8 bit palette select, rgb: RGB565
+
+namespace primitiveCodec {
+
+	// matching the SPHERE, CAPSULE, ROUNDEDBOX defines in generate.h
+	constexpr uint32_t typeSphere = 0;
+	constexpr uint32_t typeCapsule = 1;
+	constexpr uint32_t typeRoundedBox = 2;
+
+	// number of consecutive primitives that share a set of quantization bounds - generators emit spatially
+		// coherent runs ( e.g. one branch after another ), so the list order is already a decent clustering
+	constexpr uint32_t clusterSize = 1024;
+
+	// 32 bytes, laid out as two vec4s so it can go in an std430 buffer as-is
+	struct clusterHeader_t {
+		glm::vec3 boundsMin = glm::vec3( 0.0f );
+		float maxScalar = 0.0f;	// largest abs( radius ) / rounding factor in the cluster
+		glm::vec3 boundsMax = glm::vec3( 0.0f );
+		float maxScale = 0.0f;	// largest rounded box scale factor in the cluster
+	};
+
+	// 16 bytes, a quarter of the float layout
+	struct packedPrimitive_t {
+		uint32_t data[ 4 ] = { 0, 0, 0, 0 };
+	};
+
+	struct compressedList_t {
+		std::vector< clusterHeader_t > clusters;
+		std::vector< packedPrimitive_t > primitives;
+
+		size_t Count () const { return primitives.size(); }
+		size_t SizeBytes () const { return clusters.size() * sizeof( clusterHeader_t ) + primitives.size() * sizeof( packedPrimitive_t ); }
+		float BytesPerPrimitive () const { return primitives.size() ? float( SizeBytes() ) / float( primitives.size() ) : 0.0f; }
+	};
+
+//=============================================================================
+//==== Bit Packing Helpers ====================================================
+//=============================================================================
+
+	inline void PutBits ( packedPrimitive_t &p, const uint32_t offset, const uint32_t width, uint32_t value ) {
+		value &= ( width == 32 ) ? 0xFFFFFFFFu : ( ( 1u << width ) - 1u );
+		const uint32_t word = offset / 32;
+		const uint32_t shift = offset % 32;
+		p.data[ word ] |= value << shift;
+		if ( shift + width > 32 ) { // straddles a word boundary
+			p.data[ word + 1 ] |= value >> ( 32 - shift );
+		}
+	}
+
+	inline uint32_t GetBits ( const packedPrimitive_t &p, const uint32_t offset, const uint32_t width ) {
+		const uint32_t word = offset / 32;
+		const uint32_t shift = offset % 32;
+		uint64_t value = p.data[ word ] >> shift;
+		if ( shift + width > 32 ) {
+			value |= uint64_t( p.data[ word + 1 ] ) << ( 32 - shift );
+		}
+		return uint32_t( value & ( ( uint64_t( 1 ) << width ) - 1 ) );
+	}
+
+	// unsigned quantization of value in [ lo, hi ] to N bits, and back
+	inline uint32_t Quantize ( const float value, const float lo, const float hi, const uint32_t bits ) {
+		const float maxQ = float( ( 1u << bits ) - 1u );
+		if ( hi <= lo ) return 0;
+		return uint32_t( std::clamp( std::round( ( value - lo ) / ( hi - lo ) * maxQ ), 0.0f, maxQ ) );
+	}
+
+	inline float Dequantize ( const uint32_t q, const float lo, const float hi, const uint32_t bits ) {
+		const float maxQ = float( ( 1u << bits ) - 1u );
+		return ( hi <= lo ) ? lo : lo + ( float( q ) / maxQ ) * ( hi - lo );
+	}
+
+	// field offsets, from the layout above
+	constexpr uint32_t positionBits = 16;
+	constexpr uint32_t thetaBits = 12;
+	constexpr uint32_t phiBits = 9;
+	constexpr uint32_t scaleBits = 9;
+	constexpr uint32_t scalarBits = 12;
+	constexpr uint32_t typeOffset = 96;
+	constexpr uint32_t colorModeOffset = 98;
+	constexpr uint32_t scalarSignOffset = 99;
+	constexpr uint32_t scalarOffset = 100;
+	constexpr uint32_t colorOffset = 112;
+
+	inline void PutPosition ( packedPrimitive_t &p, const uint32_t offset, const glm::vec3 v, const clusterHeader_t &h ) {
+		for ( int i = 0; i < 3; i++ )
+			PutBits( p, offset + i * positionBits, positionBits, Quantize( v[ i ], h.boundsMin[ i ], h.boundsMax[ i ], positionBits ) );
+	}
+
+	inline glm::vec3 GetPosition ( const packedPrimitive_t &p, const uint32_t offset, const clusterHeader_t &h ) {
+		glm::vec3 v;
+		for ( int i = 0; i < 3; i++ )
+			v[ i ] = Dequantize( GetBits( p, offset + i * positionBits, positionBits ), h.boundsMin[ i ], h.boundsMax[ i ], positionBits );
+		return v;
+	}
+
+//=============================================================================
+//==== Encode / Decode ========================================================
+//=============================================================================
+
+	inline void EncodePrimitive ( const float parameters[ 16 ], const clusterHeader_t &h, packedPrimitive_t &p ) {
+		p = packedPrimitive_t();
+		const uint32_t type = uint32_t( parameters[ 0 ] );
+		PutBits( p, typeOffset, 2, type );
+
+		float scalar = 0.0f;
+		switch ( type ) {
+			case typeSphere:
+				PutPosition( p, 0, glm::vec3( parameters[ 1 ], parameters[ 2 ], parameters[ 3 ] ), h );
+				scalar = parameters[ 5 ]; // signed radius, abs() is rederived on decode
+				break;
+
+			case typeCapsule:
+				PutPosition( p, 0, glm::vec3( parameters[ 1 ], parameters[ 2 ], parameters[ 3 ] ), h );
+				PutPosition( p, 48, glm::vec3( parameters[ 5 ], parameters[ 6 ], parameters[ 7 ] ), h );
+				scalar = parameters[ 4 ];
+				break;
+
+			case typeRoundedBox: {
+				PutPosition( p, 0, glm::vec3( parameters[ 1 ], parameters[ 2 ], parameters[ 3 ] ), h );
+
+				// the shaders only ever look at fract() and floor() of the packed euler value, so keep those two parts
+				const float packedEuler = parameters[ 4 ];
+				const float phi = std::floor( packedEuler ); // integer in -256..255
+				const float theta = packedEuler - phi; // 0..1
+				PutBits( p, 48, thetaBits, std::min( uint32_t( theta * float( 1u << thetaBits ) ), ( 1u << thetaBits ) - 1u ) );
+				PutBits( p, 60, phiBits, uint32_t( std::clamp( int( phi ) + 256, 0, 511 ) ) );
+
+				for ( int i = 0; i < 3; i++ )
+					PutBits( p, 69 + i * scaleBits, scaleBits, Quantize( parameters[ 5 + i ], 0.0f, h.maxScale, scaleBits ) );
+				scalar = parameters[ 8 ];
+				break;
+			}
+
+			default: break;
+		}
+
+		PutBits( p, scalarSignOffset, 1, scalar < 0.0f ? 1 : 0 );
+		PutBits( p, scalarOffset, scalarBits, Quantize( std::abs( scalar ), 0.0f, h.maxScalar, scalarBits ) );
+
+		if ( parameters[ 15 ] == -1.0f ) { // explicit color, RGB565
+			PutBits( p, colorModeOffset, 1, 1 );
+			PutBits( p, colorOffset, 5, Quantize( parameters[ 12 ], 0.0f, 1.0f, 5 ) );
+			PutBits( p, colorOffset + 5, 6, Quantize( parameters[ 13 ], 0.0f, 1.0f, 6 ) );
+			PutBits( p, colorOffset + 11, 5, Quantize( parameters[ 14 ], 0.0f, 1.0f, 5 ) );
+		} else { // palette select in the integer part, value in the fractional part
+			const float select = std::floor( parameters[ 15 ] );
+			const float value = parameters[ 15 ] - select;
+			PutBits( p, colorOffset, 8, std::min( uint32_t( value * 256.0f ), 255u ) );
+			PutBits( p, colorOffset + 8, 8, uint32_t( std::clamp( select, 0.0f, 255.0f ) ) );
+		}
+	}
+
+	inline void DecodePrimitive ( const packedPrimitive_t &p, const clusterHeader_t &h, float parameters[ 16 ] ) {
+		std::fill( parameters, parameters + 16, 0.0f );
+		const uint32_t type = GetBits( p, typeOffset, 2 );
+		parameters[ 0 ] = float( type );
+
+		const float scalar = ( GetBits( p, scalarSignOffset, 1 ) ? -1.0f : 1.0f ) * Dequantize( GetBits( p, scalarOffset, scalarBits ), 0.0f, h.maxScalar, scalarBits );
+		const glm::vec3 position = GetPosition( p, 0, h );
+		parameters[ 1 ] = position.x;
+		parameters[ 2 ] = position.y;
+		parameters[ 3 ] = position.z;
+
+		switch ( type ) {
+			case typeSphere:
+				parameters[ 4 ] = std::abs( scalar );
+				parameters[ 5 ] = scalar;
+				break;
+
+			case typeCapsule: {
+				const glm::vec3 pointB = GetPosition( p, 48, h );
+				parameters[ 4 ] = scalar;
+				parameters[ 5 ] = pointB.x;
+				parameters[ 6 ] = pointB.y;
+				parameters[ 7 ] = pointB.z;
+				break;
+			}
+
+			case typeRoundedBox: {
+				// theta is reconstructed at the bin center, strictly inside 0..1, so floor() still recovers phi
+				const float theta = ( float( GetBits( p, 48, thetaBits ) ) + 0.5f ) / float( 1u << thetaBits );
+				const float phi = float( int( GetBits( p, 60, phiBits ) ) - 256 );
+				parameters[ 4 ] = phi + theta;
+				for ( int i = 0; i < 3; i++ )
+					parameters[ 5 + i ] = Dequantize( GetBits( p, 69 + i * scaleBits, scaleBits ), 0.0f, h.maxScale, scaleBits );
+				parameters[ 8 ] = scalar;
+				break;
+			}
+
+			default: break;
+		}
+
+		if ( GetBits( p, colorModeOffset, 1 ) ) {
+			parameters[ 12 ] = Dequantize( GetBits( p, colorOffset, 5 ), 0.0f, 1.0f, 5 );
+			parameters[ 13 ] = Dequantize( GetBits( p, colorOffset + 5, 6 ), 0.0f, 1.0f, 6 );
+			parameters[ 14 ] = Dequantize( GetBits( p, colorOffset + 11, 5 ), 0.0f, 1.0f, 5 );
+			parameters[ 15 ] = -1.0f;
+		} else {
+			parameters[ 15 ] = float( GetBits( p, colorOffset + 8, 8 ) ) + ( float( GetBits( p, colorOffset, 8 ) ) + 0.5f ) / 256.0f;
+		}
+	}
+
+	// compute the quantization bounds for primitives [ first, first + n ) of a float parameter list
+	inline clusterHeader_t ComputeClusterHeader ( const float * parametersList, const size_t first, const size_t n ) {
+		clusterHeader_t h;
+		h.boundsMin = glm::vec3(  std::numeric_limits< float >::max() );
+		h.boundsMax = glm::vec3( -std::numeric_limits< float >::max() );
+		for ( size_t i = first; i < first + n; i++ ) {
+			const float * parameters = parametersList + i * 16;
+			const glm::vec3 a = glm::vec3( parameters[ 1 ], parameters[ 2 ], parameters[ 3 ] );
+			h.boundsMin = glm::min( h.boundsMin, a );
+			h.boundsMax = glm::max( h.boundsMax, a );
+			switch ( uint32_t( parameters[ 0 ] ) ) {
+				case typeSphere:
+					h.maxScalar = std::max( h.maxScalar, std::abs( parameters[ 5 ] ) );
+					break;
+
+				case typeCapsule: {
+					const glm::vec3 b = glm::vec3( parameters[ 5 ], parameters[ 6 ], parameters[ 7 ] );
+					h.boundsMin = glm::min( h.boundsMin, b );
+					h.boundsMax = glm::max( h.boundsMax, b );
+					h.maxScalar = std::max( h.maxScalar, std::abs( parameters[ 4 ] ) );
+					break;
+				}
+
+				case typeRoundedBox:
+					h.maxScale = std::max( { h.maxScale, parameters[ 5 ], parameters[ 6 ], parameters[ 7 ] } );
+					h.maxScalar = std::max( h.maxScalar, std::abs( parameters[ 8 ] ) );
+					break;
+
+				default: break;
+			}
+		}
+		return h;
+	}
+
+	// parametersList is the geometryManager_t layout, 16 floats per primitive
+	inline compressedList_t Encode ( const std::vector< float > &parametersList ) {
+		compressedList_t result;
+		const size_t count = parametersList.size() / 16;
+		result.primitives.resize( count );
+		result.clusters.reserve( ( count + clusterSize - 1 ) / clusterSize );
+		for ( size_t first = 0; first < count; first += clusterSize ) {
+			const size_t n = std::min( size_t( clusterSize ), count - first );
+			result.clusters.push_back( ComputeClusterHeader( parametersList.data(), first, n ) );
+			for ( size_t i = first; i < first + n; i++ ) {
+				EncodePrimitive( parametersList.data() + i * 16, result.clusters.back(), result.primitives[ i ] );
+			}
+		}
+		return result;
+	}
+
+	// back to the float layout, e.g. for upload to the existing shaders
+	inline std::vector< float > Decode ( const compressedList_t &compressed ) {
+		std::vector< float > parametersList( compressed.primitives.size() * 16 );
+		for ( size_t i = 0; i < compressed.primitives.size(); i++ ) {
+			DecodePrimitive( compressed.primitives[ i ], compressed.clusters[ i / clusterSize ], parametersList.data() + i * 16 );
+		}
+		return parametersList;
+	}
+
+//=============================================================================
+//==== Round Trip Precision Report ============================================
+//=============================================================================
+
+	struct roundTripReport_t {
+		size_t count = 0;
+		size_t mismatchedTypes = 0;
+		size_t mismatchedColorModes = 0;
+		size_t mismatchedPaletteSelects = 0;
+		float maxPositionError = 0.0f;		// world units
+		float maxPositionErrorRelative = 0.0f;	// fraction of the cluster extent, expected <= 0.5 / 65535
+		float maxScalarError = 0.0f;		// radius / rounding factor, world units
+		float maxScalarErrorRelative = 0.0f;	// fraction of the cluster's maxScalar, expected <= 0.5 / 4095
+		float maxScaleError = 0.0f;
+		float maxScaleErrorRelative = 0.0f;	// fraction of the cluster's maxScale, expected <= 0.5 / 511
+		float maxThetaError = 0.0f;		// fraction of a full turn
+		float maxPhiError = 0.0f;			// in the 255 steps per quarter turn used by generate.h
+		float maxPaletteValueError = 0.0f;
+		float maxRGBError = 0.0f;
+		size_t originalBytes = 0;
+		size_t compressedBytes = 0;
+		float bytesPerPrimitive = 0.0f;
+		float encodeMs = 0.0f;			// filled in by the caller, when it times the Encode()
+
+		// everything inside the bounds implied by the bit allocation
+		bool Passed () const {
+			return mismatchedTypes == 0 && mismatchedColorModes == 0 && mismatchedPaletteSelects == 0 &&
+				maxPositionErrorRelative <= 0.5f / 65535.0f + 1e-6f && maxThetaError <= 0.5f / float( 1u << thetaBits ) + 1e-5f &&
+				maxScalarErrorRelative <= 0.5f / float( ( 1u << scalarBits ) - 1u ) + 1e-6f && maxScaleErrorRelative <= 0.5f / float( ( 1u << scaleBits ) - 1u ) + 1e-6f &&
+				maxPhiError == 0.0f && maxPaletteValueError <= 0.5f / 256.0f + 1e-5f && maxRGBError <= 0.5f / 31.0f + 1e-5f;
+		}
+
+		std::vector< std::string > Lines () const {
+			return {
+				"Primitives: " + std::to_string( count ),
+				"Float layout: " + std::to_string( originalBytes ) + " bytes ( 64.0 bytes per primitive )",
+				"Packed layout: " + std::to_string( compressedBytes ) + " bytes ( " + std::to_string( bytesPerPrimitive ) + " bytes per primitive, " + std::to_string( compressedBytes ? float( originalBytes ) / float( compressedBytes ) : 0.0f ) + "x smaller )",
+				"Max position error: " + std::to_string( maxPositionError ) + " ( " + std::to_string( maxPositionErrorRelative ) + " of cluster extent )",
+				"Max radius/rounding error: " + std::to_string( maxScalarError ) + " ( " + std::to_string( maxScalarErrorRelative ) + " of cluster max ), max scale error: " + std::to_string( maxScaleError ) + " ( " + std::to_string( maxScaleErrorRelative ) + " of cluster max )",
+				"Max theta error: " + std::to_string( maxThetaError ) + " turns, max phi error: " + std::to_string( maxPhiError ),
+				"Max palette value error: " + std::to_string( maxPaletteValueError ) + ", max RGB error: " + std::to_string( maxRGBError ),
+				"Type/color mode/palette mismatches: " + std::to_string( mismatchedTypes ) + "/" + std::to_string( mismatchedColorModes ) + "/" + std::to_string( mismatchedPaletteSelects ),
+				std::string( Passed() ? "Round trip within quantization bounds" : "Round trip exceeded quantization bounds" )
+			};
+		}
+	};
+
+	// checks an already encoded list against the floats it came from
+	inline roundTripReport_t RoundTrip ( const std::vector< float > &parametersList, const compressedList_t &compressed ) {
+		roundTripReport_t report;
+		const std::vector< float > decoded = Decode( compressed );
+
+		report.count = compressed.Count();
+		report.originalBytes = parametersList.size() * sizeof( float );
+		report.compressedBytes = compressed.SizeBytes();
+		report.bytesPerPrimitive = compressed.BytesPerPrimitive();
+
+		for ( size_t i = 0; i < report.count; i++ ) {
+			const float * a = parametersList.data() + i * 16;
+			const float * b = decoded.data() + i * 16;
+			const clusterHeader_t &h = compressed.clusters[ i / clusterSize ];
+			const float extent = std::max( { h.boundsMax.x - h.boundsMin.x, h.boundsMax.y - h.boundsMin.y, h.boundsMax.z - h.boundsMin.z, 1e-30f } );
+
+			if ( a[ 0 ] != b[ 0 ] ) { report.mismatchedTypes++; continue; }
+			auto positionError = [&] ( int offset ) {
+				for ( int j = 0; j < 3; j++ ) {
+					const float e = std::abs( a[ offset + j ] - b[ offset + j ] );
+					const float axisExtent = h.boundsMax[ j ] - h.boundsMin[ j ];
+					report.maxPositionError = std::max( report.maxPositionError, e );
+					report.maxPositionErrorRelative = std::max( report.maxPositionErrorRelative, axisExtent > 0.0f ? e / axisExtent : e / extent );
+				}
+			};
+			auto scalarError = [&] ( int offset ) {
+				const float e = std::abs( a[ offset ] - b[ offset ] );
+				report.maxScalarError = std::max( report.maxScalarError, e );
+				report.maxScalarErrorRelative = std::max( report.maxScalarErrorRelative, h.maxScalar > 0.0f ? e / h.maxScalar : e );
+			};
+			auto scaleError = [&] ( int offset ) {
+				const float e = std::abs( a[ offset ] - b[ offset ] );
+				report.maxScaleError = std::max( report.maxScaleError, e );
+				report.maxScaleErrorRelative = std::max( report.maxScaleErrorRelative, h.maxScale > 0.0f ? e / h.maxScale : e );
+			};
+
+			positionError( 1 );
+			switch ( uint32_t( a[ 0 ] ) ) {
+				case typeSphere:
+					scalarError( 5 );
+					break;
+
+				case typeCapsule:
+					positionError( 5 );
+					scalarError( 4 );
+					break;
+
+				case typeRoundedBox: {
+					const float thetaA = a[ 4 ] - std::floor( a[ 4 ] );
+					const float thetaB = b[ 4 ] - std::floor( b[ 4 ] );
+					const float dTheta = std::abs( thetaA - thetaB );
+					report.maxThetaError = std::max( report.maxThetaError, std::min( dTheta, 1.0f - dTheta ) );
+					report.maxPhiError = std::max( report.maxPhiError, std::abs( std::floor( a[ 4 ] ) - std::floor( b[ 4 ] ) ) );
+					for ( int j = 0; j < 3; j++ )
+						scaleError( 5 + j );
+					scalarError( 8 );
+					break;
+				}
+
+				default: break;
+			}
+
+			const bool rgbA = ( a[ 15 ] == -1.0f );
+			const bool rgbB = ( b[ 15 ] == -1.0f );
+			if ( rgbA != rgbB ) {
+				report.mismatchedColorModes++;
+			} else if ( rgbA ) {
+				for ( int j = 12; j < 15; j++ )
+					report.maxRGBError = std::max( report.maxRGBError, std::abs( std::clamp( a[ j ], 0.0f, 1.0f ) - b[ j ] ) );
+			} else {
+				if ( std::floor( a[ 15 ] ) != std::floor( b[ 15 ] ) ) report.mismatchedPaletteSelects++;
+				report.maxPaletteValueError = std::max( report.maxPaletteValueError, std::abs( a[ 15 ] - b[ 15 ] ) );
+			}
+		}
+		return report;
+	}
+
+	inline roundTripReport_t RoundTrip ( const std::vector< float > &parametersList ) {
+		return RoundTrip( parametersList, Encode( parametersList ) );
+	}
+
+	// registers the "primitiveCodecReport" terminal command over the given named reports - templated on the terminal
+		// so this header doesn't need the engine includes, the reports need to outlive the terminal
+	template < typename terminalType >
+	inline void AddReportCommand ( terminalType &terminal, const std::vector< std::pair< std::string, const roundTripReport_t * > > reports ) {
+		terminal.addCommand( { "primitiveCodecReport" }, {},
+			[ &terminal, reports ] ( auto args ) {
+				for ( auto& report : reports ) {
+					terminal.addHistoryLine( terminal.csb.append( report.first + " ( encoded in " + std::to_string( report.second->encodeMs ) + "ms )", 2 ).flush() );
+					for ( auto& line : report.second->Lines() ) {
+						terminal.addHistoryLine( terminal.csb.append( "  " + line ).flush() );
+					}
+				}
+			}, "Report size and precision of the packed impostor lists, as of the last upload." );
+	}
+}
+
+#endif // PRIMITIVE_CODEC_H
@@ -45,16 +45,16 @@ public:
 			//   operation, so the idea is to write the result to a texture and copy
 			//   that until the state changes and that is no longer good data
 			glUseProgram( generateShader );
-			glUniform3fv( glGetUniformLocation( generateShader, "basisX" ), 1, glm::value_ptr( basisX ) );
-			glUniform3fv( glGetUniformLocation( generateShader, "basisY" ), 1, glm::value_ptr( basisY ) );
-			glUniform3fv( glGetUniformLocation( generateShader, "basisZ" ), 1, glm::value_ptr( basisZ ) );
-			glUniform1i( glGetUniformLocation( generateShader, "mode" ), modeSelect );
+			UniformCache().Set( generateShader, generateUniforms.basisX, basisX );
+			UniformCache().Set( generateShader, generateUniforms.basisY, basisY );
+			UniformCache().Set( generateShader, generateUniforms.basisZ, basisZ );
+			UniformCache().Set( generateShader, generateUniforms.mode, modeSelect );
 			glDispatchCompute( blockDimensions.x, blockDimensions.y, 1 );
 			needsRedraw = false;
 		}
 
 		glUseProgram( copyShader );
-		glUniform2iv( glGetUniformLocation( copyShader, "basePt" ), 1, glm::value_ptr( basePt ) );
+		UniformCache().Set( copyShader, copyUniforms.basePt, basePt );
 		glDispatchCompute( blockDimensions.x, blockDimensions.y, 1 );
 	}
 
@@ -145,6 +145,17 @@ private:
 	GLuint generateShader;
 	GLuint copyShader;
 	bool needsRedraw; // generate shader needs to run again with new values
+
+	struct generateUniforms_t {
+		uniform_t< glm::vec3 > basisX { "basisX" };
+		uniform_t< glm::vec3 > basisY { "basisY" };
+		uniform_t< glm::vec3 > basisZ { "basisZ" };
+		uniform_t< int > mode { "mode" };
+	} generateUniforms;
+
+	struct copyUniforms_t {
+		uniform_t< glm::ivec2 > basePt { "basePt" };
+	} copyUniforms;
 };
 
 #endif